@@ -0,0 +1,142 @@
+#!/usr/bin/env python
+
+# ===--- compare_perf_tests.py -------------------------------------------===//
+#
+#  This source file is part of the Swift.org open source project
+#
+#  Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+#  Licensed under Apache License v2.0 with Runtime Library Exception
+#
+#  See http://swift.org/LICENSE.txt for license information
+#  See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ===---------------------------------------------------------------------===//
+
+"""
+Compare the output of two runs of the in-tree benchmark driver, or convert
+one run into the JSON report utils/submit-benchmark-results reads.
+
+The input files hold the CSV lines Benchmark_O and friends print:
+
+  #,TEST,SAMPLES,MIN(us),MEDIAN(us),MEAN(us),SD(us),MAX_RSS(B),ALLOCS
+
+A file may hold several runs appended to each other, as
+utils/pre-commit-benchmark writes them; the best of the runs is used.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+# Only the leading columns are required, so that output of the external
+# performance test suite (#,TEST,SAMPLES,MIN,MAX,...) can be compared too.
+SCORE_RE = re.compile(r"^(\d+),[ \t]*(\w+),[ \t]*(\d+),[ \t]*([\d.]+)"
+                      r"(?:,[ \t]*([\d.]+))?")
+
+def parse_results(path):
+    """Return a dictionary from benchmark name to (min, median), taking the
+    smallest value of each over all the runs in the file."""
+    results = {}
+    with open(path) as f:
+        for line in f:
+            m = SCORE_RE.match(line)
+            if not m:
+                continue
+            name = m.group(2)
+            minimum = float(m.group(4))
+            median = float(m.group(5)) if m.group(5) else minimum
+            if name in results:
+                old_min, old_median = results[name]
+                minimum = min(minimum, old_min)
+                median = min(median, old_median)
+            results[name] = (minimum, median)
+    return results
+
+def compare(args):
+    old = parse_results(args.old)
+    new = parse_results(args.new)
+
+    rows = [['TEST', 'OLD_MIN', 'NEW_MIN', 'OLD_MEDIAN', 'NEW_MEDIAN',
+             'SPEEDUP', '']]
+    regressions = 0
+    for name in sorted(set(old.keys()) | set(new.keys())):
+        if name not in old or name not in new:
+            rows.append([name, 'added' if name in new else 'removed'])
+            continue
+        old_min, old_median = old[name]
+        new_min, new_median = new[name]
+        speedup = old_min / new_min if new_min > 0 else float('inf')
+        flag = ''
+        if speedup < 1 - args.threshold:
+            flag = '(!)'
+            regressions += 1
+        elif speedup > 1 + args.threshold:
+            flag = '(+)'
+        if not flag and args.changes_only:
+            continue
+        rows.append([name, '%d' % old_min, '%d' % new_min,
+                     '%d' % old_median, '%d' % new_median,
+                     '%.2fx' % speedup, flag])
+
+    widths = [max(len(row[i]) for row in rows if i < len(row))
+              for i in range(len(rows[0]))]
+    for row in rows:
+        print(' '.join(cell.ljust(widths[i]) if i == 0 else
+                       cell.rjust(widths[i])
+                       for i, cell in enumerate(row)).rstrip())
+
+    if regressions:
+        print('\n%d benchmark(s) regressed by more than %d%%' %
+              (regressions, args.threshold * 100))
+        return 1
+    return 0
+
+def lit_json(args):
+    results = parse_results(args.results)
+    tests = []
+    elapsed = 0.0
+    for name in sorted(results):
+        minimum, _ = results[name]
+        seconds = minimum / 1e6
+        elapsed += seconds
+        tests.append({
+            'name': '%s :: %s' % (args.suite, name),
+            'code': 'PASS',
+            'metrics': {'compile_time': 0.0, 'exec_time': seconds},
+        })
+    with open(args.output, 'w') as f:
+        json.dump({'elapsed': elapsed, 'tests': tests}, f, indent=2)
+    return 0
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip(),
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    subparsers = parser.add_subparsers()
+
+    compare_parser = subparsers.add_parser('compare',
+        help='compare two result files; exits with 1 if anything regressed')
+    compare_parser.add_argument('old', help='the baseline results')
+    compare_parser.add_argument('new', help='the results to compare')
+    compare_parser.add_argument('--threshold', type=float, default=0.05,
+        help='relative change of the minimum that counts as a regression '
+             'or improvement (default: 0.05)')
+    compare_parser.add_argument('--changes-only', action='store_true',
+        help='only list benchmarks that changed by more than the threshold')
+    compare_parser.set_defaults(func=compare)
+
+    lit_parser = subparsers.add_parser('lit-json',
+        help='write results in the format utils/submit-benchmark-results '
+             'reads')
+    lit_parser.add_argument('results', help='the results to convert')
+    lit_parser.add_argument('-o', '--output', required=True,
+        help='the JSON file to write')
+    lit_parser.add_argument('--suite', default='Benchmark_O',
+        help='the suite name to record for each benchmark')
+    lit_parser.set_defaults(func=lit_json)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,217 @@
+#!/usr/bin/env python
+
+# ===--- compile_time_tests.py -------------------------------------------===//
+#
+#  This source file is part of the Swift.org open source project
+#
+#  Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+#  Licensed under Apache License v2.0 with Runtime Library Exception
+#
+#  See http://swift.org/LICENSE.txt for license information
+#  See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ===---------------------------------------------------------------------===//
+
+"""
+Measure how long the compiler takes to compile the inputs in
+benchmark/compile-time, or compare two such measurements.
+
+Each input is a gyb template. AppSkeleton.swift.gyb is instantiated once per
+file of a many-file module; every other template is a single file. Every
+input is compiled several times with -trace-compile-time, and the time of
+each frontend phase is summed over all frontend jobs of a compile. The
+results file records the minimum and median of every phase over the runs:
+
+  {"<benchmark>": {"<phase>": {"min": <us>, "median": <us>}, ...}, ...}
+
+The "wall" phase is the time of the whole swiftc invocation.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+INPUTS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                          os.pardir, 'compile-time')
+DEFAULT_GYB = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                           os.pardir, os.pardir, 'utils', 'gyb')
+
+MANY_FILE_BENCHMARK = 'AppSkeleton'
+
+# The phases the frontend records spans for, in pipeline order.
+PHASES = ['Sema', 'SILGen', 'SIL diagnostic passes', 'SIL optimization',
+          'IRGen', 'frontend']
+
+def list_benchmarks():
+    return sorted(name[:-len('.swift.gyb')]
+                  for name in os.listdir(INPUTS_DIR)
+                  if name.endswith('.swift.gyb'))
+
+def generate_sources(args, name, work_dir):
+    """Instantiate the template of benchmark \\p name in \\p work_dir and
+    return the paths of the generated files."""
+    template = os.path.join(INPUTS_DIR, name + '.swift.gyb')
+    if name == MANY_FILE_BENCHMARK:
+        count = args.app_files
+    else:
+        count = 1
+    sources = []
+    for i in range(count):
+        output = os.path.join(work_dir, '%s%d.swift' % (name, i))
+        subprocess.check_call([args.gyb, '-DFileIndex=%d' % i,
+                               '-DFileCount=%d' % count, '-o', output,
+                               template])
+        sources.append(output)
+    return sources
+
+def read_trace(path):
+    """Return the events of a trace in the "JSON array" format, whose
+    closing bracket is optional."""
+    with open(path) as f:
+        text = f.read().strip()
+    if text.endswith(','):
+        text = text[:-1]
+    if not text.endswith(']'):
+        text += ']'
+    return json.loads(text)
+
+def compile_once(args, name, sources, work_dir):
+    """Compile \\p sources and return a dictionary from phase to
+    microseconds."""
+    trace = os.path.join(work_dir, 'trace.json')
+    if os.path.exists(trace):
+        os.remove(trace)
+    command = [args.swiftc, '-c', '-module-name', name,
+               '-trace-compile-time', trace, '-j%d' % args.jobs]
+    command += args.swiftc_flags
+    command += sources
+    start = time.time()
+    subprocess.check_call(command, cwd=work_dir)
+    times = {'wall': int((time.time() - start) * 1e6)}
+    for phase in PHASES:
+        times[phase] = 0
+    for event in read_trace(trace):
+        if event.get('ph') == 'X' and event.get('cat') == 'frontend' and \
+                event['name'] in times:
+            times[event['name']] += event['dur']
+    return times
+
+def run(args):
+    benchmarks = args.benchmarks or list_benchmarks()
+    results = {}
+    for name in benchmarks:
+        work_dir = tempfile.mkdtemp(prefix='swift-compile-time-')
+        try:
+            sources = generate_sources(args, name, work_dir)
+            samples = [compile_once(args, name, sources, work_dir)
+                       for _ in range(args.iterations)]
+        finally:
+            shutil.rmtree(work_dir)
+        phases = {}
+        for phase in ['wall'] + PHASES:
+            values = sorted(sample[phase] for sample in samples)
+            phases[phase] = {'min': values[0],
+                             'median': values[len(values) // 2]}
+        results[name] = phases
+        print('%-20s wall %10d us  frontend %10d us' %
+              (name, phases['wall']['min'], phases['frontend']['min']))
+        sys.stdout.flush()
+
+    with open(args.output, 'w') as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+    return 0
+
+def compare(args):
+    with open(args.old) as f:
+        old = json.load(f)
+    with open(args.new) as f:
+        new = json.load(f)
+
+    rows = [['BENCHMARK', 'PHASE', 'OLD_MIN(us)', 'NEW_MIN(us)', 'SPEEDUP',
+             '']]
+    regressions = 0
+    for name in sorted(set(old.keys()) | set(new.keys())):
+        if name not in old or name not in new:
+            rows.append([name, 'added' if name in new else 'removed'])
+            continue
+        for phase in ['wall'] + PHASES:
+            if phase not in old[name] or phase not in new[name]:
+                continue
+            old_min = old[name][phase]['min']
+            new_min = new[name][phase]['min']
+            if old_min == 0 and new_min == 0:
+                continue
+            speedup = float(old_min) / new_min if new_min > 0 \
+                else float('inf')
+            flag = ''
+            if speedup < 1 - args.threshold:
+                flag = '(!)'
+                regressions += 1
+            elif speedup > 1 + args.threshold:
+                flag = '(+)'
+            if not flag and args.changes_only:
+                continue
+            rows.append([name, phase, '%d' % old_min, '%d' % new_min,
+                         '%.2fx' % speedup, flag])
+
+    widths = [max(len(row[i]) for row in rows if i < len(row))
+              for i in range(len(rows[0]))]
+    for row in rows:
+        print(' '.join(cell.ljust(widths[i]) if i < 2 else
+                       cell.rjust(widths[i])
+                       for i, cell in enumerate(row)).rstrip())
+
+    if regressions:
+        print('\n%d phase(s) regressed by more than %d%%' %
+              (regressions, args.threshold * 100))
+        return 1
+    return 0
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip(),
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    subparsers = parser.add_subparsers()
+
+    run_parser = subparsers.add_parser('run',
+        help='compile the benchmarks and write their results')
+    run_parser.add_argument('--swiftc', required=True,
+        help='the compiler driver to measure')
+    run_parser.add_argument('--gyb', default=DEFAULT_GYB,
+        help='the gyb script used to instantiate the inputs')
+    run_parser.add_argument('-o', '--output', required=True,
+        help='the JSON results file to write')
+    run_parser.add_argument('--iterations', type=int, default=5,
+        help='how many times to compile each benchmark (default: 5)')
+    run_parser.add_argument('--app-files', type=int, default=1000,
+        help='the number of files of the %s benchmark (default: 1000)' %
+             MANY_FILE_BENCHMARK)
+    run_parser.add_argument('-j', '--jobs', type=int, default=1,
+        help='the number of frontend jobs to run at once (default: 1)')
+    run_parser.add_argument('--swiftc-flag', dest='swiftc_flags',
+        action='append', default=[],
+        help='an extra flag for every compile, e.g. --swiftc-flag=-O')
+    run_parser.add_argument('benchmarks', nargs='*',
+        help='the benchmarks to run (default: all of them)')
+    run_parser.set_defaults(func=run)
+
+    compare_parser = subparsers.add_parser('compare',
+        help='compare two result files; exits with 1 if anything regressed')
+    compare_parser.add_argument('old', help='the baseline results')
+    compare_parser.add_argument('new', help='the results to compare')
+    compare_parser.add_argument('--threshold', type=float, default=0.05,
+        help='relative change of the minimum that counts as a regression '
+             'or improvement (default: 0.05)')
+    compare_parser.add_argument('--changes-only', action='store_true',
+        help='only list phases that changed by more than the threshold')
+    compare_parser.set_defaults(func=compare)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,55 @@
+//===--- ArrayAppend.swift ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Growing arrays one element at a time.
+
+@inline(never)
+func run_ArrayAppend(N: Int) {
+  for _ in 0..<N {
+    for _ in 0..<10 {
+      var nums = [Int]()
+      for i in 0..<40000 {
+        nums.append(i)
+      }
+      CheckResults(nums.count == 40000 && nums[39999] == 39999,
+                   "ArrayAppend: wrong contents")
+    }
+  }
+}
+
+@inline(never)
+func run_ArrayAppendReserved(N: Int) {
+  for _ in 0..<N {
+    for _ in 0..<10 {
+      var nums = [Int]()
+      nums.reserveCapacity(40000)
+      for i in 0..<40000 {
+        nums.append(i)
+      }
+      CheckResults(nums.count == 40000 && nums[39999] == 39999,
+                   "ArrayAppendReserved: wrong contents")
+    }
+  }
+}
+
+@inline(never)
+func run_ArrayAppendStrings(N: Int) {
+  let strings = ["a", "bb", "ccc", "dddd", "a somewhat longer string"]
+  for _ in 0..<N {
+    var elements = [String]()
+    for i in 0..<10000 {
+      elements.append(strings[i % strings.count])
+    }
+    CheckResults(elements.count == 10000 && elements[9999] == "dddd",
+                 "ArrayAppendStrings: wrong contents")
+  }
+}
@@ -0,0 +1,124 @@
+//===--- Class.swift ------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Workloads dominated by class allocation, reference counting and dynamic
+// dispatch.
+
+class Shape {
+  func area() -> Int { return 0 }
+}
+
+final class Square : Shape {
+  let side: Int
+  init(side: Int) { self.side = side }
+  override func area() -> Int { return side * side }
+}
+
+final class Rectangle : Shape {
+  let width: Int
+  let height: Int
+  init(width: Int, height: Int) {
+    self.width = width
+    self.height = height
+  }
+  override func area() -> Int { return width * height }
+}
+
+final class Triangle : Shape {
+  let base: Int
+  let height: Int
+  init(base: Int, height: Int) {
+    self.base = base
+    self.height = height
+  }
+  override func area() -> Int { return base * height / 2 }
+}
+
+@inline(never)
+func run_ClassDispatch(N: Int) {
+  var shapes = [Shape]()
+  for i in 0..<1000 {
+    switch i % 3 {
+    case 0: shapes.append(Square(side: i))
+    case 1: shapes.append(Rectangle(width: i, height: 2))
+    default: shapes.append(Triangle(base: i, height: 4))
+    }
+  }
+  for _ in 0..<N {
+    var total = 0
+    for _ in 0..<10 {
+      for shape in shapes {
+        total = total &+ shape.area()
+      }
+    }
+    CheckResults(total > 0, "ClassDispatch: wrong total")
+  }
+}
+
+final class ListNode {
+  let value: Int
+  let next: ListNode?
+  init(value: Int, next: ListNode?) {
+    self.value = value
+    self.next = next
+  }
+}
+
+@inline(never)
+func run_ClassLinkedList(N: Int) {
+  for _ in 0..<N {
+    var head: ListNode? = nil
+    for i in 0..<10000 {
+      head = ListNode(value: i, next: head)
+    }
+    var sum = 0
+    var node = head
+    while let n = node {
+      sum += n.value
+      node = n.next
+    }
+    CheckResults(sum == 10000 * 9999 / 2, "ClassLinkedList: wrong sum")
+    // Unlink the list iteratively; releasing a long chain of nodes
+    // recursively could overflow the stack.
+    while let n = head {
+      head = n.next
+    }
+  }
+}
+
+final class TreeNode {
+  let left: TreeNode?
+  let right: TreeNode?
+  init(left: TreeNode?, right: TreeNode?) {
+    self.left = left
+    self.right = right
+  }
+
+  func count() -> Int {
+    return 1 + (left?.count() ?? 0) + (right?.count() ?? 0)
+  }
+}
+
+func makeTree(depth: Int) -> TreeNode {
+  if depth == 0 {
+    return TreeNode(left: nil, right: nil)
+  }
+  return TreeNode(left: makeTree(depth - 1), right: makeTree(depth - 1))
+}
+
+@inline(never)
+func run_ClassTree(N: Int) {
+  for _ in 0..<N {
+    let tree = makeTree(12)
+    CheckResults(tree.count() == (1 << 13) - 1, "ClassTree: wrong count")
+  }
+}
@@ -0,0 +1,74 @@
+//===--- Dictionary.swift -------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Inserting into and looking up in native dictionaries.
+
+@inline(never)
+func run_DictionaryInsert(N: Int) {
+  let size = 10000
+  for _ in 0..<N {
+    var dict = [Int: Int]()
+    for i in 0..<size {
+      dict[i] = i
+    }
+    CheckResults(dict.count == size, "DictionaryInsert: wrong count")
+  }
+}
+
+@inline(never)
+func run_DictionaryLookup(N: Int) {
+  let size = 10000
+  var rng = LCRNG()
+  var dict = [Int: Int]()
+  var keys = [Int]()
+  for i in 0..<size {
+    let key = rng.next()
+    dict[key] = i
+    keys.append(key)
+  }
+
+  for _ in 0..<N {
+    var found = 0
+    for key in keys {
+      if dict[key] != nil {
+        found += 1
+      }
+      // A key that is almost never present.
+      if dict[key &+ 1] != nil {
+        found -= 1
+      }
+    }
+    CheckResults(found > 0, "DictionaryLookup: keys not found")
+  }
+}
+
+@inline(never)
+func run_DictionaryStringKeys(N: Int) {
+  let size = 1000
+  var keys = [String]()
+  for i in 0..<size {
+    keys.append("key number \(i)")
+  }
+
+  for _ in 0..<N {
+    var dict = [String: Int]()
+    for (i, key) in keys.enumerate() {
+      dict[key] = i
+    }
+    var sum = 0
+    for key in keys {
+      sum += dict[key]!
+    }
+    CheckResults(sum == size * (size - 1) / 2,
+                 "DictionaryStringKeys: wrong sum")
+  }
+}
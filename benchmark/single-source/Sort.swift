@@ -0,0 +1,62 @@
+//===--- Sort.swift -------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Sorting arrays of random integers and strings.
+
+func randomInts(count: Int) -> [Int] {
+  var rng = LCRNG()
+  var result = [Int]()
+  for _ in 0..<count {
+    result.append(rng.next())
+  }
+  return result
+}
+
+func isSorted<T : Comparable>(elements: [T]) -> Bool {
+  for i in elements.indices.dropFirst() {
+    if elements[i] < elements[i - 1] {
+      return false
+    }
+  }
+  return true
+}
+
+@inline(never)
+func run_SortInts(N: Int) {
+  let input = randomInts(10000)
+  for _ in 0..<N {
+    var elements = input
+    elements.sortInPlace()
+    CheckResults(isSorted(elements), "SortInts: not sorted")
+  }
+}
+
+@inline(never)
+func run_SortStrings(N: Int) {
+  let input = randomInts(2000).map { "\($0)" }
+  for _ in 0..<N {
+    var elements = input
+    elements.sortInPlace()
+    CheckResults(isSorted(elements), "SortStrings: not sorted")
+  }
+}
+
+@inline(never)
+func run_StableSortInts(N: Int) {
+  // Few distinct keys, so that stability matters.
+  let input = randomInts(10000).map { $0 % 100 }
+  for _ in 0..<N {
+    var elements = input
+    elements.stableSortInPlace()
+    CheckResults(isSorted(elements), "StableSortInts: not sorted")
+  }
+}
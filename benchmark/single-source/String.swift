@@ -0,0 +1,87 @@
+//===--- String.swift -----------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Common String operations, on ASCII and non-ASCII text.
+
+let asciiText = "The quick brown fox jumps over the lazy dog. "
+let unicodeText = "Съешь же ещё этих мягких французских булок. "
+
+@inline(never)
+func run_StringAppend(N: Int) {
+  for _ in 0..<N {
+    var s = ""
+    for _ in 0..<200 {
+      s += asciiText
+      s += unicodeText
+    }
+    CheckResults(s.utf16.count ==
+                 200 * (asciiText.utf16.count + unicodeText.utf16.count),
+                 "StringAppend: wrong length")
+  }
+}
+
+@inline(never)
+func run_StringCompare(N: Int) {
+  let a = asciiText + asciiText
+  let b = asciiText + asciiText
+  let c = asciiText + unicodeText
+  for _ in 0..<N {
+    var equal = 0
+    for _ in 0..<1000 {
+      if a == b { equal += 1 }
+      if a == c { equal -= 1 }
+      if a < c { equal += 1 }
+    }
+    CheckResults(equal == 2000, "StringCompare: wrong comparisons")
+  }
+}
+
+@inline(never)
+func run_StringHash(N: Int) {
+  var strings = [String]()
+  for i in 0..<1000 {
+    strings.append(i % 2 == 0 ? "\(asciiText)\(i)" : "\(unicodeText)\(i)")
+  }
+  for _ in 0..<N {
+    var set = Set<String>()
+    for s in strings {
+      set.insert(s)
+    }
+    CheckResults(set.count == strings.count, "StringHash: wrong count")
+  }
+}
+
+@inline(never)
+func run_StringInterpolation(N: Int) {
+  for _ in 0..<N {
+    var length = 0
+    for i in 0..<1000 {
+      let s = "item \(i) of \(asciiText) costs \(Double(i) / 4)"
+      length += s.utf8.count
+    }
+    CheckResults(length > 0, "StringInterpolation: empty results")
+  }
+}
+
+@inline(never)
+func run_StringUTF8View(N: Int) {
+  let text = String(count: 100, repeatedValue: Character("x")) + unicodeText
+  for _ in 0..<N {
+    var checksum = 0
+    for _ in 0..<100 {
+      for c in text.utf8 {
+        checksum = checksum &+ Int(c)
+      }
+    }
+    CheckResults(checksum != 0, "StringUTF8View: wrong checksum")
+  }
+}
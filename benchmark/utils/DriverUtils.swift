@@ -0,0 +1,244 @@
+//===--- DriverUtils.swift - Benchmark driver -----------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Runs each benchmark for a number of samples and prints one CSV line per
+// benchmark, in the format utils/pre-commit-benchmark and
+// benchmark/scripts/compare_perf_tests.py read:
+//
+//   #,TEST,SAMPLES,MIN(us),MEDIAN(us),MEAN(us),SD(us),MAX_RSS(B),ALLOCS
+//
+// Times are per iteration of the benchmark's workload.  MAX_RSS is how far
+// the process's peak resident set grew while the benchmark ran, and ALLOCS
+// is the number of heap objects it allocated per iteration, which is only
+// available when the runtime is built with SWIFT_RUNTIME_ENABLE_STATISTICS.
+//
+//===----------------------------------------------------------------------===//
+
+#if os(Linux)
+import Glibc
+#else
+import Darwin
+#endif
+
+/// A benchmark: a name and a function that runs its workload `N` times.
+struct BenchmarkInfo {
+  let name: String
+  let runFunction: Int -> ()
+}
+
+/// Abort the run if a benchmark computed the wrong result.
+///
+/// Every benchmark checks its result, which also keeps the optimizer from
+/// throwing the work away.
+func CheckResults(result: Bool, _ message: String) {
+  if !result {
+    fputs("Incorrect result: \(message)\n", stderr)
+    abort()
+  }
+}
+
+/// A linear congruential generator, so that every run sees the same input.
+struct LCRNG {
+  var state: UInt64
+
+  init(seed: UInt64 = 42) {
+    state = seed
+  }
+
+  mutating func next() -> Int {
+    state = state &* 6364136223846793005 &+ 1442695040888963407
+    return Int(truncatingBitPattern: state >> 33)
+  }
+}
+
+//===--- Measurement ------------------------------------------------------===//
+
+/// Nanoseconds from a monotonic clock.
+func currentNanoseconds() -> UInt64 {
+#if os(Linux)
+  var now = timespec()
+  clock_gettime(CLOCK_MONOTONIC, &now)
+  return UInt64(now.tv_sec) * 1_000_000_000 + UInt64(now.tv_nsec)
+#else
+  var info = mach_timebase_info_data_t()
+  mach_timebase_info(&info)
+  return mach_absolute_time() * UInt64(info.numer) / UInt64(info.denom)
+#endif
+}
+
+/// The peak resident set size of the process so far, in bytes.
+func maxResidentSetBytes() -> Int {
+  var usage = rusage()
+  getrusage(RUSAGE_SELF, &usage)
+#if os(Linux)
+  // Linux reports kilobytes.
+  return usage.ru_maxrss * 1024
+#else
+  return usage.ru_maxrss
+#endif
+}
+
+@_silgen_name("swift_getRuntimeStatistics")
+func _swift_getRuntimeStatistics(
+  statistics: UnsafeMutablePointer<UInt64>) -> Bool
+
+/// The number of heap objects the runtime has allocated so far, or `nil`
+/// if it does not keep statistics.
+func objectsAllocated() -> UInt64? {
+  // Large enough for every counter in RuntimeStatistics.def, of which
+  // ObjectsAllocated is the first.  The buffer comes from malloc, so reading
+  // the counters does not change them.
+  let counterCapacity = 64
+  let counters = UnsafeMutablePointer<UInt64>.alloc(counterCapacity)
+  defer { counters.dealloc(counterCapacity) }
+  if !_swift_getRuntimeStatistics(counters) {
+    return nil
+  }
+  return counters[0]
+}
+
+/// Summary statistics of the samples of one benchmark, in microseconds.
+struct SampleStatistics {
+  let minimum: Double
+  let median: Double
+  let mean: Double
+  let standardDeviation: Double
+
+  init(_ samples: [Double]) {
+    let sorted = samples.sort()
+    minimum = sorted[0]
+    let middle = sorted.count / 2
+    median = sorted.count % 2 == 0
+      ? (sorted[middle - 1] + sorted[middle]) / 2
+      : sorted[middle]
+    mean = sorted.reduce(0, combine: +) / Double(sorted.count)
+    let variance = sorted.reduce(0) {
+      $0 + ($1 - mean) * ($1 - mean)
+    } / Double(sorted.count)
+    standardDeviation = sqrt(variance)
+  }
+}
+
+//===--- Driver -----------------------------------------------------------===//
+
+struct TestConfig {
+  /// The number of timed samples of each benchmark.
+  var numSamples = 10
+
+  /// The number of iterations per sample, or `nil` to pick one so that a
+  /// sample takes about `sampleNanoseconds`.
+  var numIters: Int? = nil
+
+  var sampleNanoseconds: UInt64 = 100_000_000
+
+  /// Benchmarks to run; all of them if empty.
+  var filters: [String] = []
+
+  var listOnly = false
+  var verbose = false
+
+  init(_ arguments: [String]) {
+    for argument in arguments.dropFirst() {
+      if argument == "--list" {
+        listOnly = true
+      } else if argument == "--verbose" {
+        verbose = true
+      } else if argument.hasPrefix("--num-samples=") {
+        numSamples = TestConfig.parseCount(argument)
+      } else if argument.hasPrefix("--num-iters=") {
+        numIters = TestConfig.parseCount(argument)
+      } else if argument.hasPrefix("--sample-time-ms=") {
+        sampleNanoseconds = UInt64(TestConfig.parseCount(argument)) * 1_000_000
+      } else if argument.hasPrefix("--") {
+        TestConfig.usage("unknown option '\(argument)'")
+      } else {
+        filters.append(argument)
+      }
+    }
+  }
+
+  static func parseCount(argument: String) -> Int {
+    let value = argument.characters.split("=", maxSplit: 1).last.map(String.init)
+    guard let count = value.flatMap({ Int($0) }) where count > 0 else {
+      usage("expected a positive count in '\(argument)'")
+    }
+    return count
+  }
+
+  @noreturn
+  static func usage(message: String) {
+    fputs("error: \(message)\n", stderr)
+    fputs("usage: \(Process.arguments[0]) [--list] [--verbose] " +
+          "[--num-samples=N] [--num-iters=N] [--sample-time-ms=N] " +
+          "[benchmark...]\n", stderr)
+    exit(1)
+  }
+}
+
+/// Time `bench` running `iterations` times, in nanoseconds.
+func timeBenchmark(bench: BenchmarkInfo, _ iterations: Int) -> UInt64 {
+  let start = currentNanoseconds()
+  bench.runFunction(iterations)
+  return currentNanoseconds() - start
+}
+
+/// Run the benchmarks selected by the command line and print their results.
+func runBenchmarks(benchmarks: [BenchmarkInfo]) {
+  let config = TestConfig(Process.arguments)
+  let selected = config.filters.isEmpty
+    ? benchmarks
+    : benchmarks.filter { config.filters.contains($0.name) }
+
+  if config.listOnly {
+    for bench in selected {
+      print(bench.name)
+    }
+    return
+  }
+
+  print("#,TEST,SAMPLES,MIN(us),MEDIAN(us),MEAN(us),SD(us),MAX_RSS(B),ALLOCS")
+  var totalMinimum = 0.0
+  var totalMedian = 0.0
+  for (index, bench) in selected.enumerate() {
+    // Warm up caches, lazily initialized globals and the allocator.
+    let warmup = timeBenchmark(bench, 1)
+
+    let iterations = config.numIters ?? max(1, min(1_000_000,
+      Int(config.sampleNanoseconds / max(warmup, 1))))
+
+    let rssBefore = maxResidentSetBytes()
+    let objectsBefore = objectsAllocated()
+    var samples: [Double] = []
+    for _ in 0..<config.numSamples {
+      let elapsed = timeBenchmark(bench, iterations)
+      samples.append(Double(elapsed) / 1000 / Double(iterations))
+      if config.verbose {
+        print("    \(bench.name): \(iterations) iterations, \(elapsed) ns")
+      }
+    }
+    let rssGrowth = maxResidentSetBytes() - rssBefore
+    var allocations = "-"
+    if let before = objectsBefore, after = objectsAllocated() {
+      let runs = UInt64(iterations * config.numSamples)
+      allocations = String((after - before) / runs)
+    }
+
+    let s = SampleStatistics(samples)
+    totalMinimum += s.minimum
+    totalMedian += s.median
+    print("\(index + 1),\(bench.name),\(samples.count)," +
+          "\(Int(s.minimum)),\(Int(s.median)),\(Int(s.mean))," +
+          "\(Int(s.standardDeviation)),\(rssGrowth),\(allocations)")
+  }
+  print("")
+  print("Totals,\(Int(totalMinimum)),\(Int(totalMedian))")
+}
@@ -0,0 +1,36 @@
+//===--- main.swift - Benchmark registry ----------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Add new benchmarks here, and their sources to benchmark/CMakeLists.txt.
+runBenchmarks([
+  BenchmarkInfo(name: "ArrayAppend", runFunction: run_ArrayAppend),
+  BenchmarkInfo(name: "ArrayAppendReserved",
+                runFunction: run_ArrayAppendReserved),
+  BenchmarkInfo(name: "ArrayAppendStrings",
+                runFunction: run_ArrayAppendStrings),
+  BenchmarkInfo(name: "ClassDispatch", runFunction: run_ClassDispatch),
+  BenchmarkInfo(name: "ClassLinkedList", runFunction: run_ClassLinkedList),
+  BenchmarkInfo(name: "ClassTree", runFunction: run_ClassTree),
+  BenchmarkInfo(name: "DictionaryInsert", runFunction: run_DictionaryInsert),
+  BenchmarkInfo(name: "DictionaryLookup", runFunction: run_DictionaryLookup),
+  BenchmarkInfo(name: "DictionaryStringKeys",
+                runFunction: run_DictionaryStringKeys),
+  BenchmarkInfo(name: "SortInts", runFunction: run_SortInts),
+  BenchmarkInfo(name: "SortStrings", runFunction: run_SortStrings),
+  BenchmarkInfo(name: "StableSortInts", runFunction: run_StableSortInts),
+  BenchmarkInfo(name: "StringAppend", runFunction: run_StringAppend),
+  BenchmarkInfo(name: "StringCompare", runFunction: run_StringCompare),
+  BenchmarkInfo(name: "StringHash", runFunction: run_StringHash),
+  BenchmarkInfo(name: "StringInterpolation",
+                runFunction: run_StringInterpolation),
+  BenchmarkInfo(name: "StringUTF8View", runFunction: run_StringUTF8View),
+])
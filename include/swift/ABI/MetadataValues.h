@@ -88,10 +88,22 @@ inline ClassFlags &operator|=(ClassFlags &a, ClassFlags b) {
   return a = (a | b);
 }
 
+/// The number of words in the inline value buffer of existential containers
+/// and generic local variables.  The compiler and the runtime have to be
+/// built with the same value; see SWIFT_VALUE_BUFFER_WORDS in CMakeLists.txt.
+#ifndef SWIFT_VALUE_BUFFER_WORDS
+#define SWIFT_VALUE_BUFFER_WORDS 3
+#endif
+
 enum : unsigned {
   /// Number of words reserved in generic metadata patterns.
   NumGenericMetadataPrivateDataWords = 16,
+
+  /// Number of words in a fixed-size value buffer.
+  NumWords_ValueBuffer = SWIFT_VALUE_BUFFER_WORDS,
 };
+static_assert(NumWords_ValueBuffer >= 3,
+              "a value buffer must be able to hold three words inline");
   
 /// Kinds of protocol conformance record.
 enum class ProtocolConformanceTypeKind : unsigned {
@@ -166,8 +178,8 @@ public:
   }
   
   constexpr ProtocolConformanceReferenceKind getConformanceKind() const {
-    return ProtocolConformanceReferenceKind((Data >> ConformanceKindShift)
-                                     & ConformanceKindMask);
+    return ProtocolConformanceReferenceKind((Data & ConformanceKindMask)
+                                     >> ConformanceKindShift);
   }
   constexpr ProtocolConformanceFlags withConformanceKind(
                                   ProtocolConformanceReferenceKind pck) const {
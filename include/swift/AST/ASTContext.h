@@ -36,6 +36,7 @@
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Allocator.h"
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -80,6 +81,7 @@ namespace swift {
   class DiagnosticEngine;
   class Substitution;
   class TypeCheckerDebugConsumer;
+  class TypeCheckTimingReport;
   class DocComment;
 
   enum class KnownProtocolKind : uint8_t;
@@ -214,9 +216,33 @@ public:
   /// This state should be tracked somewhere else.
   unsigned LastCheckedExternalDefinition = 0;
 
+  /// Incremented whenever the declarations visible at module scope may have
+  /// changed, which invalidates the unqualified lookup results cached by
+  /// each source file.
+  unsigned ModuleScopeLookupGeneration = 0;
+
+  /// Incremented whenever an extension is added to a nominal type or any
+  /// conformance lookup table gains or supersedes an entry, which
+  /// invalidates the conformance lookup results cached by each table.
+  unsigned ConformanceLookupGeneration = 0;
+
   /// A consumer of type checker debug output.
   std::unique_ptr<TypeCheckerDebugConsumer> TypeCheckerDebug;
 
+  /// If set, the type checker polls this flag and stops checking function
+  /// bodies once it becomes true. The resulting AST is incomplete and should
+  /// be thrown away; this is meant for clients that rebuild the AST anyway.
+  const std::atomic<bool> *CancellationFlag = nullptr;
+
+  bool isCancellationRequested() const {
+    return CancellationFlag &&
+           CancellationFlag->load(std::memory_order_relaxed);
+  }
+
+  /// The slowest expressions and function bodies type-checked so far, if
+  /// -type-check-report was requested.
+  std::unique_ptr<TypeCheckTimingReport> TypeCheckTimings;
+
   /// Cache for names of canonical GenericTypeParamTypes.
   mutable llvm::DenseMap<unsigned, Identifier>
     CanonicalGenericTypeParamTypeNames;
@@ -478,6 +504,9 @@ public:
   /// Retrieve the declaration of Swift.==(Int, Int) -> Bool.
   FuncDecl *getEqualIntDecl(LazyResolver *resolver) const;
   
+  /// Retrieve the declaration of Swift._combineHashValues.
+  FuncDecl *getCombineHashValuesDecl(LazyResolver *resolver) const;
+
   /// Retrieve the declaration of Swift._unimplemented_initializer.
   FuncDecl *getUnimplementedInitializerDecl(LazyResolver *resolver) const;
 
@@ -813,6 +842,13 @@ public:
                             clang::ObjCInterfaceDecl *classDecl,
                             bool forInstance);
 
+  /// Retrieve the USR that was generated for the given declaration, if any.
+  Optional<StringRef> getDeclUSR(const ValueDecl *D) const;
+
+  /// Remember the USR generated for the given declaration. The string must
+  /// be allocated in this context.
+  void setDeclUSR(const ValueDecl *D, StringRef USR);
+
 private:
   friend class Decl;
   Optional<RawComment> getRawComment(const Decl *D);
@@ -0,0 +1,32 @@
+//===--- ASTMemoryStatistics.h - AST node memory use ------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_AST_ASTMEMORYSTATISTICS_H
+#define SWIFT_AST_ASTMEMORYSTATISTICS_H
+
+namespace llvm {
+  class raw_ostream;
+}
+
+namespace swift {
+  class Module;
+
+  /// \brief Print how many declarations and expressions of each kind the
+  /// source files of \p M contain, and how much memory they take up, along
+  /// with the total memory of the ASTContext.
+  ///
+  /// Only the fixed-size part of each node is counted, not trailing storage
+  /// or separately allocated arrays.
+  void printASTMemoryStatistics(Module *M, llvm::raw_ostream &OS);
+}
+
+#endif
@@ -615,6 +615,37 @@ class alignas(1 << DeclAlignInBits) Decl {
   enum { NumExtensionDeclBits = NumDeclBits + 5 };
   static_assert(NumExtensionDeclBits <= 32, "fits in an unsigned");
 
+  // The bitfields below belong to subclasses whose bits above are used up.
+  // Each used to take a word of its own, plus padding, in the subclass.
+
+  class FuncDeclExtraBitfields {
+    friend class FuncDecl;
+
+    /// If this declaration is part of an overload set, determine if we've
+    /// searched for a common overload amongst all overloads, or if we've
+    /// found one.
+    unsigned HaveSearchedForCommonOverloadReturnType : 1;
+    unsigned HaveFoundCommonOverloadReturnType : 1;
+  };
+
+  class ConstructorDeclExtraBitfields {
+    friend class ConstructorDecl;
+
+    /// The failability of this initializer, which is an OptionalTypeKind.
+    unsigned Failability : 2;
+  };
+
+  class ProtocolDeclExtraBitfields {
+    friend class ProtocolDecl;
+
+    /// True if the protocol has requirements that cannot be satisfied (e.g.
+    /// because they could not be imported from Objective-C).
+    unsigned HasMissingRequirements : 1;
+
+    /// Whether we have already set the list of inherited protocols.
+    unsigned InheritedProtocolsSet : 1;
+  };
+
 protected:
   union {
     DeclBitfields DeclBits;
@@ -639,7 +670,13 @@ protected:
     uint32_t OpaqueBits;
   };
 
-  // FIXME: Unused padding here.
+  // This fills what would otherwise be padding on 64-bit hosts.
+  union {
+    FuncDeclExtraBitfields FuncDeclExtraBits;
+    ConstructorDeclExtraBitfields ConstructorDeclExtraBits;
+    ProtocolDeclExtraBitfields ProtocolDeclExtraBits;
+    uint32_t OpaqueExtraBits;
+  };
 
   // Storage for the declaration attributes.
   DeclAttributes Attrs;
@@ -661,7 +698,7 @@ private:
 protected:
 
   Decl(DeclKind kind, llvm::PointerUnion<DeclContext *, ASTContext *> context)
-    : OpaqueBits(0), Context(context) {
+    : OpaqueBits(0), OpaqueExtraBits(0), Context(context) {
     DeclBits.Kind = unsigned(kind);
     DeclBits.Invalid = false;
     DeclBits.Implicit = false;
@@ -3367,13 +3404,6 @@ class ProtocolDecl : public NominalTypeDecl {
 
   ArrayRef<ProtocolDecl *> InheritedProtocols;
 
-  /// True if the protocol has requirements that cannot be satisfied (e.g.
-  /// because they could not be imported from Objective-C).
-  unsigned HasMissingRequirements : 1;
-
-  /// Whether we have already set the list of inherited protocols.
-  unsigned InheritedProtocolsSet : 1;
-
   bool requiresClassSlow();
 
   bool existentialConformsToSelfSlow();
@@ -3486,27 +3516,28 @@ public:
   /// with requirements that cannot be represented in Swift.
   bool hasMissingRequirements() const {
     (void)getMembers();
-    return HasMissingRequirements;
+    return ProtocolDeclExtraBits.HasMissingRequirements;
   }
 
   void setHasMissingRequirements(bool newValue) {
-    HasMissingRequirements = newValue;
+    ProtocolDeclExtraBits.HasMissingRequirements = newValue;
   }
 
   /// Set the list of inherited protocols.
   void setInheritedProtocols(ArrayRef<ProtocolDecl *> protocols) {
-    assert(!InheritedProtocolsSet && "protocols already set");
-    InheritedProtocolsSet = true;
+    assert(!ProtocolDeclExtraBits.InheritedProtocolsSet &&
+           "protocols already set");
+    ProtocolDeclExtraBits.InheritedProtocolsSet = true;
     InheritedProtocols = protocols;
   }
 
   void clearInheritedProtocols() {
-    InheritedProtocolsSet = true;
+    ProtocolDeclExtraBits.InheritedProtocolsSet = true;
     InheritedProtocols = { };
   }
 
   bool isInheritedProtocolsValid() const {
-    return InheritedProtocolsSet;
+    return ProtocolDeclExtraBits.InheritedProtocolsSet;
   }
 
   /// Retrieve the name to use for this protocol when interoperating
@@ -4657,12 +4688,6 @@ class FuncDecl : public AbstractFunctionDecl {
   ///
   /// \sa getBodyResultType()
   Type BodyResultType;
-  
-  /// If this declaration is part of an overload set, determine if we've
-  /// searched for a common overload amongst all overloads, or if we've found
-  /// one.
-  unsigned HaveSearchedForCommonOverloadReturnType : 1;
-  unsigned HaveFoundCommonOverloadReturnType : 1;
 
   /// \brief If this FuncDecl is an accessor for a property, this indicates
   /// which property and what kind of accessor.
@@ -4689,9 +4714,6 @@ class FuncDecl : public AbstractFunctionDecl {
     FuncDeclBits.Mutating = false;
     FuncDeclBits.HasDynamicSelf = false;
     FuncDeclBits.ForcedStaticDispatch = false;
-        
-    HaveSearchedForCommonOverloadReturnType = false;
-    HaveFoundCommonOverloadReturnType = false;
   }
 
   static FuncDecl *createImpl(ASTContext &Context, SourceLoc StaticLoc,
@@ -4744,16 +4766,16 @@ public:
   }
   
   bool getHaveSearchedForCommonOverloadReturnType() {
-    return HaveSearchedForCommonOverloadReturnType;
+    return FuncDeclExtraBits.HaveSearchedForCommonOverloadReturnType;
   }
   void setHaveSearchedForCommonOverloadReturnType(bool b = true) {
-    HaveSearchedForCommonOverloadReturnType = b;
+    FuncDeclExtraBits.HaveSearchedForCommonOverloadReturnType = b;
   }
   bool getHaveFoundCommonOverloadReturnType() {
-    return HaveFoundCommonOverloadReturnType;
+    return FuncDeclExtraBits.HaveFoundCommonOverloadReturnType;
   }
   void setHaveFoundCommonOverloadReturnType(bool b = true) {
-    HaveFoundCommonOverloadReturnType = b;
+    FuncDeclExtraBits.HaveFoundCommonOverloadReturnType = b;
   }
 
   /// \returns true if this is non-mutating due to applying a 'mutating'
@@ -5154,9 +5176,6 @@ enum class CtorInitializerKind {
 class ConstructorDecl : public AbstractFunctionDecl {
   friend class AbstractFunctionDecl;
 
-  /// The failability of this initializer, which is an OptionalTypeKind.
-  unsigned Failability : 2;
-
   /// The location of the '!' or '?' for a failable initializer.
   SourceLoc FailabilityLoc;
 
@@ -5297,7 +5316,8 @@ public:
 
   /// Determine the failability of the initializer.
   OptionalTypeKind getFailability() const {
-    return static_cast<OptionalTypeKind>(Failability);
+    return static_cast<OptionalTypeKind>(
+             ConstructorDeclExtraBits.Failability);
   }
 
   /// Retrieve the location of the '!' or '?' in a failable initializer.
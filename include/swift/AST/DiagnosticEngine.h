@@ -28,6 +28,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include <string>
 #include <utility>
 
@@ -414,6 +415,16 @@ namespace swift {
 
     bool ShowDiagnosticsAfterFatalError = false;
 
+    /// Drop diagnostics that repeat an earlier one, along with their notes.
+    bool SuppressDuplicateDiagnostics = false;
+
+    /// Set while the notes of a dropped duplicate diagnostic are coming in.
+    bool SuppressingNotes = false;
+
+    /// \brief The ID, location, and arguments of each diagnostic emitted so
+    /// far, when duplicates are suppressed.
+    llvm::StringSet<> EmittedDiagnosticKeys;
+
     /// \brief The currently active diagnostic, if there is one.
     Optional<Diagnostic> ActiveDiagnostic;
 
@@ -450,6 +461,13 @@ namespace swift {
       ShowDiagnosticsAfterFatalError = Val;
     }
 
+    /// Drop diagnostics with the same ID, location, and arguments as one that
+    /// was already emitted. Notes attached to a dropped diagnostic are dropped
+    /// too.
+    void setSuppressDuplicateDiagnostics(bool Val = true) {
+      SuppressDuplicateDiagnostics = Val;
+    }
+
     void resetHadAnyError() {
       HadAnyError = false;
       FatalState = FatalErrorState::None;
@@ -74,6 +74,11 @@ public:
   /// used to force-load this module.
   std::string ForceLoadSymbolName;
 
+  /// If non-empty, the code generation of a primary file is split across the
+  /// -num-threads threads, and the partial object files are combined with
+  /// this relocatable linker.
+  std::string ParallelCodeGenLinker;
+
   /// The kind of compilation we should do.
   IRGenOutputKind OutputKind : 3;
 
@@ -84,6 +89,9 @@ public:
   /// Whether or not to run optimization passes.
   unsigned Optimize : 1;
 
+  /// Whether the optimization passes should favor small code over speed.
+  unsigned OptimizeForSize : 1;
+
   /// Whether we should emit debug info.
   IRGenDebugInfoKind DebugInfoKind : 2;
 
@@ -123,23 +131,50 @@ public:
   /// Instrument code to generate profiling information.
   unsigned GenerateProfile : 1;
 
+  /// Update the profile counters of every loop iteration in memory, instead
+  /// of once when the loop exits.
+  unsigned DisableProfileCounterPromotion : 1;
+
   /// Whether we should embed the bitcode file.
   IRGenEmbedMode EmbedMode : 2;
 
   /// For resilient access to super's members for testing.
   unsigned ForceResilientSuperDispatch: 1;
 
+  /// Emit a per-call-site cache of the last conformance found by casts of
+  /// class instances to protocol types.
+  unsigned EmitDynamicCastInlineCaches : 1;
+
+  /// Emit only a declaration, identified by its mangled name, for the debug
+  /// info of Swift types that are defined in another module.
+  unsigned DebugInfoExternalTypeDeclarations : 1;
+
+  /// Instantiate the witness tables of dependent conformances in this module
+  /// through the runtime, once per conforming type.
+  unsigned EnableGenericWitnessTables : 1;
+
+  /// Write a report of the size of each emitted function next to each
+  /// output file, attributing specializations to the functions they were
+  /// specialized from.
+  unsigned EmitCodeSizeReport : 1;
+
   /// List of backend command-line options for -embed-bitcode.
   std::vector<uint8_t> CmdArgs;
 
   IRGenOptions() : OutputKind(IRGenOutputKind::LLVMAssembly), Verify(true),
-                   Optimize(false), DebugInfoKind(IRGenDebugInfoKind::None),
+                   Optimize(false), OptimizeForSize(false),
+                   DebugInfoKind(IRGenDebugInfoKind::None),
                    UseJIT(false), DisableLLVMOptzns(false),
                    DisableLLVMARCOpts(false), DisableLLVMSLPVectorizer(false),
                    DisableFPElim(true), Playground(false),
                    EmitStackPromotionChecks(false), GenerateProfile(false),
+                   DisableProfileCounterPromotion(false),
                    EmbedMode(IRGenEmbedMode::None),
-                   ForceResilientSuperDispatch(false)
+                   ForceResilientSuperDispatch(false),
+                   EmitDynamicCastInlineCaches(false),
+                   DebugInfoExternalTypeDeclarations(false),
+                   EnableGenericWitnessTables(false),
+                   EmitCodeSizeReport(false)
                    {}
   
   /// Gets the name of the specified output filename.
@@ -27,6 +27,7 @@ class Decl;
 class DeclContext;
 class ExtensionDecl;
 class Identifier;
+class IterableDeclContext;
 class NominalTypeDecl;
 class NormalProtocolConformance;
 class ProtocolConformance;
@@ -138,6 +139,20 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Populates \p members with the members of \p IDC whose base name is
+  /// \p name, without loading any of the other members.
+  ///
+  /// The implementation should \em not add the members to \p IDC.
+  ///
+  /// \returns false if members cannot be loaded by name, in which case the
+  /// caller must fall back to loadAllMembers.
+  virtual bool
+  loadNamedMembers(const IterableDeclContext *IDC, Identifier name,
+                   uint64_t contextData,
+                   SmallVectorImpl<ValueDecl *> &members) {
+    return false;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
   /// The implementation should \em not call setConformances on \p D.
@@ -26,6 +26,7 @@
 #include "swift/Basic/SourceLoc.h"
 #include "swift/Basic/STLExtras.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
@@ -275,6 +276,18 @@ private:
   /// The magic __dso_handle variable.
   llvm::PointerIntPair<VarDecl *, 2, OptionSet<Flags>> DSOHandleAndFlags;
 
+  /// The results of name lookups into this module and its re-exports made
+  /// on behalf of other modules, keyed on the name, the import access path,
+  /// and the lookup options.
+  ///
+  /// \see namelookup::lookupInModule
+  llvm::DenseMap<std::pair<DeclName, std::pair<Identifier, unsigned>>,
+                 TinyPtrVector<ValueDecl *>> ImportLookupCache;
+
+  /// The ASTContext's ModuleScopeLookupGeneration when ImportLookupCache was
+  /// last known to be valid.
+  unsigned ImportLookupCacheGeneration = 0;
+
   ModuleDecl(Identifier name, ASTContext &ctx);
 
 public:
@@ -294,6 +307,12 @@ public:
   void addFile(FileUnit &newFile);
   void removeFile(FileUnit &existingFile);
 
+  /// Free the name lookup caches of this module and its source files.
+  ///
+  /// They are rebuilt on demand, so this is only worthwhile once name lookup
+  /// into the module is mostly done, such as after SILGen.
+  void releaseLookupCaches();
+
   /// Convenience accessor for clients that know what kind of file they're
   /// dealing with.
   SourceFile &getMainSourceFile(SourceFileKind expectedKind) const;
@@ -431,6 +450,24 @@ public:
   void
   getImportedModulesForLookup(SmallVectorImpl<ImportedModule> &imports) const;
 
+  /// Retrieve the cached results of a lookup of \p name in this module and
+  /// its re-exports, or null if there are none.
+  ///
+  /// \param options Distinguishes lookups whose results may differ, such as
+  /// lookups with different resolution kinds.
+  ///
+  /// This is a performance hack. Do not use for anything but name lookup.
+  const TinyPtrVector<ValueDecl *> *
+  getCachedImportLookup(AccessPathTy accessPath, DeclName name,
+                        unsigned options);
+
+  /// Cache the results of a lookup of \p name in this module and its
+  /// re-exports.
+  ///
+  /// The results must not depend on the context the lookup was made from.
+  void cacheImportLookup(AccessPathTy accessPath, DeclName name,
+                         unsigned options, ArrayRef<ValueDecl *> results);
+
   /// Finds all top-level decls of this module.
   ///
   /// This does a simple local lookup, not recursively looking through imports.
@@ -619,6 +656,16 @@ public:
     return nullptr;
   }
 
+  /// Look up a type named \p name that this file declares as a member of
+  /// \p parent or of an extension of \p parent.
+  ///
+  /// This is a fast path for cross-references; returning null only means
+  /// that the caller has to search the members of \p parent.
+  virtual TypeDecl *lookupNestedType(Identifier name,
+                                     const NominalTypeDecl *parent) const {
+    return nullptr;
+  }
+
   /// Find ValueDecls in the module and pass them to the given consumer object.
   ///
   /// This does a simple local lookup, not recursively looking through imports.
@@ -790,9 +837,7 @@ public:
   DerivedFileUnit(ModuleDecl &M);
   ~DerivedFileUnit() = default;
 
-  void addDerivedDecl(FuncDecl *FD) {
-    DerivedDecls.push_back(FD);
-  }
+  void addDerivedDecl(FuncDecl *FD);
 
   void lookupValue(ModuleDecl::AccessPathTy accessPath, DeclName name,
                    NLKind lookupKind,
@@ -853,6 +898,15 @@ private:
   std::unique_ptr<LookupCache> Cache;
   LookupCache &getCache() const;
 
+  /// The module-scope results of unqualified lookups made from this file,
+  /// keyed on the name and the lookup options.
+  llvm::DenseMap<std::pair<DeclName, unsigned>, TinyPtrVector<ValueDecl *>>
+    UnqualifiedLookupCache;
+
+  /// The ASTContext's ModuleScopeLookupGeneration when
+  /// UnqualifiedLookupCache was last known to be valid.
+  unsigned UnqualifiedLookupCacheGeneration = 0;
+
   /// This is the list of modules that are imported by this module.
   ///
   /// This is filled in by the Name Binding phase.
@@ -881,6 +935,33 @@ private:
   /// this source file so far.
   llvm::MD5 InterfaceHash;
 
+  /// The interface hashes of the declarations being parsed, innermost last.
+  ///
+  /// \sa beginDeclInterfaceHash
+  struct ActiveDeclInterfaceHash {
+    llvm::MD5 Full;
+    llvm::MD5 Own;
+  };
+  SmallVector<ActiveDeclInterfaceHash, 4> ActiveDeclInterfaceHashes;
+
+public:
+  /// The interface hashes of a single declaration.
+  struct DeclInterfaceHash {
+    /// A hash of all of the declaration's interface tokens.
+    llvm::MD5::MD5Result Full;
+
+    /// A hash of the interface tokens that don't belong to any nested
+    /// declaration, such as a type's name, generic parameters, and
+    /// inheritance clause.
+    llvm::MD5::MD5Result Own;
+  };
+
+private:
+  /// The interface hashes recorded for declarations in this file.
+  ///
+  /// \sa beginDeclInterfaceHash
+  llvm::DenseMap<const Decl *, DeclInterfaceHash> DeclInterfaceHashes;
+
   /// \brief The ID for the memory buffer containing this file's source.
   ///
   /// May be -1, to indicate no association with a buffer.
@@ -942,6 +1023,23 @@ public:
 
   void clearLookupCache();
 
+  /// Like clearLookupCache(), but also frees the memory of the cached
+  /// unqualified lookups made from this file.
+  void releaseLookupCaches();
+
+  /// Retrieve the cached module-scope results of an unqualified lookup of
+  /// \p name from this file, or null if there are none.
+  ///
+  /// \param options Distinguishes lookups whose results may differ, such
+  /// as type-only lookups.
+  const TinyPtrVector<ValueDecl *> *
+  getCachedUnqualifiedLookup(DeclName name, unsigned options);
+
+  /// Cache the module-scope results of an unqualified lookup of \p name
+  /// from this file.
+  void cacheUnqualifiedLookup(DeclName name, unsigned options,
+                              ArrayRef<ValueDecl *> results);
+
   void cacheVisibleDecls(SmallVectorImpl<ValueDecl *> &&globals) const;
   const SmallVectorImpl<ValueDecl *> &getCachedVisibleDecls() const;
 
@@ -1081,10 +1179,56 @@ public:
     // Add null byte to separate tokens.
     uint8_t a[1] = {0};
     InterfaceHash.update(a);
+
+    if (ActiveDeclInterfaceHashes.empty())
+      return;
+    for (auto &active : ActiveDeclInterfaceHashes) {
+      active.Full.update(token);
+      active.Full.update(a);
+    }
+    ActiveDeclInterfaceHashes.back().Own.update(token);
+    ActiveDeclInterfaceHashes.back().Own.update(a);
+  }
+
+  /// Starts hashing the interface tokens of a declaration that is about to be
+  /// parsed, in addition to those of the file as a whole. This is used to
+  /// track dependencies on individual declarations rather than whole files.
+  ///
+  /// Declarations may nest; each call must be balanced by a call to
+  /// endDeclInterfaceHash.
+  void beginDeclInterfaceHash() {
+    ActiveDeclInterfaceHashes.emplace_back();
+  }
+
+  /// Finishes the innermost declaration started by beginDeclInterfaceHash,
+  /// and records its hashes for each of \p decls that doesn't have any yet.
+  void endDeclInterfaceHash(ArrayRef<Decl *> decls);
+
+  /// Returns the hashes recorded for \p D by endDeclInterfaceHash, or null if
+  /// there are none.
+  const DeclInterfaceHash *getDeclInterfaceHash(const Decl *D) const {
+    auto known = DeclInterfaceHashes.find(D);
+    if (known == DeclInterfaceHashes.end())
+      return nullptr;
+    return &known->second;
   }
 
-  const llvm::MD5 &getInterfaceHashState() { return InterfaceHash; }
-  void setInterfaceHashState(const llvm::MD5 &state) { InterfaceHash = state; }
+  /// A snapshot of the file's interface hash and of the hashes of the
+  /// declarations being parsed, for discarding tokens that were hashed since.
+  struct InterfaceHashState {
+    llvm::MD5 File;
+    SmallVector<ActiveDeclInterfaceHash, 4> ActiveDecls;
+  };
+
+  InterfaceHashState getInterfaceHashState() const {
+    return { InterfaceHash, ActiveDeclInterfaceHashes };
+  }
+  void setInterfaceHashState(const InterfaceHashState &state) {
+    assert(state.ActiveDecls.size() == ActiveDeclInterfaceHashes.size() &&
+           "restoring the hashes of different declarations");
+    InterfaceHash = state.File;
+    ActiveDeclInterfaceHashes = state.ActiveDecls;
+  }
 
   void getInterfaceHash(llvm::SmallString<32> &str) {
     llvm::MD5::MD5Result result;
@@ -19,6 +19,7 @@
 #define SWIFT_AST_SILOPTIONS_H
 
 #include <string>
+#include <vector>
 #include <climits>
 
 namespace swift {
@@ -48,12 +49,18 @@ public:
     None,
     Debug,
     Optimize,
+    OptimizeForSize,
     OptimizeUnchecked
   };
 
   /// Controls how  perform SIL linking.
   LinkingMode LinkMode = LinkNormal;
 
+  /// Don't eagerly deserialize the bodies of functions from other modules.
+  /// Only their declarations are linked up front, and a body is read when
+  /// the inliner or the generic specializer wants to use it.
+  bool LinkBodiesOnDemand = false;
+
   /// Remove all runtime assertions during optimizations.
   bool RemoveRuntimeAsserts = false;
 
@@ -95,11 +102,46 @@ public:
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// If non-empty, read execution counts from this indexed profile and attach
+  /// them to the generated SIL.
+  std::string UseProfile;
+
+  /// Names of the types and functions of this module whose specializations
+  /// are kept public, so that clients can call them. The standard library
+  /// exports a built-in list of specializations in addition to these.
+  std::vector<std::string> ExportedSpecializations;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   StringRef ExternalPassPipelineFilename;
 
+  /// If non-empty, write a JSON profile of all SIL pass runs to this file.
+  StringRef PassProfileFilename;
+
+  /// Record the profile of all SIL pass runs even if it is not written to a
+  /// file, so that a tool can read it with takeSILPassProfile().
+  bool RecordPassProfile = false;
+
   /// Use super_method for native super method calls instead of function_ref.
   bool UseNativeSuperMethod = false;
+
+  /// Pass the parameters of ordinary native functions at +0 (guaranteed)
+  /// instead of +1, so that callers don't need to copy their arguments.
+  /// This changes the calling convention, so all modules of a program must be
+  /// compiled with the same setting.
+  bool EnableGuaranteedNormalArguments = false;
+
+  /// Assume that the module is linked into an executable and that nothing
+  /// outside of it refers to its symbols, except for the entry point and
+  /// symbols which are reached through the Objective-C runtime. This lets
+  /// dead function elimination drop unused public functions and vtable and
+  /// witness table entries. Only honored in whole-module mode.
+  bool WholeProgram = false;
+
+  /// When the performance inliner inlines a transparent function or a
+  /// function from the standard library, attribute the inlined code to the
+  /// call site, as mandatory inlining does, instead of creating inlined
+  /// debug scopes for it. This shrinks the debug info of optimized builds.
+  bool CollapseInlinedStdlibDebugScopes = false;
 };
 
 } // end namespace swift
@@ -0,0 +1,91 @@
+//===--- TypeCheckTimingReport.h - Slowest type-checked code ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the TypeCheckTimingReport class, which collects the
+// expressions and function bodies that took the longest to type-check for
+// the -type-check-report frontend option.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_AST_TYPE_CHECK_TIMING_REPORT_H
+#define SWIFT_AST_TYPE_CHECK_TIMING_REPORT_H
+
+#include "swift/Basic/LLVM.h"
+#include "swift/Basic/SourceLoc.h"
+#include <string>
+#include <vector>
+
+namespace swift {
+
+class SourceManager;
+
+/// \brief Collects the slowest expressions and function bodies seen by the
+/// type checker.
+///
+/// Only the \c Limit slowest entries are kept. The report is written as JSON
+/// Lines, one object per entry, so that the frontend jobs of a single driver
+/// invocation can all append to the same file.
+class TypeCheckTimingReport {
+public:
+  enum class EntryKind {
+    /// A top-level call to TypeChecker::typeCheckExpression.
+    Expression,
+    /// The body of a function, initializer or deinitializer.
+    FunctionBody,
+    /// The body of a multi-statement closure.
+    ClosureBody,
+  };
+
+  struct Entry {
+    EntryKind Kind;
+    SourceLoc Loc;
+    double Milliseconds;
+
+    /// Constraint solver work done for this entry, summed over all of the
+    /// constraint systems it solved.
+    unsigned NumStatesExplored;
+    unsigned NumDisjunctions;
+
+    /// The solver memory that was released when those constraint systems
+    /// were destroyed.
+    uint64_t NumSolverBytesFreed;
+
+    /// The name of the function, if this is a function body.
+    std::string Name;
+  };
+
+private:
+  unsigned Limit;
+
+  /// A min-heap on Milliseconds, so that the fastest entry kept is the one
+  /// replaced.
+  std::vector<Entry> Entries;
+
+public:
+  explicit TypeCheckTimingReport(unsigned limit) : Limit(limit) {}
+
+  /// Record an entry, dropping the fastest one if there are too many.
+  void record(Entry &&entry);
+
+  /// Write the report, slowest entry first.
+  void write(raw_ostream &OS, const SourceManager &SM) const;
+
+  /// Append the report to the file at \p path.
+  ///
+  /// \returns true on error.
+  bool appendToFile(StringRef path, const SourceManager &SM,
+                    std::string &error) const;
+};
+
+} // namespace swift
+
+#endif // SWIFT_AST_TYPE_CHECK_TIMING_REPORT_H
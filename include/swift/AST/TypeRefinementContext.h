@@ -157,6 +157,15 @@ private:
 
   std::vector<TypeRefinementContext *> Children;
 
+  /// Whether the children are in source order and don't overlap, so that
+  /// they can be binary-searched by location.
+  enum class ChildOrder : uint8_t { Unknown, Ordered, Unordered };
+  ChildOrder ChildrenOrder = ChildOrder::Unknown;
+
+  /// Determines whether the children can be binary-searched, computing it if
+  /// it is not known.
+  bool areChildrenOrdered(SourceManager &SM);
+
   TypeRefinementContext(ASTContext &Ctx, IntroNode Node,
                         TypeRefinementContext *Parent, SourceRange SrcRange,
                         const VersionRange &Versions);
@@ -237,6 +246,7 @@ public:
   void addChild(TypeRefinementContext *Child) {
     assert(Child->getSourceRange().isValid());
     Children.push_back(Child);
+    ChildrenOrder = ChildOrder::Unknown;
   }
 
   /// Returns the inner-most TypeRefinementContext descendant of this context
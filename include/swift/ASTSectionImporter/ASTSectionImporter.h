@@ -23,12 +23,32 @@
 namespace swift {
   class SerializedModuleLoader;
 
+  /// \brief A swift module found in an AST section.
+  struct ASTSectionModule {
+    /// The access path of the module.
+    StringRef Name;
+    /// The serialized module, as a range of the section.
+    StringRef Data;
+  };
+
+  /// \brief Provided a memory buffer with an entire Mach-O __apple_ast
+  /// section, this function finds the swift modules in it and appends
+  /// them to the vector modules. Only the control block of each module is
+  /// read, and nothing is copied, so this stays cheap for sections with
+  /// hundreds of modules.
+  /// \return true if successful.
+  bool indexASTSection(StringRef Data,
+                       SmallVectorImpl<ASTSectionModule> &modules);
+
   /// \brief Povided a memory buffer with an entire Mach-O __apple_ast
-  /// section, this function makes memory buffer copies of all swift
-  /// modules found in it and registers them using
-  /// registerMemoryBuffer() so they can be found by loadModule(). The
-  /// access path of all modules found in the section is appended to
-  /// the vector foundModules.
+  /// section, this function registers memory buffers referring to all
+  /// swift modules found in it using registerMemoryBuffer() so they can
+  /// be found by loadModule(). The access path of all modules found in
+  /// the section is appended to the vector foundModules.
+  ///
+  /// The modules are not deserialized until they are imported, so clients
+  /// should only import the modules they need rather than all the modules
+  /// in foundModules.
   /// \return true if successful.
   bool parseASTSection(SerializedModuleLoader* SML, StringRef Data,
                        SmallVectorImpl<std::string> &foundModules);
@@ -129,6 +129,16 @@ protected:
   /// Invokes \c remove on all keys.
   void removeAll();
 
+  /// Sets the total cost of the values the cache may hold.
+  ///
+  /// \param Limit The cost limit, in the units passed to \c setAndRetain().
+  /// Zero means there is no limit.
+  ///
+  /// Whenever the total cost exceeds the limit, the least recently used keys
+  /// are removed, except for the most recently used one.  The cache may also
+  /// evict entries under memory pressure regardless of the limit.
+  void setCostLimit(size_t Limit);
+
   /// Destroys cache.
   void destroy();
 };
@@ -192,6 +202,12 @@ public:
     removeAll();
   }
 
+  /// Bounds the total cost of the cached values, evicting the least
+  /// recently used ones when it is exceeded; zero removes the bound.
+  void setCostLimit(size_t Limit) {
+    CacheImpl::setCostLimit(Limit);
+  }
+
 private:
   static uintptr_t keyHash(void *Key, void *UserData) {
     return KeyInfoT::getHashValue(*static_cast<KeyT*>(Key));
@@ -659,14 +659,11 @@ private:
   /// that it's known to contain enough capacity for them.
   void appendConstantBitsReserved(size_t numBits, bool addOnes);
 
-  /// Append bits from the given array to this vector.
+  /// Append bits from the given array to this vector, given that it's
+  /// known to contain enough capacity for them all.  The bits are
+  /// shifted into place a whole chunk at a time.
   void appendReserved(size_t numBits, const ChunkType *nextChunk);
 
-  /// Append bits to this vector, given that it's known to contain
-  /// enough capacity for them all.
-  void appendReserved(size_t numBits,
-                llvm::function_ref<ChunkType(size_t numBitsWanted)> generator);
-
   /// The slow cases of equality-checking.
   static bool equalsSlowCase(const ClusteredBitVector &lhs,
                              const ClusteredBitVector &rhs);
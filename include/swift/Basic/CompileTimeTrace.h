@@ -0,0 +1,135 @@
+//===--- CompileTimeTrace.h - Chrome trace of compiler phases ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the process-wide span recorder behind the
+// -trace-compile-time option. Spans are written in the Chrome trace event
+// "JSON array" format, which can be loaded into chrome://tracing.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_COMPILE_TIME_TRACE_H
+#define SWIFT_BASIC_COMPILE_TIME_TRACE_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include <cstdint>
+#include <string>
+
+namespace swift {
+
+/// \brief Records timed spans of compiler work for -trace-compile-time.
+///
+/// Recording is off until enable() is called, and every entry point is
+/// cheap when it is off. Spans may be recorded from any thread.
+///
+/// The trace file uses the "JSON array" variant of the trace event format,
+/// in which the closing bracket is optional. Each process appends all of its
+/// events with a single write, so the driver and all of its frontend jobs
+/// can share one file and produce a single merged trace.
+class CompileTimeTrace {
+  static bool Enabled;
+  static bool PhaseTotalsEnabled;
+
+public:
+  /// The category of the spans that are totalled by enablePhaseTotals().
+  static constexpr const char *PhaseCategory = "frontend";
+
+  /// Start recording spans in this process.
+  static void enable();
+
+  /// Start adding up the time spent in each span of the PhaseCategory, for
+  /// appendPhaseTotals(). Other spans are not recorded unless enable() is
+  /// called as well.
+  static void enablePhaseTotals();
+
+  static bool isEnabled() { return Enabled; }
+
+  /// Whether spans in \p category are recorded in any way.
+  static bool isEnabled(StringRef category) {
+    return Enabled || (PhaseTotalsEnabled && category == PhaseCategory);
+  }
+
+  /// The current time in microseconds, on a clock that is shared between
+  /// processes on the same machine.
+  static uint64_t now();
+
+  /// Record a complete span.
+  ///
+  /// \p threadID identifies the lane the span is drawn in; by default the
+  /// calling thread is used.
+  static void record(StringRef category, StringRef name,
+                     uint64_t startMicros, uint64_t endMicros,
+                     Optional<uint64_t> threadID = None);
+
+  /// Create \p path containing just the start of an empty trace,
+  /// discarding any previous contents.
+  static bool startFile(StringRef path, std::string &error);
+
+  /// Append the spans recorded so far to \p path, labeling this process
+  /// with \p processName. If the file does not exist yet it is started.
+  static bool appendToFile(StringRef path, StringRef processName,
+                           std::string &error);
+
+  /// Append one line of JSON to \p path with the total time spent in each
+  /// phase, in microseconds, labeling this process with \p processName.
+  ///
+  /// This is the frontend's part of a -progress-output stream.
+  static bool appendPhaseTotals(StringRef path, StringRef processName,
+                                std::string &error);
+};
+
+/// \brief An RAII object that records a span for its lifetime when
+/// compile-time tracing is enabled.
+class CompileTimeTraceScope {
+  StringRef Category;
+  std::string Name;
+  uint64_t Start = 0;
+  bool Active;
+
+public:
+  CompileTimeTraceScope(StringRef category, StringRef name)
+    : Category(category), Active(CompileTimeTrace::isEnabled(category)) {
+    if (Active) {
+      Name = name;
+      Start = CompileTimeTrace::now();
+    }
+  }
+
+  /// Only compute the span name when tracing is enabled.
+  CompileTimeTraceScope(StringRef category,
+                        llvm::function_ref<std::string()> getName)
+    : Category(category), Active(CompileTimeTrace::isEnabled(category)) {
+    if (Active) {
+      Name = getName();
+      Start = CompileTimeTrace::now();
+    }
+  }
+
+  CompileTimeTraceScope(const CompileTimeTraceScope &) = delete;
+  CompileTimeTraceScope &operator=(const CompileTimeTraceScope &) = delete;
+
+  /// End the span before the scope is left.
+  void finish() {
+    if (Active)
+      CompileTimeTrace::record(Category, Name, Start, CompileTimeTrace::now());
+    Active = false;
+  }
+
+  ~CompileTimeTraceScope() {
+    finish();
+  }
+};
+
+} // end namespace swift
+
+#endif
@@ -348,23 +348,113 @@ std::string mangleNode(const NodePointer &root);
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
-struct NodeFactory {
-  static NodePointer create(Node::Kind K) {
-    return NodePointer(new Node(K));
+/// \brief A bump-pointer arena for the nodes built by a DemangleSession.
+///
+/// Each node and its reference count are carved out of the arena's slabs
+/// rather than allocated separately from the heap. Every node keeps its
+/// arena alive, so a parse tree may outlive the session that built it.
+class NodeArena {
+  static const size_t SlabSize = 16384;
+
+  std::vector<void *> Slabs;
+  size_t CurSlab = 0;
+  char *CurPtr = nullptr;
+  char *End = nullptr;
+
+public:
+  NodeArena() {}
+  NodeArena(const NodeArena &) = delete;
+  NodeArena &operator=(const NodeArena &) = delete;
+  ~NodeArena();
+
+  void *allocate(size_t Size, size_t Alignment);
+
+  /// Make the arena's memory available for reuse. Only valid when no node
+  /// allocated from it is alive.
+  void reset();
+};
+
+/// \brief A stateful allocator over a NodeArena, as the shared_ptr control
+/// blocks of arena nodes need. Deallocation does nothing; the memory goes
+/// away with the arena.
+template <typename T>
+struct NodeArenaAllocator {
+  typedef T value_type;
+
+  std::shared_ptr<NodeArena> Arena;
+
+  explicit NodeArenaAllocator(std::shared_ptr<NodeArena> Arena)
+    : Arena(std::move(Arena)) {}
+  template <typename U>
+  NodeArenaAllocator(const NodeArenaAllocator<U> &Other)
+    : Arena(Other.Arena) {}
+
+  T *allocate(size_t N) {
+    return static_cast<T *>(Arena->allocate(N * sizeof(T), alignof(T)));
   }
-  static NodePointer create(Node::Kind K, Node::IndexType Index) {
-    return NodePointer(new Node(K, Index));
+  void deallocate(T *, size_t) {}
+
+  template <typename U>
+  bool operator==(const NodeArenaAllocator<U> &Other) const {
+    return Arena == Other.Arena;
   }
-  static NodePointer create(Node::Kind K, llvm::StringRef Text) {
-    return NodePointer(new Node(K, Text));
+  template <typename U>
+  bool operator!=(const NodeArenaAllocator<U> &Other) const {
+    return Arena != Other.Arena;
   }
-  static NodePointer create(Node::Kind K, std::string &&Text) {
-    return NodePointer(new Node(K, std::move(Text)));
+};
+
+/// \brief Demangles many symbols in a row, reusing memory between calls.
+///
+/// While a call on the session runs, every node is allocated from the
+/// session's NodeArena. The arena's slabs are recycled by the next call
+/// once all the nodes of the previous ones have been released. A session is
+/// not thread-safe; use one per thread.
+class DemangleSession {
+  std::shared_ptr<NodeArena> Arena;
+
+  void prepareArena();
+
+public:
+  NodePointer
+  demangleSymbolAsNode(const char *MangledName, size_t MangledNameLength,
+                       const DemangleOptions &Options = DemangleOptions());
+
+  NodePointer
+  demangleTypeAsNode(const char *MangledName, size_t MangledNameLength,
+                     const DemangleOptions &Options = DemangleOptions());
+
+  std::string
+  demangleSymbolAsString(const char *MangledName, size_t MangledNameLength,
+                         const DemangleOptions &Options = DemangleOptions());
+
+  std::string
+  demangleSymbolAsString(llvm::StringRef MangledName,
+                         const DemangleOptions &Options = DemangleOptions()) {
+    return demangleSymbolAsString(MangledName.data(), MangledName.size(),
+                                  Options);
   }
+
+  std::string
+  demangleTypeAsString(const char *MangledName, size_t MangledNameLength,
+                       const DemangleOptions &Options = DemangleOptions());
+};
+
+struct NodeFactory {
+  static NodePointer create(Node::Kind K);
+  static NodePointer create(Node::Kind K, Node::IndexType Index);
+  static NodePointer create(Node::Kind K, llvm::StringRef Text);
+  static NodePointer create(Node::Kind K, std::string &&Text);
   template <size_t N>
   static NodePointer create(Node::Kind K, const char (&Text)[N]) {
-    return NodePointer(new Node(K, llvm::StringRef(Text)));
+    return create(K, llvm::StringRef(Text));
   }
+
+private:
+  /// Allocate a node from the arena of the innermost DemangleSession call on
+  /// this thread, or from the heap outside of one.
+  template <typename... ArgTypes>
+  static NodePointer allocate(ArgTypes &&... Args);
 };
 
   /// A class for printing to a std::string.
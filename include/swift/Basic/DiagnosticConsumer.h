@@ -79,6 +79,18 @@ protected:
 
 public:
   virtual ~DiagnosticConsumer();
+
+  /// \brief Invoked before a diagnostic is formatted, to find out whether
+  /// this consumer is going to use its text.
+  ///
+  /// Producing the text can require printing types and declarations, so the
+  /// DiagnosticEngine skips it when no consumer needs it. A consumer that
+  /// returns false here still receives the diagnostic through
+  /// handleDiagnostic(), but possibly with empty text.
+  virtual bool needsDiagnosticText(SourceLoc Loc, DiagnosticKind Kind,
+                                   const DiagnosticInfo &Info) {
+    return true;
+  }
   
   /// \brief Invoked whenever the frontend emits a diagnostic.
   ///
@@ -102,6 +114,9 @@ public:
 /// \brief DiagnosticConsumer that discards all diagnostics.
 class NullDiagnosticConsumer : public DiagnosticConsumer {
 public:
+  bool needsDiagnosticText(SourceLoc Loc, DiagnosticKind Kind,
+                           const DiagnosticInfo &Info) override;
+
   void handleDiagnostic(SourceManager &SM, SourceLoc Loc,
                         DiagnosticKind Kind, StringRef Text,
                         const DiagnosticInfo &Info) override;
@@ -32,6 +32,9 @@ public:
   /// Keep emitting subsequent diagnostics after a fatal error.
   bool ShowDiagnosticsAfterFatalError = false;
 
+  /// Drop diagnostics that repeat an earlier one at the same location.
+  bool SuppressDuplicateDiagnostics = false;
+
   /// When emitting fixits as code edits, apply all fixits from diagnostics
   /// without any filtering.
   bool FixitCodeForAllDiagnostics = false;
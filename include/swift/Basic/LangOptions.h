@@ -136,10 +136,22 @@ namespace swift {
     /// ID of the current process for the purposes of AST verification.
     unsigned ASTVerifierProcessId = 1U;
 
+    /// Percentage of function bodies the AST verifier checks. The rest are
+    /// skipped, trading coverage for compile time in asserts builds.
+    unsigned ASTVerifierSamplePercent = 100U;
+
+    /// Seed used to pick the function bodies verified in sampled mode.
+    unsigned ASTVerifierSampleSeed = 0U;
+
     /// \brief The upper bound, in bytes, of temporary data that can be
     /// allocated by the constraint solver.
     unsigned SolverMemoryThreshold = 15000000;
 
+    /// \brief Attempt the terms of each disjunction in ranked order: favored
+    /// terms, then overloads accepting the argument types known so far,
+    /// then the remaining non-generic and finally generic overloads.
+    bool SolverRankDisjunctionChoices = false;
+
     /// \brief Perform all dynamic allocations using malloc/free instead of
     /// optimized custom allocator, so that memory debugging tools can be used.
     bool UseMalloc = false;
@@ -75,7 +75,10 @@ public:
 /// A relative reference to a function, intended to reference private metadata
 /// functions for the current executable or dynamic library image from
 /// position-independent constant data.
-template<typename T>
+///
+/// If \p Nullable is true, an offset of zero represents a null pointer
+/// rather than a reference to the pointer itself.
+template<typename T, bool Nullable>
 class RelativeDirectPointerImpl {
 private:
   /// The relative offset of the function's entry point from *this.
@@ -96,21 +99,31 @@ public:
   using PointerTy = T*;
 
   PointerTy get() const & {
+    // Check for null.
+    if (Nullable && RelativeOffset == 0)
+      return nullptr;
+
     // The function entry point is addressed relative to `this`.
     auto base = reinterpret_cast<intptr_t>(this);
     intptr_t absolute = base + RelativeOffset;
     return reinterpret_cast<PointerTy>(absolute);
   }
 
+  bool isNull() const & {
+    return Nullable && RelativeOffset == 0;
+  }
 };
 
 /// A direct relative reference to an object.
-template<typename T>
+template<typename T, bool Nullable = false>
 class RelativeDirectPointer :
-  private RelativeDirectPointerImpl<T>
+  private RelativeDirectPointerImpl<T, Nullable>
 {
-  using super = RelativeDirectPointerImpl<T>;
+  using super = RelativeDirectPointerImpl<T, Nullable>;
 public:
+  using super::get;
+  using super::isNull;
+
   operator typename super::PointerTy() const & {
     return this->get();
   }
@@ -126,17 +139,20 @@ public:
 
 /// A specialization of RelativeDirectPointer for function pointers,
 /// allowing for calls.
-template<typename RetTy, typename...ArgTy>
-class RelativeDirectPointer<RetTy (ArgTy...)> :
-  private RelativeDirectPointerImpl<RetTy (ArgTy...)>
+template<typename RetTy, typename...ArgTy, bool Nullable>
+class RelativeDirectPointer<RetTy (ArgTy...), Nullable> :
+  private RelativeDirectPointerImpl<RetTy (ArgTy...), Nullable>
 {
-  using super = RelativeDirectPointerImpl<RetTy (ArgTy...)>;
+  using super = RelativeDirectPointerImpl<RetTy (ArgTy...), Nullable>;
 public:
+  using super::get;
+  using super::isNull;
+
   operator typename super::PointerTy() const & {
     return this->get();
   }
 
-  RetTy operator()(ArgTy...arg) {
+  RetTy operator()(ArgTy...arg) const {
     return this->get()(std::forward<ArgTy>(arg)...);
   }
 };
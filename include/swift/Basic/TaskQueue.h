@@ -18,9 +18,13 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/Program.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <queue>
+#include <vector>
 
 namespace swift {
 namespace sys {
@@ -38,14 +42,81 @@ enum class TaskFinishedResponse {
   StopExecution,
 };
 
+/// \brief Resources used by a task, as reported by the system when the task
+/// was reaped. Fields the current platform can't report are zero.
+struct TaskProcessInformation {
+  /// Time from starting the task to reaping it, in microseconds.
+  uint64_t WallTimeMicros = 0;
+  /// CPU time spent in user mode, in microseconds.
+  uint64_t UserTimeMicros = 0;
+  /// CPU time spent in the kernel, in microseconds.
+  uint64_t SystemTimeMicros = 0;
+  /// Peak resident set size, in bytes.
+  uint64_t MaxResidentSetBytes = 0;
+};
+
+/// \brief A queue of tasks which have not begun execution, ordered by
+/// priority.
+///
+/// Tasks with a higher priority are dequeued first; tasks with equal
+/// priorities are dequeued in the order in which they were added.
+template <typename TaskTy>
+class TaskPriorityQueue {
+  struct Entry {
+    int64_t Priority;
+    uint64_t Sequence;
+    std::unique_ptr<TaskTy> T;
+  };
+
+  /// A max-heap of entries, as maintained by std::push_heap/std::pop_heap.
+  std::vector<Entry> Heap;
+
+  /// The sequence number to give the next entry.
+  uint64_t NextSequence = 0;
+
+  static bool comesAfter(const Entry &LHS, const Entry &RHS) {
+    if (LHS.Priority != RHS.Priority)
+      return LHS.Priority < RHS.Priority;
+    return LHS.Sequence > RHS.Sequence;
+  }
+
+public:
+  bool empty() const { return Heap.empty(); }
+  size_t size() const { return Heap.size(); }
+
+  void push(std::unique_ptr<TaskTy> T, int64_t Priority = 0) {
+    Heap.push_back({Priority, NextSequence++, std::move(T)});
+    std::push_heap(Heap.begin(), Heap.end(), comesAfter);
+  }
+
+  /// Returns the task with the highest priority, without removing it.
+  const TaskTy &top() const {
+    assert(!empty() && "no top of an empty queue");
+    return *Heap.front().T;
+  }
+
+  /// Removes and returns the task with the highest priority.
+  std::unique_ptr<TaskTy> pop() {
+    assert(!empty() && "popping from an empty queue");
+    std::pop_heap(Heap.begin(), Heap.end(), comesAfter);
+    std::unique_ptr<TaskTy> Result = std::move(Heap.back().T);
+    Heap.pop_back();
+    return Result;
+  }
+};
+
 /// \brief A class encapsulating the execution of multiple tasks in parallel.
 class TaskQueue {
   /// Tasks which have not begun execution.
-  std::queue<std::unique_ptr<Task>> QueuedTasks;
+  TaskPriorityQueue<Task> QueuedTasks;
 
   /// The number of tasks to execute in parallel.
   unsigned NumberOfParallelTasks;
 
+  /// The most memory the running tasks are projected to use at once, in
+  /// bytes, or 0 for no limit.
+  uint64_t MemoryBudget = 0;
+
 public:
   /// \brief Create a new TaskQueue instance.
   ///
@@ -72,12 +143,15 @@ public:
   /// \param ReturnCode the return code of the task which finished execution.
   /// \param Output the output from the task which finished execution,
   /// if available. (This may not be available on all platforms.)
+  /// \param ProcInfo the resources used by the task
   /// \param Context the context which was passed when the task was added
   ///
   /// \returns true if further execution of tasks should stop,
   /// false if execution should continue
   typedef std::function<TaskFinishedResponse(ProcessId Pid, int ReturnCode,
-                                             StringRef Output, void *Context)>
+                                             StringRef Output,
+                                             TaskProcessInformation ProcInfo,
+                                             void *Context)>
     TaskFinishedCallback;
 
   /// \brief A callback which will be executed if a task exited abnormally due
@@ -88,12 +162,15 @@ public:
   /// no reason could be deduced, this may be empty.
   /// \param Output the output from the task which exited abnormally, if
   /// available. (This may not be available on all platforms.)
+  /// \param ProcInfo the resources used by the task
   /// \param Context the context which was passed when the task was added
   ///
   /// \returns a TaskFinishedResponse indicating whether or not execution
   /// should proceed
   typedef std::function<TaskFinishedResponse(ProcessId Pid, StringRef ErrorMsg,
-                                             StringRef Output, void *Context)>
+                                             StringRef Output,
+                                             TaskProcessInformation ProcInfo,
+                                             void *Context)>
     TaskSignalledCallback;
 #pragma clang diagnostic pop
 
@@ -113,6 +190,17 @@ public:
   /// parallel
   unsigned getNumberOfParallelTasks() const;
 
+  /// \brief Limits how much memory the running tasks may use together.
+  ///
+  /// A task is not started while the projected peak memory of the running
+  /// tasks plus its own would exceed \p Bytes, unless no other task is
+  /// running. A task's projection is the estimate passed to \ref addTask,
+  /// or, without one, the largest peak memory of any task that has finished
+  /// so far. Tasks still start in priority order.
+  ///
+  /// \note Only supported where TaskQueue supports parallel execution.
+  void setMemoryBudget(uint64_t Bytes) { MemoryBudget = Bytes; }
+
   /// \brief Adds a task to the TaskQueue.
   ///
   /// \param ExecPath the path to the executable which the task should execute
@@ -120,9 +208,15 @@ public:
   /// \param Env the environment which should be used for the task;
   /// must be null-terminated. If empty, inherits the parent's environment.
   /// \param Context an optional context which will be associated with the task
+  /// \param Priority tasks with a higher priority begin execution before
+  /// tasks with a lower one; tasks with equal priorities begin in the order in
+  /// which they were added
+  /// \param ProjectedMemory the expected peak memory of the task in bytes,
+  /// or 0 if unknown; see \ref setMemoryBudget
   virtual void addTask(const char *ExecPath, ArrayRef<const char *> Args,
                        ArrayRef<const char *> Env = llvm::None,
-                       void *Context = nullptr);
+                       void *Context = nullptr, int64_t Priority = 0,
+                       uint64_t ProjectedMemory = 0);
 
   /// \brief Synchronously executes the tasks in the TaskQueue.
   ///
@@ -159,7 +253,7 @@ class DummyTaskQueue : public TaskQueue {
       : ExecPath(ExecPath), Args(Args), Env(Env), Context(Context) {}
   };
 
-  std::queue<std::unique_ptr<DummyTask>> QueuedTasks;
+  TaskPriorityQueue<DummyTask> QueuedTasks;
 
 public:
   /// \brief Create a new DummyTaskQueue instance.
@@ -168,7 +262,8 @@ public:
 
   virtual void addTask(const char *ExecPath, ArrayRef<const char *> Args,
                        ArrayRef<const char *> Env = llvm::None,
-                       void *Context = nullptr);
+                       void *Context = nullptr, int64_t Priority = 0,
+                       uint64_t ProjectedMemory = 0);
 
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
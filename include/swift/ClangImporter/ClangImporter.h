@@ -218,6 +218,14 @@ public:
   std::string getBridgingHeaderContents(StringRef headerPath, off_t &fileSize,
                                         time_t &fileModTime);
 
+  /// Writes a precompiled form of the bridging header \p headerPath to
+  /// \p outputPCHPath, to be shared by the frontend jobs that import it.
+  ///
+  /// \returns true if there was an error.
+  ///
+  /// \sa ClangImporterOptions::PrecompiledBridgingHeader
+  bool emitBridgingPCH(StringRef headerPath, StringRef outputPCHPath);
+
   const clang::Module *getClangOwningModule(ClangNode Node) const;
   bool hasTypedef(const clang::Decl *typeDecl) const;
 
@@ -73,6 +73,11 @@ public:
   /// If true, we should use the Swift name lookup tables rather than
   /// Clang's name lookup facilities.
   bool UseSwiftLookupTables = false;
+
+  /// A precompiled form of the bridging header, shared by the frontend jobs
+  /// of a target. It is used in place of parsing the header only when it was
+  /// built from that header and is newer than every file it depends on.
+  std::string PrecompiledBridgingHeader;
 };
 
 } // end namespace swift
@@ -32,6 +32,7 @@ namespace opt {
   class InputArgList;
   class DerivedArgList;
 }
+  class raw_fd_ostream;
 }
 
 namespace swift {
@@ -127,6 +128,18 @@ private:
   /// rebuilt.
   bool ShowIncrementalBuildDecisions = false;
 
+  /// When true, compile jobs that are ready to run at the same time are
+  /// combined, so that each frontend invocation handles several primary files.
+  bool EnableBatchMode = false;
+
+  /// The most memory the running jobs are expected to use at once, in bytes,
+  /// or 0 for no limit.
+  uint64_t MemoryBudget = 0;
+
+  /// With -progress-output, the stream an event is written to for each job
+  /// that begins, finishes, or is skipped.
+  std::unique_ptr<llvm::raw_fd_ostream> ProgressStream;
+
   static const Job *unwrap(const std::unique_ptr<const Job> &p) {
     return p.get();
   }
@@ -189,6 +202,20 @@ public:
     ShowIncrementalBuildDecisions = value;
   }
 
+  bool getBatchModeEnabled() const {
+    return EnableBatchMode;
+  }
+  void setBatchModeEnabled(bool value = true) {
+    EnableBatchMode = value;
+  }
+
+  uint64_t getMemoryBudget() const {
+    return MemoryBudget;
+  }
+  void setMemoryBudget(uint64_t bytes) {
+    MemoryBudget = bytes;
+  }
+
   void setCompilationRecordPath(StringRef path) {
     assert(CompilationRecordPath.empty() && "already set");
     CompilationRecordPath = path;
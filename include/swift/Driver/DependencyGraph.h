@@ -56,6 +56,10 @@ public:
 
     /// The file was loaded successfully; anything that depends on the node
     /// should be considered out of date.
+    ///
+    /// If the node's interface hash changed, this is only returned when
+    /// something the node provides changed, and only the dependents of what
+    /// changed are considered out of date. \sa markTransitive
     AffectsDownstream
   };
 
@@ -90,6 +94,10 @@ private:
   struct ProvidesEntryTy {
     std::string name;
     DependencyMaskTy kindMask;
+
+    /// A hash of the declarations that provide this name, if the frontend
+    /// recorded one for every kind in \c kindMask; otherwise empty.
+    std::string fingerprint;
   };
   static_assert(std::is_move_constructible<ProvidesEntryTy>::value, "");
 
@@ -116,6 +124,12 @@ private:
   /// \sa DependencyMaskTy
   llvm::StringMap<std::pair<std::vector<DependencyEntryTy>, DependencyMaskTy>> Dependencies;
 
+  /// The (kind, string) pairs whose declarations changed the last time each
+  /// node was loaded with a new interface hash, including pairs that are no
+  /// longer provided. Only these edges are followed out of a node that
+  /// hasn't been marked yet.
+  llvm::DenseMap<const void *, std::vector<ProvidesEntryTy>> ChangedProvides;
+
   /// The set of marked nodes.
   llvm::SmallPtrSet<const void *, 16> Marked;
 
@@ -183,6 +197,13 @@ protected:
   }
 
 public:
+  /// Re-encodes the dependency file in \p buffer in the compact binary
+  /// format. Binary files can be loaded anywhere a YAML file can, but are read
+  /// in a single pass over fixed-width records instead of being parsed.
+  ///
+  /// \returns true if \p buffer could not be parsed.
+  static bool encodeAsBinary(llvm::MemoryBuffer &buffer, raw_ostream &out);
+
   llvm::iterator_range<StringSetIterator> getExternalDependencies() const {
     return llvm::make_range(StringSetIterator(ExternalDependencies.begin()),
                             StringSetIterator(ExternalDependencies.end()));
@@ -236,13 +257,17 @@ public:
   };
 
   /// Load "depends" and "provides" data for \p node from the file at the given
-  /// path.
+  /// path. The file may be in either the YAML or the binary format.
   ///
   /// If \p node is already in the graph, outgoing edges ("provides") are
   /// cleared and replaced with the newly loaded data. Incoming edges
   /// ("depends") are not cleared; new dependencies are considered additive.
   ///
   /// If \p node has already been marked, only its outgoing edges are updated.
+  ///
+  /// If the file provides fingerprints for its declarations, reloading it with
+  /// a new interface hash only affects the nodes that depend on the
+  /// declarations whose fingerprints changed.
   LoadResult loadFromPath(T node, StringRef path) {
     return DependencyGraphImpl::loadFromPath(Traits::getAsVoidPointer(node),
                                              path);
@@ -250,7 +275,8 @@ public:
 
   /// Load "depends" and "provides" data for \p node from a plain string.
   ///
-  /// This is only intended for testing purposes.
+  /// This is used for testing, and for loading dependency data that has
+  /// already been read into memory.
   ///
   /// \sa loadFromPath
   LoadResult loadFromString(T node, StringRef data) {
@@ -269,6 +295,10 @@ public:
   /// Marks \p node and all nodes that depend on \p node, and places any nodes
   /// that get transitively marked into \p visited.
   ///
+  /// If \p node hasn't been marked yet and was last loaded with a new
+  /// interface hash, only the nodes that depend on what changed in that load
+  /// are traversed.
+  ///
   /// Nodes that have been previously marked are not included in \p newlyMarked,
   /// nor are their successors traversed, <em>even if their "provides" set has
   /// been updated since it was marked.</em> (However, nodes that depend on the
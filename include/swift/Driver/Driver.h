@@ -24,6 +24,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
 
 #include <functional>
 #include <memory>
@@ -96,6 +97,11 @@ public:
   /// Whether the compiler picked the current module name, rather than the user.
   bool ModuleNameIsFallback = false;
 
+  /// Whether the module is compiled as a whole and linked into an executable
+  /// which nothing else links against, so that unreachable code may be
+  /// removed by the compiler and the linker (-whole-program).
+  bool ShouldAssumeWholeProgram = false;
+
   // Whether the driver should generate compiler fixits as source edits.
   bool ShouldGenerateFixitEdits = false;
   
@@ -157,6 +163,12 @@ private:
   /// stored in it, and will clean them up when torn down.
   mutable llvm::StringMap<ToolChain *> ToolChains;
 
+  /// \brief Cache of the status of the inputs and outputs the driver looked
+  /// at while building a compilation, so that each is only stat'ed once.
+  ///
+  /// Files that don't exist have the type file_not_found.
+  mutable llvm::StringMap<llvm::sys::fs::file_status> FileStatuses;
+
 public:
   typedef std::pair<types::ID, const llvm::opt::Arg *> InputPair;
   typedef SmallVector<InputPair, 16> InputList;
@@ -182,6 +194,16 @@ public:
 
   void setCheckInputFilesExist(bool Value) { CheckInputFilesExist = Value; }
 
+  /// Stat those of \p Paths that aren't in the file status cache yet.
+  ///
+  /// Large batches are spread across several threads, since a no-op build of
+  /// a big module is otherwise dominated by waiting for the file system.
+  void prefetchFileStatuses(ArrayRef<StringRef> Paths) const;
+
+  /// Returns the status of the file at \p Path, from the file status cache
+  /// if possible.
+  const llvm::sys::fs::file_status &getFileStatus(StringRef Path) const;
+
   /// Construct a compilation object for a command line argument vector.
   ///
   /// \return A Compilation, or nullptr if none was built for the given argument
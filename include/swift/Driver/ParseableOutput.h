@@ -44,6 +44,31 @@ void emitSignalledMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
 /// \brief Emits a "skipped" message to the given stream.
 void emitSkippedMessage(raw_ostream &os, const Job &Cmd);
 
+using swift::sys::TaskProcessInformation;
+
+// The -progress-output stream has one JSON object per line. Unlike the
+// messages above, its events leave out command lines and captured output,
+// and each one is written with a single call, so that the frontend jobs can
+// append their phase timings to the same file.
+
+/// \brief Emits a "began" progress event to the given stream.
+///
+/// \param TimeMicros the time the job began, on CompileTimeTrace's clock
+void emitBeganEvent(raw_ostream &os, const Job &Cmd, ProcessId Pid,
+                    uint64_t TimeMicros);
+
+/// \brief Emits a "finished" progress event to the given stream.
+void emitFinishedEvent(raw_ostream &os, const Job &Cmd, ProcessId Pid,
+                       int ExitStatus, const TaskProcessInformation &ProcInfo);
+
+/// \brief Emits a "signalled" progress event to the given stream.
+void emitSignalledEvent(raw_ostream &os, const Job &Cmd, ProcessId Pid,
+                        StringRef ErrorMsg,
+                        const TaskProcessInformation &ProcInfo);
+
+/// \brief Emits a "skipped" progress event to the given stream.
+void emitSkippedEvent(raw_ostream &os, const Job &Cmd);
+
 } // end namespace parseable_output
 } // end namespace driver
 } // end namespace swift
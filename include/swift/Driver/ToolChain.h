@@ -93,6 +93,9 @@ protected:
   constructInvocation(const GenerateDSYMJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
+  constructInvocation(const GeneratePCHJobAction &job,
+                      const JobContext &context) const;
+  virtual InvocationInfo
   constructInvocation(const AutolinkExtractJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
@@ -113,6 +116,13 @@ protected:
   /// This method is invoked by findProgramRelativeToSwift().
   virtual std::string findProgramRelativeToSwiftImpl(StringRef name) const;
 
+  /// Returns the path of the linker used to combine object files into a
+  /// single relocatable object file ("ld -r"), or an empty string if there is
+  /// none.
+  ///
+  /// By default this is the "ld" that a job running it would use.
+  virtual std::string getRelocatableLinkerPath() const;
+
 public:
   virtual ~ToolChain() = default;
 
@@ -131,6 +141,16 @@ public:
                                     const llvm::opt::ArgList &args,
                                     const OutputInfo &OI) const;
 
+  /// Construct a Job that compiles the primary files of all of \p jobs in a
+  /// single frontend invocation.
+  ///
+  /// Each job in \p jobs must be a compile job with one primary file. Their
+  /// per-file outputs are taken from the output file map at
+  /// \p outputFileMapPath, which the caller must write.
+  std::unique_ptr<Job> constructBatchJob(ArrayRef<const Job *> jobs,
+                                         StringRef outputFileMapPath,
+                                         const llvm::opt::ArgList &args) const;
+
   /// Return the default langauge type to use for the given extension.
   virtual types::ID lookupTypeForExtension(StringRef Ext) const;
 };
@@ -26,6 +26,7 @@
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/LinkLibrary.h"
 #include "swift/AST/Module.h"
+#include "swift/AST/ReferencedNameTracker.h"
 #include "swift/AST/SearchPathOptions.h"
 #include "swift/AST/SILOptions.h"
 #include "swift/Parse/CodeCompletionCallbacks.h"
@@ -315,8 +316,28 @@ class CompilerInstance {
 
   SourceFile *PrimarySourceFile = nullptr;
 
+  /// If set, decides which function bodies in the primary file are parsed.
+  DelayedParsingCallbacks *PrimaryDelayedParseCB = nullptr;
+
+  /// In batch mode, the buffers of the primary inputs after the first one,
+  /// which is PrimaryBufferID.
+  SmallVector<unsigned, 4> BatchPrimaryBufferIDs;
+
+  /// In batch mode, the source files of the primary inputs after the first
+  /// one, which is PrimarySourceFile.
+  SmallVector<SourceFile *, 4> BatchPrimarySourceFiles;
+
+  /// In batch mode, the name trackers for BatchPrimarySourceFiles. NameTracker
+  /// goes with PrimarySourceFile.
+  std::vector<std::unique_ptr<ReferencedNameTracker>> BatchNameTrackers;
+
   void createSILModule(bool WholeModule = false);
+  bool setupContext();
+  bool setupInputBuffers();
   void setPrimarySourceFile(SourceFile *SF);
+  void addPrimaryBuffer(unsigned BufferID);
+  bool isPrimaryBuffer(unsigned BufferID) const;
+  bool isPrimarySourceFile(const SourceFile *SF) const;
 
 public:
   SourceManager &getSourceMgr() { return SourceMgr; }
@@ -386,11 +407,47 @@ public:
 
   /// Gets the SourceFile which is the primary input for this CompilerInstance.
   /// \returns the primary SourceFile, or nullptr if there is no primary input
+  ///
+  /// In batch mode, this is the first primary input.
   SourceFile *getPrimarySourceFile() { return PrimarySourceFile; }
 
+  /// Gets the SourceFile for the primary input \p Filename.
+  /// \returns the primary SourceFile, or nullptr if \p Filename is not a
+  /// primary input
+  SourceFile *getPrimarySourceFile(StringRef Filename);
+
+  /// Sets callbacks that decide which function bodies in the primary file are
+  /// parsed and type-checked by performSema(). Bodies the callbacks delay are
+  /// left unparsed.
+  ///
+  /// Has no effect if the invocation already delays function body parsing.
+  void setPrimaryDelayedParsingCallbacks(DelayedParsingCallbacks *CB) {
+    assert(!PrimarySourceFile && "must be called before performSema()");
+    PrimaryDelayedParseCB = CB;
+  }
+
   /// \brief Returns true if there was an error during setup.
   bool setup(const CompilerInvocation &Invocation);
 
+  /// \brief Sets up the ASTContext and the module loaders for \p Invocation
+  /// without its inputs, and loads the standard library and
+  /// \p PreloadModules.
+  ///
+  /// The instance can then be copied, by forking the process, and each copy
+  /// completed with setupInputs() for an invocation that differs from
+  /// \p Invocation only in its inputs and outputs. This lets a compile
+  /// server load these modules once for many jobs.
+  ///
+  /// \returns true if there was an error.
+  bool setupForReuse(const CompilerInvocation &Invocation,
+                     ArrayRef<std::string> PreloadModules);
+
+  /// \brief Adds the inputs of \p Invocation to an instance that was set
+  /// up with setupForReuse(), in place of setup().
+  ///
+  /// \returns true if there was an error.
+  bool setupInputs(const CompilerInvocation &Invocation);
+
   /// Parses and type-checks all input files.
   void performSema();
 
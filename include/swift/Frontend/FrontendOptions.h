@@ -74,6 +74,16 @@ public:
   /// be generated for the whole module.
   Optional<SelectedInput> PrimaryInput;
 
+  /// In batch mode, every primary input, in the order they were given.
+  ///
+  /// The frontend produces the outputs for each of these in turn, setting
+  /// PrimaryInput and the output paths below from BatchOutputFileMapPath.
+  std::vector<SelectedInput> BatchPrimaryInputs;
+
+  /// In batch mode, an output file map giving the outputs for each primary
+  /// input.
+  std::string BatchOutputFileMapPath;
+
   /// The kind of input on which the frontend should operate.
   InputFileKind InputKind = InputFileKind::IFK_Swift;
 
@@ -102,6 +112,10 @@ public:
   /// The path to which we should emit an Objective-C header for the module.
   std::string ObjCHeaderOutputPath;
 
+  /// If non-empty, the Objective-C header is built by merging these partial
+  /// headers instead of being printed from the module.
+  std::vector<std::string> PartialObjCHeaderPaths;
+
   /// Path to a file which should contain serialized diagnostics for this
   /// frontend invocation.
   std::string SerializedDiagnosticsPath;
@@ -140,6 +154,7 @@ public:
     EmitSIL, ///< Emit canonical SIL
 
     EmitModuleOnly, ///< Emit module only
+    EmitPCH, ///< Emit a precompiled Objective-C header
 
     EmitSIBGen, ///< Emit serialized AST + raw SIL
     EmitSIB, ///< Emit serialized AST + canonical SIL
@@ -166,10 +181,33 @@ public:
   /// If set, dumps wall time taken to check each function body to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If non-empty, the slowest expressions and function bodies to type-check
+  /// are appended to this file.
+  std::string TypeCheckReportPath;
+
+  /// The number of entries to write to TypeCheckReportPath.
+  unsigned TypeCheckReportCount = 20;
+
+  /// If non-empty, a Chrome trace of the time spent in each compiler phase
+  /// is appended to this file.
+  std::string TraceCompileTimePath;
+
+  /// If non-empty, the time spent in each compiler phase is appended to this
+  /// file as a line of the driver's -progress-output stream.
+  std::string ProgressOutputPath;
+
+  /// If non-empty, the directory in which immediate mode caches the object
+  /// code it generates for each script.
+  std::string ImmediateObjectCachePath;
+
   /// Indicates whether function body parsing should be delayed
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
 
+  /// Indicates whether function bodies in files other than the primary files
+  /// should be parsed in full rather than skipped.
+  bool DisableSecondaryBodySkipping = false;
+
   /// Indicates whether or not an import statement can pick up a Swift source
   /// file (as opposed to a module file).
   bool EnableSourceImport = false;
@@ -187,6 +225,10 @@ public:
   /// the Objective-C half should implicitly be visible to the Swift sources.
   bool ImportUnderlyingModule = false;
 
+  /// If set, the Objective-C header only contains the declarations of the
+  /// primary file, to be merged with the other files' headers later.
+  bool EmitPartialObjCHeader = false;
+
   /// If set, the header provided in ImplicitObjCHeaderPath will be rewritten
   /// by the Clang importer as part of semantic analysis.
   bool SerializeBridgingHeader = false;
@@ -195,6 +237,18 @@ public:
   /// not just code considered fragile.
   bool SILSerializeAll = false;
 
+  /// Indicates that the name lookup caches of the main module should be
+  /// freed once SILGen is done with them.
+  bool ReleaseLookupCachesAfterSILGen = false;
+
+  /// Indicates that the SIL of public generic functions should be serialized
+  /// into the module, so that clients can specialize them.
+  bool SILSerializeGenerics = false;
+
+  /// The maximum number of SIL instructions in a generic function serialized
+  /// because of SILSerializeGenerics.
+  unsigned SILSerializeGenericsLimit = 200;
+
   /// Indicates whether or not the frontend should print statistics upon
   /// termination.
   bool PrintStats = false;
@@ -203,6 +257,10 @@ public:
   /// termination.
   bool PrintClangStats = false;
 
+  /// Indicates whether the number and size of the AST nodes of the main
+  /// module should be printed after type checking.
+  bool PrintASTMemoryStats = false;
+
   /// Indicates whether the playground transformation should be applied.
   bool PlaygroundTransform = false;
 
@@ -210,6 +268,10 @@ public:
   /// instrumentation that has a high runtime performance impact.
   bool PlaygroundHighPerformance = false;
 
+  /// Indicates whether the playground transformation should log values
+  /// through the batched logging entry point.
+  bool PlaygroundBatchedLogging = false;
+
   /// Indicates whether standard help should be shown.
   bool PrintHelp = false;
 
@@ -236,6 +298,10 @@ public:
   /// Indicates whether the RequestedAction will immediately run code.
   bool actionIsImmediate() const;
 
+  /// Indicates whether the RequestedAction will generate SIL, or needs the
+  /// type-checked AST to be complete enough to do so.
+  bool actionRunsSILGen() const;
+
   void forAllOutputPaths(std::function<void(const std::string &)> fn) const;
   
   /// Gets the name of the specified output filename.
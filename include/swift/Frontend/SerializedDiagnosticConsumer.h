@@ -18,7 +18,11 @@
 #ifndef SWIFT_SERIALIZEDDIAGNOSTICCONSUMER_H
 #define SWIFT_SERIALIZEDDIAGNOSTICCONSUMER_H
 
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include <memory>
+#include <string>
 
 namespace llvm {
   class raw_ostream;
@@ -37,6 +41,20 @@ namespace swift {
     ///
     /// \returns A new diagnostic consumer that serializes diagnostics.
     DiagnosticConsumer *createConsumer(std::unique_ptr<llvm::raw_ostream> OS);
+
+    /// \brief Write the diagnostics of several serialized diagnostics files
+    /// into one, so that a client can read a single file for a whole module.
+    ///
+    /// File names, categories, and flags are written once each, however many
+    /// of the inputs refer to them.
+    ///
+    /// \param Inputs the serialized diagnostics files to read, in order.
+    /// \param OutputPath the file to write.
+    /// \param Error set to a description of the problem on failure.
+    ///
+    /// \returns true on error
+    bool mergeFiles(ArrayRef<std::string> Inputs, StringRef OutputPath,
+                    std::string &Error);
   }
 }
 
@@ -19,6 +19,11 @@
 
 namespace swift {
 
+  /// Return the TBAA access tag IRGen attaches to loads of `let` stored
+  /// properties of class instances. Once an instance is initialized, no call
+  /// can modify such a property, which SwiftAAResult exploits.
+  llvm::MDNode *getImmutablePropertyTBAATag(llvm::LLVMContext &Ctx);
+
   struct SwiftAAResult : llvm::AAResultBase<SwiftAAResult> {
     friend llvm::AAResultBase<SwiftAAResult>;
 
@@ -96,6 +101,14 @@ namespace swift {
     SwiftStackPromotion() : llvm::FunctionPass(ID) {}
   };
 
+  class SwiftProfileCounterPromotion : public llvm::FunctionPass {
+    virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+    virtual bool runOnFunction(llvm::Function &F) override;
+  public:
+    static char ID;
+    SwiftProfileCounterPromotion() : llvm::FunctionPass(ID) {}
+  };
+
 
 } // end namespace swift
 
@@ -23,12 +23,14 @@ namespace llvm {
   void initializeSwiftARCOptPass(PassRegistry &);
   void initializeSwiftARCContractPass(PassRegistry &);
   void initializeSwiftStackPromotionPass(PassRegistry &);
+  void initializeSwiftProfileCounterPromotionPass(PassRegistry &);
 }
 
 namespace swift {
   llvm::FunctionPass *createSwiftARCOptPass();
   llvm::FunctionPass *createSwiftARCContractPass();
   llvm::FunctionPass *createSwiftStackPromotionPass();
+  llvm::FunctionPass *createSwiftProfileCounterPromotionPass();
   llvm::ImmutablePass *createSwiftAAWrapperPass();
   llvm::ImmutablePass *createSwiftRCIdentityPass();
 } // end namespace swift
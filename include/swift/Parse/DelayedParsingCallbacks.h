@@ -13,6 +13,7 @@
 #ifndef SWIFT_PARSE_DELAYED_PARSING_CALLBACKS_H
 #define SWIFT_PARSE_DELAYED_PARSING_CALLBACKS_H
 
+#include "swift/AST/Attr.h"
 #include "swift/Basic/SourceLoc.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Parse/Parser.h"
@@ -44,6 +45,21 @@ class AlwaysDelayedCallbacks : public DelayedParsingCallbacks {
   }
 };
 
+/// \brief Skip all function bodies except those that are transparent.
+///
+/// Used for files whose bodies are never type-checked, such as secondary
+/// files of a frontend job and modules imported from source. Transparent
+/// bodies are delayed instead, so that they can be parsed with
+/// \c performDelayedParsing once the rest of the file is in place.
+class SkipNonTransparentFunctions : public DelayedParsingCallbacks {
+  bool shouldDelayFunctionBodyParsing(Parser &TheParser,
+                                      AbstractFunctionDecl *AFD,
+                                      const DeclAttributes &Attrs,
+                                      SourceRange BodyRange) override {
+    return Attrs.hasAttribute<TransparentAttr>();
+  }
+};
+
 /// \brief Implementation of callbacks that guide the parser in delayed
 /// parsing for code completion.
 class CodeCompleteDelayedCallbacks : public DelayedParsingCallbacks {
@@ -63,6 +79,28 @@ public:
   }
 };
 
+/// \brief Parse only the bodies of functions that contain a given location.
+///
+/// Used to re-check a single edited function body. The other bodies are
+/// delayed and, since nothing parses them later, are never type-checked.
+/// Local functions are always parsed along with their enclosing body.
+class FocusedFunctionBodyCallbacks : public DelayedParsingCallbacks {
+  SourceLoc FocusLoc;
+public:
+  explicit FocusedFunctionBodyCallbacks(SourceLoc FocusLoc)
+    : FocusLoc(FocusLoc) {
+  }
+
+  bool shouldDelayFunctionBodyParsing(Parser &TheParser,
+                                      AbstractFunctionDecl *AFD,
+                                      const DeclAttributes &Attrs,
+                                      SourceRange BodyRange) override {
+    if (AFD->getDeclContext()->isLocalContext())
+      return false;
+    return !TheParser.SourceMgr.rangeContainsTokenLoc(BodyRange, FocusLoc);
+  }
+};
+
 } // namespace swift
 
 #endif
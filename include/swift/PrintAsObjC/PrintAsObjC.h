@@ -18,13 +18,26 @@
 
 namespace swift {
   class ModuleDecl;
+  class SourceFile;
 
   /// Print the Objective-C-compatible declarations in a module as a Clang
   /// header.
   ///
+  /// If \p onlyFile is given, only the declarations in that file are printed,
+  /// as a partial header. Partial headers are complete headers on their own,
+  /// but are meant to be combined with mergeObjCHeaders, which lets the
+  /// declarations of each file be printed in parallel.
+  ///
   /// Returns true on error.
   bool printAsObjC(raw_ostream &out, ModuleDecl *M, StringRef bridgingHeader,
-                   Accessibility minRequiredAccess);
+                   Accessibility minRequiredAccess,
+                   const SourceFile *onlyFile = nullptr);
+
+  /// Combine the partial headers printed for each file of a module into the
+  /// header for the whole module.
+  ///
+  /// Returns true if one of \p partialHeaders is not a partial header.
+  bool mergeObjCHeaders(raw_ostream &out, ArrayRef<StringRef> partialHeaders);
 }
 
 #endif
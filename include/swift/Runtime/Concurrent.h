@@ -13,6 +13,7 @@
 #define SWIFT_RUNTIME_CONCURRENTUTILS_H
 #include <iterator>
 #include <atomic>
+#include <mutex>
 #include <stdint.h>
 
 /// This is a node in a concurrent linked list.
@@ -222,4 +223,130 @@ private:
   }
 };
 
+/// An insert-only, open-addressing hash table of element pointers that
+/// supports lock-free lookups running concurrently with insertions.
+///
+/// Each slot holds a hash code and a pointer to an element; the element
+/// pointer is published last (with release ordering), so a reader that
+/// observes a non-null element also observes its hash. Insertions are
+/// serialized by an internal lock, which is only held for the duration of
+/// the store itself. When the table grows, the old storage is kept alive
+/// until the table is destroyed, because readers may still be probing it;
+/// a reader that races with a resize may miss an element inserted after the
+/// resize began, so callers must re-check under their own synchronization
+/// before concluding that an element is absent.
+template <class ElemTy> class ConcurrentOpenHashTable {
+  struct Slot {
+    std::atomic<size_t> Hash;
+    std::atomic<ElemTy *> Elem;
+  };
+
+  struct Storage {
+    /// The number of slots; always a power of two.
+    size_t Capacity;
+    /// The storage this one replaced, which may still be in use by readers.
+    Storage *Previous;
+    Slot *Slots;
+
+    Storage(size_t Capacity, Storage *Previous)
+      : Capacity(Capacity), Previous(Previous), Slots(new Slot[Capacity]) {
+      for (size_t i = 0; i < Capacity; ++i) {
+        Slots[i].Hash.store(0, std::memory_order_relaxed);
+        Slots[i].Elem.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+    ~Storage() { delete [] Slots; }
+
+    Storage(const Storage &) = delete;
+    Storage &operator=(const Storage &) = delete;
+  };
+
+  /// The current storage. Readers load this once per lookup.
+  std::atomic<Storage *> Current;
+
+  /// The number of elements in the current storage. Guarded by WriterLock.
+  size_t Count;
+
+  /// Serializes insertions and resizes.
+  std::mutex WriterLock;
+
+  enum { InitialCapacity = 16 };
+
+  /// Store an element into \p S without checking for an existing entry.
+  static void insertInto(Storage *S, size_t Hash, ElemTy *Elem) {
+    size_t Mask = S->Capacity - 1;
+    for (size_t i = Hash & Mask; ; i = (i + 1) & Mask) {
+      Slot &Candidate = S->Slots[i];
+      if (Candidate.Elem.load(std::memory_order_relaxed))
+        continue;
+      Candidate.Hash.store(Hash, std::memory_order_relaxed);
+      Candidate.Elem.store(Elem, std::memory_order_release);
+      return;
+    }
+  }
+
+public:
+  ConcurrentOpenHashTable()
+    : Current(new Storage(InitialCapacity, nullptr)), Count(0) {}
+
+  ~ConcurrentOpenHashTable() {
+    Storage *S = Current.load(std::memory_order_acquire);
+    while (S) {
+      Storage *Previous = S->Previous;
+      delete S;
+      S = Previous;
+    }
+  }
+
+  ConcurrentOpenHashTable(const ConcurrentOpenHashTable &) = delete;
+  ConcurrentOpenHashTable &operator=(const ConcurrentOpenHashTable &) = delete;
+
+  /// Look for an element with hash code \p Hash for which \p IsMatch returns
+  /// true. This never blocks. Returns null if no such element was found.
+  template <class MatchFn>
+  ElemTy *find(size_t Hash, const MatchFn &IsMatch) const {
+    Storage *S = Current.load(std::memory_order_acquire);
+    size_t Mask = S->Capacity - 1;
+    for (size_t i = Hash & Mask; ; i = (i + 1) & Mask) {
+      const Slot &Candidate = S->Slots[i];
+      ElemTy *Elem = Candidate.Elem.load(std::memory_order_acquire);
+      if (!Elem)
+        return nullptr;
+      if (Candidate.Hash.load(std::memory_order_relaxed) == Hash &&
+          IsMatch(Elem))
+        return Elem;
+    }
+  }
+
+  /// Add an element with hash code \p Hash. The caller is responsible for
+  /// making sure that no equal element is already in the table.
+  void insert(size_t Hash, ElemTy *Elem) {
+    std::lock_guard<std::mutex> Guard(WriterLock);
+    Storage *S = Current.load(std::memory_order_relaxed);
+
+    // Keep the load factor at or below one half so that probe sequences
+    // stay short for readers.
+    if ((Count + 1) * 2 > S->Capacity) {
+      Storage *Grown = new Storage(S->Capacity * 2, S);
+      for (size_t i = 0; i < S->Capacity; ++i) {
+        Slot &Old = S->Slots[i];
+        if (ElemTy *OldElem = Old.Elem.load(std::memory_order_relaxed))
+          insertInto(Grown, Old.Hash.load(std::memory_order_relaxed), OldElem);
+      }
+      Current.store(Grown, std::memory_order_release);
+      S = Grown;
+    }
+
+    insertInto(S, Hash, Elem);
+    ++Count;
+  }
+
+  /// Return the number of elements in the table. This is only a snapshot
+  /// when there are concurrent insertions.
+  size_t size() {
+    std::lock_guard<std::mutex> Guard(WriterLock);
+    return Count;
+  }
+};
+
 #endif // SWIFT_RUNTIME_CONCURRENTUTILS_H
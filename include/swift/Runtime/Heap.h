@@ -18,5 +18,17 @@
 #define SWIFT_RUNTIME_HEAP_H
 
 #include <llvm/Support/Compiler.h>
+#include <cstddef>
+
+namespace swift {
+
+/// Return the number of usable bytes in an allocation returned by
+/// swift_slowAlloc, which may be larger than the size requested.
+/// This is the runtime's analog of malloc_size and must be used instead of
+/// it for memory that came from swift_slowAlloc, because small allocations
+/// are served from the runtime's own size-class heap rather than malloc.
+size_t swift_slowAllocSize(const void *ptr);
+
+} // end namespace swift
 
 #endif /* SWIFT_RUNTIME_HEAP_H */
@@ -66,6 +66,37 @@ extern "C" HeapObject *swift_initStackObject(HeapMetadata const *metadata,
 /// object did escape to some other location.
 extern "C" void swift_verifyEndOfLifetime(HeapObject *object);
 
+/// An arena of memory for heap objects that are freed all at once, e.g. the
+/// buffers that are allocated while handling one request.
+struct SwiftArena;
+
+/// Create an arena that allocates memory in blocks of \p blockSize bytes.
+/// Objects that don't fit in half a block get a block of their own.
+///
+/// An arena must only be used by one thread at a time.
+extern "C" SwiftArena *swift_arenaCreate(size_t blockSize);
+
+/// Free the memory of all objects that were allocated in \p arena, and the
+/// arena itself.
+///
+/// Deallocating an object in an arena runs its destructor, but leaves its
+/// memory to the arena.  The objects in \p arena must all have been
+/// deallocated, and must not be referenced, weakly or unowned, any more.
+extern "C" void swift_arenaDestroy(SwiftArena *arena);
+
+/// Allocate a heap object like swift_allocObject, but with memory from
+/// \p arena.
+///
+/// \return never null
+extern "C" HeapObject *swift_arenaAllocObject(SwiftArena *arena,
+                                              HeapMetadata const *metadata,
+                                              size_t requiredSize,
+                                              size_t requiredAlignmentMask);
+
+/// Return the number of usable bytes of an object allocated by
+/// swift_bufferAllocate or swift_arenaAllocObject, including its header.
+extern "C" size_t swift_bufferAllocatedSize(HeapObject *object);
+
 /// A structure that's two pointers in size.
 ///
 /// C functions can use the TwoWordPair::Return type to return a value in
@@ -162,6 +193,11 @@ extern "C" void *swift_slowAlloc(size_t bytes, size_t alignMask);
 // then call these corresponding APIs:
 extern "C" void swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask);
 
+// Resize memory returned by swift_slowAlloc to <newBytes>, keeping its first
+// <oldBytes> bytes. The memory may move. Never returns nil.
+extern "C" void *swift_slowRealloc(void *ptr, size_t oldBytes, size_t newBytes,
+                                   size_t alignMask);
+
 /// Atomically increments the retain count of an object.
 ///
 /// \param object - may be null, in which case this is a no-op
@@ -177,6 +213,12 @@ extern "C" void swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask);
 extern "C" void swift_retain(HeapObject *object);
 extern "C" void swift_retain_n(HeapObject *object, uint32_t n);
 
+/// Atomically increments the retain count of every object in an array.
+/// Adjacent duplicates are retained together.
+///
+/// \param objects - an array of \p count objects, any of which may be null
+extern "C" void swift_retainBatch(HeapObject **objects, size_t count);
+
 static inline void _swift_retain_inlined(HeapObject *object) {
   if (object) {
     object->refCount.increment();
@@ -226,6 +268,13 @@ extern "C" void swift_release(HeapObject *object);
 /// count reaches zero, the object is destroyed
 extern "C" void swift_release_n(HeapObject *object, uint32_t n);
 
+/// Atomically decrements the retain count of every object in an array,
+/// in order, destroying any whose retain count reaches zero. Adjacent
+/// duplicates are released together.
+///
+/// \param objects - an array of \p count objects, any of which may be null
+extern "C" void swift_releaseBatch(HeapObject **objects, size_t count);
+
 /// ObjC compatibility. Never call this.
 extern "C" size_t swift_retainCount(HeapObject *object);
 extern "C" size_t swift_unownedRetainCount(HeapObject *object);
@@ -480,6 +529,10 @@ static inline void swift_unownedTakeAssign(UnownedReference *dest,
 /*****************************************************************************/
 
 /// A weak reference value object.  This is ABI.
+///
+/// A native weak reference doesn't point at the object itself but at a
+/// tagged side-table entry, which lets the object's memory be freed as soon
+/// as it is deallocated.
 struct WeakReference {
   HeapObject *Value;
 };
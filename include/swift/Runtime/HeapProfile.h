@@ -0,0 +1,53 @@
+//===--- HeapProfile.h - Swift sampling heap profiler -----------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A sampling profiler of the objects allocated by swift_allocObject. It
+// records the type and the backtrace of roughly one allocation per sample
+// interval of allocated bytes, and writes profiles that pprof can read.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_HEAPPROFILE_H
+#define SWIFT_RUNTIME_HEAPPROFILE_H
+
+#include <cstddef>
+
+namespace swift {
+
+/// Start sampling object allocations, about one per \p sampleInterval
+/// allocated bytes on average.
+///
+/// Setting the SWIFT_HEAP_PROFILE environment variable to a path prefix
+/// starts the profiler when the runtime is loaded, and writes a profile to
+/// that prefix when the process exits. SWIFT_HEAP_PROFILE_SAMPLE_INTERVAL
+/// overrides the default interval of 512 KiB, and
+/// SWIFT_HEAP_PROFILE_SIGNAL names a signal number that requests a profile.
+/// Profiles that are requested by a signal are written by the next sampled
+/// allocation.
+///
+/// Objects allocated before the profiler started are not part of profiles.
+/// Calling this again only changes the sample interval.
+extern "C" void swift_startHeapProfile(size_t sampleInterval);
+
+/// Write a profile of the sampled allocations to "<prefix>.heap", and a
+/// summary of the sampled types to "<prefix>.types".
+///
+/// The profile is in the legacy heap profile format of pprof, and lists the
+/// live and the total sampled objects and bytes of each backtrace. The
+/// summary estimates the live and the total objects and bytes of each type.
+///
+/// Returns false if the profiler isn't running or a file can't be written.
+extern "C" bool swift_dumpHeapProfile(const char *prefix);
+
+} // end namespace swift
+
+#endif /* SWIFT_RUNTIME_HEAPPROFILE_H */
@@ -32,6 +32,8 @@ extern "C" HeapObject *(*_swift_tryRetain)(HeapObject *object);
 extern "C" bool (*_swift_isDeallocating)(HeapObject *object);
 extern "C" void (*_swift_release)(HeapObject *object);
 extern "C" void (*_swift_release_n)(HeapObject *object, uint32_t n);
+extern "C" void (*_swift_retainBatch)(HeapObject **objects, size_t count);
+extern "C" void (*_swift_releaseBatch)(HeapObject **objects, size_t count);
 
 // liboainject on iOS 8 patches the function pointers below if present. 
 // Do not reuse these names unless you do what oainject expects you to do.
@@ -35,17 +35,17 @@
 namespace swift {
 
 /// A bump pointer for metadata allocations. Since metadata is (currently)
-/// never released, it does not support deallocation. This allocator by itself
-/// is not thread-safe; in concurrent uses, allocations must be guarded by
-/// a lock, such as the per-metadata-cache lock used to guard metadata
-/// instantiations. All allocations are pointer-aligned.
+/// never released, it does not support deallocation. This allocator is
+/// thread-safe: the bump pointer is advanced with a compare-and-swap, so
+/// metadata instantiations for different keys of the same cache may allocate
+/// concurrently. All allocations are pointer-aligned.
 class MetadataAllocator {
   /// Address of the next available space. The allocator grabs a page at a time,
   /// so the need for a new page can be determined by page alignment.
   ///
   /// Initializing to -1 instead of nullptr ensures that the first allocation
   /// triggers a page allocation since it will always span a "page" boundary.
-  char *next = (char*)(~(uintptr_t)0U);
+  std::atomic<char*> next{(char*)(~(uintptr_t)0U)};
   
 public:
   MetadataAllocator() = default;
@@ -89,6 +89,9 @@ struct OpaqueValue;
 /// store a structure containing a pointer, a size, and an owning
 /// object, which is a common pattern in code due to ARC.  In a GC
 /// environment, this could be reduced to two pointers without much loss.
+/// Code that routinely puts larger values in existentials can build the
+/// compiler and runtime with a larger NumWords_ValueBuffer to avoid
+/// allocating them out of line.
 ///
 /// A buffer can be in one of three states:
 ///  - An unallocated buffer has a completely unspecified state.
@@ -97,7 +100,7 @@ struct OpaqueValue;
 ///  - An initialized buffer is an allocated buffer whose value
 ///    storage has been initialized.
 struct ValueBuffer {
-  void *PrivateData[3];
+  void *PrivateData[NumWords_ValueBuffer];
 };
 
 /// Can a value with the given size and alignment be allocated inline?
@@ -1205,7 +1208,7 @@ struct NominalTypeDescriptor {
   /// The kind of nominal type descriptor.
   NominalTypeKind Kind;
   /// The mangled name of the nominal type, with no generic parameters.
-  const char *Name;
+  RelativeDirectPointer<const char> Name;
   
   /// The following fields are kind-dependent.
   union {
@@ -1225,12 +1228,13 @@ struct NominalTypeDescriptor {
       
       /// The field names. A doubly-null-terminated list of strings, whose
       /// length and order is consistent with that of the field offset vector.
-      const char *FieldNames;
+      RelativeDirectPointer<const char, /*nullable*/ true> FieldNames;
       
       /// The field type vector accessor. Returns a pointer to an array of
       /// type metadata references whose order is consistent with that of the
       /// field offset vector.
-      const FieldType *(*GetFieldTypes)(const Metadata *Self);
+      RelativeDirectPointer<const FieldType * (const Metadata *),
+                            /*nullable*/ true> GetFieldTypes;
 
       /// True if metadata records for this type have a field offset vector for
       /// its stored properties.
@@ -1249,12 +1253,13 @@ struct NominalTypeDescriptor {
       
       /// The field names. A doubly-null-terminated list of strings, whose
       /// length and order is consistent with that of the field offset vector.
-      const char *FieldNames;
+      RelativeDirectPointer<const char, /*nullable*/ true> FieldNames;
       
       /// The field type vector accessor. Returns a pointer to an array of
       /// type metadata references whose order is consistent with that of the
       /// field offset vector.
-      const FieldType *(*GetFieldTypes)(const Metadata *Self);
+      RelativeDirectPointer<const FieldType * (const Metadata *),
+                            /*nullable*/ true> GetFieldTypes;
 
       /// True if metadata records for this type have a field offset vector for
       /// its stored properties.
@@ -1272,11 +1277,12 @@ struct NominalTypeDescriptor {
       /// The names of the cases. A doubly-null-terminated list of strings,
       /// whose length is NumNonEmptyCases + NumEmptyCases. Cases are named in
       /// tag order, non-empty cases first, followed by empty cases.
-      const char *CaseNames;
+      RelativeDirectPointer<const char, /*nullable*/ true> CaseNames;
       /// The field type vector accessor. Returns a pointer to an array of
       /// type metadata references whose order is consistent with that of the
       /// CaseNames. Only types for payload cases are provided.
-      const FieldType *(*GetCaseTypes)(const Metadata *Self);
+      RelativeDirectPointer<const FieldType * (const Metadata *),
+                            /*nullable*/ true> GetCaseTypes;
 
       uint32_t getNumPayloadCases() const {
         return NumPayloadCasesAndPayloadSizeOffset & 0x00FFFFFFU;
@@ -1299,7 +1305,8 @@ struct NominalTypeDescriptor {
   
   /// A pointer to the generic metadata pattern that is used to instantiate
   /// instances of this type. Null if the type is not generic.
-  GenericMetadata *GenericMetadataPattern;
+  RelativeDirectPointer<GenericMetadata, /*nullable*/ true>
+    GenericMetadataPattern;
   
   /// The generic parameter descriptor header. This describes how to find and
   /// parse the generic parameter vector in metadata records for this nominal
@@ -1504,8 +1511,8 @@ public:
   /// Get a pointer to the field type vector, if present, or null.
   const FieldType *getFieldTypes() const {
     assert(isTypeMetadata());
-    auto *getter = Description->Class.GetFieldTypes;
-    if (!getter)
+    auto &getter = Description->Class.GetFieldTypes;
+    if (getter.isNull())
       return nullptr;
     
     return getter(this);
@@ -1682,8 +1689,8 @@ struct StructMetadata : public Metadata {
   
   /// Get a pointer to the field type vector, if present, or null.
   const FieldType *getFieldTypes() const {
-    auto *getter = Description->Struct.GetFieldTypes;
-    if (!getter)
+    auto &getter = Description->Struct.GetFieldTypes;
+    if (getter.isNull())
       return nullptr;
     
     return getter(this);
@@ -2106,6 +2113,38 @@ struct GenericMetadata {
   }
 };
 
+/// \brief The control structure of a generic protocol conformance.
+///
+/// A conformance of a generic type whose witness table depends on the
+/// type's generic arguments is described by one of these instead of by a
+/// single static witness table.  The table for a particular instance is
+/// built by swift_getGenericWitnessTable and uniqued on the instance's
+/// metadata.
+///
+/// Like GenericMetadata, this is *not* const data; it includes
+/// implementation-private data.
+struct GenericWitnessTable {
+  /// The size of the witness table in words.
+  uint16_t WitnessTableSizeInWords;
+
+  /// The number of leading words to copy from the pattern.  The rest of
+  /// the table is zero-filled.
+  uint16_t WitnessTableSizeInWordsToCopy;
+
+  /// The pattern.
+  const WitnessTable *Pattern;
+
+  /// The instantiation function, which is called after the pattern is
+  /// copied into a new table.  May be null.
+  void (*Instantiator)(WitnessTable *instantiatedTable,
+                       const Metadata *type,
+                       void * const *instantiationArgs);
+
+  /// Data that the runtime can use for its own purposes.  It is guaranteed
+  /// to be zero-filled by the compiler.
+  void *PrivateData[swift::NumGenericMetadataPrivateDataWords];
+};
+
 /// The structure of a protocol conformance record.
 ///
 /// This contains enough static information to recover the witness table for a
@@ -2302,6 +2341,16 @@ extern "C" const Metadata *
 swift_getGenericMetadata(GenericMetadata *pattern,
                          const void *arguments);
 
+/// \brief Fetch a uniqued witness table for a generic conformance.
+///
+/// The table is instantiated from genericTable's pattern the first time it
+/// is requested for the given type; instantiationArgs is passed through to
+/// the instantiation function and is not part of the key.
+extern "C" const WitnessTable *
+swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
+                             const Metadata *type,
+                             void * const *instantiationArgs);
+
 // Fast entry points for swift_getGenericMetadata with a small number of
 // template arguments.
 extern "C" const Metadata *
@@ -2781,6 +2830,42 @@ extern "C"
 const WitnessTable *swift_conformsToProtocol(const Metadata *type,
                                             const ProtocolDescriptor *protocol);
 
+/// The witness tables with which a type conforms to the protocols of an
+/// existential type, as cached by swift_lookupExistentialConformances.
+///
+/// Entries are owned by the runtime, and are never modified or deallocated
+/// once they have been returned.
+struct ExistentialConformances {
+  /// The conforming type.
+  const Metadata *Type;
+
+  // Followed by the witness tables for the protocols of the existential type
+  // that require them, in the order of its protocol list.
+
+  const WitnessTable * const *getWitnessTables() const {
+    return reinterpret_cast<const WitnessTable * const *>(this + 1);
+  }
+};
+
+/// \brief Check whether a type conforms to all of the protocols of an
+/// existential type.
+///
+/// Unlike swift_conformsToProtocol, the result is cached for the pair of
+/// types, so repeating the query is a single hash table lookup. Protocols
+/// whose conformance can depend on the value rather than just the type
+/// (Objective-C protocols) are checked against the type alone.
+///
+/// \param type The metadata for the type for which to do the conformance
+///             check.
+/// \param existentialType The existential type whose protocols to check.
+/// \returns the cached conformances, which stay valid forever and are the
+///          same for every lookup of the pair, or null if the type does not
+///          conform.
+extern "C" const ExistentialConformances *
+swift_lookupExistentialConformances(
+                               const Metadata *type,
+                               const ExistentialTypeMetadata *existentialType);
+
 /// Register a block of protocol conformance records for dynamic lookup.
 extern "C"
 void swift_registerProtocolConformances(const ProtocolConformanceRecord *begin,
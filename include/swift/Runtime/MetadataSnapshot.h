@@ -0,0 +1,54 @@
+//===--- MetadataSnapshot.h - Prewarmed metadata snapshots ------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A metadata snapshot lists the generic and tuple metadata that one run of a
+// program instantiated. Replaying it in a later run fills the metadata
+// caches ahead of time, so that the program's own requests for those types
+// hit the caches.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_METADATASNAPSHOT_H
+#define SWIFT_RUNTIME_METADATASNAPSHOT_H
+
+#include <cstddef>
+
+namespace swift {
+
+/// Start writing the generic and tuple metadata that the process
+/// instantiates from now on to a snapshot at \p path.
+///
+/// Returns false if a snapshot is already being recorded or the file can't
+/// be created.
+extern "C" bool swift_startRecordingMetadataSnapshot(const char *path);
+
+/// Stop recording the metadata snapshot, and close its file.
+extern "C" void swift_stopRecordingMetadataSnapshot();
+
+/// Instantiate the metadata listed in the snapshot at \p path.
+///
+/// Every record is checked against the images loaded in this process. The
+/// references of a record must name exported symbols of the same kind, in
+/// an image at the same path and with the same size and modification time
+/// as when the snapshot was recorded. Records which fail these checks are
+/// skipped, so replaying a stale snapshot is harmless.
+///
+/// The snapshot is replayed on the calling thread. A program which wants to
+/// prewarm the caches in the background calls this on a thread of its own,
+/// once the images it depends on are loaded.
+///
+/// Returns the number of replayed records.
+extern "C" size_t swift_replayMetadataSnapshot(const char *path);
+
+} // end namespace swift
+
+#endif /* SWIFT_RUNTIME_METADATASNAPSHOT_H */
@@ -18,22 +18,15 @@
 #define SWIFT_RUNTIME_ONCE_H
 
 #include "swift/Runtime/HeapObject.h"
-#include <mutex>
 
 namespace swift {
 
-#ifdef __APPLE__
-
-// On OS X and iOS, swift_once_t matches dispatch_once_t.
+// On OS X and iOS, swift_once_t matches dispatch_once_t. On other platforms
+// it follows the same protocol: the predicate is zero-initialized and set to
+// -1 once the initialization has finished, which lets the compiler check it
+// inline before calling swift_once.
 typedef long swift_once_t;
 
-#else
-
-// On other platforms swift_once_t is std::once_flag
-typedef std::once_flag swift_once_t;
-
-#endif
-
 /// Runs the given function with the given context argument exactly once.
 /// The predicate argument must point to a global or static variable of static
 /// extent of type swift_once_t.
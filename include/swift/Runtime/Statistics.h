@@ -0,0 +1,47 @@
+//===--- Statistics.h - Swift Runtime statistics ----------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counters that a runtime built with SWIFT_RUNTIME_ENABLE_STATISTICS keeps
+// for allocation, reference counting, metadata instantiation, conformance
+// lookup and dynamic casts.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_STATISTICS_H
+#define SWIFT_RUNTIME_STATISTICS_H
+
+#include <cstdint>
+
+namespace swift {
+
+/// A copy of the runtime's counters, summed over all threads.
+struct SwiftRuntimeStatistics {
+#define RUNTIME_STATISTIC(Name, Description) uint64_t Name;
+#include "swift/Runtime/RuntimeStatistics.def"
+};
+
+/// Copy the current value of every counter into \p statistics.
+///
+/// Returns false, and sets every counter to zero, if the runtime was built
+/// without statistics. Counters of threads that are still running are read
+/// without stopping them, so the result is only approximately consistent.
+extern "C" bool swift_getRuntimeStatistics(SwiftRuntimeStatistics *statistics);
+
+/// Print the current value of every counter to stderr.
+///
+/// If the SWIFT_DEBUG_DUMP_RUNTIME_STATISTICS environment variable is set,
+/// the runtime also does this when the process exits.
+extern "C" void swift_dumpRuntimeStatistics();
+
+} // end namespace swift
+
+#endif /* SWIFT_RUNTIME_STATISTICS_H */
@@ -57,6 +57,15 @@ public:
 
   using DominatorTreeBase::properlyDominates;
 
+  /// Update the tree after the terminator of \p From was changed to branch
+  /// to \p NewTo instead of \p OldTo.
+  ///
+  /// Only the dominator subtree that contains the ends of both edges is
+  /// recomputed. \p NewTo may be a new block, which is added to the tree if
+  /// the changed edge is its only predecessor.
+  void changeEdgeTarget(SILBasicBlock *From, SILBasicBlock *OldTo,
+                        SILBasicBlock *NewTo);
+
   bool isValid(SILFunction *F) const {
     return getNode(&F->front()) != nullptr;
   }
@@ -19,6 +19,7 @@
 
 #include "swift/Basic/Range.h"
 #include "swift/SIL/SILInstruction.h"
+#include "llvm/ADT/Optional.h"
 
 namespace llvm {
   template <class T> struct GraphTraits;
@@ -49,6 +50,14 @@ private:
   /// The ordered set of instructions in the SILBasicBlock.
   InstListType InstList;
 
+  /// The number of times this block was executed according to the profile
+  /// passed with -profile-use, if known.
+  Optional<uint64_t> ProfileCount;
+
+  /// Set on the latch of a loop whose body the optimizer has freed of array
+  /// checks. IRGen asks LLVM to vectorize the loop branching from this block.
+  bool VectorizationHint = false;
+
   friend struct llvm::ilist_sentinel_traits<SILBasicBlock>;
   friend struct llvm::ilist_traits<SILBasicBlock>;
   SILBasicBlock() : Parent(0) {}
@@ -59,6 +68,13 @@ public:
   SILBasicBlock(SILFunction *F, SILBasicBlock *afterBB = nullptr);
   ~SILBasicBlock();
 
+  /// Blocks are allocated with the module's block allocator, which reuses the
+  /// storage of erased blocks.
+  template <typename ContextTy>
+  void *operator new(size_t Bytes, ContextTy &C) {
+    return C.allocateBlock(Bytes, alignof(SILBasicBlock));
+  }
+
   /// Gets the ID (= index in the function's block list) of the block.
   ///
   /// Returns -1 if the block is not contained in a function.
@@ -80,6 +96,15 @@ public:
   /// Returns true if this BB is the entry BB of its parent.
   bool isEntry() const;
 
+  /// Returns the profiled execution count of this block, if known.
+  Optional<uint64_t> getProfileCount() const { return ProfileCount; }
+  void setProfileCount(uint64_t Count) { ProfileCount = Count; }
+
+  /// Returns true if the loop whose back edge leaves this block should be
+  /// vectorized.
+  bool hasVectorizationHint() const { return VectorizationHint; }
+  void setVectorizationHint() { VectorizationHint = true; }
+
   //===--------------------------------------------------------------------===//
   // SILInstruction List Inspection and Manipulation
   //===--------------------------------------------------------------------===//
@@ -347,7 +372,7 @@ public:
   SILBasicBlock *provideInitialHead() const { return createSentinel(); }
   SILBasicBlock *ensureHead(SILBasicBlock*) const { return createSentinel(); }
   static void noteHead(SILBasicBlock*, SILBasicBlock*) {}
-  static void deleteNode(SILBasicBlock *BB) { BB->~SILBasicBlock(); }
+  static void deleteNode(SILBasicBlock *BB);
 
   void addNodeToList(SILBasicBlock *BB) {
   }
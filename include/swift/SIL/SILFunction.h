@@ -133,6 +133,13 @@ private:
   /// It does not include references from debug scopes.
   unsigned RefCount = 0;
 
+  /// Incremented whenever the pass manager is told that this function has
+  /// changed.
+  unsigned ModificationEpoch = 1;
+
+  /// The ModificationEpoch at which the function was last verified.
+  mutable unsigned VerifiedEpoch = 0;
+
   /// The function's semantics attribute.
   std::string SemanticsAttr;
 
@@ -580,6 +587,17 @@ public:
   /// invariants.
   void verify() const;
 
+  /// Record that the function has changed since it was last verified.
+  void notifyModified() { ++ModificationEpoch; }
+
+  /// Returns the modification epoch of the function.
+  unsigned getModificationEpoch() const { return ModificationEpoch; }
+
+  /// Returns true if the function has not changed since it was last verified.
+  bool isVerifiedUpToDate() const {
+    return VerifiedEpoch == ModificationEpoch;
+  }
+
   /// Pretty-print the SILFunction.
   void dump(bool Verbose) const;
   void dump() const;
@@ -40,6 +40,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
+#include <vector>
 
 namespace swift {
   class AnyFunctionType;
@@ -101,6 +102,13 @@ private:
   mutable llvm::BumpPtrAllocator BPA;
   void *TypeListUniquing;
 
+  /// The storage of erased basic blocks. The bump allocator can't free it, so
+  /// it is handed out again by allocateBlock().
+  ///
+  /// This is declared before the function list so that it outlives the
+  /// blocks which are returned to it when the functions are destroyed.
+  std::vector<void *> FreeBlockStorage;
+
   /// The swift Module associated with this SILModule.
   ModuleDecl *TheSwiftModule;
 
@@ -114,6 +122,11 @@ private:
   /// functions so that the destructor of \p functions is called first.
   llvm::StringMap<SILFunction *> FunctionTable;
 
+  /// The mangled names of the SILDeclRefs that were looked up in this module.
+  /// SILGen asks for the function of the same constant many times, and
+  /// mangling its name each time is expensive.
+  llvm::DenseMap<SILDeclRef, StringRef> MangledNameCache;
+
   /// The list of SILFunctions in the module.
   FunctionListType functions;
 
@@ -384,6 +397,10 @@ public:
   /// \return null if this module has no such function
   SILFunction *lookUpFunction(SILDeclRef fnRef);
 
+  /// Returns the mangled name of \p constant, mangling it only the first time
+  /// it is asked for.
+  StringRef getMangledName(SILDeclRef constant);
+
   /// Attempt to link the SILFunction. Returns true if linking succeeded, false
   /// otherwise.
   ///
@@ -405,6 +422,12 @@ public:
   bool linkFunction(StringRef Name,
                     LinkingMode LinkAll = LinkingMode::LinkNormal);
 
+  /// Look for a function by mangled name, deserializing only its declaration
+  /// if it is not in this module yet.
+  ///
+  /// \return null if no module has such a function
+  SILFunction *linkFunctionDeclaration(StringRef Name);
+
   /// Link in all Witness Tables in the module.
   void linkAllWitnessTables();
 
@@ -501,7 +524,10 @@ public:
 
   /// \brief Run the SIL verifier to make sure that all Functions follow
   /// invariants.
-  void verify() const;
+  ///
+  /// If \p OnlyModifiedFunctions is true, functions which have not changed
+  /// since they were last verified are skipped.
+  void verify(bool OnlyModifiedFunctions = false) const;
 
   /// Pretty-print the module.
   void dump(bool Verbose = false) const;
@@ -529,6 +555,17 @@ public:
   /// Allocate memory using the module's internal allocator.
   void *allocate(unsigned Size, unsigned Align) const;
 
+  /// Returns the number of bytes allocated so far with allocate(). The
+  /// allocator never frees memory, so this is also its peak usage.
+  size_t getBytesAllocated() const { return BPA.getBytesAllocated(); }
+
+  /// Allocate memory for a basic block, reusing the storage of an erased block
+  /// if there is one.
+  void *allocateBlock(unsigned Size, unsigned Align);
+
+  /// Return the memory of a destroyed basic block for reuse.
+  void deallocateBlock(SILBasicBlock *BB);
+
   /// Allocate memory for an instruction using the module's internal allocator.
   void *allocateInst(unsigned Size, unsigned Align) const;
 
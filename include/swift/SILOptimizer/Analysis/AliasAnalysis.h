@@ -147,6 +147,9 @@ public:
   }
   
   virtual void initialize(SILPassManager *PM) override;
+
+  /// Returns the side-effect analysis which this alias analysis uses.
+  SideEffectAnalysis *getSideEffectAnalysis() const { return SEA; }
   
   /// Perform an alias query to see if V1, V2 refer to the same values.
   AliasResult alias(SILValue V1, SILValue V2, SILType TBAAType1 = SILType(),
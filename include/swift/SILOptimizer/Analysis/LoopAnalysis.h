@@ -46,6 +46,13 @@ public:
   // information.
   virtual SILLoopInfo *newFunctionAnalysis(SILFunction *F) override;
 
+protected:
+  virtual void verify(SILLoopInfo *LI) const override {
+    LI->verify();
+  }
+
+public:
+
   virtual void initialize(SILPassManager *PM) override;
 };
 
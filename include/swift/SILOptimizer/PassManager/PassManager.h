@@ -17,6 +17,8 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <string>
+#include <vector>
 
 #ifndef SWIFT_SILOPTIMIZER_PASSMANAGER_PASSMANAGER_H
 #define SWIFT_SILOPTIMIZER_PASSMANAGER_PASSMANAGER_H
@@ -60,6 +62,10 @@ class SILPassManager {
 
   /// Set to true when a pass invalidates an analysis.
   bool currentPassHasInvalidated = false;
+
+  /// The number of analysis invalidations requested by the current pass.
+  /// Only used for -sil-pass-profile.
+  unsigned NumInvalidationsInCurrentPass = 0;
   
 public:
   /// C'tor. It creates and registers all analysis passes, which are defined
@@ -98,9 +104,12 @@ public:
         AP->invalidate(K);
 
     currentPassHasInvalidated = true;
+    ++NumInvalidationsInCurrentPass;
 
     // Assume that all functions have changed. Clear all masks of all functions.
     CompletedPassesMap.clear();
+    for (auto &F : *Mod)
+      F.notifyModified();
   }
 
   /// \brief Broadcast the invalidation of the function to all analysis.
@@ -112,8 +121,10 @@ public:
         AP->invalidate(F, K);
     
     currentPassHasInvalidated = true;
+    ++NumInvalidationsInCurrentPass;
     // Any change let all passes run again.
     CompletedPassesMap[F].reset();
+    F->notifyModified();
   }
 
   /// \brief Reset the state of the pass manager and remove all transformation
@@ -176,6 +187,20 @@ private:
   void viewCallGraph();
 };
 
+/// The cost of all runs of one SIL pass, summed from the pass profile.
+struct SILPassCost {
+  std::string Pass;
+  uint64_t WallTimeNS = 0;
+  /// How much the module's bump allocator grew during the pass.
+  uint64_t AllocatedBytes = 0;
+  unsigned Runs = 0;
+};
+
+/// Sum up the pass runs recorded so far for -sil-pass-profile (or
+/// SILOptions::RecordPassProfile) by pass, in the order in which the passes
+/// first ran, and discard the records.
+std::vector<SILPassCost> takeSILPassProfile();
+
 } // end namespace swift
 
 #endif
@@ -90,6 +90,17 @@ namespace swift {
     /// The entry point to the transformation.
     virtual void run() = 0;
 
+    /// Returns true if this pass keeps the analysis of kind \p Kind up to date
+    /// for its function, either because it doesn't touch what the analysis
+    /// depends on, or because it updates the analysis itself.
+    ///
+    /// The pass manager doesn't invalidate preserved analyses while the pass
+    /// runs. With -sil-verify-all they are verified against a recomputation
+    /// after the pass.
+    virtual bool preservesAnalysis(SILAnalysis::AnalysisKind Kind) const {
+      return false;
+    }
+
     static bool classof(const SILTransform *S) {
       return S->getKind() == TransformKind::Function;
     }
@@ -51,8 +51,9 @@ TermInst *changeEdgeValue(TermInst *Branch, SILBasicBlock *Dest, size_t Idx,
 /// \param EdgeIdx The successor edges index that will be replaced.
 /// \param NewDest The new target block.
 /// \param PreserveArgs If set, preserve arguments on the replaced edge.
+/// \param DT If not null, the dominator tree is updated for the changed edge.
 void changeBranchTarget(TermInst *T, unsigned EdgeIdx, SILBasicBlock *NewDest,
-                        bool PreserveArgs);
+                        bool PreserveArgs, DominanceInfo *DT = nullptr);
 
 /// \brief Replace a branch target.
 ///
@@ -60,8 +61,9 @@ void changeBranchTarget(TermInst *T, unsigned EdgeIdx, SILBasicBlock *NewDest,
 /// \param OldDest The successor block that will be replaced.
 /// \param NewDest The new target block.
 /// \param PreserveArgs If set, preserve arguments on the replaced edge.
+/// \param DT If not null, the dominator tree is updated for the changed edge.
 void replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest, SILBasicBlock *NewDest,
-                         bool PreserveArgs);
+                         bool PreserveArgs, DominanceInfo *DT = nullptr);
 
 /// \brief Check if the edge from the terminator is critical.
 bool isCriticalEdge(TermInst *T, unsigned EdgeIdx);
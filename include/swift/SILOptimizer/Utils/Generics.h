@@ -41,6 +41,11 @@ ApplySite replaceWithSpecializedFunction(ApplySite AI, SILFunction *NewF);
 
 SILFunction *getExistingSpecialization(SILModule &M, StringRef FunctionName);
 
+/// Replace an apply of a generic function whose body is not available by an
+/// apply of a specialization exported by the function's module, if there is
+/// one. Returns the new apply, or a null ApplySite.
+ApplySite tryUseExportedSpecialization(ApplySite Apply);
+
 } // end namespace swift
 
 #endif
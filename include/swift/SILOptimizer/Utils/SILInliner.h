@@ -50,7 +50,7 @@ public:
              CloneCollector::CallbackType Callback =nullptr)
     : TypeSubstCloner<SILInliner>(To, From, ContextSubs, ApplySubs, true),
     IKind(IKind), CalleeEntryBB(nullptr), CallSiteScope(nullptr),
-    Callback(Callback) {
+    CollapseScopes(false), Callback(Callback) {
   }
 
   /// inlineFunction - This method inlines a callee function, assuming that it
@@ -84,7 +84,7 @@ private:
 
   SILLocation remapLocation(SILLocation InLoc) {
     // For performance inlining return the original location.
-    if (IKind == InlineKind::PerformanceInline)
+    if (IKind == InlineKind::PerformanceInline && !CollapseScopes)
       return InLoc;
     // Inlined location wraps the call site that is being inlined, regardless
     // of the input location.
@@ -93,7 +93,7 @@ private:
   }
 
   const SILDebugScope *remapScope(const SILDebugScope *DS) {
-    if (IKind == InlineKind::MandatoryInline)
+    if (IKind == InlineKind::MandatoryInline || CollapseScopes)
       // Transparent functions are absorbed into the call
       // site. No soup, err, debugging for you!
       return CallSiteScope;
@@ -113,6 +113,10 @@ private:
   /// of SIL-to-SIL transformations).
   Optional<SILLocation> Loc;
   const SILDebugScope *CallSiteScope;
+  /// Whether the inlined code is attributed to the call site, even though
+  /// this is a performance inline.
+  /// \sa SILOptions::CollapseInlinedStdlibDebugScopes
+  bool CollapseScopes;
   SILFunction *CalleeFunction;
   llvm::SmallDenseMap<const SILDebugScope *,
                       const SILDebugScope *> InlinedScopeCache;
@@ -284,6 +284,23 @@ private:
 
   std::unique_ptr<SerializedObjCMethodTable> ObjCMethods;
 
+  class MemberNamesTableInfo;
+  using SerializedMemberNamesTable =
+    llvm::OnDiskIterableChainedHashTable<MemberNamesTableInfo>;
+
+  std::unique_ptr<SerializedMemberNamesTable> MembersByName;
+
+  class NestedTypeDeclsTableInfo;
+  using SerializedNestedTypeDeclsTable =
+    llvm::OnDiskIterableChainedHashTable<NestedTypeDeclsTableInfo>;
+
+  std::unique_ptr<SerializedNestedTypeDeclsTable> NestedTypeDecls;
+
+  /// The IDs of deserialized types and extensions whose members are loaded
+  /// lazily, used to find their members in MembersByName.
+  llvm::DenseMap<const IterableDeclContext *, serialization::DeclID>
+    MemberContextIDs;
+
   llvm::DenseMap<const ValueDecl *, Identifier> PrivateDiscriminatorsByValue;
 
   TinyPtrVector<Decl *> ImportDecls;
@@ -388,6 +405,16 @@ private:
   std::unique_ptr<ModuleFile::SerializedObjCMethodTable>
   readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Read an on-disk member table stored in
+  /// index_block::MemberNamesTableLayout format.
+  std::unique_ptr<ModuleFile::SerializedMemberNamesTable>
+  readMemberNamesTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
+  /// Read an on-disk nested type table stored in
+  /// index_block::NestedTypeDeclsLayout format.
+  std::unique_ptr<ModuleFile::SerializedNestedTypeDeclsTable>
+  readNestedTypeDeclsTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
   /// Reads the index block, which contains global tables.
   ///
   /// Returns false if there was an error.
@@ -498,6 +525,12 @@ public:
   /// Searches the module's local type decls for the given mangled name.
   TypeDecl *lookupLocalType(StringRef MangledName);
 
+  /// Searches the module's nested type decls for one named \p name that is
+  /// nested in \p parent or in one of this module's extensions of \p parent.
+  ///
+  /// If none is found, returns null.
+  TypeDecl *lookupNestedType(Identifier name, const NominalTypeDecl *parent);
+
   /// Searches the module's operators for one with the given name and fixity.
   ///
   /// If none is found, returns null.
@@ -592,6 +625,11 @@ public:
                               uint64_t contextData,
                               bool *ignored) override;
 
+  virtual bool
+  loadNamedMembers(const IterableDeclContext *IDC, Identifier name,
+                   uint64_t contextData,
+                   SmallVectorImpl<ValueDecl *> &members) override;
+
   virtual void
   loadAllConformances(const Decl *D, uint64_t contextData,
                       SmallVectorImpl<ProtocolConformance*> &Conforms) override;
@@ -51,7 +51,7 @@ const uint16_t VERSION_MAJOR = 0;
 /// To ensure that two separate changes don't silently get merged into one
 /// in source control, you should also update the comment to briefly
 /// describe what change you made.
-const uint16_t VERSION_MINOR = 223; // Last change: SIL @inout_aliasable
+const uint16_t VERSION_MINOR = 226; // Last change: module content hash
 
 using DeclID = Fixnum<31>;
 using DeclIDField = BCFixed<31>;
@@ -402,7 +402,8 @@ namespace control_block {
   enum {
     METADATA = 1,
     MODULE_NAME,
-    TARGET
+    TARGET,
+    CONTENT_HASH
   };
 
   using MetadataLayout = BCRecordLayout<
@@ -421,6 +422,17 @@ namespace control_block {
     TARGET,
     BCBlob // LLVM triple
   >;
+
+  /// The size of the hash stored in a CONTENT_HASH record.
+  const unsigned ContentHashSize = 16;
+
+  /// An MD5 hash of the whole module file, computed with the hash itself
+  /// zeroed out. Identical modules have identical hashes, so clients can
+  /// tell that a rebuilt module did not actually change.
+  using ContentHashLayout = BCRecordLayout<
+    CONTENT_HASH,
+    BCBlob // ContentHashSize bytes
+  >;
 }
 
 /// The record types within the options block (a sub-block of the control
@@ -1423,6 +1435,14 @@ namespace index_block {
     DECL_CONTEXT_OFFSETS,
     LOCAL_TYPE_DECLS,
     NORMAL_CONFORMANCE_OFFSETS,
+
+    /// The member index, which maps a type or extension and a base name to
+    /// the members of that context with that name.
+    MEMBER_NAMES,
+
+    /// The nested type index, which maps a name to the nominal types with
+    /// that name and the types they are nested in.
+    NESTED_TYPE_DECLS,
   };
 
   using OffsetsLayout = BCGenericRecordLayout<
@@ -1442,6 +1462,18 @@ namespace index_block {
     BCBlob         // map from Objective-C selectors to methods with that selector
   >;
 
+  using MemberNamesTableLayout = BCRecordLayout<
+    MEMBER_NAMES,  // record ID
+    BCVBR<16>,     // table offset within the blob (see below)
+    BCBlob         // map from context IDs and base names to member decl IDs
+  >;
+
+  using NestedTypeDeclsLayout = BCRecordLayout<
+    NESTED_TYPE_DECLS, // record ID
+    BCVBR<16>,         // table offset within the blob (see below)
+    BCBlob             // map from names to parent and nested type decl IDs
+  >;
+
   using EntryPointLayout = BCRecordLayout<
     ENTRY_POINT,
     DeclIDField  // the ID of the main class; 0 if there was a main source file
@@ -36,6 +36,8 @@ namespace swift {
 
     bool AutolinkForceLoad = false;
     bool SerializeAllSIL = false;
+    bool SerializeGenericSIL = false;
+    unsigned SerializeGenericSILLimit = 0;
     bool SerializeOptionsForDebugging = false;
     bool IsSIB = false;
   };
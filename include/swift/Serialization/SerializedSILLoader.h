@@ -82,6 +82,9 @@ public:
   SILFunction *lookupSILFunction(SILFunction *Callee);
   SILFunction *lookupSILFunction(SILDeclRef Decl);
   SILFunction *lookupSILFunction(StringRef Name);
+  /// Deserialize only the declaration of the function named \p Name. Its
+  /// body, if it has one, can still be deserialized later.
+  SILFunction *lookupSILFunctionDeclaration(StringRef Name);
   SILVTable *lookupVTable(Identifier Name);
   SILVTable *lookupVTable(const ClassDecl *C) {
     return lookupVTable(C->getName());
@@ -67,6 +67,8 @@ namespace serialization {
   struct ValidationInfo {
     StringRef name = {};
     StringRef targetTriple = {};
+    /// The module's content hash, or empty if it was not recorded.
+    StringRef contentHash = {};
     size_t bytes = 0;
     Status status = Status::Malformed;
   };
@@ -25,6 +25,8 @@ namespace swift {
   /// The extension for LLVM IR files.
   static const char LLVM_BC_EXTENSION[] = "bc";
   static const char LLVM_IR_EXTENSION[] = "ll";
+  /// The extension for precompiled Objective-C headers.
+  static const char PCH_EXTENSION[] = "pch";
   /// The name of the standard library, which is a reserved module name.
   static const char STDLIB_NAME[] = "Swift";
   /// The name of the SwiftShims module, which contains private stdlib decls.
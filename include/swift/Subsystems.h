@@ -137,7 +137,11 @@ namespace swift {
   ///
   /// \param HighPerformance True if the playground transform should omit
   /// instrumentation that has a high runtime performance impact.
-  void performPlaygroundTransform(SourceFile &SF, bool HighPerformance);
+  /// \param BatchedLogging True if logged values should be handed to the
+  /// runtime in a single call that can buffer them, instead of building a
+  /// log record and sending it.
+  void performPlaygroundTransform(SourceFile &SF, bool HighPerformance,
+                                  bool BatchedLogging = false);
   
   /// Flags used to control type checking.
   enum class TypeCheckingFlags : unsigned {
@@ -151,7 +155,12 @@ namespace swift {
 
     /// Indicates that the type checker is checking code that will be
     /// immediately executed.
-    ForImmediateMode = 1 << 2
+    ForImmediateMode = 1 << 2,
+
+    /// Indicates that no SIL will be generated from the type-checked AST, so
+    /// the members of nominal types referenced from other files need not be
+    /// validated.
+    NoSILGeneration = 1 << 3
   };
 
   /// Once parsing and name-binding are complete, this walks the AST to resolve
@@ -28,7 +28,9 @@
 #include "swift/AST/ModuleLoader.h"
 #include "swift/AST/NameLookup.h"
 #include "swift/AST/RawComment.h"
+#include "swift/AST/TypeCheckTimingReport.h"
 #include "swift/AST/TypeCheckerDebugConsumer.h"
+#include "swift/Basic/CompileTimeTrace.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/StringExtras.h"
 #include "clang/AST/DeclObjC.h"
@@ -36,6 +38,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringMap.h"
 #include <algorithm>
 #include <memory>
@@ -67,6 +70,82 @@ namespace {
     Import = 1 << 0,
     Framework = 1 << 1
   };
+
+  /// The table that uniques the strings behind identifiers.
+  ///
+  /// Each entry remembers the hash of its string, so the table grows without
+  /// hashing any string again, and a probe compares hashes and lengths before
+  /// it touches string data. The strings are nul-terminated and live in the
+  /// ASTContext's permanent arena.
+  class IdentifierTableImpl {
+    struct Entry {
+      const char *Data;
+      unsigned Length;
+      unsigned Hash;
+    };
+
+    llvm::BumpPtrAllocator &Allocator;
+    std::unique_ptr<Entry[]> Buckets;
+    unsigned NumBuckets = 0;
+    unsigned NumEntries = 0;
+
+    /// The number of buckets the table starts with. The standard library
+    /// alone interns several thousand identifiers.
+    enum : unsigned { InitialBuckets = 4096 };
+
+    void grow() {
+      unsigned OldNumBuckets = NumBuckets;
+      std::unique_ptr<Entry[]> OldBuckets = std::move(Buckets);
+
+      NumBuckets = OldNumBuckets ? OldNumBuckets * 2 : InitialBuckets;
+      Buckets.reset(new Entry[NumBuckets]());
+      for (unsigned I = 0; I != OldNumBuckets; ++I) {
+        const Entry &Old = OldBuckets[I];
+        if (!Old.Data)
+          continue;
+        unsigned Bucket = Old.Hash & (NumBuckets - 1);
+        while (Buckets[Bucket].Data)
+          Bucket = (Bucket + 1) & (NumBuckets - 1);
+        Buckets[Bucket] = Old;
+      }
+    }
+
+  public:
+    explicit IdentifierTableImpl(llvm::BumpPtrAllocator &Allocator)
+      : Allocator(Allocator) {}
+
+    static unsigned hash(StringRef Str) {
+      return static_cast<unsigned>(llvm::hash_value(Str));
+    }
+
+    /// Returns the uniqued copy of \p Str, whose hash is \p Hash.
+    const char *intern(StringRef Str, unsigned Hash) {
+      // Keep the load factor at or below 3/4.
+      if ((NumEntries + 1) * 4 > NumBuckets * 3)
+        grow();
+
+      unsigned Bucket = Hash & (NumBuckets - 1);
+      while (true) {
+        Entry &E = Buckets[Bucket];
+        if (!E.Data)
+          break;
+        if (E.Hash == Hash && E.Length == Str.size() &&
+            memcmp(E.Data, Str.data(), Str.size()) == 0)
+          return E.Data;
+        Bucket = (Bucket + 1) & (NumBuckets - 1);
+      }
+
+      // Identifier keeps two low bits of the pointer free.
+      char *Data = static_cast<char *>(
+          Allocator.Allocate(Str.size() + 1, alignof(uint32_t)));
+      memcpy(Data, Str.data(), Str.size());
+      Data[Str.size()] = '\0';
+
+      Buckets[Bucket] = { Data, static_cast<unsigned>(Str.size()), Hash };
+      ++NumEntries;
+      return Data;
+    }
+  };
 }
 
 struct ASTContext::Implementation {
@@ -81,7 +160,7 @@ struct ASTContext::Implementation {
   /// The last resolver.
   LazyResolver *Resolver = nullptr;
 
-  llvm::StringMap<char, llvm::BumpPtrAllocator&> IdentifierTable;
+  IdentifierTableImpl IdentifierTable;
 
   /// The declaration of Swift.Bool.
   NominalTypeDecl *BoolDecl = nullptr;
@@ -174,6 +253,9 @@ struct ASTContext::Implementation {
   /// func ==(Int, Int) -> Bool
   FuncDecl *EqualIntDecl = nullptr;
 
+  /// func _combineHashValues(Int, Int) -> Int
+  FuncDecl *CombineHashValuesDecl = nullptr;
+
   /// func _unimplemented_initializer(className: StaticString).
   FuncDecl *UnimplementedInitializerDecl = nullptr;
 
@@ -200,6 +282,9 @@ struct ASTContext::Implementation {
   /// \brief Map from Swift declarations to brief comments.
   llvm::DenseMap<const Decl *, StringRef> BriefComments;
 
+  /// \brief Map from declarations to the USRs generated for them.
+  llvm::DenseMap<const ValueDecl *, StringRef> DeclUSRs;
+
   /// \brief Map from local declarations to their discriminators.
   /// Missing entries implicitly have value 0.
   llvm::DenseMap<const ValueDecl *, unsigned> LocalDiscriminators;
@@ -482,8 +567,8 @@ Identifier ASTContext::getIdentifier(StringRef Str) const {
   // Make sure null pointers stay null.
   if (Str.data() == nullptr) return Identifier(0);
 
-  auto I = Impl.IdentifierTable.insert(std::make_pair(Str, char())).first;
-  return Identifier(I->getKeyData());
+  return Identifier(Impl.IdentifierTable.intern(
+      Str, IdentifierTableImpl::hash(Str)));
 }
 
 void ASTContext::lookupInSwiftModule(
@@ -970,6 +1055,29 @@ FuncDecl *ASTContext::getEqualIntDecl(LazyResolver *resolver) const {
   return nullptr;
 }
 
+FuncDecl *ASTContext::getCombineHashValuesDecl(LazyResolver *resolver) const {
+  if (Impl.CombineHashValuesDecl)
+    return Impl.CombineHashValuesDecl;
+
+  // Look for the function.
+  CanType input, output;
+  auto decl = findLibraryIntrinsic(*this, "_combineHashValues", resolver);
+  if (!decl || !isNonGenericIntrinsic(decl, input, output))
+    return nullptr;
+
+  // Check for the signature: (Int, Int) -> Int
+  CanType intType = getIntDecl()->getDeclaredType().getCanonicalTypeOrNull();
+  auto tType = dyn_cast<TupleType>(input.getPointer());
+  if (!tType || tType->getNumElements() != 2 ||
+      tType->getElementType(0).getCanonicalTypeOrNull() != intType ||
+      tType->getElementType(1).getCanonicalTypeOrNull() != intType ||
+      output != intType)
+    return nullptr;
+
+  Impl.CombineHashValuesDecl = decl;
+  return decl;
+}
+
 FuncDecl *
 ASTContext::getUnimplementedInitializerDecl(LazyResolver *resolver) const {
   if (Impl.UnimplementedInitializerDecl)
@@ -1395,6 +1503,16 @@ ASTContext::getModule(ArrayRef<std::pair<Identifier, SourceLoc>> ModulePath) {
   if (auto *M = getLoadedModule(ModulePath))
     return M;
 
+  CompileTimeTraceScope traceScope("import", [&]() -> std::string {
+    std::string name;
+    for (auto &component : ModulePath) {
+      if (!name.empty())
+        name += '.';
+      name += component.first.str();
+    }
+    return name;
+  });
+
   auto moduleID = ModulePath[0];
   for (auto &importer : Impl.ModuleLoaders) {
     if (Module *M = importer->loadModule(moduleID.second, ModulePath)) {
@@ -1458,6 +1576,18 @@ void ASTContext::setBriefComment(const Decl *D, StringRef Comment) {
   Impl.BriefComments[D] = Comment;
 }
 
+Optional<StringRef> ASTContext::getDeclUSR(const ValueDecl *D) const {
+  auto Known = Impl.DeclUSRs.find(D);
+  if (Known == Impl.DeclUSRs.end())
+    return None;
+
+  return Known->second;
+}
+
+void ASTContext::setDeclUSR(const ValueDecl *D, StringRef USR) {
+  Impl.DeclUSRs[D] = USR;
+}
+
 unsigned ValueDecl::getLocalDiscriminator() const {
   assert(getDeclContext()->isLocalContext());
   auto &discriminators = getASTContext().Impl.LocalDiscriminators;
@@ -1623,6 +1753,7 @@ size_t ASTContext::getTotalMemory() const {
     llvm::capacity_in_bytes(Impl.ModuleLoaders) +
     llvm::capacity_in_bytes(Impl.RawComments) +
     llvm::capacity_in_bytes(Impl.BriefComments) +
+    llvm::capacity_in_bytes(Impl.DeclUSRs) +
     llvm::capacity_in_bytes(Impl.LocalDiscriminators) +
     llvm::capacity_in_bytes(Impl.ModuleTypes) +
     llvm::capacity_in_bytes(Impl.GenericParamTypes) +
@@ -0,0 +1,102 @@
+//===--- ASTMemoryStatistics.cpp - AST node memory use --------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/AST/ASTMemoryStatistics.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/AST/ASTWalker.h"
+#include "swift/AST/Decl.h"
+#include "swift/AST/Expr.h"
+#include "swift/AST/Module.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace swift;
+
+static const size_t DeclSizes[] = {
+#define DECL(Id, Parent) sizeof(Id##Decl),
+#include "swift/AST/DeclNodes.def"
+};
+
+static const size_t ExprSizes[] = {
+#define EXPR(Id, Parent) sizeof(Id##Expr),
+#include "swift/AST/ExprNodes.def"
+};
+
+static const unsigned NumDeclKinds = llvm::array_lengthof(DeclSizes);
+static const unsigned NumExprKinds = llvm::array_lengthof(ExprSizes);
+
+namespace {
+class NodeCounter : public ASTWalker {
+public:
+  unsigned DeclCounts[NumDeclKinds] = {};
+  unsigned ExprCounts[NumExprKinds] = {};
+
+  bool walkToDeclPre(Decl *D) override {
+    ++DeclCounts[unsigned(D->getKind())];
+    return true;
+  }
+
+  std::pair<bool, Expr *> walkToExprPre(Expr *E) override {
+    ++ExprCounts[unsigned(E->getKind())];
+    return { true, E };
+  }
+};
+} // end anonymous namespace
+
+/// Print one line per kind, largest total first, followed by the sum.
+template <typename KindTy>
+static void printKinds(StringRef title, const unsigned *counts,
+                       const size_t *sizes, unsigned numKinds,
+                       StringRef (*getName)(KindTy), llvm::raw_ostream &OS) {
+  SmallVector<unsigned, 64> kinds;
+  size_t totalCount = 0, totalBytes = 0;
+  for (unsigned i = 0; i != numKinds; ++i) {
+    if (!counts[i])
+      continue;
+    kinds.push_back(i);
+    totalCount += counts[i];
+    totalBytes += counts[i] * sizes[i];
+  }
+  std::sort(kinds.begin(), kinds.end(), [&](unsigned lhs, unsigned rhs) {
+    return counts[lhs] * sizes[lhs] > counts[rhs] * sizes[rhs];
+  });
+
+  OS << "  " << title << ":\n";
+  for (unsigned kind : kinds) {
+    OS << llvm::format("    %10u %5zu %12zu  ", counts[kind], sizes[kind],
+                       counts[kind] * sizes[kind])
+       << getName(KindTy(kind)) << "\n";
+  }
+  OS << llvm::format("    %10zu       %12zu  ", totalCount, totalBytes)
+     << "total\n";
+}
+
+void swift::printASTMemoryStatistics(Module *M, llvm::raw_ostream &OS) {
+  NodeCounter counter;
+  for (FileUnit *file : M->getFiles())
+    if (auto SF = dyn_cast<SourceFile>(file))
+      SF->walk(counter);
+
+  OS << "*** AST memory statistics for module '" << M->getName().str() << "' ***\n"
+     << "       count  size        bytes  kind\n";
+  printKinds<DeclKind>("Declarations", counter.DeclCounts, DeclSizes,
+                       NumDeclKinds, &Decl::getKindName, OS);
+  printKinds<ExprKind>("Expressions", counter.ExprCounts, ExprSizes,
+                       NumExprKinds, &Expr::getKindName, OS);
+
+  const ASTContext &ctx = M->getASTContext();
+  OS << "  ASTContext total memory: " << ctx.getTotalMemory() << " bytes\n"
+     << "  Constraint solver memory: " << ctx.getSolverMemory() << " bytes\n";
+}
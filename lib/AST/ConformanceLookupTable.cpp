@@ -18,10 +18,18 @@
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/Decl.h"
 #include "swift/AST/Module.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/SaveAndRestore.h"
 
 using namespace swift;
 
+#define DEBUG_TYPE "Conformance lookup"
+
+STATISTIC(NumConformanceLookupCacheHits,
+          "# of conformance lookups answered from the cache");
+STATISTIC(NumConformanceLookupCacheMisses,
+          "# of conformance lookups that updated the lookup table");
+
 DeclContext *ConformanceLookupTable::ConformanceSource::getDeclContext() const {
   switch (getKind()) {
   case ConformanceEntryKind::Inherited:
@@ -60,6 +68,7 @@ void ConformanceLookupTable::ConformanceEntry::markSupersededBy(
 
   // Note that we've been superseded.
   SupersededBy = entry;
+  ++getDeclContext()->getASTContext().ConformanceLookupGeneration;
 
   if (diagnose) {
     // Record the problem in the conformance table. We'll
@@ -467,6 +476,7 @@ bool ConformanceLookupTable::addProtocol(NominalTypeDecl *nominal,
   // context.
   AllConformances[dc].push_back(entry);
 
+  ++ctx.ConformanceLookupGeneration;
   return true;
 }
 
@@ -854,6 +864,7 @@ void ConformanceLookupTable::registerProtocolConformance(
   }
 
   // Otherwise, add a new entry.
+  ++nominal->getASTContext().ConformanceLookupGeneration;
   auto inherited = dyn_cast<InheritedProtocolConformance>(conformance);
   ConformanceSource source
     = inherited ? ConformanceSource::forInherited(cast<ClassDecl>(nominal))
@@ -879,6 +890,43 @@ bool ConformanceLookupTable::lookupConformance(
        ProtocolDecl *protocol, 
        LazyResolver *resolver,
        SmallVectorImpl<ProtocolConformance *> &conformances) {
+  // Answer from the cache if no conformance table has changed since it was
+  // filled. Updating the table would otherwise walk the whole superclass
+  // chain on every lookup.
+  ASTContext &ctx = nominal->getASTContext();
+  std::pair<unsigned, unsigned> generation = {
+    ctx.ConformanceLookupGeneration, ctx.getCurrentGeneration()
+  };
+  if (LookupCacheGeneration != generation) {
+    LookupCache.clear();
+    LookupCacheGeneration = generation;
+  }
+  auto cached = LookupCache.find(protocol);
+  if (cached != LookupCache.end()) {
+    ++NumConformanceLookupCacheHits;
+    conformances.append(cached->second.begin(), cached->second.end());
+    return !cached->second.empty();
+  }
+  ++NumConformanceLookupCacheMisses;
+
+  // Only cache complete answers: those computed with a resolver, so that no
+  // extension was left unresolved, outside of a superclass visit that may
+  // have cut the update short, and where every entry produced a
+  // conformance.
+  bool cacheable = resolver && !VisitingSuperclass;
+  auto recordResult = [&](ArrayRef<ProtocolConformance *> found) {
+    // Adding extensions or conformances during the lookup invalidates
+    // what it found.
+    if (cacheable &&
+        LookupCacheGeneration.first == ctx.ConformanceLookupGeneration &&
+        LookupCacheGeneration.second == ctx.getCurrentGeneration()) {
+      auto &entry = LookupCache[protocol];
+      entry.clear();
+      for (auto conformance : found)
+        entry.push_back(conformance);
+    }
+  };
+
   // Update to record all explicit and inherited conformances.
   updateLookupTable(nominal, ConformanceStage::Inherited, resolver);
 
@@ -890,18 +938,24 @@ bool ConformanceLookupTable::lookupConformance(
     known = Conformances.find(protocol);
 
     // We didn't find anything.
-    if (known == Conformances.end())
+    if (known == Conformances.end()) {
+      recordResult({});
       return false;
+    }
   }
 
   // Resolve the conformances for this protocol.
   resolveConformances(nominal, protocol, resolver);
+  unsigned firstFound = conformances.size();
   for (auto entry : Conformances[protocol]) {
     if (auto conformance = getConformance(nominal, resolver, entry)) {
       conformances.push_back(conformance);
+    } else {
+      cacheable = false;
     }
   }
-  return !conformances.empty();
+  recordResult(llvm::makeArrayRef(conformances).slice(firstFound));
+  return conformances.size() != firstFound;
 }
 
 void ConformanceLookupTable::lookupConformances(
@@ -24,9 +24,11 @@
 #include "swift/AST/TypeLoc.h"
 #include "swift/Basic/LLVM.h"
 #include "swift/Basic/SourceLoc.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/TinyPtrVector.h"
 
 namespace swift {
 
@@ -320,6 +322,15 @@ class ConformanceLookupTable {
   /// Indicates whether we are visiting the superclass.
   bool VisitingSuperclass = false;
 
+  /// The results of lookupConformance, keyed on the protocol. An empty
+  /// list records that the nominal type does not conform.
+  llvm::DenseMap<ProtocolDecl *, llvm::TinyPtrVector<ProtocolConformance *>>
+    LookupCache;
+
+  /// The ASTContext's ConformanceLookupGeneration and module generation
+  /// when LookupCache was last known to be valid.
+  std::pair<unsigned, unsigned> LookupCacheGeneration = { 0, 0 };
+
   /// Add a protocol.
   bool addProtocol(NominalTypeDecl *nominal,
                    ProtocolDecl *protocol, SourceLoc loc,
@@ -1914,6 +1914,19 @@ bool NominalTypeDecl::derivesProtocolConformance(ProtocolDecl *protocol) const {
       return false;
     }
   }
+
+  // Structs can derive Equatable and Hashable conformance when all of their
+  // stored properties conform. The type checker checks the properties.
+  if (isa<StructDecl>(this)) {
+    switch (*knownProtocol) {
+    case KnownProtocolKind::Equatable:
+    case KnownProtocolKind::Hashable:
+      return true;
+
+    default:
+      return false;
+    }
+  }
   return false;
 }
 
@@ -2032,6 +2045,7 @@ ExtensionRange NominalTypeDecl::getExtensions() {
 void NominalTypeDecl::addExtension(ExtensionDecl *extension) {
   assert(!extension->NextExtension.getInt() && "Already added extension");
   extension->NextExtension.setInt(true);
+  ++getASTContext().ConformanceLookupGeneration;
   
   // First extension; set both first and last.
   if (!FirstExtension) {
@@ -2464,8 +2478,8 @@ ProtocolDecl::ProtocolDecl(DeclContext *DC, SourceLoc ProtocolLoc,
   ProtocolDeclBits.KnownProtocol = 0;
   ProtocolDeclBits.Circularity
     = static_cast<unsigned>(CircularityCheck::Unchecked);
-  HasMissingRequirements = false;
-  InheritedProtocolsSet = false;
+  ProtocolDeclExtraBits.HasMissingRequirements = false;
+  ProtocolDeclExtraBits.InheritedProtocolsSet = false;
 }
 
 ArrayRef<ProtocolDecl *>
@@ -4006,7 +4020,7 @@ ConstructorDecl::ConstructorDecl(DeclName Name, SourceLoc ConstructorLoc,
   ConstructorDeclBits.InitKind
     = static_cast<unsigned>(CtorInitializerKind::Designated);
   ConstructorDeclBits.HasStubImplementation = 0;
-  this->Failability = static_cast<unsigned>(Failability);
+  ConstructorDeclExtraBits.Failability = static_cast<unsigned>(Failability);
 }
 
 void ConstructorDecl::setBodyParams(Pattern *selfPattern, Pattern *bodyParams) {
@@ -28,6 +28,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 using namespace swift;
 
 enum class DiagnosticOptions {
@@ -466,6 +467,73 @@ void DiagnosticEngine::emitTentativeDiagnostics() {
   TentativeDiagnostics.clear();
 }
 
+/// Write everything that identifies a diagnostic to \p Key, without
+/// formatting its arguments. Arguments that refer to AST nodes are compared
+/// by identity.
+static void getDiagnosticKey(const Diagnostic &diagnostic,
+                             SmallVectorImpl<char> &Key) {
+  auto append = [&Key](const void *data, size_t size) {
+    Key.append(static_cast<const char *>(data),
+               static_cast<const char *>(data) + size);
+  };
+  auto appendValue = [&append](uintptr_t value) {
+    append(&value, sizeof(value));
+  };
+  auto appendString = [&](StringRef str) {
+    appendValue(str.size());
+    append(str.data(), str.size());
+  };
+
+  appendValue(static_cast<uintptr_t>(diagnostic.getID()));
+  appendValue(reinterpret_cast<uintptr_t>(
+      diagnostic.getLoc().getOpaquePointerValue()));
+  appendValue(reinterpret_cast<uintptr_t>(diagnostic.getDecl()));
+
+  for (auto &arg : diagnostic.getArgs()) {
+    appendValue(static_cast<uintptr_t>(arg.getKind()));
+    switch (arg.getKind()) {
+    case DiagnosticArgumentKind::String:
+      appendString(arg.getAsString());
+      break;
+    case DiagnosticArgumentKind::Integer:
+      appendValue(static_cast<uintptr_t>(arg.getAsInteger()));
+      break;
+    case DiagnosticArgumentKind::Unsigned:
+      appendValue(arg.getAsUnsigned());
+      break;
+    case DiagnosticArgumentKind::Identifier:
+      appendValue(reinterpret_cast<uintptr_t>(
+          arg.getAsIdentifier().getOpaqueValue()));
+      break;
+    case DiagnosticArgumentKind::ObjCSelector:
+      appendValue(reinterpret_cast<uintptr_t>(
+          arg.getAsObjCSelector().getOpaqueValue()));
+      break;
+    case DiagnosticArgumentKind::Type:
+      appendValue(reinterpret_cast<uintptr_t>(arg.getAsType().getPointer()));
+      break;
+    case DiagnosticArgumentKind::TypeRepr:
+      appendValue(reinterpret_cast<uintptr_t>(arg.getAsTypeRepr()));
+      break;
+    case DiagnosticArgumentKind::PatternKind:
+      appendValue(static_cast<uintptr_t>(arg.getAsPatternKind()));
+      break;
+    case DiagnosticArgumentKind::StaticSpellingKind:
+      appendValue(static_cast<uintptr_t>(arg.getAsStaticSpellingKind()));
+      break;
+    case DiagnosticArgumentKind::DescriptiveDeclKind:
+      appendValue(static_cast<uintptr_t>(arg.getAsDescriptiveDeclKind()));
+      break;
+    case DiagnosticArgumentKind::DeclAttribute:
+      appendValue(reinterpret_cast<uintptr_t>(arg.getAsDeclAttribute()));
+      break;
+    case DiagnosticArgumentKind::VersionTuple:
+      appendString(arg.getAsVersionTuple().getAsString());
+      break;
+    }
+  }
+}
+
 void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
   const StoredDiagnosticInfo &StoredInfo
     = StoredDiagnosticInfos[(unsigned)diagnostic.getID()];
@@ -482,6 +550,19 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
     }
   }
 
+  if (SuppressDuplicateDiagnostics) {
+    if (StoredInfo.Kind == DiagnosticKind::Note) {
+      if (SuppressingNotes)
+        return;
+    } else {
+      llvm::SmallString<64> key;
+      getDiagnosticKey(diagnostic, key);
+      SuppressingNotes = !EmittedDiagnosticKeys.insert(key).second;
+      if (SuppressingNotes)
+        return;
+    }
+  }
+
   // Check whether this is an error.
   switch (StoredInfo.Kind) {
   case DiagnosticKind::Error:
@@ -614,18 +695,24 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
     }
   }
 
-  // Actually substitute the diagnostic arguments into the diagnostic text.
+  DiagnosticInfo Info;
+  Info.ID = diagnostic.getID();
+  Info.Ranges = diagnostic.getRanges();
+  Info.FixIts = diagnostic.getFixIts();
+
+  // Actually substitute the diagnostic arguments into the diagnostic text,
+  // unless every consumer is going to discard it anyway.
   llvm::SmallString<256> Text;
-  {
+  bool needsText = std::any_of(Consumers.begin(), Consumers.end(),
+                               [&](DiagnosticConsumer *Consumer) {
+    return Consumer->needsDiagnosticText(loc, StoredInfo.Kind, Info);
+  });
+  if (needsText) {
     llvm::raw_svector_ostream Out(Text);
     formatDiagnosticText(StoredInfo.Text, diagnostic.getArgs(), Out);
   }
 
   // Pass the diagnostic off to the consumer.
-  DiagnosticInfo Info;
-  Info.ID = diagnostic.getID();
-  Info.Ranges = diagnostic.getRanges();
-  Info.FixIts = diagnostic.getFixIts();
   for (auto &Consumer : Consumers) {
     Consumer->handleDiagnostic(SourceMgr, loc, StoredInfo.Kind, Text, Info);
   }
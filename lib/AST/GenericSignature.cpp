@@ -362,8 +362,12 @@ GenericSignature::getCanonicalManglingSignature(ModuleDecl &M) const {
   
   CanGenericSignature canSig(manglingSig);
   
-  // Cache the result.
+  // Cache the result. The mangling signature is already minimal, so it is
+  // also its own mangling signature; record that too, since declarations
+  // are given their mangling signature and the mangler asks again.
   Context.ManglingSignatures.insert({{canonical, &M}, canSig});
+  if (canSig != canonical)
+    Context.ManglingSignatures.insert({{canSig, &M}, canSig});
   Context.setArchetypeBuilder(canSig, &M, std::move(builder));
 
   return canSig;
@@ -62,6 +62,15 @@ namespace {
 /// Mangle a StringRef as an identifier into a buffer.
 void Mangler::mangleIdentifier(StringRef str, OperatorFixity fixity,
                                bool isOperator) {
+  // Most identifiers are plain ASCII names, which are mangled as their length
+  // followed by their characters. Write those directly instead of going
+  // through a temporary string.
+  if ((!isOperator || fixity == OperatorFixity::NotOperator) &&
+      (!UsePunycode || !isNonAscii(str))) {
+    Buffer << str.size() << str;
+    return;
+  }
+
   auto operatorKind = [=]() -> Demangle::OperatorKind {
     if (!isOperator) return Demangle::OperatorKind::NotOperator;
     switch (fixity) {
@@ -355,6 +355,7 @@ void Module::addFile(FileUnit &newFile) {
          cast<SourceFile>(newFile).Kind == SourceFileKind::Library ||
          cast<SourceFile>(newFile).Kind == SourceFileKind::SIL);
   Files.push_back(&newFile);
+  ++getASTContext().ModuleScopeLookupGeneration;
 
   switch (newFile.getKind()) {
   case FileUnitKind::Source:
@@ -389,6 +390,13 @@ void Module::removeFile(FileUnit &existingFile) {
   Files.erase(I.base());
 }
 
+void Module::releaseLookupCaches() {
+  for (FileUnit *file : Files)
+    if (auto SF = dyn_cast<SourceFile>(file))
+      SF->releaseLookupCaches();
+  decltype(ImportLookupCache)().swap(ImportLookupCache);
+}
+
 DerivedFileUnit &Module::getDerivedFileUnit() const {
   for (auto File : Files) {
     if (auto DFU = dyn_cast<DerivedFileUnit>(File))
@@ -529,6 +537,13 @@ DerivedFileUnit::DerivedFileUnit(Module &M)
   M.getASTContext().addDestructorCleanup(*this);
 }
 
+void DerivedFileUnit::addDerivedDecl(FuncDecl *FD) {
+  DerivedDecls.push_back(FD);
+
+  // Derived operators are found by unqualified lookup.
+  ++getASTContext().ModuleScopeLookupGeneration;
+}
+
 void DerivedFileUnit::lookupValue(Module::AccessPathTy accessPath,
                                   DeclName name,
                                   NLKind lookupKind,
@@ -1135,6 +1150,45 @@ void Module::getImportedModulesForLookup(
   FORWARD(getImportedModulesForLookup, (modules));
 }
 
+/// Returns the key the import lookup cache uses for \p accessPath.
+static Identifier getImportLookupCacheKey(Module::AccessPathTy accessPath) {
+  assert(accessPath.size() <= 1 && "can only refer to top-level decls");
+  return accessPath.empty() ? Identifier() : accessPath.front().first;
+}
+
+const TinyPtrVector<ValueDecl *> *
+Module::getCachedImportLookup(AccessPathTy accessPath, DeclName name,
+                              unsigned options) {
+  if (ImportLookupCacheGeneration !=
+        getASTContext().ModuleScopeLookupGeneration) {
+    ImportLookupCache.clear();
+    ImportLookupCacheGeneration = getASTContext().ModuleScopeLookupGeneration;
+    return nullptr;
+  }
+
+  auto known = ImportLookupCache.find(
+    {name, {getImportLookupCacheKey(accessPath), options}});
+  if (known == ImportLookupCache.end())
+    return nullptr;
+  return &known->second;
+}
+
+void Module::cacheImportLookup(AccessPathTy accessPath, DeclName name,
+                               unsigned options,
+                               ArrayRef<ValueDecl *> results) {
+  if (ImportLookupCacheGeneration !=
+        getASTContext().ModuleScopeLookupGeneration) {
+    ImportLookupCache.clear();
+    ImportLookupCacheGeneration = getASTContext().ModuleScopeLookupGeneration;
+  }
+
+  auto &cached =
+    ImportLookupCache[{name, {getImportLookupCacheKey(accessPath), options}}];
+  cached.clear();
+  for (auto result : results)
+    cached.push_back(result);
+}
+
 bool Module::isSameAccessPath(AccessPathTy lhs, AccessPathTy rhs) {
   using AccessPathElem = std::pair<Identifier, SourceLoc>;
   if (lhs.size() != rhs.size())
@@ -1182,6 +1236,20 @@ bool Module::isBuiltinModule() const {
   return this == getASTContext().TheBuiltinModule;
 }
 
+void SourceFile::endDeclInterfaceHash(ArrayRef<Decl *> decls) {
+  assert(!ActiveDeclInterfaceHashes.empty() && "no declaration being hashed");
+  ActiveDeclInterfaceHash active = ActiveDeclInterfaceHashes.pop_back_val();
+
+  DeclInterfaceHash result;
+  active.Full.final(result.Full);
+  active.Own.final(result.Own);
+
+  // Nested declarations finish first, so don't let an enclosing #if clobber
+  // the hashes of the declarations inside it.
+  for (Decl *D : decls)
+    DeclInterfaceHashes.insert({D, result});
+}
+
 bool SourceFile::registerMainClass(ClassDecl *mainClass, SourceLoc diagLoc) {
   if (mainClass == MainClass)
     return false;
@@ -1424,6 +1492,7 @@ void SourceFile::addImports(
   assert(iter == newBuf.end());
 
   Imports = newBuf;
+  ++ctx.ModuleScopeLookupGeneration;
 }
 
 bool SourceFile::hasTestableImport(const swift::Module *module) const {
@@ -1435,7 +1504,16 @@ bool SourceFile::hasTestableImport(const swift::Module *module) const {
   });
 }
 
+void SourceFile::releaseLookupCaches() {
+  clearLookupCache();
+  decltype(UnqualifiedLookupCache)().swap(UnqualifiedLookupCache);
+}
+
 void SourceFile::clearLookupCache() {
+  // Declarations may have been added to this file, so any file's cached
+  // unqualified lookups may be stale.
+  ++getASTContext().ModuleScopeLookupGeneration;
+
   if (!Cache)
     return;
 
@@ -1444,6 +1522,37 @@ void SourceFile::clearLookupCache() {
   Cache.reset();
 }
 
+const TinyPtrVector<ValueDecl *> *
+SourceFile::getCachedUnqualifiedLookup(DeclName name, unsigned options) {
+  if (UnqualifiedLookupCacheGeneration !=
+        getASTContext().ModuleScopeLookupGeneration) {
+    UnqualifiedLookupCache.clear();
+    UnqualifiedLookupCacheGeneration =
+      getASTContext().ModuleScopeLookupGeneration;
+    return nullptr;
+  }
+
+  auto known = UnqualifiedLookupCache.find({name, options});
+  if (known == UnqualifiedLookupCache.end())
+    return nullptr;
+  return &known->second;
+}
+
+void SourceFile::cacheUnqualifiedLookup(DeclName name, unsigned options,
+                                        ArrayRef<ValueDecl *> results) {
+  if (UnqualifiedLookupCacheGeneration !=
+        getASTContext().ModuleScopeLookupGeneration) {
+    UnqualifiedLookupCache.clear();
+    UnqualifiedLookupCacheGeneration =
+      getASTContext().ModuleScopeLookupGeneration;
+  }
+
+  auto &cached = UnqualifiedLookupCache[{name, options}];
+  cached.clear();
+  for (auto result : results)
+    cached.push_back(result);
+}
+
 void
 SourceFile::cacheVisibleDecls(SmallVectorImpl<ValueDecl*> &&globals) const {
   SmallVectorImpl<ValueDecl*> &cached = getCache().AllVisibleValues;
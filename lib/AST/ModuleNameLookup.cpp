@@ -20,8 +20,24 @@ using namespace swift;
 using namespace namelookup;
 
 namespace {
+  /// The results of a lookup into one module and its re-exports, made as
+  /// part of a larger lookup.
+  struct ModuleLookupResult {
+    TinyPtrVector<ValueDecl *> Decls;
+
+    /// The resolution kind the lookup was made with.
+    ResolutionKind Kind = ResolutionKind::Overloadable;
+
+    /// False while the module's re-exports are still being visited.
+    bool Complete = false;
+
+    /// Whether the results are independent of where the larger lookup
+    /// started, so that they may be cached in the module.
+    bool Stable = false;
+  };
+
   using ModuleLookupCache = llvm::SmallDenseMap<Module::ImportedModule,
-                                                TinyPtrVector<ValueDecl *>,
+                                                ModuleLookupResult,
                                                 32>;
 
   class SortCanType {
@@ -139,8 +155,16 @@ static ResolutionKind recordImportDecls(LazyResolver *typeResolver,
 
 /// Performs a qualified lookup into the given module and, if necessary, its
 /// reexports, observing proper shadowing rules.
+///
+/// If \p cacheName is non-empty, it is the name being looked up, and results
+/// that don't depend on \p moduleScopeContext are cached in the modules
+/// they came from, using \p cacheOptions to distinguish different kinds of
+/// lookups.
+///
+/// \returns true if the results found don't depend on where the lookup
+/// started.
 template <typename OverloadSetTy, typename CallbackTy>
-static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
+static bool lookupInModule(Module *module, Module::AccessPathTy accessPath,
                            SmallVectorImpl<ValueDecl *> &decls,
                            ResolutionKind resolutionKind, bool canReturnEarly,
                            LazyResolver *typeResolver,
@@ -148,6 +172,7 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
                            const DeclContext *moduleScopeContext,
                            bool respectAccessControl,
                            ArrayRef<Module::ImportedModule> extraImports,
+                           DeclName cacheName, unsigned cacheOptions,
                            CallbackTy callback) {
   assert(module);
   assert(std::none_of(extraImports.begin(), extraImports.end(),
@@ -159,8 +184,30 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
   bool isNew;
   std::tie(iter, isNew) = cache.insert({{accessPath, module}, {}});
   if (!isNew) {
-    decls.append(iter->second.begin(), iter->second.end());
-    return;
+    auto &known = iter->second;
+    decls.append(known.Decls.begin(), known.Decls.end());
+    // A lookup that is still in progress, or one made with a different
+    // resolution kind, isn't what this lookup would have found on its own.
+    return known.Complete && known.Stable && known.Kind == resolutionKind;
+  }
+  iter->second.Kind = resolutionKind;
+
+  // Once the lookup has left the module it started from, the results no
+  // longer depend on the context, so they can be shared with every other
+  // lookup of the same name.
+  bool isStable = cacheName && extraImports.empty() &&
+                  (!respectAccessControl || !moduleScopeContext);
+  unsigned options =
+    cacheOptions | (static_cast<unsigned>(resolutionKind) << 2);
+  if (isStable) {
+    if (auto cached = module->getCachedImportLookup(accessPath, cacheName,
+                                                    options)) {
+      decls.append(cached->begin(), cached->end());
+      iter->second.Decls = *cached;
+      iter->second.Complete = true;
+      iter->second.Stable = true;
+      return true;
+    }
   }
 
   size_t initialCount = decls.size();
@@ -219,10 +266,13 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
       }
 
       auto &resultSet = next.first.empty() ? unscopedValues : scopedValues;
-      lookupInModule<OverloadSetTy>(next.second, combinedAccessPath,
-                                    resultSet, resolutionKind, canReturnEarly,
-                                    typeResolver, cache, moduleScopeContext,
-                                    respectAccessControl, {}, callback);
+      if (!lookupInModule<OverloadSetTy>(next.second, combinedAccessPath,
+                                         resultSet, resolutionKind,
+                                         canReturnEarly, typeResolver, cache,
+                                         moduleScopeContext,
+                                         respectAccessControl, {},
+                                         cacheName, cacheOptions, callback))
+        isStable = false;
     }
 
     // Add the results from scoped imports.
@@ -246,10 +296,19 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
                              }),
               decls.end());
 
-  auto &cachedValues = cache[{accessPath, module}];
-  cachedValues.insert(cachedValues.end(),
+  // Visiting the re-exports may have invalidated 'iter'.
+  auto &cached = cache[{accessPath, module}];
+  cached.Decls.insert(cached.Decls.end(),
                       decls.begin() + initialCount,
                       decls.end());
+  cached.Complete = true;
+  cached.Stable = isStable;
+
+  if (isStable) {
+    module->cacheImportLookup(accessPath, cacheName, options,
+                              { decls.begin() + initialCount, decls.end() });
+  }
+  return isStable;
 }
 
 void namelookup::lookupInModule(Module *startModule,
@@ -265,10 +324,13 @@ void namelookup::lookupInModule(Module *startModule,
   ModuleLookupCache cache;
   bool respectAccessControl = startModule->getASTContext().LangOpts
                                 .EnableAccessControl;
+  unsigned cacheOptions = (lookupKind == NLKind::QualifiedLookup ? 1 : 0) |
+                          (typeResolver ? 2 : 0);
   ::lookupInModule<CanTypeSet>(startModule, topAccessPath, decls,
                                resolutionKind, /*canReturnEarly=*/true,
                                typeResolver, cache, moduleScopeContext,
                                respectAccessControl, extraImports,
+                               name, cacheOptions,
     [=](Module *module, Module::AccessPathTy path,
         SmallVectorImpl<ValueDecl *> &localDecls) {
       module->lookupValue(path, name, lookupKind, localDecls);
@@ -292,6 +354,7 @@ void namelookup::lookupVisibleDeclsInModule(
                                     resolutionKind, /*canReturnEarly=*/false,
                                     typeResolver, cache, moduleScopeContext,
                                     respectAccessControl, extraImports,
+                                    DeclName(), 0,
     [=](Module *module, Module::AccessPathTy path,
         SmallVectorImpl<ValueDecl *> &localDecls) {
       VectorDeclConsumer consumer(localDecls);
@@ -25,6 +25,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/STLExtras.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/TinyPtrVector.h"
 
 using namespace swift;
@@ -623,8 +624,21 @@ UnqualifiedLookup::UnqualifiedLookup(DeclName Name, DeclContext *DC,
   SmallVector<ValueDecl *, 8> CurModuleResults;
   auto resolutionKind =
     IsTypeLookup ? ResolutionKind::TypesOnly : ResolutionKind::Overloadable;
-  lookupInModule(&M, {}, Name, CurModuleResults, NLKind::UnqualifiedLookup,
-                 resolutionKind, TypeResolver, DC, extraImports);
+
+  // The module-scope results depend only on the file and the name, so cache
+  // them in the file. The debugger can change what is visible at any time,
+  // so don't cache when there is a debugger client.
+  auto SF = DebugClient ? nullptr : dyn_cast<SourceFile>(DC);
+  unsigned cacheOptions = (IsTypeLookup ? 1 : 0) | (TypeResolver ? 2 : 0);
+  if (auto cached =
+        SF ? SF->getCachedUnqualifiedLookup(Name, cacheOptions) : nullptr) {
+    CurModuleResults.append(cached->begin(), cached->end());
+  } else {
+    lookupInModule(&M, {}, Name, CurModuleResults, NLKind::UnqualifiedLookup,
+                   resolutionKind, TypeResolver, DC, extraImports);
+    if (SF)
+      SF->cacheUnqualifiedLookup(Name, cacheOptions, CurModuleResults);
+  }
 
   for (auto VD : CurModuleResults)
     Results.push_back(UnqualifiedLookupResult(VD));
@@ -688,6 +702,14 @@ class swift::MemberLookupTable {
   /// Lookup table mapping names to the set of declarations with that name.
   LookupTable Lookup;
 
+  /// Extensions included in the table whose members were not loaded yet.
+  /// Their members are added by name, as they are looked up.
+  llvm::SmallVector<ExtensionDecl *, 4> LazyExtensions;
+
+  /// Base names for which all members of the unloaded contexts have already
+  /// been added.
+  llvm::DenseSet<Identifier> LoadedNames;
+
 public:
   /// Create a new member lookup table.
   explicit MemberLookupTable(ASTContext &ctx);
@@ -704,6 +726,11 @@ public:
   /// \brief Add the given members to the lookup table.
   void addMembers(DeclRange members);
 
+  /// \brief Make sure that the members of \p nominal and of its included
+  /// extensions with the given base name are in the lookup table, loading
+  /// them if necessary.
+  void loadNamedMembers(NominalTypeDecl *nominal, Identifier name);
+
   /// \brief The given extension has been extended with new members; add them
   /// if appropriate.
   void addExtensionMembers(NominalTypeDecl *nominal,
@@ -835,10 +862,64 @@ void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
                      : nominal->FirstExtension;
        next;
        (LastExtensionIncluded = next,next = next->NextExtension.getPointer())) {
+    // Don't load the members of a serialized extension just yet; they will
+    // be added by name as needed.
+    if (next->isLazy()) {
+      LazyExtensions.push_back(next);
+      LoadedNames.clear();
+      continue;
+    }
+
     addMembers(next->getMembers());
   }
 }
 
+/// Add the members of \p IDC with the given base name to \p table.
+///
+/// \returns false if the loader of \p IDC cannot load members by name.
+static bool addNamedMembers(MemberLookupTable &table,
+                            const IterableDeclContext *IDC,
+                            Identifier name) {
+  SmallVector<ValueDecl *, 4> members;
+  if (!IDC->getLoader()->loadNamedMembers(IDC, name,
+                                          IDC->getLoaderContextData(),
+                                          members))
+    return false;
+
+  for (auto member : members)
+    table.addMember(member);
+  return true;
+}
+
+void MemberLookupTable::loadNamedMembers(NominalTypeDecl *nominal,
+                                         Identifier name) {
+  // Note that the name has been loaded up front; deserializing the members
+  // can look up the same name again.
+  if (!LoadedNames.insert(name).second)
+    return;
+
+  if (nominal->isLazy() && !addNamedMembers(*this, nominal, name)) {
+    // Loading all of the members adds them to the table.
+    (void)nominal->getMembers();
+  }
+
+  // Deserialization can include new extensions, so work on a copy.
+  SmallVector<ExtensionDecl *, 4> extensions;
+  extensions.swap(LazyExtensions);
+  for (auto ext : extensions) {
+    // Drop extensions that have been loaded completely in the meantime.
+    if (!ext->isLazy())
+      continue;
+
+    if (addNamedMembers(*this, ext, name)) {
+      LazyExtensions.push_back(ext);
+      continue;
+    }
+
+    addMembers(ext->getMembers());
+  }
+}
+
 void MemberLookupTable::destroy() {
   this->~MemberLookupTable();
 }
@@ -900,7 +981,9 @@ void NominalTypeDecl::prepareLookupTable(bool ignoreNewExtensions) {
 
   // If we haven't walked the member list yet to update the lookup
   // table, do so now.
-  if (!LookupTable.getInt()) {
+  // If the members haven't been loaded yet, they will be added by name as
+  // they are looked up.
+  if (!LookupTable.getInt() && !isLazy()) {
     // Note that we'll have walked the members now.
     LookupTable.setInt(true);
 
@@ -925,20 +1008,20 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
 
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
-  // Make sure we have the complete list of members (in this nominal and in all
-  // extensions).
-  if (!ignoreNewExtensions) {
-    for (auto E : getExtensions())
-      (void)E->getMembers();
-  }
-
-  (void)getMembers();
+  // Make sure we have the complete list of extensions.
+  if (!ignoreNewExtensions)
+    (void)getExtensions();
 
   prepareLookupTable(ignoreNewExtensions);
 
+  // Members that haven't been loaded yet (in this nominal and in the
+  // extensions) are only loaded if they have the name we're looking for.
+  auto &table = *LookupTable.getPointer();
+  table.loadNamedMembers(this, name.getBaseName());
+
   // Look for the declarations with this name.
-  auto known = LookupTable.getPointer()->find(name);
-  if (known == LookupTable.getPointer()->end())
+  auto known = table.find(name);
+  if (known == table.end())
     return { };
 
   // We found something; return it.
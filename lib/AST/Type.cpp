@@ -2402,7 +2402,15 @@ Type Type::subst(Module *module, TypeSubstitutionMap &substitutions,
   auto failed = [&](Type t){
     return options.contains(SubstFlags::IgnoreMissing) ? t : Type();
   };
-  
+
+  // Only archetypes and type parameters are ever replaced. If the canonical
+  // type mentions neither, the walk below would hand back this very type,
+  // so skip it. Check the canonical type because sugar such as
+  // AssociatedTypeType does not carry the properties of what it stands for.
+  auto canProps = getPointer()->getCanonicalType()->getRecursiveProperties();
+  if (!canProps.hasArchetype() && !canProps.hasTypeParameter())
+    return *this;
+
   return transform([&](Type type) -> Type {
     assert(!isa<SILFunctionType>(type.getPointer()) &&
            "should not be doing AST type-substitution on a lowered SIL type;"
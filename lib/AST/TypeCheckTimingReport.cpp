@@ -0,0 +1,131 @@
+//===--- TypeCheckTimingReport.cpp - Slowest type-checked code ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/AST/TypeCheckTimingReport.h"
+#include "swift/Basic/SourceManager.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <tuple>
+
+using namespace swift;
+
+static bool isFaster(const TypeCheckTimingReport::Entry &lhs,
+                     const TypeCheckTimingReport::Entry &rhs) {
+  return lhs.Milliseconds > rhs.Milliseconds;
+}
+
+void TypeCheckTimingReport::record(Entry &&entry) {
+  if (Limit == 0)
+    return;
+
+  if (Entries.size() == Limit) {
+    if (entry.Milliseconds <= Entries.front().Milliseconds)
+      return;
+    std::pop_heap(Entries.begin(), Entries.end(), isFaster);
+    Entries.pop_back();
+  }
+
+  Entries.push_back(std::move(entry));
+  std::push_heap(Entries.begin(), Entries.end(), isFaster);
+}
+
+static StringRef getKindName(TypeCheckTimingReport::EntryKind kind) {
+  switch (kind) {
+  case TypeCheckTimingReport::EntryKind::Expression:
+    return "expression";
+  case TypeCheckTimingReport::EntryKind::FunctionBody:
+    return "function-body";
+  case TypeCheckTimingReport::EntryKind::ClosureBody:
+    return "closure-body";
+  }
+  llvm_unreachable("bad entry kind");
+}
+
+static void writeJSONString(raw_ostream &OS, StringRef str) {
+  OS << '"';
+  for (unsigned char c : str) {
+    switch (c) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (c < 0x20)
+        OS << llvm::format("\\u%04x", c);
+      else
+        OS << c;
+    }
+  }
+  OS << '"';
+}
+
+void TypeCheckTimingReport::write(raw_ostream &OS,
+                                  const SourceManager &SM) const {
+  std::vector<const Entry *> sorted;
+  for (auto &entry : Entries)
+    sorted.push_back(&entry);
+  std::sort(sorted.begin(), sorted.end(),
+            [](const Entry *lhs, const Entry *rhs) {
+              return lhs->Milliseconds > rhs->Milliseconds;
+            });
+
+  for (auto entry : sorted) {
+    OS << "{\"kind\": \"" << getKindName(entry->Kind) << "\", \"file\": ";
+    unsigned line = 0, column = 0;
+    if (entry->Loc.isValid()) {
+      writeJSONString(OS, SM.getBufferIdentifierForLoc(entry->Loc));
+      std::tie(line, column) = SM.getLineAndColumn(entry->Loc);
+    } else {
+      OS << "\"\"";
+    }
+    OS << ", \"line\": " << line << ", \"column\": " << column;
+    if (!entry->Name.empty()) {
+      OS << ", \"name\": ";
+      writeJSONString(OS, entry->Name);
+    }
+    OS << ", \"ms\": " << llvm::format("%0.3f", entry->Milliseconds)
+       << ", \"states\": " << entry->NumStatesExplored
+       << ", \"disjunctions\": " << entry->NumDisjunctions
+       << ", \"solver-bytes\": " << entry->NumSolverBytesFreed << "}\n";
+  }
+}
+
+bool TypeCheckTimingReport::appendToFile(StringRef path,
+                                         const SourceManager &SM,
+                                         std::string &error) const {
+  // Format the whole report first and write it with a single call, so that
+  // reports appended by concurrent frontend jobs don't interleave.
+  SmallString<1024> buffer;
+  llvm::raw_svector_ostream bufferOS(buffer);
+  write(bufferOS, SM);
+  bufferOS.flush();
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(path, EC, llvm::sys::fs::F_Append |
+                                    llvm::sys::fs::F_Text);
+  if (EC) {
+    error = EC.message();
+    return true;
+  }
+  OS.SetUnbuffered();
+  OS << buffer;
+  if (OS.has_error()) {
+    error = "could not write report";
+    OS.clear_error();
+    return true;
+  }
+  return false;
+}
@@ -136,6 +136,23 @@ void *TypeRefinementContext::operator new(size_t Bytes, ASTContext &C,
   return C.Allocate(Bytes, Alignment);
 }
 
+/// Contexts with fewer children than this search them linearly.
+static const unsigned MinChildrenForBinarySearch = 8;
+
+bool TypeRefinementContext::areChildrenOrdered(SourceManager &SM) {
+  if (ChildrenOrder == ChildOrder::Unknown) {
+    ChildrenOrder = ChildOrder::Ordered;
+    for (unsigned i = 1, e = Children.size(); i != e; ++i) {
+      if (!SM.isBeforeInBuffer(Children[i - 1]->SrcRange.End,
+                               Children[i]->SrcRange.Start)) {
+        ChildrenOrder = ChildOrder::Unordered;
+        break;
+      }
+    }
+  }
+  return ChildrenOrder == ChildOrder::Ordered;
+}
+
 TypeRefinementContext *
 TypeRefinementContext::findMostRefinedSubContext(SourceLoc Loc,
                                                  SourceManager &SM) {
@@ -144,8 +161,22 @@ TypeRefinementContext::findMostRefinedSubContext(SourceLoc Loc,
   if (SrcRange.isValid() && !SM.rangeContainsTokenLoc(SrcRange, Loc))
     return nullptr;
 
-  // For the moment, we perform a linear search here, but we can and should
-  // do something more efficient.
+  // The children of a context are almost always built in source order, in
+  // which case only the last one starting before Loc can contain it.
+  if (Children.size() >= MinChildrenForBinarySearch &&
+      areChildrenOrdered(SM)) {
+    auto Next = std::upper_bound(Children.begin(), Children.end(), Loc,
+                                 [&SM](SourceLoc Loc,
+                                       const TypeRefinementContext *Child) {
+      return SM.isBeforeInBuffer(Loc, Child->SrcRange.Start);
+    });
+    if (Next != Children.begin()) {
+      if (auto *Found = (*std::prev(Next))->findMostRefinedSubContext(Loc, SM))
+        return Found;
+    }
+    return this;
+  }
+
   for (TypeRefinementContext *Child : Children) {
     if (auto *Found = Child->findMostRefinedSubContext(Loc, SM)) {
       return Found;
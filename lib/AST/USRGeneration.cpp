@@ -29,7 +29,7 @@ static inline StringRef getUSRSpacePrefix() {
   return "s:";
 }
 
-bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
+static bool printDeclUSRUncached(const ValueDecl *D, raw_ostream &OS) {
   using namespace Mangle;
 
   if (!isa<FuncDecl>(D) && !D->hasName())
@@ -90,6 +90,26 @@ bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
   return false;
 }
 
+bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
+  // Indexing and cursor info ask for the USR of the same declaration for
+  // every reference to it, so remember the ones that were generated.
+  ASTContext &Ctx = D->getASTContext();
+  if (auto USR = Ctx.getDeclUSR(D)) {
+    OS << *USR;
+    return false;
+  }
+
+  llvm::SmallString<128> Buf;
+  llvm::raw_svector_ostream BufOS(Buf);
+  if (printDeclUSRUncached(D, BufOS))
+    return true;
+
+  StringRef USR = Ctx.AllocateCopy(BufOS.str());
+  Ctx.setDeclUSR(D, USR);
+  OS << USR;
+  return false;
+}
+
 bool ide::printAccessorUSR(const AbstractStorageDecl *D, AccessorKind AccKind,
                            llvm::raw_ostream &OS) {
   using namespace Mangle;
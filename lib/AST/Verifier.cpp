@@ -23,14 +23,48 @@
 #include "swift/AST/Mangle.h"
 #include "swift/AST/PrettyStackTrace.h"
 #include "swift/Basic/SourceManager.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
 using namespace swift;
 
+/// Returns true if the sampled verification mode picked \p AFD for this run.
+///
+/// The choice depends only on the seed, the function's name and its line,
+/// so a failure can be reproduced by passing the same seed again.
+static bool isSampledForVerification(const AbstractFunctionDecl *AFD,
+                                     const ASTContext &Ctx) {
+  unsigned Percent = Ctx.LangOpts.ASTVerifierSamplePercent;
+  if (Percent >= 100)
+    return true;
+
+  unsigned Line = 0;
+  if (AFD->getLoc().isValid())
+    Line = Ctx.SourceMgr.getLineAndColumn(AFD->getLoc()).first;
+  size_t Hash = llvm::hash_combine(Ctx.LangOpts.ASTVerifierSampleSeed,
+                                   AFD->getNameStr(), Line);
+  return Hash % 100 < Percent;
+}
+
 namespace {
 
+/// Prints the sampling seed if the verifier crashes, so that the same
+/// subset of functions can be verified again.
+class PrettyStackTraceVerifierSample : public llvm::PrettyStackTraceEntry {
+  const ASTContext &Ctx;
+public:
+  explicit PrettyStackTraceVerifierSample(const ASTContext &Ctx) : Ctx(Ctx) {}
+  void print(llvm::raw_ostream &out) const override {
+    out << "While verifying " << Ctx.LangOpts.ASTVerifierSamplePercent
+        << "% of function bodies (-ast-verifier-sample-seed "
+        << Ctx.LangOpts.ASTVerifierSampleSeed << ")\n";
+  }
+};
+
+
 template<typename T>
 struct ASTNodeBase {};
 
@@ -333,6 +367,14 @@ struct ASTNodeBase {};
     bool shouldVerify(Pattern *S) { return true; }
     bool shouldVerify(Decl *S) { return true; }
 
+    // Function bodies are where most of the verification time goes, so
+    // they're what the sampled verification mode skips.
+    bool shouldVerify(AbstractFunctionDecl *AFD) {
+      if (!isSampledForVerification(AFD, Ctx))
+        return false;
+      return shouldVerify(cast<ValueDecl>(AFD));
+    }
+
     // Default cases for cleaning up as we exit a node.
     void cleanup(Expr *E) { }
     void cleanup(Stmt *S) { }
@@ -2865,8 +2907,25 @@ struct ASTNodeBase {};
 
 void swift::verify(SourceFile &SF) {
 #if !(defined(NDEBUG) || defined(SWIFT_DISABLE_AST_VERIFIER))
+  const ASTContext &Ctx = SF.getASTContext();
+  Optional<PrettyStackTraceVerifierSample> sampleTrace;
+  if (Ctx.LangOpts.ASTVerifierSamplePercent < 100)
+    sampleTrace.emplace(Ctx);
+
   Verifier verifier(SF, &SF);
-  SF.walk(verifier);
+
+  // A file that isn't type-checked here is being verified by every frontend
+  // job that parses it, so share its top-level declarations out among the
+  // jobs. Type-checked files are only ever checked by one job.
+  if (Ctx.LangOpts.ASTVerifierProcessCount == 1 ||
+      SF.ASTStage == SourceFile::TypeChecked) {
+    SF.walk(verifier);
+    return;
+  }
+
+  for (Decl *D : SF.Decls)
+    if (shouldVerify(D, Ctx))
+      D->walk(verifier);
 #endif
 }
 
@@ -2880,7 +2939,9 @@ bool swift::shouldVerify(const Decl *D, const ASTContext &Context) {
   }
 
   if (const auto *ED = dyn_cast<ExtensionDecl>(D)) {
-    return shouldVerify(ED->getExtendedType()->getAnyNominal(), Context);
+    if (auto *NTD = ED->getExtendedType()->getAnyNominal())
+      return shouldVerify(NTD, Context);
+    return true;
   }
 
   const auto *VD = dyn_cast<ValueDecl>(D);
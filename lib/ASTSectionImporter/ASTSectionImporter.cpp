@@ -24,8 +24,8 @@
 
 using namespace swift;
 
-bool swift::parseASTSection(SerializedModuleLoader *SML, StringRef buf,
-                            SmallVectorImpl<std::string> &foundModules) {
+bool swift::indexASTSection(StringRef buf,
+                            SmallVectorImpl<ASTSectionModule> &modules) {
   if (!serialization::isSerializedAST(buf))
     return false;
 
@@ -38,15 +38,8 @@ bool swift::parseASTSection(SerializedModuleLoader *SML, StringRef buf,
 
     if (info.status == serialization::Status::Valid) {
       assert(info.bytes != 0);
-      if (!info.name.empty()) {
-        StringRef moduleData = buf.substr(0, info.bytes);
-        std::unique_ptr<llvm::MemoryBuffer> bitstream(
-          llvm::MemoryBuffer::getMemBuffer(moduleData, info.name, false));
-
-        // Register the memory buffer.
-        SML->registerMemoryBuffer(info.name, std::move(bitstream));
-        foundModules.push_back(info.name);
-      }
+      if (!info.name.empty())
+        modules.push_back({ info.name, buf.substr(0, info.bytes) });
     } else {
       llvm::dbgs() << "Unable to load module";
       if (!info.name.empty())
@@ -67,3 +60,20 @@ bool swift::parseASTSection(SerializedModuleLoader *SML, StringRef buf,
 
   return true;
 }
+
+bool swift::parseASTSection(SerializedModuleLoader *SML, StringRef buf,
+                            SmallVectorImpl<std::string> &foundModules) {
+  SmallVector<ASTSectionModule, 16> modules;
+  bool success = indexASTSection(buf, modules);
+
+  for (auto &module : modules) {
+    // The buffer doesn't copy the module, and the module is only
+    // deserialized if it's imported.
+    std::unique_ptr<llvm::MemoryBuffer> bitstream(
+      llvm::MemoryBuffer::getMemBuffer(module.Data, module.Name, false));
+    SML->registerMemoryBuffer(module.Name, std::move(bitstream));
+    foundModules.push_back(module.Name);
+  }
+
+  return success;
+}
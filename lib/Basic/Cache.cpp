@@ -14,12 +14,14 @@
 #include "Darwin/Cache-Mac.cpp"
 #else
 
-//  This file implements a default caching implementation that never evicts
-//  its entries.
+//  This file implements a default caching implementation that evicts its
+//  least recently used entries once their total cost exceeds the limit set
+//  with setCostLimit(), and never evicts without a limit.
 
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Mutex.h"
+#include <list>
 
 using namespace swift::sys;
 using llvm::StringRef;
@@ -33,12 +35,73 @@ struct DefaultCacheKey {
   DefaultCacheKey(void *Key, CacheImpl::CallBacks *CBs) : Key(Key), CBs(CBs) {}
 };
 
+struct DefaultCacheEntry {
+  void *Key;
+  void *Value;
+  size_t Cost;
+};
+
+/// Tracks the retains of a value, so that a value that leaves the cache is
+/// only destroyed once nobody uses it anymore.
+struct DefaultCacheValueState {
+  unsigned RetainCount = 0;
+  /// How many times the value left the cache; the value destroy callback is
+  /// invoked that many times.
+  unsigned PendingDestroys = 0;
+};
+
 struct DefaultCache {
   llvm::sys::Mutex Mux;
   CacheImpl::CallBacks CBs;
-  llvm::DenseMap<DefaultCacheKey, void *> Entries;
+  /// The entries, most recently used first.
+  std::list<DefaultCacheEntry> LRU;
+  llvm::DenseMap<DefaultCacheKey, std::list<DefaultCacheEntry>::iterator>
+    Entries;
+  llvm::DenseMap<void *, DefaultCacheValueState> Values;
+  size_t TotalCost = 0;
+  size_t CostLimit = 0;
 
   explicit DefaultCache(CacheImpl::CallBacks CBs) : CBs(std::move(CBs)) { }
+
+  void retain(void *Value) {
+    ++Values[Value].RetainCount;
+  }
+
+  void release(void *Value) {
+    auto Found = Values.find(Value);
+    assert(Found != Values.end() && "releasing a value that isn't retained");
+    assert(Found->second.RetainCount > 0);
+    if (--Found->second.RetainCount != 0)
+      return;
+    unsigned Destroys = Found->second.PendingDestroys;
+    Values.erase(Found);
+    while (Destroys--)
+      CBs.valueDestroyCB(Value, CBs.UserData);
+  }
+
+  /// Removes an entry; its value is destroyed once it is released by
+  /// everyone who retained it.
+  void erase(decltype(Entries)::iterator Entry) {
+    auto LRUEntry = Entry->second;
+    Entries.erase(Entry);
+    CBs.keyDestroyCB(LRUEntry->Key, CBs.UserData);
+    void *Value = LRUEntry->Value;
+    TotalCost -= LRUEntry->Cost;
+    LRU.erase(LRUEntry);
+    ++Values[Value].PendingDestroys;
+    release(Value);
+  }
+
+  /// Evicts the least recently used entries until the total cost is within
+  /// the limit. The most recently used entry is always kept.
+  void evict() {
+    if (CostLimit == 0)
+      return;
+    while (TotalCost > CostLimit && LRU.size() > 1) {
+      DefaultCacheKey CKey(LRU.back().Key, &CBs);
+      erase(Entries.find(CKey));
+    }
+  }
 };
 } // end anonymous namespace
 
@@ -77,16 +140,18 @@ void CacheImpl::setAndRetain(void *Key, void *Value, size_t Cost) {
 
   DefaultCacheKey CKey(Key, &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-  }
+  if (Entry != DCache.Entries.end())
+    DCache.erase(Entry);
+
+  DCache.LRU.push_front({ Key, Value, Cost });
+  DCache.Entries[CKey] = DCache.LRU.begin();
+  DCache.TotalCost += Cost;
 
-  DCache.Entries[CKey] = Value;
+  // One retain for the cache and one for the caller.
+  DCache.retain(Value);
+  DCache.retain(Value);
 
-  // FIXME: Not thread-safe! It should avoid deleting the value until
-  // 'releaseValue is called on it.
+  DCache.evict();
 }
 
 bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
@@ -95,17 +160,20 @@ bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
 
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    // FIXME: Not thread-safe! It should avoid deleting the value until
-    // 'releaseValue is called on it.
-    *Value_out = Entry->second;
-    return true;
-  }
-  return false;
+  if (Entry == DCache.Entries.end())
+    return false;
+
+  // Mark the entry as the most recently used one.
+  DCache.LRU.splice(DCache.LRU.begin(), DCache.LRU, Entry->second);
+  *Value_out = Entry->second->Value;
+  DCache.retain(*Value_out);
+  return true;
 }
 
 void CacheImpl::releaseValue(void *Value) {
-  // FIXME: Implementation.
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+  DCache.release(Value);
 }
 
 bool CacheImpl::remove(const void *Key) {
@@ -114,24 +182,28 @@ bool CacheImpl::remove(const void *Key) {
 
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-    return true;
-  }
-  return false;
+  if (Entry == DCache.Entries.end())
+    return false;
+  DCache.erase(Entry);
+  return true;
 }
 
 void CacheImpl::removeAll() {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
   llvm::sys::ScopedLock L(DCache.Mux);
 
-  for (auto Entry : DCache.Entries) {
-    DCache.CBs.keyDestroyCB(Entry.first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry.second, nullptr);
+  while (!DCache.LRU.empty()) {
+    DefaultCacheKey CKey(DCache.LRU.front().Key, &DCache.CBs);
+    DCache.erase(DCache.Entries.find(CKey));
   }
-  DCache.Entries.clear();
+}
+
+void CacheImpl::setCostLimit(size_t Limit) {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+
+  DCache.CostLimit = Limit;
+  DCache.evict();
 }
 
 void CacheImpl::destroy() {
@@ -22,15 +22,19 @@
 using namespace swift;
 
 ClusteredBitVector ClusteredBitVector::fromAPInt(const llvm::APInt &bits) {
-  // This is not a very efficient algorithm.
   ClusteredBitVector result;
-  for (unsigned i = 0, e = bits.getBitWidth(); i != e; ++i) {
-    if (bits[i]) {
-      result.appendSetBits(1);
-    } else {
-      result.appendClearBits(1);
-    }
+  auto numBits = bits.getBitWidth();
+  if (bits == 0) {
+    result.appendClearBits(numBits);
+    return result;
   }
+
+  // This assumes that the chunk size is the same as APInt's. APInt keeps
+  // the unused high bits of its last word clear, just like we do.
+  static_assert(sizeof(ChunkType) == sizeof(llvm::integerPart),
+                "chunk size doesn't match APInt's word size");
+  result.reserve(numBits);
+  result.appendReserved(numBits, bits.getRawData());
   return result;
 }
 
@@ -76,100 +80,77 @@ void ClusteredBitVector::reallocate(size_t newCapacityInChunks) {
   }
 }
 
-void ClusteredBitVector::appendReserved(size_t numBits,
-                llvm::function_ref<ChunkType(size_t numBitsWanted)> generator) {
+void ClusteredBitVector::appendConstantBitsReserved(size_t numBits,
+                                                    bool addOnes) {
   assert(LengthInBits + numBits <= getCapacityInBits());
   assert(numBits > 0);
 
-  auto getMoreBits =
-    [&](size_t numBitsWanted) -> ChunkType {
-    auto result = generator(numBitsWanted);
-    assert((numBitsWanted == ChunkSizeInBits ||
-            result <= (ChunkType(1) << numBitsWanted)) &&
-           "generator returned out-of-range value!");
-    return result;
-  };
-
-  // Check whether the current end of the vector is a clean multiple
-  // of the chunk size.
+  // The unused bits of the current last chunk are guaranteed to be zero, and
+  // the chunks after it are uninitialized.
   auto offset = LengthInBits % ChunkSizeInBits;
-  ChunkType *nextChunk = &getChunksPtr()[LengthInBits / ChunkSizeInBits];
-
-  // Now we can go ahead and add in the right number of extra bits.
+  ChunkType *chunks = &getChunksPtr()[LengthInBits / ChunkSizeInBits];
+  auto numChunks = getNumChunksForBits(offset + numBits);
   LengthInBits += numBits;
 
-  // If not, we need to combine the generator result with that last chunk.
-  if (offset) {
-    auto claimedBits = std::min(numBits, size_t(ChunkSizeInBits - offset));
-
-    // The extra bits in data[chunkIndex] are guaranteed to be zero.
-    *nextChunk++ |= (getMoreBits(claimedBits) << offset);
-    
-    numBits -= claimedBits;
-    if (numBits == 0) return;
-  }
-
-  // For the rest, just generator chunks one at a time.
-  do {
-    auto claimedBits = std::min(numBits, size_t(ChunkSizeInBits));
-    *nextChunk++ = getMoreBits(claimedBits);
-    numBits -= claimedBits;
-  } while (numBits);
-}
-
-void ClusteredBitVector::appendConstantBitsReserved(size_t numBits,
-                                                    bool addOnes) {
-  assert(LengthInBits + numBits <= getCapacityInBits());
-  assert(numBits > 0);
-
   ChunkType pattern = (addOnes ? ~ChunkType(0) : ChunkType(0));
-  appendReserved(numBits, [=](size_t numBitsWanted) -> ChunkType {
-    return (pattern >> (ChunkSizeInBits - numBitsWanted));
-  });
+  if (offset)
+    chunks[0] |= (pattern << offset);
+  else
+    chunks[0] = pattern;
+  std::fill(chunks + 1, chunks + numChunks, pattern);
+
+  // Restore the invariant that the unused bits of the last chunk are zero.
+  if (auto tailBits = (offset + numBits) % ChunkSizeInBits)
+    chunks[numChunks - 1] &= ((ChunkType(1) << tailBits) - 1);
 }
 
 void ClusteredBitVector::appendReserved(size_t numBits,
                                         const ChunkType *nextChunk) {
-  // This is easy if we're not currently at an offset.
-  // (Note that this special case generator relies on the exact
-  // implementation of the main appendReserved routine.)
+  assert(LengthInBits + numBits <= getCapacityInBits());
+  assert(numBits > 0);
+
   auto offset = LengthInBits % ChunkSizeInBits;
+  ChunkType *chunks = &getChunksPtr()[LengthInBits / ChunkSizeInBits];
+  auto numSourceChunks = getNumChunksForBits(numBits);
+  auto numChunks = getNumChunksForBits(offset + numBits);
+  LengthInBits += numBits;
+
+  // The source's last chunk may have bits set beyond numBits; read it
+  // through a mask.
+  auto sourceTailBits = numBits % ChunkSizeInBits;
+  auto getSourceChunk = [&](size_t i) -> ChunkType {
+    ChunkType chunk = nextChunk[i];
+    if (i == numSourceChunks - 1 && sourceTailBits)
+      chunk &= ((ChunkType(1) << sourceTailBits) - 1);
+    return chunk;
+  };
+
+  // This is just a copy if we're not currently at an offset.
   if (!offset) {
-    appendReserved(numBits, [&](size_t numBitsWanted) -> ChunkType {
-      return *nextChunk++;
-    });
+    memcpy(chunks, nextChunk, (numSourceChunks - 1) * sizeof(ChunkType));
+    chunks[numSourceChunks - 1] = getSourceChunk(numSourceChunks - 1);
     return;
   }
 
-  // But if we are, we need to be constantly mixing values.
-  ChunkType prevChunk = 0;
-  size_t bitsRemaining = 0;
-  appendReserved(numBits, [&](size_t numBitsWanted) -> ChunkType {
-    auto resultMask = (numBitsWanted == ChunkSizeInBits
-                         ? ~ChunkType(0)
-                         : ((ChunkType(1) << numBitsWanted) - 1));
-
-    // If we can resolve the desired bits out of the current chunk,
-    // all the better.
-    if (numBitsWanted <= bitsRemaining) {
-      assert(numBitsWanted != ChunkSizeInBits);
-      auto result = prevChunk & resultMask;
-      bitsRemaining -= numBitsWanted;
-      prevChunk >>= numBitsWanted;
-      return result;
-    }
-
-    // |-- bitsRemaining --|-------- ChunkSizeInBits --------|
-    // |     prevChunk     |             nextChunk           |
-    // |------ numBitsWanted ------|----- bitsRemaining' ----|
-    //                             |        prevChunk'       |
-
-    auto newChunk = *nextChunk++;
-    auto result = (prevChunk | (newChunk << bitsRemaining)) & resultMask;
-    prevChunk = newChunk >> (numBitsWanted - bitsRemaining);
-    bitsRemaining = ChunkSizeInBits + bitsRemaining - numBitsWanted;
-    return result;
-  });
+  // Otherwise each chunk combines the high bits of one source chunk with
+  // the low bits of the next.  The unused bits of the current last chunk are
+  // guaranteed to be zero.
+  //
+  // |---- offset ----|------------ ChunkSizeInBits - offset ------------|
+  // |  chunks[i]     |  low bits of source chunk i                      |
+  // |  high bits of source chunk i - 1                                  |
+  ChunkType carry = 0;
+  for (size_t i = 0; i != numSourceChunks; ++i) {
+    ChunkType sourceChunk = getSourceChunk(i);
+    ChunkType combined = carry | (sourceChunk << offset);
+    if (i == 0)
+      chunks[0] |= combined;
+    else
+      chunks[i] = combined;
+    carry = sourceChunk >> (ChunkSizeInBits - offset);
+  }
+  if (numChunks > numSourceChunks)
+    chunks[numSourceChunks] = carry;
 }
 
 bool ClusteredBitVector::equalsSlowCase(const ClusteredBitVector &lhs,
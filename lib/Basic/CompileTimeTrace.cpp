@@ -0,0 +1,239 @@
+//===--- CompileTimeTrace.cpp - Chrome trace of compiler phases -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/CompileTimeTrace.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if LLVM_ON_UNIX
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#endif
+
+using namespace swift;
+
+bool CompileTimeTrace::Enabled = false;
+bool CompileTimeTrace::PhaseTotalsEnabled = false;
+constexpr const char *CompileTimeTrace::PhaseCategory;
+
+namespace {
+struct Span {
+  std::string Category;
+  std::string Name;
+  uint64_t Start;
+  uint64_t End;
+  uint64_t ThreadID;
+};
+
+struct TraceState {
+  std::mutex Lock;
+  std::vector<Span> Spans;
+  llvm::DenseMap<size_t, uint64_t> ThreadIDs;
+
+  /// The total time of each phase, in the order the phases first ended.
+  std::vector<std::pair<std::string, uint64_t>> PhaseTotals;
+};
+} // end anonymous namespace
+
+static TraceState &getState() {
+  static TraceState State;
+  return State;
+}
+
+static uint64_t getProcessID() {
+#if LLVM_ON_UNIX && HAVE_UNISTD_H
+  return getpid();
+#else
+  return 0;
+#endif
+}
+
+void CompileTimeTrace::enable() {
+  Enabled = true;
+}
+
+void CompileTimeTrace::enablePhaseTotals() {
+  PhaseTotalsEnabled = true;
+}
+
+uint64_t CompileTimeTrace::now() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(
+      steady_clock::now().time_since_epoch()).count();
+}
+
+void CompileTimeTrace::record(StringRef category, StringRef name,
+                              uint64_t startMicros, uint64_t endMicros,
+                              Optional<uint64_t> threadID) {
+  if (!isEnabled(category))
+    return;
+
+  auto &state = getState();
+  std::lock_guard<std::mutex> guard(state.Lock);
+
+  if (PhaseTotalsEnabled && category == PhaseCategory) {
+    auto known = std::find_if(state.PhaseTotals.begin(),
+                              state.PhaseTotals.end(),
+                              [&](const std::pair<std::string, uint64_t> &p) {
+      return p.first == name;
+    });
+    if (known == state.PhaseTotals.end())
+      state.PhaseTotals.push_back({name, endMicros - startMicros});
+    else
+      known->second += endMicros - startMicros;
+  }
+
+  if (!Enabled)
+    return;
+
+  // Number the threads of this process in the order they first record a
+  // span, so the main thread is lane 0.
+  if (!threadID) {
+    size_t key = std::hash<std::thread::id>()(std::this_thread::get_id());
+    auto inserted = state.ThreadIDs.insert({key, state.ThreadIDs.size()});
+    threadID = inserted.first->second;
+  }
+
+  state.Spans.push_back({category, name, startMicros, endMicros, *threadID});
+}
+
+static void writeJSONString(raw_ostream &OS, StringRef str) {
+  OS << '"';
+  for (unsigned char c : str) {
+    switch (c) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (c < 0x20)
+        OS << llvm::format("\\u%04x", c);
+      else
+        OS << c;
+    }
+  }
+  OS << '"';
+}
+
+bool CompileTimeTrace::startFile(StringRef path, std::string &error) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(path, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    error = EC.message();
+    return true;
+  }
+  OS << "[\n";
+  return false;
+}
+
+bool CompileTimeTrace::appendToFile(StringRef path, StringRef processName,
+                                    std::string &error) {
+  uint64_t pid = getProcessID();
+
+  // Format all the events first and write them with a single call, so that
+  // events appended by concurrent frontend jobs don't interleave. Every event
+  // is followed by a comma, which the format allows before the optional
+  // closing bracket.
+  SmallString<4096> buffer;
+  llvm::raw_svector_ostream bufferOS(buffer);
+
+  // A file that does not exist yet needs the opening bracket.
+  if (!llvm::sys::fs::exists(path))
+    bufferOS << "[\n";
+
+  bufferOS << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid
+           << ", \"args\": {\"name\": ";
+  writeJSONString(bufferOS, processName);
+  bufferOS << "}},\n";
+
+  {
+    auto &state = getState();
+    std::lock_guard<std::mutex> guard(state.Lock);
+    for (auto &span : state.Spans) {
+      bufferOS << "{\"name\": ";
+      writeJSONString(bufferOS, span.Name);
+      bufferOS << ", \"cat\": ";
+      writeJSONString(bufferOS, span.Category);
+      bufferOS << ", \"ph\": \"X\", \"ts\": " << span.Start
+               << ", \"dur\": " << (span.End - span.Start)
+               << ", \"pid\": " << pid << ", \"tid\": " << span.ThreadID
+               << "},\n";
+    }
+  }
+  bufferOS.flush();
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(path, EC, llvm::sys::fs::F_Append |
+                                    llvm::sys::fs::F_Text);
+  if (EC) {
+    error = EC.message();
+    return true;
+  }
+  OS.SetUnbuffered();
+  OS << buffer;
+  if (OS.has_error()) {
+    error = "could not write trace";
+    OS.clear_error();
+    return true;
+  }
+  return false;
+}
+
+bool CompileTimeTrace::appendPhaseTotals(StringRef path, StringRef processName,
+                                         std::string &error) {
+  // As with the trace, write the line with a single call so that lines from
+  // concurrent jobs and the driver don't interleave.
+  SmallString<256> buffer;
+  llvm::raw_svector_ostream bufferOS(buffer);
+  bufferOS << "{\"kind\":\"phases\",\"pid\":" << getProcessID()
+           << ",\"name\":";
+  writeJSONString(bufferOS, processName);
+  bufferOS << ",\"phases\":{";
+  {
+    auto &state = getState();
+    std::lock_guard<std::mutex> guard(state.Lock);
+    for (auto &phase : state.PhaseTotals) {
+      if (&phase != &state.PhaseTotals.front())
+        bufferOS << ',';
+      writeJSONString(bufferOS, phase.first);
+      bufferOS << ':' << phase.second;
+    }
+  }
+  bufferOS << "}}\n";
+  bufferOS.flush();
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(path, EC, llvm::sys::fs::F_Append |
+                                    llvm::sys::fs::F_Text);
+  if (EC) {
+    error = EC.message();
+    return true;
+  }
+  OS.SetUnbuffered();
+  OS << buffer;
+  if (OS.has_error()) {
+    error = "could not write progress output";
+    OS.clear_error();
+    return true;
+  }
+  return false;
+}
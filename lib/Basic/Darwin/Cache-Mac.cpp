@@ -65,6 +65,11 @@ void CacheImpl::removeAll() {
   cache_remove_all(static_cast<cache_t*>(Impl));
 }
 
+void CacheImpl::setCostLimit(size_t Limit) {
+  // FIXME: libcache only evicts under system memory pressure and has no
+  // cost limit.
+}
+
 void CacheImpl::destroy() {
   cache_destroy(static_cast<cache_t*>(Impl));
 }
@@ -21,6 +21,8 @@
 #include "swift/Basic/Punycode.h"
 #include "swift/Basic/UUID.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
+#include <algorithm>
 #include <functional>
 #include <vector>
 #include <cstdlib>
@@ -98,6 +100,97 @@ Node::~Node() {
   unreachable("bad payload kind");
 }
 
+//===----------------------------------------------------------------------===//
+// Node allocation
+//===----------------------------------------------------------------------===//
+
+NodeArena::~NodeArena() {
+  for (void *Slab : Slabs)
+    free(Slab);
+}
+
+void *NodeArena::allocate(size_t Size, size_t Alignment) {
+  assert(Size + Alignment <= SlabSize && "allocation too large for arena");
+  for (;;) {
+    if (CurPtr) {
+      uintptr_t Aligned = (uintptr_t(CurPtr) + Alignment - 1)
+                            & ~uintptr_t(Alignment - 1);
+      if (Aligned + Size <= uintptr_t(End)) {
+        CurPtr = reinterpret_cast<char *>(Aligned + Size);
+        return reinterpret_cast<void *>(Aligned);
+      }
+      ++CurSlab;
+    }
+    // Move on to the next slab, reusing one kept by reset() if possible.
+    if (CurSlab == Slabs.size()) {
+      void *Slab = malloc(SlabSize);
+      if (!Slab)
+        unreachable("out of memory in demangler arena");
+      Slabs.push_back(Slab);
+    }
+    CurPtr = static_cast<char *>(Slabs[CurSlab]);
+    End = CurPtr + SlabSize;
+  }
+}
+
+void NodeArena::reset() {
+  CurSlab = 0;
+  CurPtr = Slabs.empty() ? nullptr : static_cast<char *>(Slabs.front());
+  End = CurPtr ? CurPtr + SlabSize : nullptr;
+}
+
+/// The arena of the innermost DemangleSession call on this thread.
+static LLVM_THREAD_LOCAL std::shared_ptr<NodeArena> *CurrentArena;
+
+namespace {
+  /// Makes NodeFactory allocate from an arena for the lifetime of the scope.
+  class ArenaScope {
+    std::shared_ptr<NodeArena> *Saved;
+  public:
+    explicit ArenaScope(std::shared_ptr<NodeArena> &Arena)
+        : Saved(CurrentArena) {
+      CurrentArena = &Arena;
+    }
+    ~ArenaScope() { CurrentArena = Saved; }
+  };
+} // end anonymous namespace
+
+template <typename... ArgTypes>
+NodePointer NodeFactory::allocate(ArgTypes &&... Args) {
+  if (!CurrentArena)
+    return NodePointer(new Node(std::forward<ArgTypes>(Args)...));
+
+  // The control block is allocated from the arena as well, and holds a
+  // reference to it through its copy of the allocator.
+  std::shared_ptr<NodeArena> &Arena = *CurrentArena;
+  void *Memory = Arena->allocate(sizeof(Node), alignof(Node));
+  return NodePointer(new (Memory) Node(std::forward<ArgTypes>(Args)...),
+                     [](Node *N) { N->~Node(); },
+                     NodeArenaAllocator<Node>(Arena));
+}
+
+NodePointer NodeFactory::create(Node::Kind K) {
+  return allocate(K);
+}
+NodePointer NodeFactory::create(Node::Kind K, Node::IndexType Index) {
+  return allocate(K, Index);
+}
+NodePointer NodeFactory::create(Node::Kind K, llvm::StringRef Text) {
+  return allocate(K, Text.str());
+}
+NodePointer NodeFactory::create(Node::Kind K, std::string &&Text) {
+  return allocate(K, std::move(Text));
+}
+
+void DemangleSession::prepareArena() {
+  // Recycle the slabs if nothing demangled before is still alive; otherwise
+  // keep allocating after it.
+  if (!Arena)
+    Arena = std::make_shared<NodeArena>();
+  else if (Arena.use_count() == 1)
+    Arena->reset();
+}
+
 namespace {
   struct FindPtr {
     FindPtr(Node *v) : Target(v) {}
@@ -3632,3 +3725,42 @@ std::string Demangle::demangleTypeAsString(const char *MangledName,
   return demangling;
 }
 
+NodePointer
+DemangleSession::demangleSymbolAsNode(const char *MangledName,
+                                      size_t MangledNameLength,
+                                      const DemangleOptions &Options) {
+  prepareArena();
+  ArenaScope Scope(Arena);
+  return Demangle::demangleSymbolAsNode(MangledName, MangledNameLength,
+                                        Options);
+}
+
+NodePointer
+DemangleSession::demangleTypeAsNode(const char *MangledName,
+                                    size_t MangledNameLength,
+                                    const DemangleOptions &Options) {
+  prepareArena();
+  ArenaScope Scope(Arena);
+  return Demangle::demangleTypeAsNode(MangledName, MangledNameLength, Options);
+}
+
+std::string
+DemangleSession::demangleSymbolAsString(const char *MangledName,
+                                        size_t MangledNameLength,
+                                        const DemangleOptions &Options) {
+  prepareArena();
+  ArenaScope Scope(Arena);
+  return Demangle::demangleSymbolAsString(MangledName, MangledNameLength,
+                                          Options);
+}
+
+std::string
+DemangleSession::demangleTypeAsString(const char *MangledName,
+                                      size_t MangledNameLength,
+                                      const DemangleOptions &Options) {
+  prepareArena();
+  ArenaScope Scope(Arena);
+  return Demangle::demangleTypeAsString(MangledName, MangledNameLength,
+                                        Options);
+}
+
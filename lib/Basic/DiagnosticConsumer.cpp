@@ -23,6 +23,15 @@ using namespace swift;
 
 DiagnosticConsumer::~DiagnosticConsumer() { }
 
+bool NullDiagnosticConsumer::needsDiagnosticText(SourceLoc Loc,
+                                                 DiagnosticKind Kind,
+                                                 const DiagnosticInfo &Info) {
+  // The text is only ever used for debug output.
+  bool NeedsText = false;
+  DEBUG(NeedsText = true);
+  return NeedsText;
+}
+
 void NullDiagnosticConsumer::handleDiagnostic(SourceManager &SM,
                                               SourceLoc Loc,
                                               DiagnosticKind Kind,
@@ -42,9 +42,11 @@ DummyTaskQueue::DummyTaskQueue(unsigned NumberOfParallelTasks)
 DummyTaskQueue::~DummyTaskQueue() = default;
 
 void DummyTaskQueue::addTask(const char *ExecPath, ArrayRef<const char *> Args,
-                             ArrayRef<const char *> Env, void *Context) {
-  QueuedTasks.emplace(
-    std::unique_ptr<DummyTask>(new DummyTask(ExecPath, Args, Env, Context)));
+                             ArrayRef<const char *> Env, void *Context,
+                             int64_t Priority, uint64_t ProjectedMemory) {
+  QueuedTasks.push(
+    std::unique_ptr<DummyTask>(new DummyTask(ExecPath, Args, Env, Context)),
+    Priority);
 }
 
 bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
@@ -65,8 +67,7 @@ bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
     // at the parallel limit, and no earlier subtasks have failed.
     while (!SubtaskFailed && !QueuedTasks.empty() &&
            ExecutingTasks.size() < MaxNumberOfParallelTasks) {
-      std::unique_ptr<DummyTask> T(QueuedTasks.front().release());
-      QueuedTasks.pop();
+      std::unique_ptr<DummyTask> T = QueuedTasks.pop();
 
       if (Began)
         Began(++Pid, T->Context);
@@ -80,7 +81,8 @@ bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
 
     if (Finished) {
       std::string Output = "Output placeholder\n";
-        if (Finished(P.first, 0, Output, P.second->Context) ==
+        if (Finished(P.first, 0, Output, TaskProcessInformation(),
+                     P.second->Context) ==
             TaskFinishedResponse::StopExecution)
           SubtaskFailed = true;
     }
@@ -34,6 +34,7 @@
 #include "swift/ClangImporter/ClangImporterOptions.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/Config.h"
+#include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Mangle.h"
 #include "clang/Basic/CharInfo.h"
@@ -53,7 +54,10 @@
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/Sema.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include <algorithm>
 #include <memory>
@@ -119,6 +123,59 @@ namespace {
     }
   };
 
+  /// Collects the files a precompiled bridging header was built from,
+  /// including the inputs of any module files it imports.
+  class PrecompiledHeaderInputCollector : public clang::ASTReaderListener {
+    clang::FileManager &FileMgr;
+    const clang::PCHContainerReader &ContainerReader;
+    llvm::StringSet<> VisitedModuleFiles;
+  public:
+    std::vector<std::string> Inputs;
+
+    PrecompiledHeaderInputCollector(clang::FileManager &fileMgr,
+                                    const clang::PCHContainerReader &reader)
+      : FileMgr(fileMgr), ContainerReader(reader) {}
+
+    bool needsInputFileVisitation() override { return true; }
+    bool needsSystemInputFileVisitation() override { return true; }
+    bool needsImportVisitation() const override { return true; }
+
+    bool visitInputFile(StringRef file, bool isSystem,
+                        bool isOverridden, bool isExplicitModule) override {
+      if (!isOverridden)
+        Inputs.push_back(file);
+      return true;
+    }
+
+    void visitImport(StringRef moduleFile) override {
+      if (!VisitedModuleFiles.insert(moduleFile).second)
+        return;
+      Inputs.push_back(moduleFile);
+      clang::ASTReader::readASTFileControlBlock(moduleFile, FileMgr,
+                                                ContainerReader,
+                                                /*FindModuleFileExtensions=*/false,
+                                                *this);
+    }
+  };
+
+  /// Records the module imports that were serialized into a precompiled
+  /// bridging header.
+  class PrecompiledHeaderImportCollector : public clang::ASTConsumer {
+    ClangImporter::Implementation &Impl;
+  public:
+    explicit PrecompiledHeaderImportCollector(
+        ClangImporter::Implementation &impl) : Impl(impl) {}
+
+    bool HandleTopLevelDecl(clang::DeclGroupRef group) override {
+      for (auto *D : group) {
+        auto *import = dyn_cast<clang::ImportDecl>(D);
+        if (import && !import->getImportedOwningModule())
+          Impl.PrecompiledBridgingHeaderImports.push_back(import);
+      }
+      return true;
+    }
+  };
+
   class StdStringMemBuffer : public llvm::MemoryBuffer {
     const std::string storage;
     const std::string name;
@@ -591,6 +648,20 @@ ClangImporter::create(ASTContext &ctx,
   if (importerOpts.Mode == ClangImporterOptions::Modes::EmbedBitcode)
     return importer;
 
+  // Load the precompiled bridging header instead of parsing the header, as
+  // long as it is still up to date. The bridging header lookup table is
+  // built while the header is parsed, so it can't come from a PCH.
+  bool usePrecompiledBridgingHeader = false;
+  if (!importerOpts.PrecompiledBridgingHeader.empty() &&
+      !importer->Impl.UseSwiftLookupTables) {
+    instance.createFileManager();
+    if (importer->Impl.canUsePrecompiledBridgingHeader(
+          importerOpts.PrecompiledBridgingHeader)) {
+      ppOpts.ImplicitPCHInclude = importerOpts.PrecompiledBridgingHeader;
+      usePrecompiledBridgingHeader = true;
+    }
+  }
+
   bool canBegin = action->BeginSourceFile(instance,
                                           instance.getFrontendOpts().Inputs[0]);
   if (!canBegin)
@@ -611,6 +682,11 @@ ClangImporter::create(ASTContext &ctx,
 
   // Manually run the action, so that the TU stays open for additional parsing.
   instance.createSema(action->getTranslationUnitKind(), nullptr);
+  if (usePrecompiledBridgingHeader) {
+    PrecompiledHeaderImportCollector collector(importer->Impl);
+    instance.getModuleManager()->StartTranslationUnit(&collector);
+    instance.getModuleManager()->StartTranslationUnit(nullptr);
+  }
   importer->Impl.Parser.reset(new clang::Parser(clangPP, instance.getSema(),
                                                 /*skipFunctionBodies=*/false));
 
@@ -692,6 +768,11 @@ void ClangImporter::Implementation::addEntryToLookupTable(
        SwiftLookupTable &table,
        clang::NamedDecl *named)
 {
+  // Record the names of the declaration, so that clients of the module don't
+  // have to compute them again.
+  if (table.storesImportedNames())
+    storeImportedNames(clangSema, table, named);
+
   // Determine whether this declaration is suppressed in Swift.
   bool suppressDecl = false;
   if (auto objcMethod = dyn_cast<clang::ObjCMethodDecl>(named)) {
@@ -855,6 +936,83 @@ bool ClangImporter::Implementation::importHeader(
   return false;
 }
 
+bool ClangImporter::Implementation::canUsePrecompiledBridgingHeader(
+    StringRef pchPath) {
+  clang::FileManager &fileMgr = Instance->getFileManager();
+  const clang::PCHContainerReader &reader =
+    Instance->getPCHContainerReader();
+
+  // The PCH must have been built with a compatible configuration.
+  if (!clang::ASTReader::isAcceptableASTFile(
+        pchPath, fileMgr, reader, Instance->getLangOpts(),
+        Instance->getTargetOpts(), Instance->getPreprocessorOpts(),
+        Instance->getSpecificModuleCachePath()))
+    return false;
+
+  const clang::FileEntry *pchFile = fileMgr.getFile(pchPath);
+  if (!pchFile)
+    return false;
+
+  // ...and must be newer than everything it was built from, since Clang
+  // would otherwise reject it as out of date and fail the whole import.
+  PrecompiledHeaderInputCollector collector(fileMgr, reader);
+  if (clang::ASTReader::readASTFileControlBlock(
+        pchPath, fileMgr, reader, /*FindModuleFileExtensions=*/false,
+        collector))
+    return false;
+
+  for (auto &input : collector.Inputs) {
+    llvm::sys::fs::file_status status;
+    if (llvm::sys::fs::status(input, status))
+      return false;
+    if (status.getLastModificationTime().toEpochTime() >=
+        pchFile->getModificationTime())
+      return false;
+  }
+
+  std::string header = clang::ASTReader::getOriginalSourceFile(
+    pchPath, fileMgr, reader, Instance->getDiagnostics());
+  PrecompiledBridgingHeaderSource = fileMgr.getFile(header);
+  if (!PrecompiledBridgingHeaderSource)
+    return false;
+
+  PrecompiledBridgingHeaderInputs = std::move(collector.Inputs);
+  return true;
+}
+
+void ClangImporter::Implementation::importPrecompiledBridgingHeader(
+    ClangImporter &importer, Module *adapter, bool trackParsedSymbols) {
+  assert(adapter);
+  ImportedHeaderOwners.push_back(adapter);
+
+  // The header can only be used this way once.
+  PrecompiledBridgingHeaderSource = nullptr;
+
+  for (auto &input : PrecompiledBridgingHeaderInputs)
+    importer.addDependency(input);
+
+  // The module imports in the header were already made visible when the PCH
+  // was loaded; all that's left is to reflect them in Swift.
+  for (auto *clangImport : PrecompiledBridgingHeaderImports) {
+    Module *nativeImported =
+      finishLoadingClangModule(importer, clangImport->getImportedModule(),
+                               /*adapter=*/true);
+    ImportedHeaderExports.push_back({ /*filter=*/{}, nativeImported });
+    BridgeHeaderTopLevelImports.push_back(
+      createImportDecl(SwiftContext, adapter, clangImport, {}));
+  }
+
+  if (trackParsedSymbols) {
+    for (auto *D : getClangASTContext().getTranslationUnitDecl()->decls()) {
+      if (D->isFromASTFile() && !D->getImportedOwningModule() &&
+          !isa<clang::ImportDecl>(D))
+        addBridgeHeaderTopLevelDecls(D);
+    }
+  }
+
+  bumpGeneration();
+}
+
 bool ClangImporter::importHeader(StringRef header, Module *adapter,
                                  off_t expectedSize, time_t expectedModTime,
                                  StringRef cachedContents, SourceLoc diagLoc) {
@@ -887,6 +1045,11 @@ bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
     return true;
   }
 
+  if (headerFile == Impl.PrecompiledBridgingHeaderSource) {
+    Impl.importPrecompiledBridgingHeader(*this, adapter, trackParsedSymbols);
+    return false;
+  }
+
   llvm::SmallString<128> importLine{"#import \""};
   importLine += header;
   importLine += "\"\n";
@@ -947,6 +1110,43 @@ std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
   return result;
 }
 
+bool ClangImporter::emitBridgingPCH(StringRef headerPath,
+                                    StringRef outputPCHPath) {
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getFrontendOpts().Inputs.clear();
+  invocation->getFrontendOpts().Inputs.push_back(
+      clang::FrontendInputFile(headerPath, clang::IK_ObjC));
+  invocation->getFrontendOpts().OutputFile = outputPCHPath;
+  invocation->getFrontendOpts().ProgramAction = clang::frontend::GeneratePCH;
+  invocation->getFrontendOpts().ModuleFileExtensions.clear();
+
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+
+  clang::CompilerInstance emitInstance(
+    Impl.Instance->getPCHContainerOperations());
+  emitInstance.setInvocation(&*invocation);
+  emitInstance.createDiagnostics(&Impl.Instance->getDiagnosticClient(),
+                                 /*ShouldOwnClient=*/false);
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  emitInstance.setFileManager(&fileManager);
+  emitInstance.createSourceManager(fileManager);
+  emitInstance.setTarget(&Impl.Instance->getTarget());
+
+  clang::GeneratePCHAction action;
+  emitInstance.ExecuteAction(action);
+
+  if (emitInstance.getDiagnostics().hasErrorOccurred()) {
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+  return false;
+}
+
 void ClangImporter::collectSubModuleNamesAndVisibility(
     ArrayRef<std::pair<Identifier, SourceLoc>> path,
     std::vector<std::pair<std::string, bool>> &namesVisiblePairs) {
@@ -1246,9 +1446,13 @@ ClangImporter::Implementation::getAPINotesForModule(
     scratch.clear();
     llvm::sys::path::append(scratch, searchPath, notesFilename.str());
 
-    // Try to open the file.
+    // Try to open the file. The reader looks entries up in the file's
+    // on-disk hash tables rather than reading it up front, so map it instead
+    // of copying it. Requiring a null terminator would force a copy whenever
+    // the file size is a multiple of the page size.
     llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> bufferOrErr
-      = llvm::MemoryBuffer::getFile(scratch.str());
+      = llvm::MemoryBuffer::getFile(scratch.str(), /*FileSize=*/-1,
+                                    /*RequiresNullTerminator=*/false);
     if (!bufferOrErr)
       return false;
 
@@ -2071,6 +2275,139 @@ considerErrorImport(ClangImporter::Implementation &importer,
   return None;
 }
 
+/// Encodes an imported name so that it can be stored in a Swift lookup table.
+///
+/// \sa decodeImportedName
+static void
+encodeImportedName(const ClangImporter::Implementation::ImportedName &name,
+                   SmallVectorImpl<char> &buffer) {
+  using namespace llvm::support;
+  llvm::raw_svector_ostream out(buffer);
+  endian::Writer<little> writer(out);
+
+  auto writeString = [&](StringRef str) {
+    writer.write<uint16_t>(str.size());
+    out << str;
+  };
+  auto writeDeclName = [&](DeclName declName) {
+    writer.write<uint8_t>(!declName ? 0 : declName.isSimpleName() ? 1 : 2);
+    if (!declName)
+      return;
+    writeString(declName.getBaseName().str());
+    if (declName.isSimpleName())
+      return;
+    writer.write<uint16_t>(declName.getArgumentNames().size());
+    for (auto argName : declName.getArgumentNames())
+      writeString(argName.empty() ? StringRef() : argName.str());
+  };
+
+  writeDeclName(name.Imported);
+  writeDeclName(name.Alias);
+  writer.write<uint8_t>(name.HasCustomName | (name.DroppedVariadic << 1) |
+                        (name.IsSubscriptAccessor << 2));
+  writer.write<uint8_t>(static_cast<uint8_t>(name.InitKind));
+  writer.write<uint8_t>(name.ErrorInfo.hasValue());
+  if (auto errorInfo = name.ErrorInfo) {
+    writer.write<uint8_t>(errorInfo->Kind);
+    writer.write<uint8_t>(errorInfo->IsOwned);
+    writer.write<uint16_t>(errorInfo->ParamIndex);
+    writer.write<uint8_t>(errorInfo->ReplaceParamWithVoid);
+  }
+}
+
+/// Decodes an imported name stored by encodeImportedName.
+static ClangImporter::Implementation::ImportedName
+decodeImportedName(ASTContext &ctx, StringRef data) {
+  using namespace llvm::support;
+  auto cursor = reinterpret_cast<const uint8_t *>(data.data());
+  auto readString = [&]() -> StringRef {
+    auto length = endian::readNext<uint16_t, little, unaligned>(cursor);
+    StringRef str(reinterpret_cast<const char *>(cursor), length);
+    cursor += length;
+    return str;
+  };
+  auto readDeclName = [&]() -> DeclName {
+    auto kind = endian::readNext<uint8_t, little, unaligned>(cursor);
+    if (kind == 0)
+      return DeclName();
+    Identifier baseName = ctx.getIdentifier(readString());
+    if (kind == 1)
+      return baseName;
+    auto numArgs = endian::readNext<uint16_t, little, unaligned>(cursor);
+    SmallVector<Identifier, 4> argNames;
+    while (numArgs--) {
+      StringRef argName = readString();
+      argNames.push_back(argName.empty() ? Identifier()
+                                         : ctx.getIdentifier(argName));
+    }
+    return DeclName(ctx, baseName, argNames);
+  };
+
+  ClangImporter::Implementation::ImportedName result;
+  result.Imported = readDeclName();
+  result.Alias = readDeclName();
+  auto flags = endian::readNext<uint8_t, little, unaligned>(cursor);
+  result.HasCustomName = flags & 0x01;
+  result.DroppedVariadic = flags & 0x02;
+  result.IsSubscriptAccessor = flags & 0x04;
+  result.InitKind = static_cast<CtorInitializerKind>(
+                      endian::readNext<uint8_t, little, unaligned>(cursor));
+  if (endian::readNext<uint8_t, little, unaligned>(cursor)) {
+    ClangImporter::Implementation::ImportedErrorInfo errorInfo;
+    errorInfo.Kind = static_cast<ForeignErrorConvention::Kind>(
+                       endian::readNext<uint8_t, little, unaligned>(cursor));
+    errorInfo.IsOwned = static_cast<ForeignErrorConvention::IsOwned_t>(
+                          endian::readNext<uint8_t, little, unaligned>(cursor));
+    errorInfo.ParamIndex = endian::readNext<uint16_t, little, unaligned>(cursor);
+    errorInfo.ReplaceParamWithVoid =
+      endian::readNext<uint8_t, little, unaligned>(cursor);
+    result.ErrorInfo = errorInfo;
+  }
+  assert(reinterpret_cast<const char *>(cursor) == data.end() &&
+         "malformed imported name");
+  return result;
+}
+
+void ClangImporter::Implementation::storeImportedNames(
+       clang::Sema &clangSema, SwiftLookupTable &table,
+       clang::NamedDecl *named) {
+  SmallString<64> buffer;
+  encodeImportedName(importFullName(named, None, nullptr, &clangSema), buffer);
+  table.addImportedName(named, /*suppressFactoryAsInit=*/false, buffer);
+
+  // Methods are also imported without turning factory methods into
+  // initializers.
+  if (isa<clang::ObjCMethodDecl>(named)) {
+    buffer.clear();
+    encodeImportedName(
+      importFullName(named, ImportNameFlags::SuppressFactoryMethodAsInit,
+                     nullptr, &clangSema),
+      buffer);
+    table.addImportedName(named, /*suppressFactoryAsInit=*/true, buffer);
+  }
+}
+
+auto ClangImporter::Implementation::lookupStoredImportedName(
+       const clang::NamedDecl *D,
+       ImportNameOptions options) -> Optional<ImportedName> {
+  if (!UseSwiftLookupTables || !D->isFromASTFile())
+    return None;
+
+  auto clangModule = getClangSubmoduleForDecl(D);
+  if (!clangModule || !*clangModule)
+    return None;
+  auto table = findLookupTable(*clangModule);
+  if (!table)
+    return None;
+
+  bool suppressFactoryAsInit =
+    options.contains(ImportNameFlags::SuppressFactoryMethodAsInit);
+  auto stored = table->lookupImportedName(D, suppressFactoryAsInit);
+  if (!stored)
+    return None;
+  return decodeImportedName(SwiftContext, *stored);
+}
+
 auto ClangImporter::Implementation::importFullName(
        const clang::NamedDecl *D,
        ImportNameOptions options,
@@ -2119,6 +2456,13 @@ auto ClangImporter::Implementation::importFullName(
     }
   }
 
+  // Declarations from a module file may have had their names computed when
+  // the module was built.
+  if (!clangSemaOverride) {
+    if (auto stored = lookupStoredImportedName(D, options))
+      return *stored;
+  }
+
   // Local function that forms a DeclName from the given strings.
   auto formDeclName = [&](StringRef baseName,
                           ArrayRef<StringRef> argumentNames,
@@ -4400,7 +4744,9 @@ llvm::hash_code ClangImporter::Implementation::hashExtension(
                   llvm::hash_code code) const {
   return llvm::hash_combine(code, StringRef("swift.lookup"),
                             SWIFT_LOOKUP_TABLE_VERSION_MAJOR,
-                            SWIFT_LOOKUP_TABLE_VERSION_MINOR);
+                            SWIFT_LOOKUP_TABLE_VERSION_MINOR,
+                            OmitNeedlessWords,
+                            InferDefaultArguments);
 }
 
 std::unique_ptr<clang::ModuleFileExtensionWriter>
@@ -5913,6 +5913,128 @@ ClangImporter::Implementation::loadAllMembers(Decl *D, uint64_t unused,
 
 }
 
+/// Returns true if \p proto, or a protocol it inherits, has a member with
+/// the given base name that loadAllMembers may mirror into adopting types.
+static bool
+protocolMayHaveMember(ClangImporter::Implementation &Impl,
+                      const clang::ObjCProtocolDecl *proto, StringRef baseName,
+                      SmallPtrSetImpl<const clang::ObjCProtocolDecl *> &visited) {
+  proto = proto->getDefinition();
+  if (!proto || !visited.insert(proto).second)
+    return false;
+
+  // Be conservative if the protocol's lookup table can't be found.
+  auto clangModule = Impl.getClangSubmoduleForDecl(proto);
+  if (!clangModule)
+    return true;
+  auto table = Impl.findLookupTable(*clangModule);
+  if (!table)
+    return true;
+
+  auto protoContext = const_cast<clang::ObjCProtocolDecl *>(proto);
+  if (!table->lookup(baseName, protoContext).empty())
+    return true;
+
+  for (auto inherited : proto->protocols())
+    if (protocolMayHaveMember(Impl, inherited, baseName, visited))
+      return true;
+  return false;
+}
+
+bool
+ClangImporter::Implementation::loadNamedMembers(
+    const IterableDeclContext *IDC, Identifier name, uint64_t unused,
+    SmallVectorImpl<ValueDecl *> &members) {
+  // Members can only be found by name through the Swift lookup tables.
+  if (!UseSwiftLookupTables)
+    return false;
+
+  // Initializers and subscripts are also synthesized from members with other
+  // names, such as factory methods and subscript accessors.
+  if (name == SwiftContext.Id_init || name == SwiftContext.Id_subscript)
+    return false;
+
+  const Decl *D;
+  if (auto nominal = dyn_cast<NominalTypeDecl>(IDC))
+    D = nominal;
+  else
+    D = cast<ExtensionDecl>(IDC);
+
+  // Only handle Objective-C classes and categories. Protocols have to know
+  // whether all of their requirements could be imported.
+  const clang::ObjCContainerDecl *container;
+  const clang::ObjCInterfaceDecl *clangClass;
+  llvm::SmallPtrSet<const clang::ObjCProtocolDecl *, 8> visitedProtocols;
+  bool mayMirror = false;
+  if (auto category =
+        dyn_cast_or_null<clang::ObjCCategoryDecl>(D->getClangDecl())) {
+    container = category;
+    clangClass = category->getClassInterface();
+    for (auto proto : category->protocols())
+      mayMirror |= protocolMayHaveMember(*this, proto, name.str(),
+                                         visitedProtocols);
+  } else if (auto objcClass =
+               dyn_cast_or_null<clang::ObjCInterfaceDecl>(D->getClangDecl())) {
+    container = clangClass = objcClass->getDefinition();
+    if (clangClass) {
+      for (auto proto : clangClass->all_referenced_protocols())
+        mayMirror |= protocolMayHaveMember(*this, proto, name.str(),
+                                           visitedProtocols);
+    }
+  } else {
+    return false;
+  }
+
+  // Members of adopted protocols may be mirrored into the type.
+  if (!clangClass || mayMirror)
+    return false;
+
+  // The instance methods of a root class are also imported as class methods,
+  // which can only be done once per context.
+  if (!clangClass->getSuperClass())
+    return false;
+
+  auto clangModule = getClangSubmoduleForDecl(container);
+  if (!clangModule)
+    return false;
+  auto table = findLookupTable(*clangModule);
+  if (!table)
+    return false;
+
+  clang::PrettyStackTraceDecl trace(container, clang::SourceLocation(),
+                                    Instance->getSourceManager(),
+                                    "loading named members for");
+
+  ImportingEntityRAII Importing(*this);
+
+  // Categories are imported as extensions of the class, so the table lists
+  // their members under the class.
+  auto searchContext = const_cast<clang::ObjCInterfaceDecl *>(clangClass);
+  for (auto entry : table->lookup(name.str(), searchContext)) {
+    auto nd = entry.dyn_cast<clang::NamedDecl *>();
+    if (!nd || nd != nd->getCanonicalDecl())
+      continue;
+
+    // Members of other categories belong to other extensions.
+    if (nd->getDeclContext() != container)
+      continue;
+
+    auto member = cast_or_null<ValueDecl>(importDecl(nd));
+    if (!member) {
+      // When a property can't be imported, loadAllMembers falls back to its
+      // getter, which isn't listed in the table.
+      if (isa<clang::ObjCPropertyDecl>(nd))
+        return false;
+      continue;
+    }
+
+    if (member->getName() == name)
+      members.push_back(member);
+  }
+
+  return true;
+}
+
 void ClangImporter::Implementation::loadAllConformances(
        const Decl *D, uint64_t contextData,
        SmallVectorImpl<ProtocolConformance *> &Conformances) {
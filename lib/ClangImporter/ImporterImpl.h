@@ -643,6 +643,17 @@ public:
 
   /// Tracks macro definitions from the bridging header.
   std::vector<clang::IdentifierInfo *> BridgeHeaderMacros;
+
+  /// The bridging header whose precompiled form was loaded when the importer
+  /// was created, until it is imported.
+  const clang::FileEntry *PrecompiledBridgingHeaderSource = nullptr;
+
+  /// The files the precompiled bridging header was built from.
+  std::vector<std::string> PrecompiledBridgingHeaderInputs;
+
+  /// The module imports of the precompiled bridging header.
+  std::vector<clang::ImportDecl *> PrecompiledBridgingHeaderImports;
+
   /// Tracks included headers from the bridging header.
   llvm::DenseSet<const clang::FileEntry *> BridgeHeaderFiles;
 
@@ -692,6 +703,19 @@ public:
                     bool trackParsedSymbols,
                     std::unique_ptr<llvm::MemoryBuffer> contents);
 
+  /// Returns true if the precompiled bridging header at \p pchPath can be
+  /// used in place of parsing the header it was built from.
+  ///
+  /// On success, records the header's source file and the files the
+  /// precompiled header depends on.
+  bool canUsePrecompiledBridgingHeader(StringRef pchPath);
+
+  /// Makes the already-loaded precompiled bridging header visible to Swift,
+  /// as importHeader does for a header that is parsed textually.
+  void importPrecompiledBridgingHeader(ClangImporter &importer,
+                                       Module *adapter,
+                                       bool trackParsedSymbols);
+
   /// Returns the redeclaration of \p D that contains its definition for any
   /// tag type decl (struct, enum, or union) or Objective-C class or protocol.
   ///
@@ -833,6 +857,16 @@ public:
                               clang::DeclContext **effectiveContext = nullptr,
                               clang::Sema *clangSemaOverride = nullptr);
 
+  /// Returns the name of \p D that was stored in its module's Swift lookup
+  /// table when the module was built, if there is one.
+  Optional<ImportedName> lookupStoredImportedName(const clang::NamedDecl *D,
+                                                  ImportNameOptions options);
+
+  /// Records the names of \p named in \p table, which is being built for a
+  /// module file.
+  void storeImportedNames(clang::Sema &clangSema, SwiftLookupTable &table,
+                          clang::NamedDecl *named);
+
   /// \brief Import the given Clang identifier into Swift.
   ///
   /// \param identifier The Clang identifier to map into Swift.
@@ -1257,6 +1291,11 @@ public:
   loadAllMembers(Decl *D, uint64_t unused,
                  bool *hasMissingRequiredMembers) override;
 
+  virtual bool
+  loadNamedMembers(const IterableDeclContext *IDC, Identifier name,
+                   uint64_t unused,
+                   SmallVectorImpl<ValueDecl *> &members) override;
+
   void
   loadAllConformances(
     const Decl *D, uint64_t contextData,
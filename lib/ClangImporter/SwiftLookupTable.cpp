@@ -221,6 +221,22 @@ SwiftLookupTable::lookupObjCMembers(StringRef baseName) {
   return result;
 }
 
+void SwiftLookupTable::addImportedName(clang::NamedDecl *decl,
+                                       bool suppressFactoryAsInit,
+                                       StringRef encodedName) {
+  assert(StoresImportedNames && "Not recording imported names");
+  ImportedNames[{decl, suppressFactoryAsInit}] = encodedName.str();
+}
+
+Optional<StringRef>
+SwiftLookupTable::lookupImportedName(const clang::NamedDecl *decl,
+                                     bool suppressFactoryAsInit) {
+  // Only names stored in a module file are looked up.
+  if (!Reader || !decl->isFromASTFile())
+    return None;
+  return Reader->lookupImportedName(decl, suppressFactoryAsInit);
+}
+
 static void printName(clang::NamedDecl *named, llvm::raw_ostream &out) {
   // If there is a name, print it.
   if (!named->getDeclName().isEmpty()) {
@@ -343,11 +359,26 @@ namespace {
     /// name.
     BASE_NAME_TO_ENTITIES_RECORD_ID
       = clang::serialization::FIRST_EXTENSION_RECORD_ID,
+
+    /// Record that contains the Swift names of the declarations in the
+    /// module, as computed when the module was built.
+    IMPORTED_NAMES_RECORD_ID,
   };
 
   using BaseNameToEntitiesTableRecordLayout
     = BCRecordLayout<BASE_NAME_TO_ENTITIES_RECORD_ID, BCVBR<16>, BCBlob>;
 
+  using ImportedNamesTableRecordLayout
+    = BCRecordLayout<IMPORTED_NAMES_RECORD_ID, BCVBR<16>, BCBlob>;
+
+  /// Forms the key for a declaration's imported name: its ID in the module
+  /// file, and whether the factory-method-as-initializer transformation was
+  /// suppressed.
+  static uint32_t getImportedNameKey(clang::serialization::DeclID id,
+                                     bool suppressFactoryAsInit) {
+    return (id << 1) | suppressFactoryAsInit;
+  }
+
   /// Trait used to write the on-disk hash table for the base name -> entities
   /// mapping.
   class BaseNameToEntitiesTableWriterInfo {
@@ -442,11 +473,49 @@ namespace {
   };
 }
 
+namespace {
+  /// Trait used to write the on-disk hash table for the declaration ->
+  /// imported name mapping.
+  class ImportedNamesTableWriterInfo {
+  public:
+    using key_type = uint32_t;
+    using key_type_ref = key_type;
+    using data_type = StringRef;
+    using data_type_ref = data_type;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      return key;
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = sizeof(uint32_t);
+      uint32_t dataLength = data.size();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      endian::Writer<little>(out).write<uint32_t>(key);
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      out << data;
+    }
+  };
+}
+
 void SwiftLookupTableWriter::writeExtensionContents(
        clang::Sema &sema,
        llvm::BitstreamWriter &stream) {
   // Populate the lookup table.
   SwiftLookupTable table(nullptr);
+  table.setStoresImportedNames();
   PopulateTable(sema, table);
 
   SmallVector<uint64_t, 64> ScratchRecord;
@@ -477,6 +546,40 @@ void SwiftLookupTableWriter::writeExtensionContents(
     BaseNameToEntitiesTableRecordLayout layout(stream);
     layout.emit(ScratchRecord, tableOffset, hashTableBlob);
   }
+
+  // Form the mapping from declarations to their imported names.
+  if (!table.ImportedNames.empty()) {
+    // Sort the entries by key, so that the table is deterministic.
+    SmallVector<std::pair<uint32_t, StringRef>, 64> entries;
+    for (const auto &entry : table.ImportedNames) {
+      auto id = Writer.getDeclID(entry.first.first);
+      entries.push_back({getImportedNameKey(id, entry.first.second),
+                         entry.second});
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const std::pair<uint32_t, StringRef> &lhs,
+                 const std::pair<uint32_t, StringRef> &rhs) {
+      return lhs.first < rhs.first;
+    });
+
+    llvm::SmallString<4096> hashTableBlob;
+    uint32_t tableOffset;
+    {
+      llvm::OnDiskChainedHashTableGenerator<ImportedNamesTableWriterInfo>
+        generator;
+      ImportedNamesTableWriterInfo info;
+      for (auto &entry : entries)
+        generator.insert(entry.first, entry.second, info);
+
+      llvm::raw_svector_ostream blobStream(hashTableBlob);
+      // Make sure that no bucket is at offset 0
+      endian::Writer<little>(blobStream).write<uint32_t>(0);
+      tableOffset = generator.Emit(blobStream, info);
+    }
+
+    ImportedNamesTableRecordLayout layout(stream);
+    layout.emit(ScratchRecord, tableOffset, hashTableBlob);
+  }
 }
 
 namespace {
@@ -555,9 +658,54 @@ namespace {
 
 }
 
+namespace {
+  /// Used to deserialize the on-disk declaration -> imported name table.
+  class ImportedNamesTableReaderInfo {
+  public:
+    using internal_key_type = uint32_t;
+    using external_key_type = internal_key_type;
+    using data_type = StringRef;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    internal_key_type GetInternalKey(external_key_type key) {
+      return key;
+    }
+
+    external_key_type GetExternalKey(internal_key_type key) {
+      return key;
+    }
+
+    hash_value_type ComputeHash(internal_key_type key) {
+      return key;
+    }
+
+    static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+      return lhs == rhs;
+    }
+
+    static std::pair<unsigned, unsigned>
+    ReadKeyDataLength(const uint8_t *&data) {
+      unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+      return { sizeof(uint32_t), dataLength };
+    }
+
+    static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+      return endian::readNext<uint32_t, little, unaligned>(data);
+    }
+
+    static data_type ReadData(internal_key_type key, const uint8_t *data,
+                              unsigned length) {
+      return StringRef((const char *)data, length);
+    }
+  };
+}
+
 namespace swift {
   using SerializedBaseNameToEntitiesTable =
     llvm::OnDiskIterableChainedHashTable<BaseNameToEntitiesTableReaderInfo>;
+  using SerializedImportedNamesTable =
+    llvm::OnDiskChainedHashTable<ImportedNamesTableReaderInfo>;
 }
 
 clang::NamedDecl *SwiftLookupTable::mapStoredDecl(uintptr_t &entry) {
@@ -612,6 +760,7 @@ SwiftLookupTable::SingleEntry SwiftLookupTable::mapStored(uintptr_t &entry) {
 SwiftLookupTableReader::~SwiftLookupTableReader() {
   OnRemove();
   delete static_cast<SerializedBaseNameToEntitiesTable *>(SerializedTable);
+  delete static_cast<SerializedImportedNamesTable *>(SerializedImportedNames);
 }
 
 std::unique_ptr<SwiftLookupTableReader>
@@ -626,6 +775,7 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
   auto cursor = stream;
   auto next = cursor.advance();
   std::unique_ptr<SerializedBaseNameToEntitiesTable> serializedTable;
+  std::unique_ptr<SerializedImportedNamesTable> serializedImportedNames;
   while (next.Kind != llvm::BitstreamEntry::EndBlock) {
     if (next.Kind == llvm::BitstreamEntry::Error)
       return nullptr;
@@ -660,6 +810,22 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
       break;
     }
 
+    case IMPORTED_NAMES_RECORD_ID: {
+      // Already saw the imported names table.
+      if (serializedImportedNames)
+        return nullptr;
+
+      uint32_t tableOffset;
+      ImportedNamesTableRecordLayout::readRecord(scratch, tableOffset);
+      auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+      serializedImportedNames.reset(
+        SerializedImportedNamesTable::Create(base + tableOffset,
+                                             base + sizeof(uint32_t),
+                                             base));
+      break;
+    }
+
     default:
       // Unknown record, possibly for use by a future version of the
       // module format.
@@ -674,7 +840,8 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
   // Create the reader.
   return std::unique_ptr<SwiftLookupTableReader>(
            new SwiftLookupTableReader(extension, reader, moduleFile, onRemove,
-                                      serializedTable.release()));
+                                      serializedTable.release(),
+                                      serializedImportedNames.release()));
 
 }
 
@@ -704,3 +871,22 @@ bool SwiftLookupTableReader::lookup(
   return true;
 }
 
+Optional<StringRef> SwiftLookupTableReader::lookupImportedName(
+                      const clang::NamedDecl *decl,
+                      bool suppressFactoryAsInit) {
+  auto table =
+    static_cast<SerializedImportedNamesTable *>(SerializedImportedNames);
+  if (!table)
+    return None;
+
+  // The table is keyed by the declaration's ID within this module file.
+  if (Reader.getOwningModuleFile(decl) != &ModuleFile)
+    return None;
+  clang::serialization::DeclID id =
+    Reader.mapGlobalIDToModuleFileGlobalID(ModuleFile, decl->getGlobalID());
+
+  auto known = table->find(getImportedNameKey(id, suppressFactoryAsInit));
+  if (known == table->end())
+    return None;
+  return *known;
+}
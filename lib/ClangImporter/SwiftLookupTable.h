@@ -50,7 +50,7 @@ const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MAJOR = 1;
 /// Lookup table major version number.
 ///
 /// When the format changes IN ANY WAY, this number should be incremented.
-const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 0;
+const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 1; // imported names
 
 /// A lookup table that maps Swift names to the set of Clang
 /// declarations with that particular name.
@@ -165,6 +165,17 @@ private:
   /// The reader responsible for lazily loading the contents of this table.
   SwiftLookupTableReader *Reader;
 
+  /// Whether the Swift names of the declarations added to this table are
+  /// recorded, to be written out with it.
+  bool StoresImportedNames = false;
+
+  /// The recorded Swift names, keyed by declaration and by whether the
+  /// factory-method-as-initializer transformation was suppressed.
+  ///
+  /// The names are encoded by the Clang importer; the table only stores them.
+  llvm::DenseMap<std::pair<clang::NamedDecl *, unsigned>, std::string>
+    ImportedNames;
+
   friend class SwiftLookupTableReader;
   friend class SwiftLookupTableWriter;
 
@@ -214,6 +225,25 @@ public:
   /// of context.
   SmallVector<clang::NamedDecl *, 4> lookupObjCMembers(StringRef baseName);
 
+  /// Whether the Swift names of declarations should be recorded with
+  /// addImportedName.
+  bool storesImportedNames() const { return StoresImportedNames; }
+
+  /// Start recording the Swift names of declarations in this table.
+  void setStoresImportedNames() {
+    assert(!Reader && "Cannot modify a lookup table stored on disk");
+    StoresImportedNames = true;
+  }
+
+  /// Record the encoded Swift name of \p decl.
+  void addImportedName(clang::NamedDecl *decl, bool suppressFactoryAsInit,
+                       StringRef encodedName);
+
+  /// Retrieve the encoded Swift name recorded for \p decl when the module
+  /// containing it was built.
+  Optional<StringRef> lookupImportedName(const clang::NamedDecl *decl,
+                                         bool suppressFactoryAsInit);
+
   /// Deserialize all entries.
   void deserializeAll();
 
@@ -245,15 +275,18 @@ class SwiftLookupTableReader : public clang::ModuleFileExtensionReader {
   std::function<void()> OnRemove;
 
   void *SerializedTable;
+  void *SerializedImportedNames;
 
   SwiftLookupTableReader(clang::ModuleFileExtension *extension,
                          clang::ASTReader &reader,
                          clang::serialization::ModuleFile &moduleFile,
                          std::function<void()> onRemove,
-                         void *serializedTable)
+                         void *serializedTable,
+                         void *serializedImportedNames)
     : ModuleFileExtensionReader(extension), Reader(reader),
       ModuleFile(moduleFile), OnRemove(onRemove),
-      SerializedTable(serializedTable) { }
+      SerializedTable(serializedTable),
+      SerializedImportedNames(serializedImportedNames) { }
 
 public:
   /// Create a new lookup table reader for the given AST reader and stream
@@ -280,6 +313,11 @@ public:
   /// \returns true if we found anything, false otherwise.
   bool lookup(StringRef baseName,
               SmallVectorImpl<SwiftLookupTable::FullTableEntry> &entries);
+
+  /// Retrieve the encoded Swift name stored for the given declaration, if
+  /// it belongs to this module file.
+  Optional<StringRef> lookupImportedName(const clang::NamedDecl *decl,
+                                         bool suppressFactoryAsInit);
 };
 
 }
@@ -0,0 +1,67 @@
+//===--- BuildRecordFormat.h - Binary copy of the build record --*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The YAML build record stays the canonical description of the last build,
+// but parsing it dominates the time of a no-op build of a large module. The
+// driver therefore writes the same information in a binary form next to it,
+// and only falls back to the YAML record when the binary one is missing or
+// describes a different version of the YAML record.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_DRIVER_BUILDRECORDFORMAT_H
+#define SWIFT_DRIVER_BUILDRECORDFORMAT_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace swift {
+namespace driver {
+
+/// The binary build record format. All integers are little-endian.
+///
+/// \code
+///   header:  "SBRC" version recordSize recordSeconds recordNanoseconds
+///            versionLength argsHashLength buildSeconds buildNanoseconds
+///            numEntries compilerVersion argsHash
+///   entries: numEntries x { status nameLength seconds nanoseconds name }
+/// \endcode
+///
+/// The record* fields are the size and modification time of the YAML record
+/// that was written alongside. The size and seconds fields are 64 bits, the
+/// status is 8 bits, and everything else is 32 bits.
+namespace build_record_format {
+  static const char Signature[] = {'S', 'B', 'R', 'C'};
+  static const uint32_t Version = 1;
+
+  static const size_t HeaderSize = sizeof(Signature) + 6 * sizeof(uint32_t) +
+                                   3 * sizeof(uint64_t);
+  static const size_t EntryHeaderSize = sizeof(uint8_t) +
+                                        2 * sizeof(uint32_t) + sizeof(uint64_t);
+
+  /// Values of an entry's status field.
+  enum Status : uint8_t {
+    UpToDate = 0,
+    NeedsCascadingBuild = 1,
+    NeedsNonCascadingBuild = 2
+  };
+
+  static inline std::string getPath(StringRef buildRecordPath) {
+    return (buildRecordPath + ".bin").str();
+  }
+} // end namespace build_record_format
+
+} // end namespace driver
+} // end namespace swift
+
+#endif
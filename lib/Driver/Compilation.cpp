@@ -12,10 +12,13 @@
 
 #include "swift/Driver/Compilation.h"
 
+#include "BuildRecordFormat.h"
 #include "swift/AST/DiagnosticEngine.h"
 #include "swift/AST/DiagnosticsDriver.h"
+#include "swift/Basic/CompileTimeTrace.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Program.h"
+#include "swift/Basic/Range.h"
 #include "swift/Basic/TaskQueue.h"
 #include "swift/Basic/Version.h"
 #include "swift/Basic/type_traits.h"
@@ -24,15 +27,22 @@
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
 #include "swift/Driver/ParseableOutput.h"
+#include "swift/Frontend/SerializedDiagnosticConsumer.h"
+#include "swift/Option/Options.h"
+#include "swift/Serialization/Validation.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/YAMLParser.h"
 
 using namespace swift;
@@ -83,6 +93,18 @@ namespace {
     ///
     /// Only intended for source files.
     llvm::SmallDenseMap<const Job *, bool, 16> UnfinishedCommands;
+
+    /// In batch mode, compile jobs that are ready to run and waiting to be
+    /// combined into batches.
+    SmallVector<const Job *, 16> PendingBatchableCommands;
+
+    /// The jobs created to run batches. These are not part of the
+    /// Compilation's list of jobs; the jobs they combine are.
+    SmallVector<std::unique_ptr<Job>, 4> BatchCommands;
+
+    /// A map from each batch job to the jobs it combines.
+    llvm::SmallDenseMap<const Job *, SmallVector<const Job *, 4>, 4>
+        BatchConstituents;
   };
 }
 
@@ -110,7 +132,10 @@ static void populateInputInfoMap(InputInfoMap &inputs,
                                  const PerformJobsState &endState) {
   for (auto &entry : endState.UnfinishedCommands) {
     for (auto *action : entry.first->getSource().getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      // Skip the precompiled bridging header.
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry.first->getInputModTime();
@@ -127,7 +152,10 @@ static void populateInputInfoMap(InputInfoMap &inputs,
       continue;
 
     for (auto *action : compileAction->getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      // Skip the precompiled bridging header.
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry->getInputModTime();
@@ -215,6 +243,524 @@ static void writeCompilationRecord(StringRef path, StringRef argsHash,
   }
 }
 
+/// Writes the binary copy of the build record at \p yamlPath, which must
+/// already have been written with the same contents.
+///
+/// \sa build_record_format
+static void writeBinaryCompilationRecord(StringRef yamlPath,
+                                         StringRef argsHash,
+                                         llvm::sys::TimeValue buildTime,
+                                         const InputInfoMap &inputs) {
+  using namespace llvm::support;
+  namespace format = build_record_format;
+
+  std::string path = format::getPath(yamlPath);
+  llvm::sys::fs::file_status yamlStatus;
+  if (llvm::sys::fs::status(yamlPath, yamlStatus)) {
+    // Don't leave a copy of an older record behind.
+    llvm::sys::fs::remove(path);
+    return;
+  }
+
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error()) {
+    // FIXME: How should we report this error?
+    out.clear_error();
+    return;
+  }
+
+  StringRef compilerVersion = version::getSwiftFullVersion();
+  llvm::sys::TimeValue yamlModTime = yamlStatus.getLastModificationTime();
+
+  out.write(format::Signature, sizeof(format::Signature));
+  endian::Writer<little> writer(out);
+  writer.write<uint32_t>(format::Version);
+  writer.write<uint64_t>(yamlStatus.getSize());
+  writer.write<uint64_t>(yamlModTime.toEpochTime());
+  writer.write<uint32_t>(yamlModTime.nanoseconds());
+  writer.write<uint32_t>(compilerVersion.size());
+  writer.write<uint32_t>(argsHash.size());
+  writer.write<uint64_t>(buildTime.seconds());
+  writer.write<uint32_t>(buildTime.nanoseconds());
+  writer.write<uint32_t>(inputs.size());
+  out << compilerVersion << argsHash;
+
+  for (auto &entry : inputs) {
+    format::Status status = format::UpToDate;
+    switch (entry.second.status) {
+    case CompileJobAction::InputInfo::UpToDate:
+      break;
+    case CompileJobAction::InputInfo::NewlyAdded:
+    case CompileJobAction::InputInfo::NeedsCascadingBuild:
+      status = format::NeedsCascadingBuild;
+      break;
+    case CompileJobAction::InputInfo::NeedsNonCascadingBuild:
+      status = format::NeedsNonCascadingBuild;
+      break;
+    }
+
+    StringRef name = entry.first->getValue();
+    writer.write<uint8_t>(status);
+    writer.write<uint32_t>(name.size());
+    writer.write<uint64_t>(entry.second.previousModTime.seconds());
+    writer.write<uint32_t>(entry.second.previousModTime.nanoseconds());
+    out << name;
+  }
+}
+
+/// Maps a job's duration key (see getJobDurationKey) to how long the job took,
+/// in milliseconds, the last time it ran.
+using JobDurationMap = llvm::StringMap<uint64_t>;
+
+/// Job durations are kept in a separate file next to the build record, so that
+/// older drivers can still read the record itself.
+static std::string getJobDurationsPath(StringRef buildRecordPath) {
+  return (buildRecordPath + ".durations").str();
+}
+
+/// Maps a job's duration key to its peak resident set size, in bytes, the
+/// last time it ran.
+using JobPeakMemoryMap = llvm::StringMap<uint64_t>;
+
+/// Peak memory is kept next to the durations, in the same format.
+static std::string getJobPeakMemoryPath(StringRef buildRecordPath) {
+  return (buildRecordPath + ".memory").str();
+}
+
+/// Returns the key under which \p Cmd's duration is recorded: the primary
+/// input for compile jobs, and the kind of job for everything else.
+static StringRef getJobDurationKey(const Job *Cmd) {
+  if (isa<CompileJobAction>(Cmd->getSource()))
+    return Cmd->getOutput().getBaseInput(0);
+  return Cmd->getSource().getClassName();
+}
+
+/// Reads a file mapping job keys to numbers, such as durations, into
+/// \p values.
+static void readJobStatistics(StringRef path,
+                              llvm::StringMap<uint64_t> &values) {
+  // A missing or malformed file just means we don't know anything yet.
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return;
+
+  namespace yaml = llvm::yaml;
+  llvm::SourceMgr SM;
+  yaml::Stream stream(buffer.get()->getMemBufferRef(), SM);
+
+  auto I = stream.begin();
+  if (I == stream.end() || !I->getRoot())
+    return;
+
+  auto *topLevelMap = dyn_cast<yaml::MappingNode>(I->getRoot());
+  if (!topLevelMap)
+    return;
+
+  SmallString<64> keyScratch;
+  SmallString<16> valueScratch;
+  // FIXME: LLVM's YAML support does incremental parsing in such a way that
+  // for-range loops break.
+  for (auto i = topLevelMap->begin(), e = topLevelMap->end(); i != e; ++i) {
+    auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+    auto *value = dyn_cast_or_null<yaml::ScalarNode>(i->getValue());
+    if (!key || !value)
+      return;
+
+    uint64_t number;
+    if (value->getValue(valueScratch).getAsInteger(10, number))
+      return;
+    values[key->getValue(keyScratch)] = number;
+  }
+}
+
+static void writeJobStatistics(StringRef path,
+                               const llvm::StringMap<uint64_t> &values) {
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error()) {
+    // FIXME: How should we report this error?
+    out.clear_error();
+    return;
+  }
+
+  // Sort the keys so that the file is stable from build to build.
+  std::vector<StringRef> keys;
+  for (auto &entry : values)
+    keys.push_back(entry.getKey());
+  std::sort(keys.begin(), keys.end());
+
+  for (StringRef key : keys) {
+    out << "\"" << llvm::yaml::escape(key) << "\": "
+        << values.lookup(key) << "\n";
+  }
+}
+
+/// Maps the path of a module file the build depends on to the content hash
+/// (as a hex string) that the module had when the build finished.
+using ModuleHashMap = llvm::StringMap<std::string>;
+
+/// Module hashes are kept in a separate file next to the build record, like
+/// the job durations.
+static std::string getModuleHashesPath(StringRef buildRecordPath) {
+  return (buildRecordPath + ".modulehashes").str();
+}
+
+/// Returns the content hash recorded in the header of the serialized module
+/// at \p path as a hex string, or an empty string if \p path isn't a valid
+/// module or has no hash.
+static std::string getModuleContentHash(StringRef path) {
+  // Only the control block is read, so map the file rather than reading it.
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer)
+    return std::string();
+
+  StringRef data = buffer.get()->getBuffer();
+  if (!serialization::isSerializedAST(data))
+    return std::string();
+  auto info = serialization::validateSerializedAST(data);
+  if (info.status != serialization::Status::Valid || info.contentHash.empty())
+    return std::string();
+
+  std::string result;
+  for (char c : info.contentHash) {
+    uint8_t byte = c;
+    result.push_back(llvm::hexdigit(byte >> 4, /*lowercase=*/true));
+    result.push_back(llvm::hexdigit(byte & 0xF, /*lowercase=*/true));
+  }
+  return result;
+}
+
+static void readModuleHashes(StringRef path, ModuleHashMap &hashes) {
+  // A missing or malformed file just means we don't know anything yet.
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return;
+
+  namespace yaml = llvm::yaml;
+  llvm::SourceMgr SM;
+  yaml::Stream stream(buffer.get()->getMemBufferRef(), SM);
+
+  auto I = stream.begin();
+  if (I == stream.end() || !I->getRoot())
+    return;
+
+  auto *topLevelMap = dyn_cast<yaml::MappingNode>(I->getRoot());
+  if (!topLevelMap)
+    return;
+
+  SmallString<64> keyScratch;
+  SmallString<32> valueScratch;
+  // FIXME: LLVM's YAML support does incremental parsing in such a way that
+  // for-range loops break.
+  for (auto i = topLevelMap->begin(), e = topLevelMap->end(); i != e; ++i) {
+    auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+    auto *value = dyn_cast_or_null<yaml::ScalarNode>(i->getValue());
+    if (!key || !value)
+      return;
+    hashes[key->getValue(keyScratch)] = value->getValue(valueScratch);
+  }
+}
+
+static void writeModuleHashes(StringRef path, const ModuleHashMap &hashes) {
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error()) {
+    // FIXME: How should we report this error?
+    out.clear_error();
+    return;
+  }
+
+  // Sort the keys so that the file is stable from build to build.
+  std::vector<StringRef> keys;
+  for (auto &entry : hashes)
+    keys.push_back(entry.getKey());
+  std::sort(keys.begin(), keys.end());
+
+  for (StringRef key : keys) {
+    out << "\"" << llvm::yaml::escape(key) << "\": \""
+        << hashes.lookup(key) << "\"\n";
+  }
+}
+
+/// An entry in the dependency cache: a job's dependency information in the
+/// binary format, along with the modification time and size of the
+/// .swiftdeps file it was encoded from.
+struct CachedDependencies {
+  uint64_t Seconds;
+  uint32_t Nanoseconds;
+  uint64_t Size;
+  StringRef Data;
+
+  /// Returns true if the .swiftdeps file with status \p status is the one this
+  /// entry was encoded from.
+  bool matches(const llvm::sys::fs::file_status &status) const {
+    llvm::sys::TimeValue modTime = status.getLastModificationTime();
+    return modTime.toEpochTime() == Seconds &&
+           modTime.nanoseconds() == Nanoseconds && status.getSize() == Size;
+  }
+};
+
+/// Maps the path of a .swiftdeps file to its entry in the dependency cache.
+using DependencyCacheMap = llvm::StringMap<CachedDependencies>;
+
+/// The dependency cache lets the driver skip reading and parsing the .swiftdeps
+/// files that haven't changed since the last build. Like the job durations, it
+/// is kept in a separate file next to the build record.
+static std::string getDependencyCachePath(StringRef buildRecordPath) {
+  return (buildRecordPath + ".depcache").str();
+}
+
+/// The dependency cache format. All integers are little-endian.
+///
+/// \code
+///   header:  "SDCA" version numEntries
+///   entries: numEntries x { pathLength dataLength seconds nanoseconds size
+///                           path data }
+/// \endcode
+///
+/// The seconds and size fields are 64 bits; everything else is 32 bits.
+namespace dependency_cache_format {
+  static const char Signature[] = {'S', 'D', 'C', 'A'};
+  static const uint32_t Version = 2;
+
+  static const size_t HeaderSize = sizeof(Signature) + 2 * sizeof(uint32_t);
+  static const size_t EntryHeaderSize = 3 * sizeof(uint32_t) +
+                                        2 * sizeof(uint64_t);
+} // end namespace dependency_cache_format
+
+/// Reads the dependency cache at \p path into \p entries.
+///
+/// \returns the buffer that \p entries refers into, or null if the cache is
+/// missing or malformed.
+static std::unique_ptr<llvm::MemoryBuffer>
+readDependencyCache(StringRef path, DependencyCacheMap &entries) {
+  using namespace llvm::support;
+  using namespace dependency_cache_format;
+
+  // The cache can be large, so allow it to be mapped rather than read.
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer)
+    return nullptr;
+
+  StringRef data = buffer.get()->getBuffer();
+  if (data.size() < HeaderSize ||
+      !data.startswith(StringRef(Signature, sizeof(Signature))))
+    return nullptr;
+
+  const char *cursor = data.data() + sizeof(Signature);
+  if (endian::readNext<uint32_t, little, unaligned>(cursor) != Version)
+    return nullptr;
+  uint32_t numEntries = endian::readNext<uint32_t, little, unaligned>(cursor);
+
+  for (uint32_t i = 0; i != numEntries; ++i) {
+    if (size_t(data.end() - cursor) < EntryHeaderSize) {
+      entries.clear();
+      return nullptr;
+    }
+
+    CachedDependencies entry;
+    auto pathLength = endian::readNext<uint32_t, little, unaligned>(cursor);
+    auto dataLength = endian::readNext<uint32_t, little, unaligned>(cursor);
+    entry.Seconds = endian::readNext<uint64_t, little, unaligned>(cursor);
+    entry.Nanoseconds = endian::readNext<uint32_t, little, unaligned>(cursor);
+    entry.Size = endian::readNext<uint64_t, little, unaligned>(cursor);
+
+    if (uint64_t(data.end() - cursor) < uint64_t(pathLength) + dataLength) {
+      entries.clear();
+      return nullptr;
+    }
+    StringRef entryPath(cursor, pathLength);
+    cursor += pathLength;
+    entry.Data = StringRef(cursor, dataLength);
+    cursor += dataLength;
+
+    entries[entryPath] = entry;
+  }
+
+  return std::move(buffer.get());
+}
+
+/// Writes a dependency cache covering the .swiftdeps files of \p jobs.
+///
+/// Entries in \p oldEntries are reused for files that haven't changed; every
+/// other file is re-encoded from disk, so that the cache always matches the
+/// files themselves rather than the (additive) state of the graph.
+static void writeDependencyCache(StringRef path, ArrayRef<const Job *> jobs,
+                                 const DependencyCacheMap &oldEntries) {
+  using namespace llvm::support;
+
+  // Build the whole file in memory first, since \p oldEntries may refer into
+  // a mapping of the file being replaced.
+  std::string contents;
+  llvm::raw_string_ostream out(contents);
+  endian::Writer<little> writer(out);
+  uint32_t numEntries = 0;
+
+  for (const Job *Cmd : jobs) {
+    StringRef DependenciesFile =
+      Cmd->getOutput().getAdditionalOutputForType(types::TY_SwiftDeps);
+    if (DependenciesFile.empty())
+      continue;
+
+    llvm::sys::fs::file_status status;
+    if (llvm::sys::fs::status(DependenciesFile, status))
+      continue;
+
+    std::string encoded;
+    StringRef data;
+    auto oldEntry = oldEntries.find(DependenciesFile);
+    if (oldEntry != oldEntries.end() && oldEntry->getValue().matches(status)) {
+      data = oldEntry->getValue().Data;
+    } else {
+      auto buffer = llvm::MemoryBuffer::getFile(DependenciesFile);
+      if (!buffer)
+        continue;
+      llvm::raw_string_ostream encodedOut(encoded);
+      if (DependencyGraphImpl::encodeAsBinary(*buffer.get(), encodedOut))
+        continue;
+      data = encodedOut.str();
+    }
+
+    llvm::sys::TimeValue modTime = status.getLastModificationTime();
+    writer.write<uint32_t>(DependenciesFile.size());
+    writer.write<uint32_t>(data.size());
+    writer.write<uint64_t>(modTime.toEpochTime());
+    writer.write<uint32_t>(modTime.nanoseconds());
+    writer.write<uint64_t>(status.getSize());
+    out << DependenciesFile << data;
+    ++numEntries;
+  }
+  out.flush();
+
+  std::error_code error;
+  llvm::raw_fd_ostream file(path, error, llvm::sys::fs::F_None);
+  if (file.has_error()) {
+    // FIXME: How should we report this error?
+    file.clear_error();
+    return;
+  }
+
+  file.write(dependency_cache_format::Signature,
+             sizeof(dependency_cache_format::Signature));
+  endian::Writer<little> fileWriter(file);
+  fileWriter.write<uint32_t>(dependency_cache_format::Version);
+  fileWriter.write<uint32_t>(numEntries);
+  file << contents;
+}
+
+/// Computes a scheduling priority for each job: the expected length of the
+/// longest chain of jobs starting at that job, based on \p durations.
+///
+/// Running the jobs with the longest remaining chains first keeps the final
+/// merge-module and link jobs from waiting on one slow file that happened to
+/// be queued last. Jobs with no recorded duration are assumed to take as long
+/// as an average job; if nothing is known, every job gets the same priority
+/// and they run in their original order.
+static void computeJobPriorities(ArrayRef<const Job *> jobs,
+                                 const JobDurationMap &durations,
+                                 llvm::DenseMap<const Job *, int64_t> &result) {
+  uint64_t totalKnown = 0;
+  unsigned numKnown = 0;
+  for (const Job *Cmd : jobs) {
+    auto known = durations.find(getJobDurationKey(Cmd));
+    if (known == durations.end())
+      continue;
+    totalKnown += known->getValue();
+    ++numKnown;
+  }
+  if (numKnown == 0)
+    return;
+  uint64_t defaultDuration = totalKnown / numKnown;
+
+  // Jobs are created after the jobs they depend on, so walking them in reverse
+  // visits every job after all of the jobs that consume its outputs.
+  llvm::DenseMap<const Job *, int64_t> longestDependentChain;
+  for (const Job *Cmd : reversed(jobs)) {
+    auto known = durations.find(getJobDurationKey(Cmd));
+    uint64_t duration =
+      (known == durations.end()) ? defaultDuration : known->getValue();
+
+    int64_t priority = duration + longestDependentChain.lookup(Cmd);
+    result[Cmd] = priority;
+
+    for (const Job *input : Cmd->getInputs()) {
+      int64_t &chain = longestDependentChain[input];
+      chain = std::max(chain, priority);
+    }
+  }
+}
+
+/// The largest number of primary files given to one frontend invocation in
+/// batch mode. Bigger batches save more startup work, but leave the driver
+/// less room to balance work across parallel tasks.
+static const size_t MaxBatchSize = 25;
+
+/// Returns true if \p Cmd can be combined with other compile jobs in batch
+/// mode.
+static bool isBatchableCommand(const Job *Cmd) {
+  if (!isa<CompileJobAction>(Cmd->getSource()))
+    return false;
+
+  const CommandOutput &Output = Cmd->getOutput();
+  if (Output.getPrimaryOutputFilenames().size() != 1)
+    return false;
+
+  // Serialized diagnostics and fix-its are written for a whole frontend
+  // invocation, so they can't be split back up by file.
+  if (!Output.getAdditionalOutputForType(types::TY_SerializedDiagnostics)
+         .empty() ||
+      !Output.getAdditionalOutputForType(types::TY_Remapping).empty())
+    return false;
+
+  for (StringRef Arg : Cmd->getArguments())
+    if (Arg == "-primary-file")
+      return true;
+  return false;
+}
+
+/// Writes the output file map that tells a batch frontend invocation where to
+/// put each primary file's outputs.
+///
+/// \returns true on error
+static bool writeBatchOutputFileMap(StringRef path,
+                                    ArrayRef<const Job *> jobs) {
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error() || error) {
+    out.clear_error();
+    return true;
+  }
+
+  static const types::ID perFileOutputTypes[] = {
+    types::TY_SwiftModuleFile,
+    types::TY_SwiftModuleDocFile,
+    types::TY_Dependencies,
+    types::TY_SwiftDeps,
+  };
+
+  out << "{\n";
+  for (const Job *cmd : jobs) {
+    const CommandOutput &output = cmd->getOutput();
+    out << "  \"" << llvm::yaml::escape(output.getBaseInput(0)) << "\": {\n";
+    out << "    \"" << types::getTypeName(output.getPrimaryOutputType())
+        << "\": \"" << llvm::yaml::escape(output.getPrimaryOutputFilename())
+        << "\"";
+    for (types::ID type : perFileOutputTypes) {
+      const std::string &path = output.getAdditionalOutputForType(type);
+      if (path.empty())
+        continue;
+      out << ",\n    \"" << types::getTypeName(type) << "\": \""
+          << llvm::yaml::escape(path) << "\"";
+    }
+    out << "\n  }" << (cmd == jobs.back() ? "" : ",") << "\n";
+  }
+  out << "}\n";
+  return false;
+}
+
 int Compilation::performJobsImpl() {
   // Create a TaskQueue for execution.
   std::unique_ptr<TaskQueue> TQ;
@@ -225,6 +771,42 @@ int Compilation::performJobsImpl() {
 
   PerformJobsState State;
 
+  // Use the durations recorded by the last build to decide which jobs to run
+  // first.
+  JobDurationMap JobDurations;
+  llvm::DenseMap<const Job *, int64_t> JobPriorities;
+  if (!CompilationRecordPath.empty()) {
+    readJobStatistics(getJobDurationsPath(CompilationRecordPath),
+                      JobDurations);
+    SmallVector<const Job *, 32> AllJobs(getJobs().begin(), getJobs().end());
+    computeJobPriorities(AllJobs, JobDurations, JobPriorities);
+  }
+  llvm::DenseMap<const Job *, llvm::sys::TimeValue> JobStartTimes;
+
+  // Likewise, the peak memory each job used last time is its projection for
+  // the memory budget.
+  JobPeakMemoryMap JobPeakMemory;
+  if (!CompilationRecordPath.empty())
+    readJobStatistics(getJobPeakMemoryPath(CompilationRecordPath),
+                      JobPeakMemory);
+  TQ->setMemoryBudget(MemoryBudget);
+
+  // Dependencies for files that haven't changed since the last build are
+  // loaded from the dependency cache rather than from their .swiftdeps files.
+  DependencyCacheMap DependencyCache;
+  std::unique_ptr<llvm::MemoryBuffer> DependencyCacheBuffer;
+  if (!CompilationRecordPath.empty() && getIncrementalBuildEnabled()) {
+    DependencyCacheBuffer =
+      readDependencyCache(getDependencyCachePath(CompilationRecordPath),
+                          DependencyCache);
+  }
+
+  // A module that was rebuilt since the last build but whose content hash
+  // didn't change doesn't invalidate anything that depends on it.
+  ModuleHashMap ModuleHashes;
+  if (!CompilationRecordPath.empty() && getIncrementalBuildEnabled())
+    readModuleHashes(getModuleHashesPath(CompilationRecordPath), ModuleHashes);
+
   using DependencyGraph = DependencyGraph<const Job *>;
   DependencyGraph DepGraph;
   SmallPtrSet<const Job *, 16> DeferredCommands;
@@ -249,6 +831,17 @@ int Compilation::performJobsImpl() {
     });
   };
 
+  auto addTaskForCommand = [&] (const Job *Cmd) {
+    TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
+                (void *)Cmd, JobPriorities.lookup(Cmd),
+                JobPeakMemory.lookup(getJobDurationKey(Cmd)));
+  };
+
+  // In batch mode, compile jobs that are ready before tasks start executing
+  // are held back so that they can be combined. Jobs that become ready while
+  // other tasks are running are started on their own straight away.
+  bool CollectingBatchableCommands = getBatchModeEnabled();
+
   // Set up scheduleCommandIfNecessaryAndPossible.
   // This will only schedule the given command if it has not been scheduled
   // and if all of its inputs are in FinishedCommands.
@@ -265,8 +858,85 @@ int Compilation::performJobsImpl() {
     assert(Cmd->getExtraEnvironment().empty() &&
            "not implemented for compilations with multiple jobs");
     State.ScheduledCommands.insert(Cmd);
-    TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
-                (void *)Cmd);
+    if (CollectingBatchableCommands && isBatchableCommand(Cmd)) {
+      State.PendingBatchableCommands.push_back(Cmd);
+      return;
+    }
+    addTaskForCommand(Cmd);
+  };
+
+  // Runs all of the jobs in \p Batch with a single frontend invocation.
+  auto scheduleBatch = [&] (ArrayRef<const Job *> Batch) {
+    int64_t Priority = 0;
+    uint64_t ProjectedMemory = 0;
+    for (const Job *Cmd : Batch) {
+      Priority += JobPriorities.lookup(Cmd);
+      ProjectedMemory = std::max(ProjectedMemory,
+                                 JobPeakMemory.lookup(getJobDurationKey(Cmd)));
+    }
+
+    SmallString<128> OutputFileMapPath;
+    if (Batch.size() == 1 ||
+        llvm::sys::fs::createTemporaryFile("batch", "json",
+                                           OutputFileMapPath)) {
+      for (const Job *Cmd : Batch)
+        addTaskForCommand(Cmd);
+      return;
+    }
+    addTemporaryFile(OutputFileMapPath);
+    if (writeBatchOutputFileMap(OutputFileMapPath, Batch)) {
+      for (const Job *Cmd : Batch)
+        addTaskForCommand(Cmd);
+      return;
+    }
+
+    std::unique_ptr<Job> BatchCmd =
+      getDefaultToolChain().constructBatchJob(Batch, OutputFileMapPath,
+                                              getArgs());
+    State.BatchConstituents[BatchCmd.get()].append(Batch.begin(), Batch.end());
+    TQ->addTask(BatchCmd->getExecutable(), BatchCmd->getArguments(),
+                llvm::None, (void *)BatchCmd.get(), Priority, ProjectedMemory);
+    State.BatchCommands.push_back(std::move(BatchCmd));
+  };
+
+  // Combines the pending batchable jobs into batches, using at least as many
+  // batches as there are parallel tasks so that none of them sit idle.
+  auto schedulePendingBatches = [&] {
+    auto &Pending = State.PendingBatchableCommands;
+    if (Pending.empty())
+      return;
+
+    size_t NumBatches = std::max<size_t>(NumberOfParallelCommands, 1);
+    NumBatches = std::max(NumBatches,
+                          (Pending.size() + MaxBatchSize - 1) / MaxBatchSize);
+    NumBatches = std::min(NumBatches, Pending.size());
+
+    // Deal out the jobs with the longest expected durations first, so that
+    // every batch gets a similar amount of work.
+    std::stable_sort(Pending.begin(), Pending.end(),
+                     [&](const Job *LHS, const Job *RHS) {
+      return JobPriorities.lookup(LHS) > JobPriorities.lookup(RHS);
+    });
+
+    SmallVector<SmallVector<const Job *, 8>, 8> Batches(NumBatches);
+    for (size_t i = 0, e = Pending.size(); i != e; ++i)
+      Batches[i % NumBatches].push_back(Pending[i]);
+    Pending.clear();
+
+    for (auto &Batch : Batches)
+      scheduleBatch(Batch);
+  };
+
+  // Returns the jobs run by the task for \p TaskCmd: the jobs it combines if
+  // it is a batch, or just \p TaskCmd itself.
+  auto getCommandsForTask =
+      [&] (const Job *TaskCmd) -> SmallVector<const Job *, 4> {
+    auto Batch = State.BatchConstituents.find(TaskCmd);
+    if (Batch != State.BatchConstituents.end())
+      return Batch->second;
+    SmallVector<const Job *, 4> Result;
+    Result.push_back(TaskCmd);
+    return Result;
   };
 
   // When a task finishes, we need to reevaluate the other commands that
@@ -278,8 +948,19 @@ int Compilation::performJobsImpl() {
     if (BlockedIter != State.BlockingCommands.end()) {
       auto AllBlocked = std::move(BlockedIter->second);
       State.BlockingCommands.erase(BlockedIter);
+
+      // Jobs released together, such as every compile waiting on the
+      // precompiled bridging header, can still be combined into batches.
+      bool CollectBatch = !CollectingBatchableCommands &&
+                          getBatchModeEnabled();
+      if (CollectBatch)
+        CollectingBatchableCommands = true;
       for (auto *Blocked : AllBlocked)
         scheduleCommandIfNecessaryAndPossible(Blocked);
+      if (CollectBatch) {
+        schedulePendingBatches();
+        CollectingBatchableCommands = false;
+      }
     }
   };
 
@@ -302,7 +983,18 @@ int Compilation::performJobsImpl() {
       if (Cmd->getCondition() == Job::Condition::NewlyAdded) {
         DepGraph.addIndependentNode(Cmd);
       } else {
-        switch (DepGraph.loadFromPath(Cmd, DependenciesFile)) {
+        DependencyGraphImpl::LoadResult LoadStatus;
+        auto Cached = DependencyCache.find(DependenciesFile);
+        llvm::sys::fs::file_status DependenciesStatus;
+        if (Cached != DependencyCache.end() &&
+            !llvm::sys::fs::status(DependenciesFile, DependenciesStatus) &&
+            Cached->getValue().matches(DependenciesStatus)) {
+          LoadStatus = DepGraph.loadFromString(Cmd, Cached->getValue().Data);
+        } else {
+          LoadStatus = DepGraph.loadFromPath(Cmd, DependenciesFile);
+        }
+
+        switch (LoadStatus) {
         case DependencyGraphImpl::LoadResult::HadError:
           disableIncrementalBuild();
           for (const Job *Cmd : DeferredCommands)
@@ -355,10 +1047,21 @@ int Compilation::performJobsImpl() {
     // Check all cross-module dependencies as well.
     for (StringRef dependency : DepGraph.getExternalDependencies()) {
       llvm::sys::fs::file_status depStatus;
-      if (!llvm::sys::fs::status(dependency, depStatus))
+      if (!llvm::sys::fs::status(dependency, depStatus)) {
         if (depStatus.getLastModificationTime() < LastBuildTime)
           continue;
 
+        auto knownHash = ModuleHashes.find(dependency);
+        if (knownHash != ModuleHashes.end() &&
+            knownHash->getValue() == getModuleContentHash(dependency)) {
+          if (ShowIncrementalBuildDecisions) {
+            llvm::outs() << "Ignoring " << llvm::sys::path::filename(dependency)
+                         << " because its contents did not change\n";
+          }
+          continue;
+        }
+      }
+
       // If the dependency has been modified since the oldest built file,
       // or if we can't stat it for some reason (perhaps it's been deleted?),
       // trigger rebuilds through the dependency graph.
@@ -383,30 +1086,54 @@ int Compilation::performJobsImpl() {
   // Set up a callback which will be called immediately after a task has
   // started. This callback may be used to provide output indicating that the
   // task began.
-  auto taskBegan = [this] (ProcessId Pid, void *Context) {
+  auto taskBegan = [&] (ProcessId Pid, void *Context) {
     // TODO: properly handle task began.
     const Job *BeganCmd = (const Job *)Context;
+    JobStartTimes[BeganCmd] = llvm::sys::TimeValue::now();
 
     // For verbose output, print out each command as it begins execution.
-    if (Level == OutputLevel::Verbose)
+    if (Level == OutputLevel::Verbose) {
       BeganCmd->printCommandLine(llvm::errs());
-    else if (Level == OutputLevel::Parseable)
-      parseable_output::emitBeganMessage(llvm::errs(), *BeganCmd, Pid);
+    } else if (Level == OutputLevel::Parseable) {
+      for (const Job *Cmd : getCommandsForTask(BeganCmd))
+        parseable_output::emitBeganMessage(llvm::errs(), *Cmd, Pid);
+    }
+
+    if (ProgressStream) {
+      uint64_t Now = CompileTimeTrace::now();
+      for (const Job *Cmd : getCommandsForTask(BeganCmd))
+        parseable_output::emitBeganEvent(*ProgressStream, *Cmd, Pid, Now);
+    }
   };
 
+
   // Set up a callback which will be called immediately after a task has
   // finished execution. This callback should determine if execution should
   // continue (if execution should stop, this callback should return true), and
   // it should also schedule any additional commands which we now know need
   // to run.
   auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
+                           TaskProcessInformation ProcInfo,
                            void *Context) -> TaskFinishedResponse {
-    const Job *FinishedCmd = (const Job *)Context;
+    const Job *TaskCmd = (const Job *)Context;
+    SmallVector<const Job *, 4> FinishedCmds = getCommandsForTask(TaskCmd);
+
+    // Jobs that ran as one batch all report the batch's resource usage.
+    if (ProgressStream) {
+      for (const Job *FinishedCmd : FinishedCmds) {
+        parseable_output::emitFinishedEvent(*ProgressStream, *FinishedCmd, Pid,
+                                            ReturnCode, ProcInfo);
+      }
+    }
 
     if (Level == OutputLevel::Parseable) {
-      // Parseable output was requested.
-      parseable_output::emitFinishedMessage(llvm::errs(), *FinishedCmd, Pid,
-                                            ReturnCode, Output);
+      // Parseable output was requested. A batch's output is reported with the
+      // first job in the batch.
+      for (const Job *FinishedCmd : FinishedCmds) {
+        parseable_output::emitFinishedMessage(
+          llvm::errs(), *FinishedCmd, Pid, ReturnCode,
+          FinishedCmd == FinishedCmds.front() ? Output : StringRef());
+      }
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -414,6 +1141,19 @@ int Compilation::performJobsImpl() {
         llvm::errs() << Output;
     }
 
+    // Draw each job in the compile-time trace on a lane named after the
+    // process that ran it, next to the frontend's own spans.
+    if (CompileTimeTrace::isEnabled()) {
+      auto StartTime = JobStartTimes.find(TaskCmd);
+      if (StartTime != JobStartTimes.end()) {
+        llvm::sys::TimeValue Elapsed =
+          llvm::sys::TimeValue::now() - StartTime->second;
+        uint64_t End = CompileTimeTrace::now();
+        CompileTimeTrace::record("job", getJobDurationKey(TaskCmd),
+                                 End - Elapsed.usec(), End, uint64_t(Pid));
+      }
+    }
+
     if (ReturnCode != EXIT_SUCCESS) {
       // The task failed, so return true without performing any further
       // dependency analysis.
@@ -423,10 +1163,10 @@ int Compilation::performJobsImpl() {
       if (Result == EXIT_SUCCESS)
         Result = ReturnCode;
 
-      if (!isa<CompileJobAction>(FinishedCmd->getSource()) ||
+      if (!isa<CompileJobAction>(TaskCmd->getSource()) ||
           ReturnCode != EXIT_FAILURE) {
         Diags.diagnose(SourceLoc(), diag::error_command_failed,
-                       FinishedCmd->getSource().getClassName(),
+                       TaskCmd->getSource().getClassName(),
                        ReturnCode);
       }
 
@@ -435,56 +1175,87 @@ int Compilation::performJobsImpl() {
           TaskFinishedResponse::StopExecution;
     }
 
-    // When a task finishes, we need to reevaluate the other commands that
-    // might have been blocked.
-    markFinished(FinishedCmd);
+    // A batch's time is shared evenly between the jobs it combines.
+    auto StartTime = JobStartTimes.find(TaskCmd);
+    if (StartTime != JobStartTimes.end()) {
+      llvm::sys::TimeValue Elapsed =
+        llvm::sys::TimeValue::now() - StartTime->second;
+      for (const Job *FinishedCmd : FinishedCmds) {
+        JobDurations[getJobDurationKey(FinishedCmd)] =
+          Elapsed.msec() / FinishedCmds.size();
+      }
+    }
 
-    // In order to handle both old dependencies that have disappeared and new
-    // dependencies that have arisen, we need to reload the dependency file.
-    if (getIncrementalBuildEnabled()) {
-      const CommandOutput &Output = FinishedCmd->getOutput();
-      StringRef DependenciesFile =
-        Output.getAdditionalOutputForType(types::TY_SwiftDeps);
-      if (!DependenciesFile.empty()) {
-        SmallVector<const Job *, 16> Dependents;
-        bool wasCascading = DepGraph.isMarked(FinishedCmd);
+    // Unlike its time, a batch's memory isn't shared out: each of its jobs
+    // might run with as much again next time.
+    if (ProcInfo.MaxResidentSetBytes != 0) {
+      for (const Job *FinishedCmd : FinishedCmds) {
+        JobPeakMemory[getJobDurationKey(FinishedCmd)] =
+          ProcInfo.MaxResidentSetBytes;
+      }
+    }
 
-        switch (DepGraph.loadFromPath(FinishedCmd, DependenciesFile)) {
-        case DependencyGraphImpl::LoadResult::HadError:
-          disableIncrementalBuild();
-          for (const Job *Cmd : DeferredCommands)
-            scheduleCommandIfNecessaryAndPossible(Cmd);
-          DeferredCommands.clear();
-          Dependents.clear();
-          break;
-        case DependencyGraphImpl::LoadResult::UpToDate:
-          if (!wasCascading)
+    for (const Job *FinishedCmd : FinishedCmds) {
+      // When a task finishes, we need to reevaluate the other commands that
+      // might have been blocked.
+      markFinished(FinishedCmd);
+
+      // In order to handle both old dependencies that have disappeared and new
+      // dependencies that have arisen, we need to reload the dependency file.
+      if (getIncrementalBuildEnabled()) {
+        const CommandOutput &Output = FinishedCmd->getOutput();
+        StringRef DependenciesFile =
+          Output.getAdditionalOutputForType(types::TY_SwiftDeps);
+        if (!DependenciesFile.empty()) {
+          SmallVector<const Job *, 16> Dependents;
+          bool wasCascading = DepGraph.isMarked(FinishedCmd);
+
+          switch (DepGraph.loadFromPath(FinishedCmd, DependenciesFile)) {
+          case DependencyGraphImpl::LoadResult::HadError:
+            disableIncrementalBuild();
+            for (const Job *Cmd : DeferredCommands)
+              scheduleCommandIfNecessaryAndPossible(Cmd);
+            DeferredCommands.clear();
+            Dependents.clear();
             break;
-          SWIFT_FALLTHROUGH;
-        case DependencyGraphImpl::LoadResult::AffectsDownstream:
-          DepGraph.markTransitive(Dependents, FinishedCmd);
-          break;
-        }
+          case DependencyGraphImpl::LoadResult::UpToDate:
+            if (!wasCascading)
+              break;
+            SWIFT_FALLTHROUGH;
+          case DependencyGraphImpl::LoadResult::AffectsDownstream:
+            DepGraph.markTransitive(Dependents, FinishedCmd);
+            break;
+          }
 
-        for (const Job *Cmd : Dependents) {
-          DeferredCommands.erase(Cmd);
-          noteBuilding(Cmd, "because of dependencies discovered later");
-          scheduleCommandIfNecessaryAndPossible(Cmd);
+          for (const Job *Cmd : Dependents) {
+            DeferredCommands.erase(Cmd);
+            noteBuilding(Cmd, "because of dependencies discovered later");
+            scheduleCommandIfNecessaryAndPossible(Cmd);
+          }
         }
       }
+
     }
 
     return TaskFinishedResponse::ContinueExecution;
   };
 
   auto taskSignalled = [&] (ProcessId Pid, StringRef ErrorMsg, StringRef Output,
+                            TaskProcessInformation ProcInfo,
                             void *Context) -> TaskFinishedResponse {
     const Job *SignalledCmd = (const Job *)Context;
 
+    if (ProgressStream) {
+      for (const Job *Cmd : getCommandsForTask(SignalledCmd))
+        parseable_output::emitSignalledEvent(*ProgressStream, *Cmd, Pid,
+                                             ErrorMsg, ProcInfo);
+    }
+
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
-      parseable_output::emitSignalledMessage(llvm::errs(), *SignalledCmd, Pid,
-                                             ErrorMsg, Output);
+      for (const Job *Cmd : getCommandsForTask(SignalledCmd))
+        parseable_output::emitSignalledMessage(llvm::errs(), *Cmd, Pid,
+                                               ErrorMsg, Output);
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -506,8 +1277,12 @@ int Compilation::performJobsImpl() {
   };
 
   do {
+    schedulePendingBatches();
+
     // Ask the TaskQueue to execute.
+    CollectingBatchableCommands = false;
     TQ->execute(taskBegan, taskFinished, taskSignalled);
+    CollectingBatchableCommands = getBatchModeEnabled();
 
     // Mark all remaining deferred commands as skipped.
     for (const Job *Cmd : DeferredCommands) {
@@ -516,13 +1291,16 @@ int Compilation::performJobsImpl() {
         // was requested.
         parseable_output::emitSkippedMessage(llvm::errs(), *Cmd);
       }
+      if (ProgressStream)
+        parseable_output::emitSkippedEvent(*ProgressStream, *Cmd);
 
       State.ScheduledCommands.insert(Cmd);
       markFinished(Cmd);
     }
 
     // ...which may allow us to go on and do later tasks.
-  } while (Result == 0 && TQ->hasRemainingTasks());
+  } while (Result == 0 && (TQ->hasRemainingTasks() ||
+                           !State.PendingBatchableCommands.empty()));
 
   if (Result == 0) {
     assert(State.BlockingCommands.empty() &&
@@ -555,6 +1333,40 @@ int Compilation::performJobsImpl() {
     checkForOutOfDateInputs(Diags, InputInfo);
     writeCompilationRecord(CompilationRecordPath, ArgsHash, BuildStartTime,
                            InputInfo);
+    writeBinaryCompilationRecord(CompilationRecordPath, ArgsHash,
+                                 BuildStartTime, InputInfo);
+
+    // Only keep statistics for jobs that are still part of the build.
+    JobDurationMap CurrentDurations;
+    JobPeakMemoryMap CurrentPeakMemory;
+    for (const Job *Cmd : getJobs()) {
+      StringRef Key = getJobDurationKey(Cmd);
+      auto Known = JobDurations.find(Key);
+      if (Known != JobDurations.end())
+        CurrentDurations[Key] = Known->getValue();
+      auto KnownMemory = JobPeakMemory.find(Key);
+      if (KnownMemory != JobPeakMemory.end())
+        CurrentPeakMemory[Key] = KnownMemory->getValue();
+    }
+    writeJobStatistics(getJobDurationsPath(CompilationRecordPath),
+                       CurrentDurations);
+    writeJobStatistics(getJobPeakMemoryPath(CompilationRecordPath),
+                       CurrentPeakMemory);
+
+    SmallVector<const Job *, 32> AllJobs(getJobs().begin(), getJobs().end());
+    writeDependencyCache(getDependencyCachePath(CompilationRecordPath),
+                         AllJobs, DependencyCache);
+
+    if (getIncrementalBuildEnabled()) {
+      ModuleHashMap CurrentHashes;
+      for (StringRef dependency : DepGraph.getExternalDependencies()) {
+        std::string hash = getModuleContentHash(dependency);
+        if (!hash.empty())
+          CurrentHashes[dependency] = std::move(hash);
+      }
+      writeModuleHashes(getModuleHashesPath(CompilationRecordPath),
+                        CurrentHashes);
+    }
   }
 
   if (Result == 0)
@@ -593,8 +1405,48 @@ int Compilation::performSingleCommand(const Job *Cmd) {
 }
 
 int Compilation::performJobs() {
+  // With -trace-compile-time, the driver starts the trace file and every
+  // frontend job appends its own events to it.
+  StringRef TracePath;
+  if (const Arg *A = getArgs().getLastArg(options::OPT_trace_compile_time)) {
+    TracePath = A->getValue();
+    std::string Error;
+    if (CompileTimeTrace::startFile(TracePath, Error)) {
+      Diags.diagnose(SourceLoc(), diag::error_opening_output, TracePath,
+                     Error);
+      return EXIT_FAILURE;
+    }
+    CompileTimeTrace::enable();
+  }
+
+  // With -progress-output, the driver starts the file and appends an event
+  // for each job. Frontend jobs append their phase timings to the same file,
+  // so the driver must append as well rather than write at its own offset.
+  if (const Arg *A = getArgs().getLastArg(options::OPT_progress_output)) {
+    StringRef ProgressPath = A->getValue();
+    std::error_code EC;
+    {
+      llvm::raw_fd_ostream Truncate(ProgressPath, EC, llvm::sys::fs::F_None);
+    }
+    if (!EC) {
+      ProgressStream.reset(new llvm::raw_fd_ostream(ProgressPath, EC,
+                                                    llvm::sys::fs::F_Append));
+    }
+    if (EC) {
+      Diags.diagnose(SourceLoc(), diag::error_opening_output, ProgressPath,
+                     EC.message());
+      ProgressStream.reset();
+      return EXIT_FAILURE;
+    }
+    ProgressStream->SetUnbuffered();
+  }
+
+  const Arg *MergedDiagnosticsArg =
+    getArgs().getLastArg(options::OPT_serialize_diagnostics_module_path);
+
   // If we don't have to do any cleanup work, just exec the subprocess.
-  if (Level < OutputLevel::Parseable &&
+  if (Level < OutputLevel::Parseable && !ProgressStream &&
+      !MergedDiagnosticsArg &&
       (SaveTemps || TempFilePaths.empty()) &&
       CompilationRecordPath.empty() &&
       Jobs.size() == 1) {
@@ -605,7 +1457,44 @@ int Compilation::performJobs() {
     Diags.diagnose(SourceLoc(), diag::warning_parallel_execution_not_supported);
   }
 
-  int result = performJobsImpl();
+  int result;
+  {
+    CompileTimeTraceScope TraceScope("driver", "driver");
+    result = performJobsImpl();
+  }
+
+  if (!TracePath.empty()) {
+    std::string Error;
+    if (CompileTimeTrace::appendToFile(TracePath, "swift driver", Error)) {
+      Diags.diagnose(SourceLoc(), diag::error_opening_output, TracePath,
+                     Error);
+      if (result == EXIT_SUCCESS)
+        result = EXIT_FAILURE;
+    }
+  }
+
+  // Build systems would rather read one diagnostics file for the module
+  // than one for each of its files. Jobs that were skipped or never ran
+  // don't leave a file behind.
+  if (MergedDiagnosticsArg) {
+    std::vector<std::string> DiagnosticsPaths;
+    for (const auto &Cmd : getJobs()) {
+      const std::string &Path = Cmd->getOutput().getAdditionalOutputForType(
+          types::TY_SerializedDiagnostics);
+      if (!Path.empty() && llvm::sys::fs::exists(Path))
+        DiagnosticsPaths.push_back(Path);
+    }
+
+    StringRef MergedPath = MergedDiagnosticsArg->getValue();
+    std::string Error;
+    if (serialized_diagnostics::mergeFiles(DiagnosticsPaths, MergedPath,
+                                           Error)) {
+      Diags.diagnose(SourceLoc(), diag::error_merging_serialized_diagnostics,
+                     MergedPath, Error);
+      if (result == EXIT_SUCCESS)
+        result = EXIT_FAILURE;
+    }
+  }
 
   if (!SaveTemps) {
     // FIXME: Do we want to be deleting temporaries even when a child process
@@ -16,6 +16,8 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
@@ -48,15 +50,169 @@ using LoadResult = DependencyGraphImpl::LoadResult;
 using DependencyKind = DependencyGraphImpl::DependencyKind;
 using DependencyCallbackTy = LoadResult(StringRef, DependencyKind, bool);
 using InterfaceHashCallbackTy = LoadResult(StringRef);
+using FingerprintCallbackTy = LoadResult(StringRef, DependencyKind, StringRef);
+
+// After an entry, we know more about the node as a whole.
+// Update the "result" variable in the enclosing function.
+// This is a macro rather than a lambda because it contains a return.
+#define UPDATE_RESULT(update) switch (update) {\
+    case LoadResult::HadError: \
+      return LoadResult::HadError; \
+    case LoadResult::UpToDate: \
+      break; \
+    case LoadResult::AffectsDownstream: \
+      result = LoadResult::AffectsDownstream; \
+      break; \
+    } \
+
+/// The binary dependency format.
+///
+/// Every string in the file (names and the interface hash) is stored once in
+/// a string table, and each dependency or provided name is a fixed-width
+/// record referring to it, so the file can be consumed straight out of a
+/// mapped buffer. All integers are little-endian.
+///
+/// \code
+///   header:  "SDEP" version numStrings numRecords interfaceHash
+///   strings: numStrings x { offset length }
+///   records: numRecords x { name fingerprint kind flags reserved(16 bits) }
+///   data:    the bytes of every string, referred to by the string table
+/// \endcode
+///
+/// All fields are 32 bits except the record kind and flags, which are 8 bits.
+/// Member names use the same "{MangledBaseName}\0memberName" encoding as the
+/// in-memory graph. Only "provides" records have fingerprints.
+namespace binary_format {
+  static const char Signature[] = {'S', 'D', 'E', 'P'};
+  static const uint32_t Version = 2;
+  static const uint32_t NoString = ~0U;
+
+  static const size_t HeaderSize = sizeof(Signature) + 4 * sizeof(uint32_t);
+  static const size_t StringEntrySize = 2 * sizeof(uint32_t);
+  static const size_t RecordSize = 2 * sizeof(uint32_t) + 4 * sizeof(uint8_t);
+
+  enum RecordFlags : uint8_t {
+    IsProvides = 1 << 0,
+    IsCascading = 1 << 1
+  };
+} // end namespace binary_format
+
+static bool isBinaryDependencyFile(StringRef data) {
+  return data.startswith(StringRef(binary_format::Signature,
+                                   sizeof(binary_format::Signature)));
+}
+
+/// Returns true if a record with the given fields could have been written
+/// for a YAML dependency file.
+static bool isValidBinaryRecord(uint8_t kind, bool isProvides,
+                                bool isCascading, bool hasFingerprint) {
+  // Provided names are never private.
+  if (isProvides && !isCascading)
+    return false;
+  if (hasFingerprint && !isProvides)
+    return false;
+
+  switch (DependencyKind(kind)) {
+  case DependencyKind::TopLevelName:
+  case DependencyKind::DynamicLookupName:
+  case DependencyKind::NominalType:
+  case DependencyKind::NominalTypeMember:
+    return true;
+  case DependencyKind::ExternalFile:
+    return !isProvides;
+  }
+  return false;
+}
 
 static LoadResult
-parseDependencyFile(llvm::MemoryBuffer &buffer,
-                    llvm::function_ref<DependencyCallbackTy> providesCallback,
-                    llvm::function_ref<DependencyCallbackTy> dependsCallback,
-                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
+parseBinaryDependencyFile(StringRef data,
+                          llvm::function_ref<DependencyCallbackTy> providesCallback,
+                          llvm::function_ref<DependencyCallbackTy> dependsCallback,
+                          llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                          llvm::function_ref<FingerprintCallbackTy> fingerprintCallback) {
+  using namespace llvm::support;
+  using namespace binary_format;
+
+  if (data.size() < HeaderSize)
+    return LoadResult::HadError;
+
+  const char *cursor = data.data() + sizeof(Signature);
+  if (endian::readNext<uint32_t, little, unaligned>(cursor) != Version)
+    return LoadResult::HadError;
+  uint32_t numStrings = endian::readNext<uint32_t, little, unaligned>(cursor);
+  uint32_t numRecords = endian::readNext<uint32_t, little, unaligned>(cursor);
+  uint32_t interfaceHash = endian::readNext<uint32_t, little, unaligned>(cursor);
+
+  uint64_t tablesSize = uint64_t(numStrings) * StringEntrySize +
+                        uint64_t(numRecords) * RecordSize;
+  if (tablesSize > data.size() - HeaderSize)
+    return LoadResult::HadError;
+
+  const char *stringTable = cursor;
+  const char *records = stringTable + numStrings * StringEntrySize;
+  StringRef stringData = data.substr(HeaderSize + tablesSize);
+
+  // Returns true if \p index does not name a valid string.
+  auto getString = [&](uint32_t index, StringRef &result) -> bool {
+    if (index >= numStrings)
+      return true;
+    const char *entry = stringTable + index * StringEntrySize;
+    uint32_t offset = endian::readNext<uint32_t, little, unaligned>(entry);
+    uint32_t length = endian::readNext<uint32_t, little, unaligned>(entry);
+    if (offset > stringData.size() || length > stringData.size() - offset)
+      return true;
+    result = stringData.substr(offset, length);
+    return false;
+  };
+
+  LoadResult result = LoadResult::UpToDate;
+  StringRef name;
+
+  if (interfaceHash != NoString) {
+    if (getString(interfaceHash, name))
+      return LoadResult::HadError;
+    UPDATE_RESULT(interfaceHashCallback(name));
+  }
+
+  for (uint32_t i = 0; i != numRecords; ++i) {
+    uint32_t nameIndex = endian::readNext<uint32_t, little, unaligned>(records);
+    uint32_t fingerprintIndex =
+      endian::readNext<uint32_t, little, unaligned>(records);
+    auto kind = endian::readNext<uint8_t, little, unaligned>(records);
+    auto flags = endian::readNext<uint8_t, little, unaligned>(records);
+    records += sizeof(uint16_t);
+
+    bool isProvides = flags & IsProvides;
+    bool isCascading = flags & IsCascading;
+    bool hasFingerprint = fingerprintIndex != NoString;
+    if (!isValidBinaryRecord(kind, isProvides, isCascading, hasFingerprint))
+      return LoadResult::HadError;
+    if (getString(nameIndex, name))
+      return LoadResult::HadError;
+
+    auto &callback = isProvides ? providesCallback : dependsCallback;
+    UPDATE_RESULT(callback(name, DependencyKind(kind), isCascading));
+
+    if (hasFingerprint) {
+      StringRef fingerprint;
+      if (getString(fingerprintIndex, fingerprint))
+        return LoadResult::HadError;
+      UPDATE_RESULT(fingerprintCallback(name, DependencyKind(kind),
+                                        fingerprint));
+    }
+  }
+
+  return result;
+}
+
+static LoadResult
+parseYAMLDependencyFile(llvm::MemoryBuffer &buffer,
+                        llvm::function_ref<DependencyCallbackTy> providesCallback,
+                        llvm::function_ref<DependencyCallbackTy> dependsCallback,
+                        llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                        llvm::function_ref<FingerprintCallbackTy> fingerprintCallback) {
   namespace yaml = llvm::yaml;
 
-  // FIXME: Switch to a format other than YAML.
   llvm::SourceMgr SM;
   yaml::Stream stream(buffer.getMemBufferRef(), SM);
   auto I = stream.begin();
@@ -73,19 +229,6 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
   LoadResult result = LoadResult::UpToDate;
   SmallString<64> scratch;
 
-  // After an entry, we know more about the node as a whole.
-  // Update the "result" variable above.
-  // This is a macro rather than a lambda because it contains a return.
-#define UPDATE_RESULT(update) switch (update) {\
-    case LoadResult::HadError: \
-      return LoadResult::HadError; \
-    case LoadResult::UpToDate: \
-      break; \
-    case LoadResult::AffectsDownstream: \
-      result = LoadResult::AffectsDownstream; \
-      break; \
-    } \
-
   // FIXME: LLVM's YAML support does incremental parsing in such a way that
   // for-range loops break.
   for (auto i = topLevelMap->begin(), e = topLevelMap->end(); i != e; ++i) {
@@ -106,9 +249,10 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       UPDATE_RESULT(interfaceHashCallback(valueString));
 
     } else {
-      enum class DependencyDirection : bool {
+      enum class DependencyDirection : uint8_t {
         Depends,
-        Provides
+        Provides,
+        Fingerprints
       };
       using KindPair = std::pair<DependencyKind, DependencyDirection>;
 
@@ -140,6 +284,15 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
         .Case("provides-dynamic-lookup",
               std::make_pair(DependencyKind::DynamicLookupName,
                              DependencyDirection::Provides))
+        .Case("fingerprints-top-level",
+              std::make_pair(DependencyKind::TopLevelName,
+                             DependencyDirection::Fingerprints))
+        .Case("fingerprints-nominal",
+              std::make_pair(DependencyKind::NominalType,
+                             DependencyDirection::Fingerprints))
+        .Case("fingerprints-member",
+              std::make_pair(DependencyKind::NominalTypeMember,
+                             DependencyDirection::Fingerprints))
         .Default(std::make_pair(DependencyKind(),
                                 DependencyDirection::Depends));
       if (dirAndKind.first == DependencyKind())
@@ -149,7 +302,42 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       if (!entries)
         return LoadResult::HadError;
 
-      if (dirAndKind.first == DependencyKind::NominalTypeMember) {
+      if (dirAndKind.second == DependencyDirection::Fingerprints) {
+        // Fingerprints come in the form ["name", "fingerprint"], or
+        // ["{MangledBaseName}", "memberName", "fingerprint"] for members.
+        bool isMember = dirAndKind.first == DependencyKind::NominalTypeMember;
+        unsigned numParts = isMember ? 3 : 2;
+
+        for (yaml::Node &rawEntry : *entries) {
+          auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry);
+          if (!entry)
+            return LoadResult::HadError;
+
+          SmallString<64> name;
+          SmallString<32> fingerprint;
+          unsigned index = 0;
+          for (yaml::Node &rawPart : *entry) {
+            auto *part = dyn_cast<yaml::ScalarNode>(&rawPart);
+            if (!part || index == numParts)
+              return LoadResult::HadError;
+
+            if (index == numParts - 1) {
+              fingerprint = part->getValue(scratch);
+            } else {
+              // Smash the type and member names together, as below.
+              if (index != 0)
+                name.push_back('\0');
+              name += part->getValue(scratch);
+            }
+            ++index;
+          }
+          if (index != numParts)
+            return LoadResult::HadError;
+
+          UPDATE_RESULT(fingerprintCallback(name.str(), dirAndKind.first,
+                                            fingerprint.str()));
+        }
+      } else if (dirAndKind.first == DependencyKind::NominalTypeMember) {
         // Handle member dependencies specially. Rather than being a single
         // string, they come in the form ["{MangledBaseName}", "memberName"].
         for (yaml::Node &rawEntry : *entries) {
@@ -206,6 +394,146 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
   return result;
 }
 
+#undef UPDATE_RESULT
+
+static LoadResult
+parseDependencyFile(llvm::MemoryBuffer &buffer,
+                    llvm::function_ref<DependencyCallbackTy> providesCallback,
+                    llvm::function_ref<DependencyCallbackTy> dependsCallback,
+                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                    llvm::function_ref<FingerprintCallbackTy> fingerprintCallback) {
+  if (isBinaryDependencyFile(buffer.getBuffer()))
+    return parseBinaryDependencyFile(buffer.getBuffer(), providesCallback,
+                                     dependsCallback, interfaceHashCallback,
+                                     fingerprintCallback);
+  return parseYAMLDependencyFile(buffer, providesCallback, dependsCallback,
+                                 interfaceHashCallback, fingerprintCallback);
+}
+
+namespace {
+/// Collects the entries of a dependency file and writes them out in the
+/// binary format.
+class BinaryDependencyWriter {
+  struct Record {
+    uint32_t Name;
+    uint32_t Fingerprint;
+    DependencyKind Kind;
+    uint8_t Flags;
+  };
+
+  llvm::StringMap<uint32_t> StringIndices;
+  std::vector<StringRef> Strings;
+  std::vector<Record> Records;
+  uint32_t InterfaceHash = binary_format::NoString;
+
+  /// Maps a provided kind and name to its record, for attaching fingerprints.
+  llvm::StringMap<size_t> ProvidesRecords;
+
+  static std::string getProvidesKey(StringRef name, DependencyKind kind) {
+    std::string key(1, static_cast<char>(kind));
+    key += name;
+    return key;
+  }
+
+  uint32_t intern(StringRef str) {
+    auto insertResult = StringIndices.insert({str, Strings.size()});
+    if (insertResult.second)
+      Strings.push_back(insertResult.first->getKey());
+    return insertResult.first->getValue();
+  }
+
+public:
+  void addRecord(StringRef name, DependencyKind kind, bool isProvides,
+                 bool isCascading) {
+    uint8_t flags = 0;
+    if (isProvides)
+      flags |= binary_format::IsProvides;
+    if (isCascading)
+      flags |= binary_format::IsCascading;
+    if (isProvides)
+      ProvidesRecords[getProvidesKey(name, kind)] = Records.size();
+    Records.push_back({intern(name), binary_format::NoString, kind, flags});
+  }
+
+  void setFingerprint(StringRef name, DependencyKind kind,
+                      StringRef fingerprint) {
+    auto record = ProvidesRecords.find(getProvidesKey(name, kind));
+    if (record == ProvidesRecords.end())
+      return;
+    Records[record->getValue()].Fingerprint = intern(fingerprint);
+  }
+
+  void setInterfaceHash(StringRef hash) {
+    InterfaceHash = intern(hash);
+  }
+
+  void write(raw_ostream &out) const {
+    using namespace llvm::support;
+    endian::Writer<little> writer(out);
+
+    out.write(binary_format::Signature, sizeof(binary_format::Signature));
+    writer.write<uint32_t>(binary_format::Version);
+    writer.write<uint32_t>(Strings.size());
+    writer.write<uint32_t>(Records.size());
+    writer.write<uint32_t>(InterfaceHash);
+
+    uint32_t offset = 0;
+    for (StringRef str : Strings) {
+      writer.write<uint32_t>(offset);
+      writer.write<uint32_t>(str.size());
+      offset += str.size();
+    }
+
+    for (const Record &record : Records) {
+      writer.write<uint32_t>(record.Name);
+      writer.write<uint32_t>(record.Fingerprint);
+      writer.write<uint8_t>(static_cast<uint8_t>(record.Kind));
+      writer.write<uint8_t>(record.Flags);
+      writer.write<uint16_t>(0);
+    }
+
+    for (StringRef str : Strings)
+      out << str;
+  }
+};
+} // end anonymous namespace
+
+bool DependencyGraphImpl::encodeAsBinary(llvm::MemoryBuffer &buffer,
+                                         raw_ostream &out) {
+  if (isBinaryDependencyFile(buffer.getBuffer())) {
+    out << buffer.getBuffer();
+    return false;
+  }
+
+  BinaryDependencyWriter writer;
+  auto dependsCallback = [&writer](StringRef name, DependencyKind kind,
+                                   bool isCascading) -> LoadResult {
+    writer.addRecord(name, kind, /*isProvides=*/false, isCascading);
+    return LoadResult::UpToDate;
+  };
+  auto providesCallback = [&writer](StringRef name, DependencyKind kind,
+                                    bool isCascading) -> LoadResult {
+    writer.addRecord(name, kind, /*isProvides=*/true, isCascading);
+    return LoadResult::UpToDate;
+  };
+  auto interfaceHashCallback = [&writer](StringRef hash) -> LoadResult {
+    writer.setInterfaceHash(hash);
+    return LoadResult::UpToDate;
+  };
+  auto fingerprintCallback = [&writer](StringRef name, DependencyKind kind,
+                                       StringRef fingerprint) -> LoadResult {
+    writer.setFingerprint(name, kind, fingerprint);
+    return LoadResult::UpToDate;
+  };
+
+  if (parseYAMLDependencyFile(buffer, providesCallback, dependsCallback,
+                              interfaceHashCallback,
+                              fingerprintCallback) == LoadResult::HadError)
+    return true;
+  writer.write(out);
+  return false;
+}
+
 LoadResult DependencyGraphImpl::loadFromPath(const void *node, StringRef path) {
   auto buffer = llvm::MemoryBuffer::getFile(path);
   if (!buffer)
@@ -215,13 +543,18 @@ LoadResult DependencyGraphImpl::loadFromPath(const void *node, StringRef path) {
 
 LoadResult
 DependencyGraphImpl::loadFromString(const void *node, StringRef data) {
-  auto buffer = llvm::MemoryBuffer::getMemBuffer(data);
+  // Binary data is often a slice of a larger buffer, so it won't be
+  // null-terminated.
+  bool requiresNullTerminator = !isBinaryDependencyFile(data);
+  auto buffer = llvm::MemoryBuffer::getMemBuffer(data, "",
+                                                 requiresNullTerminator);
   return loadFromBuffer(node, *buffer);
 }
 
 LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
                                                llvm::MemoryBuffer &buffer) {
-  auto &provides = Provides[node];
+  // Anything that changed in an earlier load has been dealt with by now.
+  ChangedProvides.erase(node);
 
   auto dependsCallback = [this, node](StringRef name, DependencyKind kind,
                                       bool isCascading) -> LoadResult {
@@ -250,24 +583,47 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     return LoadResult::UpToDate;
   };
 
+  // Collect the new "provides" set on its own, so that it can be compared
+  // with the old one once the whole file has been read.
+  struct LoadedProvidesEntry {
+    ProvidesEntryTy entry;
+    DependencyMaskTy fingerprintedKinds;
+  };
+  std::vector<LoadedProvidesEntry> newProvides;
+  llvm::StringMap<size_t> newProvidesIndices;
+
   auto providesCallback =
-      [this, node, &provides](StringRef name, DependencyKind kind,
-                              bool isCascading) -> LoadResult {
+      [&newProvides, &newProvidesIndices](StringRef name, DependencyKind kind,
+                                          bool isCascading) -> LoadResult {
     assert(isCascading);
-    auto iter = std::find_if(provides.begin(), provides.end(),
-                             [name](const ProvidesEntryTy &entry) -> bool {
-      return name == entry.name;
-    });
-
-    if (iter == provides.end())
-      provides.push_back({name, kind});
+    auto insertResult = newProvidesIndices.insert({name, newProvides.size()});
+    if (insertResult.second)
+      newProvides.push_back({{name, kind, ""}, None});
     else
-      iter->kindMask |= kind;
+      newProvides[insertResult.first->getValue()].entry.kindMask |= kind;
 
     return LoadResult::UpToDate;
   };
 
-  auto interfaceHashCallback = [this, node](StringRef hash) -> LoadResult {
+  auto fingerprintCallback =
+      [&newProvides, &newProvidesIndices](StringRef name, DependencyKind kind,
+                                          StringRef fingerprint) -> LoadResult {
+    auto index = newProvidesIndices.find(name);
+    if (index == newProvidesIndices.end())
+      return LoadResult::UpToDate;
+
+    auto &loaded = newProvides[index->getValue()];
+    if (!loaded.entry.kindMask.contains(kind))
+      return LoadResult::UpToDate;
+    // A name provided as several kinds has one fingerprint per kind.
+    loaded.entry.fingerprint += fingerprint;
+    loaded.fingerprintedKinds |= kind;
+    return LoadResult::UpToDate;
+  };
+
+  bool interfaceHashChanged = false;
+  auto interfaceHashCallback = [this, node, &interfaceHashChanged](
+      StringRef hash) -> LoadResult {
     auto insertResult = InterfaceHashes.insert(std::make_pair(node, hash));
 
     if (insertResult.second) {
@@ -279,14 +635,74 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     auto iter = insertResult.first;
     if (hash != iter->second) {
       iter->second = hash;
-      return LoadResult::AffectsDownstream;
+      interfaceHashChanged = true;
     }
 
     return LoadResult::UpToDate;
   };
 
-  return parseDependencyFile(buffer, providesCallback, dependsCallback,
-                             interfaceHashCallback);
+  LoadResult result = parseDependencyFile(buffer, providesCallback,
+                                          dependsCallback,
+                                          interfaceHashCallback,
+                                          fingerprintCallback);
+  if (result == LoadResult::HadError)
+    return result;
+
+  // Merge the new "provides" set into the old one, keeping track of every
+  // (kind, name) pair that was added, removed, or whose fingerprint changed.
+  // Entries without a fingerprint for each of their kinds are assumed to have
+  // changed whenever the file's interface does.
+  auto &provides = Provides[node];
+  std::vector<ProvidesEntryTy> changed;
+
+  for (auto &oldEntry : provides) {
+    if (!newProvidesIndices.count(oldEntry.name))
+      changed.push_back({oldEntry.name, oldEntry.kindMask, ""});
+  }
+
+  for (auto &loaded : newProvides) {
+    ProvidesEntryTy &newEntry = loaded.entry;
+    if (!loaded.fingerprintedKinds.contains(newEntry.kindMask))
+      newEntry.fingerprint.clear();
+
+    auto iter = std::find_if(provides.begin(), provides.end(),
+                             [&newEntry](const ProvidesEntryTy &entry) -> bool {
+      return newEntry.name == entry.name;
+    });
+
+    if (iter == provides.end()) {
+      changed.push_back({newEntry.name, newEntry.kindMask, ""});
+      provides.push_back(std::move(newEntry));
+      continue;
+    }
+
+    DependencyMaskTy changedKinds = (newEntry.kindMask - iter->kindMask) |
+                                    (iter->kindMask - newEntry.kindMask);
+    if (newEntry.fingerprint.empty() ||
+        newEntry.fingerprint != iter->fingerprint) {
+      changedKinds |= newEntry.kindMask;
+    }
+    if (changedKinds)
+      changed.push_back({newEntry.name, changedKinds, ""});
+
+    iter->kindMask |= newEntry.kindMask;
+    iter->fingerprint = std::move(newEntry.fingerprint);
+  }
+
+  if (!interfaceHashChanged)
+    return result;
+
+  // If a new dependency already has to be rebuilt, be conservative and let
+  // everything downstream of this node be rebuilt as well.
+  if (result == LoadResult::AffectsDownstream)
+    return result;
+
+  // Otherwise, only what changed affects other nodes. If nothing changed that
+  // other nodes can see, they don't need to be rebuilt at all.
+  if (changed.empty())
+    return LoadResult::UpToDate;
+  ChangedProvides[node] = std::move(changed);
+  return LoadResult::AffectsDownstream;
 }
 
 void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
@@ -322,12 +738,9 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   SmallPtrSet<const void *, 16> visitedSet;
 
   auto addDependentsToWorklist = [&](const void *next,
-                                     ArrayRef<MarkTracerImpl::Entry> reason) {
-    auto allProvided = Provides.find(next);
-    if (allProvided == Provides.end())
-      return;
-
-    for (const auto &provided : allProvided->second) {
+                                     ArrayRef<MarkTracerImpl::Entry> reason,
+                                     ArrayRef<ProvidesEntryTy> allProvided) {
+    for (const auto &provided : allProvided) {
       auto allDependents = Dependencies.find(provided.name);
       if (allDependents == Dependencies.end())
         continue;
@@ -372,9 +785,26 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
     }
   };
 
-  // Always mark through the starting node, even if it's already marked.
-  markIntransitive(node);
-  addDependentsToWorklist(node, {});
+  auto getProvides = [this](const void *node) -> ArrayRef<ProvidesEntryTy> {
+    auto allProvided = Provides.find(node);
+    if (allProvided == Provides.end())
+      return {};
+    return allProvided->second;
+  };
+
+  // Always mark through the starting node, even if it's already marked. If it
+  // hasn't been marked yet and its last load said what changed, only mark
+  // through the dependents of what changed.
+  auto changed = ChangedProvides.find(node);
+  if (changed != ChangedProvides.end() && !isMarked(node)) {
+    markIntransitive(node);
+    addDependentsToWorklist(node, {}, changed->second);
+  } else {
+    markIntransitive(node);
+    addDependentsToWorklist(node, {}, getProvides(node));
+  }
+  if (changed != ChangedProvides.end())
+    ChangedProvides.erase(changed);
 
   while (!worklist.empty()) {
     auto next = worklist.pop_back_val();
@@ -386,7 +816,7 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       continue;
     }
 
-    addDependentsToWorklist(next.Node, next.Reason);
+    addDependentsToWorklist(next.Node, next.Reason, getProvides(next.Node));
     if (!markIntransitive(next.Node))
       continue;
     record(next);
@@ -16,6 +16,7 @@
 
 #include "swift/Driver/Driver.h"
 
+#include "BuildRecordFormat.h"
 #include "ToolChains.h"
 #include "swift/Strings.h"
 #include "swift/AST/DiagnosticEngine.h"
@@ -43,6 +44,7 @@
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
@@ -52,6 +54,7 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include <memory>
+#include <thread>
 
 using namespace swift;
 using namespace swift::driver;
@@ -183,19 +186,121 @@ class Driver::InputInfoMap
 };
 using InputInfoMap = Driver::InputInfoMap;
 
-static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
-                                 const Driver::InputList &inputs,
-                                 StringRef buildRecordPath) {
-  // Treat a missing file as "no previous build".
-  auto buffer = llvm::MemoryBuffer::getFile(buildRecordPath);
+/// Maps each input of the previous build to its state in the build record.
+using PreviousInputMap = llvm::StringMap<CompileJobAction::InputInfo>;
+
+/// Reads the binary copy of the build record at \p buildRecordPath, as long
+/// as it was written together with the YAML record described by
+/// \p recordStatus.
+///
+/// \returns true if the binary record was used, false if the YAML record has
+/// to be parsed instead.
+///
+/// \sa build_record_format
+static bool readBinaryBuildRecord(InputInfoMap &map, StringRef argsHashStr,
+                                  StringRef buildRecordPath,
+                                  const llvm::sys::fs::file_status &recordStatus,
+                                  PreviousInputMap &previousInputs,
+                                  bool &versionValid, bool &optionsMatch) {
+  using namespace llvm::support;
+  namespace format = build_record_format;
+  using InputInfo = CompileJobAction::InputInfo;
+
+  auto buffer = llvm::MemoryBuffer::getFile(format::getPath(buildRecordPath),
+                                            /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
   if (!buffer)
     return false;
 
+  StringRef data = buffer.get()->getBuffer();
+  if (data.size() < format::HeaderSize ||
+      !data.startswith(StringRef(format::Signature, sizeof(format::Signature))))
+    return false;
+
+  const char *cursor = data.data() + sizeof(format::Signature);
+  if (endian::readNext<uint32_t, little, unaligned>(cursor) != format::Version)
+    return false;
+
+  // A driver that doesn't know about the binary record may have rewritten
+  // the YAML record since.
+  llvm::sys::TimeValue recordModTime = recordStatus.getLastModificationTime();
+  if (endian::readNext<uint64_t, little, unaligned>(cursor) !=
+        recordStatus.getSize() ||
+      endian::readNext<uint64_t, little, unaligned>(cursor) !=
+        recordModTime.toEpochTime() ||
+      endian::readNext<uint32_t, little, unaligned>(cursor) !=
+        uint32_t(recordModTime.nanoseconds()))
+    return false;
+
+  auto versionLength = endian::readNext<uint32_t, little, unaligned>(cursor);
+  auto argsHashLength = endian::readNext<uint32_t, little, unaligned>(cursor);
+  llvm::sys::TimeValue buildTime;
+  buildTime.seconds(endian::readNext<uint64_t, little, unaligned>(cursor));
+  buildTime.nanoseconds(endian::readNext<uint32_t, little, unaligned>(cursor));
+  auto numEntries = endian::readNext<uint32_t, little, unaligned>(cursor);
+
+  if (uint64_t(data.end() - cursor) < uint64_t(versionLength) + argsHashLength)
+    return false;
+  StringRef compilerVersion(cursor, versionLength);
+  cursor += versionLength;
+  StringRef argsHash(cursor, argsHashLength);
+  cursor += argsHashLength;
+
+  for (uint32_t i = 0; i != numEntries; ++i) {
+    if (size_t(data.end() - cursor) < format::EntryHeaderSize) {
+      previousInputs.clear();
+      return false;
+    }
+
+    auto status = endian::readNext<uint8_t, little, unaligned>(cursor);
+    auto nameLength = endian::readNext<uint32_t, little, unaligned>(cursor);
+    llvm::sys::TimeValue modTime;
+    modTime.seconds(endian::readNext<uint64_t, little, unaligned>(cursor));
+    modTime.nanoseconds(endian::readNext<uint32_t, little, unaligned>(cursor));
+
+    if (size_t(data.end() - cursor) < nameLength) {
+      previousInputs.clear();
+      return false;
+    }
+    StringRef name(cursor, nameLength);
+    cursor += nameLength;
+
+    InputInfo::Status previousBuildState;
+    switch (status) {
+    case format::UpToDate:
+      previousBuildState = InputInfo::UpToDate;
+      break;
+    case format::NeedsCascadingBuild:
+      previousBuildState = InputInfo::NeedsCascadingBuild;
+      break;
+    case format::NeedsNonCascadingBuild:
+      previousBuildState = InputInfo::NeedsNonCascadingBuild;
+      break;
+    default:
+      previousInputs.clear();
+      return false;
+    }
+    previousInputs[name] = { previousBuildState, modTime };
+  }
+
+  versionValid = (compilerVersion == version::getSwiftFullVersion());
+  optionsMatch = (argsHash == argsHashStr);
+  map[nullptr] = { InputInfo::NeedsCascadingBuild, buildTime };
+  return true;
+}
+
+/// Parses the YAML build record in \p buffer.
+///
+/// \returns true if the record is malformed.
+static bool readYAMLBuildRecord(InputInfoMap &map, StringRef argsHashStr,
+                                const llvm::MemoryBuffer &buffer,
+                                PreviousInputMap &previousInputs,
+                                bool &versionValid, bool &optionsMatch) {
   namespace yaml = llvm::yaml;
   using InputInfo = CompileJobAction::InputInfo;
 
   llvm::SourceMgr SM;
-  yaml::Stream stream(buffer.get()->getMemBufferRef(), SM);
+  yaml::Stream stream(buffer.getMemBufferRef(), SM);
 
   auto I = stream.begin();
   if (I == stream.end() || !I->getRoot())
@@ -206,10 +311,6 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
     return true;
   SmallString<64> scratch;
 
-  llvm::StringMap<InputInfo> previousInputs;
-  bool versionValid = false;
-  bool optionsMatch = true;
-
   auto readTimeValue = [&scratch](yaml::Node *node,
                                   llvm::sys::TimeValue &timeValue) -> bool {
     auto *seq = dyn_cast<yaml::SequenceNode>(node);
@@ -313,6 +414,31 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
     }
   }
 
+  return false;
+}
+
+static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
+                                 const Driver::InputList &inputs,
+                                 StringRef buildRecordPath) {
+  // Treat a missing file as "no previous build".
+  llvm::sys::fs::file_status recordStatus;
+  if (llvm::sys::fs::status(buildRecordPath, recordStatus))
+    return false;
+
+  PreviousInputMap previousInputs;
+  bool versionValid = false;
+  bool optionsMatch = true;
+
+  if (!readBinaryBuildRecord(map, argsHashStr, buildRecordPath, recordStatus,
+                             previousInputs, versionValid, optionsMatch)) {
+    auto buffer = llvm::MemoryBuffer::getFile(buildRecordPath);
+    if (!buffer)
+      return false;
+    if (readYAMLBuildRecord(map, argsHashStr, *buffer.get(), previousInputs,
+                            versionValid, optionsMatch))
+      return true;
+  }
+
   if (!versionValid || !optionsMatch)
     return true;
 
@@ -448,6 +574,20 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
           // FIXME: Distinguish errors from "file removed", which is benign.
         } else {
           rebuildEverything = false;
+
+          // Deciding which jobs to skip looks at every input and primary
+          // output, so stat them all up front.
+          SmallVector<StringRef, 64> Paths;
+          for (auto &InputPair : Inputs) {
+            StringRef Input = InputPair.second->getValue();
+            Paths.push_back(Input);
+            if (auto *OutputMap = OFM->getOutputMapForInput(Input)) {
+              auto Output = OutputMap->find(OI.CompilerOutputType);
+              if (Output != OutputMap->end())
+                Paths.push_back(Output->second);
+            }
+          }
+          prefetchFileStatuses(Paths);
         }
       }
     }
@@ -475,6 +615,15 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
     }
   }
 
+  uint64_t MemoryBudgetInMegabytes = 0;
+  if (const Arg *A = ArgList->getLastArg(options::OPT_job_memory_budget)) {
+    if (StringRef(A->getValue()).getAsInteger(10, MemoryBudgetInMegabytes)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(*ArgList), A->getValue());
+      return nullptr;
+    }
+  }
+
   OutputLevel Level = OutputLevel::Normal;
   if (const Arg *A = ArgList->getLastArg(options::OPT_v,
                                          options::OPT_parseable_output)) {
@@ -507,6 +656,13 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   if (ShowIncrementalBuildDecisions)
     C->setShowsIncrementalBuildDecisions();
 
+  C->setMemoryBudget(MemoryBudgetInMegabytes * 1024 * 1024);
+
+  // Batch mode only applies to compiles with one primary file per job.
+  if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      C->getArgs().hasArg(options::OPT_enable_batch_mode))
+    C->setBatchModeEnabled();
+
   // This has to happen after building jobs, because otherwise we won't even
   // emit .swiftdeps files for the next build.
   if (rebuildEverything)
@@ -701,13 +857,60 @@ static bool checkInputExistence(const Driver &D, const DerivedArgList &Args,
   if (Input == "-")
     return true;
 
-  if (llvm::sys::fs::exists(Input))
+  if (llvm::sys::fs::exists(D.getFileStatus(Input)))
     return true;
 
   Diags.diagnose(SourceLoc(), diag::error_no_such_file_or_directory, Input);
   return false;
 }
 
+void Driver::prefetchFileStatuses(ArrayRef<StringRef> Paths) const {
+  SmallVector<StringRef, 64> Uncached;
+  for (StringRef Path : Paths)
+    if (!FileStatuses.count(Path))
+      Uncached.push_back(Path);
+
+  // A failed stat leaves the status as file_not_found or status_error.
+  std::vector<llvm::sys::fs::file_status> Statuses(Uncached.size());
+  auto statRange = [&](size_t Begin, size_t End) {
+    for (size_t i = Begin; i != End; ++i)
+      (void)llvm::sys::fs::status(Uncached[i], Statuses[i]);
+  };
+
+  // Only use threads when each one has enough work to be worth starting.
+  const size_t MinPathsPerThread = 64;
+  size_t NumThreads = std::min<size_t>(
+      std::max(std::thread::hardware_concurrency(), 1U),
+      Uncached.size() / MinPathsPerThread);
+
+  if (NumThreads <= 1) {
+    statRange(0, Uncached.size());
+  } else {
+    size_t ChunkSize = (Uncached.size() + NumThreads - 1) / NumThreads;
+    std::vector<std::thread> Threads;
+    for (size_t Begin = ChunkSize; Begin < Uncached.size(); Begin += ChunkSize)
+      Threads.emplace_back(statRange, Begin,
+                           std::min(Begin + ChunkSize, Uncached.size()));
+    statRange(0, ChunkSize);
+    for (auto &Thread : Threads)
+      Thread.join();
+  }
+
+  for (size_t i = 0, e = Uncached.size(); i != e; ++i)
+    FileStatuses[Uncached[i]] = Statuses[i];
+}
+
+const llvm::sys::fs::file_status &
+Driver::getFileStatus(StringRef Path) const {
+  auto Known = FileStatuses.find(Path);
+  if (Known != FileStatuses.end())
+    return Known->getValue();
+
+  llvm::sys::fs::file_status &Status = FileStatuses[Path];
+  (void)llvm::sys::fs::status(Path, Status);
+  return Status;
+}
+
 void Driver::buildInputs(const ToolChain &TC,
                          const DerivedArgList &Args,
                          InputList &Inputs) const {
@@ -716,6 +919,15 @@ void Driver::buildInputs(const ToolChain &TC,
 
   llvm::StringMap<StringRef> SourceFileNames;
 
+  if (getCheckInputFilesExist()) {
+    SmallVector<StringRef, 64> InputPaths;
+    for (const Arg *A : Args)
+      if (A->getOption().getKind() == Option::InputClass &&
+          StringRef(A->getValue()) != "-")
+        InputPaths.push_back(A->getValue());
+    prefetchFileStatuses(InputPaths);
+  }
+
   for (Arg *A : Args) {
     if (A->getOption().getKind() == Option::InputClass) {
       StringRef Value = A->getValue();
@@ -962,6 +1174,15 @@ void Driver::buildOutputInfo(const ToolChain &TC, const DerivedArgList &Args,
 
   assert(OI.CompilerOutputType != types::ID::TY_INVALID);
 
+  if (const Arg *A = Args.getLastArg(options::OPT_whole_program)) {
+    if (OI.CompilerMode == OutputInfo::Mode::SingleCompile &&
+        OI.LinkAction == LinkKind::Executable)
+      OI.ShouldAssumeWholeProgram = true;
+    else
+      Diags.diagnose(SourceLoc(), diag::warning_whole_program_ignored,
+                     A->getSpelling());
+  }
+
   if (const Arg *A = Args.getLastArg(options::OPT_g_Group)) {
     if (A->getOption().matches(options::OPT_g))
       OI.DebugInfoKind = IRGenDebugInfoKind::Normal;
@@ -1112,6 +1333,19 @@ void Driver::buildActions(const ToolChain &TC,
   switch (OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
+    // Precompile the bridging header once, rather than having every compile
+    // job parse it again. The action is shared by all of the compile actions;
+    // like the rest of the action graph, it is never freed.
+    Action *PCH = nullptr;
+    if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+        Args.hasArg(options::OPT_enable_bridging_pch)) {
+      if (const Arg *A = Args.getLastArg(options::OPT_import_objc_header)) {
+        if (!StringRef(A->getValue()).endswith(PCH_EXTENSION))
+          PCH = new GeneratePCHJobAction(
+            new InputAction(*A, types::TY_ObjCHeader));
+      }
+    }
+
     for (const InputPair &Input : Inputs) {
       types::ID InputType = Input.first;
       const Arg *InputArg = Input.second;
@@ -1132,6 +1366,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              types::TY_LLVM_BC,
                                              previousBuildState));
+          if (PCH)
+            Current->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
           Current.reset(new BackendJobAction(Current.release(),
                                              OI.CompilerOutputType, 0));
@@ -1139,6 +1375,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              OI.CompilerOutputType,
                                              previousBuildState));
+          if (PCH)
+            Current->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
         }
         AllLinkerInputs.push_back(Current.release());
@@ -1171,6 +1409,7 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_SerializedDiagnostics:
       case types::TY_ObjCHeader:
       case types::TY_ClangModuleFile:
+      case types::TY_PCH:
       case types::TY_SwiftDeps:
       case types::TY_Remapping:
         // We could in theory handle assembly or LLVM input, but let's not.
@@ -1576,7 +1815,8 @@ static void addAuxiliaryOutput(Compilation &C, CommandOutput &output,
 /// If the file at \p input has not been modified since the last build (i.e. its
 /// mtime has not changed), adjust the Job's condition accordingly.
 static void
-handleCompileJobCondition(Job *J, CompileJobAction::InputInfo inputInfo,
+handleCompileJobCondition(const Driver &D, Job *J,
+                          CompileJobAction::InputInfo inputInfo,
                           StringRef input, bool alwaysRebuildDependents) {
   if (inputInfo.status == CompileJobAction::InputInfo::NewlyAdded) {
     J->setCondition(Job::Condition::NewlyAdded);
@@ -1588,8 +1828,8 @@ handleCompileJobCondition(Job *J, CompileJobAction::InputInfo inputInfo,
     J->setCondition(Job::Condition::RunWithoutCascading);
   }
 
-  llvm::sys::fs::file_status inputStatus;
-  if (llvm::sys::fs::status(input, inputStatus))
+  const llvm::sys::fs::file_status &inputStatus = D.getFileStatus(input);
+  if (!llvm::sys::fs::exists(inputStatus))
     return;
 
   J->setInputModTime(inputStatus.getLastModificationTime());
@@ -1599,7 +1839,8 @@ handleCompileJobCondition(Job *J, CompileJobAction::InputInfo inputInfo,
   Job::Condition condition;
   switch (inputInfo.status) {
   case CompileJobAction::InputInfo::UpToDate:
-    if (!llvm::sys::fs::exists(J->getOutput().getPrimaryOutputFilename()))
+    if (!llvm::sys::fs::exists(
+            D.getFileStatus(J->getOutput().getPrimaryOutputFilename())))
       condition = Job::Condition::RunWithoutCascading;
     else
       condition = Job::Condition::CheckDependencies;
@@ -1696,6 +1937,8 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
     }
     // Add an output file for each input job.
     for (const Job *job : InputJobs) {
+      if (isa<GeneratePCHJobAction>(job->getSource()))
+        continue;
       OutputFunc(job->getOutput().getBaseInput(0));
     }
   } else {
@@ -1805,7 +2048,8 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
 
   if (isa<CompileJobAction>(JA)) {
     // Choose the serialized diagnostics output path.
-    if (C.getArgs().hasArg(options::OPT_serialize_diagnostics)) {
+    if (C.getArgs().hasArg(options::OPT_serialize_diagnostics,
+                           options::OPT_serialize_diagnostics_module_path)) {
       addAuxiliaryOutput(C, *Output, types::TY_SerializedDiagnostics, OI,
                          OutputMap);
 
@@ -1826,6 +2070,23 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
     }
   }
 
+  // With -parallel-objc-header, each compile job prints the part of the
+  // Objective-C header for its primary file, to be merged by the merge-module
+  // job. Keep it next to the object file, so that it's still there for the
+  // jobs skipped by an incremental build.
+  if (isa<CompileJobAction>(JA) &&
+      OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      C.getArgs().hasArg(options::OPT_parallel_objc_header) &&
+      C.getArgs().hasArg(options::OPT_emit_objc_header,
+                         options::OPT_emit_objc_header_path)) {
+    llvm::SmallString<128> Path(Output->getPrimaryOutputFilenames()[0]);
+    bool isTempFile = C.isTemporaryFile(Path);
+    llvm::sys::path::replace_extension(Path, "partial.h");
+    Output->setAdditionalOutputForType(types::TY_ObjCHeader, Path);
+    if (isTempFile)
+      C.addTemporaryFile(Path);
+  }
+
   // Choose the Objective-C header output path.
   if ((isa<MergeModuleJobAction>(JA) ||
        (isa<CompileJobAction>(JA) &&
@@ -1878,8 +2139,8 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
       auto compileJob = cast<CompileJobAction>(A);
       bool alwaysRebuildDependents =
           C.getArgs().hasArg(options::OPT_driver_always_rebuild_dependents);
-      handleCompileJobCondition(J, compileJob->getInputInfo(), BaseInput,
-                                alwaysRebuildDependents);
+      handleCompileJobCondition(*this, J, compileJob->getInputInfo(),
+                                BaseInput, alwaysRebuildDependents);
     }
   }
 
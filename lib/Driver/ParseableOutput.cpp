@@ -16,7 +16,9 @@
 #include "swift/Driver/Action.h"
 #include "swift/Driver/Job.h"
 #include "swift/Driver/Types.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Option/Arg.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace swift::driver::parseable_output;
@@ -269,3 +271,93 @@ void parseable_output::emitSkippedMessage(raw_ostream &os, const Job &Cmd) {
   SkippedMessage msg(Cmd);
   emitMessage(os, msg);
 }
+
+static void writeJSONString(raw_ostream &os, StringRef str) {
+  os << '"';
+  for (unsigned char c : str) {
+    switch (c) {
+    case '"':  os << "\\\""; break;
+    case '\\': os << "\\\\"; break;
+    case '\n': os << "\\n"; break;
+    case '\t': os << "\\t"; break;
+    default:
+      if (c < 0x20)
+        os << llvm::format("\\u%04x", c);
+      else
+        os << c;
+    }
+  }
+  os << '"';
+}
+
+/// Starts a progress event with the fields every event has.
+static void beginEvent(raw_ostream &os, StringRef Kind, const Job &Cmd) {
+  os << "{\"kind\":\"" << Kind << "\",\"name\":\""
+     << Cmd.getSource().getClassName() << "\",\"inputs\":[";
+  bool First = true;
+  for (const Action *A : Cmd.getSource().getInputs()) {
+    if (const InputAction *IA = dyn_cast<InputAction>(A)) {
+      if (!First)
+        os << ',';
+      writeJSONString(os, IA->getInputArg().getValue());
+      First = false;
+    }
+  }
+  os << ']';
+}
+
+static void writeResourceUsage(raw_ostream &os,
+                               const TaskProcessInformation &ProcInfo) {
+  os << ",\"wall-time-us\":" << ProcInfo.WallTimeMicros
+     << ",\"user-time-us\":" << ProcInfo.UserTimeMicros
+     << ",\"system-time-us\":" << ProcInfo.SystemTimeMicros
+     << ",\"max-rss-bytes\":" << ProcInfo.MaxResidentSetBytes;
+}
+
+/// Writes \p event to \p os with a single call.
+static void emitEvent(raw_ostream &os, StringRef event) {
+  os << event;
+  os.flush();
+}
+
+void parseable_output::emitBeganEvent(raw_ostream &os, const Job &Cmd,
+                                      ProcessId Pid, uint64_t TimeMicros) {
+  SmallString<256> Buffer;
+  llvm::raw_svector_ostream Event(Buffer);
+  beginEvent(Event, "began", Cmd);
+  Event << ",\"pid\":" << Pid << ",\"time-us\":" << TimeMicros << "}\n";
+  emitEvent(os, Event.str());
+}
+
+void parseable_output::emitFinishedEvent(
+    raw_ostream &os, const Job &Cmd, ProcessId Pid, int ExitStatus,
+    const TaskProcessInformation &ProcInfo) {
+  SmallString<256> Buffer;
+  llvm::raw_svector_ostream Event(Buffer);
+  beginEvent(Event, "finished", Cmd);
+  Event << ",\"pid\":" << Pid << ",\"exit-status\":" << ExitStatus;
+  writeResourceUsage(Event, ProcInfo);
+  Event << "}\n";
+  emitEvent(os, Event.str());
+}
+
+void parseable_output::emitSignalledEvent(
+    raw_ostream &os, const Job &Cmd, ProcessId Pid, StringRef ErrorMsg,
+    const TaskProcessInformation &ProcInfo) {
+  SmallString<256> Buffer;
+  llvm::raw_svector_ostream Event(Buffer);
+  beginEvent(Event, "signalled", Cmd);
+  Event << ",\"pid\":" << Pid << ",\"error-message\":";
+  writeJSONString(Event, ErrorMsg);
+  writeResourceUsage(Event, ProcInfo);
+  Event << "}\n";
+  emitEvent(os, Event.str());
+}
+
+void parseable_output::emitSkippedEvent(raw_ostream &os, const Job &Cmd) {
+  SmallString<256> Buffer;
+  llvm::raw_svector_ostream Event(Buffer);
+  beginEvent(Event, "skipped", Cmd);
+  Event << "}\n";
+  emitEvent(os, Event.str());
+}
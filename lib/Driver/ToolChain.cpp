@@ -21,6 +21,8 @@
 
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
+#include "swift/Option/Options.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
@@ -53,6 +55,7 @@ ToolChain::constructJob(const JobAction &JA,
     CASE(ModuleWrapJob)
     CASE(LinkJob)
     CASE(GenerateDSYMJob)
+    CASE(GeneratePCHJob)
     CASE(AutolinkExtractJob)
     CASE(REPLJob)
 #undef CASE
@@ -61,6 +64,27 @@ ToolChain::constructJob(const JobAction &JA,
     }
   }();
 
+  // Hand compile jobs to a compile server, which has the modules they import
+  // loaded already.
+  if (const Arg *A = args.getLastArg(options::OPT_compile_server_socket)) {
+    ArgStringList &arguments = invocationInfo.Arguments;
+    if (isa<CompileJobAction>(JA) && !arguments.empty() &&
+        StringRef(arguments.front()) == "-frontend") {
+      arguments.insert(arguments.begin(), A->getValue());
+      arguments.insert(arguments.begin(), "-compile-server-client");
+    }
+  }
+
+  // Look compile jobs up in the compile cache, which runs them on a miss.
+  if (const Arg *A = args.getLastArg(options::OPT_compile_cache)) {
+    if (isa<CompileJobAction>(JA) && !invocationInfo.Arguments.empty()) {
+      invocationInfo.Arguments.insert(invocationInfo.Arguments.begin(),
+                                      A->getValue());
+      invocationInfo.Arguments.insert(invocationInfo.Arguments.begin(),
+                                      "-compile-cache");
+    }
+  }
+
   // Special-case the Swift frontend.
   const char *executablePath = nullptr;
   if (StringRef(SWIFT_EXECUTABLE_NAME) == invocationInfo.ExecutableName) {
@@ -88,6 +112,65 @@ ToolChain::constructJob(const JobAction &JA,
                                 std::move(invocationInfo.ExtraEnvironment));
 }
 
+std::unique_ptr<Job>
+ToolChain::constructBatchJob(ArrayRef<const Job *> jobs,
+                             StringRef outputFileMapPath,
+                             const llvm::opt::ArgList &args) const {
+  assert(!jobs.empty() && "cannot batch zero jobs");
+  const Job *first = jobs.front();
+
+  // Options naming an output of a single primary file. In batch mode these
+  // come from the output file map instead.
+  static const char * const perPrimaryOptions[] = {
+    "-o",
+    "-emit-module-path",
+    "-emit-module-doc-path",
+    "-emit-dependencies-path",
+    "-emit-reference-dependencies-path",
+  };
+
+  llvm::StringSet<> primaries;
+  auto output = llvm::make_unique<CommandOutput>(
+    first->getOutput().getPrimaryOutputType());
+  for (const Job *cmd : jobs) {
+    assert(isa<CompileJobAction>(cmd->getSource()) &&
+           "only compile jobs can be batched");
+    assert(cmd->getExecutable() == first->getExecutable() &&
+           "batched jobs must use the same frontend");
+    const CommandOutput &cmdOutput = cmd->getOutput();
+    primaries.insert(cmdOutput.getBaseInput(0));
+    output->addPrimaryOutput(cmdOutput.getPrimaryOutputFilename(),
+                             cmdOutput.getBaseInput(0));
+  }
+
+  // All of the jobs differ only in which input is the primary file and in
+  // their per-file outputs, so start from the first job's arguments.
+  ArgStringList arguments;
+  const ArgStringList &firstArgs = first->getArguments();
+  for (size_t i = 0, e = firstArgs.size(); i != e; ++i) {
+    StringRef arg = firstArgs[i];
+    if (arg == "-primary-file")
+      continue;
+    if (std::find(std::begin(perPrimaryOptions), std::end(perPrimaryOptions),
+                  arg) != std::end(perPrimaryOptions)) {
+      ++i;
+      continue;
+    }
+    if (primaries.erase(arg))
+      arguments.push_back("-primary-file");
+    arguments.push_back(firstArgs[i]);
+  }
+  assert(primaries.empty() && "primary file missing from the first job");
+
+  arguments.push_back("-batch-output-file-map");
+  arguments.push_back(args.MakeArgString(outputFileMapPath));
+
+  SmallVector<const Job *, 4> inputs;
+  return llvm::make_unique<Job>(first->getSource(), std::move(inputs),
+                                std::move(output), first->getExecutable(),
+                                std::move(arguments));
+}
+
 std::string
 ToolChain::findProgramRelativeToSwift(StringRef executableName) const {
   auto insertionResult =
@@ -110,6 +193,16 @@ ToolChain::findProgramRelativeToSwiftImpl(StringRef executableName) const {
   return {};
 }
 
+std::string ToolChain::getRelocatableLinkerPath() const {
+  std::string relativePath = findProgramRelativeToSwift("ld");
+  if (!relativePath.empty())
+    return relativePath;
+  auto systemPath = llvm::sys::findProgramByName("ld");
+  if (systemPath)
+    return systemPath.get();
+  return {};
+}
+
 types::ID ToolChain::lookupTypeForExtension(StringRef Ext) const {
   return types::lookupTypeForExtension(Ext);
 }
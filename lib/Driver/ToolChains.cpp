@@ -124,8 +124,17 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_parse_stdlib);
   inputArgs.AddLastArg(arguments, options::OPT_resource_dir);
   inputArgs.AddLastArg(arguments, options::OPT_solver_memory_threshold);
+  inputArgs.AddLastArg(arguments, options::OPT_type_check_report);
+  inputArgs.AddLastArg(arguments, options::OPT_type_check_report_count);
+  inputArgs.AddLastArg(arguments, options::OPT_trace_compile_time);
+  inputArgs.AddLastArg(arguments, options::OPT_progress_output);
+  inputArgs.AddLastArg(arguments, options::OPT_immediate_object_cache_path);
   inputArgs.AddLastArg(arguments, options::OPT_profile_generate);
   inputArgs.AddLastArg(arguments, options::OPT_profile_coverage_mapping);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_use);
+
+  if (OI.ShouldAssumeWholeProgram)
+    arguments.push_back("-whole-program");
 
   // Pass on any build config options
   inputArgs.AddAllArgs(arguments, options::OPT_D);
@@ -205,6 +214,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -230,8 +240,13 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   
   Arguments.push_back(FrontendModeOption);
 
-  assert(context.Inputs.empty() &&
-         "The Swift frontend does not expect to be fed any input Jobs!");
+  // The only jobs a compile can depend on are the ones that precompile the
+  // bridging header.
+  for (const Job *PCH : context.Inputs) {
+    assert(isa<GeneratePCHJobAction>(PCH->getSource()) &&
+           "The Swift frontend does not expect to be fed any input Jobs!");
+    (void)PCH;
+  }
 
   // Add input arguments.
   switch (context.OI.CompilerMode) {
@@ -243,6 +258,8 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     auto *IA = cast<InputAction>(context.InputActions[0]);
     const Arg &PrimaryInputArg = IA->getInputArg();
     bool FoundPrimaryInput = false;
+    unsigned NumInputs = 0;
+    unsigned PrimaryInputIndex = 0;
 
     for (auto *A : make_range(context.Args.filtered_begin(options::OPT_INPUT),
                               context.Args.filtered_end())) {
@@ -251,8 +268,23 @@ ToolChain::constructInvocation(const CompileJobAction &job,
       if (!FoundPrimaryInput && PrimaryInputArg.getIndex() == A->getIndex()) {
         Arguments.push_back("-primary-file");
         FoundPrimaryInput = true;
+        PrimaryInputIndex = NumInputs;
       }
       Arguments.push_back(A->getValue());
+      ++NumInputs;
+    }
+
+    // Every job parses every input, so give each job its own share of the
+    // AST verification of the files it doesn't type-check. Batched jobs
+    // would drop shares, so leave batch mode alone.
+    if (NumInputs > 1 &&
+        context.Args.hasArg(options::OPT_distribute_ast_verification) &&
+        !context.Args.hasArg(options::OPT_enable_batch_mode)) {
+      Arguments.push_back("-ast-verifier-process-count");
+      Arguments.push_back(context.Args.MakeArgString(Twine(NumInputs)));
+      Arguments.push_back("-ast-verifier-process-id");
+      Arguments.push_back(
+          context.Args.MakeArgString(Twine(PrimaryInputIndex)));
     }
     break;
   }
@@ -296,12 +328,15 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   const std::string &ObjCHeaderOutputPath =
     context.Output.getAdditionalOutputForType(types::ID::TY_ObjCHeader);
   if (!ObjCHeaderOutputPath.empty()) {
-    assert(context.OI.CompilerMode == OutputInfo::Mode::SingleCompile &&
+    assert((context.OI.CompilerMode == OutputInfo::Mode::SingleCompile ||
+            context.Args.hasArg(options::OPT_parallel_objc_header)) &&
            "The Swift tool should only emit an Obj-C header in single compile"
            "mode!");
 
     Arguments.push_back("-emit-objc-header-path");
     Arguments.push_back(ObjCHeaderOutputPath.c_str());
+    if (context.OI.CompilerMode != OutputInfo::Mode::SingleCompile)
+      Arguments.push_back("-emit-partial-objc-header");
   }
 
   const std::string &SerializedDiagnosticsPath =
@@ -338,6 +373,18 @@ ToolChain::constructInvocation(const CompileJobAction &job,
         context.Args.MakeArgString(Twine(context.OI.numThreads)));
   }
 
+  // Whole-module builds already code-generate every file on its own thread.
+  if (context.Args.hasArg(options::OPT_split_primary_file_codegen) &&
+      context.OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      context.OI.numThreads > 1 &&
+      context.Output.getPrimaryOutputType() == types::TY_Object) {
+    std::string Linker = getRelocatableLinkerPath();
+    if (!Linker.empty()) {
+      Arguments.push_back("-parallel-codegen-linker");
+      Arguments.push_back(context.Args.MakeArgString(Linker));
+    }
+  }
+
   // Add the output file argument if necessary.
   if (context.Output.getPrimaryOutputType() != types::TY_Nothing) {
     for (auto &FileName : context.Output.getPrimaryOutputFilenames()) {
@@ -349,6 +396,12 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   if (context.Args.hasArg(options::OPT_embed_bitcode_marker))
     Arguments.push_back("-embed-bitcode-marker");
 
+  for (const Job *PCH : context.Inputs) {
+    Arguments.push_back("-import-objc-header-pch");
+    Arguments.push_back(
+      PCH->getOutput().getPrimaryOutputFilename().c_str());
+  }
+
   auto program = SWIFT_EXECUTABLE_NAME;
   if (context.OI.CompilerMode == OutputInfo::Mode::UpdateCode)
     program = SWIFT_UPDATE_NAME;
@@ -441,6 +494,7 @@ ToolChain::constructInvocation(const BackendJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -567,6 +621,24 @@ ToolChain::constructInvocation(const MergeModuleJobAction &job,
   if (!ObjCHeaderOutputPath.empty()) {
     Arguments.push_back("-emit-objc-header-path");
     Arguments.push_back(ObjCHeaderOutputPath.c_str());
+
+    // Merge the parts of the header printed by the compile jobs, unless some
+    // of the input modules weren't compiled by this build.
+    bool haveAllPartialHeaders =
+      context.Args.hasArg(options::OPT_parallel_objc_header) &&
+      context.InputActions.empty() &&
+      std::all_of(context.Inputs.begin(), context.Inputs.end(),
+                  [](const Job *Cmd) {
+        return !Cmd->getOutput().getAnyOutputForType(types::TY_ObjCHeader)
+                  .empty();
+      });
+    if (haveAllPartialHeaders) {
+      for (const Job *Cmd : context.Inputs) {
+        Arguments.push_back("-merge-partial-objc-header");
+        Arguments.push_back(
+          Cmd->getOutput().getAnyOutputForType(types::TY_ObjCHeader).c_str());
+      }
+    }
   }
 
   Arguments.push_back("-o");
@@ -669,6 +741,34 @@ ToolChain::constructInvocation(const GenerateDSYMJobAction &job,
   return {"dsymutil", Arguments};
 }
 
+ToolChain::InvocationInfo
+ToolChain::constructInvocation(const GeneratePCHJobAction &job,
+                               const JobContext &context) const {
+  assert(context.Inputs.empty());
+  assert(context.InputActions.size() == 1);
+  assert(context.Output.getPrimaryOutputType() == types::TY_PCH);
+
+  ArgStringList Arguments;
+
+  Arguments.push_back("-frontend");
+  Arguments.push_back("-emit-pch");
+
+  cast<InputAction>(context.InputActions.front())->getInputArg().renderAsInput(
+    context.Args, Arguments);
+
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
+                        Arguments);
+
+  Arguments.push_back("-module-name");
+  Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
+
+  Arguments.push_back("-o");
+  Arguments.push_back(
+      context.Args.MakeArgString(context.Output.getPrimaryOutputFilename()));
+
+  return {SWIFT_EXECUTABLE_NAME, Arguments};
+}
+
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const AutolinkExtractJobAction &job,
                                const JobContext &context) const {
@@ -843,6 +943,11 @@ toolchains::Darwin::constructInvocation(const LinkJobAction &job,
     llvm_unreachable("invalid link kind");
   case LinkKind::Executable:
     // The default for ld; no extra flags necessary.
+    // With -whole-program the compiler has already removed the code which is
+    // unreachable from main; let ld drop what remains unreferenced. The Swift
+    // metadata sections are marked no_dead_strip, so they are kept.
+    if (context.OI.ShouldAssumeWholeProgram)
+      Arguments.push_back("-dead_strip");
     break;
   case LinkKind::DynamicLibrary:
     Arguments.push_back("-dylib");
@@ -23,6 +23,7 @@
 #include "llvm/Option/Option.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 
 using namespace swift;
 using namespace llvm::opt;
@@ -119,17 +120,38 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.EmitSortedSIL |= Args.hasArg(OPT_emit_sorted_sil);
 
   Opts.DelayedFunctionBodyParsing |= Args.hasArg(OPT_delayed_function_body_parsing);
+  Opts.DisableSecondaryBodySkipping |=
+    Args.hasArg(OPT_disable_secondary_body_skipping);
   Opts.EnableTesting |= Args.hasArg(OPT_enable_testing);
 
   Opts.PrintStats |= Args.hasArg(OPT_print_stats);
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
+  Opts.PrintASTMemoryStats |= Args.hasArg(OPT_print_ast_memory_stats);
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
 
+  if (const Arg *A = Args.getLastArg(OPT_type_check_report))
+    Opts.TypeCheckReportPath = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_trace_compile_time))
+    Opts.TraceCompileTimePath = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_progress_output))
+    Opts.ProgressOutputPath = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_immediate_object_cache_path))
+    Opts.ImmediateObjectCachePath = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_type_check_report_count)) {
+    if (StringRef(A->getValue()).getAsInteger(10, Opts.TypeCheckReportCount)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+  }
+
   Opts.PlaygroundTransform |= Args.hasArg(OPT_playground);
   if (Args.hasArg(OPT_disable_playground_transform))
     Opts.PlaygroundTransform = false;
   Opts.PlaygroundHighPerformance |=
     Args.hasArg(OPT_playground_high_performance);
+  Opts.PlaygroundBatchedLogging |=
+    Args.hasArg(OPT_playground_batched_logging);
 
   if (const Arg *A = Args.getLastArg(OPT_help, OPT_help_hidden)) {
     if (A->getOption().matches(OPT_help)) {
@@ -141,19 +163,35 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  std::vector<SelectedInput> PrimaryInputs;
   for (const Arg *A : make_range(Args.filtered_begin(OPT_INPUT,
                                                      OPT_primary_file),
                                  Args.filtered_end())) {
     if (A->getOption().matches(OPT_INPUT)) {
       Opts.InputFilenames.push_back(A->getValue());
     } else if (A->getOption().matches(OPT_primary_file)) {
-      Opts.PrimaryInput = SelectedInput(Opts.InputFilenames.size());
+      PrimaryInputs.push_back(SelectedInput(Opts.InputFilenames.size()));
       Opts.InputFilenames.push_back(A->getValue());
     } else {
       llvm_unreachable("Unknown input-related argument!");
     }
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_batch_output_file_map)) {
+    // In batch mode, start out with the first primary input; the rest are
+    // handled one after another once the whole batch has been type-checked.
+    Opts.BatchOutputFileMapPath = A->getValue();
+    Opts.BatchPrimaryInputs = PrimaryInputs;
+    if (!PrimaryInputs.empty())
+      Opts.PrimaryInput = PrimaryInputs.front();
+  } else if (PrimaryInputs.size() > 1) {
+    Diags.diagnose(SourceLoc(),
+                   diag::error_multiple_primary_files_without_batch_map);
+    return true;
+  } else if (!PrimaryInputs.empty()) {
+    Opts.PrimaryInput = PrimaryInputs.front();
+  }
+
   Opts.ParseStdlib |= Args.hasArg(OPT_parse_stdlib);
 
   // Determine what the user has asked the frontend to do.
@@ -186,6 +224,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Action = FrontendOptions::DumpTypeRefinementContexts;
     } else if (Opt.matches(OPT_dump_interface_hash)) {
       Action = FrontendOptions::DumpInterfaceHash;
+    } else if (Opt.matches(OPT_emit_pch)) {
+      Action = FrontendOptions::EmitPCH;
     } else if (Opt.matches(OPT_print_ast)) {
       Action = FrontendOptions::PrintAST;
     } else if (Opt.matches(OPT_repl) ||
@@ -380,6 +420,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Suffix = SERIALIZED_MODULE_EXTENSION;
       break;
 
+    case FrontendOptions::EmitPCH:
+      Suffix = PCH_EXTENSION;
+      break;
+
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       // These modes have no frontend-generated output.
@@ -519,6 +563,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     Opts.FixitsOutputPath = A->getValue();
   }
 
+  Opts.EmitPartialObjCHeader |= Args.hasArg(OPT_emit_partial_objc_header);
+  Opts.PartialObjCHeaderPaths =
+    Args.getAllArgValues(OPT_merge_partial_objc_header);
+
   bool IsSIB =
     Opts.RequestedAction == FrontendOptions::EmitSIB ||
     Opts.RequestedAction == FrontendOptions::EmitSIBGen;
@@ -547,6 +595,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_dependencies);
@@ -573,6 +622,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_header);
@@ -602,6 +652,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
     case FrontendOptions::EmitSILGen:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       if (!Opts.ModuleOutputPath.empty())
@@ -630,6 +681,17 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.EnableSourceImport |= Args.hasArg(OPT_enable_source_import);
   Opts.ImportUnderlyingModule |= Args.hasArg(OPT_import_underlying_module);
   Opts.SILSerializeAll |= Args.hasArg(OPT_sil_serialize_all);
+  Opts.ReleaseLookupCachesAfterSILGen |=
+    Args.hasArg(OPT_release_lookup_caches_after_silgen);
+  Opts.SILSerializeGenerics |= Args.hasArg(OPT_sil_serialize_generics);
+  if (const Arg *A = Args.getLastArg(OPT_sil_serialize_generics_limit)) {
+    if (StringRef(A->getValue()).getAsInteger(10,
+                                              Opts.SILSerializeGenericsLimit)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+  }
 
   if (const Arg *A = Args.getLastArg(OPT_import_objc_header)) {
     Opts.ImplicitObjCHeaderPath = A->getValue();
@@ -690,6 +752,8 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   }
   
   Opts.DebugConstraintSolver |= Args.hasArg(OPT_debug_constraints);
+  Opts.SolverRankDisjunctionChoices |=
+    Args.hasArg(OPT_solver_rank_disjunction_choices);
   Opts.IterativeTypeChecker |= Args.hasArg(OPT_iterative_type_checker);
   Opts.DebugGenericSignatures |= Args.hasArg(OPT_debug_generic_signatures);
 
@@ -728,6 +792,49 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
     Opts.DebugForbidTypecheckPrefix = A->getValue();
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_ast_verifier_process_count)) {
+    unsigned count;
+    if (StringRef(A->getValue()).getAsInteger(10, count) || count == 0) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+    Opts.ASTVerifierProcessCount = count;
+  }
+
+  if (const Arg *A = Args.getLastArg(OPT_ast_verifier_process_id)) {
+    unsigned id;
+    if (StringRef(A->getValue()).getAsInteger(10, id) ||
+        id >= Opts.ASTVerifierProcessCount) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+    Opts.ASTVerifierProcessId = id;
+  }
+
+  if (const Arg *A = Args.getLastArg(OPT_ast_verifier_sample_percent)) {
+    unsigned percent;
+    if (StringRef(A->getValue()).getAsInteger(10, percent) || percent > 100) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+    Opts.ASTVerifierSamplePercent = percent;
+
+    // Without an explicit seed, verify a different subset on every run.
+    Opts.ASTVerifierSampleSeed = llvm::sys::Process::GetRandomNumber();
+  }
+
+  if (const Arg *A = Args.getLastArg(OPT_ast_verifier_sample_seed)) {
+    if (StringRef(A->getValue()).getAsInteger(10,
+                                              Opts.ASTVerifierSampleSeed)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+  }
+
   if (const Arg *A = Args.getLastArg(OPT_solver_memory_threshold)) {
     unsigned threshold;
     if (StringRef(A->getValue()).getAsInteger(10, threshold)) {
@@ -813,6 +920,9 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
   Opts.UseSwiftLookupTables |= Args.hasArg(OPT_enable_swift_name_lookup_tables);
   Opts.DumpClangDiagnostics |= Args.hasArg(OPT_dump_clang_diagnostics);
 
+  if (const Arg *A = Args.getLastArg(OPT_import_objc_header_pch))
+    Opts.PrecompiledBridgingHeader = A->getValue();
+
   if (Args.hasArg(OPT_embed_bitcode))
     Opts.Mode = ClangImporterOptions::Modes::EmbedBitcode;
 
@@ -878,6 +988,8 @@ static bool ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
   Opts.SkipDiagnosticPasses |= Args.hasArg(OPT_disable_diagnostic_passes);
   Opts.ShowDiagnosticsAfterFatalError |=
     Args.hasArg(OPT_show_diagnostics_after_fatal);
+  Opts.SuppressDuplicateDiagnostics |=
+    Args.hasArg(OPT_suppress_duplicate_diagnostics);
   Opts.UseColor |= Args.hasArg(OPT_color_diagnostics);
   Opts.FixitCodeForAllDiagnostics |= Args.hasArg(OPT_fixit_all);
 
@@ -933,6 +1045,7 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
     else
       llvm_unreachable("Unknown SIL linking option!");
   }
+  Opts.LinkBodiesOnDemand |= Args.hasArg(OPT_sil_link_on_demand);
 
   // Parse the optimization level.
   if (const Arg *A = Args.getLastArg(OPT_O_Group)) {
@@ -946,6 +1059,16 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
       // Removal of cond_fail (overflow on binary operations).
       Opts.RemoveRuntimeAsserts = true;
       Opts.AssertConfig = SILOptions::Fast;
+    } else if (A->getOption().matches(OPT_Og)) {
+      // Run the cheap SIL optimizations that don't hurt debugging, but no
+      // LLVM optimizations.
+      IRGenOpts.Optimize = false;
+      Opts.Optimization = SILOptions::SILOptMode::Debug;
+    } else if (A->getOption().matches(OPT_Osize)) {
+      // Optimize, but don't trade code size for speed.
+      IRGenOpts.Optimize = true;
+      IRGenOpts.OptimizeForSize = true;
+      Opts.Optimization = SILOptions::SILOptMode::OptimizeForSize;
     } else if (A->getOption().matches(OPT_Oplayground)) {
       // For now -Oplayground is equivalent to -Onone.
       IRGenOpts.Optimize = false;
@@ -996,11 +1119,22 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
   Opts.PrintInstCounts |= Args.hasArg(OPT_print_inst_counts);
   if (const Arg *A = Args.getLastArg(OPT_external_pass_pipeline_filename))
     Opts.ExternalPassPipelineFilename = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_sil_pass_profile))
+    Opts.PassProfileFilename = A->getValue();
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
   Opts.EmitProfileCoverageMapping |= Args.hasArg(OPT_profile_coverage_mapping);
+  if (const Arg *A = Args.getLastArg(OPT_profile_use))
+    Opts.UseProfile = A->getValue();
+  Opts.ExportedSpecializations =
+    Args.getAllArgValues(OPT_export_specializations_of);
   Opts.UseNativeSuperMethod |=
     Args.hasArg(OPT_use_native_super_method);
+  Opts.EnableGuaranteedNormalArguments |=
+    Args.hasArg(OPT_enable_guaranteed_normal_arguments);
+  Opts.WholeProgram |= Args.hasArg(OPT_whole_program);
+  Opts.CollapseInlinedStdlibDebugScopes |=
+    Args.hasArg(OPT_collapse_inlined_stdlib_debug_scopes);
 
   return false;
 }
@@ -1099,6 +1233,8 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   if (Args.hasArg(OPT_autolink_force_load))
     Opts.ForceLoadSymbolName = Args.getLastArgValue(OPT_module_link_name);
 
+  Opts.ParallelCodeGenLinker = Args.getLastArgValue(OPT_parallel_codegen_linker);
+
   // TODO: investigate whether these should be removed, in favor of definitions
   // in other classes.
   if (FrontendOpts.PrimaryInput && FrontendOpts.PrimaryInput->isFilename()) {
@@ -1125,6 +1261,8 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   }
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
+  Opts.DisableProfileCounterPromotion |=
+    Args.hasArg(OPT_disable_profile_counter_promotion);
 
   if (Args.hasArg(OPT_embed_bitcode))
     Opts.EmbedMode = IRGenEmbedMode::EmbedBitcode;
@@ -1158,6 +1296,17 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   Opts.ForceResilientSuperDispatch |=
     Args.hasArg(OPT_force_resilient_super_dispatch);
 
+  Opts.EmitDynamicCastInlineCaches |=
+    Args.hasArg(OPT_enable_dynamic_cast_inline_caches);
+
+  Opts.DebugInfoExternalTypeDeclarations |=
+    Args.hasArg(OPT_debug_info_external_type_declarations);
+
+  Opts.EnableGenericWitnessTables |=
+    Args.hasArg(OPT_enable_generic_witness_tables);
+
+  Opts.EmitCodeSizeReport |= Args.hasArg(OPT_emit_code_size_report);
+
   return false;
 }
 
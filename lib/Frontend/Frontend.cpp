@@ -22,6 +22,8 @@
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/AST/Module.h"
+#include "swift/AST/TypeCheckTimingReport.h"
+#include "swift/Basic/CompileTimeTrace.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Parse/DelayedParsingCallbacks.h"
 #include "swift/Parse/Lexer.h"
@@ -45,15 +47,96 @@ void CompilerInstance::createSILModule(bool WholeModule) {
 void CompilerInstance::setPrimarySourceFile(SourceFile *SF) {
   assert(SF);
   assert(MainModule && "main module not created yet");
-  assert(!PrimarySourceFile && "already has a primary source file");
+  if (PrimarySourceFile) {
+    // In batch mode, every primary file gets its own name tracker.
+    assert(SF->getBufferID().hasValue() &&
+           isPrimaryBuffer(SF->getBufferID().getValue()) &&
+           "already has a primary source file");
+    BatchPrimarySourceFiles.push_back(SF);
+    if (NameTracker) {
+      BatchNameTrackers.emplace_back(new ReferencedNameTracker());
+      SF->setReferencedNameTracker(BatchNameTrackers.back().get());
+    }
+    return;
+  }
   assert(PrimaryBufferID == NO_SUCH_BUFFER || !SF->getBufferID().hasValue() ||
          SF->getBufferID().getValue() == PrimaryBufferID);
   PrimarySourceFile = SF;
   PrimarySourceFile->setReferencedNameTracker(NameTracker);
 }
 
+void CompilerInstance::addPrimaryBuffer(unsigned BufferID) {
+  if (PrimaryBufferID == NO_SUCH_BUFFER)
+    PrimaryBufferID = BufferID;
+  else
+    BatchPrimaryBufferIDs.push_back(BufferID);
+}
+
+bool CompilerInstance::isPrimaryBuffer(unsigned BufferID) const {
+  return BufferID == PrimaryBufferID ||
+         std::find(BatchPrimaryBufferIDs.begin(), BatchPrimaryBufferIDs.end(),
+                   BufferID) != BatchPrimaryBufferIDs.end();
+}
+
+bool CompilerInstance::isPrimarySourceFile(const SourceFile *SF) const {
+  return SF == PrimarySourceFile ||
+         std::find(BatchPrimarySourceFiles.begin(),
+                   BatchPrimarySourceFiles.end(),
+                   SF) != BatchPrimarySourceFiles.end();
+}
+
+SourceFile *CompilerInstance::getPrimarySourceFile(StringRef Filename) {
+  if (PrimarySourceFile && PrimarySourceFile->getFilename() == Filename)
+    return PrimarySourceFile;
+  for (SourceFile *SF : BatchPrimarySourceFiles)
+    if (SF->getFilename() == Filename)
+      return SF;
+  return nullptr;
+}
+
 bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   Invocation = Invok;
+  if (setupContext())
+    return true;
+  return setupInputBuffers();
+}
+
+bool CompilerInstance::setupForReuse(const CompilerInvocation &Invok,
+                                     ArrayRef<std::string> PreloadModules) {
+  Invocation = Invok;
+  if (setupContext())
+    return true;
+
+  if (!Invocation.getParseStdlib() &&
+      Invocation.getInputKind() != InputFileKind::IFK_SIL) {
+    ModuleDecl *M = Context->getStdlibModule(true);
+    if (!M || M->failedToLoad())
+      return true;
+  }
+
+  for (const std::string &Name : PreloadModules) {
+    std::pair<Identifier, SourceLoc> Path(Context->getIdentifier(Name),
+                                          SourceLoc());
+    if (!Context->getModule(Path))
+      return true;
+  }
+
+  return Diagnostics.hadAnyError();
+}
+
+bool CompilerInstance::setupInputs(const CompilerInvocation &Invok) {
+  assert(Context && !MainModule && BufferIDs.empty() && PartialModules.empty() &&
+         "instance must come straight from setupForReuse()");
+  // The ASTContext refers to the options of the invocation, which this
+  // updates in place.
+  Invocation = Invok;
+  if (!Invocation.getFrontendOptions().ModuleDocOutputPath.empty())
+    Invocation.getLangOptions().AttachCommentsToDecls = true;
+  return setupInputBuffers();
+}
+
+bool CompilerInstance::setupContext() {
+  const CompilerInvocation &Invok = Invocation;
 
   // Honor -Xllvm.
   if (!Invok.getFrontendOptions().LLVMArgs.empty()) {
@@ -69,6 +152,9 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   if (Invocation.getDiagnosticOptions().ShowDiagnosticsAfterFatalError) {
     Diagnostics.setShowDiagnosticsAfterFatalError();
   }
+  if (Invocation.getDiagnosticOptions().SuppressDuplicateDiagnostics) {
+    Diagnostics.setSuppressDuplicateDiagnostics();
+  }
 
   // If we are asked to emit a module documentation file, configure lexing and
   // parsing to remember comments.
@@ -79,6 +165,11 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
                                Invocation.getSearchPathOptions(),
                                SourceMgr, Diagnostics));
 
+  if (!Invocation.getFrontendOptions().TypeCheckReportPath.empty()) {
+    Context->TypeCheckTimings.reset(new TypeCheckTimingReport(
+        Invocation.getFrontendOptions().TypeCheckReportCount));
+  }
+
   if (Invocation.getFrontendOptions().EnableSourceImport) {
     bool immediate = Invocation.getFrontendOptions().actionIsImmediate();
     Context->addModuleLoader(SourceLoader::create(*Context, !immediate,
@@ -103,7 +194,10 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   Context->addModuleLoader(std::move(clangImporter), /*isClang*/true);
 
   assert(Lexer::isIdentifier(Invocation.getModuleName()));
+  return false;
+}
 
+bool CompilerInstance::setupInputBuffers() {
   Optional<unsigned> CodeCompletionBufferID;
   auto CodeCompletePoint = Invocation.getCodeCompletionPoint();
   if (CodeCompletePoint.first) {
@@ -121,8 +215,16 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   if (SILMode)
     Invocation.getLangOptions().EnableAccessControl = false;
 
-  const Optional<SelectedInput> &PrimaryInput =
-    Invocation.getFrontendOptions().PrimaryInput;
+  const FrontendOptions &FrontendOpts = Invocation.getFrontendOptions();
+  auto isPrimaryInput = [&FrontendOpts](unsigned Index, bool IsBuffer) {
+    auto matches = [=](const SelectedInput &Input) {
+      return Input.Index == Index && Input.isBuffer() == IsBuffer;
+    };
+    if (!FrontendOpts.BatchPrimaryInputs.empty())
+      return std::any_of(FrontendOpts.BatchPrimaryInputs.begin(),
+                         FrontendOpts.BatchPrimaryInputs.end(), matches);
+    return FrontendOpts.PrimaryInput && matches(*FrontendOpts.PrimaryInput);
+  };
 
   // Add the memory buffers first, these will be associated with a filename
   // and they can replace the contents of an input filename.
@@ -141,8 +243,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (SILMode)
         MainBufferID = BufferID;
 
-      if (PrimaryInput && PrimaryInput->isBuffer() && PrimaryInput->Index == i)
-        PrimaryBufferID = BufferID;
+      if (isPrimaryInput(i, /*IsBuffer=*/true))
+        addPrimaryBuffer(BufferID);
     }
   }
 
@@ -157,9 +259,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (SILMode || (MainMode && filename(File) == "main.swift"))
         MainBufferID = ExistingBufferID.getValue();
 
-      if (PrimaryInput && PrimaryInput->isFilename() &&
-          PrimaryInput->Index == i)
-        PrimaryBufferID = ExistingBufferID.getValue();
+      if (isPrimaryInput(i, /*IsBuffer=*/false))
+        addPrimaryBuffer(ExistingBufferID.getValue());
 
       continue; // replaced by a memory buffer.
     }
@@ -200,8 +301,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
     if (SILMode || (MainMode && filename(File) == "main.swift"))
       MainBufferID = BufferID;
 
-    if (PrimaryInput && PrimaryInput->isFilename() && PrimaryInput->Index == i)
-      PrimaryBufferID = BufferID;
+    if (isPrimaryInput(i, /*IsBuffer=*/false))
+      addPrimaryBuffer(BufferID);
   }
 
   // Set the primary file to the code-completion point if one exists.
@@ -355,6 +456,13 @@ void CompilerInstance::performSema() {
     DelayedCB.reset(new AlwaysDelayedCallbacks);
   }
 
+  // Function bodies in secondary files are never type-checked or emitted by
+  // this job, so only their declarations need to be parsed.
+  SkipNonTransparentFunctions SecondaryCB;
+  bool SkipSecondaryBodies =
+    !DelayedCB && PrimaryBufferID != NO_SUCH_BUFFER &&
+    !Invocation.getFrontendOptions().DisableSecondaryBodySkipping;
+
   PersistentParserState PersistentState;
 
   // Make sure the main file is the first file in the module. This may only be
@@ -373,7 +481,7 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*MainFile);
     addAdditionalInitialImports(MainFile);
 
-    if (MainBufferID == PrimaryBufferID)
+    if (isPrimaryBuffer(MainBufferID))
       setPrimarySourceFile(MainFile);
   }
 
@@ -399,17 +507,28 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*NextInput);
     addAdditionalInitialImports(NextInput);
 
-    if (BufferID == PrimaryBufferID)
+    DelayedParsingCallbacks *NextCB = DelayedCB.get();
+    if (isPrimaryBuffer(BufferID)) {
       setPrimarySourceFile(NextInput);
+      if (!DelayedCB && PrimaryDelayedParseCB)
+        NextCB = PrimaryDelayedParseCB;
+    } else if (SkipSecondaryBodies)
+      NextCB = &SecondaryCB;
 
+    CompileTimeTraceScope traceScope("parse",
+                                     SourceMgr.getIdentifierForBuffer(BufferID));
     bool Done;
     do {
       // Parser may stop at some erroneous constructions like #else, #endif
       // or '}' in some cases, continue parsing until we are done
       parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, NextCB);
     } while (!Done);
 
+    // Transparent bodies were only delayed; parse them now.
+    if (NextCB == &SecondaryCB)
+      performDelayedParsing(NextInput, PersistentState, nullptr);
+
     performNameBinding(*NextInput);
   }
 
@@ -435,15 +554,22 @@ void CompilerInstance::performSema() {
   if (Invocation.getFrontendOptions().actionIsImmediate()) {
     TypeCheckOptions |= TypeCheckingFlags::ForImmediateMode;
   }
+  if (!Invocation.getFrontendOptions().actionRunsSILGen()) {
+    TypeCheckOptions |= TypeCheckingFlags::NoSILGeneration;
+  }
 
   // Parse the main file last.
   if (MainBufferID != NO_SUCH_BUFFER) {
     bool mainIsPrimary =
-      (PrimaryBufferID == NO_SUCH_BUFFER || MainBufferID == PrimaryBufferID);
+      (PrimaryBufferID == NO_SUCH_BUFFER || isPrimaryBuffer(MainBufferID));
 
     SourceFile &MainFile =
       MainModule->getMainSourceFile(Invocation.getSourceFileKind());
+    DelayedParsingCallbacks *MainCB = DelayedCB.get();
+    if (!DelayedCB && PrimaryDelayedParseCB && isPrimaryBuffer(MainBufferID))
+      MainCB = PrimaryDelayedParseCB;
     SILParserState SILContext(TheSILModule.get());
+    CompileTimeTraceScope traceScope("parse", MainFile.getFilename());
     unsigned CurTUElem = 0;
     bool Done;
     do {
@@ -453,7 +579,7 @@ void CompilerInstance::performSema() {
       // with 'sil' definitions.
       parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
                           TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, MainCB);
       if (mainIsPrimary) {
         performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, CurTUElem);
@@ -463,7 +589,9 @@ void CompilerInstance::performSema() {
     
     if (mainIsPrimary && !Context->hadError() &&
         Invocation.getFrontendOptions().PlaygroundTransform)
-      performPlaygroundTransform(MainFile, Invocation.getFrontendOptions().PlaygroundHighPerformance);
+      performPlaygroundTransform(
+        MainFile, Invocation.getFrontendOptions().PlaygroundHighPerformance,
+        Invocation.getFrontendOptions().PlaygroundBatchedLogging);
     if (!mainIsPrimary)
       performNameBinding(MainFile);
   }
@@ -471,9 +599,11 @@ void CompilerInstance::performSema() {
   // Type-check each top-level input besides the main source file.
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (PrimaryBufferID == NO_SUCH_BUFFER || isPrimarySourceFile(SF)) {
+        CompileTimeTraceScope traceScope("typecheck", SF->getFilename());
         performTypeChecking(*SF, PersistentState.getTopLevelContext(),
                             TypeCheckOptions);
+      }
 
   // Even if there were no source files, we should still record known
   // protocols.
@@ -488,8 +618,10 @@ void CompilerInstance::performSema() {
   // Perform whole-module type checking.
   if (TypeCheckOptions & TypeCheckingFlags::DelayWholeModuleChecking) {
     for (auto File : MainModule->getFiles())
-      if (auto SF = dyn_cast<SourceFile>(File))
+      if (auto SF = dyn_cast<SourceFile>(File)) {
+        CompileTimeTraceScope traceScope("typecheck", SF->getFilename());
         performWholeModuleTypeChecking(*SF);
+      }
   }
 }
 
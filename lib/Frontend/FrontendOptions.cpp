@@ -31,6 +31,7 @@ bool FrontendOptions::actionHasOutput() const {
   case EmitSIBGen:
   case EmitSIB:
   case EmitModuleOnly:
+  case EmitPCH:
     return true;
   case Immediate:
   case REPL:
@@ -58,6 +59,7 @@ bool FrontendOptions::actionIsImmediate() const {
   case EmitSIBGen:
   case EmitSIB:
   case EmitModuleOnly:
+  case EmitPCH:
     return false;
   case Immediate:
   case REPL:
@@ -71,6 +73,36 @@ bool FrontendOptions::actionIsImmediate() const {
   llvm_unreachable("Unknown ActionType");
 }
 
+bool FrontendOptions::actionRunsSILGen() const {
+  switch (RequestedAction) {
+  case Parse:
+    // Printing an Objective-C header or serializing a module needs the
+    // members of the types involved to be validated.
+    return !ObjCHeaderOutputPath.empty() || !ModuleOutputPath.empty();
+  case DumpParse:
+  case DumpAST:
+  case DumpInterfaceHash:
+  case PrintAST:
+  case DumpTypeRefinementContexts:
+  case EmitPCH:
+    return false;
+  case NoneAction:
+  case EmitSILGen:
+  case EmitSIL:
+  case EmitSIBGen:
+  case EmitSIB:
+  case EmitModuleOnly:
+  case Immediate:
+  case REPL:
+  case EmitAssembly:
+  case EmitIR:
+  case EmitBC:
+  case EmitObject:
+    return true;
+  }
+  llvm_unreachable("Unknown ActionType");
+}
+
 void FrontendOptions::forAllOutputPaths(
     std::function<void(const std::string &)> fn) const {
   if (RequestedAction != FrontendOptions::EmitModuleOnly) {
@@ -22,6 +22,8 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallString.h"
@@ -29,6 +31,7 @@
 
 // For constant values only.
 #include "clang/Frontend/SerializedDiagnosticPrinter.h"
+#include "clang/Frontend/SerializedDiagnosticReader.h"
 
 using namespace swift;
 
@@ -105,14 +108,18 @@ struct SharedState : llvm::RefCountedBase<SharedState> {
   /// \brief A text buffer for rendering diagnostic text.
   llvm::SmallString<256> diagBuf;
 
-  /// \brief The collection of files used.
-  llvm::DenseMap<const char *, unsigned> Files;
+  /// \brief The collection of files used, by name.
+  llvm::StringMap<unsigned> Files;
 
-  typedef llvm::DenseMap<const void *, std::pair<unsigned, StringRef> >
-  DiagFlagsTy;
+  /// \brief The file record of each source buffer seen so far, so that the
+  /// name of a buffer is only looked up once.
+  llvm::DenseMap<unsigned, unsigned> BufferFiles;
 
-  /// \brief Map for uniquing strings.
-  DiagFlagsTy DiagFlags;
+  /// \brief The collection of categories used, by name.
+  llvm::StringMap<unsigned> Categories;
+
+  /// \brief The collection of diagnostic flags used, by name.
+  llvm::StringMap<unsigned> DiagFlags;
 
   /// \brief Whether we have already started emission of any DIAG blocks. Once
   /// this becomes \c true, we never close a DIAG block until we know that we're
@@ -120,10 +127,17 @@ struct SharedState : llvm::RefCountedBase<SharedState> {
   bool EmittedAnyDiagBlocks;
 };
 
+class DiagnosticFileMerger;
+
 /// \brief Diagnostic consumer that serializes diagnostics to a stream.
 class SerializedDiagnosticConsumer : public DiagnosticConsumer {
+  friend class DiagnosticFileMerger;
+
   /// \brief State shared among the various clones of this diagnostic consumer.
   llvm::IntrusiveRefCntPtr<SharedState> State;
+
+  /// \brief How much serialized content to collect before writing it out.
+  enum { FlushThreshold = 64 * 1024 };
 public:
   SerializedDiagnosticConsumer(std::unique_ptr<raw_ostream> OS)
       : State(new SharedState(std::move(OS))) {
@@ -142,8 +156,8 @@ public:
     if (State->EmittedAnyDiagBlocks)
       exitDiagBlock();
 
-    // Write the generated bitstream to "Out".
-    State->OS->write((char *)&State->Buffer.front(), State->Buffer.size());
+    // Write the rest of the generated bitstream to "Out".
+    State->OS->write(State->Buffer.data(), State->Buffer.size());
     State->OS->flush();
     State->OS.reset(0);
   }
@@ -175,17 +189,40 @@ private:
     State->Stream.ExitBlock();
   }
 
+  /// \brief Write out the bitstream serialized so far, once there is enough
+  /// of it.
+  ///
+  /// Must only be called between top-level blocks, because the sizes of
+  /// blocks that are still open get patched into the buffer when they close.
+  void flushBuffer() {
+    if (State->Buffer.size() < FlushThreshold)
+      return;
+    State->OS->write(State->Buffer.data(), State->Buffer.size());
+    State->Buffer.clear();
+  }
+
   // Record identifier for the file.
   unsigned getEmitFile(StringRef Filename);
 
+  // Record identifier for the file of a source buffer.
+  unsigned getEmitFile(SourceManager &SM, unsigned BufferID);
+
+  // Record identifier for a category.
+  unsigned getEmitCategory(StringRef Name);
+
+  // Record identifier for a diagnostic flag.
+  unsigned getEmitDiagFlag(StringRef Name);
+
   /// \brief Add a source location to a record.
+  ///
+  /// \param BufferID the buffer that \p Loc most likely belongs to.
   void addLocToRecord(SourceLoc Loc,
                       SourceManager &SM,
-                      StringRef Filename,
+                      unsigned BufferID,
                       RecordDataImpl &Record);
 
   void addRangeToRecord(CharSourceRange Range, SourceManager &SM,
-                        StringRef Filename, RecordDataImpl &Record);
+                        unsigned BufferID, RecordDataImpl &Record);
 
   /// \brief Emit the message payload of a diagnostic to bitcode.
   void emitDiagnosticMessage(SourceManager &SM, SourceLoc Loc,
@@ -201,17 +238,14 @@ namespace swift { namespace serialized_diagnostics {
 }}
 
 unsigned SerializedDiagnosticConsumer::getEmitFile(StringRef Filename) {
-  // NOTE: Using Filename.data() here relies on SourceMgr using
-  // const char* as buffer identifiers.  This is fast, but may
-  // be brittle.  We can always switch over to using a StringMap.
-  unsigned &entry = State->Files[Filename.data()];
-  if (entry)
+  auto insertion = State->Files.insert({Filename, State->Files.size() + 1});
+  unsigned entry = insertion.first->second;
+  if (!insertion.second)
     return entry;
 
   // Lazily generate the record for the file.  Note that in
   // practice we only expect there to be one file, but this is
   // general and is what the diagnostic file expects.
-  entry = State->Files.size();
   RecordData Record;
   Record.push_back(RECORD_FILENAME);
   Record.push_back(entry);
@@ -224,9 +258,49 @@ unsigned SerializedDiagnosticConsumer::getEmitFile(StringRef Filename) {
   return entry;
 }
 
+unsigned SerializedDiagnosticConsumer::getEmitFile(SourceManager &SM,
+                                                   unsigned BufferID) {
+  unsigned &entry = State->BufferFiles[BufferID];
+  if (!entry)
+    entry = getEmitFile(SM.getIdentifierForBuffer(BufferID));
+  return entry;
+}
+
+unsigned SerializedDiagnosticConsumer::getEmitCategory(StringRef Name) {
+  auto insertion = State->Categories.insert({Name,
+                                             State->Categories.size() + 1});
+  unsigned entry = insertion.first->second;
+  if (!insertion.second)
+    return entry;
+
+  RecordData Record;
+  Record.push_back(RECORD_CATEGORY);
+  Record.push_back(entry);
+  Record.push_back(Name.size());
+  State->Stream.EmitRecordWithBlob(State->Abbrevs.get(RECORD_CATEGORY),
+                                   Record, Name);
+  return entry;
+}
+
+unsigned SerializedDiagnosticConsumer::getEmitDiagFlag(StringRef Name) {
+  auto insertion = State->DiagFlags.insert({Name,
+                                            State->DiagFlags.size() + 1});
+  unsigned entry = insertion.first->second;
+  if (!insertion.second)
+    return entry;
+
+  RecordData Record;
+  Record.push_back(RECORD_DIAG_FLAG);
+  Record.push_back(entry);
+  Record.push_back(Name.size());
+  State->Stream.EmitRecordWithBlob(State->Abbrevs.get(RECORD_DIAG_FLAG),
+                                   Record, Name);
+  return entry;
+}
+
 void SerializedDiagnosticConsumer::addLocToRecord(SourceLoc Loc,
                                                   SourceManager &SM,
-                                                  StringRef Filename,
+                                                  unsigned BufferID,
                                                   RecordDataImpl &Record) {
   if (!Loc.isValid()) {
     // Emit a "sentinel" location.
@@ -237,10 +311,15 @@ void SerializedDiagnosticConsumer::addLocToRecord(SourceLoc Loc,
     return;
   }
 
+  // Ranges and fix-its are almost always in the buffer of the diagnostic
+  // itself, so only search the other buffers when they aren't.
+  if (!SM.getRangeForBuffer(BufferID).contains(Loc))
+    BufferID = SM.findBufferContainingLoc(Loc);
+
   unsigned line, col;
-  std::tie(line, col) = SM.getLineAndColumn(Loc);
+  std::tie(line, col) = SM.getLineAndColumn(Loc, BufferID);
 
-  Record.push_back(getEmitFile(Filename));
+  Record.push_back(getEmitFile(SM, BufferID));
   Record.push_back(line);
   Record.push_back(col);
   Record.push_back(0);
@@ -248,11 +327,11 @@ void SerializedDiagnosticConsumer::addLocToRecord(SourceLoc Loc,
 
 void SerializedDiagnosticConsumer::addRangeToRecord(CharSourceRange Range,
                                                     SourceManager &SM,
-                                                    StringRef Filename,
+                                                    unsigned BufferID,
                                                     RecordDataImpl &Record) {
   assert(Range.isValid());
-  addLocToRecord(Range.getStart(), SM, Filename, Record);
-  addLocToRecord(Range.getEnd(), SM, Filename, Record);
+  addLocToRecord(Range.getStart(), SM, BufferID, Record);
+  addLocToRecord(Range.getEnd(), SM, BufferID, Record);
 }
 
 /// \brief Map a Swift DiagosticKind to the diagnostic level expected
@@ -441,15 +520,15 @@ emitDiagnosticMessage(SourceManager &SM,
   RecordData &Record = State->Record;
   AbbreviationMap &Abbrevs = State->Abbrevs;
 
-  StringRef filename = "";
+  unsigned bufferID = 0;
   if (Loc.isValid())
-    filename = SM.getIdentifierForBuffer(SM.findBufferContainingLoc(Loc));
+    bufferID = SM.findBufferContainingLoc(Loc);
 
   // Emit the RECORD_DIAG record.
   Record.clear();
   Record.push_back(RECORD_DIAG);
   Record.push_back(getDiagnosticLevel(Kind));
-  addLocToRecord(Loc, SM, filename, Record);
+  addLocToRecord(Loc, SM, bufferID, Record);
 
   // FIXME: Swift diagnostics currently have no category.
   Record.push_back(0);
@@ -471,7 +550,7 @@ emitDiagnosticMessage(SourceManager &SM,
       continue;
     State->Record.clear();
     State->Record.push_back(RECORD_SOURCE_RANGE);
-    addRangeToRecord(R, SM, filename, State->Record);
+    addRangeToRecord(R, SM, bufferID, State->Record);
     State->Stream.EmitRecordWithAbbrev(RangeAbbrev, State->Record);
   }
 
@@ -481,7 +560,7 @@ emitDiagnosticMessage(SourceManager &SM,
     if (F.getRange().isValid()) {
       State->Record.clear();
       State->Record.push_back(RECORD_FIXIT);
-      addRangeToRecord(F.getRange(), SM, filename, State->Record);
+      addRangeToRecord(F.getRange(), SM, bufferID, State->Record);
       State->Record.push_back(F.getText().size());
       Stream.EmitRecordWithBlob(FixItAbbrev, Record, F.getText());
     }
@@ -498,8 +577,10 @@ SerializedDiagnosticConsumer::handleDiagnostic(SourceManager &SM,
   // than waiting for beginDiagnostic, in case associated notes
   // are emitted before we get there.
   if (Kind != DiagnosticKind::Note) {
-    if (State->EmittedAnyDiagBlocks)
+    if (State->EmittedAnyDiagBlocks) {
       exitDiagBlock();
+      flushBuffer();
+    }
 
     enterDiagBlock();
     State->EmittedAnyDiagBlocks = true;
@@ -518,3 +599,144 @@ SerializedDiagnosticConsumer::handleDiagnostic(SourceManager &SM,
     exitDiagBlock();
 }
 
+
+//===----------------------------------------------------------------------===//
+// Merging serialized diagnostics files.
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// \brief Copies the diagnostics of serialized diagnostics files into the
+/// output of a SerializedDiagnosticConsumer, renumbering the file, category,
+/// and flag records of each input to those of the output.
+class DiagnosticFileMerger
+    : public clang::serialized_diags::SerializedDiagnosticReader {
+  using Location = clang::serialized_diags::Location;
+
+  SerializedDiagnosticConsumer &Writer;
+
+  /// \brief Maps the record IDs of the file being read to those of the output.
+  llvm::DenseMap<unsigned, unsigned> FileIDs, CategoryIDs, FlagIDs;
+
+  /// \brief The number of diagnostic blocks currently open in the output.
+  unsigned Depth = 0;
+
+  void addLocToRecord(const Location &Loc, RecordDataImpl &Record) {
+    Record.push_back(FileIDs.lookup(Loc.FileID));
+    Record.push_back(Loc.Line);
+    Record.push_back(Loc.Col);
+    Record.push_back(Loc.Offset);
+  }
+
+public:
+  explicit DiagnosticFileMerger(SerializedDiagnosticConsumer &Writer)
+    : Writer(Writer) {}
+
+  /// \brief Append the diagnostics of the file at \p Path.
+  std::error_code merge(StringRef Path) {
+    FileIDs.clear();
+    CategoryIDs.clear();
+    FlagIDs.clear();
+    std::error_code EC = readDiagnostics(Path);
+
+    // Don't leave a truncated input's blocks open.
+    for (; Depth != 0; --Depth)
+      Writer.exitDiagBlock();
+    return EC;
+  }
+
+protected:
+  std::error_code visitStartOfDiagnostic() override {
+    Writer.enterDiagBlock();
+    ++Depth;
+    return std::error_code();
+  }
+
+  std::error_code visitEndOfDiagnostic() override {
+    Writer.exitDiagBlock();
+    if (--Depth == 0)
+      Writer.flushBuffer();
+    return std::error_code();
+  }
+
+  std::error_code visitCategoryRecord(unsigned ID, StringRef Name) override {
+    CategoryIDs[ID] = Writer.getEmitCategory(Name);
+    return std::error_code();
+  }
+
+  std::error_code visitDiagFlagRecord(unsigned ID, StringRef Name) override {
+    FlagIDs[ID] = Writer.getEmitDiagFlag(Name);
+    return std::error_code();
+  }
+
+  std::error_code visitFilenameRecord(unsigned ID, unsigned Size,
+                                      unsigned Timestamp,
+                                      StringRef Name) override {
+    FileIDs[ID] = Writer.getEmitFile(Name);
+    return std::error_code();
+  }
+
+  std::error_code visitDiagnosticRecord(unsigned Severity,
+                                        const Location &Loc,
+                                        unsigned Category, unsigned Flag,
+                                        StringRef Message) override {
+    RecordData &Record = Writer.State->Record;
+    Record.clear();
+    Record.push_back(RECORD_DIAG);
+    Record.push_back(Severity);
+    addLocToRecord(Loc, Record);
+    Record.push_back(CategoryIDs.lookup(Category));
+    Record.push_back(FlagIDs.lookup(Flag));
+    Record.push_back(Message.size());
+    Writer.State->Stream.EmitRecordWithBlob(
+        Writer.State->Abbrevs.get(RECORD_DIAG), Record, Message);
+    return std::error_code();
+  }
+
+  std::error_code visitSourceRangeRecord(const Location &Start,
+                                         const Location &End) override {
+    RecordData &Record = Writer.State->Record;
+    Record.clear();
+    Record.push_back(RECORD_SOURCE_RANGE);
+    addLocToRecord(Start, Record);
+    addLocToRecord(End, Record);
+    Writer.State->Stream.EmitRecordWithAbbrev(
+        Writer.State->Abbrevs.get(RECORD_SOURCE_RANGE), Record);
+    return std::error_code();
+  }
+
+  std::error_code visitFixitRecord(const Location &Start, const Location &End,
+                                   StringRef Text) override {
+    RecordData &Record = Writer.State->Record;
+    Record.clear();
+    Record.push_back(RECORD_FIXIT);
+    addLocToRecord(Start, Record);
+    addLocToRecord(End, Record);
+    Record.push_back(Text.size());
+    Writer.State->Stream.EmitRecordWithBlob(
+        Writer.State->Abbrevs.get(RECORD_FIXIT), Record, Text);
+    return std::error_code();
+  }
+};
+} // end anonymous namespace
+
+bool swift::serialized_diagnostics::mergeFiles(ArrayRef<std::string> Inputs,
+                                               StringRef OutputPath,
+                                               std::string &Error) {
+  std::error_code EC;
+  std::unique_ptr<llvm::raw_fd_ostream> OS(
+      new llvm::raw_fd_ostream(OutputPath, EC, llvm::sys::fs::F_None));
+  if (EC) {
+    Error = EC.message();
+    return true;
+  }
+
+  SerializedDiagnosticConsumer Writer(std::move(OS));
+  DiagnosticFileMerger Merger(Writer);
+  for (const std::string &Input : Inputs) {
+    if ((EC = Merger.merge(Input))) {
+      Error = Input + ": " + EC.message();
+      return true;
+    }
+  }
+  return false;
+}
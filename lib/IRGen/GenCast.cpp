@@ -376,6 +376,119 @@ static llvm::Function *emitExistentialScalarCastFn(IRGenModule &IGM,
   return fn;
 }
 
+/// Emit a lookup of the witness table for the conformance of a class
+/// instance to the single protocol of \p existentialType, going through a
+/// cache of the last conformance found at this cast site.
+///
+/// Hits compare a single type pointer and don't call into the runtime.
+/// Misses call swift_lookupExistentialConformances and update the cache.
+/// The cached entries are owned by the runtime and never change, so the
+/// cache only has to publish the pointer to one.
+static void emitCachedExistentialCast(IRGenFunction &IGF,
+                                      llvm::Value *value,
+                                      llvm::Value *metadataValue,
+                                      CanType existentialType,
+                                      CheckedCastMode mode,
+                                      llvm::Value *&resultValue,
+                                      llvm::Value *&witnessTable) {
+  auto &IGM = IGF.IGM;
+  auto null = llvm::ConstantPointerNull::get(IGM.Int8PtrPtrTy);
+  auto cache = new llvm::GlobalVariable(IGM.Module, IGM.Int8PtrPtrTy,
+                                        /*constant*/ false,
+                                        llvm::GlobalValue::PrivateLinkage,
+                                        null, "dynamic_cast_cache");
+  cache->setAlignment(IGM.getPointerAlignment().getValue());
+  Address cacheAddr(cache, IGM.getPointerAlignment());
+
+  auto checkBB = IGF.createBasicBlock("cache_check");
+  auto hitBB = IGF.createBasicBlock("cache_hit");
+  auto missBB = IGF.createBasicBlock("cache_miss");
+  auto fillBB = IGF.createBasicBlock("cache_fill");
+  auto successBB = IGF.createBasicBlock("success");
+  auto failBB = IGF.createBasicBlock("fail");
+
+  auto cached = IGF.Builder.CreateLoad(cacheAddr);
+  cached->setAtomic(llvm::AtomicOrdering::Acquire, llvm::CrossThread);
+  IGF.Builder.CreateCondBr(IGF.Builder.CreateICmpEQ(cached, null),
+                           missBB, checkBB);
+
+  // The first word of the entry is the type it is for.
+  IGF.Builder.emitBlock(checkBB);
+  auto cachedType =
+    IGF.Builder.CreateLoad(Address(cached, IGM.getPointerAlignment()));
+  auto type = IGF.Builder.CreateBitCast(metadataValue, IGM.Int8PtrTy);
+  IGF.Builder.CreateCondBr(IGF.Builder.CreateICmpEQ(cachedType, type),
+                           hitBB, missBB);
+
+  IGF.Builder.emitBlock(hitBB);
+  IGF.Builder.CreateBr(successBB);
+
+  IGF.Builder.emitBlock(missBB);
+  auto existentialMetadata = IGF.emitTypeMetadataRef(existentialType);
+  auto found =
+    IGF.Builder.CreateCall(IGM.getLookupExistentialConformancesFn(),
+                           {metadataValue, existentialMetadata});
+  found->setDoesNotThrow();
+  IGF.Builder.CreateCondBr(IGF.Builder.CreateICmpEQ(found, null),
+                           failBB, fillBB);
+
+  IGF.Builder.emitBlock(fillBB);
+  auto store = IGF.Builder.CreateStore(found, cacheAddr);
+  store->setAtomic(llvm::AtomicOrdering::Release, llvm::CrossThread);
+  IGF.Builder.CreateBr(successBB);
+
+  // If we failed, return nil or trap.
+  llvm::BasicBlock *contBB = nullptr;
+  IGF.Builder.emitBlock(failBB);
+  switch (mode) {
+  case CheckedCastMode::Conditional:
+    contBB = IGF.createBasicBlock("cont");
+    IGF.Builder.CreateBr(contBB);
+    break;
+
+  case CheckedCastMode::Unconditional: {
+    llvm::Function *trapIntrinsic = llvm::Intrinsic::getDeclaration(&IGM.Module,
+                                                    llvm::Intrinsic::ID::trap);
+    IGF.Builder.CreateCall(trapIntrinsic, {});
+    IGF.Builder.CreateUnreachable();
+    break;
+  }
+  }
+
+  // The witness table follows the type in the entry.
+  IGF.Builder.emitBlock(successBB);
+  auto entry = IGF.Builder.CreatePHI(IGM.Int8PtrPtrTy, 2);
+  entry->addIncoming(cached, hitBB);
+  entry->addIncoming(found, fillBB);
+  Address witnessTableAddr =
+    IGF.Builder.CreateConstArrayGEP(Address(entry, IGM.getPointerAlignment()),
+                                    1, IGM.getPointerSize());
+  llvm::Value *successWitnessTable = IGF.Builder.CreateLoad(witnessTableAddr);
+  successWitnessTable =
+    IGF.Builder.CreateBitCast(successWitnessTable, IGM.WitnessTablePtrTy);
+
+  if (!contBB) {
+    resultValue = value;
+    witnessTable = successWitnessTable;
+    return;
+  }
+
+  // Join the failure path, which produces null.
+  auto successEndBB = IGF.Builder.GetInsertBlock();
+  IGF.Builder.CreateBr(contBB);
+  IGF.Builder.emitBlock(contBB);
+  auto valuePhi = IGF.Builder.CreatePHI(value->getType(), 2);
+  valuePhi->addIncoming(value, successEndBB);
+  valuePhi->addIncoming(llvm::Constant::getNullValue(value->getType()),
+                        failBB);
+  auto witnessTablePhi = IGF.Builder.CreatePHI(IGM.WitnessTablePtrTy, 2);
+  witnessTablePhi->addIncoming(successWitnessTable, successEndBB);
+  witnessTablePhi->addIncoming(
+                 llvm::ConstantPointerNull::get(IGM.WitnessTablePtrTy), failBB);
+  resultValue = valuePhi;
+  witnessTable = witnessTablePhi;
+}
+
 void irgen::emitMetatypeToObjectDowncast(IRGenFunction &IGF,
                                          llvm::Value *metatypeValue,
                                          CanAnyMetatypeType type,
@@ -630,6 +743,22 @@ void irgen::emitScalarExistentialDowncast(IRGenFunction &IGF,
     metadataValue = emitDynamicTypeOfHeapObject(IGF, value, srcType);
   }
 
+  // Casts of class instances to a single Swift protocol can go through an
+  // inline cache instead.
+  if (IGF.IGM.Opts.EmitDynamicCastInlineCaches && !metatypeKind &&
+      allProtos.size() == 1 && witnessTableProtos.size() == 1) {
+    assert(objcProtos.empty() && !checkClassConstraint);
+    if (resultValue->getType() != resultType)
+      resultValue = IGF.Builder.CreateBitCast(resultValue, resultType);
+    llvm::Value *witnessTable;
+    emitCachedExistentialCast(IGF, resultValue, metadataValue,
+                              destType.getSwiftRValueType(), mode,
+                              resultValue, witnessTable);
+    ex.add(resultValue);
+    ex.add(witnessTable);
+    return;
+  }
+
   // Look up witness tables for the protocols that need them.
   auto fn = emitExistentialScalarCastFn(IGF.IGM, witnessTableProtos.size(),
                                         mode, checkClassConstraint);
@@ -1016,7 +1016,6 @@ SILLinkage LinkEntity::getLinkage(IRGenModule &IGM,
 
   case Kind::DirectProtocolWitnessTable:
   case Kind::ProtocolWitnessTableAccessFunction:
-  case Kind::DependentProtocolWitnessTableGenerator:
     return getConformanceLinkage(IGM, getProtocolConformance());
 
   case Kind::ProtocolWitnessTableLazyAccessFunction:
@@ -1029,6 +1028,9 @@ SILLinkage LinkEntity::getLinkage(IRGenModule &IGM,
       return SILLinkage::Shared;
     }
 
+  // The instantiation function and template are only referenced by the
+  // witness table access function, which is emitted alongside them.
+  case Kind::DependentProtocolWitnessTableGenerator:
   case Kind::DependentProtocolWitnessTableTemplate:
     return SILLinkage::Private;
   
@@ -1733,7 +1735,9 @@ getTypeEntityForProtocolConformanceRecord(IRGenModule &IGM,
 
   // TODO: Should use accessor kind for lazy conformances
   ProtocolConformanceReferenceKind conformanceKind
-    = ProtocolConformanceReferenceKind::WitnessTable;
+    = IGM.usesGenericWitnessTable(conformance)
+        ? ProtocolConformanceReferenceKind::WitnessTableAccessor
+        : ProtocolConformanceReferenceKind::WitnessTable;
 
   auto conformingType = conformance->getType()->getCanonicalType();
   if (auto bgt = dyn_cast<BoundGenericType>(conformingType)) {
@@ -1882,14 +1886,21 @@ llvm::Constant *IRGenModule::emitProtocolConformances() {
 
     // If the conformance is in this object's table, then the witness table
     // should also be in this object file, so we can always directly reference
-    // it.
+    // it.  Witness tables that are instantiated at runtime are referenced
+    // through their access function instead.
     // TODO: Produce a relative reference to a private generator function
-    // if the witness table requires lazy initialization, instantiation, or
-    // conditional conformance checking.
+    // if the witness table requires lazy initialization or conditional
+    // conformance checking.
     std::pair<llvm::Constant*, DirectOrGOT> witnessTableRef;
-    auto witnessTableVar = getAddrOfWitnessTable(conformance);
-    witnessTableRef = std::make_pair(witnessTableVar,
-                                     DirectOrGOT::Direct);
+    if (usesGenericWitnessTable(conformance)) {
+      auto accessor = getAddrOfWitnessTableAccessFunction(conformance,
+                                                          NotForDefinition);
+      witnessTableRef = std::make_pair(accessor, DirectOrGOT::Direct);
+    } else {
+      auto witnessTableVar = getAddrOfWitnessTable(conformance);
+      witnessTableRef = std::make_pair(witnessTableVar,
+                                       DirectOrGOT::Direct);
+    }
 
     auto typeRef = getAddrOfLLVMVariableOrGOTEquivalent(
       typeEntity.entity, getPointerAlignment(), typeEntity.defaultTy);
@@ -2680,6 +2691,38 @@ IRGenModule::getAddrOfWitnessTable(const NormalProtocolConformance *conf,
                                WitnessTableTy, DebugTypeInfo());
 }
 
+/// Look up the address of the runtime instantiation structure for the
+/// witness tables of a dependent conformance.
+llvm::Constant *
+IRGenModule::getAddrOfGenericWitnessTableCache(
+                                      const NormalProtocolConformance *conf,
+                                              llvm::Type *storageTy) {
+  auto entity = LinkEntity::forDependentProtocolWitnessTableTemplate(conf);
+  return getAddrOfLLVMVariable(entity, getPointerAlignment(), storageTy,
+                               Int8Ty, DebugTypeInfo());
+}
+
+/// Fetch the function that fills in the type-dependent parts of a newly
+/// instantiated witness table.
+llvm::Function *
+IRGenModule::getAddrOfGenericWitnessTableInstantiationFunction(
+                                      const NormalProtocolConformance *conf) {
+  LinkEntity entity =
+    LinkEntity::forDependentProtocolWitnessTableGenerator(conf);
+  llvm::Function *&entry = GlobalFuncs[entity];
+  if (entry) return entry;
+
+  auto fnType = llvm::FunctionType::get(VoidTy,
+                                        {WitnessTablePtrTy,
+                                         TypeMetadataPtrTy,
+                                         Int8PtrPtrTy},
+                                        /*varargs*/ false);
+
+  LinkInfo link = LinkInfo::get(*this, entity, ForDefinition);
+  entry = link.createFunction(*this, fnType, RuntimeCC, llvm::AttributeSet());
+  return entry;
+}
+
 /// Should we be defining the given helper function?
 static llvm::Function *shouldDefineHelper(IRGenModule &IGM,
                                           llvm::Constant *fn) {
@@ -100,6 +100,7 @@
 
 #define DEBUG_TYPE "enum-layout"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "GenEnum.h"
 
@@ -2693,6 +2694,11 @@ namespace {
     CopyDestroyStrategy CopyDestroyKind;
     ReferenceCounting Refcounting;
 
+    /// Outlined copy and consume functions for this layout, emitted lazily
+    /// the first time a large copy or consume is requested.
+    mutable llvm::Function *OutlinedCopyFn = nullptr;
+    mutable llvm::Function *OutlinedConsumeFn = nullptr;
+
     static EnumPayloadSchema getPayloadSchema(ArrayRef<Element> payloads) {
       // TODO: We might be able to form a nicer schema if the payload elements
       // share a schema. For now just use a generic schema.
@@ -3551,6 +3557,118 @@ namespace {
       APInt mask = ~PayloadTagBits.asAPInt();
       payload.emitApplyAndMask(IGF, mask);
     }
+
+    /// The number of explosion elements across the nontrivial payloads above
+    /// which copy and consume are outlined rather than expanded at every
+    /// use site.
+    static const unsigned OutliningThreshold = 8;
+
+    /// Whether the inline copy or consume sequence is large enough that it
+    /// should be emitted once per module and called instead.
+    bool shouldOutlineCopyAndConsume() const {
+      if (TIK < Loadable)
+        return false;
+      unsigned cost = 0;
+      for (auto &elt : ElementsWithPayload) {
+        if (elt.ti->isPOD(ResilienceScope::Component))
+          continue;
+        cost += cast<LoadableTypeInfo>(*elt.ti).getExplosionSize();
+      }
+      return cost > OutliningThreshold;
+    }
+
+    /// Create a module-private function taking this enum's explosion as its
+    /// arguments, with the body generated by \p emitBody.
+    llvm::Function *createOutlinedFunction(StringRef kind,
+                llvm::function_ref<void(IRGenFunction &, Explosion &)> emitBody)
+    const {
+      ExplosionSchema schema;
+      getSchema(schema);
+      SmallVector<llvm::Type *, 4> argTys;
+      for (auto &elt : schema)
+        argTys.push_back(elt.getScalarType());
+      auto fnTy = llvm::FunctionType::get(IGM.VoidTy, argTys, false);
+
+      llvm::SmallString<64> name;
+      llvm::raw_svector_ostream(name)
+        << "__swift_outlined_" << kind << "_" << getStorageType()->getName();
+      auto fn = llvm::Function::Create(fnTy, llvm::GlobalValue::PrivateLinkage,
+                                       name.str(), &IGM.Module);
+      fn->setCallingConv(IGM.RuntimeCC);
+      fn->setDoesNotThrow();
+
+      IRGenFunction subIGF(IGM, fn);
+      if (IGM.DebugInfo)
+        IGM.DebugInfo->emitArtificialFunction(subIGF, fn);
+      Explosion args = subIGF.collectParameters();
+      emitBody(subIGF, args);
+      subIGF.Builder.CreateRetVoid();
+      return fn;
+    }
+
+    void emitOutlinedCall(IRGenFunction &IGF, llvm::Function *fn,
+                          ArrayRef<llvm::Value *> values) const {
+      llvm::CallInst *call = IGF.Builder.CreateCall(fn, values);
+      call->setCallingConv(fn->getCallingConv());
+      call->setDoesNotThrow();
+    }
+
+    llvm::Function *getOutlinedCopyFunction() const {
+      if (!OutlinedCopyFn)
+        OutlinedCopyFn = createOutlinedFunction("copy",
+          [&](IRGenFunction &subIGF, Explosion &args) {
+            Explosion copy;
+            emitInlineCopy(subIGF, args, copy);
+            copy.claimAll();
+          });
+      return OutlinedCopyFn;
+    }
+
+    llvm::Function *getOutlinedConsumeFunction() const {
+      if (!OutlinedConsumeFn)
+        OutlinedConsumeFn = createOutlinedFunction("consume",
+          [&](IRGenFunction &subIGF, Explosion &args) {
+            emitInlineConsume(subIGF, args);
+          });
+      return OutlinedConsumeFn;
+    }
+
+    /// Copy a value whose payloads need nontrivial copying, by switching on
+    /// its case.
+    void emitInlineCopy(IRGenFunction &IGF, Explosion &src,
+                        Explosion &dest) const {
+      auto parts = destructureAndTagLoadableEnum(IGF, src);
+
+      forNontrivialPayloads(IGF, parts.tag,
+        [&](unsigned tagIndex, EnumImplStrategy::Element elt) {
+          auto &lti = cast<LoadableTypeInfo>(*elt.ti);
+          Explosion value;
+          projectPayloadValue(IGF, parts.payload, tagIndex, lti, value);
+
+          Explosion tmp;
+          lti.copy(IGF, value, tmp);
+          tmp.claimAll(); // FIXME: repack if not bit-identical
+        });
+
+      parts.payload.explode(IGF.IGM, dest);
+      if (parts.extraTagBits)
+        dest.add(parts.extraTagBits);
+    }
+
+    /// Consume a value whose payloads need nontrivial destruction, by
+    /// switching on its case.
+    void emitInlineConsume(IRGenFunction &IGF, Explosion &src) const {
+      auto parts = destructureAndTagLoadableEnum(IGF, src);
+
+      forNontrivialPayloads(IGF, parts.tag,
+        [&](unsigned tagIndex, EnumImplStrategy::Element elt) {
+          auto &lti = cast<LoadableTypeInfo>(*elt.ti);
+          Explosion value;
+          projectPayloadValue(IGF, parts.payload, tagIndex, lti, value);
+
+          lti.consume(IGF, value);
+        });
+    }
     
   public:
     void emitValueInjection(IRGenFunction &IGF,
@@ -3584,22 +3702,15 @@ namespace {
 
       case BitwiseTakable:
       case Normal: {
-        auto parts = destructureAndTagLoadableEnum(IGF, src);
-        
-        forNontrivialPayloads(IGF, parts.tag,
-          [&](unsigned tagIndex, EnumImplStrategy::Element elt) {
-            auto &lti = cast<LoadableTypeInfo>(*elt.ti);
-            Explosion value;
-            projectPayloadValue(IGF, parts.payload, tagIndex, lti, value);
-
-            Explosion tmp;
-            lti.copy(IGF, value, tmp);
-            tmp.claimAll(); // FIXME: repack if not bit-identical
-          });
-
-        parts.payload.explode(IGF.IGM, dest);
-        if (parts.extraTagBits)
-          dest.add(parts.extraTagBits);
+        if (shouldOutlineCopyAndConsume()) {
+          // The copy leaves the value bit-identical, so the source values
+          // can be forwarded as the result.
+          auto values = src.claim(getExplosionSize());
+          emitOutlinedCall(IGF, getOutlinedCopyFunction(), values);
+          dest.add(values);
+          return;
+        }
+        emitInlineCopy(IGF, src, dest);
         return;
       }
 
@@ -3636,16 +3747,12 @@ namespace {
 
       case BitwiseTakable:
       case Normal: {
-        auto parts = destructureAndTagLoadableEnum(IGF, src);
-
-        forNontrivialPayloads(IGF, parts.tag,
-          [&](unsigned tagIndex, EnumImplStrategy::Element elt) {
-            auto &lti = cast<LoadableTypeInfo>(*elt.ti);
-            Explosion value;
-            projectPayloadValue(IGF, parts.payload, tagIndex, lti, value);
-
-            lti.consume(IGF, value);
-          });
+        if (shouldOutlineCopyAndConsume()) {
+          emitOutlinedCall(IGF, getOutlinedConsumeFunction(),
+                           src.claim(getExplosionSize()));
+          return;
+        }
+        emitInlineConsume(IGF, src);
         return;
       }
 
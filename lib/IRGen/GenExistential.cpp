@@ -1665,7 +1665,8 @@ Address irgen::emitBoxedExistentialContainerAllocation(IRGenFunction &IGF,
                                   SILType destType,
                                   CanType formalSrcType,
                                   SILType loweredSrcType,
-                                  ArrayRef<ProtocolConformance *> conformances){
+                                  ArrayRef<ProtocolConformance *> conformances,
+                                  Address initialValue) {
   // TODO: Non-ErrorType boxed existentials.
   assert(_isErrorType(destType));
 
@@ -1680,12 +1681,18 @@ Address irgen::emitBoxedExistentialContainerAllocation(IRGenFunction &IGF,
                                          entry, conformances[0]);
   
   // Call the runtime to allocate the box.
-  // TODO: When there's a store or copy_addr immediately into the box, peephole
-  // it into the initializer parameter to allocError.
+  // TODO: Also peephole a copy_addr into the box into the initializer
+  // parameter to allocError.
+  llvm::Value *initialValuePtr;
+  if (initialValue.isValid())
+    initialValuePtr = IGF.Builder.CreateBitCast(initialValue.getAddress(),
+                                                IGF.IGM.OpaquePtrTy);
+  else
+    initialValuePtr = llvm::ConstantPointerNull::get(IGF.IGM.OpaquePtrTy);
   auto result = IGF.Builder.CreateCall(IGF.IGM.getAllocErrorFn(),
-                         {srcMetadata, witness,
-                           llvm::ConstantPointerNull::get(IGF.IGM.OpaquePtrTy),
-                           llvm::ConstantInt::get(IGF.IGM.Int1Ty, 0)});
+                         {srcMetadata, witness, initialValuePtr,
+                          llvm::ConstantInt::get(IGF.IGM.Int1Ty,
+                                                 initialValue.isValid())});
   
   // Extract the box and value address from the result.
   auto box = IGF.Builder.CreateExtractValue(result, 0);
@@ -63,13 +63,15 @@ namespace irgen {
                                  ArrayRef<ProtocolConformance*> conformances);
 
   /// Allocate a boxed existential container with uninitialized space to hold a
-  /// value of a given type.
+  /// value of a given type. If \p initialValue is valid, the value is taken
+  /// from it into the container.
   Address emitBoxedExistentialContainerAllocation(IRGenFunction &IGF,
                                   Explosion &dest,
                                   SILType destType,
                                   CanType formalSrcType,
                                   SILType loweredSrcType,
-                                  ArrayRef<ProtocolConformance *> conformances);
+                                  ArrayRef<ProtocolConformance *> conformances,
+                                  Address initialValue = Address());
   
   /// "Deinitialize" an existential container whose contained value is allocated
   /// but uninitialized, by deallocating the buffer owned by the container if any.
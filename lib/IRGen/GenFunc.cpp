@@ -2240,6 +2240,8 @@ if (Builtin.ID == BuiltinValueKind::id) { \
     if (auto ExpectedPred = IGF.IGM.TargetInfo.OnceDonePredicateValue) {
       auto PredValue = IGF.Builder.CreateLoad(PredPtr,
                                               IGF.IGM.getPointerAlignment());
+      if (IGF.IGM.TargetInfo.OnceDoneCheckNeedsAcquire)
+        PredValue->setAtomic(llvm::AtomicOrdering::Acquire, llvm::CrossThread);
       auto ExpectedPredValue = llvm::ConstantInt::getSigned(IGF.IGM.OnceTy,
                                                             *ExpectedPred);
       auto PredIsDone = IGF.Builder.CreateICmpEQ(PredValue, ExpectedPredValue);
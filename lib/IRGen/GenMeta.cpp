@@ -32,6 +32,7 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/ADT/SmallString.h"
 
@@ -1101,11 +1102,15 @@ void irgen::emitLazyCacheAccessFunction(IRGenModule &IGM,
   // current LLVM ARM backend.
   auto load = IGF.Builder.CreateLoad(cache);
 
-  // Compare the load result against null.
+  // Compare the load result against null.  The cache is only empty on the
+  // first access, so weight the branch towards the cached path; this keeps
+  // the hit path a single load and compare once the accessor is inlined.
   auto isNullBB = IGF.createBasicBlock("cacheIsNull");
   auto contBB = IGF.createBasicBlock("cont");
   llvm::Value *comparison = IGF.Builder.CreateICmpEQ(load, null);
-  IGF.Builder.CreateCondBr(comparison, isNullBB, contBB);
+  auto weights = llvm::MDBuilder(IGM.getLLVMContext())
+                   .createBranchWeights(/*cache miss*/ 1, /*cache hit*/ 2000);
+  IGF.Builder.CreateCondBr(comparison, isNullBB, contBB, weights);
   auto loadBB = IGF.Builder.GetInsertBlock();
 
   // If the load yielded null, emit the type metadata.
@@ -1793,9 +1798,63 @@ namespace {
     llvm::SmallVector<llvm::Constant*, 16> Fields;
     Size NextOffset = Size(0);
 
+    /// A placeholder for the address of the constant being built. Relative
+    /// references are formed against it until the real global exists, at
+    /// which point setRelativeAddressBase replaces it.
+    std::unique_ptr<llvm::GlobalVariable> RelativeAddressBase;
+
   protected:
     Size getNextOffset() const { return NextOffset; }
 
+    /// Form the relative distance from the next field to \p target.
+    llvm::Constant *getRelativeAddressFromNextField(llvm::Constant *target) {
+      if (!RelativeAddressBase) {
+        RelativeAddressBase.reset(new llvm::GlobalVariable(IGM.Int8Ty,
+                                   /*constant*/ true,
+                                   llvm::GlobalValue::PrivateLinkage));
+      }
+
+      auto baseAddr = llvm::ConstantExpr::getPtrToInt(RelativeAddressBase.get(),
+                                                      IGM.SizeTy);
+      auto fieldAddr = llvm::ConstantExpr::getAdd(baseAddr,
+                       llvm::ConstantInt::get(IGM.SizeTy, NextOffset.getValue()));
+      auto targetAddr = llvm::ConstantExpr::getPtrToInt(target, IGM.SizeTy);
+
+      auto relativeAddr = llvm::ConstantExpr::getSub(targetAddr, fieldAddr);
+
+      // Relative addresses can be 32-bit even on 64-bit platforms.
+      if (IGM.SizeTy != IGM.RelativeAddressTy)
+        relativeAddr = llvm::ConstantExpr::getTrunc(relativeAddr,
+                                                    IGM.RelativeAddressTy);
+      return relativeAddr;
+    }
+
+    /// Add a 32-bit relative reference to the given object or function.
+    void addRelativeAddress(llvm::Constant *target) {
+      assert(!isa<llvm::ConstantPointerNull>(target));
+      addInt32(getRelativeAddressFromNextField(target));
+    }
+
+    /// Add a 32-bit relative reference to the given object or function, or
+    /// zero if it is null.
+    void addRelativeAddressOrNull(llvm::Constant *target) {
+      if (!target || isa<llvm::ConstantPointerNull>(target)) {
+        addConstantInt32(0);
+        return;
+      }
+      addRelativeAddress(target);
+    }
+
+    /// Resolve the relative references added so far against the address of
+    /// the global variable the constant was finally emitted into.
+    void setRelativeAddressBase(llvm::Constant *var) {
+      if (!RelativeAddressBase)
+        return;
+      auto base = llvm::ConstantExpr::getBitCast(var, IGM.Int8PtrTy);
+      RelativeAddressBase->replaceAllUsesWith(base);
+      RelativeAddressBase.reset();
+    }
+
     /// Add a uintptr_t value that represents the given offset, but
     /// scaled to a number of words.
     void addConstantWordInWords(Size value) {
@@ -1913,7 +1972,7 @@ namespace {
     
     void addName() {
       NominalTypeDecl *ntd = asImpl().getTarget();
-      addWord(getMangledTypeName(IGM,
+      addRelativeAddress(getMangledTypeName(IGM,
                                  ntd->getDeclaredType()->getCanonicalType()));
     }
     
@@ -1921,13 +1980,13 @@ namespace {
       NominalTypeDecl *ntd = asImpl().getTarget();
       if (!ntd->getGenericParams()) {
         // If there are no generic parameters, there's no pattern to link.
-        addWord(llvm::ConstantPointerNull::get(IGM.TypeMetadataPatternPtrTy));
+        addConstantInt32(0);
         return;
       }
       
-      addWord(IGM.getAddrOfTypeMetadata(ntd->getDeclaredType()
-                                          ->getCanonicalType(),
-                                        /*pattern*/ true));
+      addRelativeAddress(IGM.getAddrOfTypeMetadata(ntd->getDeclaredType()
+                                                     ->getCanonicalType(),
+                                                   /*pattern*/ true));
     }
     
     void addGenericParams() {
@@ -1984,6 +2043,7 @@ namespace {
                                                          init->getType()));
       var->setConstant(true);
       var->setInitializer(init);
+      setRelativeAddressBase(var);
       return var;
     }
     
@@ -2305,14 +2365,14 @@ namespace {
       
       addConstantInt32(numFields);
       addConstantInt32InWords(FieldVectorOffset);
-      addWord(IGM.getAddrOfGlobalString(fieldNames));
+      addRelativeAddress(IGM.getAddrOfGlobalString(fieldNames));
       
       // Build the field type accessor function.
       llvm::Function *fieldTypeVectorAccessor
         = getFieldTypeAccessorFn(IGM, Target,
                                    Target->getStoredProperties());
       
-      addWord(fieldTypeVectorAccessor);
+      addRelativeAddress(fieldTypeVectorAccessor);
     }
   };
   
@@ -2389,14 +2449,14 @@ namespace {
       
       addConstantInt32(numFields);
       addConstantInt32InWords(FieldVectorOffset);
-      addWord(IGM.getAddrOfGlobalString(fieldNames));
+      addRelativeAddress(IGM.getAddrOfGlobalString(fieldNames));
       
       // Build the field type accessor function.
       llvm::Function *fieldTypeVectorAccessor
         = getFieldTypeAccessorFn(IGM, Target,
                                    Target->getStoredProperties());
       
-      addWord(fieldTypeVectorAccessor);
+      addRelativeAddress(fieldTypeVectorAccessor);
     }
   };
   
@@ -2479,14 +2539,14 @@ namespace {
       // # empty cases
       addConstantInt32(strategy.getElementsWithNoPayload().size());
 
-      addWord(strategy.emitCaseNames());
+      addRelativeAddressOrNull(strategy.emitCaseNames());
 
       // Build the case type accessor.
       llvm::Function *caseTypeVectorAccessor
         = getFieldTypeAccessorFn(IGM, Target,
                                  strategy.getElementsWithPayload());
       
-      addWord(caseTypeVectorAccessor);
+      addRelativeAddressOrNull(caseTypeVectorAccessor);
     }
   };
 }
@@ -3685,6 +3745,10 @@ void IRGenFunction::setDereferenceableLoad(llvm::LoadInst *load,
   load->setMetadata(IGM.DereferenceableID, sizeNode);
 }
 
+void IRGenFunction::setNonNullLoad(llvm::LoadInst *load) {
+  load->setMetadata(IGM.NonNullID, llvm::MDNode::get(IGM.LLVMContext, {}));
+}
+
 /// Emit a load from the given metadata at a constant index.
 ///
 /// The load is marked invariant. This function should not be called
@@ -3786,6 +3850,30 @@ static llvm::Value *emitLoadOfWitnessTableRefAtIndex(IRGenFunction &IGF,
                                      IGF.IGM.WitnessTablePtrTy);
 }
 
+/// Load the generic argument metadata reference at the given index.
+///
+/// Unlike the parent reference, a generic argument is never null, and
+/// it always points at least at a metadata kind word.
+static llvm::Value *emitLoadOfGenericArgumentAtIndex(IRGenFunction &IGF,
+                                                     llvm::Value *metadata,
+                                                     int index) {
+  auto load = emitInvariantLoadFromMetadataAtIndex(IGF, metadata, index,
+                                     IGF.IGM.TypeMetadataPtrTy);
+  IGF.setNonNullLoad(load);
+  IGF.setDereferenceableLoad(load, IGF.IGM.getPointerSize().getValue());
+  return load;
+}
+
+/// Load the generic argument witness table reference at the given index.
+static llvm::Value *emitLoadOfGenericWitnessTableAtIndex(IRGenFunction &IGF,
+                                                         llvm::Value *metadata,
+                                                         int index) {
+  auto load = emitInvariantLoadFromMetadataAtIndex(IGF, metadata, index,
+                                     IGF.IGM.WitnessTablePtrTy);
+  IGF.setNonNullLoad(load);
+  return load;
+}
+
 namespace {
   /// A class for finding the 'parent' index in a class metadata object.
   BEGIN_METADATA_SEARCHER_0(FindClassParentIndex, Class)
@@ -3865,21 +3953,21 @@ llvm::Value *irgen::emitArgumentMetadataRef(IRGenFunction &IGF,
     int index =
       FindClassArgumentIndex(IGF.IGM, cast<ClassDecl>(decl), targetArchetype)
         .getTargetIndex();
-    return emitLoadOfMetadataRefAtIndex(IGF, metadata, index);
+    return emitLoadOfGenericArgumentAtIndex(IGF, metadata, index);
   }
 
   case DeclKind::Struct: {
     int index =
       FindStructArgumentIndex(IGF.IGM, cast<StructDecl>(decl), targetArchetype)
         .getTargetIndex();
-    return emitLoadOfMetadataRefAtIndex(IGF, metadata, index);
+    return emitLoadOfGenericArgumentAtIndex(IGF, metadata, index);
   }
 
   case DeclKind::Enum: {
     int index =
       FindEnumArgumentIndex(IGF.IGM, cast<EnumDecl>(decl), targetArchetype)
         .getTargetIndex();
-    return emitLoadOfMetadataRefAtIndex(IGF, metadata, index);
+    return emitLoadOfGenericArgumentAtIndex(IGF, metadata, index);
   }
   }
   llvm_unreachable("bad decl kind!");
@@ -3930,7 +4018,7 @@ llvm::Value *irgen::emitArgumentWitnessTableRef(IRGenFunction &IGF,
       FindClassWitnessTableIndex(IGF.IGM, cast<ClassDecl>(decl),
                                  targetArchetype, targetProtocol)
         .getTargetIndex();
-    return emitLoadOfWitnessTableRefAtIndex(IGF, metadata, index);
+    return emitLoadOfGenericWitnessTableAtIndex(IGF, metadata, index);
   }
 
   case DeclKind::Enum: {
@@ -3938,7 +4026,7 @@ llvm::Value *irgen::emitArgumentWitnessTableRef(IRGenFunction &IGF,
       FindEnumWitnessTableIndex(IGF.IGM, cast<EnumDecl>(decl),
                                  targetArchetype, targetProtocol)
         .getTargetIndex();
-    return emitLoadOfWitnessTableRefAtIndex(IGF, metadata, index);
+    return emitLoadOfGenericWitnessTableAtIndex(IGF, metadata, index);
   }
       
   case DeclKind::Struct: {
@@ -3946,7 +4034,7 @@ llvm::Value *irgen::emitArgumentWitnessTableRef(IRGenFunction &IGF,
       FindStructWitnessTableIndex(IGF.IGM, cast<StructDecl>(decl),
                                   targetArchetype, targetProtocol)
         .getTargetIndex();
-    return emitLoadOfWitnessTableRefAtIndex(IGF, metadata, index);
+    return emitLoadOfGenericWitnessTableAtIndex(IGF, metadata, index);
   }
   }
   llvm_unreachable("bad decl kind!");
@@ -4042,7 +4130,9 @@ irgen::emitClassResilientInstanceSizeAndAlignMask(IRGenFunction &IGF,
   auto loadZExtInt32AtOffset = [&](Size offset) {
     Address slot = IGF.Builder.CreateConstByteArrayGEP(metadataAsBytes, offset);
     slot = IGF.Builder.CreateBitCast(slot, IGF.IGM.Int32Ty->getPointerTo());
-    llvm::Value *result = IGF.Builder.CreateLoad(slot);
+    auto load = IGF.Builder.CreateLoad(slot);
+    IGF.setInvariantLoad(load);
+    llvm::Value *result = load;
     if (IGF.IGM.SizeTy != IGF.IGM.Int32Ty)
       result = IGF.Builder.CreateZExt(result, IGF.IGM.SizeTy);
     return result;
@@ -4121,6 +4211,9 @@ static llvm::Value *emitLoadOfHeapMetadataRef(IRGenFunction &IGF,
     auto metadata = IGF.Builder.CreateLoad(Address(slot,
                                                IGF.IGM.getPointerAlignment()));
     metadata->setName(llvm::Twine(object->getName()) + ".metadata");
+    // The isa of a live object is never null, but it is not invariant:
+    // the object's class can be changed dynamically.
+    IGF.setNonNullLoad(metadata);
     return metadata;
   }
       
@@ -4222,6 +4315,7 @@ llvm::Value *irgen::emitClassHeapMetadataRefForMetatype(IRGenFunction &IGF,
             IGF.IGM.getPointerAlignment());
   auto metatypeKind =
     IGF.Builder.CreateLoad(metatypeKindAddr, metatype->getName() + ".kind");
+  IGF.setInvariantLoad(metatypeKind);
 
   // Compare it with the class wrapper kind.
   auto classWrapperKind =
@@ -4310,7 +4404,10 @@ llvm::Value *irgen::emitVirtualMethodValue(IRGenFunction &IGF,
       metadata = emitClassHeapMetadataRef(IGF, instanceTy.getSwiftRValueType(),
                                           MetadataValueType::TypeMetadata);
       auto superField = emitAddressOfSuperclassRefInClassMetadata(IGF, metadata);
-      metadata = IGF.Builder.CreateLoad(superField);
+      auto superMetadata = IGF.Builder.CreateLoad(superField);
+      IGF.setInvariantLoad(superMetadata);
+      IGF.setNonNullLoad(superMetadata);
+      metadata = superMetadata;
     } else {
       // Otherwise, we can directly load the statically known superclass's
       // metadata.
@@ -20,6 +20,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "swift/ABI/MetadataValues.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -38,7 +39,7 @@ using namespace irgen;
 /// If we align them more, we'll need to introduce padding to
 /// make protocol types work.
 Size irgen::getFixedBufferSize(IRGenModule &IGM) {
-  return 3 * IGM.getPointerSize();
+  return NumWords_ValueBuffer * IGM.getPointerSize();
 }
 Alignment irgen::getFixedBufferAlignment(IRGenModule &IGM) {
   return IGM.getPointerAlignment();
@@ -433,6 +434,45 @@ llvm::Value *irgen::emitProjectBufferCall(IRGenFunction &IGF,
   return result;
 }
 
+/// Emit a call to a copy-like value witness. When optimizing, the call is
+/// guarded by a runtime check of the type's value witness flags: if
+/// \p emitIsTrivial says the operation is trivial for this type, an inline
+/// memcpy of the type's size is done instead. Everything the witness call
+/// needs is loaded before the branch, so the values cached in the local type
+/// data dominate any later uses.
+static void emitCopyWitnessCall(IRGenFunction &IGF, SILType T,
+                                llvm::Value *copyFn, llvm::Value *metadata,
+                                llvm::Value *destObject,
+                                llvm::Value *srcObject,
+                                llvm::Value *(*emitIsTrivial)(IRGenFunction &,
+                                                              SILType)) {
+  llvm::BasicBlock *contBB = nullptr;
+  if (IGF.IGM.Opts.Optimize) {
+    llvm::Value *isTrivial = emitIsTrivial(IGF, T);
+    llvm::Value *size = emitLoadOfSize(IGF, T);
+    auto trivialBB = IGF.createBasicBlock("trivial-copy");
+    auto witnessBB = IGF.createBasicBlock("witness-copy");
+    contBB = IGF.createBasicBlock("copy-cont");
+    IGF.Builder.CreateCondBr(isTrivial, trivialBB, witnessBB);
+
+    IGF.Builder.emitBlock(trivialBB);
+    IGF.Builder.CreateMemCpy(destObject, srcObject, size, 1);
+    IGF.Builder.CreateBr(contBB);
+
+    IGF.Builder.emitBlock(witnessBB);
+  }
+
+  llvm::CallInst *call =
+    IGF.Builder.CreateCall(copyFn, {destObject, srcObject, metadata});
+  call->setCallingConv(IGF.IGM.RuntimeCC);
+  call->setDoesNotThrow();
+
+  if (contBB) {
+    IGF.Builder.CreateBr(contBB);
+    IGF.Builder.emitBlock(contBB);
+  }
+}
+
 /// Emit a call to do an 'initializeWithCopy' operation.
 void irgen::emitInitializeWithCopyCall(IRGenFunction &IGF,
                                        SILType T,
@@ -441,10 +481,8 @@ void irgen::emitInitializeWithCopyCall(IRGenFunction &IGF,
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
   llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
                                          ValueWitness::InitializeWithCopy);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn, {destObject, srcObject, metadata});
-  call->setCallingConv(IGF.IGM.RuntimeCC);
-  call->setDoesNotThrow();
+  emitCopyWitnessCall(IGF, T, copyFn, metadata, destObject, srcObject,
+                      emitLoadOfIsPOD);
 }
 
 llvm::Value *irgen::emitInitializeBufferWithTakeCall(IRGenFunction &IGF,
@@ -498,11 +536,9 @@ void irgen::emitInitializeWithTakeCall(IRGenFunction &IGF,
                                        llvm::Value *srcObject) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
   llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
-                                            ValueWitness::InitializeWithTake);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn, {destObject, srcObject, metadata});
-  call->setCallingConv(IGF.IGM.RuntimeCC);
-  call->setDoesNotThrow();
+                                         ValueWitness::InitializeWithTake);
+  emitCopyWitnessCall(IGF, T, copyFn, metadata, destObject, srcObject,
+                      emitLoadOfIsBitwiseTakable);
 }
 
 /// Emit a call to do an 'initializeArrayWithTakeFrontToBack' operation.
@@ -554,10 +590,8 @@ void irgen::emitAssignWithCopyCall(IRGenFunction &IGF,
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
   llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
                                          ValueWitness::AssignWithCopy);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn, {destObject, srcObject, metadata});
-  call->setCallingConv(IGF.IGM.RuntimeCC);
-  call->setDoesNotThrow();
+  emitCopyWitnessCall(IGF, T, copyFn, metadata, destObject, srcObject,
+                      emitLoadOfIsPOD);
 }
 
 /// Emit a call to do an 'assignWithTake' operation.
@@ -568,10 +602,8 @@ void irgen::emitAssignWithTakeCall(IRGenFunction &IGF,
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
   llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
                                          ValueWitness::AssignWithTake);
-  llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn, {destObject, srcObject, metadata});
-  call->setCallingConv(IGF.IGM.RuntimeCC);
-  call->setDoesNotThrow();
+  emitCopyWitnessCall(IGF, T, copyFn, metadata, destObject, srcObject,
+                      emitLoadOfIsPOD);
 }
 
 /// Emit a call to do a 'destroy' operation.
@@ -581,9 +613,25 @@ void irgen::emitDestroyCall(IRGenFunction &IGF,
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
   llvm::Value *fn = IGF.emitValueWitnessForLayout(T,
                                    ValueWitness::Destroy);
+
+  // When optimizing, skip the call entirely for POD types.
+  llvm::BasicBlock *contBB = nullptr;
+  if (IGF.IGM.Opts.Optimize) {
+    llvm::Value *isPOD = emitLoadOfIsPOD(IGF, T);
+    auto destroyBB = IGF.createBasicBlock("witness-destroy");
+    contBB = IGF.createBasicBlock("destroy-cont");
+    IGF.Builder.CreateCondBr(isPOD, contBB, destroyBB);
+    IGF.Builder.emitBlock(destroyBB);
+  }
+
   llvm::CallInst *call = IGF.Builder.CreateCall(fn, {object, metadata});
   call->setCallingConv(IGF.IGM.RuntimeCC);
   setHelperAttributes(call);
+
+  if (contBB) {
+    IGF.Builder.CreateBr(contBB);
+    IGF.Builder.emitBlock(contBB);
+  }
 }
 
 /// Emit a call to do a 'destroyArray' operation.
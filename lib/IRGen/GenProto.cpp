@@ -299,6 +299,20 @@ static bool isDependentConformance(IRGenModule &IGM,
   return false;
 }
 
+/// Are the witness tables of the given conformance instantiated by the
+/// runtime, through the conformance's witness table access function?
+bool IRGenModule::usesGenericWitnessTable(
+                                   const NormalProtocolConformance *conf) {
+  if (!Opts.EnableGenericWitnessTables)
+    return false;
+
+  // We can only rely on an access function if we emit it ourselves.
+  if (conf->getDeclContext()->getParentModule() != SILMod->getSwiftModule())
+    return false;
+
+  return isDependentConformance(*this, conf, ResilienceScope::Component);
+}
+
 /// Detail about how an object conforms to a protocol.
 class irgen::ConformanceInfo {
   friend class ProtocolInfo;
@@ -1620,6 +1634,8 @@ namespace {
     const ProtocolConformance &Conformance;
     ArrayRef<Substitution> Substitutions;
     ArrayRef<SILWitnessTable::Entry> SILEntries;
+    SmallVector<std::pair<unsigned, const NormalProtocolConformance *>, 2>
+      DependentBaseConformances;
 #ifndef NDEBUG
     const ProtocolInfo &PI;
 #endif
@@ -1688,10 +1704,28 @@ namespace {
         basePI.getConformance(IGM, baseProto, astConf);
 
       llvm::Constant *baseWitness = conf.tryGetConstantTable(IGM, ConcreteType);
-      assert(baseWitness && "couldn't get a constant table!");
+
+      // If the base conformance is instantiated at runtime, reference its
+      // pattern here and let the instantiation function fill in the table
+      // for the actual conforming type.
+      if (!baseWitness) {
+        auto baseConformance = astConf->getRootNormalConformance();
+        assert(IGM.usesGenericWitnessTable(baseConformance) &&
+               "couldn't get a constant table!");
+        DependentBaseConformances.push_back({Table.size(), baseConformance});
+        baseWitness = IGM.getAddrOfWitnessTable(baseConformance);
+      }
       Table.push_back(asOpaquePtr(IGM, baseWitness));
     }
 
+    /// The table indices of the base protocol witnesses that have to be
+    /// filled in when the table is instantiated, and the conformances that
+    /// witness them.
+    ArrayRef<std::pair<unsigned, const NormalProtocolConformance *>>
+    getDependentBaseConformances() const {
+      return DependentBaseConformances;
+    }
+
     void addMethodFromSILWitnessTable(AbstractFunctionDecl *iface) {
       auto &entry = SILEntries.front();
       SILEntries = SILEntries.slice(1);
@@ -2024,10 +2058,7 @@ ProtocolInfo::getConformance(IRGenModule &IGM, ProtocolDecl *protocol,
 
   // If the conformance is dependent in any way, we need to unique it.
   // TODO: maybe this should apply whenever it's out of the module?
-  // TODO: actually enable this
-  if ((false) &&
-      isDependentConformance(IGM, normalConformance,
-                             ResilienceScope::Component)) {
+  if (IGM.usesGenericWitnessTable(normalConformance)) {
     info = new AccessorConformanceInfo(normalConformance);
 
   // Otherwise, we can use a direct-referencing conformance.
@@ -2039,6 +2070,96 @@ ProtocolInfo::getConformance(IRGenModule &IGM, ProtocolDecl *protocol,
   return *info;
 }
 
+/// Emit the instantiation function for a dependent conformance, which
+/// replaces the base protocol witnesses that depend on the conforming type.
+static llvm::Constant *emitGenericWitnessTableInstantiationFunction(
+                                        IRGenModule &IGM,
+                                 const NormalProtocolConformance *conformance,
+   ArrayRef<std::pair<unsigned, const NormalProtocolConformance *>> bases) {
+  if (bases.empty())
+    return llvm::ConstantPointerNull::get(IGM.Int8PtrTy);
+
+  llvm::Function *fn =
+    IGM.getAddrOfGenericWitnessTableInstantiationFunction(conformance);
+  fn->setDoesNotThrow();
+
+  IRGenFunction IGF(IGM, fn);
+  if (IGM.DebugInfo)
+    IGM.DebugInfo->emitArtificialFunction(IGF, fn);
+
+  Explosion params = IGF.collectParameters();
+  Address table(params.claimNext(), IGM.getPointerAlignment());
+  llvm::Value *metadata = params.claimNext();
+  (void) params.claimNext();
+
+  for (auto &base : bases) {
+    auto accessor =
+      IGM.getAddrOfWitnessTableAccessFunction(base.second, NotForDefinition);
+    auto call = IGF.Builder.CreateCall(accessor, {metadata});
+    call->setCallingConv(IGM.RuntimeCC);
+    call->setDoesNotAccessMemory();
+    call->setDoesNotThrow();
+
+    Address slot = IGF.Builder.CreateConstArrayGEP(table, base.first,
+                                                   IGM.getPointerSize());
+    IGF.Builder.CreateStore(IGF.Builder.CreateBitCast(call, IGM.Int8PtrTy),
+                            slot);
+  }
+  IGF.Builder.CreateRetVoid();
+
+  return llvm::ConstantExpr::getBitCast(fn, IGM.Int8PtrTy);
+}
+
+/// Emit the witness table access function for a dependent conformance,
+/// which instantiates the table for the conforming type through
+/// swift_getGenericWitnessTable.  The runtime caches the instantiated
+/// tables in the GenericWitnessTable structure we emit here.
+static void emitGenericWitnessTableAccessFunction(IRGenModule &IGM,
+                                 const NormalProtocolConformance *conformance,
+                                                  llvm::Constant *pattern,
+                                                  unsigned tableSize,
+   ArrayRef<std::pair<unsigned, const NormalProtocolConformance *>> bases) {
+  assert(tableSize <= UINT16_MAX && "witness table too large");
+
+  llvm::Constant *fields[] = {
+    // WitnessTableSizeInWords
+    llvm::ConstantInt::get(IGM.Int16Ty, tableSize),
+    // WitnessTableSizeInWordsToCopy
+    llvm::ConstantInt::get(IGM.Int16Ty, tableSize),
+    // Pattern
+    llvm::ConstantExpr::getBitCast(pattern, IGM.Int8PtrTy),
+    // Instantiator
+    emitGenericWitnessTableInstantiationFunction(IGM, conformance, bases),
+    // PrivateData
+    llvm::ConstantAggregateZero::get(
+      llvm::ArrayType::get(IGM.Int8PtrTy,
+                           swift::NumGenericMetadataPrivateDataWords)),
+  };
+  auto init = llvm::ConstantStruct::getAnon(fields);
+
+  auto cache = cast<llvm::GlobalVariable>(
+    IGM.getAddrOfGenericWitnessTableCache(conformance, init->getType()));
+  cache->setInitializer(init);
+  cache->setAlignment(IGM.getPointerAlignment().getValue());
+
+  llvm::Function *accessor =
+    IGM.getAddrOfWitnessTableAccessFunction(conformance, ForDefinition);
+  accessor->setDoesNotThrow();
+
+  IRGenFunction IGF(IGM, accessor);
+  if (IGM.DebugInfo)
+    IGM.DebugInfo->emitArtificialFunction(IGF, accessor);
+
+  llvm::Value *metadata = IGF.collectParameters().claimNext();
+  auto call = IGF.Builder.CreateCall(IGM.getGetGenericWitnessTableFn(),
+                  {llvm::ConstantExpr::getBitCast(cache, IGM.Int8PtrTy),
+                   metadata,
+                   llvm::ConstantPointerNull::get(IGM.Int8PtrPtrTy)});
+  call->setCallingConv(IGM.RuntimeCC);
+  call->setDoesNotThrow();
+  IGF.Builder.CreateRet(call);
+}
+
 void IRGenModule::emitSILWitnessTable(SILWitnessTable *wt) {
   // Don't emit a witness table if it is a declaration.
   if (wt->isDeclaration())
@@ -2051,8 +2172,8 @@ void IRGenModule::emitSILWitnessTable(SILWitnessTable *wt) {
 
   // Build the witnesses.
   SmallVector<llvm::Constant*, 32> witnesses;
-  WitnessTableBuilder(*this, witnesses, wt)
-    .visitProtocolDecl(wt->getConformance()->getProtocol());
+  WitnessTableBuilder builder(*this, witnesses, wt);
+  builder.visitProtocolDecl(wt->getConformance()->getProtocol());
   
   assert(getProtocolInfo(wt->getConformance()->getProtocol())
            .getNumWitnesses() == witnesses.size()
@@ -2068,6 +2189,13 @@ void IRGenModule::emitSILWitnessTable(SILWitnessTable *wt) {
   global->setInitializer(initializer);
   global->setAlignment(getWitnessTableAlignment().getValue());
 
+  // If the table is instantiated at runtime, the table we just emitted is
+  // its pattern.
+  if (usesGenericWitnessTable(wt->getConformance()))
+    emitGenericWitnessTableAccessFunction(*this, wt->getConformance(), global,
+                                          witnesses.size(),
+                                      builder.getDependentBaseConformances());
+
   // Build the conformance record, if it lives in this TU.
   if (isAvailableExternally(wt->getLinkage()))
     return;
@@ -2904,8 +3032,11 @@ void NecessaryBindings::restore(IRGenFunction &IGF, Address buffer) const {
                                                   IGF.IGM.getPointerSize());
     ++metadataI;
 
-    // Load the archetype's metatype.
-    llvm::Value *metatype = IGF.Builder.CreateLoad(slot);
+    // Load the archetype's metatype.  The bindings are written once when
+    // the context is formed and never change afterwards.
+    auto metatype = IGF.Builder.CreateLoad(slot);
+    IGF.setInvariantLoad(metatype);
+    IGF.setNonNullLoad(metatype);
 
     // Load the witness tables for the archetype's protocol constraints.
     SmallVector<llvm::Value*, 4> witnesses;
@@ -2918,7 +3049,9 @@ void NecessaryBindings::restore(IRGenFunction &IGF, Address buffer) const {
       witnessSlot = IGF.Builder.CreateBitCast(witnessSlot,
                                     IGF.IGM.WitnessTablePtrTy->getPointerTo());
       ++metadataI;
-      llvm::Value *witness = IGF.Builder.CreateLoad(witnessSlot);
+      auto witness = IGF.Builder.CreateLoad(witnessSlot);
+      IGF.setInvariantLoad(witness);
+      IGF.setNonNullLoad(witness);
       witnesses.push_back(witness);
     }
 
@@ -14,6 +14,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "irgen-types"
 #include "swift/AST/CanTypeVisitor.h"
 #include "swift/AST/Decl.h"
 #include "swift/AST/IRGenOptions.h"
@@ -22,6 +23,7 @@
 #include "swift/SIL/SILModule.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/ErrorHandling.h"
 
 #include "EnumPayload.h"
@@ -45,6 +47,13 @@
 using namespace swift;
 using namespace irgen;
 
+STATISTIC(NumTypeCacheHits, "Number of type lowerings found in the cache");
+STATISTIC(NumExemplarCacheHits,
+          "Number of type lowerings shared through an exemplar type");
+STATISTIC(NumTypesConverted, "Number of types converted");
+STATISTIC(NumDependentCachesReused,
+          "Number of dependent type caches reused for a generic signature");
+
 llvm::DenseMap<TypeBase*, TypeCacheEntry> &
 TypeConverter::Types_t::getCacheFor(TypeBase *t) {
   return t->hasTypeParameter() ? DependentCache : IndependentCache;
@@ -849,6 +858,9 @@ void TypeConverter::pushGenericContext(CanGenericSignature signature) {
   // Push the generic context down to the SIL TypeConverter, so we can share
   // archetypes with SIL.
   IGM.SILMod->Types.pushGenericContext(signature);
+
+  Types.GenericContexts.push_back(signature);
+  switchDependentCache(signature);
 }
 
 void TypeConverter::popGenericContext(CanGenericSignature signature) {
@@ -858,7 +870,34 @@ void TypeConverter::popGenericContext(CanGenericSignature signature) {
   // Pop the SIL TypeConverter's generic context too.
   IGM.SILMod->Types.popGenericContext(signature);
   
+  assert(Types.GenericContexts.back() == signature &&
+         "unbalanced generic context push/pop");
+  Types.GenericContexts.pop_back();
+  switchDependentCache(Types.GenericContexts.empty()
+                         ? CanGenericSignature()
+                         : Types.GenericContexts.back());
+}
+
+void TypeConverter::switchDependentCache(CanGenericSignature signature) {
+  if (signature.getPointer() == Types.DependentCacheSignature)
+    return;
+
+  if (Types.DependentCacheSignature) {
+    Types.SavedDependentCaches[Types.DependentCacheSignature]
+      = std::move(Types.DependentCache);
+  }
   Types.DependentCache.clear();
+
+  Types.DependentCacheSignature = signature.getPointer();
+  if (!signature)
+    return;
+
+  auto saved = Types.SavedDependentCaches.find(signature.getPointer());
+  if (saved != Types.SavedDependentCaches.end()) {
+    ++NumDependentCachesReused;
+    Types.DependentCache = std::move(saved->second);
+    Types.SavedDependentCaches.erase(saved);
+  }
 }
 
 ArchetypeBuilder &TypeConverter::getArchetypes() {
@@ -1290,6 +1329,7 @@ TypeCacheEntry TypeConverter::getTypeEntry(CanType canonicalTy) {
   {
     auto it = Cache.find(canonicalTy.getPointer());
     if (it != Cache.end()) {
+      ++NumTypeCacheHits;
       return it->second;
     }
   }
@@ -1313,6 +1353,7 @@ TypeCacheEntry TypeConverter::getTypeEntry(CanType canonicalTy) {
   if (exemplarTy != canonicalTy) {
     auto it = Types.IndependentCache.find(exemplarTy.getPointer());
     if (it != Types.IndependentCache.end()) {
+      ++NumExemplarCacheHits;
       // Record the object under the original type.
       auto result = it->second;
       Cache[canonicalTy.getPointer()] = result;
@@ -1321,6 +1362,7 @@ TypeCacheEntry TypeConverter::getTypeEntry(CanType canonicalTy) {
   }
 
   // Convert the type.
+  ++NumTypesConverted;
   TypeCacheEntry convertedEntry = convertType(exemplarTy);
   auto convertedTI = convertedEntry.dyn_cast<const TypeInfo*>();
 
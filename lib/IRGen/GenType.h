@@ -176,6 +176,11 @@ public:
   ArchetypeBuilder &getArchetypes();
   
 private:
+  /// Make the dependent type cache the one for the given generic signature,
+  /// stashing the current one so it can be reused when that signature is
+  /// entered again.
+  void switchDependentCache(CanGenericSignature signature);
+
   // Debugging aids.
 #ifndef NDEBUG
   bool isExemplarArchetype(ArchetypeType *arch) const;
@@ -193,6 +198,17 @@ private:
     llvm::DenseMap<TypeBase*, TypeCacheEntry> DependentCache;
     llvm::DenseMap<TypeBase*, TypeCacheEntry> &getCacheFor(TypeBase *t);
 
+    /// The generic signature DependentCache was built under.
+    GenericSignature *DependentCacheSignature = nullptr;
+    /// The dependent caches of generic signatures that are not currently
+    /// active. Canonical signatures are uniqued, so a dependent type always
+    /// lowers the same way under the same signature.
+    llvm::DenseMap<GenericSignature*,
+                   llvm::DenseMap<TypeBase*, TypeCacheEntry>>
+      SavedDependentCaches;
+    /// The stack of entered generic contexts.
+    llvm::SmallVector<CanGenericSignature, 2> GenericContexts;
+
     llvm::ilist<ExemplarArchetype> ExemplarArchetypeStorage;
     llvm::FoldingSet<ExemplarArchetype> ExemplarArchetypes;
     
@@ -201,7 +217,9 @@ private:
                                                            NominalTypeDecl *D);
     friend void TypeConverter::addForwardDecl(TypeBase*, llvm::Type*);
     friend ArchetypeType *TypeConverter::getExemplarArchetype(ArchetypeType *t);
+    friend void TypeConverter::pushGenericContext(CanGenericSignature signature);
     friend void TypeConverter::popGenericContext(CanGenericSignature signature);
+    friend void TypeConverter::switchDependentCache(CanGenericSignature sig);
     
 #ifndef NDEBUG
     friend CanType TypeConverter::getTypeThatLoweredTo(llvm::Type *) const;
@@ -21,6 +21,8 @@
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/LinkLibrary.h"
 #include "swift/SIL/SILModule.h"
+#include "swift/Basic/CompileTimeTrace.h"
+#include "swift/Basic/Demangle.h"
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Platform.h"
 #include "swift/ClangImporter/ClangImporter.h"
@@ -28,6 +30,7 @@
 #include "swift/LLVMPasses/Passes.h"
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
+#include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/BasicTTIImpl.h"
 #include "llvm/IR/Constants.h"
@@ -42,10 +45,14 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Target/TargetMachine.h"
@@ -54,6 +61,7 @@
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/ObjCARC.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #include "IRGenModule.h"
 
 #include <thread>
@@ -119,7 +127,17 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
   // Set up a pipeline.
   PassManagerBuilder PMBuilder;
 
-  if (Opts.Optimize && !Opts.DisableLLVMOptzns) {
+  if (Opts.Optimize && Opts.OptimizeForSize && !Opts.DisableLLVMOptzns) {
+    // Use the -Os pipeline and inline threshold.
+    PMBuilder.OptLevel = 2;
+    PMBuilder.SizeLevel = 1;
+    PMBuilder.Inliner = llvm::createFunctionInliningPass(75);
+
+    // The size-sensitive transformations look at the function attribute.
+    for (auto &F : *Module)
+      if (!F.isDeclaration())
+        F.addFnAttr(llvm::Attribute::OptimizeForSize);
+  } else if (Opts.Optimize && !Opts.DisableLLVMOptzns) {
     PMBuilder.OptLevel = 3;
     PMBuilder.Inliner = llvm::createFunctionInliningPass(200);
     PMBuilder.SLPVectorize = true;
@@ -187,8 +205,11 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
   }
 
   // If we're generating a profile, add the lowering pass now.
-  if (Opts.GenerateProfile)
+  if (Opts.GenerateProfile) {
     ModulePasses.add(createInstrProfilingPass());
+    if (!Opts.DisableProfileCounterPromotion)
+      ModulePasses.add(createSwiftProfileCounterPromotionPass());
+  }
 
   if (Opts.Verify)
     ModulePasses.add(createVerifierPass());
@@ -197,13 +218,125 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
   ModulePasses.run(*Module);
 }
 
+namespace {
+/// The accumulated size of the specializations of one function.
+struct SpecializationSource {
+  unsigned NumSpecializations = 0;
+  size_t Size = 0;
+};
+} // end anonymous namespace
+
+/// If \p Name is the mangled name of a specialization, return the demangled
+/// name of the function it was specialized from.  Otherwise return an empty
+/// string.
+static std::string getSpecializedFunctionName(StringRef Name) {
+  auto Global = Demangle::demangleSymbolAsNode(Name.data(), Name.size());
+  if (!Global || Global->getKind() != Demangle::Node::Kind::Global ||
+      Global->getNumChildren() < 2)
+    return std::string();
+
+  auto FirstKind = Global->getChild(0)->getKind();
+  if (FirstKind != Demangle::Node::Kind::GenericSpecialization &&
+      FirstKind != Demangle::Node::Kind::FunctionSignatureSpecialization)
+    return std::string();
+
+  // The specialized entity follows all of the specialization attributes.
+  return Demangle::nodeToString(
+                        Global->getChild(Global->getNumChildren() - 1));
+}
+
+/// Write the size of each function defined in \p Module to
+/// <OutputFilename>.codesize, largest first, followed by the total size of
+/// the specializations of each specialized function.
+///
+/// Sizes are counted in LLVM instructions after the LLVM optimizations, which
+/// is a good proxy for the machine code size and is available for every kind
+/// of output.
+static void emitCodeSizeReport(DiagnosticEngine &Diags,
+                               llvm::sys::Mutex *DiagMutex,
+                               llvm::Module *Module,
+                               StringRef OutputFilename) {
+  std::string ReportPath = (OutputFilename + ".codesize").str();
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(ReportPath, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    if (DiagMutex)
+      DiagMutex->lock();
+    Diags.diagnose(SourceLoc(), diag::error_opening_output,
+                   ReportPath, EC.message());
+    if (DiagMutex)
+      DiagMutex->unlock();
+    return;
+  }
+
+  std::vector<std::pair<size_t, const llvm::Function *>> Functions;
+  size_t TotalSize = 0;
+  for (const llvm::Function &F : *Module) {
+    if (F.isDeclaration())
+      continue;
+    size_t Size = 0;
+    for (const llvm::BasicBlock &BB : F)
+      Size += BB.size();
+    TotalSize += Size;
+    Functions.push_back({Size, &F});
+  }
+  std::sort(Functions.begin(), Functions.end(),
+            [](const std::pair<size_t, const llvm::Function *> &LHS,
+               const std::pair<size_t, const llvm::Function *> &RHS) {
+    if (LHS.first != RHS.first)
+      return LHS.first > RHS.first;
+    return LHS.second->getName() < RHS.second->getName();
+  });
+
+  OS << "# Code size of " << Module->getModuleIdentifier()
+     << ", in LLVM instructions\n";
+  OS << "total " << TotalSize << "\n\n";
+
+  OS << "#   size function\n";
+  llvm::StringMap<SpecializationSource> Sources;
+  for (auto &Entry : Functions) {
+    StringRef Name = Entry.second->getName();
+    OS << llvm::format("%8zu ", Entry.first) << Name;
+    std::string Origin = getSpecializedFunctionName(Name);
+    if (!Origin.empty()) {
+      OS << " (specialization of " << Origin << ")";
+      auto &Source = Sources[Origin];
+      ++Source.NumSpecializations;
+      Source.Size += Entry.first;
+    }
+    OS << "\n";
+  }
+
+  std::vector<const llvm::StringMapEntry<SpecializationSource> *> SortedSources;
+  for (auto &Entry : Sources)
+    SortedSources.push_back(&Entry);
+  std::sort(SortedSources.begin(), SortedSources.end(),
+            [](const llvm::StringMapEntry<SpecializationSource> *LHS,
+               const llvm::StringMapEntry<SpecializationSource> *RHS) {
+    if (LHS->getValue().Size != RHS->getValue().Size)
+      return LHS->getValue().Size > RHS->getValue().Size;
+    return LHS->getKey() < RHS->getKey();
+  });
+
+  OS << "\n#   size   copies specialized function\n";
+  for (auto *Entry : SortedSources) {
+    OS << llvm::format("%8zu %8u ", Entry->getValue().Size,
+                       Entry->getValue().NumSpecializations)
+       << Entry->getKey() << "\n";
+  }
+}
+
 /// Run the LLVM passes. In multi-threaded compilation this will be done for
 /// multiple LLVM modules in parallel.
+///
+/// If \p Optimize is false, \p Module has already been optimized, and only
+/// the final emission passes are run.
 static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
                         llvm::sys::Mutex *DiagMutex,
                         llvm::Module *Module,
                         llvm::TargetMachine *TargetMachine,
-                        StringRef OutputFilename) {
+                        StringRef OutputFilename, bool Optimize = true) {
+  CompileTimeTraceScope traceScope("llvm", OutputFilename);
   llvm::SmallString<0> Buffer;
   std::unique_ptr<raw_pwrite_stream> RawOS;
   if (!OutputFilename.empty()) {
@@ -232,7 +365,12 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
     RawOS.reset(new raw_svector_ostream(Buffer));
   }
 
-  performLLVMOptimizations(Opts, Module, TargetMachine);
+  if (Optimize)
+    performLLVMOptimizations(Opts, Module, TargetMachine);
+
+  if (Opts.EmitCodeSizeReport && !OutputFilename.empty() &&
+      OutputFilename != "-")
+    emitCodeSizeReport(Diags, DiagMutex, Module, OutputFilename);
 
   legacy::PassManager EmitPasses;
 
@@ -381,6 +519,262 @@ static void initLLVMModule(const IRGenModule &IGM) {
   Module->setDataLayout(IGM.DataLayout.getStringRepresentation());
 }
 
+/// Adds the global values whose definitions use \p V to \p users, looking
+/// through constants.
+static void findUsingGlobals(const llvm::Value *V,
+                             SmallPtrSetImpl<const llvm::GlobalValue *> &users,
+                             SmallPtrSetImpl<const llvm::Value *> &visited) {
+  for (const llvm::User *U : V->users()) {
+    if (auto *I = dyn_cast<llvm::Instruction>(U))
+      users.insert(I->getParent()->getParent());
+    else if (auto *GV = dyn_cast<llvm::GlobalValue>(U))
+      users.insert(GV);
+    else if (visited.insert(U).second)
+      findUsingGlobals(U, users, visited);
+  }
+}
+
+/// Adds the global values referenced by the constant \p C to \p used.
+static void findUsedGlobals(const llvm::Constant *C,
+                            SmallPtrSetImpl<const llvm::GlobalValue *> &used,
+                            SmallPtrSetImpl<const llvm::Value *> &visited) {
+  if (auto *GV = dyn_cast<llvm::GlobalValue>(C)) {
+    used.insert(GV);
+    return;
+  }
+  for (const llvm::Use &Op : C->operands()) {
+    auto *OpC = dyn_cast<llvm::Constant>(Op.get());
+    if (OpC && visited.insert(OpC).second)
+      findUsedGlobals(OpC, used, visited);
+  }
+}
+
+/// Splits the definitions in \p M into at most \p MaxPartitions groups of
+/// roughly the same size, which can be code-generated independently.
+///
+/// Only definitions with strong external linkage can be referenced from
+/// another partition. Everything else, like private and linkonce_odr
+/// definitions, stays with all of its users, so no symbol has to change its
+/// linkage or visibility. The special appending globals, like llvm.used, stay
+/// with everything they refer to.
+///
+/// \returns the number of partitions.
+static unsigned
+partitionModule(const llvm::Module &M, unsigned MaxPartitions,
+                llvm::DenseMap<const llvm::GlobalValue *, unsigned> &partitions) {
+  llvm::EquivalenceClasses<const llvm::GlobalValue *> groups;
+  SmallVector<const llvm::GlobalValue *, 64> definitions;
+  llvm::DenseMap<const llvm::Comdat *, const llvm::GlobalValue *> comdats;
+
+  auto addDefinition = [&](const llvm::GlobalValue &GV) {
+    if (GV.isDeclaration())
+      return;
+    groups.insert(&GV);
+    definitions.push_back(&GV);
+  };
+  for (const llvm::Function &F : M)
+    addDefinition(F);
+  for (const llvm::GlobalVariable &G : M.globals())
+    addDefinition(G);
+  for (const llvm::GlobalAlias &A : M.aliases())
+    addDefinition(A);
+
+  for (const llvm::GlobalValue *GV : definitions) {
+    SmallPtrSet<const llvm::GlobalValue *, 8> related;
+    SmallPtrSet<const llvm::Value *, 16> visited;
+
+    if (GV->hasAppendingLinkage()) {
+      findUsedGlobals(cast<llvm::GlobalVariable>(GV)->getInitializer(),
+                      related, visited);
+    } else if (!GV->hasExternalLinkage()) {
+      findUsingGlobals(GV, related, visited);
+    }
+    if (auto *GA = dyn_cast<llvm::GlobalAlias>(GV))
+      related.insert(GA->getBaseObject());
+    if (const llvm::Comdat *C = GV->getComdat())
+      related.insert(comdats.insert({C, GV}).first->second);
+
+    for (const llvm::GlobalValue *other : related)
+      if (other && !other->isDeclaration())
+        groups.unionSets(GV, other);
+  }
+
+  // Number the groups in module order, so that the partitioning is
+  // deterministic.
+  llvm::DenseMap<const llvm::GlobalValue *, unsigned> groupIndices;
+  SmallVector<std::pair<unsigned, unsigned>, 64> groupSizes;
+  for (const llvm::GlobalValue *GV : definitions) {
+    auto *leader = groups.getLeaderValue(GV);
+    auto inserted = groupIndices.insert({leader, groupSizes.size()});
+    if (inserted.second)
+      groupSizes.push_back({0, groupSizes.size()});
+
+    unsigned size = 1;
+    if (auto *F = dyn_cast<llvm::Function>(GV))
+      for (const llvm::BasicBlock &BB : *F)
+        size += BB.size();
+    groupSizes[inserted.first->second].first += size;
+  }
+
+  unsigned numPartitions = std::min<size_t>(MaxPartitions, groupSizes.size());
+  if (numPartitions < 2)
+    return numPartitions;
+
+  // Assign the largest groups first, each to the smallest partition so far.
+  std::stable_sort(groupSizes.begin(), groupSizes.end(),
+                   [](std::pair<unsigned, unsigned> lhs,
+                      std::pair<unsigned, unsigned> rhs) {
+    return lhs.first > rhs.first;
+  });
+  SmallVector<unsigned, 64> groupPartitions(groupSizes.size());
+  SmallVector<unsigned, 8> partitionSizes(numPartitions, 0);
+  for (auto &group : groupSizes) {
+    auto smallest = std::min_element(partitionSizes.begin(),
+                                     partitionSizes.end());
+    *smallest += group.first;
+    groupPartitions[group.second] = smallest - partitionSizes.begin();
+  }
+
+  for (const llvm::GlobalValue *GV : definitions) {
+    unsigned group = groupIndices[groups.getLeaderValue(GV)];
+    partitions[GV] = groupPartitions[group];
+  }
+  return numPartitions;
+}
+
+/// Combines the object files \p Inputs into the single relocatable object
+/// \p Output, using the linker given by -parallel-codegen-linker.
+static bool combineObjectFiles(DiagnosticEngine &Diags,
+                               const std::string &Linker,
+                               ArrayRef<std::string> Inputs,
+                               StringRef Output) {
+  std::string OutputStr = Output;
+  SmallVector<const char *, 16> Args;
+  Args.push_back(Linker.data());
+  Args.push_back("-r");
+  Args.push_back("-o");
+  Args.push_back(OutputStr.c_str());
+  for (auto &Input : Inputs)
+    Args.push_back(Input.c_str());
+  Args.push_back(nullptr);
+
+  std::string ErrMsg;
+  int Result = llvm::sys::ExecuteAndWait(Linker, Args.data(),
+                                         /*env=*/nullptr,
+                                         /*redirects=*/nullptr,
+                                         /*secondsToWait=*/0,
+                                         /*memoryLimit=*/0, &ErrMsg);
+  if (Result != 0) {
+    if (ErrMsg.empty())
+      ErrMsg = "linker command failed";
+    Diags.diagnose(SourceLoc(), diag::error_parallel_codegen, ErrMsg);
+    return true;
+  }
+  return false;
+}
+
+/// Returns true if the code generation of \p Module can be split into
+/// partitions which are combined into \p OutputFilename again.
+static bool canSplitCodeGen(const IRGenOptions &Opts,
+                            const llvm::Module &Module,
+                            StringRef OutputFilename) {
+  if (Opts.OutputKind != IRGenOutputKind::ObjectFile ||
+      OutputFilename.empty() || Opts.EmbedMode != IRGenEmbedMode::None)
+    return false;
+
+  // Module-level inline assembly would be emitted into every partition.
+  return Module.getModuleInlineAsm().empty();
+}
+
+/// Runs the LLVM optimizations on \p IGM's module, and then splits it into
+/// up to \p NumThreads partitions that are code-generated at the same time,
+/// each in its own LLVM context. The resulting object files are combined
+/// into IGM's output file with \p Linker.
+static bool performParallelCodeGen(IRGenModule &IGM, ASTContext &Ctx,
+                                   unsigned NumThreads,
+                                   const std::string &Linker) {
+  llvm::Module *Module = IGM.getModule();
+  performLLVMOptimizations(IGM.Opts, Module, IGM.TargetMachine);
+
+  llvm::DenseMap<const llvm::GlobalValue *, unsigned> Partitions;
+  unsigned NumPartitions = partitionModule(*Module, NumThreads, Partitions);
+  if (NumPartitions < 2) {
+    return performLLVM(IGM.Opts, Ctx.Diags, nullptr, Module,
+                       IGM.TargetMachine, IGM.OutputFilename,
+                       /*Optimize=*/false);
+  }
+
+  // Each partition is handed to its thread as bitcode, since an LLVM context
+  // can only be used by one thread at a time.
+  std::vector<SmallString<0>> Bitcode(NumPartitions);
+  std::vector<std::string> PartitionFilenames(NumPartitions);
+  std::vector<std::unique_ptr<llvm::TargetMachine>> TargetMachines;
+  for (unsigned i = 0; i != NumPartitions; ++i) {
+    llvm::ValueToValueMapTy VMap;
+    std::unique_ptr<llvm::Module> Part =
+      llvm::CloneModule(Module, VMap, [&](const llvm::GlobalValue *GV) {
+        auto Known = Partitions.find(GV);
+        return Known != Partitions.end() && Known->second == i;
+      });
+    llvm::raw_svector_ostream OS(Bitcode[i]);
+    llvm::WriteBitcodeToFile(Part.get(), OS);
+
+    SmallString<128> PartitionFilename;
+    std::error_code EC =
+      llvm::sys::fs::createTemporaryFile(
+        llvm::sys::path::stem(IGM.OutputFilename), "o", PartitionFilename);
+    if (EC) {
+      Ctx.Diags.diagnose(SourceLoc(), diag::error_opening_output,
+                         PartitionFilename, EC.message());
+      return true;
+    }
+    PartitionFilenames[i] = PartitionFilename.str();
+
+    TargetMachines.emplace_back(createTargetMachine(IGM.Opts, Ctx));
+    if (!TargetMachines.back())
+      return true;
+  }
+
+  DEBUG(dbgs() << "splitting " << IGM.OutputFilename << " into "
+               << NumPartitions << " partitions\n");
+
+  llvm::sys::Mutex DiagMutex;
+  std::atomic<bool> HadError(false);
+  auto EmitPartition = [&](unsigned i) {
+    LLVMContext Context;
+    auto Part = llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(Bitcode[i].str(), PartitionFilenames[i]),
+        Context);
+    if (!Part) {
+      llvm::sys::ScopedLock Lock(DiagMutex);
+      Ctx.Diags.diagnose(SourceLoc(), diag::error_parallel_codegen,
+                         Part.getError().message());
+      HadError = true;
+      return;
+    }
+    if (performLLVM(IGM.Opts, Ctx.Diags, &DiagMutex, Part->get(),
+                    TargetMachines[i].get(), PartitionFilenames[i],
+                    /*Optimize=*/false)) {
+      HadError = true;
+    }
+  };
+
+  std::vector<std::thread> Threads;
+  for (unsigned i = 1; i != NumPartitions; ++i)
+    Threads.push_back(std::thread(EmitPartition, i));
+  EmitPartition(0);
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  if (!HadError)
+    HadError = combineObjectFiles(Ctx.Diags, Linker, PartitionFilenames,
+                                  IGM.OutputFilename);
+
+  for (auto &PartitionFilename : PartitionFilenames)
+    llvm::sys::fs::remove(PartitionFilename);
+  return HadError;
+}
+
 /// Generates LLVM IR, runs the LLVM passes and produces the output file.
 /// All this is done in a single thread.
 static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
@@ -474,6 +868,23 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return nullptr;
 
+  // With -parallel-codegen-linker, even a single file's code generation is
+  // split between the -num-threads threads.
+  unsigned NumThreads = SILMod->getOptions().NumThreads;
+  if (SF && NumThreads > 1 && !Opts.ParallelCodeGenLinker.empty() &&
+      canSplitCodeGen(Opts, *IGM.getModule(), IGM.OutputFilename)) {
+    auto Linker = llvm::sys::findProgramByName(Opts.ParallelCodeGenLinker);
+    if (!Linker || !llvm::sys::fs::can_execute(*Linker)) {
+      Ctx.Diags.diagnose(SourceLoc(),
+                         diag::error_parallel_codegen_linker_not_found,
+                         Opts.ParallelCodeGenLinker);
+      return nullptr;
+    }
+    if (performParallelCodeGen(IGM, Ctx, NumThreads, *Linker))
+      return nullptr;
+    return std::unique_ptr<llvm::Module>(IGM.releaseModule());
+  }
+
   embedBitcode(IGM.getModule(), Opts);
   if (performLLVM(IGM.Opts, IGM.Context.Diags, nullptr, IGM.getModule(),
                   IGM.TargetMachine, IGM.OutputFilename))
@@ -652,6 +1063,11 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return;
 
+  // IR emission shares the ASTContext, the SIL type lowering caches and the
+  // lazy emission queues, so it stays on this thread. Only the LLVM
+  // pipelines run in parallel; hand the largest modules out first.
+  dispatcher.sortQueueByCodeSize();
+
   std::vector<std::thread> Threads;
   llvm::sys::Mutex DiagMutex;
 
@@ -681,6 +1097,7 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
 std::unique_ptr<llvm::Module> swift::
 performIRGeneration(IRGenOptions &Opts, swift::Module *M, SILModule *SILMod,
                     StringRef ModuleName, llvm::LLVMContext &LLVMContext) {
+  CompileTimeTraceScope traceScope("frontend", "IRGen");
   int numThreads = SILMod->getOptions().NumThreads;
   if (numThreads != 0) {
     ::performParallelIRGeneration(Opts, M, SILMod, ModuleName, numThreads);
@@ -695,6 +1112,7 @@ std::unique_ptr<llvm::Module> swift::
 performIRGeneration(IRGenOptions &Opts, SourceFile &SF, SILModule *SILMod,
                     StringRef ModuleName, llvm::LLVMContext &LLVMContext,
                     unsigned StartElem) {
+  CompileTimeTraceScope traceScope("frontend", "IRGen");
   return ::performIRGeneration(Opts, SF.getParentModule(), SILMod, ModuleName,
                                LLVMContext, &SF, StartElem);
 }
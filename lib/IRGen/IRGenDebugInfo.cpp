@@ -1150,18 +1150,20 @@ void IRGenDebugInfo::emitGlobalVariableDeclaration(llvm::GlobalValue *Var,
 
 /// Return the mangled name of any nominal type, including the global
 /// _Tt prefix, which marks the Swift namespace for types in DWARF.
-StringRef IRGenDebugInfo::getMangledName(DebugTypeInfo DbgTy) {
+///
+/// The result may point into \p Buffer.
+StringRef IRGenDebugInfo::getMangledName(DebugTypeInfo DbgTy,
+                                         SmallVectorImpl<char> &Buffer) {
   if (MetadataTypeDecl && DbgTy.getDecl() == MetadataTypeDecl)
-    return BumpAllocatedString(DbgTy.getDecl()->getName().str());
+    return DbgTy.getDecl()->getName().str();
 
-  llvm::SmallString<160> Buffer;
   {
     llvm::raw_svector_ostream S(Buffer);
     Mangle::Mangler M(S, /* DWARF */ true);
     M.mangleTypeForDebugger(DbgTy.getType(), DbgTy.getDeclContext());
   }
   assert(!Buffer.empty() && "mangled name came back empty");
-  return BumpAllocatedString(Buffer);
+  return StringRef(Buffer.data(), Buffer.size());
 }
 
 /// Create a member of a struct, class, tuple, or enum.
@@ -1253,6 +1255,27 @@ llvm::DICompositeType *IRGenDebugInfo::createStructType(
   return DITy;
 }
 
+/// If -debug-info-external-type-declarations is in effect and \p Decl is a
+/// Swift type defined in another module, return a declaration that refers to
+/// it by its mangled name. The defining module emits the full type, so the
+/// debugger can find it there, and this object doesn't have to repeat it.
+///
+/// \returns null if the full type should be emitted here.
+llvm::DIType *IRGenDebugInfo::createExternalNominalType(
+    NominalTypeDecl *Decl, StringRef MangledName, llvm::DIScope *Scope,
+    llvm::DIFile *File, unsigned Line, unsigned SizeInBits,
+    unsigned AlignInBits) {
+  if (!Opts.DebugInfoExternalTypeDeclarations || MangledName.empty())
+    return nullptr;
+  if (Decl->hasClangNode() ||
+      Decl->getModuleContext() == IGM.SILMod->getSwiftModule())
+    return nullptr;
+
+  return DBuilder.createForwardDecl(
+      llvm::dwarf::DW_TAG_structure_type, Decl->getName().str(), Scope, File,
+      Line, llvm::dwarf::DW_LANG_Swift, SizeInBits, AlignInBits, MangledName);
+}
+
 /// Return an array with the DITypes for each of an enum's elements.
 llvm::DINodeArray IRGenDebugInfo::getEnumElements(DebugTypeInfo DbgTy,
                                                   EnumDecl *D,
@@ -1487,9 +1510,13 @@ llvm::DIType *IRGenDebugInfo::createType(DebugTypeInfo DbgTy,
     auto *StructTy = BaseTy->castTo<StructType>();
     auto *Decl = StructTy->getDecl();
     Location L = getLoc(SM, Decl);
-    return createStructType(DbgTy, Decl, StructTy, Scope,
-                            getOrCreateFile(L.Filename), L.Line, SizeInBits,
-                            AlignInBits, Flags,
+    auto *File = getOrCreateFile(L.Filename);
+    if (auto *DITy = createExternalNominalType(Decl, MangledName, Scope, File,
+                                               L.Line, SizeInBits,
+                                               AlignInBits))
+      return DITy;
+    return createStructType(DbgTy, Decl, StructTy, Scope, File, L.Line,
+                            SizeInBits, AlignInBits, Flags,
                             nullptr, // DerivedFrom
                             llvm::dwarf::DW_LANG_Swift, MangledName);
   }
@@ -1712,8 +1739,13 @@ llvm::DIType *IRGenDebugInfo::createType(DebugTypeInfo DbgTy,
     auto *EnumTy = BaseTy->castTo<EnumType>();
     auto *Decl = EnumTy->getDecl();
     Location L = getLoc(SM, Decl);
-    return createEnumType(DbgTy, Decl, MangledName, Scope,
-                          getOrCreateFile(L.Filename), L.Line, Flags);
+    auto *File = getOrCreateFile(L.Filename);
+    if (auto *DITy = createExternalNominalType(Decl, MangledName, Scope, File,
+                                               L.Line, SizeInBits,
+                                               AlignInBits))
+      return DITy;
+    return createEnumType(DbgTy, Decl, MangledName, Scope, File, L.Line,
+                          Flags);
   }
 
   case TypeKind::BoundGenericEnum: {
@@ -1864,10 +1896,16 @@ llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
   StringRef MangledName;
   llvm::MDString *UID = nullptr;
   if (canMangle(DbgTy.getType())) {
-    MangledName = getMangledName(DbgTy);
-    UID = llvm::MDString::get(IGM.getLLVMContext(), MangledName);
+    // The MDString owns a copy of the name, so it doesn't need to be kept
+    // anywhere else.
+    llvm::SmallString<160> Buffer;
+    UID = llvm::MDString::get(IGM.getLLVMContext(),
+                              getMangledName(DbgTy, Buffer));
+    MangledName = UID->getString();
     if (llvm::Metadata *CachedTy = DIRefMap.lookup(UID)) {
       auto DITy = cast<llvm::DIType>(CachedTy);
+      // Remember this TypeBase too, so that it isn't mangled again.
+      DITypeCache.insert({DbgTy.getType(), llvm::TrackingMDNodeRef(DITy)});
       return DITy;
     }
   }
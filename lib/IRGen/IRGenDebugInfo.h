@@ -240,7 +240,7 @@ private:
   StringRef getName(const FuncDecl &FD);
   StringRef getName(SILLocation L);
   StringRef getMangledName(TypeAliasDecl *Decl);
-  StringRef getMangledName(DebugTypeInfo DTI);
+  StringRef getMangledName(DebugTypeInfo DTI, SmallVectorImpl<char> &Buffer);
   llvm::DITypeRefArray createParameterTypes(CanSILFunctionType FnTy,
                                             DeclContext *DeclCtx);
   llvm::DITypeRefArray createParameterTypes(SILType SILTy,
@@ -272,6 +272,12 @@ private:
   llvm::DINodeArray getEnumElements(DebugTypeInfo DbgTy, EnumDecl *D,
                                     llvm::DIScope *Scope, llvm::DIFile *File,
                                     unsigned Flags);
+  llvm::DIType *createExternalNominalType(NominalTypeDecl *Decl,
+                                         StringRef MangledName,
+                                         llvm::DIScope *Scope,
+                                         llvm::DIFile *File, unsigned Line,
+                                         unsigned SizeInBits,
+                                         unsigned AlignInBits);
   llvm::DICompositeType *createEnumType(DebugTypeInfo DbgTy, EnumDecl *Decl,
                                         StringRef MangledName,
                                         llvm::DIScope *Scope,
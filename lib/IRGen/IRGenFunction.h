@@ -243,6 +243,8 @@ public:
   void setInvariantLoad(llvm::LoadInst *load);
   /// Mark a load as dereferenceable to `size` bytes.
   void setDereferenceableLoad(llvm::LoadInst *load, unsigned size);
+  /// Mark a load as producing a non-null pointer.
+  void setNonNullLoad(llvm::LoadInst *load);
 
 private:
   llvm::Instruction *AllocaIP;
@@ -45,6 +45,7 @@
 #include "IRGenDebugInfo.h"
 #include "Linking.h"
 
+#include <algorithm>
 #include <initializer_list>
 
 using namespace swift;
@@ -327,6 +328,7 @@ IRGenModule::IRGenModule(IRGenModuleDispatcher &dispatcher, SourceFile *SF,
   InvariantMetadataID = LLVMContext.getMDKindID("invariant.load");
   InvariantNode = llvm::MDNode::get(LLVMContext, {});
   DereferenceableID = LLVMContext.getMDKindID("dereferenceable");
+  NonNullID = LLVMContext.getMDKindID("nonnull");
   
   // TODO: use "tinycc" on platforms that support it
   RuntimeCC = llvm::CallingConv::C;
@@ -814,6 +816,27 @@ void IRGenModuleDispatcher::addGenModule(SourceFile *SF, IRGenModule *IGM) {
   Queue.push_back(IGM);
 }
 
+void IRGenModuleDispatcher::sortQueueByCodeSize() {
+  assert(QueueIndex == 0 && "queue is already being processed");
+
+  // The LLVM pipeline time of a module is roughly proportional to the
+  // number of instructions in it. Starting the biggest modules first keeps
+  // one large file from being picked up last and running alone while the
+  // other threads are idle.
+  llvm::DenseMap<IRGenModule *, size_t> CodeSize;
+  for (IRGenModule *IGM : Queue) {
+    size_t NumInsts = 0;
+    for (llvm::Function &F : IGM->getModule()->getFunctionList())
+      for (llvm::BasicBlock &BB : F)
+        NumInsts += BB.size();
+    CodeSize[IGM] = NumInsts;
+  }
+  std::stable_sort(Queue.begin(), Queue.end(),
+                   [&](IRGenModule *LHS, IRGenModule *RHS) {
+                     return CodeSize[LHS] > CodeSize[RHS];
+                   });
+}
+
 IRGenModule *IRGenModuleDispatcher::getGenModule(DeclContext *ctxt) {
   if (GenModules.size() == 1 || !ctxt) {
     return getPrimaryIGM();
@@ -237,6 +237,11 @@ public:
     return it->second;
   }
   
+  /// Order the queue so that the IRGenModules with the most code are handed
+  /// to threads first. Must be called before any thread fetches from the
+  /// queue.
+  void sortQueueByCodeSize();
+
   /// In multi-threaded compilation fetch the next IRGenModule from the queue.
   IRGenModule *fetchFromQueue() {
     int idx = QueueIndex++;
@@ -388,6 +393,7 @@ public:
   
   unsigned InvariantMetadataID; /// !invariant.load
   unsigned DereferenceableID;   /// !dereferenceable
+  unsigned NonNullID;           /// !nonnull
   llvm::MDNode *InvariantNode;
   
   llvm::CallingConv::ID RuntimeCC;     /// lightweight calling convention
@@ -678,6 +684,7 @@ public:
   void emitCoverageMapping();
   void emitSILFunction(SILFunction *f);
   void emitSILWitnessTable(SILWitnessTable *wt);
+  bool usesGenericWitnessTable(const NormalProtocolConformance *conf);
   void emitSILStaticInitializer();
   llvm::Constant *emitFixedTypeLayout(CanType t, const FixedTypeInfo &ti);
 
@@ -748,6 +755,11 @@ public:
                                                ForDefinition_t forDefinition);
   llvm::Constant *getAddrOfWitnessTable(const NormalProtocolConformance *C,
                                         llvm::Type *definitionTy = nullptr);
+  llvm::Constant *getAddrOfGenericWitnessTableCache(
+                                           const NormalProtocolConformance *C,
+                                           llvm::Type *definitionTy = nullptr);
+  llvm::Function *getAddrOfGenericWitnessTableInstantiationFunction(
+                                           const NormalProtocolConformance *C);
   Address getAddrOfObjCISAMask();
 
   StringRef mangleType(CanType type, SmallVectorImpl<char> &buffer);
@@ -20,14 +20,17 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Debug.h"
 #include "clang/AST/ASTContext.h"
+#include "swift/Basic/CompileTimeTrace.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Range.h"
 #include "swift/Basic/STLExtras.h"
+#include "swift/LLVMPasses/Passes.h"
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/Pattern.h"
@@ -300,6 +303,12 @@ public:
   int EstimatedStackSize = -1;
 
   llvm::MapVector<SILBasicBlock *, LoweredBB> LoweredBBs;
+
+  /// alloc_existential_box instructions whose allocation is deferred to the
+  /// store which initializes the box, so that the value can be passed to the
+  /// runtime.
+  llvm::SmallDenseMap<StoreInst *, AllocExistentialBoxInst *, 4>
+    DeferredErrorBoxAllocs;
   
   // Destination basic blocks for condfail traps.
   llvm::SmallVector<llvm::BasicBlock *, 8> FailBBs;
@@ -654,6 +663,7 @@ public:
   void visitDeinitExistentialAddrInst(DeinitExistentialAddrInst *i);
   
   void visitAllocExistentialBoxInst(AllocExistentialBoxInst *i);
+  void emitErrorBoxAllocation(AllocExistentialBoxInst *i, StoreInst *init);
   void visitOpenExistentialBoxInst(OpenExistentialBoxInst *i);
   void visitDeallocExistentialBoxInst(DeallocExistentialBoxInst *i);
   
@@ -1236,6 +1246,7 @@ void IRGenModule::emitSILFunction(SILFunction *f) {
     return;
 
   PrettyStackTraceSILFunction stackTrace("emitting IR", f);
+  CompileTimeTraceScope traceScope("irgen-function", f->getName());
   IRGenSILFunction(*this, f).emitSILFunction();
 }
 
@@ -2754,10 +2765,66 @@ void IRGenSILFunction::visitDynamicMethodBranchInst(DynamicMethodBranchInst *i){
   Builder.CreateCondBr(call, hasMethodBB.bb, noMethodBB.bb);
 }
 
+/// If the SIL optimizer marked the loop back edge leaving \p fromBB, attach
+/// llvm.loop metadata asking the loop vectorizer to vectorize the loop.
+static void addVectorizationHint(const SILBasicBlock *fromBB,
+                                 llvm::Instruction *br) {
+  if (!fromBB->hasVectorizationHint())
+    return;
+
+  auto &ctx = br->getContext();
+  llvm::Metadata *enable[] = {
+    llvm::MDString::get(ctx, "llvm.loop.vectorize.enable"),
+    llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(ctx))
+  };
+
+  // The first operand of a loop id is a reference to the id itself.
+  auto tempNode = llvm::MDNode::getTemporary(ctx, None);
+  llvm::Metadata *args[] = { tempNode.get(), llvm::MDNode::get(ctx, enable) };
+  llvm::MDNode *loopID = llvm::MDNode::get(ctx, args);
+  loopID->replaceOperandWith(0, loopID);
+  br->setMetadata(llvm::LLVMContext::MD_loop, loopID);
+}
+
 void IRGenSILFunction::visitBranchInst(swift::BranchInst *i) {
   LoweredBB &lbb = getLoweredBB(i->getDestBB());
   addIncomingSILArgumentsToPHINodes(*this, lbb, i->getArgs());
-  Builder.CreateBr(lbb.bb);
+  auto *br = Builder.CreateBr(lbb.bb);
+  addVectorizationHint(i->getParent(), br);
+}
+
+/// Return the profiled execution count of the edge from \p fromBB to \p toBB,
+/// if known.
+static Optional<uint64_t> getProfiledEdgeCount(const SILBasicBlock *fromBB,
+                                               const SILBasicBlock *toBB) {
+  if (toBB->getSinglePredecessor() != fromBB)
+    return None;
+  return toBB->getProfileCount();
+}
+
+/// Compute branch weights for a conditional branch from the profile passed
+/// with -profile-use, or return null if the counts are unknown.
+static llvm::MDNode *getProfiledBranchWeights(llvm::LLVMContext &ctx,
+                                              CondBranchInst *i) {
+  SILBasicBlock *fromBB = i->getParent();
+  auto trueCount = getProfiledEdgeCount(fromBB, i->getTrueBB());
+  auto falseCount = getProfiledEdgeCount(fromBB, i->getFalseBB());
+
+  // Only one side of an 'if' has a counter of its own; derive the other one
+  // from the count of the branching block.
+  if (auto fromCount = fromBB->getProfileCount()) {
+    if (trueCount && !falseCount && *fromCount >= *trueCount)
+      falseCount = *fromCount - *trueCount;
+    else if (falseCount && !trueCount && *fromCount >= *falseCount)
+      trueCount = *fromCount - *falseCount;
+  }
+  if (!trueCount || !falseCount)
+    return nullptr;
+
+  // Branch weights are 32-bit, so scale large counts down uniformly.
+  uint64_t scale = std::max(*trueCount, *falseCount) / UINT32_MAX + 1;
+  return llvm::MDBuilder(ctx).createBranchWeights(uint32_t(*trueCount / scale),
+                                                  uint32_t(*falseCount / scale));
 }
 
 void IRGenSILFunction::visitCondBranchInst(swift::CondBranchInst *i) {
@@ -2769,7 +2836,10 @@ void IRGenSILFunction::visitCondBranchInst(swift::CondBranchInst *i) {
   addIncomingSILArgumentsToPHINodes(*this, trueBB, i->getTrueArgs());
   addIncomingSILArgumentsToPHINodes(*this, falseBB, i->getFalseArgs());
 
-  Builder.CreateCondBr(condValue, trueBB.bb, falseBB.bb);
+  auto *br = Builder.CreateCondBr(condValue, trueBB.bb, falseBB.bb,
+                                  getProfiledBranchWeights(IGM.getLLVMContext(),
+                                                           i));
+  addVectorizationHint(i->getParent(), br);
 }
 
 void IRGenSILFunction::visitRetainValueInst(swift::RetainValueInst *i) {
@@ -2916,15 +2986,51 @@ void IRGenSILFunction::visitRefElementAddrInst(swift::RefElementAddrInst *i) {
   setLoweredAddress(SILValue(i, 0), field);
 }
 
+/// Whether \p addr is a `let` stored property of a class instance.
+static bool isImmutableClassProperty(SILValue addr) {
+  auto *REA = dyn_cast<RefElementAddrInst>(addr);
+  return REA && REA->getField()->isLet();
+}
+
 void IRGenSILFunction::visitLoadInst(swift::LoadInst *i) {
   Explosion lowered;
   Address source = getLoweredAddress(i->getOperand());
   const TypeInfo &type = getTypeInfo(i->getType().getObjectType());
+
+  // When optimizing, tag the loads of a `let` class property so that
+  // SwiftAA knows calls can't modify the loaded memory.
+  if (!IGM.Opts.Optimize || !isImmutableClassProperty(i->getOperand())) {
+    cast<LoadableTypeInfo>(type).loadAsTake(*this, source, lowered);
+    setLoweredExplosion(SILValue(i, 0), lowered);
+    return;
+  }
+
+  llvm::BasicBlock *startBB = Builder.GetInsertBlock();
+  llvm::BasicBlock::iterator startPos = Builder.GetInsertPoint();
+  bool startAtBegin = startPos == startBB->begin();
+  if (!startAtBegin)
+    --startPos;
+
   cast<LoadableTypeInfo>(type).loadAsTake(*this, source, lowered);
+
+  if (Builder.GetInsertBlock() == startBB) {
+    auto tag = getImmutablePropertyTBAATag(IGM.getLLVMContext());
+    auto it = startAtBegin ? startBB->begin() : std::next(startPos);
+    for (auto end = Builder.GetInsertPoint(); it != end; ++it)
+      if (auto *load = dyn_cast<llvm::LoadInst>(&*it))
+        load->setMetadata(llvm::LLVMContext::MD_tbaa, tag);
+  }
+
   setLoweredExplosion(SILValue(i, 0), lowered);
 }
 
 void IRGenSILFunction::visitStoreInst(swift::StoreInst *i) {
+  auto deferred = DeferredErrorBoxAllocs.find(i);
+  if (deferred != DeferredErrorBoxAllocs.end()) {
+    emitErrorBoxAllocation(deferred->second, i);
+    return;
+  }
+
   Explosion source = getLoweredExplosion(i->getSrc());
   Address dest = getLoweredAddress(i->getDest());
   auto &type = getTypeInfo(i->getSrc().getType().getObjectType());
@@ -4262,15 +4368,65 @@ void IRGenSILFunction::visitInitBlockStorageHeaderInst(
   setLoweredExplosion(SILValue(i, 0), e);
 }
 
-void IRGenSILFunction::visitAllocExistentialBoxInst(AllocExistentialBoxInst *i){
+/// Returns the store which initializes the box allocated by \p i if the
+/// allocation can be deferred to it: the stored value is POD, it is the only
+/// use of the box's address, and nothing in between uses the box.
+static StoreInst *getDeferrableErrorBoxStore(IRGenSILFunction &IGF,
+                                             AllocExistentialBoxInst *i) {
+  SILValue addr = i->getValueAddressResult();
+  if (!addr.hasOneUse())
+    return nullptr;
+  auto *store = dyn_cast<StoreInst>(addr.use_begin()->getUser());
+  if (!store || store->getDest() != addr || store->getParent() != i->getParent())
+    return nullptr;
+
+  auto &valueTI = IGF.getTypeInfo(i->getLoweredConcreteType());
+  if (!valueTI.isPOD(ResilienceScope::Component))
+    return nullptr;
+
+  for (auto it = std::next(SILBasicBlock::iterator(i));
+       &*it != store; ++it) {
+    for (auto &op : it->getAllOperands())
+      if (op.get().getDef() == i)
+        return nullptr;
+  }
+  return store;
+}
+
+void IRGenSILFunction::emitErrorBoxAllocation(AllocExistentialBoxInst *i,
+                                              StoreInst *init) {
+  // Pass the initial value to the runtime in a temporary, which lets it
+  // reuse a box with the same contents.
+  Address initialValue;
+  auto valueType = i->getLoweredConcreteType();
+  auto &valueTI = cast<LoadableTypeInfo>(getTypeInfo(valueType));
+  if (init) {
+    Explosion source = getLoweredExplosion(init->getSrc());
+    initialValue = valueTI.allocateStack(*this, valueType,
+                                         "error.value").getAddress();
+    valueTI.initialize(*this, source, initialValue);
+  }
+
   Explosion box;
   auto projectionAddr =
     emitBoxedExistentialContainerAllocation(*this, box, i->getExistentialType(),
                                             i->getFormalConcreteType(),
-                                            i->getLoweredConcreteType(),
-                                            i->getConformances());
+                                            valueType,
+                                            i->getConformances(),
+                                            initialValue);
   setLoweredExplosion(i->getExistentialResult(), box);
   setLoweredAddress(i->getValueAddressResult(), projectionAddr);
+
+  if (init)
+    valueTI.deallocateStack(*this, initialValue, valueType);
+}
+
+void IRGenSILFunction::visitAllocExistentialBoxInst(AllocExistentialBoxInst *i){
+  if (auto *store = getDeferrableErrorBoxStore(*this, i)) {
+    DeferredErrorBoxAllocs[store] = i;
+    return;
+  }
+  emitErrorBoxAllocation(i, nullptr);
 }
 
 void IRGenSILFunction::visitDeallocExistentialBoxInst(
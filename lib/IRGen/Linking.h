@@ -389,6 +389,22 @@ public:
     return entity;
   }
 
+  static LinkEntity
+  forDependentProtocolWitnessTableGenerator(const ProtocolConformance *C) {
+    LinkEntity entity;
+    entity.setForProtocolConformance(
+             Kind::DependentProtocolWitnessTableGenerator, C);
+    return entity;
+  }
+
+  static LinkEntity
+  forDependentProtocolWitnessTableTemplate(const ProtocolConformance *C) {
+    LinkEntity entity;
+    entity.setForProtocolConformance(
+             Kind::DependentProtocolWitnessTableTemplate, C);
+    return entity;
+  }
+
   static LinkEntity
   forProtocolWitnessTableLazyAccessFunction(const ProtocolConformance *C,
                                             CanType type) {
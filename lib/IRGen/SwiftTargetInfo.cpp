@@ -116,10 +116,12 @@ SwiftTargetInfo SwiftTargetInfo::get(IRGenModule &IGM) {
   SwiftTargetInfo target(triple.getObjectFormat(), pointerSize);
   
   // On Apple platforms, we implement "once" using dispatch_once, which exposes
-  // -1 as ABI for the "done" value.
-  if (triple.isOSDarwin())
-    target.OnceDonePredicateValue = -1L;
-  // TODO: Do we know this for Linux?
+  // -1 as ABI for the "done" value. The runtime uses the same value elsewhere,
+  // but doesn't make the initialization visible to other threads the way
+  // dispatch_once does, so the inline check needs to be an acquire.
+  target.OnceDonePredicateValue = -1L;
+  if (!triple.isOSDarwin())
+    target.OnceDoneCheckNeedsAcquire = true;
   
   switch (triple.getArch()) {
   case llvm::Triple::x86_64:
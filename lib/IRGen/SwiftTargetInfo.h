@@ -87,6 +87,11 @@ public:
   /// The value stored in a Builtin.once predicate to indicate that an
   /// initialization has already happened, if known.
   Optional<int64_t> OnceDonePredicateValue = None;
+
+  /// Whether the inline check of the "done" value needs to be an acquire
+  /// load, because the runtime doesn't otherwise order the initialization
+  /// before it.
+  bool OnceDoneCheckNeedsAcquire = false;
 };
 
 }
@@ -27,14 +27,21 @@
 #include "swift/Frontend/Frontend.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/Basic/LLVM.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
 #include <dlfcn.h>
@@ -273,6 +280,93 @@ bool swift::immediate::IRGenImportedModules(
   return hadError;
 }
 
+namespace {
+/// \brief Keeps the object files MCJIT produces in a directory, so that
+/// running an unchanged script again skips LLVM code generation.
+///
+/// Objects are keyed on a hash of the module's bitcode and the target
+/// configuration it is compiled for. The bitcode already reflects the source
+/// and every option that affects IRGen, so no other invalidation is needed.
+class ImmediateObjectCache : public llvm::ObjectCache {
+  std::string CacheDirectory;
+  llvm::hash_code TargetHash;
+  llvm::DenseMap<const llvm::Module *, std::string> ObjectPaths;
+
+  /// Compute the path of the cached object for \p M.
+  StringRef getObjectPath(const llvm::Module *M) {
+    auto &path = ObjectPaths[M];
+    if (!path.empty())
+      return path;
+
+    SmallString<0> bitcode;
+    {
+      llvm::raw_svector_ostream OS(bitcode);
+      llvm::WriteBitcodeToFile(M, OS);
+    }
+    auto hash = llvm::hash_combine(TargetHash,
+                                   llvm::hash_value(bitcode.str()));
+
+    // cacheDirectory/ModuleName-<hash of bitcode and target>.o
+    SmallString<128> name(CacheDirectory);
+    llvm::sys::path::append(name, M->getModuleIdentifier());
+    SmallString<16> hashStr;
+    llvm::APInt(64, uint64_t(hash)).toStringUnsigned(hashStr, /*Radix*/ 36);
+    name += "-";
+    name += hashStr;
+    name += ".o";
+    path = name.str();
+    return path;
+  }
+
+public:
+  ImmediateObjectCache(StringRef cacheDirectory, StringRef CPU,
+                       ArrayRef<std::string> features)
+    : CacheDirectory(cacheDirectory),
+      TargetHash(llvm::hash_combine(
+          CPU, llvm::hash_combine_range(features.begin(), features.end()))) {}
+
+  void notifyObjectCompiled(const llvm::Module *M,
+                            llvm::MemoryBufferRef Obj) override {
+    // Failing to write the cache only costs the next run some time, so
+    // errors are deliberately ignored.
+    if (llvm::sys::fs::create_directories(CacheDirectory))
+      return;
+
+    StringRef name = getObjectPath(M);
+    SmallString<128> tmpName(name);
+    tmpName += "-%%%%%%";
+    int tmpFD;
+    if (llvm::sys::fs::createUniqueFile(tmpName.str(), tmpFD, tmpName))
+      return;
+
+    {
+      llvm::raw_fd_ostream out(tmpFD, /*shouldClose=*/true);
+      out.write(Obj.getBufferStart(), Obj.getBufferSize());
+      out.flush();
+      if (out.has_error()) {
+        out.clear_error();
+        llvm::sys::fs::remove(tmpName.str());
+        return;
+      }
+    }
+
+    // Atomically rename the file into its final location.
+    if (llvm::sys::fs::rename(tmpName.str(), name))
+      llvm::sys::fs::remove(tmpName.str());
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer>
+  getObject(const llvm::Module *M) override {
+    auto bufferOrErr = llvm::MemoryBuffer::getFile(getObjectPath(M));
+    if (!bufferOrErr)
+      return nullptr;
+    DEBUG(llvm::dbgs() << "Using cached object for "
+                       << M->getModuleIdentifier() << '\n');
+    return std::move(*bufferOrErr);
+  }
+};
+} // end anonymous namespace
+
 int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                           IRGenOptions &IRGenOpts, const SILOptions &SILOpts) {
   ASTContext &Context = CI.getASTContext();
@@ -325,6 +419,16 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
     return -1;
   }
 
+  // Reuse the object code from an earlier run of the same script.
+  std::unique_ptr<ImmediateObjectCache> ObjectCache;
+  StringRef ObjectCachePath =
+      CI.getInvocation().getFrontendOptions().ImmediateObjectCachePath;
+  if (!ObjectCachePath.empty()) {
+    ObjectCache.reset(new ImmediateObjectCache(ObjectCachePath, CPU,
+                                               Features));
+    EE->setObjectCache(ObjectCache.get());
+  }
+
   DEBUG(llvm::dbgs() << "Module to be executed:\n";
         Module->dump());
 
@@ -64,6 +64,33 @@ STATISTIC(NumUnknownRetainReleaseSRed,
 llvm::cl::opt<bool>
 DisableARCOpts("disable-llvm-arc-opts", llvm::cl::init(false));
 
+/// The maximum number of blocks that retain and release motion will follow
+/// along straight-line edges before giving up.
+static llvm::cl::opt<unsigned>
+MaxARCMotionBlocks("llvm-arc-opts-max-motion-blocks", llvm::cl::init(8));
+
+/// If \p BB unconditionally branches to a block whose only predecessor is
+/// \p BB, return that block. Control flow between the two is then
+/// straight-line, and retains and releases can be moved across the edge as if
+/// it were not there.
+static BasicBlock *getStraightLineSuccessor(BasicBlock &BB) {
+  auto *Br = dyn_cast<BranchInst>(BB.getTerminator());
+  if (!Br || Br->isConditional())
+    return nullptr;
+  BasicBlock *Succ = Br->getSuccessor(0);
+  if (Succ == &BB || Succ->getSinglePredecessor() != &BB)
+    return nullptr;
+  return Succ;
+}
+
+/// The inverse of getStraightLineSuccessor.
+static BasicBlock *getStraightLinePredecessor(BasicBlock &BB) {
+  BasicBlock *Pred = BB.getSinglePredecessor();
+  if (!Pred || getStraightLineSuccessor(*Pred) != &BB)
+    return nullptr;
+  return Pred;
+}
+
 //===----------------------------------------------------------------------===//
 //                          Input Function Canonicalizer
 //===----------------------------------------------------------------------===//
@@ -251,16 +278,30 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
 /// moving it earlier in the function if possible, over instructions that do not
 /// access the released object.  If we get to a retain or allocation of the
 /// object, zap both.
+///
+/// The scan continues into the predecessor when the top of a block is reached
+/// and the edge into it is straight-line, which catches pairs that inlining
+/// left in separate blocks.
 static bool performLocalReleaseMotion(CallInst &Release, BasicBlock &BB,
                                       SwiftRCIdentity *RC) {
   // FIXME: Call classifier should identify the object for us.  Too bad C++
   // doesn't have nice Swift-style enums.
   Value *ReleasedObject = RC->getSwiftRCIdentityRoot(Release.getArgOperand(0));
 
+  BasicBlock *CurBB = &BB;
   BasicBlock::iterator BBI = Release.getIterator();
+  unsigned NumBlocksScanned = 0;
 
-  // Scan until we get to the top of the block.
-  while (BBI != BB.begin()) {
+  // Scan until we get to the top of the straight-line region.
+  while (true) {
+    if (BBI == CurBB->begin()) {
+      BasicBlock *Pred = getStraightLinePredecessor(*CurBB);
+      if (!Pred || ++NumBlocksScanned > MaxARCMotionBlocks)
+        break;
+      CurBB = Pred;
+      BBI = Pred->getTerminator()->getIterator();
+      continue;
+    }
     --BBI;
 
     // Don't analyze PHI nodes.  We can't move retains before them and they
@@ -383,7 +424,6 @@ OutOfLoop:
 
   // If we got to the top of the block, (and if the instruction didn't start
   // there) move the release to the top of the block.
-  // TODO: This is where we'd plug in some global algorithms someday.
   if (&*BBI != &Release) {
     Release.moveBefore(&*BBI);
     return true;
@@ -401,6 +441,9 @@ OutOfLoop:
 /// later in the function if possible, over instructions that provably can't
 /// release the object.  If we get to a release of the object, zap both.
 ///
+/// Like release motion, the scan follows straight-line edges into successor
+/// blocks.
+///
 /// NOTE: this handles both objc_retain and swift_retain.
 ///
 static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
@@ -409,15 +452,25 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
   // doesn't have nice Swift-style enums.
   Value *RetainedObject = RC->getSwiftRCIdentityRoot(Retain.getArgOperand(0));
 
-  BasicBlock::iterator BBI = Retain.getIterator(),
-                       BBE = BB.getTerminator()->getIterator();
+  BasicBlock *CurBB = &BB;
+  BasicBlock::iterator BBI = Retain.getIterator();
+  unsigned NumBlocksScanned = 0;
 
   bool isObjCRetain = Retain.getCalledFunction()->getName() == "objc_retain";
 
   bool MadeProgress = false;
 
-  // Scan until we get to the end of the block.
-  for (++BBI; BBI != BBE; ++BBI) {
+  // Scan until we get to the end of the straight-line region, following
+  // unconditional branches into blocks that have no other predecessors.
+  for (++BBI; ; ++BBI) {
+    while (&*BBI == CurBB->getTerminator()) {
+      BasicBlock *Succ = getStraightLineSuccessor(*CurBB);
+      if (!Succ || ++NumBlocksScanned > MaxARCMotionBlocks)
+        goto OutOfLoop;
+      CurBB = Succ;
+      BBI = Succ->getFirstNonPHI()->getIterator();
+    }
+
     Instruction &CurInst = *BBI;
 
     // Classify the instruction. This switch does a "break" when the instruction
@@ -505,7 +558,6 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
 OutOfLoop:
 
   // If we were able to move the retain down, move it now.
-  // TODO: This is where we'd plug in some global algorithms someday.
   if (MadeProgress) {
     Retain.moveBefore(&*BBI);
     return true;
@@ -0,0 +1,170 @@
+//===--- LLVMProfileCounterPromotion.cpp - Keep loop counters in registers ===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The lowered form of llvm.instrprof.increment is a load, add and store of a
+// global counter, executed every time the region runs. Inside a loop that
+// means a store to shared memory on every iteration, which is slow and makes
+// threads that run the same code fight over the counters' cache lines.
+//
+// Nothing but the instrumentation ever touches the counters, so their updates
+// can be accumulated in a register while the loop runs and added to the
+// counter once on each exit from the loop, whatever else the loop does.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "swift-profile-counter-promotion"
+#include "swift/LLVMPasses/Passes.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Pass.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/PromoteMemToReg.h"
+
+using namespace llvm;
+using namespace swift;
+
+STATISTIC(NumCounterUpdatesPromoted,
+          "Number of profile counter updates moved out of loops");
+
+//===----------------------------------------------------------------------===//
+//                     SwiftProfileCounterPromotion Pass
+//===----------------------------------------------------------------------===//
+
+char SwiftProfileCounterPromotion::ID = 0;
+
+INITIALIZE_PASS_BEGIN(SwiftProfileCounterPromotion,
+                      "swift-profile-counter-promotion",
+                      "Swift profile counter promotion pass", false, false)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_END(SwiftProfileCounterPromotion,
+                    "swift-profile-counter-promotion",
+                    "Swift profile counter promotion pass", false, false)
+
+llvm::FunctionPass *swift::createSwiftProfileCounterPromotionPass() {
+  initializeSwiftProfileCounterPromotionPass(
+      *llvm::PassRegistry::getPassRegistry());
+  return new SwiftProfileCounterPromotion();
+}
+
+void SwiftProfileCounterPromotion::getAnalysisUsage(
+    llvm::AnalysisUsage &AU) const {
+  AU.addRequiredID(LoopSimplifyID);
+  AU.addRequired<DominatorTreeWrapperPass>();
+  AU.addRequired<LoopInfoWrapperPass>();
+}
+
+/// If \p SI stores a lowered profile counter increment, returns the address
+/// of the counter.
+static Value *getIncrementedCounter(StoreInst *SI) {
+  if (!SI->isSimple())
+    return nullptr;
+
+  Value *Addr = SI->getPointerOperand();
+  auto *GEP = dyn_cast<GEPOperator>(Addr);
+  if (!GEP)
+    return nullptr;
+  auto *Counters = dyn_cast<GlobalVariable>(GEP->getPointerOperand());
+  if (!Counters ||
+      Counters->getSection().find("llvm_prf_cnts") == StringRef::npos)
+    return nullptr;
+
+  auto *Add = dyn_cast<BinaryOperator>(SI->getValueOperand());
+  if (!Add || Add->getOpcode() != Instruction::Add || !Add->hasOneUse())
+    return nullptr;
+  auto *Load = dyn_cast<LoadInst>(Add->getOperand(0));
+  if (!Load || !Load->isSimple() || !Load->hasOneUse() ||
+      Load->getPointerOperand() != Addr)
+    return nullptr;
+
+  return Addr;
+}
+
+/// Accumulate the counter updates in \p L in local variables, and add them to
+/// the counters on the loop's exits. Adds the local variables to \p Locals.
+static void promoteCounterUpdates(Function &F, Loop *L,
+                                  SmallVectorImpl<AllocaInst *> &Locals) {
+  SmallVector<BasicBlock *, 4> ExitBlocks;
+  L->getUniqueExitBlocks(ExitBlocks);
+
+  BasicBlock *Preheader = L->getLoopPreheader();
+  bool CanPromote = Preheader && L->hasDedicatedExits() &&
+                    std::none_of(ExitBlocks.begin(), ExitBlocks.end(),
+                                 [](BasicBlock *BB) { return BB->isEHPad(); });
+  if (!CanPromote) {
+    // An inner loop may still be in a suitable form.
+    for (Loop *SubLoop : *L)
+      promoteCounterUpdates(F, SubLoop, Locals);
+    return;
+  }
+
+  MapVector<Value *, SmallVector<StoreInst *, 2>> Updates;
+  for (BasicBlock *BB : L->blocks())
+    for (Instruction &I : *BB)
+      if (auto *SI = dyn_cast<StoreInst>(&I))
+        if (Value *Counter = getIncrementedCounter(SI))
+          Updates[Counter].push_back(SI);
+
+  for (auto &Entry : Updates) {
+    Value *Counter = Entry.first;
+    Type *CountTy = cast<PointerType>(Counter->getType())->getElementType();
+
+    auto *Local = new AllocaInst(CountTy, "pgocount.promoted",
+                                 &*F.getEntryBlock().begin());
+    new StoreInst(Constant::getNullValue(CountTy), Local,
+                  Preheader->getTerminator());
+
+    for (StoreInst *SI : Entry.second) {
+      auto *Load = cast<LoadInst>(
+          cast<BinaryOperator>(SI->getValueOperand())->getOperand(0));
+      Load->setOperand(Load->getPointerOperandIndex(), Local);
+      SI->setOperand(SI->getPointerOperandIndex(), Local);
+      ++NumCounterUpdatesPromoted;
+    }
+
+    for (BasicBlock *Exit : ExitBlocks) {
+      IRBuilder<> B(&*Exit->getFirstInsertionPt());
+      Value *Count = B.CreateLoad(Local);
+      Value *Total = B.CreateAdd(B.CreateLoad(Counter, "pgocount"), Count);
+      B.CreateStore(Total, Counter);
+    }
+
+    Locals.push_back(Local);
+  }
+}
+
+bool SwiftProfileCounterPromotion::runOnFunction(Function &F) {
+  auto &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+
+  // Promote to the outermost loop possible, so that a loop nest only stores
+  // each counter once.
+  SmallVector<AllocaInst *, 8> Locals;
+  for (Loop *L : LI)
+    promoteCounterUpdates(F, L, Locals);
+
+  if (Locals.empty())
+    return false;
+
+  PromoteMemToReg(Locals, DT);
+  return true;
+}
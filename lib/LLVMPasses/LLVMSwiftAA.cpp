@@ -13,7 +13,9 @@
 #include "swift/LLVMPasses/Passes.h"
 #include "LLVMARCOpts.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/LegacyPassManager.h" 
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 
 using namespace llvm;
@@ -53,7 +55,27 @@ llvm::ModRefInfo SwiftAAResult::getModRefInfo(llvm::ImmutableCallSite CS,
     break;
   }
 
-  return AAResultBase::getModRefInfo(CS, Loc);
+  auto Result = AAResultBase::getModRefInfo(CS, Loc);
+
+  // A `let` property of an initialized class instance can't be modified by a
+  // call. Freshly allocated instances are excluded, since they may still be
+  // initialized by a callee.
+  if (Loc.AATags.TBAA &&
+      Loc.AATags.TBAA == getImmutablePropertyTBAATag(Loc.Ptr->getContext())) {
+    auto &DL = CS.getInstruction()->getModule()->getDataLayout();
+    if (!isNoAliasCall(GetUnderlyingObject(Loc.Ptr, DL)))
+      Result = ModRefInfo(Result & MRI_Ref);
+  }
+
+  return Result;
+}
+
+llvm::MDNode *swift::getImmutablePropertyTBAATag(llvm::LLVMContext &Ctx) {
+  // Metadata nodes are uniqued, so every call returns the same tag.
+  llvm::MDBuilder MDB(Ctx);
+  auto *Root = MDB.createTBAARoot("Swift TBAA");
+  auto *Ty = MDB.createTBAAScalarTypeNode("Swift immutable property", Root);
+  return MDB.createTBAAStructTagNode(Ty, Ty, 0);
 }
 
 //===----------------------------------------------------------------------===//
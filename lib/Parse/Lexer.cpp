@@ -28,6 +28,10 @@
 // FIXME: Figure out if this can be migrated to LLVM.
 #include "clang/Basic/CharInfo.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using namespace swift;
 
 // clang::isIdentifierHead and clang::isIdentifierBody are deliberately not in
@@ -298,8 +302,104 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
       .fixItRemoveChars(NulLoc, NulEndLoc);
 }
 
+//===----------------------------------------------------------------------===//
+// Fast paths for scanning runs of plain ASCII text
+//===----------------------------------------------------------------------===//
+//
+// Each of these returns the first byte in [Ptr, End) that the caller has to
+// look at more closely, or End. Where SSE2 is available they test sixteen
+// bytes at a time; bytes with the high bit set are always returned, so that
+// the caller can validate them as UTF-8.
+
+#ifdef __SSE2__
+/// Returns a mask with a bit set for each byte in \p Chunk equal to \p C.
+static unsigned matchBytes(__m128i Chunk, char C) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(Chunk, _mm_set1_epi8(C)));
+}
+
+static __m128i loadChunk(const char *Ptr) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+}
+#endif
+
+/// Skips the text of a // comment, stopping at newlines, nuls and non-ASCII
+/// characters.
+static const char *skipLineCommentText(const char *Ptr, const char *End) {
+#ifdef __SSE2__
+  while (End - Ptr >= 16) {
+    __m128i Chunk = loadChunk(Ptr);
+    unsigned Mask = matchBytes(Chunk, '\n') | matchBytes(Chunk, '\r') |
+                    matchBytes(Chunk, 0) | _mm_movemask_epi8(Chunk);
+    if (Mask)
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+#endif
+  while (Ptr != End && *Ptr != '\n' && *Ptr != '\r' && *Ptr != 0 &&
+         (signed char)*Ptr >= 0)
+    ++Ptr;
+  return Ptr;
+}
+
+/// Skips the text of a /* comment, stopping at characters that may start or
+/// end a nested comment, nuls and non-ASCII characters. \p SawNewline is set
+/// if a newline was skipped.
+static const char *skipBlockCommentText(const char *Ptr, const char *End,
+                                        bool &SawNewline) {
+#ifdef __SSE2__
+  while (End - Ptr >= 16) {
+    __m128i Chunk = loadChunk(Ptr);
+    unsigned Mask = matchBytes(Chunk, '*') | matchBytes(Chunk, '/') |
+                    matchBytes(Chunk, 0) | _mm_movemask_epi8(Chunk);
+    unsigned Newlines = matchBytes(Chunk, '\n') | matchBytes(Chunk, '\r');
+    if (Mask) {
+      unsigned Offset = llvm::countTrailingZeros(Mask);
+      if (Newlines & ((1U << Offset) - 1))
+        SawNewline = true;
+      return Ptr + Offset;
+    }
+    if (Newlines)
+      SawNewline = true;
+    Ptr += 16;
+  }
+#endif
+  for (; Ptr != End; ++Ptr) {
+    char C = *Ptr;
+    if (C == '*' || C == '/' || C == 0 || (signed char)C < 0)
+      break;
+    if (C == '\n' || C == '\r')
+      SawNewline = true;
+  }
+  return Ptr;
+}
+
+/// Skips the body of a string literal, stopping at quotes, backslashes,
+/// and characters that are not printable ASCII.
+static const char *skipStringLiteralText(const char *Ptr, const char *End) {
+#ifdef __SSE2__
+  while (End - Ptr >= 16) {
+    __m128i Chunk = loadChunk(Ptr);
+    // Signed comparisons, so that non-ASCII bytes are never printable.
+    __m128i Printable =
+      _mm_and_si128(_mm_cmpgt_epi8(Chunk, _mm_set1_epi8(0x1F)),
+                    _mm_cmplt_epi8(Chunk, _mm_set1_epi8(0x7F)));
+    unsigned Mask = (~_mm_movemask_epi8(Printable) & 0xFFFF) |
+                    matchBytes(Chunk, '"') | matchBytes(Chunk, '\'') |
+                    matchBytes(Chunk, '\\');
+    if (Mask)
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+#endif
+  while (Ptr != End && isPrintable(*Ptr) && *Ptr != '"' && *Ptr != '\'' &&
+         *Ptr != '\\')
+    ++Ptr;
+  return Ptr;
+}
+
 void Lexer::skipToEndOfLine() {
   while (1) {
+    CurPtr = skipLineCommentText(CurPtr, BufferEnd);
     switch (*CurPtr++) {
     case '\n':
     case '\r':
@@ -353,6 +453,11 @@ void Lexer::skipSlashStarComment() {
   unsigned Depth = 1;
   
   while (1) {
+    bool SawNewline = false;
+    CurPtr = skipBlockCommentText(CurPtr, BufferEnd, SawNewline);
+    if (SawNewline)
+      NextToken.setAtStartOfLine(true);
+
     switch (*CurPtr++) {
     case '*':
       // Check for a '*/'
@@ -548,8 +653,11 @@ void Lexer::lexIdentifier() {
   assert(didStart && "Unexpected start");
   (void) didStart;
 
-  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*
-  while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
+  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*, without decoding ASCII characters.
+  do {
+    while (clang::isIdentifierBody(*CurPtr, /*dollar*/true))
+      ++CurPtr;
+  } while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
 
   tok Kind = kindOfIdentifier(StringRef(TokStart, CurPtr-TokStart), InSILMode);
   return formToken(Kind, TokStart);
@@ -1129,6 +1237,9 @@ void Lexer::lexStringLiteral() {
   bool wasErroneous = false;
   
   while (true) {
+    // Most of a string literal is plain text that needs no processing.
+    CurPtr = skipStringLiteralText(CurPtr, BufferEnd);
+
     if (*CurPtr == '\\' && *(CurPtr + 1) == '(') {
       // Consume tokens until we hit the corresponding ')'.
       CurPtr += 2;
@@ -1372,11 +1483,15 @@ void Lexer::getStringLiteralSegments(
   // range check subscripting on the StringRef.
   const char *SegmentStartPtr = Bytes.begin();
   const char *BytesPtr = SegmentStartPtr;
-  // FIXME: Use SSE to scan for '\'.
   while (BytesPtr != Bytes.end()) {
-    char CurChar = *BytesPtr++;
-    if (CurChar != '\\')
-      continue;
+    // Skip to the next backslash.
+    BytesPtr = static_cast<const char *>(
+      memchr(BytesPtr, '\\', Bytes.end() - BytesPtr));
+    if (!BytesPtr) {
+      BytesPtr = Bytes.end();
+      break;
+    }
+    ++BytesPtr;
 
     if (*BytesPtr++ != '(')
       continue;
@@ -1491,6 +1606,9 @@ Restart:
   case '\t':
   case '\f':
   case '\v':
+    // Skip the rest of the run at once.
+    while (isHorizontalWhitespace(*CurPtr))
+      ++CurPtr;
     goto Restart;  // Skip whitespace.
 
   case -1:
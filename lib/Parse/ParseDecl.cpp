@@ -184,15 +184,22 @@ namespace {
   struct IgnorePrivateDeclTokens {
     Parser &TheParser;
     DeclAttributes &Attributes;
-    Optional<llvm::MD5> SavedHashState;
+    Optional<SourceFile::InterfaceHashState> SavedHashState;
+
+    /// The parsed declaration, if any.
+    Decl *Result = nullptr;
 
     IgnorePrivateDeclTokens(Parser &P, DeclAttributes &Attrs)
       : TheParser(P), Attributes(Attrs) {
       // NOTE: It's generally not safe to ignore private decls in nominal
       // types. Such private decls may affect the data layout of a class/struct
-      // or the vtable layout of a class. So only ignore global private decls.
-      if (TheParser.IsParsingInterfaceTokens &&
-          TheParser.CurDeclContext->isModuleScopeContext()) {
+      // or the vtable layout of a class. So only ignore global private decls,
+      // and private methods of structs and enums (see below).
+      if (!TheParser.IsParsingInterfaceTokens)
+        return;
+      auto *DC = TheParser.CurDeclContext;
+      if (DC->isModuleScopeContext() || isa<StructDecl>(DC) ||
+          isa<EnumDecl>(DC)) {
         SavedHashState = TheParser.SF.getInterfaceHashState();
       }
     }
@@ -201,6 +208,13 @@ namespace {
       if (!SavedHashState)
         return;
 
+      // A method of a struct or enum doesn't affect its layout.
+      if (!TheParser.CurDeclContext->isModuleScopeContext()) {
+        auto *FD = dyn_cast_or_null<FuncDecl>(Result);
+        if (!FD || FD->isAccessor())
+          return;
+      }
+
       if (auto *attr = Attributes.getAttribute<AbstractAccessibilityAttr>()) {
         if (attr->getAccess() == Accessibility::Private) {
           TheParser.SF.setInterfaceHashState(*SavedHashState);
@@ -210,6 +224,46 @@ namespace {
   };
 }
 
+namespace {
+  /// An RAII type to hash the interface tokens of a single declaration at
+  /// module scope or in the body of a type or extension, so that dependencies
+  /// can be tracked per declaration. On destruct, the hash is recorded for
+  /// every declaration parsed in the meantime.
+  ///
+  /// This is only done for files whose dependencies are being tracked.
+  struct RecordDeclInterfaceHash {
+    Parser &TheParser;
+    SmallVectorImpl<Decl *> &Entries;
+    size_t FirstEntry;
+    bool Active = false;
+
+    /// A parsed declaration that may not have been added to \c Entries.
+    Decl *Result = nullptr;
+
+    RecordDeclInterfaceHash(Parser &P, SmallVectorImpl<Decl *> &Entries)
+      : TheParser(P), Entries(Entries), FirstEntry(Entries.size()) {
+      if (!TheParser.IsParsingInterfaceTokens ||
+          !TheParser.SF.getReferencedNameTracker())
+        return;
+      if (!TheParser.CurDeclContext->isModuleScopeContext() &&
+          !TheParser.CurDeclContext->isTypeContext())
+        return;
+      TheParser.SF.beginDeclInterfaceHash();
+      Active = true;
+    }
+
+    ~RecordDeclInterfaceHash() {
+      if (!Active)
+        return;
+      SmallVector<Decl *, 4> Decls(Entries.begin() + FirstEntry,
+                                   Entries.end());
+      if (Result)
+        Decls.push_back(Result);
+      TheParser.SF.endDeclInterfaceHash(Decls);
+    }
+  };
+}
+
 /// \brief Main entrypoint for the parser.
 ///
 /// \verbatim
@@ -1771,6 +1825,8 @@ ParserStatus Parser::parseDecl(SmallVectorImpl<Decl*> &Entries,
   if (isCodeCompletionFirstPass())
     BeginParserPosition = getParserPosition();
 
+  RecordDeclInterfaceHash RecordHash(*this, Entries);
+
   SourceLoc tryLoc;
   (void)consumeIf(tok::kw_try, tryLoc);
 
@@ -2050,6 +2106,8 @@ ParserStatus Parser::parseDecl(SmallVectorImpl<Decl*> &Entries,
 
   if (DeclResult.isNonNull()) {
     Decl *D = DeclResult.get();
+    RecordHash.Result = D;
+    IgnoreTokens.Result = D;
     if (!declWasHandledAlready(D))
       Entries.push_back(DeclResult.get());
   }
@@ -13,6 +13,7 @@
 #include "swift/Basic/Fallthrough.h"
 #include "swift/AST/ArchetypeBuilder.h"
 #include "swift/AST/NameLookup.h"
+#include "swift/Basic/CompileTimeTrace.h"
 #include "swift/Parse/Parser.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/SIL/AbstractionPattern.h"
@@ -3668,6 +3669,8 @@ bool Parser::parseDeclSIL() {
       parseIdentifier(FnName, FnNameLoc, diag::expected_sil_function_name) ||
       parseToken(tok::colon, diag::expected_sil_type))
     return true;
+
+  CompileTimeTraceScope traceScope("parse-sil", FnName.str());
   {
     // Construct a Scope for the function body so TypeAliasDecl can be added to
     // the scope.
@@ -3726,13 +3729,9 @@ bool Parser::parseDeclSIL() {
   if (!FunctionState.P.Diags.hadAnyError())
     FunctionState.F->verify();
 
-  // Link the static initializer for global variables.
-  for (SILGlobalVariable &v : FunctionState.SILMod.getSILGlobals()) {
-    if (v.getInitializer())
-      if (FnName.str() == v.getInitializer()->getName())
-        v.setInitializer(FunctionState.F);
-  }
-
+  // Static initializers of global variables need no linking here: a
+  // sil_global that names this function as its initializer created a forward
+  // reference, which getGlobalNameForDefinition completed in place.
   return false;
 }
 
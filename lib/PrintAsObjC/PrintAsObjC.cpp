@@ -28,6 +28,7 @@
 #include "clang/AST/DeclObjC.h"
 #include "clang/Basic/Module.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Path.h"
@@ -85,6 +86,22 @@ static Identifier getNameForObjC(const NominalTypeDecl *NTD,
   return customNamesOnly ? Identifier() : NTD->getName();
 }
 
+/// Partial headers mark the start of each top-level declaration with
+/// "<FragmentMarker> <provided> <required>...", and the end of the last one
+/// with EndOfFragmentsMarker.
+static const StringRef FragmentMarker = "// @swift-objc-fragment ";
+static const StringRef EndOfFragmentsMarker = "// @swift-objc-end\n";
+
+/// Returns the name by which a fragment of a partial header refers to the
+/// definition of \p D.
+static std::string getFragmentKey(const TypeDecl *D) {
+  if (auto CD = dyn_cast<ClassDecl>(D))
+    return ("class:" + getNameForObjC(CD).str()).str();
+  if (auto PD = dyn_cast<ProtocolDecl>(D))
+    return ("protocol:" + getNameForObjC(PD).str()).str();
+  return ("enum:" + D->getName().str()).str();
+}
+
 
 namespace {
 class ObjCPrinter : private DeclVisitor<ObjCPrinter>,
@@ -1302,9 +1319,23 @@ class ModuleWriter {
   Module &M;
   StringRef bridgingHeader;
   ObjCPrinter printer;
+
+  /// If set, only the declarations of this file are written, as a partial
+  /// header.
+  const SourceFile *onlyFile;
+
+  /// The types of this module required by the fragment of the partial header
+  /// currently being written.
+  SmallVector<const TypeDecl *, 4> fragmentRequirements;
+
+  /// The types forward-declared by the fragment of the partial header
+  /// currently being written.
+  llvm::SmallPtrSet<const NominalTypeDecl *, 16> fragmentForwardDecls;
 public:
-  ModuleWriter(Module &mod, StringRef header, Accessibility access)
-    : M(mod), bridgingHeader(header), printer(M, os, access) {}
+  ModuleWriter(Module &mod, StringRef header, Accessibility access,
+               const SourceFile *file)
+    : M(mod), bridgingHeader(header), printer(M, os, access),
+      onlyFile(file) {}
 
   /// Returns true if we added the decl's module to the import set, false if
   /// the decl is a local decl.
@@ -1347,6 +1378,14 @@ public:
       return true;
     }
 
+    if (onlyFile) {
+      // Types from the other files are defined by their own partial headers,
+      // and the merged header puts those definitions first.
+      fragmentRequirements.push_back(D);
+      if (D->getDeclContext()->getModuleScopeContext() != onlyFile)
+        return true;
+    }
+
     auto &state = seenTypes[D];
     switch (state.first) {
     case EmissionState::DefinitionRequested:
@@ -1363,6 +1402,13 @@ public:
                       std::function<void (void)> Printer) {
     if (NTD->getModuleContext()->isStdlibModule())
       return;
+    if (onlyFile) {
+      // The fragments of a partial header may be reordered when the headers
+      // are merged, so each one forward-declares everything it references.
+      if (fragmentForwardDecls.insert(NTD).second)
+        Printer();
+      return;
+    }
     auto &state = seenTypes[NTD];
     if (state.second)
       return;
@@ -1547,7 +1593,7 @@ public:
     return true;
   }
 
-  void writePrologue(raw_ostream &out) {
+  static void writePrologue(raw_ostream &out) {
     out << "// Generated by " << version::getSwiftFullVersion() << "\n"
            "#pragma clang diagnostic push\n"
            "\n"
@@ -1672,8 +1718,30 @@ public:
     return import == importer->getImportedHeaderModule();
   }
 
-  void writeImports(raw_ostream &out) {
+  /// Writes the \c \@import lines \p moduleImports and the \c \#import lines
+  /// \p headerImports.
+  static void writeImportLines(raw_ostream &out,
+                               ArrayRef<std::string> moduleImports,
+                               ArrayRef<std::string> headerImports) {
     out << "#if defined(__has_feature) && __has_feature(modules)\n";
+    for (auto &line : moduleImports)
+      out << line << "\n";
+    out << "#endif\n\n";
+
+    for (auto &line : headerImports)
+      out << line << "\n";
+    if (!headerImports.empty())
+      out << "\n";
+  }
+
+  static void writeDiagnosticPragmas(raw_ostream &out) {
+    out <<
+        "#pragma clang diagnostic ignored \"-Wproperty-attribute-mismatch\"\n"
+        "#pragma clang diagnostic ignored \"-Wduplicate-method-arg\"\n";
+  }
+
+  void writeImports(raw_ostream &out) {
+    std::vector<std::string> moduleImports;
 
     // Track printed names to handle overlay modules.
     llvm::SmallPtrSet<Identifier, 8> seenImports;
@@ -1686,10 +1754,12 @@ public:
           continue;
         }
         if (seenImports.insert(Name).second)
-          out << "@import " << Name.str() << ";\n";
+          moduleImports.push_back(("@import " + Name.str() + ";").str());
       } else {
         const auto *clangModule = import.get<const clang::Module *>();
-        out << "@import ";
+        std::string line;
+        llvm::raw_string_ostream lineOS(line);
+        lineOS << "@import ";
         // FIXME: This should be an API on clang::Module.
         SmallVector<StringRef, 4> submoduleNames;
         do {
@@ -1697,26 +1767,49 @@ public:
           clangModule = clangModule->Parent;
         } while (clangModule);
         interleave(submoduleNames.rbegin(), submoduleNames.rend(),
-                   [&out](StringRef next) { out << next; },
-                   [&out] { out << "."; });
-        out << ";\n";
+                   [&lineOS](StringRef next) { lineOS << next; },
+                   [&lineOS] { lineOS << "."; });
+        lineOS << ";";
+        moduleImports.push_back(lineOS.str());
       }
     }
 
-    out << "#endif\n\n";
-
+    std::vector<std::string> headerImports;
     if (includeUnderlying) {
       if (bridgingHeader.empty())
-        out << "#import <" << M.getName().str() << '/' << M.getName().str()
-            << ".h>\n\n";
+        headerImports.push_back(("#import <" + M.getName().str() + "/" +
+                                 M.getName().str() + ".h>").str());
       else
-        out << "#import \"" << bridgingHeader << "\"\n\n";
+        headerImports.push_back(("#import \"" + bridgingHeader + "\"").str());
     }
+
+    writeImportLines(out, moduleImports, headerImports);
+  }
+
+  /// Marks the text written to \c os since \p start as the fragment of a
+  /// partial header defining \p D.
+  void markFragment(const Decl *D, size_t start) {
+    std::string marker;
+    llvm::raw_string_ostream markerOS(marker);
+    markerOS << FragmentMarker;
+    if (auto TD = dyn_cast<TypeDecl>(D))
+      markerOS << getFragmentKey(TD);
+    else
+      markerOS << "-";
+    for (auto required : fragmentRequirements)
+      markerOS << " " << getFragmentKey(required);
+    markerOS << "\n";
+
+    os.flush();
+    bodyBuffer.insert(start, markerOS.str());
   }
 
   bool writeToStream(raw_ostream &out) {
     SmallVector<Decl *, 64> decls;
-    M.getTopLevelDecls(decls);
+    if (onlyFile)
+      onlyFile->getTopLevelDecls(decls);
+    else
+      M.getTopLevelDecls(decls);
 
     auto newEnd = std::remove_if(decls.begin(), decls.end(),
                                  [this](const Decl *D) -> bool {
@@ -1805,6 +1898,13 @@ public:
       const Decl *D = declsToWrite.back();
       bool success = true;
 
+      size_t fragmentStart = 0;
+      if (onlyFile) {
+        fragmentRequirements.clear();
+        fragmentForwardDecls.clear();
+        fragmentStart = os.str().size();
+      }
+
       if (isa<ValueDecl>(D)) {
         if (auto CD = dyn_cast<ClassDecl>(D))
           success = writeClass(CD);
@@ -1824,6 +1924,8 @@ public:
 
       if (success) {
         assert(declsToWrite.back() == D);
+        if (onlyFile && os.str().size() != fragmentStart)
+          markFragment(D, fragmentStart);
         os << "\n";
         declsToWrite.pop_back();
       }
@@ -1831,19 +1933,139 @@ public:
 
     writePrologue(out);
     writeImports(out);
-    out <<
-        "#pragma clang diagnostic ignored \"-Wproperty-attribute-mismatch\"\n"
-        "#pragma clang diagnostic ignored \"-Wduplicate-method-arg\"\n"
-      << os.str()
-      << "#pragma clang diagnostic pop\n";
+    writeDiagnosticPragmas(out);
+    out << os.str();
+    if (onlyFile)
+      out << EndOfFragmentsMarker;
+    out << "#pragma clang diagnostic pop\n";
     return false;
   }
+
+  static bool mergePartialHeaders(raw_ostream &out,
+                                  ArrayRef<StringRef> partialHeaders);
+};
+
+/// A top-level declaration of a partial header.
+struct HeaderFragment {
+  StringRef provided;
+  SmallVector<StringRef, 4> required;
+  StringRef text;
 };
 }
 
+bool ModuleWriter::mergePartialHeaders(raw_ostream &out,
+                                       ArrayRef<StringRef> partialHeaders) {
+  llvm::SetVector<StringRef> moduleImports;
+  llvm::SetVector<StringRef> headerImports;
+  std::vector<HeaderFragment> fragments;
+  llvm::StringSet<> allProvided;
+
+  for (StringRef header : partialHeaders) {
+    size_t end = header.find(EndOfFragmentsMarker);
+    if (end == StringRef::npos)
+      return true;
+    size_t begin = header.find(FragmentMarker);
+    if (begin > end)
+      begin = end;
+
+    // Everything before the first fragment is the prologue, which is the same
+    // in every header, and the imports.
+    SmallVector<StringRef, 32> lines;
+    header.slice(0, begin).split(lines, "\n");
+    for (StringRef line : lines) {
+      if (line.startswith("@import "))
+        moduleImports.insert(line);
+      else if (line.startswith("#import "))
+        headerImports.insert(line);
+    }
+
+    StringRef rest = header.slice(begin, end);
+    while (!rest.empty()) {
+      assert(rest.startswith(FragmentMarker));
+      StringRef markerLine;
+      std::tie(markerLine, rest) = rest.split('\n');
+      SmallVector<StringRef, 4> keys;
+      markerLine.drop_front(FragmentMarker.size())
+        .split(keys, " ", /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+      if (keys.empty())
+        return true;
+
+      HeaderFragment fragment;
+      fragment.provided = keys.front();
+      fragment.required.append(keys.begin() + 1, keys.end());
+
+      // The fragment ends at the start of the next marker line.
+      size_t next = rest.find(("\n" + FragmentMarker).str());
+      next = (next == StringRef::npos) ? rest.size() : next + 1;
+      fragment.text = rest.slice(0, next);
+      rest = rest.drop_front(next);
+
+      if (fragment.provided != "-")
+        allProvided.insert(fragment.provided);
+      fragments.push_back(std::move(fragment));
+    }
+  }
+
+  writePrologue(out);
+  writeImportLines(out,
+                   std::vector<std::string>(moduleImports.begin(),
+                                            moduleImports.end()),
+                   std::vector<std::string>(headerImports.begin(),
+                                            headerImports.end()));
+  writeDiagnosticPragmas(out);
+
+  // Write each fragment after the fragments providing its requirements,
+  // keeping the order of the partial headers otherwise.
+  llvm::StringSet<> written;
+  std::vector<bool> isWritten(fragments.size());
+  size_t numWritten = 0;
+  while (numWritten != fragments.size()) {
+    bool madeProgress = false;
+    for (size_t i = 0, e = fragments.size(); i != e; ++i) {
+      if (isWritten[i])
+        continue;
+      auto &fragment = fragments[i];
+      bool ready = std::all_of(fragment.required.begin(),
+                               fragment.required.end(),
+                               [&](StringRef key) {
+        return !allProvided.count(key) || written.count(key);
+      });
+      if (!ready)
+        continue;
+
+      out << fragment.text;
+      if (fragment.provided != "-")
+        written.insert(fragment.provided);
+      isWritten[i] = true;
+      ++numWritten;
+      madeProgress = true;
+    }
+
+    // Requirements can't be circular in a valid module, but don't loop
+    // forever if the headers are inconsistent.
+    if (!madeProgress) {
+      for (size_t i = 0, e = fragments.size(); i != e; ++i)
+        if (!isWritten[i])
+          out << fragments[i].text;
+      break;
+    }
+  }
+
+  out << "#pragma clang diagnostic pop\n";
+  return false;
+}
+
 bool swift::printAsObjC(llvm::raw_ostream &os, Module *M,
                         StringRef bridgingHeader,
-                        Accessibility minRequiredAccess) {
+                        Accessibility minRequiredAccess,
+                        const SourceFile *onlyFile) {
   llvm::PrettyStackTraceString trace("While generating Objective-C header");
-  return ModuleWriter(*M, bridgingHeader, minRequiredAccess).writeToStream(os);
+  return ModuleWriter(*M, bridgingHeader, minRequiredAccess, onlyFile)
+    .writeToStream(os);
+}
+
+bool swift::mergeObjCHeaders(llvm::raw_ostream &os,
+                             ArrayRef<StringRef> partialHeaders) {
+  llvm::PrettyStackTraceString trace("While merging Objective-C headers");
+  return ModuleWriter::mergePartialHeaders(os, partialHeaders);
 }
@@ -13,6 +13,8 @@
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILBasicBlock.h"
 #include "swift/SIL/Dominance.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/GenericDomTree.h"
 #include "llvm/Support/GenericDomTreeConstruction.h"
 
@@ -22,6 +24,148 @@ template class llvm::DominatorTreeBase<SILBasicBlock>;
 template class llvm::DominatorBase<SILBasicBlock>;
 template class llvm::DomTreeNodeBase<SILBasicBlock>;
 
+//===----------------------------------------------------------------------===//
+//                          Incremental Updates
+//===----------------------------------------------------------------------===//
+
+/// Recompute the immediate dominators of the blocks in the subtree rooted at
+/// \p Root, with the Cooper-Harvey-Kennedy iteration.
+///
+/// This is correct when all the edges that changed since the tree was
+/// computed run between blocks of the subtree: every path from the entry to
+/// a block of the subtree then still passes through the root, and no path to
+/// a block outside of the subtree can have changed. If a block of the
+/// subtree became unreachable, the tree is left alone and false is returned.
+static bool recalculateSubtree(DominanceInfo &DT, DominanceInfoNode *Root) {
+  SILBasicBlock *RootBB = Root->getBlock();
+
+  // Collect the old subtree.
+  SmallVector<DominanceInfoNode *, 32> OldNodes;
+  llvm::SmallPtrSet<SILBasicBlock *, 32> InSubtree;
+  OldNodes.push_back(Root);
+  for (unsigned i = 0; i < OldNodes.size(); ++i) {
+    InSubtree.insert(OldNodes[i]->getBlock());
+    OldNodes.append(OldNodes[i]->begin(), OldNodes[i]->end());
+  }
+
+  // Number the blocks reachable from the root in post-order.
+  struct Frame {
+    SILBasicBlock *BB;
+    SILBasicBlock::succ_iterator NextSucc;
+  };
+  SmallVector<SILBasicBlock *, 32> PostOrder;
+  llvm::DenseMap<SILBasicBlock *, unsigned> PostNumber;
+  SmallVector<Frame, 16> Stack;
+  llvm::SmallPtrSet<SILBasicBlock *, 32> Visited;
+  Stack.push_back({RootBB, RootBB->succ_begin()});
+  Visited.insert(RootBB);
+  while (!Stack.empty()) {
+    Frame &Top = Stack.back();
+    if (Top.NextSucc == Top.BB->succ_end()) {
+      PostNumber[Top.BB] = PostOrder.size();
+      PostOrder.push_back(Top.BB);
+      Stack.pop_back();
+      continue;
+    }
+    SILBasicBlock *Succ = (Top.NextSucc++)->getBB();
+    if (!InSubtree.count(Succ) || !Visited.insert(Succ).second)
+      continue;
+    Stack.push_back({Succ, Succ->succ_begin()});
+  }
+  if (PostOrder.size() != OldNodes.size())
+    return false;
+
+  llvm::DenseMap<SILBasicBlock *, SILBasicBlock *> IDom;
+  IDom[RootBB] = RootBB;
+  auto intersect = [&](SILBasicBlock *A, SILBasicBlock *B) {
+    while (A != B) {
+      while (PostNumber[A] < PostNumber[B])
+        A = IDom[A];
+      while (PostNumber[B] < PostNumber[A])
+        B = IDom[B];
+    }
+    return A;
+  };
+
+  // All predecessors of a block in the subtree, except of the root, are in
+  // the subtree themselves.
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (unsigned i = PostOrder.size(); i-- != 0;) {
+      SILBasicBlock *BB = PostOrder[i];
+      if (BB == RootBB)
+        continue;
+      SILBasicBlock *NewIDom = nullptr;
+      for (SILBasicBlock *Pred : BB->getPreds()) {
+        if (!IDom.lookup(Pred))
+          continue;
+        NewIDom = NewIDom ? intersect(Pred, NewIDom) : Pred;
+      }
+      assert(NewIDom && "reachable block without a processed predecessor");
+      if (IDom.lookup(BB) != NewIDom) {
+        IDom[BB] = NewIDom;
+        Changed = true;
+      }
+    }
+  }
+
+  // Re-parent the nodes top-down, so that every new immediate dominator is
+  // already in place.
+  for (unsigned i = PostOrder.size(); i-- != 0;) {
+    SILBasicBlock *BB = PostOrder[i];
+    if (BB == RootBB)
+      continue;
+    auto *Node = DT.getNode(BB);
+    auto *NewIDomNode = DT.getNode(IDom[BB]);
+    if (Node->getIDom() != NewIDomNode)
+      DT.changeImmediateDominator(Node, NewIDomNode);
+  }
+  return true;
+}
+
+void DominanceInfo::changeEdgeTarget(SILBasicBlock *From, SILBasicBlock *OldTo,
+                                     SILBasicBlock *NewTo) {
+  assert(From->isSuccessor(NewTo) && "edge target was not changed yet");
+  if (OldTo == NewTo)
+    return;
+
+  // Edges out of an unreachable block don't change anything.
+  if (!getNode(From))
+    return;
+  assert(getNode(OldTo) && "successor of a reachable block not in the tree");
+
+  SILFunction *F = From->getParent();
+  bool IsNewBlock = !getNode(NewTo);
+  if (IsNewBlock) {
+    // The edge makes the new target reachable. If it is a new block which
+    // only branches to reachable blocks, like a new landing block, add it as
+    // a leaf of the tree. Its own edges are then handled like the changed
+    // edge, since their ends are dominated by the root below.
+    bool IsNewLeaf = NewTo->getSinglePredecessor() == From;
+    for (auto &Succ : NewTo->getSuccessors())
+      IsNewLeaf &= getNode(Succ.getBB()) != nullptr;
+    if (!IsNewLeaf) {
+      recalculate(*F);
+      return;
+    }
+    addNewBlock(NewTo, From);
+  }
+
+  // The removed edge, the added edge and the edges out of a new target all
+  // run between blocks that are dominated by the nearest common dominator of
+  // their ends.
+  SILBasicBlock *Root = findNearestCommonDominator(From, OldTo);
+  if (Root)
+    Root = findNearestCommonDominator(Root, NewTo);
+  if (IsNewBlock)
+    for (auto &Succ : NewTo->getSuccessors())
+      if (Root)
+        Root = findNearestCommonDominator(Root, Succ.getBB());
+  if (!Root || !recalculateSubtree(*this, getNode(Root)))
+    recalculate(*F);
+}
+
 /// Compute the immediate-dominators map.
 DominanceInfo::DominanceInfo(SILFunction *F)
     : DominatorTreeBase(/*isPostDom*/ false) {
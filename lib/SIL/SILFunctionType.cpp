@@ -673,6 +673,22 @@ namespace {
     }
   };
   
+  /// The conventions for ordinary Swift functions when normal parameters are
+  /// passed at +0 (-enable-guaranteed-normal-arguments).
+  struct DefaultGuaranteedConventions : DefaultConventions {
+    using DefaultConventions::DefaultConventions;
+
+    ParameterConvention getIndirectParameter(unsigned index,
+                              const AbstractionPattern &type) const override {
+      return ParameterConvention::Indirect_In_Guaranteed;
+    }
+
+    ParameterConvention getDirectParameter(unsigned index,
+                              const AbstractionPattern &type) const override {
+      return ParameterConvention::Direct_Guaranteed;
+    }
+  };
+
   /// The default conventions for Swift initializing constructors.
   struct DefaultInitializerConventions : DefaultConventions {
     using DefaultConventions::DefaultConventions;
@@ -754,6 +770,15 @@ static CanSILFunctionType getNativeSILFunctionType(SILModule &M,
                                 None);
     
     case SILDeclRef::Kind::Func:
+      // Native entry points of @objc methods keep passing their parameters
+      // at +1; only ordinary functions switch to +0.
+      if (M.getOptions().EnableGuaranteedNormalArguments &&
+          extInfo.getSILRepresentation() !=
+            SILFunctionType::Representation::ObjCMethod)
+        return getSILFunctionType(M, origType, substType, substInterfaceType,
+                                  extInfo, DefaultGuaranteedConventions(),
+                                  None);
+      SWIFT_FALLTHROUGH;
     case SILDeclRef::Kind::Allocator:
     case SILDeclRef::Kind::Destroyer:
     case SILDeclRef::Kind::GlobalAccessor:
@@ -24,6 +24,9 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 #include <functional>
+
+STATISTIC(NumBlocksReused, "Number of basic blocks allocated in reused storage");
+
 using namespace swift;
 using namespace Lowering;
 
@@ -131,6 +134,24 @@ void *SILModule::allocate(unsigned Size, unsigned Align) const {
   return BPA.Allocate(Size, Align);
 }
 
+void *SILModule::allocateBlock(unsigned Size, unsigned Align) {
+  assert(Size == sizeof(SILBasicBlock) && "only blocks are recycled");
+  if (FreeBlockStorage.empty())
+    return allocate(Size, Align);
+  ++NumBlocksReused;
+  void *Storage = FreeBlockStorage.back();
+  FreeBlockStorage.pop_back();
+  return Storage;
+}
+
+void SILModule::deallocateBlock(SILBasicBlock *BB) {
+  if (getASTContext().LangOpts.UseMalloc) {
+    AlignedFree(BB);
+    return;
+  }
+  FreeBlockStorage.push_back(BB);
+}
+
 void *SILModule::allocateInst(unsigned Size, unsigned Align) const {
   return AlignedAlloc(Size, Align);
 }
@@ -328,8 +349,7 @@ SILFunction *SILModule::getOrCreateFunction(SILLocation loc,
                                             SILDeclRef constant,
                                             ForDefinition_t forDefinition) {
 
-  SmallVector<char, 128> buffer;
-  auto name = constant.mangle(buffer);
+  StringRef name = getMangledName(constant);
   auto constantType = Types.getConstantType(constant).castTo<SILFunctionType>();
   SILLinkage linkage = constant.getLinkage(forDefinition);
 
@@ -521,9 +541,21 @@ const BuiltinInfo &SILModule::getBuiltinInfo(Identifier ID) {
 }
 
 SILFunction *SILModule::lookUpFunction(SILDeclRef fnRef) {
-  llvm::SmallString<32> name;
-  fnRef.mangle(name);
-  return lookUpFunction(name);
+  return lookUpFunction(getMangledName(fnRef));
+}
+
+StringRef SILModule::getMangledName(SILDeclRef constant) {
+  auto found = MangledNameCache.find(constant);
+  if (found != MangledNameCache.end())
+    return found->second;
+
+  llvm::SmallString<128> buffer;
+  constant.mangle(buffer);
+  char *name = static_cast<char *>(BPA.Allocate(buffer.size(), 1));
+  std::copy(buffer.begin(), buffer.end(), name);
+  StringRef result(name, buffer.size());
+  MangledNameCache.insert({constant, result});
+  return result;
 }
 
 bool SILModule::linkFunction(SILFunction *Fun, SILModule::LinkingMode Mode) {
@@ -541,6 +573,12 @@ bool SILModule::linkFunction(StringRef Name, SILModule::LinkingMode Mode) {
       .processFunction(Name);
 }
 
+SILFunction *SILModule::linkFunctionDeclaration(StringRef Name) {
+  if (auto *F = lookUpFunction(Name))
+    return F;
+  return getSILLoader()->lookupSILFunctionDeclaration(Name);
+}
+
 void SILModule::linkAllWitnessTables() {
   getSILLoader()->getAllWitnessTables();
 }
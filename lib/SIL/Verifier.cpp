@@ -3031,6 +3031,7 @@ void SILFunction::verify() const {
   // ensures that the pretty stack trace in the verifier is included with the
   // back trace when the verifier crashes.
   SILVerifier(*this).verify();
+  VerifiedEpoch = ModificationEpoch;
 #endif
 }
 
@@ -3125,7 +3126,7 @@ void SILGlobalVariable::verify() const {
 }
 
 /// Verify the module.
-void SILModule::verify() const {
+void SILModule::verify(bool OnlyModifiedFunctions) const {
 #ifndef NDEBUG
   // Uniquing set to catch symbol name collisions.
   llvm::StringSet<> symbolNames;
@@ -3136,6 +3137,8 @@ void SILModule::verify() const {
       llvm::errs() << "Symbol redefined: " << f.getName() << "!\n";
       assert(false && "triggering standard assertion failure routine");
     }
+    if (OnlyModifiedFunctions && f.isVerifiedUpToDate())
+      continue;
     f.verify();
   }
 
@@ -38,6 +38,17 @@ using namespace Lowering;
 SILGenModule::SILGenModule(SILModule &M, Module *SM, bool makeModuleFragile)
   : M(M), Types(M.Types), SwiftModule(SM), TopLevelSGF(nullptr),
     Profiler(nullptr), makeModuleFragile(makeModuleFragile) {
+  const auto &ProfilePath = M.getOptions().UseProfile;
+  if (ProfilePath.empty())
+    return;
+
+  auto ReaderOrErr = llvm::IndexedInstrProfReader::create(ProfilePath);
+  if (auto EC = ReaderOrErr.getError()) {
+    diagnose(SourceLoc(), diag::error_reading_profile, ProfilePath,
+             EC.message());
+    return;
+  }
+  ProfileReader = std::move(ReaderOrErr.get());
 }
 
 SILGenModule::~SILGenModule() {
@@ -1145,6 +1156,82 @@ void SILGenModule::emitSourceFile(SourceFile *sf, unsigned startElem) {
     visit(D);
 }
 
+bool SILGenModule::isNonOverriddenClassMethod(AbstractFunctionDecl *method) {
+  // Only optimized builds give up the vtable dispatch.
+  if (M.getOptions().Optimization < SILOptions::SILOptMode::Optimize)
+    return false;
+
+  // Accessors are dispatched along with their storage, and initializers
+  // along with their initializer chains; leave them alone.
+  auto func = dyn_cast<FuncDecl>(method);
+  if (!func || func->isAccessor() || func->isFinal())
+    return false;
+  if (!isa<ClassDecl>(func->getDeclContext()))
+    return false;
+  if (func->isOverridden() || func->isDynamic() || func->isObjC() ||
+      func->hasClangNode() || !func->hasAccessibility())
+    return false;
+
+  // Every possible override must have been type-checked along with the
+  // code we are compiling: private methods can only be overridden in their
+  // own file, and internal methods within the module.
+  const DeclContext *assocDC = M.getAssociatedContext();
+  if (!assocDC || !func->isChildContextOf(assocDC))
+    return false;
+
+  switch (func->getEffectiveAccess()) {
+  case Accessibility::Public:
+    return false;
+  case Accessibility::Internal:
+    return M.isWholeModule();
+  case Accessibility::Private:
+    return true;
+  }
+  llvm_unreachable("bad accessibility");
+}
+
+/// Collect the classes among the given declarations, including the ones
+/// nested in types and extensions.
+template <typename DeclRangeTy>
+static void collectClassDecls(DeclRangeTy decls,
+                              SmallVectorImpl<ClassDecl *> &classes) {
+  for (Decl *D : decls) {
+    if (auto classDecl = dyn_cast<ClassDecl>(D))
+      classes.push_back(classDecl);
+    if (auto nominal = dyn_cast<NominalTypeDecl>(D))
+      collectClassDecls(nominal->getMembers(), classes);
+    else if (auto ext = dyn_cast<ExtensionDecl>(D))
+      collectClassDecls(ext->getMembers(), classes);
+  }
+}
+
+void SILGenModule::inferFinalClassMethods(Module *mod) {
+  assert(M.isWholeModule() && "overrides in other files are not known");
+
+  SmallVector<ClassDecl *, 16> classes;
+  for (auto file : mod->getFiles()) {
+    auto sf = dyn_cast<SourceFile>(file);
+    if (!sf || sf->ASTStage != SourceFile::TypeChecked)
+      continue;
+    collectClassDecls(sf->Decls, classes);
+
+    SmallVector<TypeDecl *, 8> localTypes;
+    sf->getLocalTypeDecls(localTypes);
+    collectClassDecls(localTypes, classes);
+  }
+
+  // Marking a method final cannot make another method overridden, so the
+  // order does not matter.
+  ASTContext &C = getASTContext();
+  for (auto classDecl : classes) {
+    for (auto member : classDecl->getMembers()) {
+      auto method = dyn_cast<FuncDecl>(member);
+      if (method && isNonOverriddenClassMethod(method))
+        method->getAttrs().add(new (C) FinalAttr(/*IsImplicit=*/true));
+    }
+  }
+}
+
 //===--------------------------------------------------------------------===//
 // SILModule::constructSIL method implementation
 //===--------------------------------------------------------------------===//
@@ -1176,6 +1263,12 @@ SILModule::constructSIL(Module *mod, SILOptions &options, FileUnit *SF,
         M->getSILLoader()->getAllForModule(mod->getName(), file);
     }
   } else {
+    // With the whole module type-checked, methods that are never
+    // overridden can be treated as final before anything is emitted, so
+    // that the vtables and class metadata agree.
+    if (isWholeModule)
+      SGM.inferFinalClassMethods(mod);
+
     for (auto file : mod->getFiles()) {
       auto nextSF = dyn_cast<SourceFile>(file);
       if (!nextSF || nextSF->ASTStage != SourceFile::TypeChecked)
@@ -23,6 +23,7 @@
 #include "swift/SIL/SILModule.h"
 #include "swift/SIL/TypeLowering.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 #include <deque>
 
 namespace swift {
@@ -59,6 +60,10 @@ public:
   /// disabled.
   std::unique_ptr<SILGenProfiling> Profiler;
 
+  /// The execution counts read from the profile passed with -profile-use, or
+  /// null if no profile is being used.
+  std::unique_ptr<llvm::IndexedInstrProfReader> ProfileReader;
+
   /// Mapping from SILDeclRefs to emitted SILFunctions.
   llvm::DenseMap<SILDeclRef, SILFunction*> emittedFunctions;
   /// Mapping from ProtocolConformances to emitted SILWitnessTables.
@@ -324,6 +329,16 @@ public:
   /// dispatch.
   bool requiresObjCMethodEntryPoint(ConstructorDecl *constructor);
 
+  /// True if the given class method is never overridden, and no override
+  /// can exist outside of the code being compiled, so that calls to it can
+  /// be dispatched directly.
+  bool isNonOverriddenClassMethod(AbstractFunctionDecl *method);
+
+  /// Mark the class methods of the module that are never overridden as
+  /// 'final', so that they neither get vtable entries nor are dispatched
+  /// through the vtable.  Only valid in whole-module compilation.
+  void inferFinalClassMethods(Module *mod);
+
   /// Emit a global initialization.
   void emitGlobalInitialization(PatternBindingDecl *initializer, unsigned elt);
   
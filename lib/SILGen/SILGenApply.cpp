@@ -1070,7 +1070,8 @@ public:
       } else {
         switch (getMethodDispatch(afd)) {
         case MethodDispatch::Class:
-          isDynamicallyDispatched = true;
+          // A method that cannot be overridden can be called directly.
+          isDynamicallyDispatched = !SGF.SGM.isNonOverriddenClassMethod(afd);
           break;
         case MethodDispatch::Static:
           isDynamicallyDispatched = false;
@@ -421,6 +421,8 @@ public:
 
   void emitDispatch(ClauseMatrix &matrix, ArgArray args,
                     const FailureHandler &failure);
+  bool emitLiteralKeyDispatch(MutableArrayRef<ClauseRow> rows, ArgArray args,
+                              const FailureHandler &failure);
 
   JumpDest getSharedCaseBlockDest(CaseStmt *caseStmt, bool hasFallthroughTo);
   void emitSharedCaseBlocks();
@@ -625,6 +627,10 @@ public:
     }
   }
 
+  /// Create a clause matrix from a subset of the rows of another matrix.
+  explicit ClauseMatrix(ArrayRef<ClauseRow *> rows)
+    : Rows(rows.begin(), rows.end()) {}
+
   ClauseMatrix(ClauseMatrix &&) = default;
   ClauseMatrix &operator=(ClauseMatrix &&) = default;
   
@@ -1010,6 +1016,220 @@ void PatternMatchEmission::emitDispatch(ClauseMatrix &clauses, ArgArray args,
   }
 }
 
+/// The minimum number of rows in a switch over literals before we dispatch
+/// on an integer key rather than testing each row in turn.
+static const unsigned MinRowsForLiteralKeyDispatch = 8;
+
+/// If the given type is a standard library struct wrapping a single
+/// fixed-width builtin integer, such as Int or UInt8, return its field.
+static VarDecl *getStdlibIntegerValueField(CanType type) {
+  auto structDecl = type->getStructOrBoundGenericStruct();
+  if (!structDecl || structDecl->isGenericContext() ||
+      !structDecl->getModuleContext()->isStdlibModule())
+    return nullptr;
+
+  auto fields = structDecl->getStoredProperties();
+  if (fields.empty() || std::next(fields.begin()) != fields.end())
+    return nullptr;
+
+  VarDecl *field = *fields.begin();
+  auto intTy = field->getType()->getAs<BuiltinIntegerType>();
+  if (!intTy || !intTy->isFixedWidth() || intTy->getFixedWidth() > 64)
+    return nullptr;
+  return field;
+}
+
+/// If the given row matches the subject against a literal of the subject's
+/// type using the standard library's '~=', return the literal.
+static LiteralExpr *getMatchedLiteral(const ClauseRow &row,
+                                      CanType subjectType) {
+  if (row.getCaseGuardExpr())
+    return nullptr;
+  auto caseStmt = dyn_cast_or_null<CaseStmt>(row.getClientData<Stmt>());
+  if (!caseStmt || caseStmt->hasBoundDecls())
+    return nullptr;
+
+  auto exprPattern = dyn_cast<ExprPattern>(
+      row.getCasePattern()->getSemanticsProvidingPattern());
+  if (!exprPattern ||
+      !exprPattern->getSubExpr()->getType()->isEqual(subjectType))
+    return nullptr;
+
+  // For two values of the same Equatable type, the standard library's
+  // '~=' is '=='.
+  auto matchCall = dyn_cast<ApplyExpr>(
+      exprPattern->getMatchExpr()->getSemanticsProvidingExpr());
+  auto matchFn = matchCall ? matchCall->getCalledValue() : nullptr;
+  if (!matchFn || matchFn->getName().str() != "~=" ||
+      !matchFn->getModuleContext()->isStdlibModule())
+    return nullptr;
+
+  // Sema converts a literal of a standard library type into a call to the
+  // type's builtin literal initializer.
+  auto initCall = dyn_cast<CallExpr>(
+      exprPattern->getSubExpr()->getSemanticsProvidingExpr());
+  if (!initCall)
+    return nullptr;
+  Expr *initFn = initCall->getFn()->getSemanticsProvidingExpr();
+  if (auto ctorRef = dyn_cast<ConstructorRefCallExpr>(initFn))
+    initFn = ctorRef->getFn()->getSemanticsProvidingExpr();
+  auto initRef = dyn_cast<DeclRefExpr>(initFn);
+  auto init = initRef ? dyn_cast<ConstructorDecl>(initRef->getDecl())
+                      : nullptr;
+  if (!init || !init->getModuleContext()->isStdlibModule())
+    return nullptr;
+  auto argNames = init->getFullName().getArgumentNames();
+  if (argNames.empty() || !argNames[0].str().startswith("_builtin"))
+    return nullptr;
+
+  Expr *arg = initCall->getArg()->getSemanticsProvidingExpr();
+  if (auto tuple = dyn_cast<TupleExpr>(arg)) {
+    if (tuple->getNumElements() != 1)
+      return nullptr;
+    arg = tuple->getElement(0)->getSemanticsProvidingExpr();
+  }
+  return dyn_cast<LiteralExpr>(arg);
+}
+
+/// Try to emit a switch whose cases all match literals, followed by a final
+/// wildcard case, by first branching on an integer key with switch_value.
+/// Each destination then tests only the rows that can match that key, so
+/// a large switch no longer calls '~=' once per case.
+///
+/// For integers the key is the value itself.  For strings it is the count
+/// of the subject's contiguous ASCII storage, or -1 if the subject is not
+/// stored that way; a non-ASCII subject may still be canonically equivalent
+/// to an ASCII literal, so -1 tests every row.
+///
+/// Returns false, having emitted nothing, if the switch is not of this form.
+bool PatternMatchEmission::emitLiteralKeyDispatch(
+                                           MutableArrayRef<ClauseRow> rows,
+                                           ArgArray args,
+                                           const FailureHandler &failure) {
+  if (rows.size() < MinRowsForLiteralKeyDispatch || args.size() != 1)
+    return false;
+  ConsumableManagedValue subject = args[0];
+  if (subject.getType().isAddress())
+    return false;
+
+  ASTContext &C = SGF.getASTContext();
+  CanType subjectType = subject.getType().getSwiftRValueType();
+  FuncDecl *asciiCountFn = nullptr;
+  VarDecl *countField = nullptr;
+  VarDecl *subjectField = nullptr;
+  if (auto stringDecl = C.getStringDecl()) {
+    if (subjectType == stringDecl->getDeclaredType()->getCanonicalType()) {
+      asciiCountFn = C.getStringContiguousASCIICount(nullptr);
+      if (!asciiCountFn || !C.getIntDecl())
+        return false;
+      countField = getStdlibIntegerValueField(
+          C.getIntDecl()->getDeclaredType()->getCanonicalType());
+      if (!countField)
+        return false;
+    }
+  }
+  if (!asciiCountFn) {
+    subjectField = getStdlibIntegerValueField(subjectType);
+    if (!subjectField)
+      return false;
+  }
+
+  // The last row must be an irrefutable wildcard that is entered along
+  // every path.
+  ClauseRow &defaultRow = rows.back();
+  auto defaultCase =
+    dyn_cast_or_null<CaseStmt>(defaultRow.getClientData<Stmt>());
+  if (!defaultCase || defaultCase->hasBoundDecls() ||
+      defaultRow.getCaseGuardExpr() ||
+      !isa<AnyPattern>(defaultRow.getCasePattern()
+                         ->getSemanticsProvidingPattern()))
+    return false;
+
+  // Compute the key of every other row.
+  SmallVector<int64_t, 16> keys;
+  for (unsigned i = 0, e = rows.size() - 1; i != e; ++i) {
+    LiteralExpr *literal = getMatchedLiteral(rows[i], subjectType);
+    if (!literal)
+      return false;
+
+    if (asciiCountFn) {
+      auto stringLiteral = dyn_cast<StringLiteralExpr>(literal);
+      if (!stringLiteral)
+        return false;
+      StringRef value = stringLiteral->getValue();
+      if (std::any_of(value.begin(), value.end(),
+                      [](unsigned char c) { return c >= 0x80; }))
+        return false;
+      keys.push_back(value.size());
+    } else {
+      auto intLiteral = dyn_cast<IntegerLiteralExpr>(literal);
+      if (!intLiteral || !intLiteral->getType()->is<BuiltinIntegerType>())
+        return false;
+      // Leave literals that overflow the subject type to be diagnosed by
+      // the ordinary lowering.
+      APInt value = intLiteral->getValue();
+      auto width = subjectField->getType()->castTo<BuiltinIntegerType>()
+                     ->getFixedWidth();
+      if (!value.isSignedIntN(width))
+        return false;
+      keys.push_back(value.getSExtValue());
+    }
+  }
+
+  // Group the rows by key, preserving their order.  Every group ends with
+  // the wildcard row.
+  llvm::MapVector<int64_t, SmallVector<ClauseRow *, 4>> groups;
+  for (unsigned i = 0, e = keys.size(); i != e; ++i)
+    groups[keys[i]].push_back(&rows[i]);
+  if (asciiCountFn) {
+    assert(!groups.count(-1) && "ASCII literal with negative count?");
+    auto &allRows = groups[-1];
+    for (unsigned i = 0, e = keys.size(); i != e; ++i)
+      allRows.push_back(&rows[i]);
+  }
+  for (auto &group : groups)
+    group.second.push_back(&defaultRow);
+
+  // Compute the key of the subject.
+  SILLocation loc = PatternMatchStmt;
+  SILValue key;
+  if (asciiCountFn) {
+    ManagedValue subjectCopy =
+      subject.getFinalManagedValue().copy(SGF, loc);
+    ManagedValue count =
+      SGF.emitApplyOfLibraryIntrinsic(loc, asciiCountFn, {}, subjectCopy,
+                                      SGFContext());
+    key = SGF.B.createStructExtract(loc, count.getValue(), countField);
+  } else {
+    key = SGF.B.createStructExtract(loc, subject.getValue(), subjectField);
+  }
+
+  SILBasicBlock *defaultBB = SGF.createBasicBlock();
+  SmallVector<std::pair<SILValue, SILBasicBlock *>, 16> caseBBs;
+  for (auto &group : groups) {
+    SILValue caseValue =
+      SGF.B.createIntegerLiteral(loc, key.getType(), group.first);
+    caseBBs.push_back({caseValue, SGF.createBasicBlock()});
+  }
+  SGF.B.createSwitchValue(loc, key, defaultBB, caseBBs);
+
+  // Emit the rows of each group as an ordinary decision tree.
+  auto emitGroup = [&](SILBasicBlock *bb, ArrayRef<ClauseRow *> groupRows,
+                       bool isFinalUse) {
+    SGF.B.emitBlock(bb);
+    ArgForwarder forwarder(SGF, args, isFinalUse);
+    ClauseMatrix matrix(groupRows);
+    emitDispatch(matrix, forwarder.getForwardedArgs(), failure);
+  };
+  unsigned groupIndex = 0;
+  for (auto &group : groups)
+    emitGroup(caseBBs[groupIndex++].second, group.second,
+              /*isFinalUse*/ false);
+  ClauseRow *defaultRowPtr = &defaultRow;
+  emitGroup(defaultBB, defaultRowPtr, /*isFinalUse*/ true);
+  return true;
+}
+
 /// Emit the decision tree for a row containing only non-specializing
 /// patterns.
 ///
@@ -2185,17 +2405,19 @@ void SILGenFunction::emitSwitchStmt(SwitchStmt *S) {
     hasFallthrough = containsFallthrough(caseBlock->getBody());
   }
 
-  // Set up an initial clause matrix.
-  ClauseMatrix clauses(clauseRows);
-
   auto failure = [&](SILLocation location) {
     // If we fail to match anything, we can just emit unreachable.
     // This will be a dataflow error if we can reach here.
     B.createUnreachable(S);
   };
 
-  // Recursively specialize and emit the clause matrix.
-  emission.emitDispatch(clauses, subject, failure);
+  // Large switches over literals first branch on an integer key.
+  // Otherwise, set up an initial clause matrix and recursively specialize
+  // and emit it.
+  if (!emission.emitLiteralKeyDispatch(clauseRows, subject, failure)) {
+    ClauseMatrix clauses(clauseRows);
+    emission.emitDispatch(clauses, subject, failure);
+  }
   assert(!B.hasValidInsertionPoint());
 
   switchScope.pop();
@@ -29,10 +29,11 @@ using namespace Lowering;
 ProfilerRAII::ProfilerRAII(SILGenModule &SGM, AbstractFunctionDecl *D)
     : SGM(SGM) {
   const auto &Opts = SGM.M.getOptions();
-  if (!Opts.GenerateProfile)
+  if (!Opts.GenerateProfile && !SGM.ProfileReader)
     return;
-  SGM.Profiler =
-      llvm::make_unique<SILGenProfiling>(SGM, Opts.EmitProfileCoverageMapping);
+  SGM.Profiler = llvm::make_unique<SILGenProfiling>(
+      SGM, Opts.GenerateProfile,
+      Opts.GenerateProfile && Opts.EmitProfileCoverageMapping);
   SGM.Profiler->assignRegionCounters(D);
 }
 
@@ -615,6 +616,15 @@ void SILGenProfiling::assignRegionCounters(AbstractFunctionDecl *Root) {
   // TODO: Mapper needs to calculate a function hash as it goes.
   FunctionHash = 0x0;
 
+  if (SGM.ProfileReader) {
+    // A function whose counters don't line up with the profile has changed
+    // since the profile was collected; ignore its stale counts.
+    if (SGM.ProfileReader->getFunctionCounts(CurrentFuncName, FunctionHash,
+                                             RegionCounts) ||
+        RegionCounts.size() != NumRegionCounters)
+      RegionCounts.clear();
+  }
+
   if (EmitCoverageMapping) {
     CoverageMapping Coverage(SGM.M.getASTContext().SourceMgr);
     walkForProfiling(Root, Coverage);
@@ -641,6 +651,11 @@ void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   assert(CounterIt != RegionCounterMap.end() &&
          "cannot increment non-existent counter");
 
+  if (!RegionCounts.empty())
+    Builder.getInsertionBB()->setProfileCount(RegionCounts[CounterIt->second]);
+  if (!EmitCounterIncrements)
+    return;
+
   auto Int32Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(32, C));
   auto Int64Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(64, C));
 
@@ -37,6 +37,7 @@ struct ProfilerRAII {
 class SILGenProfiling {
 private:
   SILGenModule &SGM;
+  bool EmitCounterIncrements;
   bool EmitCoverageMapping;
 
   // The current function's name and counter data.
@@ -45,19 +46,26 @@ private:
   uint64_t FunctionHash;
   llvm::DenseMap<ASTNode, unsigned> RegionCounterMap;
 
+  /// The execution count of each region counter read from the profile, or
+  /// empty if the profile has no matching data for the current function.
+  std::vector<uint64_t> RegionCounts;
+
   std::vector<std::tuple<std::string, uint64_t, std::string>> CoverageData;
 
 public:
-  SILGenProfiling(SILGenModule &SGM, bool EmitCoverageMapping)
-      : SGM(SGM), EmitCoverageMapping(EmitCoverageMapping),
-        NumRegionCounters(0), FunctionHash(0) {}
+  SILGenProfiling(SILGenModule &SGM, bool EmitCounterIncrements,
+                  bool EmitCoverageMapping)
+      : SGM(SGM), EmitCounterIncrements(EmitCounterIncrements),
+        EmitCoverageMapping(EmitCoverageMapping), NumRegionCounters(0),
+        FunctionHash(0) {}
 
   bool hasRegionCounters() const { return NumRegionCounters != 0; }
 
   /// Map counters to ASTNodes and set them up for profiling the given function.
   void assignRegionCounters(AbstractFunctionDecl *Root);
 
-  /// Emit SIL to increment the counter for \c Node.
+  /// Emit SIL to increment the counter for \c Node, and attach its profiled
+  /// execution count to the current block if a profile is being used.
   void emitCounterIncrement(SILGenBuilder &Builder, ASTNode Node);
 };
 
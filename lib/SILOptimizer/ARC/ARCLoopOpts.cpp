@@ -39,6 +39,12 @@ namespace {
 
 class ARCLoopOpts : public SILFunctionTransform {
 
+  bool preservesAnalysis(SILAnalysis::AnalysisKind Kind) const override {
+    // We keep loop info and the dominator tree up to date.
+    return Kind == SILAnalysis::AnalysisKind::Dominance ||
+           Kind == SILAnalysis::AnalysisKind::Loop;
+  }
+
   void run() override {
     auto *F = getFunction();
 
@@ -57,12 +63,7 @@ class ARCLoopOpts : public SILFunctionTransform {
 
     // Canonicalize the loops, invalidating if we need to.
     if (canonicalizeAllLoops(DI, LI)) {
-      // We preserve loop info and the dominator tree.
-      DA->lockInvalidation();
-      LA->lockInvalidation();
       PM->invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
-      DA->unlockInvalidation();
-      LA->unlockInvalidation();
     }
 
     // Get all of the analyses that we need.
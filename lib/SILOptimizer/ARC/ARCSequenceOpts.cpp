@@ -214,6 +214,12 @@ static bool processFunctionWithLoopSupport(
 
 namespace {
 class ARCSequenceOpts : public SILFunctionTransform {
+  bool preservesAnalysis(SILAnalysis::AnalysisKind Kind) const override {
+    // We keep loop info and the dominator tree up to date.
+    return Kind == SILAnalysis::AnalysisKind::Dominance ||
+           Kind == SILAnalysis::AnalysisKind::Loop;
+  }
+
   /// The entry point to the transformation.
   void run() override {
     auto *F = getFunction();
@@ -242,12 +248,7 @@ class ARCSequenceOpts : public SILFunctionTransform {
 
     // Canonicalize the loops, invalidating if we need to.
     if (canonicalizeAllLoops(DI, LI)) {
-      // We preserve loop info and the dominator tree.
-      DA->lockInvalidation();
-      LA->lockInvalidation();
       PM->invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
-      DA->unlockInvalidation();
-      LA->unlockInvalidation();
     }
 
     auto *AA = getAnalysis<AliasAnalysis>();
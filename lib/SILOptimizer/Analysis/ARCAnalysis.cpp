@@ -65,6 +65,49 @@ static bool canApplyDecrementRefCount(OperandValueArrayRef Ops, SILValue Ptr,
   return false;
 }
 
+/// Use the side-effect summary of the callee, which is computed bottom-up over
+/// the call graph, to check if \p AI may decrement the ref count of \p Ptr.
+/// This is the case if the callee (or any function it calls) may release an
+/// object, or if \p Ptr is passed to an @owned parameter of the callee.
+static bool calleeMayDecrementRefCount(ApplyInst *AI, SILValue Ptr,
+                                       AliasAnalysis *AA) {
+  SideEffectAnalysis *SEA = AA->getSideEffectAnalysis();
+  if (!SEA)
+    return true;
+
+  SideEffectAnalysis::FunctionEffects Effects;
+  SEA->getEffects(Effects, FullApplySite(AI));
+
+  // Releases of objects allocated in the callee are not part of the summary,
+  // but the deinit of such an object may release anything it references.
+  if (Effects.getGlobalEffects().mayRelease() || Effects.mayAllocObjects() ||
+      Effects.mayReadRC())
+    return true;
+
+  // A release of a parameter may free it and run a deinit, which again may
+  // release anything. So we only accept callees which do not release at all.
+  auto ParamEffects = Effects.getParameterEffects();
+  if (ParamEffects.size() != AI->getNumArguments())
+    return true;
+  for (auto &E : ParamEffects)
+    if (E.mayRelease())
+      return true;
+
+  // The callee takes over the ref count of @owned arguments, even if it does
+  // not release them.
+  auto Params = AI->getSubstCalleeType()->getParameters();
+  auto Args = AI->getArgumentsWithoutIndirectResult();
+  for (unsigned Idx = 0, NumArgs = Args.size(); Idx < NumArgs; ++Idx) {
+    if (!Params[Idx].isConsumed())
+      continue;
+    for (int i = 0, e = Ptr->getNumTypes(); i < e; i++) {
+      if (!AA->isNoAlias(Args[Idx], SILValue(Ptr.getDef(), i)))
+        return true;
+    }
+  }
+  return false;
+}
+
 static bool canApplyDecrementRefCount(ApplyInst *AI, SILValue Ptr,
                                       AliasAnalysis *AA) {
   // Ignore any thick functions for now due to us not handling the ref-counted
@@ -83,6 +126,9 @@ static bool canApplyDecrementRefCount(ApplyInst *AI, SILValue Ptr,
     if (isKnownToNotDecrementRefCount(FRI))
       return false;
 
+  if (!calleeMayDecrementRefCount(AI, Ptr, AA))
+    return false;
+
   return canApplyDecrementRefCount(AI->getArgumentsWithoutIndirectResult(),
                                    Ptr, AA);
 }
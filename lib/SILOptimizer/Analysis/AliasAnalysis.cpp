@@ -553,11 +553,48 @@ static bool typedAccessTBAAMayAlias(SILType LTy, SILType RTy, SILModule &Mod) {
   return true;
 }
 
+/// \brief return True if references of type \p LTy and \p RTy may refer to the
+/// same class instance.
+///
+/// An instance has exactly one dynamic class, so two references can only refer
+/// to the same instance if one static class is a superclass of the other.
+static bool classInstancesMayAlias(SILType LTy, SILType RTy) {
+#ifndef NDEBUG
+  if (!shouldRunTypedAccessTBAA())
+    return true;
+#endif
+
+  if (LTy == RTy || !LTy.isObject() || !RTy.isObject())
+    return true;
+
+  ClassDecl *LTyClass = LTy.getClassOrBoundGenericClass();
+  ClassDecl *RTyClass = RTy.getClassOrBoundGenericClass();
+  if (!LTyClass || !RTyClass)
+    return true;
+
+  // We don't know the range of classes an unbound generic class may be bound
+  // to.
+  if (LTy.hasArchetype() || RTy.hasArchetype())
+    return true;
+
+  // Imported classes may be proxies which stand in for instances of other
+  // classes. Be conservative.
+  if (LTyClass->hasClangNode() || RTyClass->hasClangNode())
+    return true;
+
+  return LTy.isSuperclassOf(RTy) || RTy.isSuperclassOf(LTy);
+}
+
 bool AliasAnalysis::typesMayAlias(SILType T1, SILType T2) {
   // Both types need to be valid.
   if (!T2 || !T1)
     return true;
 
+  // Type aliasing is symmetric. Canonicalize the order of the types so that
+  // both query orders share a cache entry.
+  if (std::less<void *>()(T2.getOpaqueValue(), T1.getOpaqueValue()))
+    std::swap(T1, T2);
+
   // Check if we've already computed the TBAA relation.
   auto Key = std::make_pair(T1, T2);
   auto Res = TypesMayAliasCache.find(Key);
@@ -644,6 +681,14 @@ AliasResult AliasAnalysis::aliasInner(SILValue V1, SILValue V2,
   if (O1 != O2 && aliasUnequalObjects(O1, O2))
     return AliasResult::NoAlias;
 
+  // References to instances of unrelated classes can not refer to the same
+  // object. This also disambiguates stored properties projected out of them.
+  if (O1 != O2 && !classInstancesMayAlias(O1.getType(), O2.getType())) {
+    DEBUG(llvm::dbgs() << "            Found references to unrelated "
+          "classes.\n");
+    return AliasResult::NoAlias;
+  }
+
   // Ok, either O1, O2 are the same or we could not prove anything based off of
   // their inequality. Now we climb up use-def chains and attempt to do tricks
   // based off of GEPs.
@@ -712,5 +757,13 @@ AliasKeyTy AliasAnalysis::toAliasKey(SILValue V1, SILValue V2,
   unsigned R2 = V2.getResultNumber();
   void *t1 = Type1.getOpaqueValue();
   void *t2 = Type2.getOpaqueValue();
+
+  // Aliasing is symmetric. Canonicalize the order of the (value, type) pairs
+  // so that alias(A, B) and alias(B, A) share a cache entry.
+  if (std::make_pair(idx2, R2) < std::make_pair(idx1, R1)) {
+    std::swap(idx1, idx2);
+    std::swap(R1, R2);
+    std::swap(t1, t2);
+  }
   return {idx1, idx2, R1, R2, t1, t2};
 }
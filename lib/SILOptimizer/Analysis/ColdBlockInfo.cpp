@@ -81,9 +81,22 @@ static BranchHint getBranchHint(SILValue Cond) {
   return BranchHint::None;
 }
 
+/// \return true if the profile shows that BB never executed although its
+/// function did.
+static bool isNeverExecutedInProfile(const SILBasicBlock *BB) {
+  auto Count = BB->getProfileCount();
+  if (!Count || *Count != 0)
+    return false;
+  auto EntryCount = BB->getParent()->front().getProfileCount();
+  return EntryCount && *EntryCount != 0;
+}
+
 /// \return true if the CFG edge FromBB->ToBB is directly gated by a _slowPath
-/// branch hint.
+/// branch hint, or was never taken according to the profile.
 bool ColdBlockInfo::isSlowPath(const SILBasicBlock *FromBB, const SILBasicBlock *ToBB) {
+  if (isNeverExecutedInProfile(ToBB))
+    return true;
+
   auto *CBI = dyn_cast<CondBranchInst>(FromBB->getTerminator());
   if (!CBI)
     return false;
@@ -100,7 +113,8 @@ bool ColdBlockInfo::isSlowPath(const SILBasicBlock *FromBB, const SILBasicBlock
   return ToBB == ColdTarget;
 }
 
-/// \return true if the given block is dominated by a _slowPath branch hint.
+/// \return true if the given block is dominated by a _slowPath branch hint or
+/// by an edge that the profile shows was never taken.
 ///
 /// Cache all blocks visited to avoid introducing quadratic behavior.
 bool ColdBlockInfo::isCold(const SILBasicBlock *BB) {
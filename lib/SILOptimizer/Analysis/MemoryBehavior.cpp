@@ -91,6 +91,7 @@ public:
 
   MemBehavior visitLoadInst(LoadInst *LI);
   MemBehavior visitStoreInst(StoreInst *SI);
+  MemBehavior getApplyBehavior(FullApplySite FAS);
   MemBehavior visitApplyInst(ApplyInst *AI);
   MemBehavior visitTryApplyInst(TryApplyInst *AI);
   MemBehavior visitBuiltinInst(BuiltinInst *BI);
@@ -217,23 +218,10 @@ MemBehavior MemoryBehaviorVisitor::visitBuiltinInst(BuiltinInst *BI) {
   return MemBehavior::MayHaveSideEffects;
 }
 
-MemBehavior MemoryBehaviorVisitor::visitTryApplyInst(TryApplyInst *AI) {
-  MemBehavior Behavior = MemBehavior::MayHaveSideEffects;
-  // If it is an allocstack which does not escape, tryapply instruction can not
-  // read/modify the memory.
-  if (auto *ASI = dyn_cast<AllocStackInst>(getUnderlyingObject(V)))
-    if (isNonEscapingLocalObject(ASI->getAddressResult()))
-      Behavior = MemBehavior::None;
-
-  // Otherwise be conservative and return that we may have side effects.
-  DEBUG(llvm::dbgs() << "  Found tryapply, returning " << Behavior << '\n');
-  return Behavior;
-}
-
-MemBehavior MemoryBehaviorVisitor::visitApplyInst(ApplyInst *AI) {
+MemBehavior MemoryBehaviorVisitor::getApplyBehavior(FullApplySite FAS) {
 
   SideEffectAnalysis::FunctionEffects ApplyEffects;
-  SEA->getEffects(ApplyEffects, AI);
+  SEA->getEffects(ApplyEffects, FAS);
 
   MemBehavior Behavior = MemBehavior::None;
 
@@ -247,12 +235,12 @@ MemBehavior MemoryBehaviorVisitor::visitApplyInst(ApplyInst *AI) {
     Behavior = GlobalEffects.getMemBehavior(InspectionMode);
 
     // Check all parameter effects.
-    for (unsigned Idx = 0, End = AI->getNumArguments();
+    for (unsigned Idx = 0, End = FAS.getNumArguments();
          Idx < End && Behavior < MemBehavior::MayHaveSideEffects; ++Idx) {
       auto &ArgEffect = ApplyEffects.getParameterEffects()[Idx];
       auto ArgBehavior = ArgEffect.getMemBehavior(InspectionMode);
       if (ArgBehavior > Behavior) {
-        SILValue Arg = AI->getArgument(Idx);
+        SILValue Arg = FAS.getArgument(Idx);
         // We only consider the argument effects if the argument aliases V.
         if (!Arg.getType().isAddress() ||
             !AA->isNoAlias(Arg, V, computeTBAAType(Arg), getValueTBAAType())) {
@@ -275,6 +263,16 @@ MemBehavior MemoryBehaviorVisitor::visitApplyInst(ApplyInst *AI) {
   return Behavior;
 }
 
+MemBehavior MemoryBehaviorVisitor::visitApplyInst(ApplyInst *AI) {
+  return getApplyBehavior(AI);
+}
+
+MemBehavior MemoryBehaviorVisitor::visitTryApplyInst(TryApplyInst *AI) {
+  // The error and normal results of a try_apply don't matter here, so we can
+  // use the callee's side-effects just like for a regular apply.
+  return getApplyBehavior(AI);
+}
+
 MemBehavior
 MemoryBehaviorVisitor::visitStrongReleaseInst(StrongReleaseInst *SI) {
   // Need to make sure that the allocated memory does not escape.
@@ -86,6 +86,11 @@ llvm::cl::opt<bool> EliminateDeadClosures(
     llvm::cl::desc("Do not eliminate dead closures after closure "
                    "specialization. This is meant ot be used when testing."));
 
+llvm::cl::opt<unsigned> ClosureForwardingDepth(
+    "closure-specialize-forwarding-depth", llvm::cl::init(2),
+    llvm::cl::desc("How many levels of calls forwarding a closure argument "
+                   "are specialized."));
+
 //===----------------------------------------------------------------------===//
 //                                  Utility
 //===----------------------------------------------------------------------===//
@@ -416,8 +421,10 @@ void CallSiteDescriptor::extendArgumentLifetime(SILValue Arg) const {
   }
 }
 
-static void specializeClosure(ClosureInfo &CInfo,
-                              CallSiteDescriptor &CallDesc) {
+/// Specialize the callee of \p CallDesc on its closure argument and rewrite
+/// the call. Returns the specialized function if it was newly created.
+static SILFunction *specializeClosure(ClosureInfo &CInfo,
+                                      CallSiteDescriptor &CallDesc) {
   llvm::SmallString<64> NewFName;
   CallDesc.createName(NewFName);
   DEBUG(llvm::dbgs() << "    Perform optimizations with new name " << NewFName
@@ -429,11 +436,13 @@ static void specializeClosure(ClosureInfo &CInfo,
 
   // If not, create a specialized version of ApplyCallee calling the closure
   // directly.
+  SILFunction *CreatedF = nullptr;
   if (!NewF)
-    NewF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
+    NewF = CreatedF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
 
   // Rewrite the call
   rewriteApplyInst(CallDesc, NewF);
+  return CreatedF;
 }
 
 static bool isSupportedClosure(const SILInstruction *Closure) {
@@ -478,6 +487,25 @@ static bool isSupportedClosure(const SILInstruction *Closure) {
   return true;
 }
 
+/// Returns true if the closure argument \p Arg of a function is applied by the
+/// function, or forwarded to a known callee which may apply it in turn. In
+/// the latter case the closure is re-created in the specialized function and
+/// specialized once more when that function is processed.
+static bool isClosureArgumentUsed(SILValue Arg) {
+  return std::any_of(Arg->use_begin(), Arg->use_end(),
+                     [&Arg](Operand *Op) -> bool {
+    auto UserAI = FullApplySite::isa(Op->getUser());
+    if (!UserAI)
+      return false;
+    if (UserAI.getCallee() == Arg)
+      return true;
+    if (UserAI.hasSubstitutions())
+      return false;
+    SILFunction *Callee = UserAI.getCalleeFunction();
+    return Callee && Callee->isDefinition();
+  });
+}
+
 //===----------------------------------------------------------------------===//
 //                     Closure Spec Cloner Implementation
 //===----------------------------------------------------------------------===//
@@ -678,6 +706,10 @@ class ClosureSpecializer {
   std::vector<SILInstruction *> PropagatedClosures;
   bool IsPropagatedClosuresUniqued = false;
 
+  /// The specialized functions created since the last call to
+  /// takeSpecializedFunctions.
+  std::vector<SILFunction *> SpecializedFunctions;
+
 public:
   ClosureSpecializer() = default;
 
@@ -686,6 +718,12 @@ public:
                        llvm::DenseSet<FullApplySite> &MultipleClosureAI);
   bool specialize(SILFunction *Caller);
 
+  std::vector<SILFunction *> takeSpecializedFunctions() {
+    std::vector<SILFunction *> Result;
+    std::swap(Result, SpecializedFunctions);
+    return Result;
+  }
+
   ArrayRef<SILInstruction *> getPropagatedClosures() {
     if (IsPropagatedClosuresUniqued)
       return PropagatedClosures;
@@ -760,20 +798,16 @@ void ClosureSpecializer::gatherCallSites(
         if (!ClosureIndex.hasValue())
           continue;
 
-        // Make sure that the Closure is invoked in the Apply's callee. We only
-        // want to perform closure specialization if we know that we will be
-        // able to change a partial_apply into an apply.
+        // Make sure that the Closure is invoked in the Apply's callee, or
+        // passed on to a function that may invoke it. We only want to perform
+        // closure specialization if we know that we will be able to change a
+        // partial_apply into an apply.
         //
         // TODO: Maybe just call the function directly instead of moving the
         // partial apply?
         SILValue Arg = ApplyCallee->getArgument(ClosureIndex.getValue());
-        if (std::none_of(Arg->use_begin(), Arg->use_end(),
-                         [&Arg](Operand *Op) -> bool {
-                           auto UserAI = FullApplySite::isa(Op->getUser());
-                           return UserAI && UserAI.getCallee() == Arg;
-                         })) {
+        if (!isClosureArgumentUsed(Arg))
           continue;
-        }
 
         auto ParamInfo = AI.getSubstCalleeType()->getParameters();
         SILParameterInfo ClosureParamInfo = ParamInfo[ClosureIndex.getValue()];
@@ -827,7 +861,8 @@ bool ClosureSpecializer::specialize(SILFunction *Caller) {
       if (MultipleClosureAI.count(CSDesc.getApplyInst()))
         continue;
 
-      specializeClosure(*CInfo, CSDesc);
+      if (auto *NewF = specializeClosure(*CInfo, CSDesc))
+        SpecializedFunctions.push_back(NewF);
       PropagatedClosures.push_back(CSDesc.getClosure());
       Changed = true;
     }
@@ -868,6 +903,17 @@ public:
       Changed |= C.specialize(F);
     }
 
+    // A closure which a callee forwards to another function is re-created in
+    // the callee's specialized copy. Specialize the copies as well, up to a
+    // fixed depth so that recursive functions don't keep us going.
+    for (unsigned Depth = 0; Depth < ClosureForwardingDepth; ++Depth) {
+      auto NewFunctions = C.takeSpecializedFunctions();
+      if (NewFunctions.empty())
+        break;
+      for (auto *F : NewFunctions)
+        Changed |= C.specialize(F);
+    }
+
     // Invalidate everything since we delete calls as well as add new
     // calls and branches.
     if (Changed) {
@@ -58,11 +58,44 @@ protected:
 
   llvm::SmallPtrSet<SILFunction *, 100> AliveFunctions;
 
+  /// True if the module is linked into an executable which nothing else links
+  /// against (-whole-program). Then public symbols are not roots; only the
+  /// entry point and what the runtime may reach without a SIL reference are.
+  bool isWholeProgram() const {
+    return Module->getOptions().WholeProgram && Module->isWholeModule();
+  }
+
+  /// Returns true if a symbol with \p linkage may be referenced from outside
+  /// of the module.
+  bool isPossiblyUsedExternally(SILLinkage linkage) const {
+    if (isWholeProgram())
+      return false;
+    return swift::isPossiblyUsedExternally(linkage, Module->isWholeModule());
+  }
+
+  /// Returns true if \p F is called from outside of a whole program, i.e. it
+  /// is the entry point or it can be looked up by name at runtime.
+  static bool isWholeProgramRoot(SILFunction *F) {
+    if (F->getName() == SWIFT_ENTRY_POINT_FUNCTION)
+      return true;
+
+    auto *DC = F->getDeclContext();
+    auto *decl = DC ? dyn_cast<AbstractFunctionDecl>(DC) : nullptr;
+    if (!decl)
+      return false;
+    return decl->isObjC() ||
+           decl->getAttrs().hasAttribute<DynamicAttr>() ||
+           decl->getAttrs().hasAttribute<SILGenNameAttr>();
+  }
+
   /// Checks is a function is alive, e.g. because it is visible externally.
   bool isAnchorFunction(SILFunction *F) {
 
     // Remove internal functions that are not referenced by anything.
-    if (isPossiblyUsedExternally(F->getLinkage(), Module->isWholeModule()))
+    if (isPossiblyUsedExternally(F->getLinkage()))
+      return true;
+
+    if (isWholeProgram() && isWholeProgramRoot(F))
       return true;
 
     // ObjC functions are called through the runtime and are therefore alive
@@ -212,7 +245,7 @@ protected:
       linkage = SILLinkage::Public;
       break;
     }
-    if (isPossiblyUsedExternally(linkage, Module->isWholeModule()))
+    if (isPossiblyUsedExternally(linkage))
       return true;
 
     // If a vtable or witness table (method) is only visible in another module
@@ -307,7 +340,7 @@ class DeadFunctionElimination : FunctionLivenessComputation {
 
         if (// A conservative approach: if any of the overridden functions is
             // visible externally, we mark the whole method as alive.
-            isPossiblyUsedExternally(F->getLinkage(), Module->isWholeModule())
+            isPossiblyUsedExternally(F->getLinkage())
             // We also have to check the method declaration's accessibility.
             // Needed if it's a public base method declared in another
             // compilation unit (for this we have no SILFunction).
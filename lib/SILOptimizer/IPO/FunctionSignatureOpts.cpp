@@ -585,8 +585,12 @@ CanSILFunctionType FunctionAnalyzer::createOptimizedSILFunctionType() {
   auto InterfaceErrorResult = FTy->getOptionalErrorResult();
   auto ExtInfo = FTy->getExtInfo();
 
-  // Don't use a method representation if we modified self.
-  if (HaveModifiedSelfArgument)
+  // Don't use a method representation if we modified self. The optimized
+  // version of a witness is only called directly, never through a witness
+  // table, so it doesn't need the witness_method convention either.
+  if (HaveModifiedSelfArgument ||
+      ExtInfo.getRepresentation() ==
+        SILFunctionTypeRepresentation::WitnessMethod)
     ExtInfo = ExtInfo.withRepresentation(SILFunctionTypeRepresentation::Thin);
 
   return SILFunctionType::get(FTy->getGenericSignature(), ExtInfo,
@@ -920,8 +924,11 @@ static bool isSpecializableRepresentation(SILFunctionTypeRepresentation Rep) {
   case SILFunctionTypeRepresentation::Thin:
   case SILFunctionTypeRepresentation::Thick:
   case SILFunctionTypeRepresentation::CFunctionPointer:
-    return true;
+  // Vtable and witness table entries keep referring to the original function,
+  // which becomes a thunk. Only devirtualized call sites call the optimized
+  // body directly.
   case SILFunctionTypeRepresentation::WitnessMethod:
+    return true;
   case SILFunctionTypeRepresentation::ObjCMethod:
   case SILFunctionTypeRepresentation::Block:
     return false;
@@ -0,0 +1,97 @@
+//===--- GenericSpecializer.cpp - Specialize generic calls ----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Specializes calls of generic functions with concrete substitutions, without
+// inlining anything. This is used by the -Og pipeline, where the performance
+// inliner (which otherwise does the specialization) does not run.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "generic-specializer"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/Generics.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumAppliesSpecialized, "Number of generic calls specialized");
+
+namespace {
+
+class GenericSpecializer : public SILModuleTransform {
+  void run() override {
+    auto &M = *getModule();
+
+    // Specializations are new functions with calls of their own, which may
+    // need to be specialized as well.
+    llvm::SmallVector<SILFunction *, 32> WorkList;
+    for (auto &F : M)
+      if (F.isDefinition())
+        WorkList.push_back(&F);
+
+    while (!WorkList.empty()) {
+      SILFunction *F = WorkList.pop_back_val();
+      if (specializeApplies(*F, WorkList))
+        invalidateAnalysis(F, SILAnalysis::InvalidationKind::Everything);
+    }
+  }
+
+  StringRef getName() override { return "Generic Specializer"; }
+
+  bool specializeApplies(SILFunction &F,
+                         llvm::SmallVectorImpl<SILFunction *> &WorkList);
+};
+
+} // end anonymous namespace
+
+bool GenericSpecializer::specializeApplies(
+    SILFunction &F, llvm::SmallVectorImpl<SILFunction *> &WorkList) {
+  llvm::SmallVector<ApplySite, 16> Applies;
+  for (auto &BB : F)
+    for (auto &I : BB)
+      if (ApplySite Apply = ApplySite::isa(&I))
+        if (Apply.hasSubstitutions())
+          Applies.push_back(Apply);
+
+  bool Changed = false;
+  for (auto Apply : Applies) {
+    auto *Callee = Apply.getCalleeFunction();
+    if (!Callee || !Callee->isDefinition())
+      continue;
+
+    DEBUG(llvm::dbgs() << "Specializing call of " << Callee->getName()
+                       << " in " << F.getName() << "\n");
+
+    CloneCollector Collector([](SILInstruction *) { return false; });
+    SILFunction *NewF = nullptr;
+    auto Specialized = trySpecializeApplyOfGeneric(Apply, NewF, Collector);
+    if (!Specialized)
+      continue;
+
+    replaceDeadApply(Apply, Specialized.getInstruction());
+    if (NewF)
+      WorkList.push_back(NewF);
+    ++NumAppliesSpecialized;
+    Changed = true;
+  }
+  return Changed;
+}
+
+SILTransform *swift::createGenericSpecializer() {
+  return new GenericSpecializer();
+}
@@ -12,6 +12,7 @@
 
 #define DEBUG_TYPE "globalopt"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/Range.h"
 #include "swift/SIL/CFG.h"
 #include "swift/SIL/DebugUtils.h"
 #include "swift/SIL/SILInstruction.h"
@@ -510,6 +511,104 @@ static SILFunction *genGetterFromInit(SILFunction *InitF, VarDecl *varDecl) {
   return GetterF;
 }
 
+/// Returns the value which is stored to \p Addr, either by a single store of
+/// the whole value or by separate stores to each of its struct or tuple
+/// elements. In the latter case the aggregate is created with \p B at \p Loc.
+/// The stores and element projections which become dead are added to \p Dead.
+static SILValue getStoredValue(SILValue Addr, SILLocation Loc, SILBuilder &B,
+                               SmallVectorImpl<SILInstruction *> &Dead) {
+  SILType Ty = Addr.getType().getObjectType();
+  StructDecl *SD = Ty.getStructOrBoundGenericStruct();
+  SmallVector<VarDecl *, 8> Fields;
+  unsigned NumElements = 0;
+  if (SD) {
+    for (VarDecl *Field : SD->getStoredProperties())
+      Fields.push_back(Field);
+    NumElements = Fields.size();
+  } else if (auto TT = Ty.getAs<TupleType>()) {
+    NumElements = TT->getNumElements();
+  }
+
+  SmallVector<SILValue, 8> Elements(NumElements, SILValue());
+  for (Operand *Use : Addr.getUses()) {
+    SILInstruction *User = Use->getUser();
+    if (auto *SI = dyn_cast<StoreInst>(User)) {
+      if (SI->getDest() != Addr || !Addr.hasOneUse())
+        return SILValue();
+      Dead.push_back(SI);
+      return SI->getSrc();
+    }
+
+    unsigned Idx;
+    if (auto *SEAI = dyn_cast<StructElementAddrInst>(User)) {
+      Idx = std::find(Fields.begin(), Fields.end(), SEAI->getField()) -
+            Fields.begin();
+    } else if (auto *TEAI = dyn_cast<TupleElementAddrInst>(User)) {
+      Idx = TEAI->getFieldNo();
+    } else {
+      return SILValue();
+    }
+    if (Idx >= NumElements || Elements[Idx])
+      return SILValue();
+
+    Elements[Idx] = getStoredValue(User, Loc, B, Dead);
+    if (!Elements[Idx])
+      return SILValue();
+    Dead.push_back(User);
+  }
+
+  if (NumElements == 0)
+    return SILValue();
+  for (SILValue Elt : Elements)
+    if (!Elt)
+      return SILValue();
+
+  if (SD)
+    return B.createStruct(Loc, Ty, Elements);
+  return B.createTuple(Loc, Ty, Elements);
+}
+
+/// SILGen initializes a struct or tuple global by storing each of its
+/// elements separately. Merge these stores into a single store of the
+/// aggregate, so that the initializer can become a static initializer.
+///
+/// \returns true if \p InitF was changed.
+static bool mergeElementStoresOfInitializer(SILFunction *InitF) {
+  // We only handle a single SILBasicBlock, like static initializers.
+  if (InitF->size() != 1)
+    return false;
+
+  SILBasicBlock *BB = &InitF->front();
+  GlobalAddrInst *GAI = nullptr;
+  for (auto &I : *BB) {
+    if (auto *A = dyn_cast<GlobalAddrInst>(&I)) {
+      if (GAI)
+        return false;
+      GAI = A;
+    }
+  }
+  if (!GAI || GAI->use_empty() ||
+      isa<StoreInst>(GAI->use_begin()->getUser()))
+    return false;
+
+  // All stored values are available at the end of the block.
+  SmallVector<SILInstruction *, 8> Created;
+  SmallVector<SILInstruction *, 8> Dead;
+  SILBuilderWithScope B(BB->getTerminator());
+  B.setTrackingList(&Created);
+  SILValue Val = getStoredValue(GAI, GAI->getLoc(), B, Dead);
+  if (!Val) {
+    for (auto *I : swift::reversed(Created))
+      I->eraseFromParent();
+    return false;
+  }
+
+  B.createStore(GAI->getLoc(), Val, GAI);
+  for (auto *I : Dead)
+    I->eraseFromParent();
+  return true;
+}
+
 /// Find the globalinit_func by analyzing the body of the addressor.
 static SILFunction *findInitializer(SILModule *Module, SILFunction *AddrF,
                                     BuiltinInst *&CallToOnce) {
@@ -856,6 +955,11 @@ void SILGlobalOpt::optimizeGlobalAccess(SILGlobalVariable *SILG,
 }
 
 bool SILGlobalOpt::run() {
+  for (auto &F : *Module) {
+    if (F.getName().startswith("globalinit_") && F.shouldOptimize())
+      HasChanged |= mergeElementStoresOfInitializer(&F);
+  }
+
   for (auto &F : *Module) {
 
     // Don't optimize functions that are marked with the opt.never attribute.
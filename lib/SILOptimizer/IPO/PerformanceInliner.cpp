@@ -32,6 +32,7 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/ADT/MapVector.h"
 #include <functional>
 
@@ -69,6 +70,10 @@ namespace {
   
   // Additional benefit for each loop level.
   const unsigned LoopBenefitFactor = 40;
+
+  // The maximum number of loop levels a call site is credited with because
+  // the profile shows that it runs more often than its caller.
+  const unsigned MaxProfiledLoopDepth = 4;
   
   // Approximately up to this cost level a function can be inlined without
   // increasing the code size.
@@ -560,6 +565,15 @@ static bool calleeHasMinimalSelfRecursion(SILFunction *Callee) {
   return false;
 }
 
+/// If the module links function bodies on demand, deserialize the body of
+/// \p Callee, along with the transparent and shared functions it references.
+static void linkCalleeOnDemand(SILFunction *Callee) {
+  SILModule &M = Callee->getModule();
+  if (!M.getOptions().LinkBodiesOnDemand || !Callee->isExternalDeclaration())
+    return;
+  M.linkFunction(Callee, SILModule::LinkingMode::LinkNormal);
+}
+
 // Returns the callee of an apply_inst if it is basically inlinable.
 SILFunction *SILPerformanceInliner::getEligibleFunction(FullApplySite AI) {
 
@@ -592,6 +606,11 @@ SILFunction *SILPerformanceInliner::getEligibleFunction(FullApplySite AI) {
     }
   }
 
+  // Bodies which are linked on demand are only deserialized once a call to
+  // them is considered for inlining.
+  if (Callee->getInlineStrategy() != NoInline)
+    linkCalleeOnDemand(Callee);
+
   // We can't inline external declarations.
   if (Callee->empty() || Callee->isExternalDeclaration()) {
     DEBUG(llvm::dbgs() << "        FAIL: Cannot inline external " <<
@@ -728,6 +747,18 @@ static SILBasicBlock *getTakenBlock(TermInst *term,
   return nullptr;
 }
 
+/// Return the number of loop levels the profile suggests for the call site:
+/// log2 of how many times it runs per execution of its caller.
+static unsigned getProfiledLoopDepth(FullApplySite AI) {
+  auto SiteCount = AI.getParent()->getProfileCount();
+  auto EntryCount = AI.getFunction()->front().getProfileCount();
+  if (!SiteCount || !EntryCount || *EntryCount == 0 ||
+      *SiteCount < *EntryCount)
+    return 0;
+  return std::min(MaxProfiledLoopDepth,
+                  llvm::Log2_64(*SiteCount / *EntryCount));
+}
+
 /// Return true if inlining this call site is profitable.
 bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
                                               unsigned loopDepthOfAI,
@@ -750,7 +781,8 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
   unsigned CalleeCost = 0;
   unsigned Benefit = InlineCostThreshold > 0 ? InlineCostThreshold :
                                                RemovedCallBenefit;
-  Benefit += loopDepthOfAI * LoopBenefitFactor;
+  Benefit += std::max(loopDepthOfAI, getProfiledLoopDepth(AI)) *
+             LoopBenefitFactor;
   int testThreshold = TestThreshold;
 
   while (SILBasicBlock *block = domOrder.getNext()) {
@@ -801,9 +833,11 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
   if (testThreshold >= 0) {
     // We are in testing mode.
     Threshold = testThreshold;
-  } else if (AI.getFunction()->isThunk()) {
-    // Only inline trivial functions into thunks (which will not increase the
-    // code size).
+  } else if (AI.getFunction()->isThunk() ||
+             AI.getModule().getOptions().Optimization ==
+               SILOptions::SILOptMode::OptimizeForSize) {
+    // Only inline trivial functions into thunks and when optimizing for size
+    // (which will not increase the code size).
     Threshold = TrivialFunctionThreshold;
   }
 
@@ -883,9 +917,20 @@ ApplySite SILPerformanceInliner::specializeGeneric(
 
   auto *Callee = Apply.getCalleeFunction();
 
-  if (!Callee || Callee->isExternalDeclaration())
+  if (!Callee)
     return ApplySite();
 
+  linkCalleeOnDemand(Callee);
+
+  // We can't specialize a function without a body, but its module may export
+  // a specialization for these substitutions.
+  if (Callee->isExternalDeclaration()) {
+    auto Specialized = tryUseExportedSpecialization(Apply);
+    if (Specialized)
+      replaceDeadApply(Apply, Specialized.getInstruction());
+    return Specialized;
+  }
+
   auto Filter = [](SILInstruction *I) -> bool {
     return ApplySite::isa(I) != ApplySite();
   };
@@ -27,6 +27,7 @@
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
 #include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
@@ -324,6 +325,9 @@ namespace {
 /// relies on knowledge of all array operations within the loop. If the array
 /// escapes in some way that cannot be tracked, the analysis must fail.
 ///
+/// Calls which take the array are safe if the callee's side-effect summary
+/// shows that it cannot create an alias of the array, see isNonAliasingCall.
+///
 /// TODO: Handle this pattern:
 ///   retain(array)
 ///   call(array)
@@ -339,6 +343,7 @@ class COWArrayOpt {
   typedef StructUseCollector::UserOperList UserOperList;
 
   RCIdentityFunctionInfo *RCIA;
+  SideEffectAnalysis *SEA;
   SILFunction *Function;
   SILLoop *Loop;
   SILBasicBlock *Preheader;
@@ -386,9 +391,9 @@ class COWArrayOpt {
   // analysing.
   SILValue CurrentArrayAddr;
 public:
-  COWArrayOpt(RCIdentityFunctionInfo *RCIA, SILLoop *L,
-              DominanceAnalysis *DA)
-      : RCIA(RCIA), Function(L->getHeader()->getParent()), Loop(L),
+  COWArrayOpt(RCIdentityFunctionInfo *RCIA, SideEffectAnalysis *SEA,
+              SILLoop *L, DominanceAnalysis *DA)
+      : RCIA(RCIA), SEA(SEA), Function(L->getHeader()->getParent()), Loop(L),
         Preheader(L->getLoopPreheader()), DomTree(DA->get(Function)),
         ColdBlocks(DA), CachedSafeLoop(false, false) {}
 
@@ -399,6 +404,7 @@ protected:
   SmallPtrSetImpl<SILBasicBlock*> &getReachingBlocks();
   bool isRetainReleasedBeforeMutate(SILInstruction *RetainInst,
                                     bool IsUniquelyIdentifiedArray = true);
+  bool isNonAliasingCall(ApplyInst *AI, bool ArrayPassedByAddress);
   bool checkSafeArrayAddressUses(UserList &AddressUsers);
   bool checkSafeArrayValueUses(UserList &ArrayValueUsers);
   bool checkSafeArrayElementUse(SILInstruction *UseInst, SILValue ArrayVal);
@@ -554,6 +560,55 @@ bool COWArrayOpt::isRetainReleasedBeforeMutate(SILInstruction *RetainInst,
   return false;
 }
 
+/// \return true if the side-effect summary of the callee of \p AI shows that
+/// the call cannot leave an alias of an array that is passed to it.
+///
+/// A callee which does not retain anything cannot copy the array buffer. An
+/// array passed by address must also not be written by the callee: it could
+/// store a different, possibly shared, array to it, e.g. by swapping it with
+/// another one. An array passed by value must be @guaranteed, because an
+/// @owned array can be stored without a retain. Finally the result must be
+/// trivial: a function with an @effects attribute may return a copy of the
+/// array without its retain showing up in the summary.
+bool COWArrayOpt::isNonAliasingCall(ApplyInst *AI, bool ArrayPassedByAddress) {
+  if (!AI->getType().isTrivial(AI->getModule()))
+    return false;
+
+  SideEffectAnalysis::FunctionEffects E;
+  SEA->getEffects(E, AI);
+  if (E.getGlobalEffects().mayRetain())
+    return false;
+
+  auto Params = AI->getSubstCalleeType()->getParameters();
+  auto ParamEffects = E.getParameterEffects();
+  for (unsigned ArgIdx = 0, ArgEnd = AI->getNumArguments(); ArgIdx != ArgEnd;
+       ++ArgIdx) {
+    if (ParamEffects[ArgIdx].mayRetain())
+      return false;
+
+    switch (Params[ArgIdx].getConvention()) {
+    case ParameterConvention::Indirect_Inout:
+      if (ParamEffects[ArgIdx].mayWrite())
+        return false;
+      break;
+    case ParameterConvention::Indirect_In_Guaranteed:
+    case ParameterConvention::Direct_Guaranteed:
+    case ParameterConvention::Direct_Unowned:
+      break;
+    case ParameterConvention::Direct_Owned:
+    case ParameterConvention::Direct_Deallocating:
+      if (!ArrayPassedByAddress &&
+          !AI->getArgument(ArgIdx).getType().isTrivial(AI->getModule()))
+        return false;
+      break;
+    default:
+      // @in, @out and @inout_aliasable arguments.
+      return false;
+    }
+  }
+  return true;
+}
+
 /// \return true if all given users of an array address are safe to hoist
 /// make_mutable across.
 ///
@@ -583,6 +638,9 @@ bool COWArrayOpt::checkSafeArrayAddressUses(UserList &AddressUsers) {
         continue;
       }
 
+      if (isNonAliasingCall(AI, /*ArrayPassedByAddress=*/true))
+        continue;
+
       DEBUG(llvm::dbgs() << "    Skipping Array: may escape through call!\n    "
             << *UseInst);
       return false;
@@ -653,6 +711,9 @@ bool COWArrayOpt::checkSafeArrayValueUses(UserList &ArrayValueUsers) {
       if (ArraySemanticsCall(AI))
         continue;
 
+      if (isNonAliasingCall(AI, /*ArrayPassedByAddress=*/false))
+        continue;
+
       // Found an unsafe or unknown user. The Array may escape here.
       DEBUG(llvm::dbgs() << "    Skipping Array: unsafe call!\n    "
             << *UseInst);
@@ -1533,6 +1594,7 @@ class COWArrayOptPass : public SILFunctionTransform {
       DEBUG(llvm::dbgs() << "  Skipping Function: No loops.\n");
       return;
     }
+    auto *SEA = PM->getAnalysis<SideEffectAnalysis>();
 
 #ifndef NDEBUG
     if (!COWViewCFGFunction.empty() && getFunction()->getName() == COWViewCFGFunction) {
@@ -1553,7 +1615,7 @@ class COWArrayOptPass : public SILFunctionTransform {
 
     bool HasChanged = false;
     for (auto *L : Loops)
-      HasChanged |= COWArrayOpt(RCIA, L, DA).run();
+      HasChanged |= COWArrayOpt(RCIA, SEA, L, DA).run();
 
       if (HasChanged) {
         invalidateAnalysis(SILAnalysis::InvalidationKind::CallsAndInstructions);
@@ -1609,6 +1671,11 @@ namespace {
 static llvm::cl::opt<bool> ShouldSpecializeArrayProps("sil-array-props",
                                                       llvm::cl::init(true));
 
+static llvm::cl::opt<bool>
+    EnableVectorizationHints("sil-array-props-vectorize", llvm::cl::init(true),
+                             llvm::cl::desc("Ask LLVM to vectorize check-free "
+                                            "specialized array loops"));
+
 /// Analysis whether it is safe to specialize this loop nest based on the
 /// array.props function calls it contains. It is safe to hoist array.props
 /// calls if the array does not escape such that the array container could be
@@ -2187,6 +2254,47 @@ static void replaceArrayPropsCall(SILBuilder &B, ArraySemanticsCall C) {
   C.removeCall();
 }
 
+/// Returns true if \p BB still checks an array's bounds or uniqueness.
+static bool hasArrayCheck(SILBasicBlock *BB) {
+  for (auto &Inst : *BB) {
+    ArraySemanticsCall Call(&Inst);
+    if (!Call)
+      continue;
+    switch (Call.getKind()) {
+    case ArrayCallKind::kArrayPropsIsNativeTypeChecked:
+    case ArrayCallKind::kCheckSubscript:
+    case ArrayCallKind::kCheckIndex:
+    case ArrayCallKind::kMakeMutable:
+    case ArrayCallKind::kMutateUnknown:
+      return true;
+    default:
+      break;
+    }
+  }
+  return false;
+}
+
+/// Mark the latches of the innermost loops in the cloned copy of \p L whose
+/// bodies are free of array checks, so that IRGen asks LLVM to vectorize
+/// them.
+static void addVectorizationHints(
+    SILLoop *L, llvm::MapVector<SILBasicBlock *, SILBasicBlock *> &BBMap) {
+  if (!L->empty()) {
+    for (auto *SubLoop : *L)
+      addVectorizationHints(SubLoop, BBMap);
+    return;
+  }
+
+  for (auto *BB : L->getBlocks())
+    if (hasArrayCheck(BBMap[BB]))
+      return;
+
+  SmallVector<SILBasicBlock *, 4> Latches;
+  L->getLoopLatches(Latches);
+  for (auto *Latch : Latches)
+    BBMap[Latch]->setVectorizationHint();
+}
+
 void ArrayPropertiesSpecializer::specializeLoopNest() {
   auto *Lp = getLoop();
   assert(Lp);
@@ -2254,6 +2362,11 @@ void ArrayPropertiesSpecializer::specializeLoopNest() {
   for (auto C : ArrayPropCalls)
     replaceArrayPropsCall(B2, C);
 
+  // Bounds checks have already been hoisted, so the innermost loops of the
+  // fast loop nest may now be free of checks that block vectorization.
+  if (EnableVectorizationHints)
+    addVectorizationHints(Lp, Cloner.getBBMap());
+
   // We have potentially cloned a loop - invalidate loop info.
   LoopAnalysis->invalidate(Header->getParent(),
                            SILAnalysis::InvalidationKind::FunctionBody);
@@ -2262,6 +2375,11 @@ void ArrayPropertiesSpecializer::specializeLoopNest() {
 namespace {
 class SwiftArrayOptPass : public SILFunctionTransform {
 
+  bool preservesAnalysis(SILAnalysis::AnalysisKind Kind) const override {
+    // We keep the dominator tree up to date.
+    return Kind == SILAnalysis::AnalysisKind::Dominance;
+  }
+
   void run() override {
     if (!ShouldSpecializeArrayProps)
       return;
@@ -2313,11 +2431,7 @@ class SwiftArrayOptPass : public SILFunctionTransform {
     }
 
     if (HasChanged) {
-      // We preserve the dominator tree. Let's invalidate everything
-      // else.
-      DA->lockInvalidation();
       invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
-      DA->unlockInvalidation();
     }
   }
 
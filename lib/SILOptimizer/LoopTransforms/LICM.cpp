@@ -13,6 +13,7 @@
 #define DEBUG_TYPE "sil-licm"
 
 #include "swift/SIL/Dominance.h"
+#include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/Analysis.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
@@ -28,7 +29,9 @@
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILInstruction.h"
 
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/Debug.h"
 
@@ -106,20 +109,21 @@ static void removeWrittenTo(AliasAnalysis *AA, ReadSet &Reads,
   }
 }
 
+/// Returns true if \p V is defined outside of the loop \p L.
+static bool isLoopInvariant(SILValue V, SILLoop *L) {
+  auto *Def = V.getDef();
+  if (auto *Inst = dyn_cast<SILInstruction>(Def))
+    return !L->contains(Inst->getParent());
+  if (auto *Arg = dyn_cast<SILArgument>(Def))
+    return !L->contains(Arg->getParent());
+  return false;
+}
+
 static bool hasLoopInvariantOperands(SILInstruction *I, SILLoop *L) {
   auto Opds = I->getAllOperands();
 
   return std::all_of(Opds.begin(), Opds.end(), [=](Operand &Op) {
-
-    auto *Def = Op.get().getDef();
-
-    // Operand is defined outside the loop.
-    if (auto *Inst = dyn_cast<SILInstruction>(Def))
-      return !L->contains(Inst->getParent());
-    if (auto *Arg = dyn_cast<SILArgument>(Def))
-      return !L->contains(Arg->getParent());
-
-    return false;
+    return isLoopInvariant(Op.get(), L);
   });
 }
 
@@ -297,6 +301,19 @@ static bool hoistInstructions(SILLoop *Loop, DominanceInfo *DT,
             semCall.hoist(Preheader->getTerminator(), DT);
           }
           break;
+        case ArrayCallKind::kCheckIndex:
+        case ArrayCallKind::kCheckSubscript:
+          // The array.props argument of check_subscript is computed in the
+          // loop; hoist() copies it. The array value itself is immutable on
+          // high-level SIL, so the check has the same outcome in every
+          // iteration if the array and the index are loop invariant.
+          if (isLoopInvariant(semCall.getSelf(), Loop) &&
+              isLoopInvariant(semCall.getIndex(), Loop) &&
+              semCall.canHoist(Preheader->getTerminator(), DT)) {
+            Changed = true;
+            semCall.hoist(Preheader->getTerminator(), DT);
+          }
+          break;
         default:
           break;
         }
@@ -370,6 +387,125 @@ static bool sinkFixLiftime(SILLoop *Loop, DominanceInfo *DomTree,
   return Changed;
 }
 
+/// Returns true if \p Retain and \p Release increment and decrement the
+/// reference count in the same way.
+static bool isMatchingRetainRelease(SILInstruction *Retain,
+                                    SILInstruction *Release) {
+  if (isa<StrongRetainInst>(Retain))
+    return isa<StrongReleaseInst>(Release);
+  return isa<RetainValueInst>(Retain) && isa<ReleaseValueInst>(Release);
+}
+
+/// Hoist a retain of a loop invariant value to the preheader and sink the
+/// matching release to the loop exits.
+///
+/// This is done if the loop contains exactly one retain and one release of
+/// the value, the retain dominates the release and the release is executed in
+/// every iteration. Nothing else in the loop may decrement or check the
+/// reference count of the value: the value stays retained for the whole loop
+/// instead of within each iteration.
+static bool hoistRetainReleasePairs(SILLoop *Loop, DominanceInfo *DT,
+                                    SILLoopInfo *LI, AliasAnalysis *AA) {
+  auto *Preheader = Loop->getLoopPreheader();
+  if (!Preheader)
+    return false;
+
+  // The release is inserted at the beginning of the exit blocks. That is only
+  // correct if they are not reachable from outside the loop.
+  SmallVector<SILBasicBlock *, 8> ExitBBs;
+  Loop->getExitBlocks(ExitBBs);
+  for (auto *ExitBB : ExitBBs)
+    for (auto *Pred : ExitBB->getPreds())
+      if (!Loop->contains(Pred))
+        return false;
+
+  // Collect the retains and releases of loop invariant values.
+  llvm::MapVector<SILValue, std::pair<SILInstruction *, SILInstruction *>>
+      Pairs;
+  llvm::DenseSet<SILValue> RetainedOrReleasedTwice;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      bool IsRetain = isa<StrongRetainInst>(&Inst) ||
+                      isa<RetainValueInst>(&Inst);
+      bool IsRelease = isa<StrongReleaseInst>(&Inst) ||
+                       isa<ReleaseValueInst>(&Inst);
+      if (!IsRetain && !IsRelease)
+        continue;
+      SILValue V = Inst.getOperand(0);
+      if (!isLoopInvariant(V, Loop))
+        continue;
+      auto &Pair = Pairs[V];
+      SILInstruction *&Slot = IsRetain ? Pair.first : Pair.second;
+      if (Slot)
+        RetainedOrReleasedTwice.insert(V);
+      Slot = &Inst;
+    }
+  }
+
+  SmallVector<SILBasicBlock *, 8> ExitingBBs;
+  Loop->getExitingBlocks(ExitingBBs);
+  SmallVector<SILBasicBlock *, 4> Latches;
+  Loop->getLoopLatches(Latches);
+
+  bool Changed = false;
+  for (auto &Pair : Pairs) {
+    SILValue V = Pair.first;
+    SILInstruction *Retain = Pair.second.first;
+    SILInstruction *Release = Pair.second.second;
+    if (!Retain || !Release || RetainedOrReleasedTwice.count(V) ||
+        !isMatchingRetainRelease(Retain, Release))
+      continue;
+
+    // Both must be executed exactly once per iteration, the retain first.
+    if (LI->getLoopFor(Retain->getParent()) != Loop ||
+        LI->getLoopFor(Release->getParent()) != Loop)
+      continue;
+    if (!DT->properlyDominates(Retain, Release))
+      continue;
+    auto *ReleaseBB = Release->getParent();
+    auto DominatedByRelease = [=](SILBasicBlock *BB) {
+      return DT->dominates(ReleaseBB, BB);
+    };
+    if (!std::all_of(ExitingBBs.begin(), ExitingBBs.end(),
+                     DominatedByRelease) ||
+        !std::all_of(Latches.begin(), Latches.end(), DominatedByRelease))
+      continue;
+
+    // The extra reference must not be observable in the loop.
+    bool IsObservable = false;
+    for (auto *BB : Loop->getBlocks()) {
+      for (auto &Inst : *BB) {
+        if (&Inst == Retain || &Inst == Release)
+          continue;
+        if (mayCheckRefCount(&Inst) || mayDecrementRefCount(&Inst, V, AA)) {
+          DEBUG(llvm::dbgs() << "  may observe the retain of " << V << "  "
+                             << Inst);
+          IsObservable = true;
+          break;
+        }
+      }
+      if (IsObservable)
+        break;
+    }
+    if (IsObservable)
+      continue;
+
+    DEBUG(llvm::dbgs() << "  hoisting " << *Retain << "  and sinking "
+                       << *Release);
+    Retain->moveBefore(Preheader->getTerminator());
+    for (auto *ExitBB : ExitBBs) {
+      SILBuilder B(ExitBB->begin());
+      if (isa<StrongReleaseInst>(Release))
+        B.createStrongRelease(Release->getLoc(), V);
+      else
+        B.createReleaseValue(Release->getLoc(), V);
+    }
+    Release->eraseFromParent();
+    Changed = true;
+  }
+  return Changed;
+}
+
 namespace {
 /// \brief Summmary of may writes occuring in the loop tree rooted at \p
 /// Loop. This includes all writes of the sub loops and the loop itself.
@@ -520,6 +656,7 @@ void LoopTreeOptimization::optimizeLoop(SILLoop *CurrentLoop,
   Changed |= sinkCondFail(CurrentLoop);
   Changed |= hoistInstructions(CurrentLoop, DomTree, SafeReads,
                                RunsOnHighLevelSil);
+  Changed |= hoistRetainReleasePairs(CurrentLoop, DomTree, LoopInfo, AA);
   Changed |= sinkFixLiftime(CurrentLoop, DomTree, LoopInfo);
 }
 
@@ -541,6 +678,12 @@ public:
                                 "Loop Invariant Code Motion";
   }
 
+  bool preservesAnalysis(SILAnalysis::AnalysisKind Kind) const override {
+    // We keep loop info and the dominator tree up to date.
+    return Kind == SILAnalysis::AnalysisKind::Dominance ||
+           Kind == SILAnalysis::AnalysisKind::Loop;
+  }
+
   void run() override {
     SILFunction *F = getFunction();
     SILLoopAnalysis *LA = PM->getAnalysis<SILLoopAnalysis>();
@@ -567,11 +710,7 @@ public:
     }
 
     if (Changed) {
-      LA->lockInvalidation();
-      DA->lockInvalidation();
       PM->invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
-      LA->unlockInvalidation();
-      DA->unlockInvalidation();
     }
   }
 };
@@ -414,6 +414,12 @@ class LoopRotation : public SILFunctionTransform {
 
   StringRef getName() override { return "SIL Loop Rotation"; }
 
+  bool preservesAnalysis(SILAnalysis::AnalysisKind Kind) const override {
+    // We keep loop info and the dominator tree up to date.
+    return Kind == SILAnalysis::AnalysisKind::Dominance ||
+           Kind == SILAnalysis::AnalysisKind::Loop;
+  }
+
   void run() override {
     SILLoopAnalysis *LA = PM->getAnalysis<SILLoopAnalysis>();
     assert(LA);
@@ -457,12 +463,7 @@ class LoopRotation : public SILFunctionTransform {
     }
 
     if (Changed) {
-      // We preserve loop info and the dominator tree.
-      DA->lockInvalidation();
-      LA->lockInvalidation();
       PM->invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
-      DA->unlockInvalidation();
-      LA->unlockInvalidation();
     }
   }
 };
@@ -13,9 +13,11 @@
 #define DEBUG_TYPE "sil-loopunroll"
 
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/Support/CommandLine.h"
 
 #include "swift/SIL/PatternMatch.h"
 #include "swift/SIL/SILCloner.h"
+#include "swift/SILOptimizer/Analysis/IVAnalysis.h"
 #include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
@@ -30,6 +32,15 @@ using llvm::MapVector;
 
 static const uint64_t SILLoopUnrollThreshold = 250;
 
+/// The maximum number of non-free instructions in the body of a partially
+/// unrolled loop.
+static const uint64_t SILLoopPartialUnrollThreshold = 64;
+
+static llvm::cl::opt<unsigned> SILLoopPartialUnrollFactor(
+    "sil-loop-partial-unroll-factor", llvm::cl::init(4),
+    llvm::cl::desc("The number of iterations a loop with a runtime trip count "
+                   "is unrolled by. Zero or one disables partial unrolling."));
+
 namespace {
 
 /// Clone the basic blocks in a loop.
@@ -419,6 +430,280 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
   return true;
 }
 
+// =============================================================================
+//                    Partial unrolling with a runtime trip count
+// =============================================================================
+
+namespace {
+
+/// An add 1 induction variable that exits the loop when it reaches a loop
+/// invariant end value.
+struct RuntimeTripCount {
+  /// The induction variable's header argument.
+  SILArgument *IndVar;
+  /// The value of the induction variable on entry to the loop.
+  SILValue Start;
+  /// The value at which the loop exits.
+  SILValue End;
+  /// The block whose conditional branch exits the loop.
+  SILBasicBlock *Exiting;
+};
+
+} // end anonymous namespace.
+
+/// Match a loop whose only exit is taken once an induction variable reaches a
+/// value that is computed before the loop, like the loops of
+/// 'for i in 0..<n'. The trip count is then only known at runtime.
+static Optional<RuntimeTripCount>
+getRuntimeTripCount(SILLoop *Loop, SILBasicBlock *Preheader,
+                    SILBasicBlock *Header, SILBasicBlock *Latch, IVInfo &IVs) {
+  // Skip a split backedge.
+  SILBasicBlock *Exiting = Latch;
+  if (!Loop->isLoopExiting(Exiting) &&
+      !(Exiting = Exiting->getSinglePredecessor()))
+    return None;
+
+  SmallVector<SILBasicBlock *, 4> ExitingBlocks;
+  Loop->getExitingBlocks(ExitingBlocks);
+  if (ExitingBlocks.size() != 1 || ExitingBlocks[0] != Exiting)
+    return None;
+
+  // The exit must be on the true side of the loop exit condition and the
+  // other side must lead to the next iteration.
+  auto *CondBr = dyn_cast<CondBranchInst>(Exiting->getTerminator());
+  if (!CondBr || Loop->contains(CondBr->getTrueBB()))
+    return None;
+  if (CondBr->getFalseBB() != (Exiting == Latch ? Header : Latch))
+    return None;
+
+  // Match an add 1 recurrence compared against a loop invariant value.
+  SILArgument *RecArg;
+  SILValue RecNext, End;
+  if (!match(CondBr->getCondition(),
+             m_BuiltinInst(BuiltinValueKind::ICMP_EQ, m_SILValue(RecNext),
+                           m_SILValue(End))))
+    return None;
+  if (!match(RecNext,
+             m_TupleExtractInst(m_ApplyInst(BuiltinValueKind::SAddOver,
+                                            m_SILArgument(RecArg), m_One()),
+                                0)))
+    return None;
+
+  if (RecArg->getParent() != Header ||
+      RecNext != RecArg->getIncomingValue(Latch))
+    return None;
+  if (!IVs.isInductionVariable(RecArg) ||
+      IVs.getInductionVariableHeader(RecArg) != RecArg)
+    return None;
+
+  if (auto *EndBB = End.getDef()->getParentBB())
+    if (Loop->contains(EndBB))
+      return None;
+
+  return RuntimeTripCount{RecArg, RecArg->getIncomingValue(Preheader), End,
+                          Exiting};
+}
+
+/// Return the number of iterations the loop should be unrolled by, or zero if
+/// it should not be unrolled.
+static unsigned getPartialUnrollFactor(SILLoop *Loop) {
+  assert(Loop->getSubLoops().empty() && "Expect innermost loops");
+  unsigned Factor = SILLoopPartialUnrollFactor;
+  if (Factor < 2)
+    return 0;
+
+  uint64_t Cost = 0;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      if (!Loop->canDuplicate(&Inst))
+        return 0;
+      if (instructionInlineCost(Inst) != InlineCost::Free)
+        ++Cost;
+    }
+  }
+
+  // Rather unroll by a smaller factor than not at all.
+  while (Factor >= 2 && Cost * Factor > SILLoopPartialUnrollThreshold)
+    Factor /= 2;
+  return Factor < 2 ? 0 : Factor;
+}
+
+/// Redirect the backedge of an unrolled copy of the loop to \p NextHeader. If
+/// \p RemoveExit is true the copy's exit branch is removed as well, because the
+/// caller knows that the loop is not exited in this copy.
+static void redirectBackedge(SILBasicBlock *Exiting, SILBasicBlock *Latch,
+                             SILBasicBlock *NextHeader, bool RemoveExit) {
+  // The exit is on the true side of the exiting block's conditional branch,
+  // see getRuntimeTripCount.
+  auto *CondBr = cast<CondBranchInst>(Exiting->getTerminator());
+
+  // Handle the split backedge case.
+  if (Exiting != Latch) {
+    auto *Br = cast<BranchInst>(Latch->getTerminator());
+    SILBuilder(Br).createBranch(Br->getLoc(), NextHeader, Br->getArgs());
+    Br->eraseFromParent();
+    if (RemoveExit) {
+      SILBuilder(CondBr).createBranch(CondBr->getLoc(), Latch,
+                                      CondBr->getFalseArgs());
+      CondBr->eraseFromParent();
+    }
+    return;
+  }
+
+  if (RemoveExit)
+    SILBuilder(CondBr).createBranch(CondBr->getLoc(), NextHeader,
+                                    CondBr->getFalseArgs());
+  else
+    SILBuilder(CondBr).createCondBranch(
+        CondBr->getLoc(), CondBr->getCondition(), CondBr->getTrueBB(),
+        CondBr->getTrueArgs(), NextHeader, CondBr->getFalseArgs());
+  CondBr->eraseFromParent();
+}
+
+/// Create a block with the same argument types as \p Header.
+static SILBasicBlock *
+createBlockWithHeaderArgs(SILBasicBlock *Header,
+                          SmallVectorImpl<SILValue> &Args) {
+  auto *F = Header->getParent();
+  auto *BB = new (F->getModule()) SILBasicBlock(F);
+  for (auto *Arg : Header->getBBArgs())
+    Args.push_back(new (F->getModule()) SILArgument(BB, Arg->getType()));
+  return BB;
+}
+
+/// Try to unroll a loop with a runtime trip count by a constant factor.
+///
+/// The unrolled loop is only entered if it executes at least one full round
+/// of Factor iterations. It checks for the loop exit only in its last copy of
+/// the body, so the copies form one straight-line body that later passes and
+/// LLVM can optimize as a whole. The original loop stays behind as the
+/// remainder loop; it runs the iterations that are left when fewer than
+/// Factor remain, and all iterations of loops that are too short to enter the
+/// unrolled loop.
+///
+///   preheader:
+///     cond_br (start <= end && end - start >= Factor), unrolled, remainder
+///   unrolled copies 1..Factor-1:   no exit check
+///   unrolled copy Factor:          cond_br (iv == end), exit, check
+///   check:
+///     cond_br (end - iv >= Factor), unrolled, remainder
+///   remainder:                     the original loop
+static bool tryToPartiallyUnrollLoop(SILLoop *Loop, IVInfo &IVs) {
+  assert(Loop->getSubLoops().empty() && "Expecting innermost loops");
+
+  auto *Preheader = Loop->getLoopPreheader();
+  if (!Preheader)
+    return false;
+  auto *PreheaderBr = dyn_cast<BranchInst>(Preheader->getTerminator());
+  if (!PreheaderBr)
+    return false;
+
+  auto *Latch = Loop->getLoopLatch();
+  if (!Latch)
+    return false;
+
+  auto *Header = Loop->getHeader();
+
+  Optional<RuntimeTripCount> TripCount =
+      getRuntimeTripCount(Loop, Preheader, Header, Latch, IVs);
+  if (!TripCount)
+    return false;
+
+  unsigned Factor = getPartialUnrollFactor(Loop);
+  if (!Factor)
+    return false;
+
+  DEBUG(llvm::dbgs() << "Partially unrolling loop by " << Factor << " in "
+                     << Header->getParent()->getName() << " " << *Loop
+                     << "\n");
+
+  SmallVector<SILBasicBlock *, 8> Headers;
+  SmallVector<SILBasicBlock *, 8> Latches;
+  SmallVector<SILBasicBlock *, 8> ExitingBlocks;
+  DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
+
+  for (unsigned Cnt = 0; Cnt < Factor; ++Cnt) {
+    LoopCloner Cloner(Loop);
+    Cloner.cloneLoop();
+    Headers.push_back(Cloner.getBBMap()[Header]);
+    Latches.push_back(Cloner.getBBMap()[Latch]);
+    ExitingBlocks.push_back(Cloner.getBBMap()[TripCount->Exiting]);
+
+    // Only the last copy exits the loop, so its values are the only new ones
+    // that reach uses outside of the loop.
+    if (Cnt == Factor - 1)
+      collectLoopLiveOutValues(LoopLiveOutValues, Loop, Cloner.getValueMap(),
+                               Cloner.getInstMap());
+  }
+
+  auto Loc = PreheaderBr->getLoc();
+  auto &Ctx = Header->getParent()->getASTContext();
+  SILType IVTy = TripCount->IndVar->getType();
+  SILType Int1Ty = SILType::getBuiltinIntegerType(1, Ctx);
+  unsigned IVIdx = TripCount->IndVar->getIndex();
+  SILValue End = TripCount->End;
+
+  // The remainder loop is entered from the preheader and from the unrolled
+  // loop. Give it a preheader of its own.
+  SmallVector<SILValue, 8> RemainderArgs;
+  auto *RemainderPreheader = createBlockWithHeaderArgs(Header, RemainderArgs);
+  SILBuilder(RemainderPreheader).createBranch(Loc, Header, RemainderArgs);
+
+  // After a round of Factor iterations check whether another full round
+  // remains. The last copy's exit check guarantees that iv != end here.
+  SmallVector<SILValue, 8> CheckArgs;
+  auto *Check = createBlockWithHeaderArgs(Header, CheckArgs);
+  {
+    SILBuilder B(Check);
+    auto *FactorVal = B.createIntegerLiteral(Loc, IVTy, Factor);
+    auto *Remaining = B.createBuiltinBinaryFunction(
+        Loc, "sub", IVTy, IVTy, {End, CheckArgs[IVIdx]});
+    auto *FullRound = B.createBuiltinBinaryFunction(
+        Loc, "cmp_uge", IVTy, Int1Ty, {Remaining, FactorVal});
+    B.createCondBranch(Loc, FullRound, Headers[0], CheckArgs,
+                       RemainderPreheader, CheckArgs);
+  }
+
+  // Thread the copies of the body into the unrolled loop.
+  for (unsigned Cnt = 0; Cnt < Factor; ++Cnt) {
+    bool IsLast = Cnt == Factor - 1;
+    redirectBackedge(ExitingBlocks[Cnt], Latches[Cnt],
+                     IsLast ? Check : Headers[Cnt + 1], !IsLast);
+  }
+
+  // Enter the unrolled loop only if it runs at least one full round. The loop
+  // does not terminate normally if start > end; leave that to the remainder
+  // loop. If start <= end the distance end - start fits into an unsigned
+  // integer of the induction variable's width.
+  {
+    SmallVector<SILValue, 8> EntryArgs(PreheaderBr->getArgs().begin(),
+                                       PreheaderBr->getArgs().end());
+    SILValue Start = TripCount->Start;
+    SILBuilder B(PreheaderBr);
+    auto *FactorVal = B.createIntegerLiteral(Loc, IVTy, Factor);
+    auto *InOrder = B.createBuiltinBinaryFunction(Loc, "cmp_sle", IVTy, Int1Ty,
+                                                  {Start, End});
+    auto *Distance =
+        B.createBuiltinBinaryFunction(Loc, "sub", IVTy, IVTy, {End, Start});
+    auto *FullRound = B.createBuiltinBinaryFunction(
+        Loc, "cmp_uge", IVTy, Int1Ty, {Distance, FactorVal});
+    auto *Unroll = B.createBuiltinBinaryFunction(Loc, "and", Int1Ty, Int1Ty,
+                                                 {InOrder, FullRound});
+
+    auto *F = Header->getParent();
+    auto *UnrolledPreheader = new (F->getModule()) SILBasicBlock(F);
+    SILBuilder(UnrolledPreheader).createBranch(Loc, Headers[0], EntryArgs);
+
+    B.createCondBranch(Loc, Unroll, UnrolledPreheader, ArrayRef<SILValue>(),
+                       RemainderPreheader, EntryArgs);
+    PreheaderBr->eraseFromParent();
+  }
+
+  // Fixup SSA form for loop values used outside the loop.
+  updateSSA(Loop, LoopLiveOutValues);
+  return true;
+}
+
 // =============================================================================
 //                                 Driver
 // =============================================================================
@@ -450,9 +735,14 @@ class LoopUnrolling : public SILFunctionTransform {
       }
     }
 
-    // Try to unroll innermost loops.
+    if (InnermostLoops.empty())
+      return;
+
+    // Try to fully unroll innermost loops and fall back to partially
+    // unrolling loops with a runtime trip count.
+    IVInfo &IVs = *PM->getAnalysis<IVAnalysis>()->get(Fun);
     for (auto *Loop : InnermostLoops)
-      Changed |= tryToUnrollLoop(Loop);
+      Changed |= tryToUnrollLoop(Loop) || tryToPartiallyUnrollLoop(Loop, IVs);
 
     if (Changed) {
       invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
@@ -171,77 +171,101 @@ static Optional<DIKind> mergeKinds(Optional<DIKind> OK1, Optional<DIKind> OK2) {
 namespace {
   /// AvailabilitySet - This class stores an array of lattice values for tuple
   /// elements being analyzed for liveness computations.  Each element is
-  /// represented with two bits in a bitvector, allowing this to represent the
-  /// lattice values corresponding to "Unknown" (bottom), "Live" or "Not Live",
-  /// which are the middle elements of the lattice, and "Partial" which is the
-  /// top element.
+  /// represented with one bit in each of two bitvectors, allowing this to
+  /// represent the lattice values corresponding to "Unknown" (bottom), "Live"
+  /// or "Not Live", which are the middle elements of the lattice, and
+  /// "Partial" which is the top element.
+  ///
+  /// A lattice value is the set of states ("No" and "Yes") the element may be
+  /// in, so the lattice merge operation is a union.  This lets every operation
+  /// on the whole set work a word at a time, which matters for initializers of
+  /// types with many stored properties.
   class AvailabilitySet {
-    // We store two bits per element, encoded in the following form:
-    //   T,T -> Nothing/Unknown
-    //   F,F -> No
-    //   F,T -> Yes
-    //   T,F -> Partial
-    llvm::SmallBitVector Data;
+    // We store one bit per element in each vector, in the following form:
+    //   MayBeNo=F, MayBeYes=F -> Nothing/Unknown
+    //   MayBeNo=T, MayBeYes=F -> No
+    //   MayBeNo=F, MayBeYes=T -> Yes
+    //   MayBeNo=T, MayBeYes=T -> Partial
+    llvm::SmallBitVector MayBeNo, MayBeYes;
   public:
-    AvailabilitySet(unsigned NumElts) {
-      Data.resize(NumElts*2, true);
-    }
+    AvailabilitySet(unsigned NumElts)
+      : MayBeNo(NumElts), MayBeYes(NumElts) {}
 
-    bool empty() const { return Data.empty(); }
-    unsigned size() const { return Data.size()/2; }
+    bool empty() const { return MayBeNo.empty(); }
+    unsigned size() const { return MayBeNo.size(); }
 
     DIKind get(unsigned Elt) const {
       return getConditional(Elt).getValue();
     }
 
     Optional<DIKind> getConditional(unsigned Elt) const {
-      bool V1 = Data[Elt*2], V2 = Data[Elt*2+1];
-      if (V1 == V2)
-        return V1 ? Optional<DIKind>(None) : DIKind::No;
-      return V2 ? DIKind::Yes : DIKind::Partial;
+      bool No = MayBeNo[Elt], Yes = MayBeYes[Elt];
+      if (No && Yes)
+        return DIKind::Partial;
+      if (Yes)
+        return DIKind::Yes;
+      if (No)
+        return DIKind::No;
+      return None;
     }
 
     void set(unsigned Elt, DIKind K) {
-      switch (K) {
-      case DIKind::No:      Data[Elt*2] = false; Data[Elt*2+1] = false; break;
-      case DIKind::Yes:     Data[Elt*2] = false, Data[Elt*2+1] = true; break;
-      case DIKind::Partial: Data[Elt*2] = true,  Data[Elt*2+1] = false; break;
-      }
+      MayBeNo[Elt] = K != DIKind::Yes;
+      MayBeYes[Elt] = K != DIKind::No;
     }
     
     void set(unsigned Elt, Optional<DIKind> K) {
       if (!K.hasValue())
-        Data[Elt*2] = true, Data[Elt*2+1] = true;
+        MayBeNo.reset(Elt), MayBeYes.reset(Elt);
       else
         set(Elt, K.getValue());
     }
 
+    /// Set the elements in the range [FirstElt, FirstElt+NumElts) to \p K.
+    void set(unsigned FirstElt, unsigned NumElts, DIKind K) {
+      unsigned End = FirstElt + NumElts;
+      if (K != DIKind::Yes)
+        MayBeNo.set(FirstElt, End);
+      else
+        MayBeNo.reset(FirstElt, End);
+      if (K != DIKind::No)
+        MayBeYes.set(FirstElt, End);
+      else
+        MayBeYes.reset(FirstElt, End);
+    }
+
     /// containsUnknownElements - Return true if there are any elements that are
     /// unknown.
     bool containsUnknownElements() const {
-      // Check that we didn't get any unknown values.
-      for (unsigned i = 0, e = size(); i != e; ++i)
-        if (!getConditional(i).hasValue())
-          return true;
-      return false;
+      llvm::SmallBitVector Known(MayBeNo);
+      Known |= MayBeYes;
+      return !Known.all();
     }
 
     bool isAll(DIKind K) const {
-      for (unsigned i = 0, e = size(); i != e; ++i) {
-        auto Elt = getConditional(i);
-        if (!Elt.hasValue() || Elt.getValue() != K)
-          return false;
+      switch (K) {
+      case DIKind::No:      return MayBeNo.all() && MayBeYes.none();
+      case DIKind::Yes:     return MayBeNo.none() && MayBeYes.all();
+      case DIKind::Partial: return MayBeNo.all() && MayBeYes.all();
       }
-      return true;
+      llvm_unreachable("bad DIKind");
     }
     
     bool hasAny(DIKind K) const {
-      for (unsigned i = 0, e = size(); i != e; ++i) {
-        auto Elt = getConditional(i);
-        if (Elt.hasValue() && Elt.getValue() == K)
-          return true;
+      llvm::SmallBitVector Matches;
+      switch (K) {
+      case DIKind::No:
+        Matches = MayBeNo;
+        Matches.reset(MayBeYes);
+        return Matches.any();
+      case DIKind::Yes:
+        Matches = MayBeYes;
+        Matches.reset(MayBeNo);
+        return Matches.any();
+      case DIKind::Partial:
+        return MayBeNo.anyCommon(MayBeYes);
       }
-      return false;
+      llvm_unreachable("bad DIKind");
     }
     
     bool isAllYes() const { return isAll(DIKind::Yes); }
@@ -250,16 +274,46 @@ namespace {
     /// changeUnsetElementsTo - If any elements of this availability set are not
     /// known yet, switch them to the specified value.
     void changeUnsetElementsTo(DIKind K) {
-      for (unsigned i = 0, e = size(); i != e; ++i)
-        if (!getConditional(i).hasValue())
-          set(i, K);
+      llvm::SmallBitVector Unset(MayBeNo);
+      Unset |= MayBeYes;
+      Unset.flip();
+      if (K != DIKind::Yes)
+        MayBeNo |= Unset;
+      if (K != DIKind::No)
+        MayBeYes |= Unset;
     }
     
     void mergeIn(const AvailabilitySet &RHS) {
       // Logically, this is an elementwise "this = merge(this, RHS)" operation,
       // using the lattice merge operation for each element.
-      for (unsigned i = 0, e = size(); i != e; ++i)
-        set(i, mergeKinds(getConditional(i), RHS.getConditional(i)));
+      MayBeNo |= RHS.MayBeNo;
+      MayBeYes |= RHS.MayBeYes;
+    }
+
+    /// Merge \p RHS into the elements that are unknown in \p Local, and set
+    /// all other elements to their value in \p Local.
+    ///
+    /// \returns true if this set changed.
+    bool transferFrom(const AvailabilitySet &RHS,
+                      const AvailabilitySet &Local) {
+      llvm::SmallBitVector LocalKnown(Local.MayBeNo);
+      LocalKnown |= Local.MayBeYes;
+
+      llvm::SmallBitVector NewNo(MayBeNo);
+      NewNo |= RHS.MayBeNo;
+      NewNo.reset(LocalKnown);
+      NewNo |= Local.MayBeNo;
+
+      llvm::SmallBitVector NewYes(MayBeYes);
+      NewYes |= RHS.MayBeYes;
+      NewYes.reset(LocalKnown);
+      NewYes |= Local.MayBeYes;
+
+      if (NewNo == MayBeNo && NewYes == MayBeYes)
+        return false;
+      MayBeNo = std::move(NewNo);
+      MayBeYes = std::move(NewYes);
+      return true;
     }
 
     void dump(llvm::raw_ostream &OS) const {
@@ -363,17 +417,8 @@ namespace {
     /// Merge the state from a predecessor block into the OutAvailability.
     /// Returns true if the live out set changed.
     bool mergeFromPred(const LiveOutBlockState &Pred) {
-      bool changed = false;
-      for (unsigned i = 0, e = OutAvailability.size(); i != e; ++i) {
-        Optional<DIKind> result;
-        if (transferAvailability(Pred.OutAvailability.getConditional(i),
-                                 OutAvailability.getConditional(i),
-                                 LocalAvailability.getConditional(i),
-                                 result)) {
-          changed = true;
-          OutAvailability.set(i, result);
-        }
-      }
+      bool changed = OutAvailability.transferFrom(Pred.OutAvailability,
+                                                  LocalAvailability);
 
       Optional<DIKind> result;
       if (transferAvailability(Pred.OutSelfConsumed,
@@ -393,10 +438,8 @@ namespace {
       // ignore.
       if (LocalAvailability.empty()) return;
       
-      for (unsigned i = 0; i != Use.NumElements; ++i) {
-        LocalAvailability.set(Use.FirstElement+i, DIKind::Yes);
-        OutAvailability.set(Use.FirstElement+i, DIKind::Yes);
-      }
+      LocalAvailability.set(Use.FirstElement, Use.NumElements, DIKind::Yes);
+      OutAvailability.set(Use.FirstElement, Use.NumElements, DIKind::Yes);
     }
 
     /// Mark the block as a failure path, indicating the self value has been
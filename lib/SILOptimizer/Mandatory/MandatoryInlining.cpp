@@ -30,6 +30,9 @@ typedef llvm::ImmutableSet<SILFunction*> ImmutableFunctionSet;
 STATISTIC(NumMandatoryInlines,
           "Number of function application sites inlined by the mandatory "
           "inlining pass");
+STATISTIC(NumDeadInstsRemoved,
+          "Number of dead instructions removed from flattened transparent "
+          "functions");
 
 template<typename...T, typename...U>
 static void diagnose(ASTContext &Context, SourceLoc loc, Diag<T...> diag,
@@ -152,6 +155,24 @@ cleanupCalleeValue(SILValue CalleeValue, ArrayRef<SILValue> CaptureArgs,
   }
 }
 
+/// \brief Removes instructions that became dead while inlining into the
+/// transparent function \p F.
+///
+/// Every caller of \p F clones its flattened body, so cleaning it up once here
+/// saves cloning (and later deleting) the dead code at each call site.
+static void cleanupFlattenedTransparentFunction(SILFunction *F) {
+  SmallVector<SILInstruction*, 16> DeadInsts;
+  for (auto &BB : *F)
+    for (auto &I : BB)
+      if (isInstructionTriviallyDead(&I))
+        DeadInsts.push_back(&I);
+
+  recursivelyDeleteTriviallyDeadInstructions(DeadInsts, false,
+                                             [](SILInstruction *) {
+    ++NumDeadInstsRemoved;
+  });
+}
+
 /// \brief Returns the callee SILFunction called at a call site, in the case
 /// that the call is transparent (as in, both that the call is marked
 /// with the transparent flag and that callee function is actually transparently
@@ -305,6 +326,7 @@ runOnFunctionRecursively(SILFunction *F, FullApplySite AI,
 
   SmallVector<SILValue, 16> CaptureArgs;
   SmallVector<SILValue, 32> FullArgs;
+  bool InlinedAny = false;
   for (auto FI = F->begin(), FE = F->end(); FI != FE; ++FI) {
     for (auto I = FI->begin(), E = FI->end(); I != E; ++I) {
       FullApplySite InnerAI = FullApplySite::isa(&*I);
@@ -416,10 +438,14 @@ runOnFunctionRecursively(SILFunction *F, FullApplySite AI,
       FI = SILFunction::iterator(ApplyBlock);
       I = ApplyBlock->begin();
       E = ApplyBlock->end();
+      InlinedAny = true;
       ++NumMandatoryInlines;
     }
   }
 
+  if (InlinedAny && F->isTransparent())
+    cleanupFlattenedTransparentFunction(F);
+
   // Keep track of full inlined functions so we don't waste time recursively
   // reprocessing them.
   FullyInlinedSet.insert(F);
@@ -12,18 +12,22 @@
 
 #define DEBUG_TYPE "sil-passmanager"
 
+#include "swift/Basic/CompileTimeTrace.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/JSONSerialization.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SILOptimizer/PassManager/PrettyStackTrace.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/GraphWriter.h"
 
@@ -79,6 +83,11 @@ llvm::cl::opt<bool> SILVerifyWithoutInvalidation(
     "sil-verify-without-invalidation", llvm::cl::init(false),
     llvm::cl::desc("Verify after passes even if the pass has not invalidated"));
 
+llvm::cl::opt<bool> SILVerifyIncremental(
+    "sil-verify-incremental", llvm::cl::init(false),
+    llvm::cl::desc("With -sil-verify-all, only re-verify the functions which "
+                   "a module pass reported as changed"));
+
 static bool doPrintBefore(SILTransform *T, SILFunction *F) {
   if (!SILPrintOnlyFun.empty() && F && F->getName() != SILPrintOnlyFun)
     return false;
@@ -148,6 +157,155 @@ static void printModule(SILModule *Mod, bool EmitVerboseSIL) {
   }
 }
 
+//===----------------------------------------------------------------------===//
+//                          Pass Profiling
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// One run of one pass, as recorded for -sil-pass-profile.
+struct PassProfileRecord {
+  std::string Stage;
+  std::string Pass;
+  /// The function the pass ran on; empty for module passes.
+  std::string Function;
+  uint32_t Iteration;
+  uint64_t WallTimeNS;
+  /// The number of instructions in the function (or the module, for module
+  /// passes) before and after the pass.
+  uint64_t InstructionsBefore;
+  uint64_t InstructionsAfter;
+  /// How much the module's bump allocator grew during the pass, and its
+  /// total size afterwards.
+  uint64_t AllocatedBytes;
+  uint64_t TotalAllocatedBytes;
+  uint32_t Invalidations;
+};
+
+/// Measures one pass run for -sil-pass-profile.
+class PassProfileScope {
+  SILModule *Mod;
+  SILFunction *F;
+  llvm::sys::TimeValue StartTime;
+  uint64_t InstructionsBefore;
+  size_t BytesBefore;
+
+  static uint64_t countInstructions(SILFunction *F) {
+    uint64_t Count = 0;
+    for (auto &BB : *F)
+      Count += BB.getInstList().size();
+    return Count;
+  }
+
+  uint64_t countInstructions() const {
+    if (F)
+      return countInstructions(F);
+    uint64_t Count = 0;
+    for (auto &Fn : *Mod)
+      Count += countInstructions(&Fn);
+    return Count;
+  }
+
+public:
+  PassProfileScope(SILModule *Mod, SILFunction *F)
+    : Mod(Mod), F(F), InstructionsBefore(countInstructions()),
+      BytesBefore(Mod->getBytesAllocated()) {
+    StartTime = llvm::sys::TimeValue::now();
+  }
+
+  PassProfileRecord finish(StringRef Stage, SILTransform *T,
+                           unsigned Iteration, unsigned Invalidations) {
+    auto Delta = llvm::sys::TimeValue::now().nanoseconds() -
+      StartTime.nanoseconds();
+    size_t BytesAfter = Mod->getBytesAllocated();
+    return { Stage.str(), T->getName().str(),
+             F ? F->getName().str() : std::string(),
+             Iteration, uint64_t(Delta), InstructionsBefore,
+             countInstructions(), BytesAfter - BytesBefore, BytesAfter,
+             Invalidations };
+  }
+};
+
+} // end anonymous namespace
+
+namespace swift {
+namespace json {
+
+template<>
+struct ObjectTraits<PassProfileRecord> {
+  static void mapping(Output &out, PassProfileRecord &R) {
+    out.mapRequired("stage", R.Stage);
+    out.mapRequired("pass", R.Pass);
+    out.mapOptional("function", R.Function, std::string());
+    out.mapRequired("iteration", R.Iteration);
+    out.mapRequired("wall-time-ns", R.WallTimeNS);
+    out.mapRequired("instructions-before", R.InstructionsBefore);
+    out.mapRequired("instructions-after", R.InstructionsAfter);
+    out.mapRequired("allocated-bytes", R.AllocatedBytes);
+    out.mapRequired("total-allocated-bytes", R.TotalAllocatedBytes);
+    out.mapRequired("invalidations", R.Invalidations);
+  }
+};
+
+template<>
+struct ArrayTraits<std::vector<PassProfileRecord>> {
+  static size_t size(Output &out, std::vector<PassProfileRecord> &seq) {
+    return seq.size();
+  }
+
+  static PassProfileRecord &element(Output &out,
+                                    std::vector<PassProfileRecord> &seq,
+                                    size_t index) {
+    return seq[index];
+  }
+};
+
+} // end namespace json
+} // end namespace swift
+
+/// The records of all pass managers in this process. Several pass managers
+/// run over the same module, so the profile is rewritten in full whenever
+/// one of them finishes.
+static std::vector<PassProfileRecord> &getPassProfileRecords() {
+  static std::vector<PassProfileRecord> Records;
+  return Records;
+}
+
+static bool shouldProfilePasses(const SILOptions &Options) {
+  return Options.RecordPassProfile || !Options.PassProfileFilename.empty();
+}
+
+std::vector<SILPassCost> swift::takeSILPassProfile() {
+  std::vector<SILPassCost> Costs;
+  llvm::StringMap<unsigned> IndexOfPass;
+  for (auto &R : getPassProfileRecords()) {
+    auto Inserted = IndexOfPass.insert({R.Pass, Costs.size()});
+    if (Inserted.second) {
+      Costs.emplace_back();
+      Costs.back().Pass = R.Pass;
+    }
+    SILPassCost &Cost = Costs[Inserted.first->second];
+    Cost.WallTimeNS += R.WallTimeNS;
+    Cost.AllocatedBytes += R.AllocatedBytes;
+    ++Cost.Runs;
+  }
+  getPassProfileRecords().clear();
+  return Costs;
+}
+
+static void writePassProfile(StringRef Filename) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Filename, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    llvm::errs() << "error: unable to write SIL pass profile '" << Filename
+                 << "': " << EC.message() << '\n';
+    return;
+  }
+  json::Output Out(OS);
+  Out << getPassProfileRecords();
+  OS << '\n';
+}
+
 SILPassManager::SILPassManager(SILModule *M, llvm::StringRef Stage) :
   Mod(M), StageName(Stage) {
   
@@ -217,11 +375,40 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
         F->dump(Options.EmitVerboseSIL);
       }
 
+      llvm::Optional<PassProfileScope> Profile;
+      if (shouldProfilePasses(Options)) {
+        NumInvalidationsInCurrentPass = 0;
+        Profile.emplace(Mod, F);
+      }
+
+      // Lock the analyses which the pass keeps up to date.
+      SmallVector<SILAnalysis *, 4> PreservedAnalyses;
+      for (SILAnalysis *A : Analysis) {
+        if (SFT->preservesAnalysis(A->getKind())) {
+          A->lockInvalidation();
+          PreservedAnalyses.push_back(A);
+        }
+      }
+
       llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
       Mod->registerDeleteNotificationHandler(SFT);
-      SFT->run();
+      {
+        CompileTimeTraceScope traceScope("sil-function-pass",
+                                         [&]() -> std::string {
+          return (SFT->getName() + " " + F->getName()).str();
+        });
+        SFT->run();
+      }
       Mod->removeDeleteNotificationHandler(SFT);
 
+      for (SILAnalysis *A : PreservedAnalyses)
+        A->unlockInvalidation();
+
+      if (Profile)
+        getPassProfileRecords().push_back(
+            Profile->finish(StageName, SFT, NumOptimizationIterations,
+                            NumInvalidationsInCurrentPass));
+
       if (SILPrintPassTime) {
         auto Delta = llvm::sys::TimeValue::now().nanoseconds() -
           StartTime.nanoseconds();
@@ -282,11 +469,25 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     printModule(Mod, Options.EmitVerboseSIL);
   }
 
+  llvm::Optional<PassProfileScope> Profile;
+  if (shouldProfilePasses(Options)) {
+    NumInvalidationsInCurrentPass = 0;
+    Profile.emplace(Mod, nullptr);
+  }
+
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
   Mod->registerDeleteNotificationHandler(SMT);
-  SMT->run();
+  {
+    CompileTimeTraceScope traceScope("sil-module-pass", SMT->getName());
+    SMT->run();
+  }
   Mod->removeDeleteNotificationHandler(SMT);
 
+  if (Profile)
+    getPassProfileRecords().push_back(
+        Profile->finish(StageName, SMT, NumOptimizationIterations,
+                        NumInvalidationsInCurrentPass));
+
   if (SILPrintPassTime) {
     auto Delta = llvm::sys::TimeValue::now().nanoseconds() -
       StartTime.nanoseconds();
@@ -304,7 +505,7 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
 
   if (Options.VerifyAll &&
       (currentPassHasInvalidated || !SILVerifyWithoutInvalidation)) {
-    Mod->verify();
+    Mod->verify(/*OnlyModifiedFunctions=*/SILVerifyIncremental);
     verifyAnalyses();
   }
 }
@@ -389,6 +590,9 @@ void SILPassManager::run() {
 
 /// D'tor.
 SILPassManager::~SILPassManager() {
+  if (!getOptions().PassProfileFilename.empty())
+    writePassProfile(getOptions().PassProfileFilename);
+
   // Free all transformations.
   for (auto T : Transformations)
     delete T;
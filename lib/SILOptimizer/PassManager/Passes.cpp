@@ -122,6 +122,13 @@ bool swift::runSILDiagnosticPasses(SILModule &Module) {
   return Ctx.hadError();
 }
 
+/// Returns true if the module is compiled with -Osize, in which case passes
+/// that trade code size for speed are not run.
+static bool isOptimizingForSize(SILPassManager &PM) {
+  return PM.getModule()->getOptions().Optimization ==
+    SILOptions::SILOptMode::OptimizeForSize;
+}
+
 void AddSimplifyCFGSILCombine(SILPassManager &PM) {
   PM.addSimplifyCFG();
   // Jump threading can expose opportunity for silcombine (enum -> is_enum_tag->
@@ -156,7 +163,8 @@ void AddHighLevelLoopOptPasses(SILPassManager &PM) {
   PM.addArrayCountPropagation();
   // To simplify induction variable.
   PM.addSILCombine();
-  PM.addLoopUnroll();
+  if (!isOptimizingForSize(PM))
+    PM.addLoopUnroll();
   PM.addSimplifyCFG();
   PM.addPerformanceConstantPropagation();
   PM.addSimplifyCFG();
@@ -295,13 +303,15 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.addCapturePropagation();
 
   // Specialize closure.
-  PM.addClosureSpecializer();
+  if (!isOptimizingForSize(PM))
+    PM.addClosureSpecializer();
 
   // Do the second stack promotion on low-level SIL.
   PM.addStackPromotion();
 
   // Speculate virtual call targets.
-  PM.addSpeculativeDevirtualization();
+  if (!isOptimizingForSize(PM))
+    PM.addSpeculativeDevirtualization();
 
   // We do this late since it is a pass like the inline caches that we only want
   // to run once very late. Make sure to run at least one round of the ARC
@@ -388,6 +398,16 @@ void swift::runSILPassesForOnone(SILModule &Module) {
   PM.run();
   PM.resetAndRemoveTransformations();
 
+  // At -Og, also run a few cheap optimizations which keep the debug info of
+  // all variables intact.
+  if (Module.getOptions().Optimization == SILOptions::SILOptMode::Debug) {
+    PM.addGenericSpecializer();
+    PM.addCopyForwarding();
+    PM.addARCSequenceOpts();
+    PM.run();
+    PM.resetAndRemoveTransformations();
+  }
+
   // Don't keep external functions from stdlib and other modules.
   // We don't want that our unoptimized version will be linked instead
   // of the optimized version from the stdlib.
@@ -28,6 +28,7 @@
 #include "swift/SILOptimizer/Analysis/SimplifyInstruction.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/Local.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
@@ -38,6 +39,8 @@ using namespace swift;
 STATISTIC(NumSimplified, "Number of instructions simplified");
 STATISTIC(NumCombined, "Number of instructions combined");
 STATISTIC(NumDeadInst, "Number of dead insts eliminated");
+STATISTIC(NumIterations, "Number of iterations over a function");
+STATISTIC(NumVisited, "Number of worklist entries processed");
 
 //===----------------------------------------------------------------------===//
 //                              Utility Methods
@@ -49,10 +52,13 @@ STATISTIC(NumDeadInst, "Number of dead insts eliminated");
 /// This has a couple of tricks to make the code faster and more powerful.  In
 /// particular, we DCE instructions as we go, to avoid adding them to the
 /// worklist (this significantly speeds up SILCombine on code where many
-/// instructions are dead or constant).
+/// instructions are dead or constant). Dead instructions are erased in one
+/// batch after the walk, together with the instructions that only they used,
+/// so that whole chains of dead code never reach the worklist.
 void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
   llvm::SmallVector<SILBasicBlock*, 256> Worklist;
   llvm::SmallVector<SILInstruction*, 128> InstrsForSILCombineWorklist;
+  llvm::SmallSetVector<SILInstruction*, 32> DeadInsts;
   llvm::SmallPtrSet<SILBasicBlock*, 64> Visited;
 
   Worklist.push_back(BB);
@@ -62,29 +68,14 @@ void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
     // We have now visited this block!  If we've already been here, ignore it.
     if (!Visited.insert(BB).second) continue;
 
-    for (SILBasicBlock::iterator BBI = BB->begin(), E = BB->end(); BBI != E; ) {
-      SILInstruction *Inst = &*BBI;
-      ++BBI;
-
+    for (auto &Inst : *BB) {
       // DCE instruction if trivially dead.
-      if (isInstructionTriviallyDead(Inst)) {
-        ++NumDeadInst;
-        DEBUG(llvm::dbgs() << "SC: DCE: " << *Inst << '\n');
-
-        // We pass in false here since we need to signal to
-        // eraseInstFromFunction to not add this instruction's operands to the
-        // worklist since we have not initialized the worklist yet.
-        //
-        // The reason to just use a default argument here is that it allows us
-        // to centralize all instruction removal in SILCombine into this one
-        // function. This is important if we want to be able to update analyses
-        // in a clean manner.
-        eraseInstFromFunction(*Inst, BBI,
-                              false /*Don't add operands to worklist*/);
+      if (isInstructionTriviallyDead(&Inst)) {
+        DeadInsts.insert(&Inst);
         continue;
       }
 
-      InstrsForSILCombineWorklist.push_back(Inst);
+      InstrsForSILCombineWorklist.push_back(&Inst);
     }
 
     // Recursively visit successors.
@@ -92,6 +83,46 @@ void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
       Worklist.push_back(*SI);
   } while (!Worklist.empty());
 
+  // Erase the dead instructions. Also erase their operands that become dead,
+  // instead of visiting them from the worklist only to erase them there.
+  llvm::SmallPtrSet<SILInstruction*, 32> Erased;
+  while (!DeadInsts.empty()) {
+    SILInstruction *Inst = DeadInsts.pop_back_val();
+    ++NumDeadInst;
+    DEBUG(llvm::dbgs() << "SC: DCE: " << *Inst << '\n');
+
+    llvm::SmallVector<SILInstruction*, 4> Ops;
+    for (auto &Op : Inst->getAllOperands())
+      if (auto *OpInst = dyn_cast<SILInstruction>(&*Op.get()))
+        Ops.push_back(OpInst);
+
+    // The debug uses are erased together with the instruction.
+    for (Operand *DU : getDebugUses(*Inst))
+      Erased.insert(DU->getUser());
+    Erased.insert(Inst);
+
+    // We pass in false here since we need to signal to eraseInstFromFunction
+    // to not add this instruction's operands to the worklist since we have
+    // not initialized the worklist yet.
+    //
+    // The reason to just use a default argument here is that it allows us to
+    // centralize all instruction removal in SILCombine into this one
+    // function. This is important if we want to be able to update analyses
+    // in a clean manner.
+    eraseInstFromFunction(*Inst, false /*Don't add operands to worklist*/);
+
+    for (SILInstruction *OpInst : Ops)
+      if (!Erased.count(OpInst) && isInstructionTriviallyDead(OpInst))
+        DeadInsts.insert(OpInst);
+  }
+
+  if (!Erased.empty())
+    InstrsForSILCombineWorklist.erase(
+        std::remove_if(InstrsForSILCombineWorklist.begin(),
+                       InstrsForSILCombineWorklist.end(),
+                       [&](SILInstruction *I) { return Erased.count(I); }),
+        InstrsForSILCombineWorklist.end());
+
   // Once we've found all of the instructions to add to the worklist, add them
   // in reverse order. This way SILCombine will visit from the top of the
   // function down. This jives well with the way that it adds all uses of
@@ -114,6 +145,7 @@ void SILCombineWorklist::add(SILInstruction *I) {
 
 bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
   MadeChange = false;
+  ++NumIterations;
 
   DEBUG(llvm::dbgs() << "\n\nSILCOMBINE ITERATION #" << Iteration << " on "
                      << F.getName() << "\n");
@@ -132,6 +164,7 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
     // skip them.
     if (I == 0)
       continue;
+    ++NumVisited;
 
     // Check to see if we can DCE the instruction.
     if (isInstructionTriviallyDead(I)) {
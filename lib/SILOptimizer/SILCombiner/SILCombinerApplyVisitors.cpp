@@ -1169,14 +1169,29 @@ bool SILCombiner::optimizeIdentityCastComposition(ApplyInst *FInverse,
   if (!knowHowToEmitReferenceCountInsts(FInverse))
     return false;
 
+  // The entry points that bridge from Objective-C take an optional, so the
+  // result of 'f' may reach 'f_inverse' wrapped in one.
+  SILValue FResult = FInverse->getArgument(0);
+  auto *WrapInOptional = dyn_cast<EnumInst>(FResult);
+  if (WrapInOptional) {
+    OptionalTypeKind OTK;
+    if (!WrapInOptional->hasOperand() ||
+        !WrapInOptional->getType().getSwiftRValueType()
+           ->getAnyOptionalObjectType(OTK) ||
+        WrapInOptional->getElement() !=
+          FInverse->getModule().getASTContext().getOptionalSomeDecl(OTK) ||
+        !WrapInOptional->hasOneUse())
+      return false;
+    FResult = WrapInOptional->getOperand();
+  }
+
   // We need to know that the cast will succeeed.
-  if (!isCastTypeKnownToSucceed(FInverse->getArgument(0).getType(),
-                                FInverse->getModule()) ||
+  if (!isCastTypeKnownToSucceed(FResult.getType(), FInverse->getModule()) ||
       !isCastTypeKnownToSucceed(FInverse->getType(), FInverse->getModule()))
     return false;
 
   // Need to have a matching 'f'.
-  auto *F = dyn_cast<ApplyInst>(FInverse->getArgument(0));
+  auto *F = dyn_cast<ApplyInst>(FResult);
   if (!F)
     return false;
   if (!F->hasSemantics(FName))
@@ -1190,7 +1205,10 @@ bool SILCombiner::optimizeIdentityCastComposition(ApplyInst *FInverse,
 
   // Retains, releases of the result of F.
   SmallVector<SILInstruction *, 16> RetainReleases;
-  if (!hasOnlyRetainReleaseUsers(F, FInverse, RetainReleases))
+  SILInstruction *FResultUser = WrapInOptional;
+  if (!FResultUser)
+    FResultUser = FInverse;
+  if (!hasOnlyRetainReleaseUsers(F, FResultUser, RetainReleases))
     return false;
 
   // Okay, now we know we can remove the calls.
@@ -1223,6 +1241,8 @@ bool SILCombiner::optimizeIdentityCastComposition(ApplyInst *FInverse,
 
   // Remove the calls.
   eraseInstFromFunction(*FInverse);
+  if (WrapInOptional)
+    eraseInstFromFunction(*WrapInOptional);
   eraseInstFromFunction(*F);
 
   return true;
@@ -606,6 +606,31 @@ SILInstruction *SILCombiner::visitStrongRetainInst(StrongRetainInst *SRI) {
   return nullptr;
 }
 
+/// A strong_retain_unowned has to check that the object hasn't been
+/// deinitialized yet. If the unowned reference was formed from a reference
+/// that the caller keeps alive for the whole function, the object is known to
+/// be alive and a plain retain does:
+///
+///   %1 = ref_to_unowned %0 : $C to $@sil_unowned C   // %0 is @guaranteed
+///   strong_retain_unowned %1 : $@sil_unowned C
+///   =>
+///   strong_retain %0 : $C
+SILInstruction *
+SILCombiner::visitStrongRetainUnownedInst(StrongRetainUnownedInst *SRUI) {
+  auto *RUI = dyn_cast<RefToUnownedInst>(SRUI->getOperand());
+  if (!RUI)
+    return nullptr;
+
+  auto *Arg = dyn_cast<SILArgument>(RUI->getOperand().stripCasts());
+  if (!Arg || !Arg->isFunctionArg() ||
+      !Arg->hasConvention(ParameterConvention::Direct_Guaranteed))
+    return nullptr;
+
+  Builder.setCurrentDebugScope(SRUI->getDebugScope());
+  Builder.createStrongRetain(SRUI->getLoc(), RUI->getOperand());
+  return eraseInstFromFunction(*SRUI);
+}
+
 /// Simplify the following two frontend patterns:
 ///
 ///   %payload_addr = init_enum_data_addr %payload_allocation
@@ -43,7 +43,11 @@ static SILInstruction* findUnexpectedBoxUse(SILValue Box,
                                             bool examinePartialApply,
                                             bool inAppliedFunction,
                                             llvm::SmallVectorImpl<Operand*> &);
-static bool partialApplyArgumentEscapes(Operand *O);
+static bool partialApplyArgumentEscapes(Operand *O, unsigned Depth);
+
+/// How many levels of callees which forward a closure to another function we
+/// look through before assuming that the closure escapes.
+static const unsigned MaxForwardingDepth = 4;
 
 // Propagate liveness backwards from an initial set of blocks in our
 // LiveIn set.
@@ -177,7 +181,8 @@ static bool useCaptured(Operand *UI) {
   return true;
 }
 
-static bool partialApplyEscapes(SILValue V, bool examineApply) {
+static bool partialApplyEscapes(SILValue V, bool examineApply,
+                                unsigned Depth = 0) {
   for (auto UI : V.getUses()) {
     auto *User = UI->getUser();
 
@@ -198,7 +203,7 @@ static bool partialApplyEscapes(SILValue V, bool examineApply) {
 
       // Optionally drill down into an apply to see if the operand is
       // captured in or returned from the apply.
-      if (examineApply && !partialApplyArgumentEscapes(UI))
+      if (examineApply && !partialApplyArgumentEscapes(UI, Depth))
         continue;
     }
 
@@ -211,7 +216,7 @@ static bool partialApplyEscapes(SILValue V, bool examineApply) {
         ->getParameters();
       params = params.slice(params.size() - args.size(), args.size());
       if (params[UI->getOperandNumber()-1].isIndirect()) {
-        if (partialApplyEscapes(partialApply, /*examineApply = */ true))
+        if (partialApplyEscapes(partialApply, /*examineApply = */ true, Depth))
           return true;
         continue;
       }
@@ -291,16 +296,18 @@ static SILFunction *getFunctionBody(SILInstruction *Call) {
 
 /// Could this operand to an apply escape that function by being
 /// stored or returned?
-static bool partialApplyArgumentEscapes(Operand *O) {
+static bool partialApplyArgumentEscapes(Operand *O, unsigned Depth) {
   SILFunction *F = getFunctionBody(O->getUser());
   // If we cannot examine the function body, assume the worst.
   if (!F)
     return true;
 
-  // Check the uses of the operand, but do not recurse down into other
-  // apply instructions.
+  // Check the uses of the operand. If the function just forwards it to
+  // another apply, follow it there as well, up to a fixed depth.
   auto Param = SILValue(getParameterForOperand(F, O));
-  return partialApplyEscapes(Param, /* examineApply = */ false);
+  return partialApplyEscapes(Param,
+                             /* examineApply = */ Depth < MaxForwardingDepth,
+                             Depth + 1);
 }
 
 /// checkPartialApplyBody - Check the body of a partial apply to see
@@ -38,6 +38,7 @@
 
 STATISTIC(NumSimplify, "Number of instructions simplified or DCE'd");
 STATISTIC(NumCSE,      "Number of instructions CSE'd");
+STATISTIC(NumArgsCSE,  "Number of block arguments CSE'd");
 
 using namespace swift;
 
@@ -511,9 +512,67 @@ bool CSE::processFunction(SILFunction &Fm, DominanceInfo *DT) {
   return Changed;
 }
 
+/// Replace block arguments which are congruent to an earlier argument of the
+/// same block, i.e. which receive the same incoming value from every
+/// predecessor. On a loop back-edge both arguments may also receive their own
+/// value. Merging the arguments lets the instructions which are computed from
+/// them be CSE'd as well.
+static bool mergeCongruentArguments(SILBasicBlock *BB) {
+  if (BB->getNumBBArg() < 2 || BB->pred_empty())
+    return false;
+
+  // Other terminators, like switch_enum, don't pass their operands as
+  // block arguments.
+  for (auto *Pred : BB->getPreds()) {
+    auto *Term = Pred->getTerminator();
+    if (!isa<BranchInst>(Term) && !isa<CondBranchInst>(Term))
+      return false;
+  }
+
+  auto Args = BB->getBBArgs();
+  llvm::SmallVector<llvm::SmallVector<SILValue, 4>, 4> Incoming(Args.size());
+  for (unsigned i = 0, e = Args.size(); i != e; ++i)
+    if (!Args[i]->getIncomingValues(Incoming[i]))
+      return false;
+
+  bool Changed = false;
+  llvm::SmallVector<bool, 4> Replaced(Args.size(), false);
+  for (unsigned i = 1, e = Args.size(); i != e; ++i) {
+    if (Args[i]->use_empty())
+      continue;
+    for (unsigned j = 0; j != i; ++j) {
+      if (Replaced[j] || Args[j]->getType() != Args[i]->getType())
+        continue;
+
+      bool Congruent = true;
+      for (unsigned k = 0, ke = Incoming[i].size(); k != ke; ++k) {
+        SILValue A = Incoming[j][k];
+        SILValue B = Incoming[i][k];
+        if (A == B)
+          continue;
+        if (A == SILValue(Args[j]) && B == SILValue(Args[i]))
+          continue;
+        Congruent = false;
+        break;
+      }
+      if (!Congruent)
+        continue;
+
+      DEBUG(llvm::dbgs() << "SILCSE ARG: " << *Args[i] << "  to: "
+                         << *Args[j] << '\n');
+      SILValue(Args[i]).replaceAllUsesWith(Args[j]);
+      Replaced[i] = true;
+      Changed = true;
+      ++NumArgsCSE;
+      break;
+    }
+  }
+  return Changed;
+}
+
 bool CSE::processNode(DominanceInfoNode *Node) {
   SILBasicBlock *BB = Node->getBlock();
-  bool Changed = false;
+  bool Changed = mergeCongruentArguments(BB);
 
   // See if any instructions in the block can be eliminated.  If so, do it.  If
   // not, add them to AvailableValues.
@@ -745,6 +745,11 @@ bool CopyForwarding::backwardPropagateCopy(
     // is initialized, so we really need the copy.
     if (DestUserInsts.count(UserInst) || UserInst == CopyDestDef) {
       if (auto *DVAI = dyn_cast<DebugValueAddrInst>(UserInst)) {
+        // At -Og, keep the variable's debug info rather than removing the
+        // copy.
+        if (CopyInst->getModule().getOptions().Optimization ==
+              SILOptions::SILOptMode::Debug)
+          return false;
         DebugValueInstsToDelete.push_back(DVAI);
         continue;
       }
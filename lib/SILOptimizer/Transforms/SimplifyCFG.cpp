@@ -51,6 +51,19 @@ STATISTIC(NumSROAArguments, "Number of aggregate argument levels split by "
 ///
 static unsigned MaxIterationsOfDominatorBasedSimplify = 10;
 
+/// Jump threading may duplicate this percentage of a function's instructions
+/// in one run of the pass, but at least MinJumpThreadingBudget instructions.
+/// Without such a limit, state-machine-like code can be duplicated over and
+/// over.
+static llvm::cl::opt<unsigned> JumpThreadingBudgetPercent(
+    "sil-jump-threading-budget-percent", llvm::cl::init(25),
+    llvm::cl::desc("How much jump threading may grow a function, in percent"));
+
+static llvm::cl::opt<unsigned> MinJumpThreadingBudget(
+    "sil-min-jump-threading-budget", llvm::cl::init(256),
+    llvm::cl::desc("How many instructions jump threading may always "
+                   "duplicate in a function"));
+
 namespace {
   class SimplifyCFG {
     SILFunction &Fn;
@@ -71,6 +84,9 @@ namespace {
 
     bool ShouldVerify;
     bool EnableJumpThread;
+
+    /// The number of instructions jump threading may still duplicate.
+    unsigned DuplicationBudget = 0;
   public:
     SimplifyCFG(SILFunction &Fn, SILPassManager *PM, bool Verify,
                 bool EnableJumpThread)
@@ -142,6 +158,17 @@ namespace {
         LoopHeaders.erase(BB);
     }
 
+    /// Returns true if the duplication budget allows one more copy of \p BB.
+    bool canDuplicate(SILBasicBlock *BB) const {
+      return BB->getInstList().size() <= DuplicationBudget;
+    }
+
+    /// Charge one copy of \p BB to the duplication budget.
+    void chargeDuplication(SILBasicBlock *BB) {
+      DuplicationBudget -= std::min<unsigned>(BB->getInstList().size(),
+                                              DuplicationBudget);
+    }
+
     bool simplifyBlocks();
     bool canonicalizeSwitchEnums();
     bool simplifyThreadedTerminators();
@@ -260,10 +287,16 @@ SimplifyCFG::trySimplifyCheckedCastBr(TermInst *Term, DominanceInfo *DT) {
   if (!DT->getNode(Term->getParent()))
     return false;
 
+  // The block of the checked_cast_br may be cloned.
+  SILBasicBlock *BB = Term->getParent();
+  if (!canDuplicate(BB))
+    return false;
+
   SmallVector<SILBasicBlock *, 16> BBs;
   auto Result = tryCheckedCastBrJumpThreading(Term, DT, BBs);
 
   if (Result) {
+    chargeDuplication(BB);
     for (auto BB: BBs)
       addToWorklist(BB);
   }
@@ -281,6 +314,26 @@ static SILValue getTerminatorCondition(TermInst *Term) {
   return nullptr;
 }
 
+/// Returns the number of instructions that are not free at which a block is
+/// too expensive to duplicate for jump threading, if it runs as often as
+/// \p BB does.
+///
+/// Blocks that the profile shows to run more often than their function is
+/// entered, i.e. in loops, may be larger. Blocks that it shows never to run
+/// are only duplicated if all of their instructions are free.
+static unsigned getJumpThreadingCostLimit(SILBasicBlock *BB) {
+  const unsigned DefaultLimit = 4;
+  auto Count = BB->getProfileCount();
+  auto EntryCount = BB->getParent()->front().getProfileCount();
+  if (!Count || !EntryCount || *EntryCount == 0)
+    return DefaultLimit;
+  if (*Count == 0)
+    return 1;
+  if (*Count > *EntryCount)
+    return 2 * DefaultLimit;
+  return DefaultLimit;
+}
+
 /// Is this basic block jump threadable.
 static bool isThreadableBlock(SILBasicBlock *BB,
                               SmallPtrSet<SILBasicBlock *, 32> &LoopHeaders) {
@@ -296,6 +349,7 @@ static bool isThreadableBlock(SILBasicBlock *BB,
     return false;
 
   unsigned Cost = 0;
+  unsigned CostLimit = getJumpThreadingCostLimit(BB);
   for (auto &Inst : *BB) {
     if (!Inst.isTriviallyDuplicatable())
       return false;
@@ -306,7 +360,7 @@ static bool isThreadableBlock(SILBasicBlock *BB,
 
     // Only thread 'small blocks'.
     if (instructionInlineCost(Inst) != InlineCost::Free)
-      if (++Cost == 4)
+      if (++Cost == CostLimit)
         return false;
   }
   return true;
@@ -344,6 +398,8 @@ public:
 
   ThreadInfo() = default;
 
+  SILBasicBlock *getDest() const { return Dest; }
+
   void threadEdge() {
     auto *SrcTerm = cast<BranchInst>(Src->getTerminator());
 
@@ -617,6 +673,9 @@ bool SimplifyCFG::dominatorBasedSimplifications(SILFunction &Fn,
     return Changed;
 
   for (auto &ThreadInfo : JumpThreadableEdges) {
+    if (!canDuplicate(ThreadInfo.getDest()))
+      continue;
+    chargeDuplication(ThreadInfo.getDest());
     ThreadInfo.threadEdge();
     Changed = true;
   }
@@ -908,7 +967,11 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
 
   // If it looks potentially interesting, decide whether we *can* do the
   // operation and whether the block is small enough to be worth duplicating.
+  if (!canDuplicate(DestBB))
+    return false;
+
   unsigned Cost = 0;
+  unsigned CostLimit = getJumpThreadingCostLimit(SrcBB);
 
   for (auto &Inst : *DestBB) {
     if (!Inst.isTriviallyDuplicatable())
@@ -921,7 +984,7 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
     // This is a really trivial cost model, which is only intended as a starting
     // point.
     if (instructionInlineCost(Inst) != InlineCost::Free)
-      if (++Cost == 4) return false;
+      if (++Cost == CostLimit) return false;
 
     // We need to update ssa if a value is used outside the duplicated block.
     if (!NeedToUpdateSSA)
@@ -937,6 +1000,7 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
   // Okay, it looks like we want to do this and we can.  Duplicate the
   // destination block into this one, rewriting uses of the BBArgs to use the
   // branch arguments as we go.
+  chargeDuplication(DestBB);
   EdgeThreadingCloner Cloner(BI);
 
   for (auto &I : *DestBB)
@@ -2610,6 +2674,12 @@ static bool splitBBArguments(SILFunction &Fn) {
 bool SimplifyCFG::run() {
   RemoveUnreachable RU(Fn);
 
+  unsigned NumInsts = 0;
+  for (auto &BB : Fn)
+    NumInsts += BB.getInstList().size();
+  DuplicationBudget = std::max<unsigned>(
+      MinJumpThreadingBudget, NumInsts * JumpThreadingBudgetPercent / 100);
+
   // First remove any block not reachable from the entry.
   bool Changed = RU.run();
 
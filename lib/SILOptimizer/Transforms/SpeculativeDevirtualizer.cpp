@@ -24,6 +24,8 @@
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
+#include "swift/SILOptimizer/Analysis/ColdBlockInfo.h"
+#include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/Utils/Generics.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
@@ -44,6 +46,8 @@ using namespace swift;
 static const int MaxNumSpeculativeTargets = 6;
 
 STATISTIC(NumTargetsPredicted, "Number of monomorphic functions predicted");
+STATISTIC(NumColdCallSitesSkipped,
+          "Number of class_method calls in cold blocks not speculated");
 
 // A utility function for cloning the apply instruction.
 static FullApplySite CloneApply(FullApplySite AI, SILBuilder &Builder) {
@@ -509,6 +513,7 @@ namespace {
 
     void run() override {
       ClassHierarchyAnalysis *CHA = PM->getAnalysis<ClassHierarchyAnalysis>();
+      ColdBlockInfo ColdBlocks(PM->getAnalysis<DominanceAnalysis>());
 
       bool Changed = false;
 
@@ -517,8 +522,16 @@ namespace {
       for (auto &BB : *getFunction()) {
         for (auto II = BB.begin(), IE = BB.end(); II != IE; ++II) {
           FullApplySite AI = FullApplySite::isa(&*II);
-          if (AI && isa<ClassMethodInst>(AI.getCallee()))
-            ToSpecialize.push_back(AI);
+          if (!AI || !isa<ClassMethodInst>(AI.getCallee()))
+            continue;
+
+          // The checks and direct calls would only grow the code on paths
+          // that hints or the profile say are (almost) never executed.
+          if (ColdBlocks.isCold(&BB)) {
+            NumColdCallSitesSkipped++;
+            continue;
+          }
+          ToSpecialize.push_back(AI);
         }
       }
 
@@ -42,6 +42,11 @@ class SILLinker : public SILModuleTransform {
 
   void run() override {
     SILModule &M = *getModule();
+
+    // The inliner and the generic specializer link the bodies they use.
+    if (M.getOptions().LinkBodiesOnDemand)
+      return;
+
     for (auto &Fn : M)
       if (M.linkFunction(&Fn, SILModule::LinkingMode::LinkAll))
           invalidateAnalysis(&Fn, SILAnalysis::InvalidationKind::Everything);
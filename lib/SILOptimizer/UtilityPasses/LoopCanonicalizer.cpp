@@ -30,6 +30,12 @@ namespace {
 
 class LoopCanonicalizer : public SILFunctionTransform {
 
+  bool preservesAnalysis(SILAnalysis::AnalysisKind Kind) const override {
+    // We keep loop info and the dominator tree up to date.
+    return Kind == SILAnalysis::AnalysisKind::Dominance ||
+           Kind == SILAnalysis::AnalysisKind::Loop;
+  }
+
   void run() override {
     SILFunction *F = getFunction();
 
@@ -47,12 +53,7 @@ class LoopCanonicalizer : public SILFunctionTransform {
     auto *DA = PM->getAnalysis<DominanceAnalysis>();
     auto *DI = DA->get(F);
     if (canonicalizeAllLoops(DI, LI)) {
-      // We preserve loop info and the dominator tree.
-      DA->lockInvalidation();
-      LA->lockInvalidation();
       PM->invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
-      DA->unlockInvalidation();
-      LA->unlockInvalidation();
     }
   }
 
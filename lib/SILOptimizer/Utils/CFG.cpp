@@ -169,8 +169,8 @@ SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
     return DefaultBB;
 }
 
-void swift::changeBranchTarget(TermInst *T, unsigned EdgeIdx,
-                               SILBasicBlock *NewDest, bool PreserveArgs) {
+static void changeBranchTargetImpl(TermInst *T, unsigned EdgeIdx,
+                                   SILBasicBlock *NewDest, bool PreserveArgs) {
   SILBuilderWithScope B(T);
 
   switch (T->getKind()) {
@@ -305,6 +305,15 @@ void swift::changeBranchTarget(TermInst *T, unsigned EdgeIdx,
   llvm_unreachable("Not yet implemented!");
 }
 
+void swift::changeBranchTarget(TermInst *T, unsigned EdgeIdx,
+                               SILBasicBlock *NewDest, bool PreserveArgs,
+                               DominanceInfo *DT) {
+  SILBasicBlock *BB = T->getParent();
+  SILBasicBlock *OldDest = T->getSuccessors()[EdgeIdx].getBB();
+  changeBranchTargetImpl(T, EdgeIdx, NewDest, PreserveArgs);
+  if (DT)
+    DT->changeEdgeTarget(BB, OldDest, NewDest);
+}
 
 template <class SwitchEnumTy, class SwitchEnumCaseTy>
 SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
@@ -327,8 +336,9 @@ SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
 /// \param OldDest The successor block that will be replaced.
 /// \param NewDest The new target block.
 /// \param PreserveArgs If set, preserve arguments on the replaced edge.
-void swift::replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest,
-                               SILBasicBlock *NewDest, bool PreserveArgs) {
+static void replaceBranchTargetImpl(TermInst *T, SILBasicBlock *OldDest,
+                                    SILBasicBlock *NewDest,
+                                    bool PreserveArgs) {
   SILBuilderWithScope B(T);
 
   switch (T->getKind()) {
@@ -447,6 +457,15 @@ void swift::replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest,
   llvm_unreachable("Not yet implemented!");
 }
 
+void swift::replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest,
+                                SILBasicBlock *NewDest, bool PreserveArgs,
+                                DominanceInfo *DT) {
+  SILBasicBlock *BB = T->getParent();
+  replaceBranchTargetImpl(T, OldDest, NewDest, PreserveArgs);
+  if (DT)
+    DT->changeEdgeTarget(BB, OldDest, NewDest);
+}
+
 /// \brief Check if the edge from the terminator is critical.
 bool swift::isCriticalEdge(TermInst *T, unsigned EdgeIdx) {
   assert(T->getSuccessors().size() > EdgeIdx && "Not enough successors");
@@ -74,43 +74,35 @@ static bool convertExtenralDefinitionIntoDeclaration(SILFunction *F) {
   return true;
 }
 
-/// Check of a given name could be a name of a white-listed
-/// specialization.
-bool swift::isWhitelistedSpecialization(StringRef SpecName) {
-  // The whitelist of classes and functions from the stdlib,
-  // whose specializations we want to preserve.
-  ArrayRef<StringRef> Whitelist = {
-      "Array",
-      "_ArrayBuffer",
-      "_ContiguousArrayBuffer",
-      "Range",
-      "RangeGenerator",
-      "_allocateUninitializedArray",
-      "UTF8",
-      "UTF16",
-      "String",
-      "_StringBuffer",
-      "_toStringReadOnlyPrintable",
-  };
-
-  // TODO: Once there is an efficient API to check if
-  // a given symbol is a specialization of a specific type,
-  // use it instead. Doing demangling just for this check
-  // is just wasteful.
-  auto DemangledNameString =
-     swift::Demangle::demangleSymbolAsString(SpecName);
-
-  StringRef DemangledName = DemangledNameString;
-
+/// The stdlib classes and functions whose specializations we want to
+/// preserve.
+static const StringRef StdlibWhitelist[] = {
+    "Array",
+    "_ArrayBuffer",
+    "_ContiguousArrayBuffer",
+    "Range",
+    "RangeGenerator",
+    "_allocateUninitializedArray",
+    "UTF8",
+    "UTF16",
+    "String",
+    "_StringBuffer",
+    "_toStringReadOnlyPrintable",
+};
+
+/// Check if a demangled name is the name of a specialization of one of the
+/// classes or functions \p Names from the module \p ModuleName.
+static bool isSpecializationOf(StringRef DemangledName, StringRef ModuleName,
+                               ArrayRef<StringRef> Names) {
   auto pos = DemangledName.find("generic ", 0);
   if (pos == StringRef::npos)
     return false;
 
-  // Create "of Swift"
+  // Create "of <ModuleName>."
   llvm::SmallString<64> OfString;
   llvm::raw_svector_ostream buffer(OfString);
   buffer << "of ";
-  buffer << STDLIB_NAME <<'.';
+  buffer << ModuleName << '.';
 
   StringRef OfStr = buffer.str();
 
@@ -121,9 +113,11 @@ bool swift::isWhitelistedSpecialization(StringRef SpecName) {
 
   pos += OfStr.size();
 
-  for(auto Name: Whitelist) {
+  for(auto Name: Names) {
     auto pos1 = DemangledName.find(Name, pos);
-    if (pos1 == pos && !isalpha(DemangledName[pos1+Name.size()])) {
+    auto end = pos1 + Name.size();
+    if (pos1 == pos &&
+        (end == DemangledName.size() || !isalpha(DemangledName[end]))) {
       return true;
     }
   }
@@ -131,23 +125,81 @@ bool swift::isWhitelistedSpecialization(StringRef SpecName) {
   return false;
 }
 
+/// Check of a given name could be a name of a white-listed
+/// specialization.
+bool swift::isWhitelistedSpecialization(StringRef SpecName) {
+  // TODO: Once there is an efficient API to check if
+  // a given symbol is a specialization of a specific type,
+  // use it instead. Doing demangling just for this check
+  // is just wasteful.
+  auto DemangledNameString =
+     swift::Demangle::demangleSymbolAsString(SpecName);
+
+  return isSpecializationOf(DemangledNameString, STDLIB_NAME,
+                            StdlibWhitelist);
+}
+
+/// Check if \p SpecName is a specialization that the module being compiled
+/// exports: one from the stdlib whitelist when compiling the stdlib, or one
+/// of a name passed with -export-specializations-of otherwise.
+static bool isExportedSpecialization(SILModule &M, StringRef SpecName) {
+  StringRef ModuleName = M.getSwiftModule()->getName().str();
+  if (ModuleName == STDLIB_NAME)
+    return isWhitelistedSpecialization(SpecName);
+
+  auto &Exported = M.getOptions().ExportedSpecializations;
+  if (Exported.empty())
+    return false;
+
+  SmallVector<StringRef, 8> Names(Exported.begin(), Exported.end());
+  auto DemangledNameString =
+     swift::Demangle::demangleSymbolAsString(SpecName);
+  return isSpecializationOf(DemangledNameString, ModuleName, Names);
+}
+
+/// Check if \p SpecName may be the name of a specialization exported by a
+/// module imported into \p M.
+///
+/// Only the stdlib's whitelist is known here. Other libraries record the
+/// specializations they export as declarations in their SIL function table,
+/// so any specialization of another module's function is worth looking up.
+static bool mayBeImportedSpecialization(SILModule &M, StringRef SpecName) {
+  auto DemangledNameString =
+     swift::Demangle::demangleSymbolAsString(SpecName);
+  StringRef DemangledName = DemangledNameString;
+
+  auto pos = DemangledName.find("generic ", 0);
+  if (pos == StringRef::npos)
+    return false;
+  pos = DemangledName.find(" of ", pos);
+  if (pos == StringRef::npos)
+    return false;
+  pos += 4;
+
+  StringRef ModuleName =
+    DemangledName.substr(pos, DemangledName.find('.', pos) - pos);
+  if (ModuleName == STDLIB_NAME)
+    return isSpecializationOf(DemangledName, STDLIB_NAME, StdlibWhitelist);
+
+  return ModuleName != M.getSwiftModule()->getName().str();
+}
+
 /// Cache a specialization.
-/// For now, it is performed only for specializations in the
-/// standard library. But in the future, one could think of
-/// maintaining a cache of optimized specializations.
+/// It is performed for the whitelisted specializations in the standard
+/// library and for the specializations other libraries export with
+/// -export-specializations-of.
 ///
 /// Mark specializations as public, so that they can be used
 /// by user applications. These specializations are supposed to be
-/// used only by -Onone compiled code. They should be never inlined.
+/// referenced by client code that can't specialize by itself. They should be
+/// never inlined.
 static bool cacheSpecialization(SILModule &M, SILFunction *F) {
-  // Do not remove functions from the white-list. Keep them around.
+  // Do not remove exported specializations. Keep them around.
   // Change their linkage to public, so that other applications can refer to it.
 
   if (M.getOptions().Optimization >= SILOptions::SILOptMode::Optimize &&
-      F->getLinkage() != SILLinkage::Public &&
-      F->getModule().getSwiftModule()->getName().str() == STDLIB_NAME) {
-    if (F->getLinkage() != SILLinkage::Public &&
-        isWhitelistedSpecialization(F->getName())) {
+      F->getLinkage() != SILLinkage::Public) {
+    if (isExportedSpecialization(M, F->getName())) {
 
       DEBUG(
         auto DemangledNameString =
@@ -177,21 +229,28 @@ static bool cacheSpecialization(SILModule &M, SILFunction *F) {
 /// Try to look up an existing specialization in the specialization cache.
 /// If it is found, it tries to link this specialization.
 ///
-/// For now, it performs a lookup only in the standard library.
-/// But in the future, one could think of maintaining a cache
-/// of optimized specializations.
+/// It performs a lookup in the standard library and in the libraries that
+/// export specializations.
 static SILFunction *lookupExistingSpecialization(SILModule &M,
                                                  StringRef FunctionName) {
-  // Try to link existing specialization only in -Onone mode.
-  // All other compilation modes perform specialization themselves.
-  // TODO: Cache optimized specializations and perform lookup here?
-  // TODO: Only check that this function exists, but don't read
-  // its body. It can save some compile-time.
-  if (isWhitelistedSpecialization(FunctionName) &&
-      M.linkFunction(FunctionName, SILOptions::LinkingMode::LinkNormal))
-    return M.lookUpFunction(FunctionName);
-
-  return nullptr;
+  // Try to link existing specialization only in -Onone mode, or for generic
+  // functions whose bodies are not available for specialization.
+  if (!mayBeImportedSpecialization(M, FunctionName))
+    return nullptr;
+
+  // The body of a public specialization is never used, so only read its
+  // declaration.
+  auto *Declaration = M.linkFunctionDeclaration(FunctionName);
+  if (!Declaration)
+    return nullptr;
+  if (hasPublicVisibility(Declaration->getLinkage()))
+    return Declaration;
+
+  // Libraries which don't serialize all of their SIL only record declarations
+  // of the specializations they export. Linking fails for those, but the
+  // declaration is still deserialized into the module.
+  M.linkFunction(FunctionName, SILOptions::LinkingMode::LinkNormal);
+  return M.lookUpFunction(FunctionName);
 }
 
 SILFunction *swift::getExistingSpecialization(SILModule &M,
@@ -231,6 +290,17 @@ SILFunction *swift::getExistingSpecialization(SILModule &M,
   return Specialization;
 }
 
+/// The maximum number of instructions of a generic function which is
+/// specialized at -Osize.
+static const unsigned SizeOptSpecializationLimit = 50;
+
+static unsigned getNumInstructions(SILFunction *F) {
+  unsigned Count = 0;
+  for (auto &BB : *F)
+    Count += std::distance(BB.begin(), BB.end());
+  return Count;
+}
+
 ApplySite swift::trySpecializeApplyOfGeneric(ApplySite Apply,
                                              SILFunction *&NewFunction,
                                              CloneCollector &Collector) {
@@ -307,6 +377,15 @@ ApplySite swift::trySpecializeApplyOfGeneric(ApplySite Apply,
       if (M.getOptions().Optimization <= SILOptions::SILOptMode::Debug) {
         llvm::dbgs() << "Creating a specialization: " << ClonedName << "\n"; });
 
+    // At -Osize, every new specialization is a copy of the generic function,
+    // so only specialize functions which are small.
+    if (M.getOptions().Optimization ==
+          SILOptions::SILOptMode::OptimizeForSize &&
+        getNumInstructions(F) > SizeOptSpecializationLimit) {
+      DEBUG(llvm::dbgs() << "    Function too big to specialize at -Osize.\n");
+      return ApplySite();
+    }
+
     // Create a new function.
     NewF = GenericCloner::cloneFunction(F, InterfaceSubs, ContextSubs,
                                         ClonedName, Apply,
@@ -319,3 +398,31 @@ ApplySite swift::trySpecializeApplyOfGeneric(ApplySite Apply,
   }
   return replaceWithSpecializedFunction(Apply, NewF);
 }
+
+ApplySite swift::tryUseExportedSpecialization(ApplySite Apply) {
+  assert(Apply.hasSubstitutions() && "Expected an apply with substitutions!");
+
+  auto *F = cast<FunctionRefInst>(Apply.getCallee())->getReferencedFunction();
+  ArrayRef<Substitution> Subs = Apply.getSubstitutions();
+  if (hasUnboundGenericTypes(Subs))
+    return ApplySite();
+
+  llvm::SmallString<64> ClonedName;
+  {
+    llvm::raw_svector_ostream buffer(ClonedName);
+    Mangle::Mangler M(buffer);
+    Mangle::GenericSpecializationMangler Mangler(M, F, Subs);
+    Mangler.mangle();
+  }
+
+  auto &M = Apply.getInstruction()->getModule();
+  auto *NewF = M.lookUpFunction(ClonedName);
+  if (!NewF || NewF->getLinkage() == SILLinkage::SharedExternal)
+    NewF = getExistingSpecialization(M, ClonedName);
+  if (!NewF)
+    return ApplySite();
+
+  DEBUG(llvm::dbgs() << "    Use exported specialization " << ClonedName
+                     << '\n');
+  return replaceWithSpecializedFunction(Apply, NewF);
+}
@@ -34,10 +34,10 @@ using namespace swift;
 /// This routine only examines the state of the instruction at hand.
 bool
 swift::isInstructionTriviallyDead(SILInstruction *I) {
-  // At Onone, consider all uses, including the debug_info.
-  // This way, debug_info is preserved at Onone.
+  // At Onone and Og, consider all uses, including the debug_info.
+  // This way, debug_info is preserved at Onone and Og.
   if (!I->use_empty() &&
-      I->getModule().getOptions().Optimization <= SILOptions::SILOptMode::None)
+      I->getModule().getOptions().Optimization <= SILOptions::SILOptMode::Debug)
     return false;
 
   if (!hasNoUsesExceptDebug(I) || isa<TermInst>(I))
@@ -101,16 +101,18 @@ static SILBasicBlock *insertBackedgeBlock(SILLoop *L, DominanceInfo *DT,
   // Create an unconditional branch that propagates the newly created BBArgs.
   SILBuilder(BEBlock).createBranch(BranchLoc, Header, BBArgs);
 
-  // Redirect the backedge blocks to BEBlock instead of Header.
+  // Redirect the backedge blocks to BEBlock instead of Header. The first
+  // redirected edge adds BEBlock to the dominator tree.
   for (auto *Pred : BackedgeBlocks) {
     auto *Terminator = Pred->getTerminator();
 
     if (auto *Branch = dyn_cast<BranchInst>(Terminator))
-      changeBranchTarget(Branch, 0, BEBlock, /*PreserveArgs=*/true);
+      changeBranchTarget(Branch, 0, BEBlock, /*PreserveArgs=*/true, DT);
     else if (auto *CondBranch = dyn_cast<CondBranchInst>(Terminator)) {
       unsigned EdgeIdx = (CondBranch->getTrueBB() == Header)
         ? CondBranchInst::TrueIdx : CondBranchInst::FalseIdx;
-      changeBranchTarget(CondBranch, EdgeIdx, BEBlock, /*PreserveArgs=*/true);
+      changeBranchTarget(CondBranch, EdgeIdx, BEBlock, /*PreserveArgs=*/true,
+                         DT);
     }
     else {
       llvm_unreachable("Expected a branch terminator.");
@@ -121,15 +123,6 @@ static SILBasicBlock *insertBackedgeBlock(SILLoop *L, DominanceInfo *DT,
   // loop and all parent loops.
   L->addBasicBlockToLoop(BEBlock, LI->getBase());
 
-  // Update dominator information
-  SILBasicBlock *DomBB = BackedgeBlocks.back();
-  for (auto BBIter = BackedgeBlocks.begin(),
-         BBEnd = std::prev(BackedgeBlocks.end());
-       BBIter != BBEnd; ++BBIter) {
-    DomBB = DT->findNearestCommonDominator(DomBB, *BBIter);
-  }
-  DT->addNewBlock(BEBlock, DomBB);
-
   return BEBlock;
 }
 
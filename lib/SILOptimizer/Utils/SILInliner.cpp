@@ -64,9 +64,17 @@ bool SILInliner::inlineFunction(FullApplySite AI, ArrayRef<SILValue> Args) {
   if (!AIScope)
     AIScope = AI.getFunction()->getDebugScope();
 
-  if (IKind == InlineKind::MandatoryInline) {
-    // Mandatory inlining: every instruction inherits scope/location
-    // from the call site.
+  CollapseScopes = false;
+  if (IKind == InlineKind::PerformanceInline &&
+      F.getModule().getOptions().CollapseInlinedStdlibDebugScopes) {
+    auto *CalleeDC = CalleeFunction->getDeclContext();
+    CollapseScopes = CalleeFunction->isTransparent() ||
+      (CalleeDC && CalleeDC->getParentModule()->isStdlibModule());
+  }
+
+  if (IKind == InlineKind::MandatoryInline || CollapseScopes) {
+    // Mandatory inlining, or a collapsed performance inline: every
+    // instruction inherits scope/location from the call site.
     CallSiteScope = AIScope;
   } else {
     // Performance inlining. Construct a proper inline scope pointing
@@ -184,14 +192,14 @@ bool SILInliner::inlineFunction(FullApplySite AI, ArrayRef<SILValue> Args) {
 void SILInliner::visitDebugValueInst(DebugValueInst *Inst) {
   // The mandatory inliner drops debug_value instructions when inlining, as if
   // it were a "nodebug" function in C.
-  if (IKind == InlineKind::MandatoryInline) return;
+  if (IKind == InlineKind::MandatoryInline || CollapseScopes) return;
 
   return SILCloner<SILInliner>::visitDebugValueInst(Inst);
 }
 void SILInliner::visitDebugValueAddrInst(DebugValueAddrInst *Inst) {
   // The mandatory inliner drops debug_value_addr instructions when inlining, as
   // if it were a "nodebug" function in C.
-  if (IKind == InlineKind::MandatoryInline) return;
+  if (IKind == InlineKind::MandatoryInline || CollapseScopes) return;
 
   return SILCloner<SILInliner>::visitDebugValueAddrInst(Inst);
 }
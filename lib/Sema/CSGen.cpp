@@ -319,6 +319,11 @@ namespace {
         conformance->getWitness(requirement.front(), &CS.TC);
     if (!witness)
       return;
+
+    // A user-written == is already found by ordinary name lookup; only the
+    // derived one lives where lookup can't see it.
+    if (!witness.getDecl()->isImplicit())
+      return;
     
     // FIXME: If we ever have derived == for generic types, we may need to
     // revisit this.
@@ -1009,6 +1014,13 @@ namespace {
       if (expr->getType() && !expr->getType()->hasTypeVariable())
         return expr->getType();
 
+      // If an earlier element of the same collection is the same kind of
+      // literal, use its type.
+      if (auto shared = CS.SharedCollectionElements.lookup(expr)) {
+        assert(shared->getType() && "shared element not visited yet");
+        return shared->getType();
+      }
+
       auto protocol = CS.getTypeChecker().getLiteralProtocol(expr);
       if (!protocol)
         return nullptr;
@@ -1544,6 +1556,13 @@ namespace {
                               arrayProto->lookupDirect(
                                 C.getIdentifier("Element")).front());
 
+      // If an earlier element of the enclosing collection is an array of the
+      // same shape, use its type; the elements have been shared with it.
+      if (auto shared = CS.SharedCollectionElements.lookup(expr)) {
+        assert(shared->getType() && "shared element not visited yet");
+        return shared->getType();
+      }
+
       auto locator = CS.getConstraintLocator(expr);
       auto contextualType = CS.getContextualType(expr);
       Type contextualArrayType = nullptr;
@@ -1562,12 +1581,17 @@ namespace {
         
         unsigned index = 0;
         for (auto element : expr->getElements()) {
+          unsigned elementIndex = index++;
+          if (CS.SharedCollectionElements.count(element))
+            continue;
+
           CS.addConstraint(ConstraintKind::Conversion,
                            element->getType(),
                            contextualArrayElementType,
                            CS.getConstraintLocator(expr,
                                                    LocatorPathElt::
-                                                    getTupleElement(index++)));
+                                                    getTupleElement(
+                                                      elementIndex)));
         }
         
         return contextualArrayType;
@@ -1591,15 +1615,20 @@ namespace {
                                              /*options=*/0);
 
       // Introduce conversions from each element to the element type of the
-      // array.
+      // array. Elements shared with an earlier element have the same type and
+      // need no conversion of their own.
       unsigned index = 0;
       for (auto element : expr->getElements()) {
+        unsigned elementIndex = index++;
+        if (CS.SharedCollectionElements.count(element))
+          continue;
+
         CS.addConstraint(ConstraintKind::Conversion,
                          element->getType(),
                          arrayElementTy,
                          CS.getConstraintLocator(
                            expr,
-                           LocatorPathElt::getTupleElement(index++)));
+                           LocatorPathElt::getTupleElement(elementIndex)));
       }
 
       return arrayTy;
@@ -1626,6 +1655,13 @@ namespace {
                             dictionaryProto->lookupDirect(
                               C.getIdentifier("Value")).front());
 
+      // If an earlier element of the enclosing collection is a dictionary of
+      // the same shape, use its type; the elements have been shared with it.
+      if (auto shared = CS.SharedCollectionElements.lookup(expr)) {
+        assert(shared->getType() && "shared element not visited yet");
+        return shared->getType();
+      }
+
       auto locator = CS.getConstraintLocator(expr);
       auto dictionaryTy = CS.createTypeVariable(locator,
                                                 TVO_PrefersSubtypeBinding);
@@ -1655,15 +1691,20 @@ namespace {
       Type elementTy = TupleType::get(tupleElts, C);
 
       // Introduce conversions from each element to the element type of the
-      // dictionary.
+      // dictionary. Elements shared with an earlier element have the same
+      // type and need no conversion of their own.
       unsigned index = 0;
       for (auto element : expr->getElements()) {
+        unsigned elementIndex = index++;
+        if (CS.SharedCollectionElements.count(element))
+          continue;
+
         CS.addConstraint(ConstraintKind::Conversion,
                          element->getType(),
                          elementTy,
                          CS.getConstraintLocator(
                            expr,
-                           LocatorPathElt::getTupleElement(index++)));
+                           LocatorPathElt::getTupleElement(elementIndex)));
       }
 
       return dictionaryTy;
@@ -2614,6 +2655,172 @@ namespace {
     bool walkToDeclPre(Decl *decl) override { return false; }
   };
 
+  /// AST walker that finds elements of collection literals that can share
+  /// the type variables and constraints of an earlier element of the same
+  /// collection, and records them in SharedCollectionElements.
+  ///
+  /// Two elements can share when they have the same shape: literals of the
+  /// same kind, or nested tuples, arrays and dictionaries whose elements all
+  /// have the same shape in turn. Elements of a shared nested collection are
+  /// shared with the first element of that shape in the collection it was
+  /// shared with, so that an array of thousands of [Int] literals has a
+  /// single integer literal type variable.
+  class CollectionElementSharer : public ASTWalker {
+    ConstraintSystem &CS;
+
+    /// The shape of each expression seen so far; 0 if it cannot be shared.
+    llvm::DenseMap<Expr *, unsigned> Shapes;
+
+    /// Unique IDs for shapes, keyed on the kind of expression and the
+    /// shapes of its elements.
+    llvm::DenseMap<std::pair<unsigned, std::pair<unsigned, unsigned>>,
+                   unsigned> ShapeIDs;
+
+    unsigned getShapeID(ExprKind kind, unsigned first = 0,
+                        unsigned second = 0) {
+      auto key = std::make_pair(static_cast<unsigned>(kind),
+                                std::make_pair(first, second));
+      auto known = ShapeIDs.find(key);
+      if (known != ShapeIDs.end())
+        return known->second;
+
+      unsigned id = ShapeIDs.size() + 1;
+      ShapeIDs[key] = id;
+      return id;
+    }
+
+    /// Compute the shape shared by all of the given elements, or 0.
+    unsigned getHomogeneousShape(ArrayRef<Expr *> elements) {
+      if (elements.empty())
+        return 0;
+
+      unsigned shape = getShape(elements.front());
+      for (auto element : elements.slice(1)) {
+        if (!shape)
+          break;
+        if (getShape(element) != shape)
+          shape = 0;
+      }
+      return shape;
+    }
+
+    unsigned computeShape(Expr *expr) {
+      switch (expr->getKind()) {
+      case ExprKind::NilLiteral:
+      case ExprKind::IntegerLiteral:
+      case ExprKind::FloatLiteral:
+      case ExprKind::BooleanLiteral:
+      case ExprKind::StringLiteral:
+        if (expr->getType() && !expr->getType()->hasTypeVariable())
+          return 0;
+        return getShapeID(expr->getKind());
+
+      case ExprKind::Tuple: {
+        auto tuple = cast<TupleExpr>(expr);
+        if (tuple->getNumElements() != 2 || tuple->hasElementNames())
+          return 0;
+        unsigned first = getShape(tuple->getElement(0));
+        unsigned second = getShape(tuple->getElement(1));
+        if (!first || !second)
+          return 0;
+        return getShapeID(expr->getKind(), first, second);
+      }
+
+      case ExprKind::Array:
+        if (auto shape = getHomogeneousShape(
+                           cast<ArrayExpr>(expr)->getElements()))
+          return getShapeID(expr->getKind(), shape);
+        return 0;
+
+      case ExprKind::Dictionary:
+        if (auto shape = getHomogeneousShape(
+                           cast<DictionaryExpr>(expr)->getElements()))
+          return getShapeID(expr->getKind(), shape);
+        return 0;
+
+      default:
+        return 0;
+      }
+    }
+
+    unsigned getShape(Expr *expr) {
+      auto known = Shapes.find(expr);
+      if (known != Shapes.end())
+        return known->second;
+
+      unsigned shape = computeShape(expr);
+      Shapes[expr] = shape;
+      return shape;
+    }
+
+    /// Share \p element with \p target, which has the same shape.
+    void share(Expr *element, Expr *target) {
+      CS.SharedCollectionElements[element] = target;
+
+      // The elements of a tuple aren't visited as collection elements, so
+      // share them here. Nested collections share their elements when they
+      // are visited.
+      if (auto tuple = dyn_cast<TupleExpr>(element)) {
+        auto targetTuple = cast<TupleExpr>(target);
+        for (unsigned i = 0, n = tuple->getNumElements(); i != n; ++i)
+          share(tuple->getElement(i), targetTuple->getElement(i));
+      }
+    }
+
+    void shareElements(Expr *collection, ArrayRef<Expr *> elements) {
+      // If this collection is itself shared, share its elements with the
+      // elements of the collection it is shared with.
+      ArrayRef<Expr *> targets = elements;
+      if (auto shared = CS.SharedCollectionElements.lookup(collection)) {
+        if (auto array = dyn_cast<ArrayExpr>(shared))
+          targets = array->getElements();
+        else
+          targets = cast<DictionaryExpr>(shared)->getElements();
+      }
+
+      llvm::SmallDenseMap<unsigned, Expr *, 4> firstOfShape;
+      for (auto target : targets) {
+        if (unsigned shape = getShape(target))
+          firstOfShape.insert({shape, target});
+      }
+
+      for (auto element : elements) {
+        unsigned shape = getShape(element);
+        if (!shape)
+          continue;
+
+        auto target = firstOfShape.lookup(shape);
+        if (target && target != element)
+          share(element, target);
+      }
+    }
+
+  public:
+    CollectionElementSharer(ConstraintSystem &cs) : CS(cs) { }
+
+    std::pair<bool, Expr *> walkToExprPre(Expr *expr) override {
+      if (auto array = dyn_cast<ArrayExpr>(expr))
+        shareElements(array, array->getElements());
+      else if (auto dictionary = dyn_cast<DictionaryExpr>(expr))
+        shareElements(dictionary, dictionary->getElements());
+
+      // We don't visit default value expressions; they've already been
+      // type-checked.
+      if (isa<DefaultValueExpr>(expr))
+        return { false, expr };
+
+      return { true, expr };
+    }
+
+    /// \brief Ignore statements.
+    std::pair<bool, Stmt *> walkToStmtPre(Stmt *stmt) override {
+      return { false, stmt };
+    }
+
+    /// \brief Ignore declarations.
+    bool walkToDeclPre(Decl *decl) override { return false; }
+  };
+
   /// AST walker that records the keyword arguments provided at each
   /// call site.
   class ArgumentLabelWalker : public ASTWalker {
@@ -2685,6 +2892,10 @@ Expr *ConstraintSystem::generateConstraints(Expr *expr) {
   // Walk the expression to associate labeled arguments.
   expr->walk(ArgumentLabelWalker(*this, expr));
 
+  // Walk the expression to find collection literal elements that can share
+  // constraints.
+  expr->walk(CollectionElementSharer(*this));
+
   // Walk the expression, generating constraints.
   ConstraintGenerator cg(*this);
   ConstraintWalker cw(cg);
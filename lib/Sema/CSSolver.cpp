@@ -18,6 +18,7 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include <algorithm>
 #include <memory>
 #include <tuple>
 using namespace swift;
@@ -412,6 +413,10 @@ ConstraintSystem::SolverState::~SolverState() {
   LangOptions &langOpts = CS.getTypeChecker().Context.LangOpts;
   langOpts.DebugConstraintSolver = OldDebugConstraintSolver;
 
+  // Attribute the work to the type checker, for the type-check report.
+  CS.TC.NumSolverStatesExplored += NumStatesExplored;
+  CS.TC.NumSolverDisjunctions += NumDisjunctions;
+
   // Write our local statistics back to the overall statistics.
   #define CS_STATISTIC(Name, Description) JOIN2(Overall,Name) += Name;
   #include "ConstraintSolverStats.def"
@@ -1301,11 +1306,38 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
   std::unique_ptr<SmallVector<Solution, 4>[]> 
     partialSolutions(new SmallVector<Solution, 4>[numComponents]);
   Optional<Score> PreviousBestScore = solverState->BestScore;
+
+  // The sum of the best scores of the components solved so far, relative to
+  // the current score. Every combination of partial solutions costs at least
+  // this much, so it tightens the bound on each of the remaining components.
+  Score BestPartialScores;
   for (unsigned component = 0; component != numComponents; ++component) {
     assert(InactiveConstraints.empty() && 
            "Some constraints were not transferred?");
     ++solverState->NumComponentsSplit;
 
+    if (PreviousBestScore && component > 0) {
+      // If no combination can beat the best solution, we're done.
+      if (CurrentScore + BestPartialScores > *PreviousBestScore) {
+        returnAllConstraints();
+        return true;
+      }
+
+      // Score ordering is preserved under subtraction, so a partial solution
+      // can only lead to a better solution if it is no worse than the best
+      // score less the partial scores already committed to. Only tighten the
+      // bound when the subtraction does not wrap around.
+      bool canTighten = true;
+      for (unsigned i = 0; i != NumScoreKinds; ++i) {
+        if (BestPartialScores.Data[i] > PreviousBestScore->Data[i]) {
+          canTighten = false;
+          break;
+        }
+      }
+      if (canTighten)
+        solverState->BestScore = *PreviousBestScore - BestPartialScores;
+    }
+
     // Collect the constraints for this component.
     InactiveConstraints.splice(InactiveConstraints.end(), 
                                constraintBuckets[component]);
@@ -1355,6 +1387,7 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
       
       TypeVariables = std::move(allTypeVariables);
       returnAllConstraints();
+      solverState->BestScore = PreviousBestScore;
       return true;
     }
 
@@ -1372,8 +1405,13 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
 
     // For each of the partial solutions, substract off the current score.
     // It doesn't contribute.
-    for (auto &solution : partialSolutions[component])
+    Optional<Score> bestPartialScore;
+    for (auto &solution : partialSolutions[component]) {
       solution.getFixedScore() -= CurrentScore;
+      if (!bestPartialScore || solution.getFixedScore() < *bestPartialScore)
+        bestPartialScore = solution.getFixedScore();
+    }
+    BestPartialScores += *bestPartialScore;
 
     // Restore the previous best score.
     solverState->BestScore = PreviousBestScore;
@@ -1402,15 +1440,25 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
   bool done = false;
   bool anySolutions = false;
   do {
+    // This combination might be worse than the best solution found so far.
+    // If so, skip it without applying any of its partial solutions.
+    Score combinedScore = CurrentScore;
+    for (unsigned i = 0; i != numComponents; ++i)
+      combinedScore += partialSolutions[i][indices[i]].getFixedScore();
+    bool worseCombination = solverState->BestScore &&
+                            combinedScore > *solverState->BestScore;
+
     // Create a new solver scope in which we apply all of the partial
     // solutions.
     SolverScope scope(*this);
-    for (unsigned i = 0; i != numComponents; ++i)
-      applySolution(partialSolutions[i][indices[i]]);
+    if (!worseCombination) {
+      for (unsigned i = 0; i != numComponents; ++i)
+        applySolution(partialSolutions[i][indices[i]]);
+    }
 
     // This solution might be worse than the best solution found so far. If so,
     // skip it.
-    if (!worseThanBestSolution()) {
+    if (!worseCombination && !worseThanBestSolution()) {
       // Finalize this solution.
       auto solution = finalize(allowFreeTypeVariables);
       if (TC.getLangOpts().DebugConstraintSolver) {
@@ -1507,6 +1555,165 @@ static bool shortCircuitDisjunctionAt(Constraint *constraint,
   return false;
 }
 
+/// Retrieve the argument type of the call that applies the overload set
+/// bound by the given BindOverload constraint, simplified with the bindings
+/// made so far, or a null type if there is no such call.
+static Type getOverloadArgumentType(ConstraintSystem &cs,
+                                    Constraint *bindOverload) {
+  auto fnTypeVar = bindOverload->getFirstType()->getAs<TypeVariableType>();
+  if (!fnTypeVar)
+    return Type();
+  fnTypeVar = cs.getRepresentative(fnTypeVar);
+
+  SmallVector<Constraint *, 8> constraints;
+  cs.getConstraintGraph().gatherConstraints(fnTypeVar, constraints);
+  for (auto constraint : constraints) {
+    if (constraint->getKind() != ConstraintKind::ApplicableFunction)
+      continue;
+
+    auto calleeTypeVar
+      = constraint->getSecondType()->getAs<TypeVariableType>();
+    if (!calleeTypeVar || cs.getRepresentative(calleeTypeVar) != fnTypeVar)
+      continue;
+
+    if (auto fnType = constraint->getFirstType()->getAs<FunctionType>())
+      return cs.simplifyType(fnType->getInput());
+  }
+
+  return Type();
+}
+
+/// Split a parameter or argument type into its element types.
+static void getElementTypes(Type type, SmallVectorImpl<Type> &elements) {
+  if (auto tuple = type->getAs<TupleType>()) {
+    for (const auto &elt : tuple->getElements())
+      elements.push_back(elt.getType());
+    return;
+  }
+
+  elements.push_back(type->getWithoutParens());
+}
+
+namespace {
+  /// How well an overload choice fits the arguments it is applied to.
+  enum class ArgumentMatch {
+    /// Every argument whose type is known has exactly the parameter type;
+    /// literals have their default type.
+    Exact,
+    /// Every argument whose type is known has exactly the parameter type;
+    /// literals can be of the parameter type.
+    Literal,
+    /// Nothing is known, or some argument does not have the parameter type.
+    None,
+  };
+}
+
+/// Determine how well the parameters of the non-generic function \p decl
+/// accept the argument type \p argTy, as far as it is known.
+static ArgumentMatch matchKnownArguments(ConstraintSystem &cs, ValueDecl *decl,
+                                         Type argTy) {
+  // Members are curried; only free functions (including all operators) are
+  // ranked.
+  if (decl->getDeclContext()->isTypeContext() || !decl->hasType())
+    return ArgumentMatch::None;
+
+  auto fnType = decl->getType()->getAs<FunctionType>();
+  if (!fnType)
+    return ArgumentMatch::None;
+
+  SmallVector<Type, 4> params, args;
+  getElementTypes(fnType->getInput(), params);
+  getElementTypes(argTy, args);
+  if (params.size() != args.size())
+    return ArgumentMatch::None;
+
+  bool anyKnown = false;
+  auto result = ArgumentMatch::Exact;
+  for (unsigned i = 0, n = args.size(); i != n; ++i) {
+    auto arg = args[i]->getLValueOrInOutObjectType();
+    auto param = params[i]->getLValueOrInOutObjectType();
+
+    if (auto argTypeVar = arg->getAs<TypeVariableType>()) {
+      auto proto = argTypeVar->getImpl().literalConformanceProto;
+      if (!proto)
+        continue;
+
+      anyKnown = true;
+      auto defaultTy = cs.TC.getDefaultType(proto, cs.DC);
+      if (defaultTy && param->isEqual(defaultTy))
+        continue;
+      if (!param->getAs<StructType>() ||
+          !cs.TC.conformsToProtocol(param, proto, cs.DC,
+                                    ConformanceCheckFlags::InExpression))
+        return ArgumentMatch::None;
+
+      result = ArgumentMatch::Literal;
+      continue;
+    }
+
+    if (arg->hasTypeVariable())
+      continue;
+
+    anyKnown = true;
+    if (!arg->isEqual(param))
+      return ArgumentMatch::None;
+  }
+
+  return anyKnown ? result : ArgumentMatch::None;
+}
+
+/// Compute the order in which to attempt the terms of a disjunction: favored
+/// terms first, then overloads that accept the argument types known so far,
+/// then the remaining non-generic overloads and finally generic ones. The
+/// order is stable, so terms of the same rank keep their original order.
+static void rankDisjunctionChoices(ConstraintSystem &cs,
+                                   ArrayRef<Constraint *> constraints,
+                                   SmallVectorImpl<unsigned> &order) {
+  SmallVector<unsigned, 8> ranks;
+  Type argTy;
+  bool computedArgTy = false;
+  for (auto constraint : constraints) {
+    if (constraint->isFavored()) {
+      ranks.push_back(0);
+      continue;
+    }
+
+    if (constraint->getKind() != ConstraintKind::BindOverload ||
+        constraint->getOverloadChoice().getKind() != OverloadChoiceKind::Decl) {
+      ranks.push_back(3);
+      continue;
+    }
+
+    auto decl = constraint->getOverloadChoice().getDecl();
+    if (decl->getInterfaceType() &&
+        decl->getInterfaceType()->is<GenericFunctionType>()) {
+      ranks.push_back(4);
+      continue;
+    }
+
+    // All terms bind the same overload set, so the arguments are shared.
+    if (!computedArgTy) {
+      argTy = getOverloadArgumentType(cs, constraint);
+      computedArgTy = true;
+    }
+
+    auto match = argTy ? matchKnownArguments(cs, decl, argTy)
+                       : ArgumentMatch::None;
+    switch (match) {
+    case ArgumentMatch::Exact:   ranks.push_back(1); break;
+    case ArgumentMatch::Literal: ranks.push_back(2); break;
+    case ArgumentMatch::None:    ranks.push_back(3); break;
+    }
+  }
+
+  for (unsigned index : indices(constraints))
+    order.push_back(index);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](unsigned lhs, unsigned rhs) {
+                     return ranks[lhs] < ranks[rhs];
+                   });
+}
+
 bool ConstraintSystem::solveSimplified(
        SmallVectorImpl<Solution> &solutions,
        FreeTypeVariableBinding allowFreeTypeVariables) {
@@ -1614,7 +1821,14 @@ bool ConstraintSystem::solveSimplified(
   Constraint *firstSolvedConstraint = nullptr;
   ++solverState->NumDisjunctions;
   auto constraints = disjunction->getNestedConstraints();
-  for (auto index : indices(constraints)) {
+  SmallVector<unsigned, 8> order;
+  if (TC.getLangOpts().SolverRankDisjunctionChoices) {
+    rankDisjunctionChoices(*this, constraints, order);
+  } else {
+    for (auto index : indices(constraints))
+      order.push_back(index);
+  }
+  for (auto index : order) {
     auto constraint = constraints[index];
 
     // We already have a solution; check whether we should
@@ -571,92 +571,96 @@ void ConstraintGraph::gatherConstraints(
 
 #pragma mark Algorithms
 
-/// Depth-first search for connected components
-static void connectedComponentsDFS(ConstraintGraph &cg,
-                                   ConstraintGraphNode &node,
-                                   unsigned component,
-                                   SmallVectorImpl<unsigned> &components) {
-  // Local function that recurses on the given set of type variables.
-  auto visitAdjacencies = [&](ArrayRef<TypeVariableType *> typeVars) {
-    for (auto adj : typeVars) {
-      auto nodeAndIndex = cg.lookupNode(adj);
-      // If we've already seen this node in this component, we're done.
-      unsigned &curComponent = components[nodeAndIndex.second];
-      if (curComponent == component)
-        continue;
-
-      // Mark this node as part of this connected component, then recurse.
-      assert(curComponent == components.size() && "Already in a component?");
-      curComponent = component;
-      connectedComponentsDFS(cg, nodeAndIndex.first, component, components);
-    }
-  };
-
-  // Recurse to mark adjacent nodes as part of this connected component.
-  visitAdjacencies(node.getAdjacencies());
-
-  // Figure out the representative for this type variable.
-  auto &cs = cg.getConstraintSystem();
-  auto typeVarRep = cs.getRepresentative(node.getTypeVariable());
-  if (typeVarRep == node.getTypeVariable()) {
-    // This type variable is the representative of its set; visit all of the
-    // other type variables in the same equivalence class.
-    visitAdjacencies(node.getEquivalenceClass().slice(1));
-  } else {
-    // Otherwise, visit the representative of the set.
-    visitAdjacencies(typeVarRep);
-  }
-}
-
 unsigned ConstraintGraph::computeConnectedComponents(
            SmallVectorImpl<TypeVariableType *> &typeVars,
            SmallVectorImpl<unsigned> &components) {
-  // Track those type variables that the caller cares about.
+  // Track those type variables that the caller cares about. The search
+  // starts from them, or from every type variable if there are none.
+  bool considerAllTypeVars = typeVars.empty();
   llvm::SmallPtrSet<TypeVariableType *, 4> typeVarSubset(typeVars.begin(),
                                                          typeVars.end());
+  SmallVector<TypeVariableType *, 16> seeds;
+  if (considerAllTypeVars)
+    seeds.append(TypeVariables.begin(), TypeVariables.end());
+  else
+    seeds.append(typeVars.begin(), typeVars.end());
   typeVars.clear();
 
-  // Initialize the components with component == # of type variables,
-  // a sentinel value indicating
-  unsigned numTypeVariables = TypeVariables.size();
-  components.assign(numTypeVariables, numTypeVariables);
-
-  // Perform a depth-first search from each type variable to identify
-  // what component it is in.
+  // Search from each seed to identify what component it is in. Only nodes
+  // reachable from the seeds are visited, so that solving one component of
+  // a large constraint system doesn't walk the rest of the graph. The
+  // search uses an explicit worklist so that long chains of type variables
+  // can't overflow the stack.
+  llvm::DenseMap<unsigned, unsigned> nodeComponents;
+  SmallVector<unsigned, 16> visitedNodes;
+  SmallVector<ConstraintGraphNode *, 16> worklist;
   unsigned numComponents = 0;
-  for (unsigned i = 0; i != numTypeVariables; ++i) {
-    auto typeVar = TypeVariables[i];
-
-    // Look up the node for this type variable.
-    auto nodeAndIndex = lookupNode(typeVar);
-
-    // If we're already assigned a component for this node, skip it.
-    unsigned &curComponent = components[nodeAndIndex.second];
-    if (curComponent != numTypeVariables)
+  for (auto seed : seeds) {
+    auto nodeAndIndex = lookupNode(seed);
+    if (!nodeComponents.insert({nodeAndIndex.second, numComponents}).second)
       continue;
 
-    // Record this component.
     unsigned component = numComponents++;
+    visitedNodes.push_back(nodeAndIndex.second);
+    worklist.push_back(&nodeAndIndex.first);
+
+    // Local function that queues the given type variables' nodes, if they
+    // haven't been seen yet.
+    auto visitAdjacencies = [&](ArrayRef<TypeVariableType *> adjacencies) {
+      for (auto adj : adjacencies) {
+        auto adjNodeAndIndex = lookupNode(adj);
+        if (!nodeComponents.insert({adjNodeAndIndex.second, component}).second)
+          continue;
+
+        visitedNodes.push_back(adjNodeAndIndex.second);
+        worklist.push_back(&adjNodeAndIndex.first);
+      }
+    };
+
+    while (!worklist.empty()) {
+      auto node = worklist.pop_back_val();
+      visitAdjacencies(node->getAdjacencies());
+
+      // Figure out the representative for this type variable.
+      auto typeVarRep = CS.getRepresentative(node->getTypeVariable());
+      if (typeVarRep == node->getTypeVariable()) {
+        // This type variable is the representative of its set; visit all of
+        // the other type variables in the same equivalence class.
+        visitAdjacencies(node->getEquivalenceClass().slice(1));
+      } else {
+        // Otherwise, visit the representative of the set.
+        visitAdjacencies(typeVarRep);
+      }
+    }
+  }
 
-    // Note that this node is part of this component, then visit it.
-    curComponent = component;
-    connectedComponentsDFS(*this, nodeAndIndex.first, component, components);
+  // Report type variables in graph order, with components numbered in the
+  // order of their first type variable, independent of where the search
+  // started.
+  std::sort(visitedNodes.begin(), visitedNodes.end());
+  SmallVector<unsigned, 4> componentOrder(numComponents, numComponents);
+  unsigned numOrdered = 0;
+  for (auto index : visitedNodes) {
+    unsigned &order = componentOrder[nodeComponents[index]];
+    if (order == numComponents)
+      order = numOrdered++;
   }
 
   // Figure out which components have unbound type variables; these
   // are the only components and type variables we want to report.
   SmallVector<bool, 4> componentHasUnboundTypeVar(numComponents, false);
-  for (unsigned i = 0; i != numTypeVariables; ++i) {
+  for (auto index : visitedNodes) {
     // If this type variable has a fixed type, skip it.
-    if (CS.getFixedType(TypeVariables[i]))
+    auto typeVar = TypeVariables[index];
+    if (CS.getFixedType(typeVar))
       continue;
 
     // If we only care about a subset, and this type variable isn't in that
     // subset, skip it.
-    if (!typeVarSubset.empty() && typeVarSubset.count(TypeVariables[i]) == 0)
+    if (!considerAllTypeVars && typeVarSubset.count(typeVar) == 0)
       continue;
 
-    componentHasUnboundTypeVar[components[i]] = true;
+    componentHasUnboundTypeVar[componentOrder[nodeComponents[index]]] = true;
   }
 
   // Renumber the old components to the new components.
@@ -672,17 +676,16 @@ unsigned ConstraintGraph::computeConnectedComponents(
 
   // Copy over the type variables in the live components and remap
   // component numbers.
-  unsigned outIndex = 0;
-  for (unsigned i = 0, n = TypeVariables.size(); i != n; ++i) {
+  components.clear();
+  for (auto index : visitedNodes) {
     // Skip type variables in dead components.
-    if (!componentHasUnboundTypeVar[components[i]])
+    unsigned component = componentOrder[nodeComponents[index]];
+    if (!componentHasUnboundTypeVar[component])
       continue;
 
-    typeVars.push_back(TypeVariables[i]);
-    components[outIndex] = componentRenumbering[components[i]];
-    ++outIndex;
+    typeVars.push_back(TypeVariables[index]);
+    components.push_back(componentRenumbering[component]);
   }
-  components.erase(components.begin() + outIndex, components.end());
 
   return numComponents;
 }
@@ -19,10 +19,17 @@
 #include "ConstraintGraph.h"
 #include "swift/AST/ArchetypeBuilder.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 
 using namespace swift;
 using namespace constraints;
 
+#define DEBUG_TYPE "Constraint solver memory"
+STATISTIC(NumSolverBytesFreed,
+          "# of bytes freed when constraint systems were destroyed");
+STATISTIC(LargestSolverBytesFreed,
+          "# of bytes freed by the largest constraint system");
+
 ConstraintSystem::ConstraintSystem(TypeChecker &tc, DeclContext *dc,
                                    ConstraintSystemOptions options)
   : TC(tc), DC(dc), Options(options),
@@ -39,6 +46,17 @@ ConstraintSystem::ConstraintSystem(TypeChecker &tc, DeclContext *dc,
 
 ConstraintSystem::~ConstraintSystem() {
   delete &CG;
+
+  // Everything the solver allocated, including the types that involve type
+  // variables, lives in Allocator and goes away with this system.
+  size_t bytesFreed = Allocator.getTotalMemory();
+  TC.NumSolverBytesFreed += bytesFreed;
+  NumSolverBytesFreed += bytesFreed;
+  // FIXME: This is not at all thread-safe.
+  if (bytesFreed > LargestSolverBytesFreed.Value) {
+    LargestSolverBytesFreed.Value = bytesFreed - 1;
+    ++LargestSolverBytesFreed;
+  }
 }
 
 bool ConstraintSystem::hasFreeTypeVariables() {
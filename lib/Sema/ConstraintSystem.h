@@ -1309,6 +1309,15 @@ public:
   /// that locator.
   llvm::DenseMap<ConstraintLocator *, ArrayRef<Identifier>> ArgumentLabels;
 
+  /// A mapping from elements of collection literals to an earlier element
+  /// of the same collection with the same shape, such as another integer
+  /// literal or another array of string literals.
+  ///
+  /// Such elements share the type variables and constraints of the earlier
+  /// element, so that a large homogeneous literal is solved once per shape
+  /// of element rather than once per element.
+  llvm::DenseMap<Expr *, Expr *> SharedCollectionElements;
+
   /// FIXME: This is a workaround for the way we perform protocol
   /// conformance checking for generic requirements, where we re-use
   /// the archetypes of the requirement (rather than, say, building
@@ -21,6 +21,7 @@
 #include "swift/AST/Decl.h"
 #include "swift/AST/Stmt.h"
 #include "swift/AST/Expr.h"
+#include "swift/AST/NameLookup.h"
 #include "swift/AST/Types.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/SmallString.h"
@@ -31,19 +32,65 @@ using namespace swift;
 using namespace DerivedConformance;
 
 /// Common preconditions for Equatable and Hashable.
-static bool canDeriveConformance(NominalTypeDecl *type) {
-  // The type must be an enum.
-  // TODO: Structs with Equatable/Hashable/Comparable members
-  auto enumDecl = dyn_cast<EnumDecl>(type);
-  if (!enumDecl)
-    return false;
-  
-  // The enum must not have associated values.
-  // TODO: Enums with Equatable/Hashable/Comparable payloads
-  if (!enumDecl->hasOnlyCasesWithoutAssociatedValues())
-    return false;
-  
-  return true;
+static bool canDeriveConformance(TypeChecker &tc, NominalTypeDecl *type,
+                                 ProtocolDecl *protocol) {
+  if (auto enumDecl = dyn_cast<EnumDecl>(type)) {
+    // The enum must not have associated values.
+    // TODO: Enums with Equatable/Hashable/Comparable payloads
+    return enumDecl->hasOnlyCasesWithoutAssociatedValues();
+  }
+
+  if (auto structDecl = dyn_cast<StructDecl>(type)) {
+    // A derived '==' for a generic struct would not be found by the
+    // constraint solver; see addNewEqualsOperatorOverloads.
+    if (structDecl->getGenericParamsOfContext())
+      return false;
+
+    // Every stored property must conform to the protocol.
+    for (auto *property : structDecl->getStoredProperties()) {
+      tc.validateDecl(property);
+      if (!property->hasType() || property->isInvalid())
+        return false;
+
+      auto propertyType = property->getType()->getReferenceStorageReferent();
+      if (!tc.conformsToProtocol(propertyType, protocol, structDecl, None))
+        return false;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+/// Returns a reference to the global operator \p name as seen from the file
+/// declaring \p type.
+///
+/// Derived operators live in the module's derived file unit, which does not
+/// see the imports of the file that declares the type, so operators used in
+/// their bodies are resolved up front.
+static Expr *createOperatorRef(NominalTypeDecl *type, Identifier name) {
+  ASTContext &C = type->getASTContext();
+  UnqualifiedLookup lookup(name, type->getModuleScopeContext(), nullptr);
+
+  SmallVector<ValueDecl *, 8> decls;
+  for (auto &result : lookup.Results)
+    decls.push_back(result.getValueDecl());
+  assert(!decls.empty() && "operator lookup should find the stdlib operator");
+
+  return new (C) OverloadedDeclRefExpr(C.AllocateCopy(decls), SourceLoc(),
+                                       /*implicit*/ true);
+}
+
+/// Create an expression which applies the binary operator \p name to \p lhs
+/// and \p rhs.
+static Expr *createBinaryOperator(NominalTypeDecl *type, Identifier name,
+                                  Expr *lhs, Expr *rhs) {
+  ASTContext &C = type->getASTContext();
+  auto args = TupleExpr::create(C, SourceLoc(), { lhs, rhs }, { }, { },
+                                SourceLoc(), /*HasTrailingClosure*/ false,
+                                /*Implicit*/ true);
+  return new (C) BinaryExpr(createOperatorRef(type, name), args,
+                            /*implicit*/ true);
 }
 
 /// Create AST statements which convert from an enum to an Int with a switch.
@@ -172,9 +219,58 @@ static void deriveBodyEquatable_enum_eq(AbstractFunctionDecl *eqDecl) {
   eqDecl->setBody(body);
 }
 
-/// Derive an '==' operator implementation for an enum.
+/// Derive the body for an '==' operator for a struct
+static void deriveBodyEquatable_struct_eq(AbstractFunctionDecl *eqDecl) {
+  auto parentDC = eqDecl->getDeclContext();
+  ASTContext &C = parentDC->getASTContext();
+
+  auto args = cast<TuplePattern>(eqDecl->getBodyParamPatterns().back());
+  auto aPattern = args->getElement(0).getPattern();
+  auto aParam =
+    cast<NamedPattern>(aPattern->getSemanticsProvidingPattern())->getDecl();
+  auto bPattern = args->getElement(1).getPattern();
+  auto bParam =
+    cast<NamedPattern>(bPattern->getSemanticsProvidingPattern())->getDecl();
+
+  auto structDecl = cast<StructDecl>(aParam->getType()->getAnyNominal());
+
+  // Compare the stored properties in declaration order, stopping at the
+  // first one that differs.
+  Expr *cmpExpr = nullptr;
+  for (auto *property : structDecl->getStoredProperties()) {
+    // generate: a.<property> == b.<property>
+    auto aRef = new (C) DeclRefExpr(aParam, SourceLoc(), /*implicit*/ true);
+    auto aMember = new (C) UnresolvedDotExpr(aRef, SourceLoc(),
+                                             property->getName(), SourceLoc(),
+                                             /*implicit*/ true);
+    auto bRef = new (C) DeclRefExpr(bParam, SourceLoc(), /*implicit*/ true);
+    auto bMember = new (C) UnresolvedDotExpr(bRef, SourceLoc(),
+                                             property->getName(), SourceLoc(),
+                                             /*implicit*/ true);
+    Expr *propertyCmp = createBinaryOperator(structDecl, C.Id_EqualsOperator,
+                                             aMember, bMember);
+
+    // generate: <previous comparisons> && <property comparison>
+    if (cmpExpr)
+      cmpExpr = createBinaryOperator(structDecl, C.getIdentifier("&&"),
+                                     cmpExpr, propertyCmp);
+    else
+      cmpExpr = propertyCmp;
+  }
+
+  // Values of a struct without stored properties are all equal.
+  if (!cmpExpr)
+    cmpExpr = new (C) BooleanLiteralExpr(true, SourceLoc(), /*implicit*/ true);
+
+  auto returnStmt = new (C) ReturnStmt(SourceLoc(), cmpExpr);
+  eqDecl->setBody(BraceStmt::create(C, SourceLoc(), ASTNode(returnStmt),
+                                    SourceLoc()));
+}
+
+/// Derive an '==' operator implementation for an enum or struct.
 static ValueDecl *
-deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
+deriveEquatable_eq(TypeChecker &tc, Decl *parentDecl, NominalTypeDecl *typeDecl,
+                   AbstractFunctionDecl::BodySynthesizer synthesizer) {
   // enum SomeEnum<T...> {
   //   case A, B, C
   // }
@@ -194,11 +290,20 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   //   }
   //   return index_a == index_b
   // }
+  //
+  // struct SomeStruct {
+  //   var x: X
+  //   var y: Y
+  // }
+  // @derived
+  // func ==(a: SomeStruct, b: SomeStruct) -> Bool {
+  //   return a.x == b.x && a.y == b.y
+  // }
   
   ASTContext &C = tc.Context;
   
   auto parentDC = cast<DeclContext>(parentDecl);
-  auto enumTy = parentDC->getDeclaredTypeInContext();
+  auto selfTy = parentDC->getDeclaredTypeInContext();
   
   auto getParamPattern = [&](StringRef s) -> std::pair<VarDecl*, Pattern*> {
     VarDecl *aDecl = new (C) ParamDecl(/*isLet*/ true,
@@ -206,13 +311,13 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
                                        Identifier(),
                                        SourceLoc(),
                                        C.getIdentifier(s),
-                                       enumTy,
+                                       selfTy,
                                        parentDC);
     aDecl->setImplicit();
     Pattern *aParam = new (C) NamedPattern(aDecl, /*implicit*/ true);
-    aParam->setType(enumTy);
-    aParam = new (C) TypedPattern(aParam, TypeLoc::withoutLoc(enumTy));
-    aParam->setType(enumTy);
+    aParam->setType(selfTy);
+    aParam = new (C) TypedPattern(aParam, TypeLoc::withoutLoc(selfTy));
+    aParam->setType(selfTy);
     aParam->setImplicit();
     return {aDecl, aParam};
   };
@@ -221,8 +326,8 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   auto bParam = getParamPattern("b");
   
   TupleTypeElt typeElts[] = {
-    TupleTypeElt(enumTy),
-    TupleTypeElt(enumTy)
+    TupleTypeElt(selfTy),
+    TupleTypeElt(selfTy)
   };
   auto paramsTy = TupleType::get(typeElts, C);
   
@@ -263,8 +368,8 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   }
 
   eqDecl->setOperatorDecl(op);
-  eqDecl->setDerivedForTypeDecl(enumDecl);
-  eqDecl->setBodySynthesizer(&deriveBodyEquatable_enum_eq);
+  eqDecl->setDerivedForTypeDecl(typeDecl);
+  eqDecl->setBodySynthesizer(synthesizer);
 
   // Compute the type.
   Type fnTy;
@@ -277,9 +382,9 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   // Compute the interface type.
   Type interfaceTy;
   if (auto genericSig = parentDC->getGenericSignatureOfContext()) {
-    auto enumIfaceTy = parentDC->getDeclaredInterfaceType();
+    auto selfIfaceTy = parentDC->getDeclaredInterfaceType();
     TupleTypeElt ifaceParamElts[] = {
-      enumIfaceTy, enumIfaceTy,
+      selfIfaceTy, selfIfaceTy,
     };
     auto ifaceParamsTy = TupleType::get(ifaceParamElts, C);
     
@@ -291,12 +396,12 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   }
   eqDecl->setInterfaceType(interfaceTy);
 
-  // Since we can't insert the == operator into the same FileUnit as the enum,
+  // Since we can't insert the == operator into the same FileUnit as the type
   // itself, we have to give it at least internal access.
-  eqDecl->setAccessibility(std::max(enumDecl->getFormalAccess(),
+  eqDecl->setAccessibility(std::max(typeDecl->getFormalAccess(),
                                     Accessibility::Internal));
 
-  if (enumDecl->hasClangNode())
+  if (typeDecl->hasClangNode())
     tc.implicitlyDefinedFunctions.push_back(eqDecl);
   
   // Since it's an operator we insert the decl after the type at global scope.
@@ -308,15 +413,19 @@ ValueDecl *DerivedConformance::deriveEquatable(TypeChecker &tc,
                                                NominalTypeDecl *type,
                                                ValueDecl *requirement) {
   // Check that we can actually derive Equatable for this type.
-  if (!canDeriveConformance(type))
+  auto equatableProto = tc.Context.getProtocol(KnownProtocolKind::Equatable);
+  if (!canDeriveConformance(tc, type, equatableProto))
     return nullptr;
 
   // Build the necessary decl.
   if (requirement->getName().str() == "==") {
-    if (auto theEnum = dyn_cast<EnumDecl>(type))
-      return deriveEquatable_enum_eq(tc, parentDecl, theEnum);
-    else
-      llvm_unreachable("todo");
+    if (isa<EnumDecl>(type))
+      return deriveEquatable_eq(tc, parentDecl, type,
+                                &deriveBodyEquatable_enum_eq);
+    if (isa<StructDecl>(type))
+      return deriveEquatable_eq(tc, parentDecl, type,
+                                &deriveBodyEquatable_struct_eq);
+    llvm_unreachable("todo");
   }
   tc.diagnose(requirement->getLoc(),
               diag::broken_equatable_requirement);
@@ -351,10 +460,51 @@ deriveBodyHashable_enum_hashValue(AbstractFunctionDecl *hashValueDecl) {
   hashValueDecl->setBody(body);
 }
 
-/// Derive a 'hashValue' implementation for an enum.
+/// Derive the body for the 'hashValue' getter for a struct
+static void
+deriveBodyHashable_struct_hashValue(AbstractFunctionDecl *hashValueDecl) {
+  auto parentDC = hashValueDecl->getDeclContext();
+  ASTContext &C = parentDC->getASTContext();
+
+  auto structDecl =
+    cast<StructDecl>(parentDC->isNominalTypeOrNominalTypeExtensionContext());
+  FuncDecl *combineFunc = C.getCombineHashValuesDecl(nullptr);
+  assert(combineFunc && "should have _combineHashValues as we checked for it");
+
+  // generate: 0
+  Expr *hashExpr = new (C) IntegerLiteralExpr("0", SourceLoc(),
+                                              /*implicit*/ true);
+  for (auto *property : structDecl->getStoredProperties()) {
+    // generate: self.<property>.hashValue
+    auto selfRef = createSelfDeclRef(hashValueDecl);
+    auto propertyRef = new (C) UnresolvedDotExpr(selfRef, SourceLoc(),
+                                                 property->getName(),
+                                                 SourceLoc(),
+                                                 /*implicit*/ true);
+    auto propertyHash = new (C) UnresolvedDotExpr(propertyRef, SourceLoc(),
+                                                  C.Id_hashValue, SourceLoc(),
+                                                  /*implicit*/ true);
+
+    // generate: _combineHashValues(<hash so far>, <property hash>)
+    auto combineRef = new (C) DeclRefExpr(combineFunc, SourceLoc(),
+                                          /*implicit*/ true);
+    auto args = TupleExpr::create(C, SourceLoc(), { hashExpr, propertyHash },
+                                  { }, { }, SourceLoc(),
+                                  /*HasTrailingClosure*/ false,
+                                  /*Implicit*/ true);
+    hashExpr = new (C) CallExpr(combineRef, args, /*Implicit*/ true);
+  }
+
+  auto returnStmt = new (C) ReturnStmt(SourceLoc(), hashExpr);
+  hashValueDecl->setBody(BraceStmt::create(C, SourceLoc(), ASTNode(returnStmt),
+                                           SourceLoc()));
+}
+
+/// Derive a 'hashValue' implementation for an enum or struct.
 static ValueDecl *
-deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
-                              EnumDecl *enumDecl) {
+deriveHashable_hashValue(TypeChecker &tc, Decl *parentDecl,
+                         NominalTypeDecl *typeDecl,
+                         AbstractFunctionDecl::BodySynthesizer synthesizer) {
   // enum SomeEnum {
   //   case A, B, C
   //   @derived var hashValue: Int {
@@ -370,25 +520,34 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
   //     return index.hashValue
   //   }
   // }
+  //
+  // struct SomeStruct {
+  //   var x: X
+  //   var y: Y
+  //   @derived var hashValue: Int {
+  //     return _combineHashValues(_combineHashValues(0, self.x.hashValue),
+  //                               self.y.hashValue)
+  //   }
+  // }
   ASTContext &C = tc.Context;
   
   auto parentDC = cast<DeclContext>(parentDecl);
 
-  Type enumType = parentDC->getDeclaredTypeInContext();
+  Type nominalType = parentDC->getDeclaredTypeInContext();
   Type intType = C.getIntDecl()->getDeclaredType();
   
   // We can't form a Hashable conformance if Int isn't Hashable or
   // IntegerLiteralConvertible.
   if (!tc.conformsToProtocol(intType,C.getProtocol(KnownProtocolKind::Hashable),
-                             enumDecl, None)) {
-    tc.diagnose(enumDecl->getLoc(), diag::broken_int_hashable_conformance);
+                             typeDecl, None)) {
+    tc.diagnose(typeDecl->getLoc(), diag::broken_int_hashable_conformance);
     return nullptr;
   }
 
   ProtocolDecl *intLiteralProto =
       C.getProtocol(KnownProtocolKind::IntegerLiteralConvertible);
-  if (!tc.conformsToProtocol(intType, intLiteralProto, enumDecl, None)) {
-    tc.diagnose(enumDecl->getLoc(),
+  if (!tc.conformsToProtocol(intType, intLiteralProto, typeDecl, None)) {
+    tc.diagnose(typeDecl->getLoc(),
                 diag::broken_int_integer_literal_convertible_conformance);
     return nullptr;
   }
@@ -398,13 +557,14 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
                                         Identifier(),
                                         SourceLoc(),
                                         C.Id_self,
-                                        enumType,
+                                        nominalType,
                                         parentDC);
   selfDecl->setImplicit();
   Pattern *selfParam = new (C) NamedPattern(selfDecl, /*implicit*/ true);
-  selfParam->setType(enumType);
-  selfParam = new (C) TypedPattern(selfParam, TypeLoc::withoutLoc(enumType));
-  selfParam->setType(enumType);
+  selfParam->setType(nominalType);
+  selfParam = new (C) TypedPattern(selfParam,
+                                   TypeLoc::withoutLoc(nominalType));
+  selfParam->setType(nominalType);
   Pattern *methodParam = TuplePattern::create(C, SourceLoc(),{},SourceLoc());
   methodParam->setType(TupleType::getEmpty(tc.Context));
   Pattern *params[] = {selfParam, methodParam};
@@ -415,7 +575,7 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
                        nullptr, Type(), params, TypeLoc::withoutLoc(intType),
                        parentDC);
   getterDecl->setImplicit();
-  getterDecl->setBodySynthesizer(deriveBodyHashable_enum_hashValue);
+  getterDecl->setBodySynthesizer(synthesizer);
 
   // Compute the type of hashValue().
   GenericParamList *genericParams = getterDecl->getGenericParamsOfContext();
@@ -439,9 +599,9 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
     interfaceType = FunctionType::get(selfType, methodType);
   
   getterDecl->setInterfaceType(interfaceType);
-  getterDecl->setAccessibility(enumDecl->getFormalAccess());
+  getterDecl->setAccessibility(typeDecl->getFormalAccess());
 
-  if (enumDecl->hasClangNode())
+  if (typeDecl->hasClangNode())
     tc.implicitlyDefinedFunctions.push_back(getterDecl);
   
   // Create the property.
@@ -452,7 +612,7 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
   hashValueDecl->setImplicit();
   hashValueDecl->makeComputed(SourceLoc(), getterDecl,
                               nullptr, nullptr, SourceLoc());
-  hashValueDecl->setAccessibility(enumDecl->getFormalAccess());
+  hashValueDecl->setAccessibility(typeDecl->getFormalAccess());
 
   Pattern *hashValuePat = new (C) NamedPattern(hashValueDecl, /*implicit*/true);
   hashValuePat->setType(intType);
@@ -479,15 +639,24 @@ ValueDecl *DerivedConformance::deriveHashable(TypeChecker &tc,
                                               NominalTypeDecl *type,
                                               ValueDecl *requirement) {
   // Check that we can actually derive Hashable for this type.
-  if (!canDeriveConformance(type))
+  auto hashableProto = tc.Context.getProtocol(KnownProtocolKind::Hashable);
+  if (!canDeriveConformance(tc, type, hashableProto))
     return nullptr;
   
   // Build the necessary decl.
   if (requirement->getName().str() == "hashValue") {
-    if (auto theEnum = dyn_cast<EnumDecl>(type))
-      return deriveHashable_enum_hashValue(tc, parentDecl, theEnum);
-    else
-      llvm_unreachable("todo");
+    if (isa<EnumDecl>(type))
+      return deriveHashable_hashValue(tc, parentDecl, type,
+                                      &deriveBodyHashable_enum_hashValue);
+    if (isa<StructDecl>(type)) {
+      if (!tc.Context.getCombineHashValuesDecl(&tc)) {
+        tc.diagnose(type->getLoc(), diag::no_combine_hash_values_for_hashable);
+        return nullptr;
+      }
+      return deriveHashable_hashValue(tc, parentDecl, type,
+                                      &deriveBodyHashable_struct_hashValue);
+    }
+    llvm_unreachable("todo");
   }
   tc.diagnose(requirement->getLoc(),
               diag::broken_hashable_requirement);
@@ -22,6 +22,9 @@
 #include "swift/AST/Expr.h"
 #include "swift/AST/Pattern.h"
 #include "swift/AST/Types.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallString.h"
 #include "DerivedConformances.h"
 
 using namespace swift;
@@ -156,6 +159,155 @@ static VarDecl *deriveRawRepresentable_raw(TypeChecker &tc,
   return propDecl;
 }
 
+/// Enums with String raw values and fewer cases than this compare the raw
+/// value against each case directly.
+static const unsigned MinCasesForASCIICountDispatch = 8;
+
+/// Create a 'default: return nil' case.
+static CaseStmt *createFailCase(ASTContext &C) {
+  auto anyPat = new (C) AnyPattern(SourceLoc());
+  anyPat->setImplicit();
+  auto dfltLabelItem =
+    CaseLabelItem(/*IsDefault=*/true, anyPat, SourceLoc(), nullptr);
+
+  auto dfltReturnStmt = new (C) FailStmt(SourceLoc(), SourceLoc());
+  auto dfltBody = BraceStmt::create(C, SourceLoc(),
+                                    ASTNode(dfltReturnStmt), SourceLoc());
+  return CaseStmt::create(C, SourceLoc(), dfltLabelItem,
+                          /*HasBoundDecls=*/false, SourceLoc(), dfltBody);
+}
+
+/// Create a switch over \p rawDecl which assigns the element of \p elts with
+/// the matching raw value to self, or fails.
+static SwitchStmt *createRawValueSwitch(ASTContext &C, Type enumType,
+                                        VarDecl *selfDecl, VarDecl *rawDecl,
+                                        ArrayRef<EnumElementDecl *> elts) {
+  SmallVector<CaseStmt*, 4> cases;
+  for (auto elt : elts) {
+    auto litExpr = cloneRawLiteralExpr(C, elt->getRawValueExpr());
+    auto litPat = new (C) ExprPattern(litExpr, /*isResolved*/ true,
+                                      nullptr, nullptr);
+    litPat->setImplicit();
+
+    auto labelItem =
+      CaseLabelItem(/*IsDefault=*/false, litPat, SourceLoc(), nullptr);
+
+    auto eltRef = new (C) DeclRefExpr(elt, SourceLoc(), /*implicit*/true);
+    auto metaTyRef = TypeExpr::createImplicit(enumType, C);
+    auto valueExpr = new (C) DotSyntaxCallExpr(eltRef, SourceLoc(), metaTyRef);
+    
+    auto selfRef = new (C) DeclRefExpr(selfDecl, SourceLoc(), /*implicit*/true,
+                                       AccessSemantics::DirectToStorage);
+
+    auto assignment = new (C) AssignExpr(selfRef, SourceLoc(), valueExpr,
+                                         /*implicit*/ true);
+    
+    auto body = BraceStmt::create(C, SourceLoc(),
+                                  ASTNode(assignment), SourceLoc());
+
+    cases.push_back(CaseStmt::create(C, SourceLoc(), labelItem,
+                                     /*HasBoundDecls=*/false, SourceLoc(),
+                                     body));
+  }
+
+  cases.push_back(createFailCase(C));
+
+  auto rawRef = new (C) DeclRefExpr(rawDecl, SourceLoc(), /*implicit*/true);
+  return SwitchStmt::create(LabeledStmtInfo(), SourceLoc(), rawRef,
+                            SourceLoc(), cases, SourceLoc(), C);
+}
+
+/// Returns the UTF-8 length of the raw value of \p elt if it is an ASCII
+/// string literal.
+static Optional<unsigned> getASCIIRawValueLength(EnumElementDecl *elt) {
+  auto stringLit = dyn_cast<StringLiteralExpr>(elt->getRawValueExpr());
+  if (!stringLit)
+    return None;
+  StringRef value = stringLit->getValue();
+  for (unsigned char c : value)
+    if (c >= 0x80)
+      return None;
+  return value.size();
+}
+
+/// Create a switch over \p rawDecl which first dispatches on the ASCII count
+/// of the raw value, so that only the cases with raw values of that length
+/// are compared against. Returns null if the enum does not qualify.
+///
+/// Two strings which are both ASCII are only equal if they have the same
+/// length. Strings which are not known to be ASCII may still be canonically
+/// equivalent to an ASCII raw value, so they are compared against every case.
+static SwitchStmt *createASCIICountSwitch(ASTContext &C, EnumDecl *enumDecl,
+                                          Type enumType, Type rawTy,
+                                          VarDecl *selfDecl,
+                                          VarDecl *rawDecl) {
+  if (!rawTy->isEqual(C.getStringDecl()->getDeclaredType()))
+    return nullptr;
+
+  auto countFunc = C.getStringContiguousASCIICount(nullptr);
+  if (!countFunc)
+    return nullptr;
+
+  SmallVector<EnumElementDecl *, 16> allElts;
+  llvm::MapVector<unsigned, SmallVector<EnumElementDecl *, 4>> eltsByLength;
+  for (auto elt : enumDecl->getAllElements()) {
+    auto length = getASCIIRawValueLength(elt);
+    if (!length)
+      return nullptr;
+    allElts.push_back(elt);
+    eltsByLength[*length].push_back(elt);
+  }
+  if (allElts.size() < MinCasesForASCIICountDispatch)
+    return nullptr;
+
+  SmallVector<CaseStmt*, 8> cases;
+  auto addCase = [&](Expr *countExpr, ArrayRef<EnumElementDecl *> elts) {
+    countExpr->setImplicit();
+    auto countPat = new (C) ExprPattern(countExpr, /*isResolved*/ true,
+                                        nullptr, nullptr);
+    countPat->setImplicit();
+    auto labelItem =
+      CaseLabelItem(/*IsDefault=*/false, countPat, SourceLoc(), nullptr);
+    auto innerSwitch = createRawValueSwitch(C, enumType, selfDecl, rawDecl,
+                                            elts);
+    auto body = BraceStmt::create(C, SourceLoc(), ASTNode(innerSwitch),
+                                  SourceLoc());
+    cases.push_back(CaseStmt::create(C, SourceLoc(), labelItem,
+                                     /*HasBoundDecls=*/false, SourceLoc(),
+                                     body));
+  };
+
+  // generate: case <length>: switch rawValue { <cases of that length> }
+  for (auto &entry : eltsByLength) {
+    llvm::SmallString<8> lengthVal;
+    APInt(32, entry.first).toString(lengthVal, 10, /*signed*/ false);
+    auto lengthStr = C.AllocateCopy(lengthVal);
+    addCase(new (C) IntegerLiteralExpr(StringRef(lengthStr.data(),
+                                                 lengthStr.size()),
+                                       SourceLoc(), /*implicit*/ true),
+            entry.second);
+  }
+
+  // generate: case -1: switch rawValue { <all cases> }
+  auto unknownExpr = new (C) IntegerLiteralExpr("1", SourceLoc(),
+                                                /*implicit*/ true);
+  unknownExpr->setNegative(SourceLoc());
+  addCase(unknownExpr, allElts);
+
+  cases.push_back(createFailCase(C));
+
+  // generate: switch _stringContiguousASCIICount(rawValue) { }
+  auto countRef = new (C) DeclRefExpr(countFunc, SourceLoc(),
+                                      /*implicit*/ true);
+  auto rawRef = new (C) DeclRefExpr(rawDecl, SourceLoc(), /*implicit*/true);
+  auto countArg = new (C) ParenExpr(SourceLoc(), rawRef, SourceLoc(),
+                                    /*hasTrailingClosure*/ false);
+  countArg->setImplicit();
+  auto countCall = new (C) CallExpr(countRef, countArg, /*Implicit*/ true);
+  return SwitchStmt::create(LabeledStmtInfo(), SourceLoc(), countCall,
+                            SourceLoc(), cases, SourceLoc(), C);
+}
+
 static void
 deriveBodyRawRepresentable_init(AbstractFunctionDecl *initDecl) {
   // enum SomeEnum : SomeType {
@@ -172,6 +324,33 @@ deriveBodyRawRepresentable_init(AbstractFunctionDecl *initDecl) {
   //     }
   //   }
   // }
+  //
+  // Enums with many ASCII String raw values dispatch on the length first:
+  //
+  // enum SomeEnum : String {
+  //   case A = "a", B = "b", CC = "cc", ...
+  //   @derived
+  //   init?(rawValue: String) {
+  //     switch _stringContiguousASCIICount(rawValue) {
+  //     case 1:
+  //       switch rawValue {
+  //       case "a": self = .A
+  //       case "b": self = .B
+  //       default: return nil
+  //       }
+  //     case 2:
+  //       switch rawValue {
+  //       case "cc": self = .CC
+  //       default: return nil
+  //       }
+  //     ...
+  //     case -1:
+  //       switch rawValue { <every case> }
+  //     default:
+  //       return nil
+  //     }
+  //   }
+  // }
   
   auto parentDC = initDecl->getDeclContext();
   ASTContext &C = parentDC->getASTContext();
@@ -193,53 +372,18 @@ deriveBodyRawRepresentable_init(AbstractFunctionDecl *initDecl) {
   Type enumType = parentDC->getDeclaredTypeInContext();
 
   auto selfDecl = cast<ConstructorDecl>(initDecl)->getImplicitSelfDecl();
-  
-  SmallVector<CaseStmt*, 4> cases;
-  for (auto elt : enumDecl->getAllElements()) {
-    auto litExpr = cloneRawLiteralExpr(C, elt->getRawValueExpr());
-    auto litPat = new (C) ExprPattern(litExpr, /*isResolved*/ true,
-                                      nullptr, nullptr);
-    litPat->setImplicit();
-
-    auto labelItem =
-      CaseLabelItem(/*IsDefault=*/false, litPat, SourceLoc(), nullptr);
-
-    auto eltRef = new (C) DeclRefExpr(elt, SourceLoc(), /*implicit*/true);
-    auto metaTyRef = TypeExpr::createImplicit(enumType, C);
-    auto valueExpr = new (C) DotSyntaxCallExpr(eltRef, SourceLoc(), metaTyRef);
-    
-    auto selfRef = new (C) DeclRefExpr(selfDecl, SourceLoc(), /*implicit*/true,
-                                       AccessSemantics::DirectToStorage);
-
-    auto assignment = new (C) AssignExpr(selfRef, SourceLoc(), valueExpr,
-                                         /*implicit*/ true);
-    
-    auto body = BraceStmt::create(C, SourceLoc(),
-                                  ASTNode(assignment), SourceLoc());
-
-    cases.push_back(CaseStmt::create(C, SourceLoc(), labelItem,
-                                     /*HasBoundDecls=*/false, SourceLoc(),
-                                     body));
-  }
-
-  auto anyPat = new (C) AnyPattern(SourceLoc());
-  anyPat->setImplicit();
-  auto dfltLabelItem =
-    CaseLabelItem(/*IsDefault=*/true, anyPat, SourceLoc(), nullptr);
-
-  auto dfltReturnStmt = new (C) FailStmt(SourceLoc(), SourceLoc());
-  auto dfltBody = BraceStmt::create(C, SourceLoc(),
-                                    ASTNode(dfltReturnStmt), SourceLoc());
-  cases.push_back(CaseStmt::create(C, SourceLoc(), dfltLabelItem,
-                                   /*HasBoundDecls=*/false, SourceLoc(),
-                                   dfltBody));
 
   Pattern *args = initDecl->getBodyParamPatterns().back();
   auto rawArgPattern = cast<NamedPattern>(args->getSemanticsProvidingPattern());
   auto rawDecl = rawArgPattern->getDecl();
-  auto rawRef = new (C) DeclRefExpr(rawDecl, SourceLoc(), /*implicit*/true);
-  auto switchStmt = SwitchStmt::create(LabeledStmtInfo(), SourceLoc(), rawRef,
-                                       SourceLoc(), cases, SourceLoc(), C);
+
+  SwitchStmt *switchStmt = createASCIICountSwitch(C, enumDecl, enumType, rawTy,
+                                                  selfDecl, rawDecl);
+  if (!switchStmt) {
+    SmallVector<EnumElementDecl *, 8> elts(enumDecl->getAllElements().begin(),
+                                           enumDecl->getAllElements().end());
+    switchStmt = createRawValueSwitch(C, enumType, selfDecl, rawDecl, elts);
+  }
   auto body = BraceStmt::create(C, SourceLoc(),
                                 ASTNode(switchStmt),
                                 SourceLoc());
@@ -61,6 +61,11 @@ private:
   DeclContext *TypeCheckDC;
   unsigned TmpNameIndex = 0;
   bool HighPerformance;
+  bool BatchedLogging;
+
+  /// The identifier of the next value-logging site in the file, when
+  /// logging is batched.
+  unsigned &NextSiteID;
 
   struct BracePair {
   public:
@@ -171,8 +176,9 @@ private:
 
 public:
   Instrumenter (ASTContext &C, DeclContext *DC, std::mt19937_64 &RNG,
-                bool HP) :
-    RNG(RNG), Context(C), TypeCheckDC(DC), HighPerformance(HP), CF(*this) { }
+                bool HP, bool BL, unsigned &NextSiteID) :
+    RNG(RNG), Context(C), TypeCheckDC(DC), HighPerformance(HP),
+    BatchedLogging(BL), NextSiteID(NextSiteID), CF(*this) { }
     
   Stmt *transformStmt(Stmt *S) { 
     switch (S->getKind()) {
@@ -930,6 +936,9 @@ public:
                                                      SourceRange());
     NameExpr->setImplicit(true);
 
+    if (BatchedLogging)
+      return buildBatchedLoggerCall(E, NameExpr, SR);
+
     const size_t buf_size = 11;
     char * const id_buf = (char*)Context.Allocate(buf_size, 1);
     std::uniform_int_distribution<unsigned int> Distribution(0, 0x7fffffffu);
@@ -949,6 +958,59 @@ public:
                                    SR);
   }
 
+  // Logs the value through a single call to the batched logging entry
+  // point, without a log record.  Each site gets a small, dense identifier
+  // so that the runtime can keep per-site state, such as how many values
+  // it has sampled, in a flat table.
+  Added<Stmt *> buildBatchedLoggerCall(Added<Expr *> E, Expr *NameExpr,
+                                       SourceRange SR) {
+    const size_t buf_size = 11;
+    char * const id_buf = (char*)Context.Allocate(buf_size, 1);
+    ::snprintf(id_buf, buf_size, "%u", NextSiteID);
+    NextSiteID++;
+    Expr *SiteIDExpr = new (Context) IntegerLiteralExpr(id_buf,
+                                                        SourceLoc(), true);
+
+    Expr *StartLine, *EndLine, *StartColumn, *EndColumn;
+    buildLocationExprs(SR, StartLine, EndLine, StartColumn, EndColumn);
+
+    Expr *LoggerArgExprs[] = {
+        *E,
+        NameExpr,
+        SiteIDExpr,
+        StartLine,
+        EndLine,
+        StartColumn,
+        EndColumn
+      };
+
+    UnresolvedDeclRefExpr *LoggerRef =
+      new (Context) UnresolvedDeclRefExpr(
+        Context.getIdentifier("$builtin_log_batched"),
+        DeclRefKind::Ordinary,
+        SR.End);
+
+    LoggerRef->setImplicit(true);
+
+    Expr *LoggerCall = new (Context) CallExpr(
+        LoggerRef, TupleExpr::createImplicit(Context, LoggerArgExprs, { }),
+        true, Type());
+    Added<Expr *> AddedLogger(LoggerCall);
+
+    if (!doTypeCheck(Context, TypeCheckDC, AddedLogger)) {
+      return nullptr;
+    }
+
+    ASTNode Elements[] = {
+      *AddedLogger
+    };
+
+    BraceStmt *BS = BraceStmt::create(Context, SourceLoc(), Elements,
+                                      SourceLoc(), true);
+
+    return BS;
+  }
+
   Added<Stmt *> buildScopeEntry(SourceRange SR) {
     return buildScopeCall(SR, false);
   }
@@ -999,9 +1061,8 @@ public:
     return buildLoggerCallWithApply(AddedLogger, SR);
   }
 
-  // Assumes Apply has already been type-checked.
-  Added<Stmt *> buildLoggerCallWithApply(Added<ApplyExpr*> Apply,
-                                         SourceRange SR) {
+  void buildLocationExprs(SourceRange SR, Expr *&StartLine, Expr *&EndLine,
+                          Expr *&StartColumn, Expr *&EndColumn) {
     std::pair<unsigned, unsigned> StartLC =
       Context.SourceMgr.getLineAndColumn(SR.Start);
 
@@ -1021,14 +1082,21 @@ public:
     ::snprintf(end_line_buf, buf_size, "%d", EndLC.first);
     ::snprintf(end_column_buf, buf_size, "%d", EndLC.second);
 
-    Expr *StartLine = new (Context) IntegerLiteralExpr(start_line_buf, 
-                                                       SR.End, true);
-    Expr *EndLine = new (Context) IntegerLiteralExpr(end_line_buf,
-                                                     SR.End, true);
-    Expr *StartColumn = new (Context) IntegerLiteralExpr(start_column_buf, 
-                                                         SR.End, true);
-    Expr *EndColumn = new (Context) IntegerLiteralExpr(end_column_buf, 
-                                                       SR.End, true);
+    StartLine = new (Context) IntegerLiteralExpr(start_line_buf,
+                                                 SR.End, true);
+    EndLine = new (Context) IntegerLiteralExpr(end_line_buf,
+                                               SR.End, true);
+    StartColumn = new (Context) IntegerLiteralExpr(start_column_buf,
+                                                   SR.End, true);
+    EndColumn = new (Context) IntegerLiteralExpr(end_column_buf,
+                                                 SR.End, true);
+  }
+
+  // Assumes Apply has already been type-checked.
+  Added<Stmt *> buildLoggerCallWithApply(Added<ApplyExpr*> Apply,
+                                         SourceRange SR) {
+    Expr *StartLine, *EndLine, *StartColumn, *EndColumn;
+    buildLocationExprs(SR, StartLine, EndLine, StartColumn, EndColumn);
 
     std::pair<PatternBindingDecl *, VarDecl *> PV =
       buildPatternAndVariable(*Apply);
@@ -1082,20 +1150,25 @@ public:
 } // end anonymous namespace
 
 void swift::performPlaygroundTransform(SourceFile &SF,
-                                       bool HighPerformance) {
+                                       bool HighPerformance,
+                                       bool BatchedLogging) {
   class ExpressionFinder : public ASTWalker {
   private:
     std::mt19937_64 RNG;
     bool HighPerformance;
+    bool BatchedLogging;
+    unsigned NextSiteID = 0;
   public:
-    ExpressionFinder(bool HP) : HighPerformance(HP) { }
+    ExpressionFinder(bool HP, bool BL)
+      : HighPerformance(HP), BatchedLogging(BL) { }
 
     virtual bool walkToDeclPre(Decl *D) {
       if (AbstractFunctionDecl *FD = dyn_cast<AbstractFunctionDecl>(D)) {
         if (!FD->isImplicit()) {
           if (BraceStmt *Body = FD->getBody()) {
             ASTContext &ctx = FD->getASTContext();
-            Instrumenter I(ctx, FD, RNG, HighPerformance);
+            Instrumenter I(ctx, FD, RNG, HighPerformance, BatchedLogging,
+                           NextSiteID);
             BraceStmt *NewBody = I.transformBraceStmt(Body);
             if (NewBody != Body) {
               FD->setBody(NewBody);
@@ -1108,7 +1181,8 @@ void swift::performPlaygroundTransform(SourceFile &SF,
         if (!TLCD->isImplicit()) {
           if (BraceStmt *Body = TLCD->getBody()) {
             ASTContext &ctx = static_cast<Decl*>(TLCD)->getASTContext();
-            Instrumenter I(ctx, TLCD, RNG, HighPerformance);
+            Instrumenter I(ctx, TLCD, RNG, HighPerformance, BatchedLogging,
+                           NextSiteID);
             BraceStmt *NewBody = I.transformBraceStmt(Body, true);
             if (NewBody != Body) {
               TLCD->setBody(NewBody);
@@ -1122,7 +1196,7 @@ void swift::performPlaygroundTransform(SourceFile &SF,
     }
   };
 
-  ExpressionFinder EF(HighPerformance);
+  ExpressionFinder EF(HighPerformance, BatchedLogging);
   for (Decl* D : SF.Decls) {
     D->walk(EF);
   }
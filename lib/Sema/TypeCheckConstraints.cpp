@@ -24,6 +24,7 @@
 #include "swift/AST/Attr.h"
 #include "swift/AST/NameLookup.h"
 #include "swift/AST/PrettyStackTrace.h"
+#include "swift/AST/TypeCheckTimingReport.h"
 #include "swift/AST/TypeCheckerDebugConsumer.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Parse/Lexer.h"
@@ -37,6 +38,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 #include <iterator>
 #include <map>
 #include <memory>
@@ -1122,6 +1124,41 @@ namespace {
 
 
 
+namespace {
+  /// Times a top-level call to typeCheckExpression for the type-check
+  /// report. Nested calls, e.g. the ones made while diagnosing a failure,
+  /// are counted as part of the outermost expression.
+  class ExpressionTimer {
+    TypeChecker &TC;
+    SourceLoc Loc;
+    llvm::SaveAndRestore<bool> Timing;
+    unsigned StartStatesExplored = TC.NumSolverStatesExplored;
+    unsigned StartDisjunctions = TC.NumSolverDisjunctions;
+    uint64_t StartSolverBytesFreed = TC.NumSolverBytesFreed;
+    llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime();
+
+  public:
+    ExpressionTimer(TypeChecker &TC, Expr *E)
+      : TC(TC), Loc(E->getLoc()), Timing(TC.TimingExpression, true) {}
+
+    ~ExpressionTimer() {
+      llvm::TimeRecord endTime = llvm::TimeRecord::getCurrentTime(false);
+
+      TypeCheckTimingReport::Entry entry;
+      entry.Kind = TypeCheckTimingReport::EntryKind::Expression;
+      entry.Loc = Loc;
+      entry.Milliseconds
+        = (endTime.getProcessTime() - StartTime.getProcessTime()) * 1000;
+      entry.NumStatesExplored
+        = TC.NumSolverStatesExplored - StartStatesExplored;
+      entry.NumDisjunctions = TC.NumSolverDisjunctions - StartDisjunctions;
+      entry.NumSolverBytesFreed
+        = TC.NumSolverBytesFreed - StartSolverBytesFreed;
+      TC.Context.TypeCheckTimings->record(std::move(entry));
+    }
+  };
+}
+
 #pragma mark High-level entry points
 bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
                                       Type convertType,
@@ -1130,6 +1167,10 @@ bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
                                       ExprTypeCheckListener *listener) {
   PrettyStackTraceExpr stackTrace(Context, "type-checking", expr);
 
+  Optional<ExpressionTimer> timer;
+  if (Context.TypeCheckTimings && !TimingExpression)
+    timer.emplace(*this, expr);
+
   // Construct a constraint system from this expression.
   ConstraintSystem cs(*this, dc, ConstraintSystemFlags::AllowFixes);
   CleanupIllFormedExpressionRAII cleanup(Context, expr);
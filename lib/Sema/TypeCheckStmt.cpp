@@ -24,6 +24,8 @@
 #include "swift/AST/Identifier.h"
 #include "swift/AST/NameLookup.h"
 #include "swift/AST/PrettyStackTrace.h"
+#include "swift/AST/TypeCheckTimingReport.h"
+#include "swift/Basic/CompileTimeTrace.h"
 #include "swift/Basic/Range.h"
 #include "swift/Basic/STLExtras.h"
 #include "swift/Basic/SourceManager.h"
@@ -126,16 +128,51 @@ namespace {
   };
 
   class FunctionBodyTimer {
+    TypeChecker &TC;
     PointerUnion<const AbstractFunctionDecl *,
                  const AbstractClosureExpr *> Function;
+    bool DumpToStderr;
+    unsigned StartStatesExplored = TC.NumSolverStatesExplored;
+    unsigned StartDisjunctions = TC.NumSolverDisjunctions;
+    uint64_t StartSolverBytesFreed = TC.NumSolverBytesFreed;
     llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime();
 
+    void record(double elapsed) {
+      auto *report = TC.Context.TypeCheckTimings.get();
+      if (!report)
+        return;
+
+      TypeCheckTimingReport::Entry entry;
+      entry.Milliseconds = elapsed * 1000;
+      entry.NumStatesExplored
+        = TC.NumSolverStatesExplored - StartStatesExplored;
+      entry.NumDisjunctions = TC.NumSolverDisjunctions - StartDisjunctions;
+      entry.NumSolverBytesFreed
+        = TC.NumSolverBytesFreed - StartSolverBytesFreed;
+      if (auto *AFD = Function.dyn_cast<const AbstractFunctionDecl *>()) {
+        entry.Kind = TypeCheckTimingReport::EntryKind::FunctionBody;
+        entry.Loc = AFD->getLoc();
+        llvm::raw_string_ostream nameOS(entry.Name);
+        nameOS << AFD->getFullName();
+      } else {
+        entry.Kind = TypeCheckTimingReport::EntryKind::ClosureBody;
+        entry.Loc = Function.get<const AbstractClosureExpr *>()->getLoc();
+      }
+      report->record(std::move(entry));
+    }
+
   public:
-    FunctionBodyTimer(decltype(Function) Fn) : Function(Fn) {}
+    FunctionBodyTimer(TypeChecker &TC, decltype(Function) Fn,
+                      bool dumpToStderr)
+      : TC(TC), Function(Fn), DumpToStderr(dumpToStderr) {}
     ~FunctionBodyTimer() {
       llvm::TimeRecord endTime = llvm::TimeRecord::getCurrentTime(false);
 
       auto elapsed = endTime.getProcessTime() - StartTime.getProcessTime();
+      record(elapsed);
+      if (!DumpToStderr)
+        return;
+
       llvm::errs() << llvm::format("%0.1f", elapsed * 1000) << "ms\t";
 
       if (auto *AFD = Function.dyn_cast<const AbstractFunctionDecl *>()) {
@@ -1206,8 +1243,15 @@ bool TypeChecker::typeCheckAbstractFunctionBody(AbstractFunctionDecl *AFD) {
     return false;
 
   Optional<FunctionBodyTimer> timer;
-  if (DebugTimeFunctionBodies)
-    timer.emplace(AFD);
+  if (DebugTimeFunctionBodies || Context.TypeCheckTimings)
+    timer.emplace(*this, AFD, DebugTimeFunctionBodies);
+
+  CompileTimeTraceScope traceScope("typecheck-body", [&]() -> std::string {
+    std::string name;
+    llvm::raw_string_ostream nameOS(name);
+    nameOS << AFD->getFullName();
+    return nameOS.str();
+  });
 
   if (typeCheckAbstractFunctionBodyUntil(AFD, SourceLoc()))
     return true;
@@ -1450,8 +1494,8 @@ void TypeChecker::typeCheckClosureBody(ClosureExpr *closure) {
   BraceStmt *body = closure->getBody();
 
   Optional<FunctionBodyTimer> timer;
-  if (DebugTimeFunctionBodies)
-    timer.emplace(closure);
+  if (DebugTimeFunctionBodies || Context.TypeCheckTimings)
+    timer.emplace(*this, closure, DebugTimeFunctionBodies);
 
   StmtChecker(*this, closure).typeCheckBody(body);
   if (body) {
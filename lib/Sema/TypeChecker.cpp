@@ -359,7 +359,8 @@ static void bindExtensionDecl(ExtensionDecl *ED, TypeChecker &TC) {
   extendedNominal->addExtension(ED);
 }
 
-static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
+static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC,
+                                               bool validateTypesForSIL) {
   unsigned currentFunctionIdx = 0;
   unsigned currentExternalDef = TC.Context.LastCheckedExternalDefinition;
   do {
@@ -368,6 +369,9 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
     // work correctly.
     for (unsigned n = TC.definedFunctions.size(); currentFunctionIdx != n;
          ++currentFunctionIdx) {
+      if (TC.Context.isCancellationRequested())
+        return;
+
       auto *AFD = TC.definedFunctions[currentFunctionIdx];
 
       // HACK: don't type-check the same function body twice.  This is
@@ -403,7 +407,8 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
     // Validate the contents of any referenced nominal types for SIL's purposes.
     // Note: if we ever start putting extension members in vtables, we'll need
     // to validate those members too.
-    // FIXME: If we're not planning to run SILGen, this is wasted effort.
+    if (!validateTypesForSIL)
+      TC.ValidatedTypes.clear();
     while (!TC.ValidatedTypes.empty()) {
       auto nominal = TC.ValidatedTypes.pop_back_val();
       if (nominal->isInvalid() || TC.Context.hadError())
@@ -500,7 +505,7 @@ void swift::typeCheckExternalDefinitions(SourceFile &SF) {
   assert(SF.ASTStage == SourceFile::TypeChecked);
   auto &Ctx = SF.getASTContext();
   TypeChecker TC(Ctx);
-  typeCheckFunctionsAndExternalDecls(TC);
+  typeCheckFunctionsAndExternalDecls(TC, /*validateTypesForSIL=*/true);
 }
 
 void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
@@ -598,9 +603,15 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
     if (SF.Kind == SourceFileKind::REPL && !TC.Context.hadError())
       TC.processREPLTopLevel(SF, TLC, StartElem);
 
-    typeCheckFunctionsAndExternalDecls(TC);
+    typeCheckFunctionsAndExternalDecls(
+        TC, !Options.contains(TypeCheckingFlags::NoSILGeneration));
   }
 
+  // Some function bodies were left unchecked; the AST is going to be thrown
+  // away, so don't bother with the rest.
+  if (Ctx.isCancellationRequested())
+    return;
+
   // Checking that benefits from having the whole module available.
   if (!(Options & TypeCheckingFlags::DelayWholeModuleChecking)) {
     performWholeModuleTypeChecking(SF);
@@ -1430,12 +1441,21 @@ TypeChecker::overApproximateOSVersionsAtLocation(SourceLoc loc,
   return OverApproximateVersionRange;
 }
 
+VersionRange TypeChecker::getAvailableRange(const Decl *D) {
+  auto known = AvailableRangeCache.find(D);
+  if (known != AvailableRangeCache.end())
+    return known->second;
+
+  VersionRange range = AvailabilityInference::availableRange(D, Context);
+  AvailableRangeCache.insert({D, range});
+  return range;
+}
+
 bool TypeChecker::isDeclAvailable(const Decl *D, SourceLoc referenceLoc,
                                   const DeclContext *referenceDC,
                                   VersionRange &OutAvailableRange) {
 
-  VersionRange safeRangeUnderApprox =
-      AvailabilityInference::availableRange(D, Context);
+  VersionRange safeRangeUnderApprox = getAvailableRange(D);
   VersionRange runningOSOverApprox = overApproximateOSVersionsAtLocation(
       referenceLoc, referenceDC);
   
@@ -460,6 +460,10 @@ public:
   /// This can't use CanTypes because typealiases may have more limited types
   /// than their underlying types.
   llvm::DenseMap<Type, Accessibility> TypeAccessibilityCache;
+
+  /// Caches the range of versions on which a declaration is available, which
+  /// is queried for every reference to the declaration.
+  llvm::DenseMap<const Decl *, VersionRange> AvailableRangeCache;
   
   // We delay validation of C and Objective-C type-bridging functions in the
   // standard library until we encounter a declaration that requires one. This
@@ -560,6 +564,15 @@ private:
   Expr* constructCallToSuperInit(ConstructorDecl *ctor,  ClassDecl *ClDecl);
 
 public:
+  /// The constraint solver work done by this type checker so far, summed
+  /// over all of its constraint systems.
+  unsigned NumSolverStatesExplored = 0;
+  unsigned NumSolverDisjunctions = 0;
+  uint64_t NumSolverBytesFreed = 0;
+
+  /// Whether a top-level expression is being timed for the type-check report.
+  bool TimingExpression = false;
+
   TypeChecker(ASTContext &Ctx) : TypeChecker(Ctx, Ctx.Diags) { }
   TypeChecker(ASTContext &Ctx, DiagnosticEngine &Diags);
   ~TypeChecker();
@@ -1637,6 +1650,10 @@ public:
                        const DeclContext *referenceDC,
                        VersionRange &OutAvailableRange);
 
+  /// Returns the range of versions on which the declaration is available,
+  /// as computed by AvailabilityInference::availableRange.
+  VersionRange getAvailableRange(const Decl *D);
+
   /// Checks whether a declaration should be considered unavailable when
   /// referred to at the given location and, if so, returns the reason why the
   /// declaration is unavailable. Returns None is the declaration is
@@ -1124,6 +1124,24 @@ Decl *ModuleFile::resolveCrossReference(Module *M, uint32_t pathLen) {
         return nullptr;
       }
 
+      // Nested types are indexed by name, so they can usually be found
+      // without loading the members and extensions of the enclosing type.
+      if (isType) {
+        for (auto file : M->getFiles()) {
+          auto nestedType = file->lookupNestedType(memberName, nominal);
+          if (!nestedType)
+            continue;
+          if (onlyInNominal && nestedType->getDeclContext() != nominal)
+            continue;
+          values.push_back(nestedType);
+          break;
+        }
+        filterValues(filterTy, M, genericSig, isType, inProtocolExt, ctorInit,
+                     values);
+        if (!values.empty())
+          break;
+      }
+
       auto members = nominal->lookupDirect(memberName, onlyInNominal);
       values.append(members.begin(), members.end());
       filterValues(filterTy, M, genericSig, isType, inProtocolExt, ctorInit,
@@ -2172,6 +2190,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theStruct, rawInheritedIDs);
 
     theStruct->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    MemberContextIDs[theStruct] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theStruct->setConformanceLoader(
       this,
@@ -2623,6 +2642,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     proto->computeType();
 
     proto->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    MemberContextIDs[proto] = DID;
     proto->setCircularityCheck(CircularityCheck::Checked);
     break;
   }
@@ -2759,6 +2779,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theClass, rawInheritedIDs);
 
     theClass->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    MemberContextIDs[theClass] = DID;
     theClass->setHasDestructor();
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theClass->setConformanceLoader(
@@ -2826,6 +2847,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theEnum, rawInheritedIDs);
 
     theEnum->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    MemberContextIDs[theEnum] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theEnum->setConformanceLoader(
       this,
@@ -3025,6 +3047,7 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     }
 
     extension->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    MemberContextIDs[extension] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     extension->setConformanceLoader(
       this,
@@ -3921,6 +3944,28 @@ void ModuleFile::loadAllMembers(Decl *D,
     IDC->addMember(member);
 }
 
+bool ModuleFile::loadNamedMembers(const IterableDeclContext *IDC,
+                                  Identifier name, uint64_t contextData,
+                                  SmallVectorImpl<ValueDecl *> &members) {
+  // A module without any named members has no member table.
+  if (!MembersByName)
+    return false;
+
+  auto contextID = MemberContextIDs.find(IDC);
+  if (contextID == MemberContextIDs.end())
+    return false;
+
+  auto known = MembersByName->find({contextID->second, name.str()});
+  if (known == MembersByName->end())
+    return true;
+
+  for (DeclID memberID : *known) {
+    auto member = cast<ValueDecl>(getDecl(memberID));
+    members.push_back(member);
+  }
+  return true;
+}
+
 void
 ModuleFile::loadAllConformances(const Decl *D, uint64_t contextData,
                          SmallVectorImpl<ProtocolConformance *> &conformances) {
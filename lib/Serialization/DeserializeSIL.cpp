@@ -1771,15 +1771,16 @@ SILFunction *SILDeserializer::lookupSILFunction(SILFunction *InFunc) {
   return Func;
 }
 
-SILFunction *SILDeserializer::lookupSILFunction(StringRef name) {
+SILFunction *SILDeserializer::lookupSILFunction(StringRef name,
+                                                bool declarationOnly) {
   if (!FuncTable)
     return nullptr;
   auto iter = FuncTable->find(name);
   if (iter == FuncTable->end())
     return nullptr;
 
-  auto Func = readSILFunction(*iter, nullptr, name, /*declarationOnly*/ false);
-  if (Func)
+  auto Func = readSILFunction(*iter, nullptr, name, declarationOnly);
+  if (Func && !declarationOnly)
     DEBUG(llvm::dbgs() << "Deserialize SIL:\n";
           Func->dump());
   return Func;
@@ -109,7 +109,8 @@ public:
       return MF->getFile();
     }
     SILFunction *lookupSILFunction(SILFunction *InFunc);
-    SILFunction *lookupSILFunction(StringRef Name);
+    SILFunction *lookupSILFunction(StringRef Name,
+                                   bool declarationOnly = false);
     SILVTable *lookupVTable(Identifier Name);
     SILWitnessTable *lookupWitnessTable(SILWitnessTable *wt);
 
@@ -194,6 +194,13 @@ validateControlBlock(llvm::BitstreamCursor &cursor,
     case control_block::TARGET:
       result.targetTriple = blobData;
       break;
+    case control_block::CONTENT_HASH:
+      if (blobData.size() != control_block::ContentHashSize) {
+        result.status = Status::Malformed;
+        break;
+      }
+      result.contentHash = blobData;
+      break;
     default:
       // Unknown metadata record, possibly for use by a future version of the
       // module format.
@@ -448,6 +455,125 @@ ModuleFile::readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData) {
                                              base + sizeof(uint32_t), base));
 }
 
+/// Used to deserialize entries in the on-disk member table.
+class ModuleFile::MemberNamesTableInfo {
+public:
+  using internal_key_type = std::pair<uint32_t, StringRef>;
+  using external_key_type = internal_key_type;
+  using data_type = SmallVector<DeclID, 4>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type ID) {
+    return ID;
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key.second, key.first);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint32_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    uint32_t contextID = endian::readNext<uint32_t, little, unaligned>(data);
+    length -= sizeof(uint32_t);
+    return { contextID, StringRef(reinterpret_cast<const char *>(data),
+                                  length) };
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    data_type result;
+    while (length > 0) {
+      DeclID memberID = endian::readNext<uint32_t, little, unaligned>(data);
+      result.push_back(memberID);
+      length -= sizeof(uint32_t);
+    }
+
+    return result;
+  }
+};
+
+std::unique_ptr<ModuleFile::SerializedMemberNamesTable>
+ModuleFile::readMemberNamesTable(ArrayRef<uint64_t> fields,
+                                 StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::MemberNamesTableLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedMemberNamesTable>;
+  return OwnedTable(
+           SerializedMemberNamesTable::Create(base + tableOffset,
+                                              base + sizeof(uint32_t), base));
+}
+
+/// Used to deserialize entries in the on-disk nested type table.
+class ModuleFile::NestedTypeDeclsTableInfo {
+public:
+  using internal_key_type = StringRef;
+  using external_key_type = Identifier;
+  using data_type = SmallVector<std::pair<DeclID, DeclID>, 4>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type ID) {
+    return ID.str();
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint32_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    return StringRef(reinterpret_cast<const char *>(data), length);
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    data_type result;
+    while (length > 0) {
+      DeclID parentID = endian::readNext<uint32_t, little, unaligned>(data);
+      DeclID childID = endian::readNext<uint32_t, little, unaligned>(data);
+      result.push_back({ parentID, childID });
+      length -= sizeof(uint32_t) * 2;
+    }
+
+    return result;
+  }
+};
+
+std::unique_ptr<ModuleFile::SerializedNestedTypeDeclsTable>
+ModuleFile::readNestedTypeDeclsTable(ArrayRef<uint64_t> fields,
+                                     StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::NestedTypeDeclsLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedNestedTypeDeclsTable>;
+  return OwnedTable(
+           SerializedNestedTypeDeclsTable::Create(base + tableOffset,
+                                                  base + sizeof(uint32_t),
+                                                  base));
+}
+
 bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
   cursor.EnterSubBlock(INDEX_BLOCK_ID);
 
@@ -524,6 +650,12 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
         assert(blobData.empty());
         NormalConformances.assign(scratch.begin(), scratch.end());
         break;
+      case index_block::MEMBER_NAMES:
+        MembersByName = readMemberNamesTable(scratch, blobData);
+        break;
+      case index_block::NESTED_TYPE_DECLS:
+        NestedTypeDecls = readNestedTypeDeclsTable(scratch, blobData);
+        break;
 
       default:
         // Unknown index kind, which this version of the compiler won't use.
@@ -1154,6 +1286,28 @@ TypeDecl *ModuleFile::lookupLocalType(StringRef MangledName) {
   return cast<TypeDecl>(getDecl((*iter).first));
 }
 
+TypeDecl *ModuleFile::lookupNestedType(Identifier name,
+                                       const NominalTypeDecl *parent) {
+  PrettyModuleFileDeserialization stackEntry(*this);
+
+  if (!NestedTypeDecls)
+    return nullptr;
+
+  auto iter = NestedTypeDecls->find(name);
+  if (iter == NestedTypeDecls->end())
+    return nullptr;
+
+  for (std::pair<DeclID, DeclID> entry : *iter) {
+    // Parents from this module are usually deserialized already, so this
+    // rarely loads anything but the nested type itself.
+    if (getDecl(entry.first) != parent)
+      continue;
+    return cast<TypeDecl>(getDecl(entry.second));
+  }
+
+  return nullptr;
+}
+
 OperatorDecl *ModuleFile::lookupOperator(Identifier name, DeclKind fixity) {
   PrettyModuleFileDeserialization stackEntry(*this);
 
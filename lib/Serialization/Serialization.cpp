@@ -42,11 +42,15 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <functional>
+#include <thread>
 #include <vector>
 
 using namespace swift;
@@ -419,6 +423,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(control_block, METADATA);
   BLOCK_RECORD(control_block, MODULE_NAME);
   BLOCK_RECORD(control_block, TARGET);
+  BLOCK_RECORD(control_block, CONTENT_HASH);
 
   BLOCK(OPTIONS_BLOCK);
   BLOCK_RECORD(options_block, SDK_PATH);
@@ -456,6 +461,8 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(index_block, DECL_CONTEXT_OFFSETS);
   BLOCK_RECORD(index_block, LOCAL_TYPE_DECLS);
   BLOCK_RECORD(index_block, NORMAL_CONFORMANCE_OFFSETS);
+  BLOCK_RECORD(index_block, MEMBER_NAMES);
+  BLOCK_RECORD(index_block, NESTED_TYPE_DECLS);
 
   BLOCK(SIL_BLOCK);
   BLOCK_RECORD(sil_block, SIL_FUNCTION);
@@ -562,6 +569,16 @@ void Serializer::writeHeader(const SerializationOptions &options) {
 
     Target.emit(ScratchRecord, M->getASTContext().LangOpts.Target.str());
 
+    // Reserve space for the content hash, which can only be computed once
+    // the whole module has been written. Blobs are word-aligned and the hash
+    // is a whole number of words, so it ends right where the record does.
+    control_block::ContentHashLayout ContentHash(Out);
+    static const char placeholderHash[control_block::ContentHashSize] = {};
+    ContentHash.emit(ScratchRecord,
+                     StringRef(placeholderHash, sizeof(placeholderHash)));
+    ContentHashOffset = Out.GetCurrentBitNo() / CHAR_BIT
+                          - sizeof(placeholderHash);
+
     {
       llvm::BCBlockRAII restoreBlock(Out, OPTIONS_BLOCK_ID, 3);
 
@@ -1215,10 +1232,12 @@ static bool shouldSerializeMember(Decl *D) {
   }
 }
 
-void Serializer::writeMembers(DeclRange members, bool isClass) {
+void Serializer::writeMembers(const Decl *parent, DeclRange members,
+                              bool isClass) {
   using namespace decls_block;
 
   unsigned abbrCode = DeclTypeAbbrCodes[MembersLayout::Code];
+  DeclID parentID = addDeclRef(parent);
   SmallVector<DeclID, 16> memberIDs;
   for (auto member : members) {
     if (!shouldSerializeMember(member))
@@ -1227,6 +1246,23 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
     DeclID memberID = addDeclRef(member);
     memberIDs.push_back(memberID);
 
+    if (auto VD = dyn_cast<ValueDecl>(member)) {
+      if (VD->hasName())
+        MembersByName[{parentID, VD->getName()}].push_back(memberID);
+    }
+
+    if (auto nestedType = dyn_cast<NominalTypeDecl>(member)) {
+      const NominalTypeDecl *parentType;
+      if (auto ext = dyn_cast<ExtensionDecl>(parent))
+        parentType = ext->getExtendedType()->getAnyNominal();
+      else
+        parentType = dyn_cast<NominalTypeDecl>(parent);
+      if (parentType) {
+        NestedTypeDecls[nestedType->getName()].push_back(
+          { addDeclRef(parentType), memberID });
+      }
+    }
+
     if (isClass) {
       if (auto VD = dyn_cast<ValueDecl>(member)) {
         if (VD->canBeAccessedByDynamicLookup()) {
@@ -1988,7 +2024,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(extension->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(extension->getGenericRequirements());
-    writeMembers(extension->getMembers(), isClassExtension);
+    writeMembers(extension, extension->getMembers(), isClassExtension);
     writeConformances(conformances, DeclTypeAbbrCodes);
 
     break;
@@ -2166,7 +2202,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theStruct->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theStruct->getGenericRequirements());
-    writeMembers(theStruct->getMembers(), false);
+    writeMembers(theStruct, theStruct->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2200,7 +2236,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theEnum->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theEnum->getGenericRequirements());
-    writeMembers(theEnum->getMembers(), false);
+    writeMembers(theEnum, theEnum->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2237,7 +2273,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theClass->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theClass->getGenericRequirements());
-    writeMembers(theClass->getMembers(), true);
+    writeMembers(theClass, theClass->getMembers(), true);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2273,7 +2309,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(proto->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(proto->getGenericRequirements());
-    writeMembers(proto->getMembers(), true);
+    writeMembers(proto, proto->getMembers(), true);
     break;
   }
 
@@ -3289,43 +3325,38 @@ void Serializer::writeOffsets(const index_block::OffsetsLayout &Offsets,
 
 /// Writes an in-memory decl table to an on-disk representation, using the
 /// given layout.
-static void writeDeclTable(const index_block::DeclListLayout &DeclList,
-                           index_block::RecordKind kind,
-                           const Serializer::DeclTable &table) {
-  if (table.empty())
-    return;
-
-  SmallVector<uint64_t, 8> scratch;
-  llvm::SmallString<4096> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::OnDiskChainedHashTableGenerator<DeclTableInfo> generator;
-    for (auto &entry : table)
-      generator.insert(entry.first, entry.second);
+namespace {
+  /// An on-disk hash table that has been built but not emitted yet.
+  struct HashTableBlob {
+    llvm::SmallString<4096> Data;
+    uint32_t TableOffset = 0;
+  };
+} // end anonymous namespace
 
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
-  }
+/// Lay out the buckets of \p generator in \p blob.
+template <typename Info>
+static void
+emitHashTable(llvm::OnDiskChainedHashTableGenerator<Info> &generator,
+              HashTableBlob &blob) {
+  llvm::raw_svector_ostream blobStream(blob.Data);
+  // Make sure that no bucket is at offset 0
+  endian::Writer<little>(blobStream).write<uint32_t>(0);
+  blob.TableOffset = generator.Emit(blobStream);
+}
 
-  DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
+static void buildDeclTable(const Serializer::DeclTable &table,
+                           HashTableBlob &blob) {
+  llvm::OnDiskChainedHashTableGenerator<DeclTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+  emitHashTable(generator, blob);
 }
 
-static void writeLocalDeclTable(const index_block::DeclListLayout &DeclList,
-                                index_block::RecordKind kind,
-                                LocalTypeHashTableGenerator &generator) {
+static void writeDeclTable(const index_block::DeclListLayout &DeclList,
+                           index_block::RecordKind kind,
+                           const HashTableBlob &blob) {
   SmallVector<uint64_t, 8> scratch;
-  llvm::SmallString<4096> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
-  }
-
-  DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
+  DeclList.emit(scratch, kind, blob.TableOffset, blob.Data);
 }
 
 namespace {
@@ -3492,8 +3523,8 @@ namespace {
   };
 } // end anonymous namespace
 
-static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
-                                 Serializer::ObjCMethodTable &objcMethods) {
+static void buildObjCMethodTable(Serializer::ObjCMethodTable &objcMethods,
+                                 HashTableBlob &blob) {
   // Collect all of the Objective-C selectors in the method table.
   std::vector<ObjCSelector> selectors;
   for (const auto &entry : objcMethods) {
@@ -3505,21 +3536,137 @@ static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
 
   // Create the on-disk hash table.
   llvm::OnDiskChainedHashTableGenerator<ObjCMethodTableInfo> generator;
-  llvm::SmallString<32> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    for (auto selector : selectors) {
-      generator.insert(selector, objcMethods[selector]);
+  for (auto selector : selectors) {
+    generator.insert(selector, objcMethods[selector]);
+  }
+  emitHashTable(generator, blob);
+}
+
+namespace {
+  /// Used to serialize the on-disk member hash table.
+  class MemberNamesTableInfo {
+  public:
+    using key_type = std::pair<uint32_t, Identifier>;
+    using key_type_ref = key_type;
+    using data_type = Serializer::MemberNamesTableData;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.second.empty());
+      return llvm::HashString(key.second.str(), key.first);
     }
 
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = sizeof(DeclID) + key.second.str().size();
+      uint32_t dataLength = sizeof(DeclID) * data.size();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint32_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      static_assert(sizeof(DeclID) <= 4, "DeclID too large");
+      endian::Writer<little>(out).write<uint32_t>(key.first);
+      out << key.second.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      endian::Writer<little> writer(out);
+      for (auto memberID : data)
+        writer.write<uint32_t>(memberID);
+    }
+  };
+} // end anonymous namespace
+
+static void buildMemberNamesTable(const Serializer::MemberNamesTable &members,
+                                  HashTableBlob &blob) {
+  // Create the on-disk hash table. The MapVector keeps the order stable.
+  llvm::OnDiskChainedHashTableGenerator<MemberNamesTableInfo> generator;
+  for (auto &entry : members)
+    generator.insert(entry.first, entry.second);
+  emitHashTable(generator, blob);
+}
+
+namespace {
+  /// Used to serialize the on-disk nested type hash table.
+  class NestedTypeDeclsTableInfo {
+  public:
+    using key_type = Identifier;
+    using key_type_ref = key_type;
+    using data_type = Serializer::NestedTypeDeclsData;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.empty());
+      return llvm::HashString(key.str());
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = key.str().size();
+      uint32_t dataLength = (sizeof(DeclID) * 2) * data.size();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint32_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      out << key.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      static_assert(sizeof(DeclID) <= 4, "DeclID too large");
+      endian::Writer<little> writer(out);
+      for (auto entry : data) {
+        writer.write<uint32_t>(entry.first);
+        writer.write<uint32_t>(entry.second);
+      }
+    }
+  };
+} // end anonymous namespace
+
+static void
+buildNestedTypeDeclsTable(const Serializer::NestedTypeDeclsTable &table,
+                          HashTableBlob &blob) {
+  llvm::OnDiskChainedHashTableGenerator<NestedTypeDeclsTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+  emitHashTable(generator, blob);
+}
+
+/// Below this many entries in total, the lookup tables are built on the
+/// calling thread; starting threads would cost more than it saves.
+static const size_t MinEntriesForConcurrentTables = 4096;
+
+/// Run all of \p builders, on separate threads if \p concurrently is set.
+static void runTableBuilders(ArrayRef<std::function<void()>> builders,
+                             bool concurrently) {
+  if (builders.empty())
+    return;
+
+  if (!concurrently || !llvm::llvm_is_multithreaded()) {
+    for (auto &builder : builders)
+      builder();
+    return;
   }
 
-  SmallVector<uint64_t, 8> scratch;
-  out.emit(scratch, tableOffset, hashTableBlob);
+  std::vector<std::thread> threads;
+  for (auto &builder : builders.drop_front())
+    threads.emplace_back(builder);
+  builders.front()();
+  for (auto &thread : threads)
+    thread.join();
 }
 
 /// Add operator methods from the given declaration type.
@@ -3667,18 +3814,80 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     writeOffsets(Offsets, LocalDeclContextOffsets);
     writeOffsets(Offsets, NormalConformanceOffsets);
 
+    // The lookup tables don't depend on each other or on the bitstream, so
+    // for large modules they are built concurrently. Only emitting them has
+    // to happen in order.
+    HashTableBlob topLevelBlob, operatorBlob, extensionBlob, classMemberBlob,
+                  operatorMethodBlob, localTypeBlob, objcMethodBlob,
+                  memberNamesBlob, nestedTypeDeclsBlob;
+    SmallVector<std::function<void()>, 9> builders;
+    size_t numEntries = 0;
+    auto addDeclTable = [&](const DeclTable &table, HashTableBlob &blob) {
+      if (table.empty())
+        return;
+      const DeclTable *tablePtr = &table;
+      HashTableBlob *blobPtr = &blob;
+      builders.push_back([=] { buildDeclTable(*tablePtr, *blobPtr); });
+      numEntries += table.size();
+    };
+    addDeclTable(topLevelDecls, topLevelBlob);
+    addDeclTable(operatorDecls, operatorBlob);
+    addDeclTable(extensionDecls, extensionBlob);
+    addDeclTable(ClassMembersByName, classMemberBlob);
+    addDeclTable(operatorMethodDecls, operatorMethodBlob);
+    if (hasLocalTypes) {
+      builders.push_back([&] {
+        emitHashTable(localTypeGenerator, localTypeBlob);
+      });
+    }
+    builders.push_back([&] {
+      buildObjCMethodTable(objcMethods, objcMethodBlob);
+    });
+    numEntries += objcMethods.size();
+    if (!MembersByName.empty()) {
+      builders.push_back([&] {
+        buildMemberNamesTable(MembersByName, memberNamesBlob);
+      });
+      numEntries += MembersByName.size();
+    }
+    if (!NestedTypeDecls.empty()) {
+      builders.push_back([&] {
+        buildNestedTypeDeclsTable(NestedTypeDecls, nestedTypeDeclsBlob);
+      });
+      numEntries += NestedTypeDecls.size();
+    }
+    runTableBuilders(builders, numEntries >= MinEntriesForConcurrentTables);
+
     index_block::DeclListLayout DeclList(Out);
-    writeDeclTable(DeclList, index_block::TOP_LEVEL_DECLS, topLevelDecls);
-    writeDeclTable(DeclList, index_block::OPERATORS, operatorDecls);
-    writeDeclTable(DeclList, index_block::EXTENSIONS, extensionDecls);
-    writeDeclTable(DeclList, index_block::CLASS_MEMBERS, ClassMembersByName);
-    writeDeclTable(DeclList, index_block::OPERATOR_METHODS, operatorMethodDecls);
+    if (!topLevelDecls.empty())
+      writeDeclTable(DeclList, index_block::TOP_LEVEL_DECLS, topLevelBlob);
+    if (!operatorDecls.empty())
+      writeDeclTable(DeclList, index_block::OPERATORS, operatorBlob);
+    if (!extensionDecls.empty())
+      writeDeclTable(DeclList, index_block::EXTENSIONS, extensionBlob);
+    if (!ClassMembersByName.empty())
+      writeDeclTable(DeclList, index_block::CLASS_MEMBERS, classMemberBlob);
+    if (!operatorMethodDecls.empty())
+      writeDeclTable(DeclList, index_block::OPERATOR_METHODS,
+                     operatorMethodBlob);
     if (hasLocalTypes)
-      writeLocalDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS,
-                          localTypeGenerator);
+      writeDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS, localTypeBlob);
 
     index_block::ObjCMethodTableLayout ObjCMethodTable(Out);
-    writeObjCMethodTable(ObjCMethodTable, objcMethods);
+    ObjCMethodTable.emit(ScratchRecord, objcMethodBlob.TableOffset,
+                         objcMethodBlob.Data);
+
+    if (!MembersByName.empty()) {
+      index_block::MemberNamesTableLayout MemberNamesTable(Out);
+      MemberNamesTable.emit(ScratchRecord, memberNamesBlob.TableOffset,
+                            memberNamesBlob.Data);
+    }
+
+    if (!NestedTypeDecls.empty()) {
+      index_block::NestedTypeDeclsLayout NestedTypeDeclsTable(Out);
+      NestedTypeDeclsTable.emit(ScratchRecord, nestedTypeDeclsBlob.TableOffset,
+                                nestedTypeDeclsBlob.Data);
+    }
 
     if (entryPointClassID.hasValue()) {
       index_block::EntryPointLayout EntryPoint(Out);
@@ -3687,6 +3896,20 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
   }
 }
 
+void Serializer::writeContentHash() {
+  assert(ContentHashOffset != 0 && "header not written");
+  llvm::MD5 hash;
+  hash.update(ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(Buffer.data()), Buffer.size()));
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+
+  static_assert(sizeof(result) == control_block::ContentHashSize,
+                "content hash size mismatch");
+  std::copy(std::begin(result), std::end(result),
+            Buffer.begin() + ContentHashOffset);
+}
+
 void Serializer::writeToStream(raw_ostream &os) {
   os.write(Buffer.data(), Buffer.size());
   os.flush();
@@ -3715,10 +3938,11 @@ void Serializer::writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
     BCBlockRAII moduleBlock(S.Out, MODULE_BLOCK_ID, 2);
     S.writeHeader(options);
     S.writeInputBlock(options);
-    S.writeSIL(SILMod, options.SerializeAllSIL);
+    S.writeSIL(SILMod, options);
     S.writeAST(DC);
   }
 
+  S.writeContentHash();
   S.writeToStream(os);
 }
 
@@ -41,6 +41,9 @@ class Serializer {
   /// A reusable buffer for emitting records.
   SmallVector<uint64_t, 64> ScratchRecord;
 
+  /// The offset in Buffer of the content hash reserved by writeHeader.
+  size_t ContentHashOffset = 0;
+
   /// The module currently being serialized.
   const ModuleDecl *M = nullptr;
 
@@ -123,12 +126,40 @@ public:
   // hash table of all defined Objective-C methods.
   using ObjCMethodTable = llvm::DenseMap<ObjCSelector, ObjCMethodTableData>;
 
+  using MemberNamesTableData = SmallVector<DeclID, 4>;
+
+  // In-memory representation of what will eventually be an on-disk
+  // hash table of the members of each type and extension, keyed by the
+  // (raw) DeclID of the context and the base name of the members.
+  using MemberNamesTable =
+    llvm::MapVector<std::pair<uint32_t, Identifier>, MemberNamesTableData>;
+
+  using NestedTypeDeclsData = SmallVector<std::pair<DeclID, DeclID>, 4>;
+
+  // In-memory representation of what will eventually be an on-disk
+  // hash table of nested nominal types, keyed by their names. Each entry
+  // holds the DeclIDs of the enclosing nominal type and of the nested type.
+  using NestedTypeDeclsTable = llvm::MapVector<Identifier, NestedTypeDeclsData>;
+
 private:
   /// A map from identifiers to methods and properties with the given name.
   ///
   /// This is used for id-style lookup.
   DeclTable ClassMembersByName;
 
+  /// A map from types and extensions and base names to the members with the
+  /// given name.
+  ///
+  /// This is used to load only the members that are looked up.
+  MemberNamesTable MembersByName;
+
+  /// A map from names to the nominal types with the given name that are
+  /// nested in other nominal types or in their extensions.
+  ///
+  /// This is used to resolve cross-references to nested types without
+  /// loading the members or extensions of the enclosing type.
+  NestedTypeDeclsTable NestedTypeDecls;
+
   /// The queue of types and decls that need to be serialized.
   ///
   /// This is a queue and not simply a vector because serializing one
@@ -231,6 +262,10 @@ private:
   /// Writes the Swift doc module file header and name.
   void writeDocHeader();
 
+  /// Fills in the content hash reserved by writeHeader. Must be called after
+  /// everything else has been written.
+  void writeContentHash();
+
   /// Writes the dependencies used to build this module: its imported
   /// modules and its source files.
   void writeInputBlock(const SerializationOptions &options);
@@ -247,10 +282,11 @@ private:
 
   /// Writes an array of members for a decl context.
   ///
+  /// \param parent The type or extension that contains the members
   /// \param members The decls within the context
   /// \param isClass True if the context could be a class context (class,
   ///        class extension, or protocol).
-  void writeMembers(DeclRange members, bool isClass);
+  void writeMembers(const Decl *parent, DeclRange members, bool isClass);
 
   /// Check if a decl is cross-referenced.
   bool isDeclXRef(const Decl *D) const;
@@ -314,7 +350,7 @@ private:
                     const std::vector<BitOffset> &values);
 
   /// Serializes all transparent SIL functions in the SILModule.
-  void writeSIL(const SILModule *M, bool serializeAllSIL);
+  void writeSIL(const SILModule *M, const SerializationOptions &options);
 
   /// Top-level entry point for serializing a module.
   void writeAST(ModuleOrSourceFile DC);
@@ -169,6 +169,11 @@ namespace {
 
     bool ShouldSerializeAll;
 
+    /// Whether to serialize the bodies of public generic functions so that
+    /// clients can specialize them, and the size limit for such bodies.
+    bool ShouldSerializeGenerics;
+    unsigned GenericSizeLimit;
+
     /// Helper function to update ListOfValues for MethodInst. Format:
     /// Attr, SILDeclRef (DeclID, Kind, uncurryLevel, IsObjC), and an operand.
     void handleMethodInst(const MethodInst *MI, SILValue operand,
@@ -204,8 +209,11 @@ namespace {
 
   public:
     SILSerializer(Serializer &S, ASTContext &Ctx,
-                  llvm::BitstreamWriter &Out, bool serializeAll)
-      : S(S), Ctx(Ctx), Out(Out), ShouldSerializeAll(serializeAll) {}
+                  llvm::BitstreamWriter &Out,
+                  const SerializationOptions &options)
+      : S(S), Ctx(Ctx), Out(Out), ShouldSerializeAll(options.SerializeAllSIL),
+        ShouldSerializeGenerics(options.SerializeGenericSIL),
+        GenericSizeLimit(options.SerializeGenericSILLimit) {}
 
     void writeSILModule(const SILModule *SILMod);
   };
@@ -1627,6 +1635,52 @@ void SILSerializer::writeSILWitnessTable(const SILWitnessTable &wt) {
   }
 }
 
+/// Returns true if \p Ty mentions a nominal type that is not visible to
+/// clients of this module.
+static bool referencesNonPublicType(SILType Ty) {
+  return Ty.getSwiftRValueType().findIf([](Type T) -> bool {
+    if (auto *NTD = T->getAnyNominal())
+      return NTD->getEffectiveAccess() < Accessibility::Public;
+    return false;
+  });
+}
+
+/// Returns true if the body of the public generic function \p F can be
+/// serialized for specialization in clients: it must not be larger than
+/// \p SizeLimit instructions and must only refer to functions, globals and
+/// types that clients can link against.
+static bool canSerializeGenericBody(const SILFunction &F, unsigned SizeLimit) {
+  if (F.getLinkage() != SILLinkage::Public ||
+      !F.getLoweredFunctionType()->isPolymorphic())
+    return false;
+
+  unsigned Size = 0;
+  for (const SILBasicBlock &BB : F) {
+    for (const SILArgument *Arg : BB.getBBArgs())
+      if (referencesNonPublicType(Arg->getType()))
+        return false;
+
+    for (const SILInstruction &I : BB) {
+      if (++Size > SizeLimit)
+        return false;
+
+      if (auto *FRI = dyn_cast<FunctionRefInst>(&I)) {
+        SILFunction *Callee = FRI->getReferencedFunction();
+        if (!hasPublicVisibility(Callee->getLinkage()) && !Callee->isFragile())
+          return false;
+      } else if (auto *GAI = dyn_cast<GlobalAddrInst>(&I)) {
+        if (!hasPublicVisibility(GAI->getReferencedGlobal()->getLinkage()))
+          return false;
+      }
+
+      for (SILType Ty : I.getTypes())
+        if (referencesNonPublicType(Ty))
+          return false;
+    }
+  }
+  return true;
+}
+
 /// Helper function for whether to emit a function body.
 bool SILSerializer::shouldEmitFunctionBody(const SILFunction &F) {
   // If F is a declaration, it has no body to emit...
@@ -1637,6 +1691,12 @@ bool SILSerializer::shouldEmitFunctionBody(const SILFunction &F) {
   if (F.isFragile())
     return true;
 
+  // Public generic functions are serialized on request, so that clients can
+  // specialize them instead of calling the unspecialized entry point.
+  if (ShouldSerializeGenerics &&
+      canSerializeGenericBody(F, GenericSizeLimit))
+    return true;
+
   // Otherwise serialize the body of the function only if we are asked to
   // serialize everything.
   return false;
@@ -1719,9 +1779,11 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
     return;
 
   // Now write function declarations for every function we've
-  // emitted a reference to without emitting a function body for.
+  // emitted a reference to without emitting a function body for, and for
+  // the specializations this module exports, so that clients can find them.
   for (const SILFunction &F : *SILMod) {
-    if (!shouldEmitFunctionBody(F) && FuncsToDeclare.count(&F))
+    if (!shouldEmitFunctionBody(F) &&
+        (FuncsToDeclare.count(&F) || F.isKeepAsPublic()))
       writeSILFunction(F, true);
   }
 }
@@ -1731,10 +1793,11 @@ void SILSerializer::writeSILModule(const SILModule *SILMod) {
   writeIndexTables();
 }
 
-void Serializer::writeSIL(const SILModule *SILMod, bool serializeAllSIL) {
+void Serializer::writeSIL(const SILModule *SILMod,
+                          const SerializationOptions &options) {
   if (!SILMod)
     return;
 
-  SILSerializer SILSer(*this, M->getASTContext(), Out, serializeAllSIL);
+  SILSerializer SILSer(*this, M->getASTContext(), Out, options);
   SILSer.writeSILModule(SILMod);
 }
@@ -91,6 +91,13 @@ SILFunction *SerializedSILLoader::lookupSILFunction(StringRef Name) {
   return retVal;
 }
 
+SILFunction *SerializedSILLoader::lookupSILFunctionDeclaration(StringRef Name) {
+  for (auto &Des : LoadedSILSections)
+    if (auto Func = Des->lookupSILFunction(Name, /*declarationOnly*/ true))
+      return Func;
+  return nullptr;
+}
+
 SILVTable *SerializedSILLoader::lookupVTable(Identifier Name) {
   for (auto &Des : LoadedSILSections) {
     if (auto VT = Des->lookupVTable(Name))
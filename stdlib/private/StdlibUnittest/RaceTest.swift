@@ -34,6 +34,9 @@
 /// possible, and the results should be returned as `Observation`.  Evaluation
 /// (cross-checking) of observations is deferred until the end of the trial.
 ///
+/// The harness can also measure how the throughput of the operation scales
+/// with the number of racing threads; see `runRaceScalingBenchmark`.
+///
 //===----------------------------------------------------------------------===//
 
 import SwiftPrivate
@@ -387,10 +390,14 @@ class _RaceTestWorkerState<RT : RaceTestWithPerTrialDataType> {
   var raceData: [RT.RaceData] = []
   var raceDataShuffle: [Int] = []
   var observations: [RT.Observation] = []
+
+  /// The time this thread spent performing operations during the trial.
+  var elapsedNanoseconds: UInt64 = 0
 }
 
 class _RaceTestSharedState<RT : RaceTestWithPerTrialDataType> {
   var racingThreadCount: Int
+  var raceDataCount: Int
 
   var trialBarrier: _stdlib_Barrier
   var trialSpinBarrier: _stdlib_AtomicInt = _stdlib_AtomicInt()
@@ -400,8 +407,14 @@ class _RaceTestSharedState<RT : RaceTestWithPerTrialDataType> {
   var aggregatedEvaluations: _RaceTestAggregatedEvaluations =
     _RaceTestAggregatedEvaluations()
 
-  init(racingThreadCount: Int) {
+  /// The time each thread spent performing operations, over all trials.
+  var totalElapsedNanoseconds: [UInt64]
+
+  init(racingThreadCount: Int, raceDataCount: Int) {
     self.racingThreadCount = racingThreadCount
+    self.raceDataCount = raceDataCount
+    self.totalElapsedNanoseconds =
+      [UInt64](count: racingThreadCount, repeatedValue: 0)
     self.trialBarrier = _stdlib_Barrier(threadCount: racingThreadCount + 1)
 
     self.workerStates.reserveCapacity(racingThreadCount)
@@ -415,7 +428,7 @@ func _masterThreadOneTrial<RT : RaceTestWithPerTrialDataType>(
   sharedState: _RaceTestSharedState<RT>
 ) {
   let racingThreadCount = sharedState.racingThreadCount
-  let raceDataCount = racingThreadCount * racingThreadCount
+  let raceDataCount = sharedState.raceDataCount
   let rt = RT()
 
   sharedState.raceData.removeAll(keepCapacity: true)
@@ -447,6 +460,8 @@ func _masterThreadOneTrial<RT : RaceTestWithPerTrialDataType>(
 
   // Collect and compare results.
   for i in 0..<racingThreadCount {
+    sharedState.totalElapsedNanoseconds[i] +=
+      sharedState.workerStates[i].elapsedNanoseconds
     let shuffle = sharedState.workerStates[i].raceDataShuffle
     sharedState.workerStates[i].raceData =
       gather(sharedState.workerStates[i].raceData, shuffle)
@@ -487,19 +502,44 @@ func _workerThreadOneTrial<RT : RaceTestWithPerTrialDataType>(
   // Perform racy operations.
   // Warning: do not add any synchronization in this loop, including
   // any implicit reference counting of shared data.
+  let start = _raceTestNanoseconds()
   for raceData in workerState.raceData {
     workerState.observations.append(rt.thread1(raceData, &threadLocalData))
   }
+  workerState.elapsedNanoseconds = _raceTestNanoseconds() - start
   sharedState.trialBarrier.wait()
 }
 
-public func runRaceTest<RT : RaceTestWithPerTrialDataType>(
+/// Nanoseconds from a monotonic clock.
+internal func _raceTestNanoseconds() -> UInt64 {
+#if os(Linux)
+  var now = timespec()
+  clock_gettime(CLOCK_MONOTONIC, &now)
+  return UInt64(now.tv_sec) * 1_000_000_000 + UInt64(now.tv_nsec)
+#else
+  var info = mach_timebase_info_data_t()
+  mach_timebase_info(&info)
+  return mach_absolute_time() * UInt64(info.numer) / UInt64(info.denom)
+#endif
+}
+
+/// The number of times the process was switched out involuntarily so far.
+internal func _raceTestInvoluntaryContextSwitches() -> Int {
+  var usage = rusage()
+  getrusage(RUSAGE_SELF, &usage)
+  return usage.ru_nivcsw
+}
+
+/// Run `trials` trials of the race test in `racingThreadCount` threads,
+/// with `raceDataCount` data items each, and return the final state.
+internal func _runRaceTestTrials<RT : RaceTestWithPerTrialDataType>(
   _: RT.Type,
   trials: Int,
-  threads: Int? = nil
-) {
-  let racingThreadCount = threads ?? max(2, _stdlib_getHardwareConcurrency())
-  let sharedState = _RaceTestSharedState<RT>(racingThreadCount: racingThreadCount)
+  racingThreadCount: Int,
+  raceDataCount: Int
+) -> _RaceTestSharedState<RT> {
+  let sharedState = _RaceTestSharedState<RT>(
+    racingThreadCount: racingThreadCount, raceDataCount: raceDataCount)
 
   let masterThreadBody: (_: ())->() = {
     (_: ())->() in
@@ -541,6 +581,19 @@ public func runRaceTest<RT : RaceTestWithPerTrialDataType>(
     expectEqual(0, ret)
   }
 
+  return sharedState
+}
+
+public func runRaceTest<RT : RaceTestWithPerTrialDataType>(
+  test: RT.Type,
+  trials: Int,
+  threads: Int? = nil
+) {
+  let racingThreadCount = threads ?? max(2, _stdlib_getHardwareConcurrency())
+  let sharedState = _runRaceTestTrials(
+    test, trials: trials, racingThreadCount: racingThreadCount,
+    raceDataCount: racingThreadCount * racingThreadCount)
+
   let aggregatedEvaluations = sharedState.aggregatedEvaluations
   expectFalse(aggregatedEvaluations.isFailed)
   print(aggregatedEvaluations)
@@ -563,6 +616,140 @@ public func runRaceTest<RT : RaceTestWithPerTrialDataType>(
   runRaceTest(test, trials: trials, threads: threads)
 }
 
+/// The throughput of a race test with one number of racing threads.
+public struct RaceTestScalingResult : CustomStringConvertible {
+  /// The number of racing threads.
+  public let threads: Int
+
+  /// The number of operations that were performed, in all threads.
+  public let operations: Int
+
+  /// The time the slowest thread spent performing its operations.
+  public let nanoseconds: UInt64
+
+  /// The time the slowest thread spent performing its operations, divided
+  /// by the time the fastest one did.  Threads that wait for each other,
+  /// or for a shared resource, make this larger than 1.
+  public let imbalance: Double
+
+  /// The number of times the process was switched out involuntarily while
+  /// the test ran, which grows with lock contention and oversubscription.
+  public let involuntaryContextSwitches: Int
+
+  /// The number of operations performed per second, in all threads.
+  public var operationsPerSecond: Double {
+    return Double(operations) * 1e9 / Double(max(nanoseconds, 1))
+  }
+
+  public var description: String {
+    return "threads: \(threads), operations/s: " +
+      _formatRaceTestDouble(operationsPerSecond, fractionDigits: 0) +
+      ", imbalance: " + _formatRaceTestDouble(imbalance, fractionDigits: 2) +
+      ", involuntary context switches: \(involuntaryContextSwitches)"
+  }
+}
+
+internal func _formatRaceTestDouble(x: Double, fractionDigits: Int) -> String {
+  var scale = 1
+  for _ in 0..<fractionDigits {
+    scale *= 10
+  }
+  let scaled = Int(x * Double(scale) + 0.5)
+  if fractionDigits == 0 {
+    return String(scaled)
+  }
+  let fraction = String(scaled % scale)
+  return String(scaled / scale) + "." +
+    String(count: fractionDigits - fraction.characters.count,
+           repeatedValue: Character("0")) +
+    fraction
+}
+
+/// Measure how the throughput of `test` scales with the number of racing
+/// threads, and print a table of the results.
+///
+/// The operation runs `operationsPerThread` times in every thread, for
+/// every count in `threadCounts`, which defaults to the powers of two up
+/// to the number of hardware threads, and that number.  Only the time
+/// spent in operations is measured, not the time of the harness between
+/// trials.  Observations are evaluated as in `runRaceTest`, so that the
+/// benchmark doubles as a stress test.
+///
+/// In the table, "speedup" is the throughput relative to the first thread
+/// count, and "efficiency" is the speedup per additional thread; an
+/// operation that scales perfectly has an efficiency of 1.
+public func runRaceScalingBenchmark<RT : RaceTestWithPerTrialDataType>(
+  test: RT.Type,
+  operationsPerThread: Int,
+  threadCounts: [Int]? = nil
+) -> [RaceTestScalingResult] {
+  var counts: [Int]
+  if let threadCounts = threadCounts {
+    counts = threadCounts
+  } else {
+    let hardwareConcurrency = _stdlib_getHardwareConcurrency()
+    counts = []
+    for var count = 1; count < hardwareConcurrency; count *= 2 {
+      counts.append(count)
+    }
+    counts.append(hardwareConcurrency)
+  }
+
+  var results: [RaceTestScalingResult] = []
+  for racingThreadCount in counts {
+    // Operations are timed per trial, so every trial has enough of them to
+    // dwarf the resolution of the clock.
+    let raceDataCount = max(racingThreadCount * racingThreadCount, 1024)
+    let trials = _divideRoundUp(operationsPerThread, raceDataCount)
+
+    let switchesBefore = _raceTestInvoluntaryContextSwitches()
+    let sharedState = _runRaceTestTrials(
+      test, trials: trials, racingThreadCount: racingThreadCount,
+      raceDataCount: raceDataCount)
+    let switches = _raceTestInvoluntaryContextSwitches() - switchesBefore
+
+    expectFalse(sharedState.aggregatedEvaluations.isFailed)
+    let elapsed = sharedState.totalElapsedNanoseconds
+    let slowest = elapsed.maxElement()!
+    let fastest = elapsed.minElement()!
+    results.append(RaceTestScalingResult(
+      threads: racingThreadCount,
+      operations: trials * raceDataCount * racingThreadCount,
+      nanoseconds: slowest,
+      imbalance: Double(slowest) / Double(max(fastest, 1)),
+      involuntaryContextSwitches: switches))
+  }
+
+  print("\(test) scaling:")
+  print("threads  operations/s  speedup  efficiency  imbalance  involuntary-csw")
+  let baseline = results.first
+  for result in results {
+    let speedup = result.operationsPerSecond / baseline!.operationsPerSecond
+    let efficiency =
+      speedup * Double(baseline!.threads) / Double(result.threads)
+    let columns = [
+      (String(result.threads), 7),
+      (_formatRaceTestDouble(result.operationsPerSecond, fractionDigits: 0), 12),
+      (_formatRaceTestDouble(speedup, fractionDigits: 2), 7),
+      (_formatRaceTestDouble(efficiency, fractionDigits: 2), 10),
+      (_formatRaceTestDouble(result.imbalance, fractionDigits: 2), 9),
+      (String(result.involuntaryContextSwitches), 15),
+    ]
+    var line = ""
+    for (text, width) in columns {
+      if !line.isEmpty {
+        line += "  "
+      }
+      line += String(
+        count: max(0, width - text.characters.count),
+        repeatedValue: Character(" "))
+      line += text
+    }
+    print(line)
+  }
+  return results
+}
+
 public func consumeCPU(units amountOfWork: Int) {
   for _ in 0..<amountOfWork {
     let scale = 16
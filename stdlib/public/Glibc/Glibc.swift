@@ -168,6 +168,16 @@ public var SIG_HOLD: __sighandler_t {
 }
 #endif
 
+//===----------------------------------------------------------------------===//
+// sys/mman.h
+//===----------------------------------------------------------------------===//
+
+/// The value returned by `mmap()` in the case of failure.
+public var MAP_FAILED: UnsafeMutablePointer<Void> {
+  // The value is ABI.  Value verified to be correct on Glibc.
+  return UnsafeMutablePointer<Void>(bitPattern: -1)
+}
+
 //===----------------------------------------------------------------------===//
 // semaphore.h
 //===----------------------------------------------------------------------===//
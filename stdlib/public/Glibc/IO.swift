@@ -0,0 +1,359 @@
+//===--- IO.swift - Buffered and zero-copy I/O helpers --------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// These helpers follow the conventions of the functions they wrap: they
+// return -1 and leave the error in `errno` on failure.  Unlike the raw
+// calls, they retry when interrupted by a signal.
+//
+//===----------------------------------------------------------------------===//
+
+/// The maximum number of buffers passed to a single `readv` or `writev`
+/// call (`UIO_MAXIOV`).
+internal var _maxIOVectors: Int { return 1024 }
+
+internal var _newline: CInt { return CInt(UInt8(ascii: "\n")) }
+
+@warn_unused_result
+internal func _readRetryingOnInterrupt(
+  fd: CInt,
+  _ buffer: UnsafeMutableBufferPointer<UInt8>
+) -> Int {
+  while true {
+    let result = read(fd, buffer.baseAddress, buffer.count)
+    if result >= 0 || errno != EINTR {
+      return result
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// unistd.h
+//===----------------------------------------------------------------------===//
+
+/// Reads up to `buffer.count` bytes from `fd` directly into `buffer`.
+///
+/// Returns the number of bytes read, or 0 at end of file.
+@warn_unused_result
+public func read(
+  fd: CInt,
+  _ buffer: UnsafeMutableBufferPointer<UInt8>
+) -> Int {
+  return _readRetryingOnInterrupt(fd, buffer)
+}
+
+/// Writes all of `buffer` to `fd`, continuing after partial writes.
+///
+/// Returns the number of bytes written.
+public func write(fd: CInt, _ buffer: UnsafeBufferPointer<UInt8>) -> Int {
+  var written = 0
+  while written < buffer.count {
+    let result = write(fd, buffer.baseAddress + written,
+                       buffer.count - written)
+    if result < 0 {
+      if errno == EINTR { continue }
+      return -1
+    }
+    written += result
+  }
+  return written
+}
+
+//===----------------------------------------------------------------------===//
+// sys/uio.h
+//===----------------------------------------------------------------------===//
+
+/// Reads from `fd` into each of `buffers` in turn with a single `readv`
+/// call.
+///
+/// Returns the total number of bytes read, or 0 at end of file.
+@warn_unused_result
+public func readv(
+  fd: CInt,
+  _ buffers: [UnsafeMutableBufferPointer<UInt8>]
+) -> Int {
+  let vectors = buffers.map {
+    iovec(iov_base: UnsafeMutablePointer($0.baseAddress), iov_len: $0.count)
+  }
+  return vectors.withUnsafeBufferPointer {
+    (vectors) -> Int in
+    while true {
+      let result = readv(fd, vectors.baseAddress,
+                         CInt(min(vectors.count, _maxIOVectors)))
+      if result >= 0 || errno != EINTR {
+        return result
+      }
+    }
+  }
+}
+
+/// Writes all of `buffers` to `fd` in order, batching them into as few
+/// `writev` calls as possible.
+///
+/// Returns the total number of bytes written.
+public func writev(fd: CInt, _ buffers: [UnsafeBufferPointer<UInt8>]) -> Int {
+  var vectors = buffers.map {
+    iovec(iov_base: UnsafeMutablePointer($0.baseAddress), iov_len: $0.count)
+  }
+  var written = 0
+  var first = 0
+  while true {
+    // Skip the buffers that have been written completely.
+    while first < vectors.count && vectors[first].iov_len == 0 {
+      first += 1
+    }
+    if first == vectors.count {
+      return written
+    }
+
+    let result = vectors.withUnsafeBufferPointer {
+      writev(fd, $0.baseAddress + first,
+             CInt(min($0.count - first, _maxIOVectors)))
+    }
+    if result < 0 {
+      if errno == EINTR { continue }
+      return -1
+    }
+    written += result
+
+    // Consume the written bytes from the front of the remaining buffers.
+    var remaining = result
+    while remaining > 0 {
+      let consumed = min(remaining, vectors[first].iov_len)
+      vectors[first].iov_base = UnsafeMutablePointer(
+        UnsafeMutablePointer<UInt8>(vectors[first].iov_base) + consumed)
+      vectors[first].iov_len -= consumed
+      remaining -= consumed
+      if vectors[first].iov_len == 0 {
+        first += 1
+      }
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Buffered reading
+//===----------------------------------------------------------------------===//
+
+/// Reads from a file descriptor, such as a file, pipe or socket, through an
+/// internal buffer.
+///
+/// The reader does not own the file descriptor and never closes it.
+public final class FileDescriptorReader {
+  /// The file descriptor being read.
+  public let fileDescriptor: CInt
+
+  internal var _buffer: UnsafeMutablePointer<UInt8>
+  internal var _capacity: Int
+
+  /// The unread bytes are `_buffer[_start..<_end]`.
+  internal var _start = 0
+  internal var _end = 0
+
+  /// Creates a reader of `fileDescriptor` with a buffer of `bufferSize`
+  /// bytes.  The buffer grows as needed to hold a long line.
+  public init(fileDescriptor: CInt, bufferSize: Int = 64 * 1024) {
+    precondition(bufferSize > 0, "buffer size must be positive")
+    self.fileDescriptor = fileDescriptor
+    self._capacity = bufferSize
+    self._buffer = UnsafeMutablePointer<UInt8>.alloc(bufferSize)
+  }
+
+  deinit {
+    _buffer.dealloc(_capacity)
+  }
+
+  /// Moves the unread bytes to the front of the buffer, growing it if it
+  /// is full, and reads more after them.
+  ///
+  /// Returns the number of bytes read, 0 at end of file, or -1 on error.
+  internal func _fill() -> Int {
+    if _start > 0 {
+      memmove(_buffer, _buffer + _start, _end - _start)
+      _end -= _start
+      _start = 0
+    }
+    if _end == _capacity {
+      let newCapacity = _capacity * 2
+      let newBuffer = UnsafeMutablePointer<UInt8>.alloc(newCapacity)
+      newBuffer.initializeFrom(_buffer, count: _end)
+      _buffer.dealloc(_capacity)
+      _buffer = newBuffer
+      _capacity = newCapacity
+    }
+    let result = _readRetryingOnInterrupt(
+      fileDescriptor,
+      UnsafeMutableBufferPointer(start: _buffer + _end,
+                                 count: _capacity - _end))
+    if result > 0 {
+      _end += result
+    }
+    return result
+  }
+
+  /// Reads up to `buffer.count` bytes into `buffer`.  Reads at least as
+  /// large as the reader's buffer bypass it.
+  ///
+  /// Returns the number of bytes read, 0 at end of file, or -1 on error.
+  @warn_unused_result
+  public func read(into buffer: UnsafeMutableBufferPointer<UInt8>) -> Int {
+    if _start == _end {
+      if buffer.count >= _capacity {
+        return _readRetryingOnInterrupt(fileDescriptor, buffer)
+      }
+      let result = _fill()
+      if result <= 0 {
+        return result
+      }
+    }
+    let count = min(buffer.count, _end - _start)
+    buffer.baseAddress.assignFrom(_buffer + _start, count: count)
+    _start += count
+    return count
+  }
+
+  /// Returns the next line, without its newline, as a view of the
+  /// reader's buffer.
+  ///
+  /// The view is only valid until the next call on the reader.  Returns
+  /// nil at end of file, or on error with `errno` set.
+  @warn_unused_result
+  public func nextLine() -> UnsafeBufferPointer<UInt8>? {
+    var scanned = _start
+    while true {
+      let newline = memchr(_buffer + scanned, _newline, _end - scanned)
+      if newline != nil {
+        let lineEnd = UnsafeMutablePointer<UInt8>(newline) - _buffer
+        let line = UnsafeBufferPointer(start: _buffer + _start,
+                                       count: lineEnd - _start)
+        _start = lineEnd + 1
+        return line
+      }
+
+      // _fill moves the unread bytes to the front of the buffer.
+      scanned = _end - _start
+      let result = _fill()
+      if result < 0 {
+        return nil
+      }
+      if result == 0 {
+        if _start == _end {
+          return nil
+        }
+        // The last line has no newline.
+        let line = UnsafeBufferPointer(start: _buffer + _start,
+                                       count: _end - _start)
+        _start = _end
+        return line
+      }
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Memory-mapped files
+//===----------------------------------------------------------------------===//
+
+/// The newline-separated lines of a buffer of UTF-8 text, as views of the
+/// buffer.  A final newline does not start another, empty line.
+public struct UTF8Lines : SequenceType {
+  public let buffer: UnsafeBufferPointer<UInt8>
+
+  public init(_ buffer: UnsafeBufferPointer<UInt8>) {
+    self.buffer = buffer
+  }
+
+  public func generate() -> UTF8LinesGenerator {
+    return UTF8LinesGenerator(_position: buffer.baseAddress,
+                              _end: buffer.baseAddress + buffer.count)
+  }
+}
+
+/// A generator over the lines of a buffer of UTF-8 text.
+public struct UTF8LinesGenerator : GeneratorType {
+  internal var _position: UnsafePointer<UInt8>
+  internal let _end: UnsafePointer<UInt8>
+
+  internal init(_position: UnsafePointer<UInt8>, _end: UnsafePointer<UInt8>) {
+    self._position = _position
+    self._end = _end
+  }
+
+  public mutating func next() -> UnsafeBufferPointer<UInt8>? {
+    if _position == _end {
+      return nil
+    }
+    let newline = memchr(_position, _newline, _end - _position)
+    let lineEnd = newline != nil ? UnsafePointer<UInt8>(newline) : _end
+    let line = UnsafeBufferPointer(start: _position, count: lineEnd - _position)
+    _position = newline != nil ? lineEnd + 1 : _end
+    return line
+  }
+}
+
+/// The read-only contents of a file, mapped into memory with `mmap`.
+///
+/// Views of the contents, such as `buffer` and the elements of `lines`, are
+/// only valid for the lifetime of the `MappedFile`.
+public final class MappedFile : CollectionType {
+  /// The contents of the file.
+  public private(set) var buffer: UnsafeBufferPointer<UInt8>
+
+  /// Maps the file at `path`, or returns nil with `errno` set.
+  public init?(path: UnsafePointer<CChar>) {
+    buffer = UnsafeBufferPointer(start: nil, count: 0)
+
+    let fd = open(path, O_RDONLY)
+    if fd < 0 {
+      return nil
+    }
+    defer { close(fd) }
+
+    let size = lseek(fd, 0, SEEK_END)
+    if size < 0 {
+      return nil
+    }
+    // mmap rejects empty mappings.
+    if size == 0 {
+      return
+    }
+
+    let address = mmap(nil, Int(size), PROT_READ, MAP_PRIVATE, fd, 0)
+    if address == MAP_FAILED {
+      return nil
+    }
+    buffer = UnsafeBufferPointer(start: UnsafePointer(address),
+                                 count: Int(size))
+  }
+
+  deinit {
+    if buffer.count > 0 {
+      munmap(UnsafeMutablePointer(buffer.baseAddress), buffer.count)
+    }
+  }
+
+  /// The lines of the file, as views of the mapping.
+  public var lines: UTF8Lines {
+    return UTF8Lines(buffer)
+  }
+
+  public var startIndex: Int {
+    return 0
+  }
+
+  public var endIndex: Int {
+    return buffer.count
+  }
+
+  public subscript(position: Int) -> UInt8 {
+    return buffer[position]
+  }
+}
@@ -70,6 +70,7 @@ public class NSConstantString {}
 
 @warn_unused_result
 @_silgen_name("swift_convertStringToNSString")
+@_semantics("convertToObjectiveC")
 public // COMPILER_INTRINSIC
 func _convertStringToNSString(string: String) -> NSString {
   return string._bridgeToObjectiveC()
@@ -438,6 +439,7 @@ public func _convertNSArrayToArray<T>(source: NSArray?) -> [T] {
 ///
 /// to Objective-C code as a method that returns an `NSArray`.
 @warn_unused_result
+@_semantics("convertToObjectiveC")
 public func _convertArrayToNSArray<T>(array: [T]) -> NSArray {
   return array._bridgeToObjectiveC()
 }
@@ -593,6 +595,7 @@ public func _convertNSDictionaryToDictionary<
 /// The cast can fail if bridging fails.  The actual checks and bridging can be
 /// deferred.
 @warn_unused_result
+@_semantics("convertToObjectiveC")
 public func _convertDictionaryToNSDictionary<Key, Value>(
   d: [Key : Value]
 ) -> NSDictionary {
@@ -835,6 +838,7 @@ extension NSIndexSet : SequenceType {
 /// The cast can fail if bridging fails.  The actual checks and bridging can be
 /// deferred.
 @warn_unused_result
+@_semantics("convertToObjectiveC")
 public func _convertSetToNSSet<T>(s: Set<T>) -> NSSet {
   return s._bridgeToObjectiveC()
 }
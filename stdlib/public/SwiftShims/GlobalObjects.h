@@ -37,6 +37,14 @@ struct _SwiftEmptyArrayStorage {
 
 extern struct _SwiftEmptyArrayStorage _swiftEmptyArrayStorage;
 
+/// A null-terminated one-character string for each ASCII character, so
+/// that single-character strings need no heap buffer.
+struct _SwiftASCIICharacterStrings {
+  __swift_uint8_t characters[128][2];
+};
+
+extern struct _SwiftASCIICharacterStrings _swiftASCIICharacterStrings;
+
 extern __swift_uint64_t _swift_stdlib_HashingDetail_fixedSeedOverride;
 
 #ifdef __cplusplus
@@ -15,6 +15,7 @@
 #include "RefCount.h"
 
 #ifdef __cplusplus
+#include <cstddef>
 #include <type_traits>
 #include "swift/Basic/type_traits.h"
 
@@ -54,6 +55,14 @@ static_assert(swift::IsTriviallyConstructible<HeapObject>::value,
               "HeapObject must be trivially initializable");
 static_assert(std::is_trivially_destructible<HeapObject>::value,
               "HeapObject must be trivially destructible");
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+// StrongRefCount keeps its biased count in the weak reference count word.
+static_assert(offsetof(HeapObject, weakRefCount) ==
+                offsetof(HeapObject, refCount) + sizeof(StrongRefCount),
+              "weak reference count must directly follow the strong one");
+static_assert(sizeof(WeakRefCount) == 2 * sizeof(uint16_t),
+              "biased count must be the upper half of the weak word");
+#endif
 
 }
 #endif 
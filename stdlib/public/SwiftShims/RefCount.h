@@ -37,6 +37,27 @@ typedef struct {
 
  #include "swift/Basic/type_traits.h"
 
+#ifndef SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+#define SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING 0
+#endif
+
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+class StrongRefCount;
+
+// The biased reference counting owner ID of the current thread. Zero until
+// the thread first allocates an object.
+extern __thread uint16_t _swift_biasedRefCountThreadID
+  __attribute__((visibility("hidden")));
+
+// Assign the current thread an owner ID and return it.
+extern uint16_t _swift_biasedRefCountAssignThreadID()
+  __attribute__((visibility("hidden")));
+
+// Ask the owner thread of a biased object to merge its biased count.
+extern void _swift_biasedRefCountQueueMerge(StrongRefCount *refCount)
+  __attribute__((visibility("hidden")));
+#endif
+
 // Strong reference count.
 
 // Barriers
@@ -49,26 +70,84 @@ typedef struct {
 // dealloc code. This ensures that the deinit code sees all modifications
 // of the object's contents that were made before the object was released.
 
+// Biased reference counting
+//
+// When the runtime is built with SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING,
+// a new object is biased towards the thread that allocated it. The owner
+// thread counts its references in a biased count that only it writes, using
+// plain loads and stores. Every other thread uses the shared count in
+// refCount, which may go negative when other threads release references the
+// owner handed to them.
+//
+// The biased count lives in the upper half of the weak reference count word
+// that follows this one in HeapObject, so the header keeps its size. Its top
+// bits hold the owner ID and never change once the object is initialized.
+//
+// When the owner drops its biased count to zero it sets the merged flag, and
+// from then on the shared count is the whole reference count. When another
+// thread takes the shared count negative, it sets the queued flag and hands
+// the object to the owner. The owner merges queued objects the next time it
+// allocates, or when it exits. A queued object is only deallocated by that
+// merge.
+
+class WeakRefCount;
+
 class StrongRefCount {
+  friend bool tryIncrementStrongAndDecrementWeak(StrongRefCount &strong,
+                                                 WeakRefCount &weak);
+
   uint32_t refCount;
 
   // The low bit is the pinned marker.
   // The next bit is the deallocating marker.
+  // With biased reference counting, the next bits are the merged marker and
+  // the queued marker.
   // The remaining bits are the reference count.
   // refCount == RC_ONE means reference count == 1.
   enum : uint32_t {
     RC_PINNED_FLAG = 0x1,
     RC_DEALLOCATING_FLAG = 0x2,
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    RC_MERGED_FLAG = 0x4,
+    RC_QUEUED_FLAG = 0x8,
+
+    RC_FLAGS_COUNT = 4,
+    RC_FLAGS_MASK = 15,
+#else
     RC_FLAGS_COUNT = 2,
     RC_FLAGS_MASK = 3,
+#endif
     RC_COUNT_MASK = ~RC_FLAGS_MASK,
 
     RC_ONE = RC_FLAGS_MASK + 1
   };
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  // The biased count holds the owner ID above BIASED_COUNT_BITS of count.
+  enum : uint16_t {
+    BIASED_COUNT_BITS = 10,
+    BIASED_COUNT_MASK = (1 << BIASED_COUNT_BITS) - 1,
+  };
+
+public:
+  enum : uint16_t {
+    // Owner IDs run from 1 to BIASED_MAX_OWNER. Threads created after the
+    // IDs run out get BIASED_NO_OWNER and allocate unbiased objects.
+    BIASED_NO_OWNER = (1 << (16 - BIASED_COUNT_BITS)) - 1,
+    BIASED_MAX_OWNER = BIASED_NO_OWNER - 1
+  };
+
+private:
+#endif
+
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  static_assert(RC_ONE == RC_QUEUED_FLAG << 1,
+                "queued bit must be adjacent to refcount bits");
+#else
   static_assert(RC_ONE == RC_DEALLOCATING_FLAG << 1,
                 "deallocating bit must be adjacent to refcount bits");
+#endif
   static_assert(RC_ONE == 1 << RC_FLAGS_COUNT,
                 "inconsistent refcount flags");
   static_assert(RC_ONE == 1 + RC_FLAGS_MASK,
@@ -83,20 +162,55 @@ class StrongRefCount {
   StrongRefCount() = default;
   
   // Refcount of a new object is 1.
+  // With biased reference counting, statically initialized objects are
+  // never biased.
   constexpr StrongRefCount(Initialized_t)
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    : refCount(RC_ONE | RC_MERGED_FLAG) { }
+#else
     : refCount(RC_ONE) { }
+#endif
 
   void init() {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    uint16_t owner = _swift_biasedRefCountThreadID;
+    if (__builtin_expect(owner == 0, 0))
+      owner = _swift_biasedRefCountAssignThreadID();
+    if (owner != BIASED_NO_OWNER) {
+      refCount = 0;
+      storeBiased(uint16_t(owner << BIASED_COUNT_BITS) | 1);
+      return;
+    }
+    refCount = RC_ONE | RC_MERGED_FLAG;
+    storeBiased(0);
+#else
     refCount = RC_ONE;
+#endif
   }
 
   // Increment the reference count.
   void increment() {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    uint16_t biased = loadBiased();
+    if (isBiasedToCurrentThread(biased) &&
+        (biased & BIASED_COUNT_MASK) != BIASED_COUNT_MASK) {
+      storeBiased(biased + 1);
+      return;
+    }
+#endif
     __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
   }
 
   // Increment the reference count by n.
   void increment(uint32_t n) {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    uint16_t biased = loadBiased();
+    if (isBiasedToCurrentThread(biased) &&
+        (biased & BIASED_COUNT_MASK) + n <= BIASED_COUNT_MASK) {
+      storeBiased(uint16_t(biased + n));
+      return;
+    }
+#endif
     __atomic_fetch_add(&refCount, n << RC_FLAGS_COUNT, __ATOMIC_RELAXED);
   }
 
@@ -151,17 +265,59 @@ class StrongRefCount {
   // Decrement the reference count.
   // Return true if the caller should now deallocate the object.
   bool decrementShouldDeallocate() {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    uint16_t biased = loadBiased();
+    if (isBiasedToCurrentThread(biased))
+      return doBiasedDecrementShouldDeallocate(biased, 1);
+#endif
     return doDecrementShouldDeallocate<false>();
   }
 
   bool decrementShouldDeallocateN(uint32_t n) {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    uint16_t biased = loadBiased();
+    if (isBiasedToCurrentThread(biased))
+      return doBiasedDecrementShouldDeallocate(biased, n);
+#endif
     return doDecrementShouldDeallocateN<false>(n);
   }
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  // Fold the biased count of a queued object into the shared count and
+  // clear the queued flag.
+  // Return true if the caller should now deallocate the object.
+  //
+  // Precondition: the caller is the owner thread, or the owner has exited.
+  bool mergeQueuedShouldDeallocate() {
+    uint16_t biased = loadBiased();
+    storeBiased(biased & ~BIASED_COUNT_MASK);
+    uint32_t delta = uint32_t(biased & BIASED_COUNT_MASK) << RC_FLAGS_COUNT;
+
+    uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    uint32_t newval;
+    do {
+      assert((oldval & RC_QUEUED_FLAG) && "merging an object that is not queued");
+      newval = ((oldval + delta) | RC_MERGED_FLAG) & ~RC_QUEUED_FLAG;
+    } while (!__atomic_compare_exchange(&refCount, &oldval, &newval, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    return shouldStartDeallocating(newval);
+  }
+
+  // Return the owner ID of the object, or 0 if it was never biased.
+  uint16_t getBiasedOwner() const {
+    return loadBiased() >> BIASED_COUNT_BITS;
+  }
+#endif
+
   // Return the reference count.
   // During deallocation the reference count is undefined.
   uint32_t getCount() const {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    int32_t shared = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    return (shared >> RC_FLAGS_COUNT) + (loadBiased() & BIASED_COUNT_MASK);
+#else
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) >> RC_FLAGS_COUNT;
+#endif
   }
 
   // Return whether the reference count is exactly 1.
@@ -173,6 +329,11 @@ class StrongRefCount {
   // Return whether the reference count is exactly 1 or the pin flag
   // is set.  During deallocation the reference count is undefined.
   bool isUniquelyReferencedOrPinned() const {
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    if (__atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_PINNED_FLAG)
+      return true;
+    return isUniquelyReferenced();
+#else
     auto value = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
     // Rotating right by one sets the sign bit to the pinned bit. After
     // rotation, the dealloc flag is the least significant bit followed by the
@@ -185,6 +346,7 @@ class StrongRefCount {
                   "The pinned flag must be the lowest bit");
     auto rotateRightByOne = ((value >> 1) | (value << 31));
     return (int32_t)rotateRightByOne < (int32_t)RC_ONE;
+#endif
   }
 
   // Return true if the object is inside deallocation.
@@ -193,6 +355,91 @@ class StrongRefCount {
   }
 
 private:
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  // HeapObject places the weak reference count directly after this one, and
+  // the biased count is its upper half.
+  uint16_t *getBiasedAddress() const {
+    return reinterpret_cast<uint16_t *>(
+             const_cast<StrongRefCount *>(this) + 1) + 1;
+  }
+
+  // Other threads read the owner ID concurrently with the owner's updates,
+  // so these are relaxed atomic accesses. They compile to plain loads and
+  // stores.
+  uint16_t loadBiased() const {
+    return __atomic_load_n(getBiasedAddress(), __ATOMIC_RELAXED);
+  }
+
+  void storeBiased(uint16_t biased) {
+    __atomic_store_n(getBiasedAddress(), biased, __ATOMIC_RELAXED);
+  }
+
+  // Return true if the current thread owns the object and has not merged
+  // its biased count yet.
+  static bool isBiasedToCurrentThread(uint16_t biased) {
+    return (biased >> BIASED_COUNT_BITS) == _swift_biasedRefCountThreadID &&
+           (biased & BIASED_COUNT_MASK) != 0;
+  }
+
+  // Release n references on the owner thread. References beyond the biased
+  // count come out of the shared count when the biased count is merged.
+  bool doBiasedDecrementShouldDeallocate(uint16_t biased, uint32_t n) {
+    uint32_t count = biased & BIASED_COUNT_MASK;
+    if (n < count) {
+      storeBiased(uint16_t(biased - n));
+      return false;
+    }
+
+    // The biased count drops to zero; merge it. Adding the merged flag
+    // sets it because only this path and mergeQueuedShouldDeallocate set it.
+    storeBiased(biased & ~BIASED_COUNT_MASK);
+    uint32_t delta = RC_MERGED_FLAG - ((n - count) << RC_FLAGS_COUNT);
+    uint32_t newval = __atomic_add_fetch(&refCount, delta, __ATOMIC_RELEASE);
+    return shouldStartDeallocating(newval);
+  }
+
+  // Decide whether to deallocate after the shared count changed to newval.
+  bool shouldStartDeallocating(uint32_t newval) {
+    if (!(newval & RC_MERGED_FLAG)) {
+      // The owner still holds biased references. If the shared count went
+      // negative, the owner has to merge before the object can die.
+      if ((int32_t)newval < 0)
+        requestMerge();
+      return false;
+    }
+
+    if ((newval & (RC_COUNT_MASK | RC_PINNED_FLAG | RC_DEALLOCATING_FLAG |
+                   RC_QUEUED_FLAG)) != 0) {
+      // Refcount is not zero, or the merge of a queued object is pending.
+      return false;
+    }
+
+    // Refcount is now 0 and is not already deallocating.  Try to set
+    // the deallocating flag.  This must be atomic because it can race
+    // with weak retains.
+    //
+    // This also performs the before-deinit acquire barrier if we set the flag.
+    uint32_t oldval = RC_MERGED_FLAG;
+    newval = RC_MERGED_FLAG | RC_DEALLOCATING_FLAG;
+    return __atomic_compare_exchange(&refCount, &oldval, &newval, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+  }
+
+  // Set the queued flag and queue the object on its owner, unless it is
+  // already queued or the owner merged in the meantime.
+  void requestMerge() {
+    uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    while (!(oldval & (RC_MERGED_FLAG | RC_QUEUED_FLAG))) {
+      uint32_t newval = oldval | RC_QUEUED_FLAG;
+      if (__atomic_compare_exchange(&refCount, &oldval, &newval, 0,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        _swift_biasedRefCountQueueMerge(this);
+        return;
+      }
+    }
+  }
+#endif
+
   template <bool ClearPinnedFlag>
   bool doDecrementShouldDeallocate() {
     // If we're being asked to clear the pinned flag, we can assume
@@ -203,6 +450,10 @@ private:
 
     assert((!ClearPinnedFlag || !(newval & RC_PINNED_FLAG)) &&
            "unpinning reference that was not pinned");
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    // The shared count of a biased object may legitimately go negative.
+    return shouldStartDeallocating(newval);
+#else
     assert(newval + quantum >= RC_ONE &&
            "releasing reference with a refcount of zero");
 
@@ -228,6 +479,7 @@ private:
     newval = RC_DEALLOCATING_FLAG;
     return __atomic_compare_exchange(&refCount, &oldval, &newval, 0,
                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+#endif
   }
 
   template <bool ClearPinnedFlag>
@@ -239,6 +491,9 @@ private:
 
     assert((!ClearPinnedFlag || !(newval & RC_PINNED_FLAG)) &&
            "unpinning reference that was not pinned");
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    return shouldStartDeallocating(newval);
+#else
     assert(newval + delta >= RC_ONE &&
            "releasing reference with a refcount of zero");
 
@@ -264,24 +519,39 @@ private:
     newval = RC_DEALLOCATING_FLAG;
     return __atomic_compare_exchange(&refCount, &oldval, &newval, 0,
                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+#endif
   }
 };
 
 
 // Weak reference count.
+//
+// With biased reference counting, the weak reference count only uses the
+// lower half of its word, which limits it to 32767; the upper half is
+// StrongRefCount's biased count.
 
 class WeakRefCount {
-  uint32_t refCount;
+  friend bool tryIncrementStrongAndDecrementWeak(StrongRefCount &strong,
+                                                 WeakRefCount &weak);
 
-  enum : uint32_t {
-    // There isn't really a flag here.
-    // Making weak RC_ONE == strong RC_ONE saves an
-    // instruction in allocation on arm64.
-    RC_UNUSED_FLAG = 1,
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  typedef uint16_t RefCountType;
+  RefCountType refCount;
+  uint16_t biasedRefCount;
+#else
+  typedef uint32_t RefCountType;
+  RefCountType refCount;
+#endif
+
+  enum : RefCountType {
+    // The arena marker: the object's memory belongs to a SwiftArena.
+    // Having a flag here at all is mostly because making weak RC_ONE ==
+    // strong RC_ONE saves an instruction in allocation on arm64.
+    RC_ARENA_FLAG = 1,
 
     RC_FLAGS_COUNT = 1,
     RC_FLAGS_MASK = 1,
-    RC_COUNT_MASK = ~RC_FLAGS_MASK,
+    RC_COUNT_MASK = RefCountType(~RC_FLAGS_MASK),
 
     RC_ONE = RC_FLAGS_MASK + 1
   };
@@ -301,7 +571,11 @@ class WeakRefCount {
   
   // Weak refcount of a new object is 1.
   constexpr WeakRefCount(Initialized_t)
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+    : refCount(RC_ONE), biasedRefCount(0) { }
+#else
     : refCount(RC_ONE) { }
+#endif
 
   void init() {
     refCount = RC_ONE;
@@ -313,17 +587,30 @@ class WeakRefCount {
     refCount = RC_ONE + RC_ONE;
   }
 
+  /// Initialize for an object in a SwiftArena. Like a stack promoted object,
+  /// the final release doesn't free its memory; the arena frees it.
+  void initForArena() {
+    refCount = RC_ONE + RC_ONE + RC_ARENA_FLAG;
+  }
+
+  /// Return true if the object's memory belongs to a SwiftArena.
+  bool isArenaAllocated() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_ARENA_FLAG;
+  }
+
   // Increment the weak reference count.
   void increment() {
-    uint32_t newval = __atomic_add_fetch(&refCount, RC_ONE, __ATOMIC_RELAXED);
+    RefCountType newval =
+      __atomic_add_fetch(&refCount, RC_ONE, __ATOMIC_RELAXED);
     assert(newval >= RC_ONE  &&  "weak refcount overflow");
     (void)newval;
   }
 
   /// Increment the weak reference count by n.
   void increment(uint32_t n) {
-    uint32_t addval = (n << RC_FLAGS_COUNT);
-    uint32_t newval = __atomic_add_fetch(&refCount, addval, __ATOMIC_RELAXED);
+    RefCountType addval = (n << RC_FLAGS_COUNT);
+    RefCountType newval =
+      __atomic_add_fetch(&refCount, addval, __ATOMIC_RELAXED);
     assert(newval >= addval  &&  "weak refcount overflow");
     (void)newval;
   }
@@ -331,7 +618,8 @@ class WeakRefCount {
   // Decrement the weak reference count.
   // Return true if the caller should deallocate the object.
   bool decrementShouldDeallocate() {
-    uint32_t oldval = __atomic_fetch_sub(&refCount, RC_ONE, __ATOMIC_RELAXED);
+    RefCountType oldval =
+      __atomic_fetch_sub(&refCount, RC_ONE, __ATOMIC_RELAXED);
     assert(oldval >= RC_ONE  &&  "weak refcount underflow");
 
     // Should dealloc if count was 1 before decrementing (i.e. it is zero now)
@@ -341,8 +629,9 @@ class WeakRefCount {
   /// Decrement the weak reference count.
   /// Return true if the caller should deallocate the object.
   bool decrementShouldDeallocateN(uint32_t n) {
-    uint32_t subval = (n << RC_FLAGS_COUNT);
-    uint32_t oldval = __atomic_fetch_sub(&refCount, subval, __ATOMIC_RELAXED);
+    RefCountType subval = (n << RC_FLAGS_COUNT);
+    RefCountType oldval =
+      __atomic_fetch_sub(&refCount, subval, __ATOMIC_RELAXED);
     assert(oldval >= subval  &&  "weak refcount underflow");
 
     // Should dealloc if count was subval before decrementing (i.e. it is zero now)
@@ -356,6 +645,44 @@ class WeakRefCount {
   }
 };
 
+// Increment the strong reference count and decrement the weak reference count
+// of an object, e.g. to trade an unowned reference for a strong one.
+// Return false, leaving both counts unchanged, if the object is deallocating.
+//
+// HeapObject keeps the two counts next to each other, so on 64-bit targets
+// this is a single atomic operation on both.
+//
+// Precondition: the weak reference count is greater than one, so that
+// decrementing it never deallocates the object.
+inline bool tryIncrementStrongAndDecrementWeak(StrongRefCount &strong,
+                                               WeakRefCount &weak) {
+#if __LP64__ && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && \
+    !SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  assert(reinterpret_cast<char *>(&weak) ==
+           reinterpret_cast<char *>(&strong) + sizeof(StrongRefCount) &&
+         "reference counts must be adjacent");
+  auto both = reinterpret_cast<uint64_t *>(&strong);
+  const uint64_t delta = uint64_t(StrongRefCount::RC_ONE) -
+                         (uint64_t(WeakRefCount::RC_ONE) << 32);
+  uint64_t oldval = __atomic_fetch_add(both, delta, __ATOMIC_RELAXED);
+  if (uint32_t(oldval) & StrongRefCount::RC_DEALLOCATING_FLAG) {
+    __atomic_fetch_sub(both, delta, __ATOMIC_RELAXED);
+    return false;
+  }
+  assert(((oldval >> 32) & WeakRefCount::RC_COUNT_MASK) >
+           WeakRefCount::RC_ONE &&
+         "trading the last weak reference");
+  return true;
+#else
+  if (!strong.tryIncrement())
+    return false;
+  bool dealloc = weak.decrementShouldDeallocate();
+  assert(!dealloc && "trading the last weak reference");
+  (void) dealloc;
+  return true;
+#endif
+}
+
 static_assert(swift::IsTriviallyConstructible<StrongRefCount>::value,
               "StrongRefCount must be trivially initializable");
 static_assert(swift::IsTriviallyConstructible<WeakRefCount>::value,
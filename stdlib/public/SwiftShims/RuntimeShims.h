@@ -61,6 +61,18 @@ int _swift_stdlib_putc_stderr(int C);
 
 __swift_size_t _swift_stdlib_getHardwareConcurrency();
 
+/// Return the factor, in percent, by which arrays grow when they run out of
+/// capacity.  This is 200 unless the SWIFT_ARRAY_GROWTH_PERCENT environment
+/// variable sets it to a value from 110 to 400.
+__swift_size_t _swift_stdlib_getArrayGrowthPercent();
+
+/// Call Work(Context, I) for every I in [0, Iterations), on up to
+/// Iterations threads at the same time, and return once all calls have
+/// returned.
+void _swift_stdlib_concurrentPerform(
+  __swift_size_t Iterations, void *Context,
+  void (*Work)(void *Context, __swift_size_t Index));
+
 #ifdef __cplusplus
 }} // extern "C", namespace swift
 #endif
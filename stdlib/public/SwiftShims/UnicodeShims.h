@@ -65,6 +65,16 @@ __swift_intptr_t _swift_stdlib_unicode_hash(
 __swift_intptr_t _swift_stdlib_unicode_hash_ascii(
   const char *Str, __swift_int32_t Length);
 
+/// Return the number of code units at the start of the given UTF-8 string
+/// that are ASCII.
+__swift_intptr_t _swift_stdlib_countLeadingASCII_utf8(
+  const __swift_uint8_t *Str, __swift_intptr_t Length);
+
+/// Return the number of code units at the start of the given UTF-16 string
+/// that are ASCII.
+__swift_intptr_t _swift_stdlib_countLeadingASCII_utf16(
+  const __swift_uint16_t *Str, __swift_intptr_t Length);
+
 __swift_int32_t _swift_stdlib_unicode_strToUpper(
   __swift_uint16_t *Destination, __swift_int32_t DestinationCapacity,
   const __swift_uint16_t *Source, __swift_int32_t SourceLength);
@@ -51,7 +51,13 @@ internal struct _ArrayBody {
   /// The number of elements that can be stored in this Array without
   /// reallocation.
   var capacity: Int {
-    return Int(_capacityAndFlags >> 1)
+    get {
+      return Int(_capacityAndFlags >> 1)
+    }
+    set {
+      _sanityCheck(newValue >= 0)
+      _capacityAndFlags = (UInt(newValue) << 1) | (_capacityAndFlags & 1)
+    }
   }
 
   /// Is the Element type bitwise-compatible with some Objective-C
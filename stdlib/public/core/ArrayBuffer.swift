@@ -142,6 +142,15 @@ extension _ArrayBuffer {
     return nil
   }
 
+  @warn_unused_result
+  public mutating func _tryReallocateUniqueBuffer(minimumCapacity: Int)
+    -> Bool
+  {
+    // The storage is held in a bridge object, which can't adopt a moved
+    // buffer without a retain and release.
+    return false
+  }
+
   @warn_unused_result
   public mutating func isMutableAndUniquelyReferenced() -> Bool {
     return isUniquelyReferenced()
@@ -47,6 +47,13 @@ public protocol _ArrayBufferType : MutableCollectionType {
   mutating func requestUniqueMutableBackingBuffer(minimumCapacity: Int)
     -> _ContiguousArrayBuffer<Element>?
 
+  /// Grow the uniquely referenced storage of `self` to hold at least
+  /// `minimumCapacity` elements by resizing the allocation, rather than by
+  /// copying the elements to a new buffer.  Return `false`, leaving `self`
+  /// unchanged, if the storage or its elements can't be handled that way.
+  @warn_unused_result
+  mutating func _tryReallocateUniqueBuffer(minimumCapacity: Int) -> Bool
+
   /// Returns true iff this buffer is backed by a uniquely-referenced mutable
   /// _ContiguousArrayBuffer.
   ///
@@ -47,6 +47,13 @@ public struct Character :
     _representation = .Small(Builtin.trunc_Int64_Int63(asInt._value))
   }
 
+  /// Construct a `Character` containing just the given ASCII code unit.
+  internal init(_asciiCodeUnit u: UInt8) {
+    _sanityCheck(u < 0x80, "not an ASCII code unit")
+    _representation = .Small(
+      Builtin.trunc_Int64_Int63((UInt64(u) | ((~0) << 8))._value))
+  }
+
   @effects(readonly)
   public init(_builtinUnicodeScalarLiteral value: Builtin.Int32) {
     self = Character(
@@ -281,6 +288,11 @@ extension String {
     switch c._representation {
     case let .Small(_63bits):
       let value = Character._smallValue(_63bits)
+      if _fastPath(
+        Bool(Builtin.cmp_uge_Int63(_63bits, _minASCIICharReprBuiltin))) {
+        self = String(_StringCore(_singleASCII: UTF8.CodeUnit(value & 0x7f)))
+        return
+      }
       let smallUTF8 = Character._SmallUTF8(value)
       self = String._fromWellFormedCodeUnitSequence(
         UTF8.self, input: smallUTF8)
@@ -297,6 +297,23 @@ public struct _ContiguousArrayBuffer<Element> : _ArrayBufferType {
     return nil
   }
 
+  @warn_unused_result
+  public mutating func _tryReallocateUniqueBuffer(minimumCapacity: Int)
+    -> Bool
+  {
+    _sanityCheck(isUniquelyReferenced())
+    // Only trivial elements can be moved with their bytes.  Empty buffers
+    // share the statically allocated empty array storage.
+    if !_isPOD(Element.self) || capacity == 0 {
+      return false
+    }
+    if !__bufferPointer._reallocate(minimumCapacity) {
+      return false
+    }
+    __bufferPointer.value.capacity = __bufferPointer.allocatedElementCount
+    return true
+  }
+
   @warn_unused_result
   public mutating func isMutableAndUniquelyReferenced() -> Bool {
     return isUniquelyReferenced()
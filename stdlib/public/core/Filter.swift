@@ -69,6 +69,17 @@ public struct LazyFilterSequence<Base : SequenceType>
       base.generate(), whereElementsSatisfy: _include)
   }
 
+  public func _forEachWhile(
+    @noescape body: (Base.Generator.Element) throws -> Bool
+  ) rethrows -> Bool {
+    return try base._forEachWhile {
+      if !_include($0) {
+        return true
+      }
+      return try body($0)
+    }
+  }
+
   /// Creates an instance consisting of the elements `x` of `base` for
   /// which `predicate(x) == true`.
   public init(
@@ -220,6 +231,17 @@ public struct LazyFilterCollection<
       _base.generate(), whereElementsSatisfy: _predicate)
   }
 
+  public func _forEachWhile(
+    @noescape body: (Base.Generator.Element) throws -> Bool
+  ) rethrows -> Bool {
+    return try _base._forEachWhile {
+      if !_predicate($0) {
+        return true
+      }
+      return try body($0)
+    }
+  }
+
   var _base: Base
   var _predicate: (Base.Generator.Element)->Bool
 }
@@ -42,8 +42,9 @@ struct _HashingDetail {
   @_transparent
   @warn_unused_result
   static func getExecutionSeed() -> UInt64 {
-    // FIXME: This needs to be a per-execution seed. This is just a placeholder
-    // implementation.
+    // The seed is fixed unless the SWIFT_HASHING_SEED environment variable
+    // overrides it, possibly with a per-execution random seed.  See
+    // initializeHashingSeed() in Stubs.cpp.
     let seed: UInt64 = 0xff51afd7ed558ccd
     return _HashingDetail.fixedSeedOverride == 0 ? seed : fixedSeedOverride
   }
@@ -132,6 +133,22 @@ func _mixInt(value: Int) -> Int {
 #endif
 }
 
+/// Returns a hash value that combines `hashValue` into `seed`.
+///
+/// Unlike combining hash values with `^`, the result depends on the order in
+/// which values are combined, and equal values do not cancel each other out.
+/// The compiler uses this function to derive `hashValue` for structs.
+@_transparent
+@warn_unused_result
+public // COMPILER_INTRINSIC
+func _combineHashValues(seed: Int, _ hashValue: Int) -> Int {
+  // Based on the golden ratio, as in boost::hash_combine.
+  let magic: UInt = 0x9e3779b9
+  var x = UInt(bitPattern: seed)
+  x ^= UInt(bitPattern: hashValue) &+ magic &+ (x << 6) &+ (x >> 2)
+  return Int(bitPattern: x)
+}
+
 /// Given a hash value, returns an integer value within the given range that
 /// corresponds to a hash value.
 ///
@@ -18,6 +18,35 @@ typealias _HeapObject = SwiftShims.HeapObject
 func _swift_bufferAllocate(
   bufferType: AnyClass, _ size: Int, _ alignMask: Int) -> AnyObject
 
+/// Resize `object`, which was returned by `_swift_bufferAllocate`, to `size`
+/// bytes, keeping its first `oldSize` bytes.  Consumes `object` and returns
+/// the resized object, which may be at a new address; returns `object`
+/// unchanged if it isn't uniquely referenced.
+@warn_unused_result
+@_silgen_name("swift_bufferReallocate")
+func _swift_bufferReallocate(
+  object: Builtin.NativeObject, _ oldSize: Int, _ size: Int, _ alignMask: Int
+) -> Builtin.NativeObject
+
+@warn_unused_result
+@_silgen_name("swift_arenaCreate")
+func _swift_arenaCreate(blockSize: Int) -> COpaquePointer
+
+@_silgen_name("swift_arenaDestroy")
+func _swift_arenaDestroy(arena: COpaquePointer)
+
+@warn_unused_result
+@_silgen_name("swift_arenaAllocObject")
+func _swift_arenaAllocObject(
+  arena: COpaquePointer, _ bufferType: AnyClass, _ size: Int, _ alignMask: Int
+) -> AnyObject
+
+/// Return the number of usable bytes of the object at `address`, which was
+/// returned by `_swift_bufferAllocate` or `_swift_arenaAllocObject`.
+@warn_unused_result
+@_silgen_name("swift_bufferAllocatedSize")
+func _swift_bufferAllocatedSize(address: UnsafePointer<UInt8>) -> Int
+
 /// A class containing an ivar "value" of type Value, and
 /// containing storage for an array of Element whose size is
 /// determined at create time.
@@ -98,6 +98,18 @@ extension LazyCollection : SequenceType {
   ) -> Bool? { 
     return _base._customContainsEquatableElement(element)
   }
+
+  public func _forEachWhile(
+    @noescape body: (Base.Generator.Element) throws -> Bool
+  ) rethrows -> Bool {
+    return try _base._forEachWhile(body)
+  }
+
+  public func _withContiguousStorageIfAvailable<R>(
+    @noescape body: (UnsafeBufferPointer<Base.Generator.Element>) throws -> R
+  ) rethrows -> R? {
+    return try _base._withContiguousStorageIfAvailable(body)
+  }
 }
 
 extension LazyCollection : CollectionType {
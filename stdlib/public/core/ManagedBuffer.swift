@@ -110,6 +110,26 @@ public class ManagedBuffer<Value, Element>
     return unsafeDowncast(p.buffer)
   }
 
+  /// Create a new instance of the most-derived class in `arena`, calling
+  /// `initializeValue` on the partially-constructed object to
+  /// generate an initial `Value`.
+  ///
+  /// - Requires: The instance is deallocated before `arena` is.
+  public final class func create(
+    minimumCapacity: Int,
+    arena: ManagedBufferArena,
+    initialValue: (ManagedProtoBuffer<Value,Element>)->Value
+  ) -> ManagedBuffer<Value,Element> {
+
+    let p = ManagedBufferPointer<Value,Element>(
+      bufferClass: self,
+      minimumCapacity: minimumCapacity,
+      arena: arena,
+      initialValue: { buffer, _ in initialValue(unsafeDowncast(buffer)) })
+
+    return unsafeDowncast(p.buffer)
+  }
+
   /// Destroy the stored Value.
   deinit {
     ManagedBufferPointer(self).withUnsafeMutablePointerToValue { $0.destroy() }
@@ -126,6 +146,32 @@ public class ManagedBuffer<Value, Element>
   }
 }
 
+/// A region of memory for `ManagedBuffer`s that are deallocated en masse.
+///
+/// Allocating a buffer in an arena mostly just advances a pointer, and
+/// deallocating it only runs its `deinit`: the memory of all the buffers in
+/// the arena is freed at once, when the arena is deallocated.  This suits
+/// many short-lived buffers whose lifetimes end at a known point, such as
+/// the buffers that are created while handling one request.
+///
+/// - Requires: Every buffer that was allocated in the arena is deallocated,
+///   and not referenced weakly or `unowned`, before the arena is.  An arena
+///   is only used by one thread at a time.
+public final class ManagedBufferArena {
+  /// Create an arena that allocates memory in blocks of `blockSize` bytes.
+  /// Buffers that don't fit in half a block get a block of their own.
+  public init(blockSize: Int = 64 * 1024) {
+    _precondition(blockSize > 0, "ManagedBufferArena needs a positive block size")
+    _arena = _swift_arenaCreate(blockSize)
+  }
+
+  deinit {
+    _swift_arenaDestroy(_arena)
+  }
+
+  internal let _arena: COpaquePointer
+}
+
 /// Contains a buffer object, and provides access to an instance of
 /// `Value` and contiguous storage for an arbitrary number of
 /// `Element` instances stored in that buffer.
@@ -184,8 +230,40 @@ public struct ManagedBufferPointer<Value, Element> : Equatable {
     initialValue: (buffer: AnyObject, allocatedCount: (AnyObject)->Int)->Value
   ) {
     self = ManagedBufferPointer(bufferClass: bufferClass, minimumCapacity: minimumCapacity)
+    _initializeValue(initialValue)
+  }
+
+  /// Create with new storage in `arena` containing an initial `Value` and
+  /// space for at least `minimumCapacity` `element`s.
+  ///
+  /// The parameters are the same as for
+  /// `init(bufferClass:minimumCapacity:initialValue:)`.
+  ///
+  /// - Requires: The buffer is deallocated before `arena` is.
+  public init(
+    bufferClass: AnyClass,
+    minimumCapacity: Int,
+    arena: ManagedBufferArena,
+    initialValue: (buffer: AnyObject, allocatedCount: (AnyObject)->Int)->Value
+  ) {
+    ManagedBufferPointer._checkValidBufferClass(bufferClass, creating: true)
+    _precondition(
+      minimumCapacity >= 0,
+      "ManagedBufferPointer must have non-negative capacity")
+
+    let totalSize = _My._elementOffset
+      +  minimumCapacity * strideof(Element.self)
 
-    // initialize the value field
+    let newBuffer: AnyObject = _swift_arenaAllocObject(
+      arena._arena, bufferClass, totalSize, _My._alignmentMask)
+
+    self._nativeBuffer = Builtin.castToNativeObject(newBuffer)
+    _initializeValue(initialValue)
+  }
+
+  internal func _initializeValue(
+    initialValue: (buffer: AnyObject, allocatedCount: (AnyObject)->Int)->Value
+  ) {
     withUnsafeMutablePointerToValue {
       $0.initialize(
         initialValue(
@@ -351,6 +429,32 @@ public struct ManagedBufferPointer<Value, Element> : Equatable {
     _nativeBuffer = Builtin.castToNativeObject(buffer)
   }
 
+  /// Resize the storage to hold at least `minimumCapacity` elements, in
+  /// place if the allocator can grow it, and by moving its bytes otherwise.
+  ///
+  /// Returns `false`, leaving `self` unchanged, if the storage is referenced
+  /// from anywhere else.
+  ///
+  /// - Requires: `Value` and `Element` are trivial types, so that moving
+  ///   their bytes moves them.
+  @warn_unused_result
+  internal mutating func _reallocate(minimumCapacity: Int) -> Bool {
+    _sanityCheck(_isPOD(Value.self) && _isPOD(Element.self))
+    let totalSize = _My._elementOffset
+      +  minimumCapacity * strideof(Element.self)
+
+    // Hand our reference to the runtime without retaining it, and adopt the
+    // one it returns without releasing the old one, which it has consumed.
+    let oldSize = _allocatedByteCount
+    let address = Builtin.addressof(&_nativeBuffer)
+    let oldBuffer: Builtin.NativeObject = Builtin.take(address)
+    Builtin.initialize(
+      _swift_bufferReallocate(
+        oldBuffer, oldSize, totalSize, _My._alignmentMask),
+      address)
+    return allocatedElementCount >= minimumCapacity
+  }
+
   internal typealias _My = ManagedBufferPointer
 
   internal static func _checkValidBufferClass(
@@ -396,7 +500,7 @@ public struct ManagedBufferPointer<Value, Element> : Equatable {
 
   /// The actual number of bytes allocated for this object.
   internal var _allocatedByteCount: Int {
-    return _swift_stdlib_malloc_size(_address)
+    return _swift_bufferAllocatedSize(_address)
   }
 
   /// The address of this instance in a convenient pointer-to-bytes form
@@ -59,6 +59,12 @@ public struct LazyMapSequence<Base : SequenceType, Element>
     return _base.underestimateCount()
   }
 
+  public func _forEachWhile(
+    @noescape body: (Element) throws -> Bool
+  ) rethrows -> Bool {
+    return try _base._forEachWhile { try body(_transform($0)) }
+  }
+
   /// Create an instance with elements `transform(x)` for each element
   /// `x` of base.
   public init(_ base: Base, transform: (Base.Generator.Element)->Element) {
@@ -113,6 +119,12 @@ public struct LazyMapCollection<Base : CollectionType, Element>
     return _base.underestimateCount()
   }
 
+  public func _forEachWhile(
+    @noescape body: (Element) throws -> Bool
+  ) rethrows -> Bool {
+    return try _base._forEachWhile { try body(_transform($0)) }
+  }
+
   /// Returns the number of elements.
   ///
   /// - Complexity: O(1) if `Index` conforms to `RandomAccessIndexType`;
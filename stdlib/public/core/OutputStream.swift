@@ -252,11 +252,33 @@ internal struct _Stdout : OutputStreamType {
   }
 
   mutating func write(string: String) {
-    // FIXME: buffering?
     // It is important that we use stdio routines in order to correctly
-    // interoperate with stdio buffering.
-    for c in string.utf8 {
-      _swift_stdlib_putchar(Int32(c))
+    // interoperate with stdio buffering.  They buffer the output, so what
+    // matters here is handing it over in as few calls as possible.
+    let core = string._core
+    if _fastPath(core.hasContiguousStorage && core.isASCII) {
+      _swift_stdlib_fwrite_stdout(core.startASCII, 1, core.count)
+      _fixLifetime(core)
+      return
+    }
+
+    // Transcode to UTF-8 in chunks.
+    var chunk: (UInt64, UInt64, UInt64, UInt64, UInt64, UInt64, UInt64, UInt64)
+      = (0, 0, 0, 0, 0, 0, 0, 0)
+    let chunkSize = sizeofValue(chunk)
+    withUnsafeMutablePointer(&chunk) {
+      (chunkPointer) -> Void in
+      let bytes = UnsafeMutablePointer<UInt8>(chunkPointer)
+      var used = 0
+      for c in string.utf8 {
+        if used == chunkSize {
+          _swift_stdlib_fwrite_stdout(bytes, 1, used)
+          used = 0
+        }
+        bytes[used] = c
+        used += 1
+      }
+      _swift_stdlib_fwrite_stdout(bytes, 1, used)
     }
   }
 }
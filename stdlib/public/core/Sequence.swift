@@ -191,6 +191,26 @@ public protocol SequenceType {
   /// `nil`.
   func _preprocessingPass<R>(preprocess: (Self)->R) -> R?
 
+  /// Call `body` on each element in `self`, in order, until it returns
+  /// `false`.  Return `false` iff `body` did.
+  ///
+  /// Lazy adaptors such as `LazyMapSequence` implement this by calling
+  /// their base's `_forEachWhile` with a `body` that applies their own
+  /// operation, so that iterating a chain of them is a single loop over
+  /// the innermost base, even where the chain isn't specialized.
+  func _forEachWhile(
+    @noescape body: (Generator.Element) throws -> Bool
+  ) rethrows -> Bool
+
+  /// If the elements of `self` are stored contiguously, invoke `body` on a
+  /// buffer pointer to them and return its result.  Otherwise, return
+  /// `nil`.
+  ///
+  /// The buffer is only valid for the duration of the call.
+  func _withContiguousStorageIfAvailable<R>(
+    @noescape body: (UnsafeBufferPointer<Generator.Element>) throws -> R
+  ) rethrows -> R?
+
   /// Create a native array buffer containing the elements of `self`,
   /// in the same order.
   func _copyToNativeArrayBuffer() -> _ContiguousArrayBuffer<Generator.Element>
@@ -520,6 +540,36 @@ extension SequenceType {
     return nil
   }
 
+  public func _forEachWhile(
+    @noescape body: (Generator.Element) throws -> Bool
+  ) rethrows -> Bool {
+    let contiguousResult: Bool? = try _withContiguousStorageIfAvailable {
+      (buffer: UnsafeBufferPointer<Generator.Element>) -> Bool in
+      for element in buffer {
+        if !(try body(element)) {
+          return false
+        }
+      }
+      return true
+    }
+    if let result = contiguousResult {
+      return result
+    }
+
+    for element in self {
+      if !(try body(element)) {
+        return false
+      }
+    }
+    return true
+  }
+
+  public func _withContiguousStorageIfAvailable<R>(
+    @noescape body: (UnsafeBufferPointer<Generator.Element>) throws -> R
+  ) rethrows -> R? {
+    return nil
+  }
+
   @warn_unused_result
   public func _customContainsEquatableElement(
     element: Generator.Element
@@ -552,8 +602,9 @@ extension SequenceType {
   public func forEach(
     @noescape body: (Generator.Element) throws -> Void
   ) rethrows {
-    for element in self {
-      try body(element)
+    try _forEachWhile {
+      try body($0)
+      return true
     }
   }
 }
@@ -65,6 +65,18 @@ extension SequenceType
     return _base._preprocessingPass { _ in preprocess(self) }
   }
 
+  public func _forEachWhile(
+    @noescape body: (Base.Generator.Element) throws -> Bool
+  ) rethrows -> Bool {
+    return try _base._forEachWhile(body)
+  }
+
+  public func _withContiguousStorageIfAvailable<R>(
+    @noescape body: (UnsafeBufferPointer<Base.Generator.Element>) throws -> R
+  ) rethrows -> R? {
+    return try _base._withContiguousStorageIfAvailable(body)
+  }
+
   /// Create a native array buffer containing the elements of `self`,
   /// in the same order.
   public func _copyToNativeArrayBuffer()
@@ -141,6 +153,18 @@ extension CollectionType
     return _base._preprocessingPass { _ in preprocess(self) }
   }
 
+  public func _forEachWhile(
+    @noescape body: (Base.Generator.Element) throws -> Bool
+  ) rethrows -> Bool {
+    return try _base._forEachWhile(body)
+  }
+
+  public func _withContiguousStorageIfAvailable<R>(
+    @noescape body: (UnsafeBufferPointer<Base.Generator.Element>) throws -> R
+  ) rethrows -> R? {
+    return try _base._withContiguousStorageIfAvailable(body)
+  }
+
   /// Create a native array buffer containing the elements of `self`,
   /// in the same order.
   public func _copyToNativeArrayBuffer()
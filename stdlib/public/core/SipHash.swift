@@ -0,0 +1,177 @@
+//===--- SipHash.swift - A streaming keyed hash function ------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements SipHash-1-3, a keyed hash function by Jean-Philippe
+// Aumasson and Daniel J. Bernstein, with one compression round per 8-byte
+// block and three finalization rounds.
+//
+// Unlike the _mix*() functions, which scramble a single word, the hasher
+// accepts an arbitrary amount of input, so that a `Hashable` conformance can
+// feed all of its significant parts through one hasher.  When the key is
+// secret, as with a randomized execution seed, it is hard to construct
+// inputs whose hash values collide.
+//
+
+/// A streaming SipHash-1-3 hasher.
+///
+/// The result only depends on the sequence of bytes that were appended, not
+/// on how they were split between calls.  Multi-byte integers are appended
+/// in little-endian byte order on every platform.
+public // @testable
+struct _SipHash13 {
+  internal var _v0: UInt64
+  internal var _v1: UInt64
+  internal var _v2: UInt64
+  internal var _v3: UInt64
+
+  /// The bytes of the current, incomplete block, starting in the low byte.
+  internal var _tail: UInt64 = 0
+
+  /// The number of bytes appended so far.
+  internal var _byteCount: Int = 0
+
+  /// Create a hasher that is keyed with the per-execution seed.
+  public init() {
+    self.init(key: _HashingDetail.getExecutionSipHashKey())
+  }
+
+  /// Create a hasher with the given 128-bit key.
+  public init(key: (UInt64, UInt64)) {
+    _v0 = key.0 ^ 0x736f6d6570736575
+    _v1 = key.1 ^ 0x646f72616e646f6d
+    _v2 = key.0 ^ 0x6c7967656e657261
+    _v3 = key.1 ^ 0x7465646279746573
+  }
+
+  @_transparent
+  @warn_unused_result
+  internal static func _rotateLeft(x: UInt64, _ amount: UInt64) -> UInt64 {
+    return (x << amount) | (x >> (64 - amount))
+  }
+
+  internal mutating func _round() {
+    _v0 = _v0 &+ _v1
+    _v1 = _SipHash13._rotateLeft(_v1, 13)
+    _v1 ^= _v0
+    _v0 = _SipHash13._rotateLeft(_v0, 32)
+    _v2 = _v2 &+ _v3
+    _v3 = _SipHash13._rotateLeft(_v3, 16)
+    _v3 ^= _v2
+    _v0 = _v0 &+ _v3
+    _v3 = _SipHash13._rotateLeft(_v3, 21)
+    _v3 ^= _v0
+    _v2 = _v2 &+ _v1
+    _v1 = _SipHash13._rotateLeft(_v1, 17)
+    _v1 ^= _v2
+    _v2 = _SipHash13._rotateLeft(_v2, 32)
+  }
+
+  internal mutating func _compress(block: UInt64) {
+    _v3 ^= block
+    _round()
+    _v0 ^= block
+  }
+
+  internal mutating func _appendByte(byte: UInt8) {
+    _tail |= UInt64(byte) << UInt64((_byteCount & 7) &* 8)
+    _byteCount += 1
+    if _byteCount & 7 == 0 {
+      _compress(_tail)
+      _tail = 0
+    }
+  }
+
+  /// Append the eight bytes of `value`.
+  public mutating func append(value: UInt64) {
+    let offset = UInt64((_byteCount & 7) &* 8)
+    _byteCount += 8
+    if _fastPath(offset == 0) {
+      _compress(value)
+      return
+    }
+    _compress(_tail | (value << offset))
+    _tail = value >> (64 - offset)
+  }
+
+  /// Append the bytes of `value`.
+  public mutating func append(value: Int) {
+    append(UInt64(bitPattern: Int64(value)))
+  }
+
+  /// Append the `count` bytes starting at `start`.
+  public mutating func appendBytes(start: UnsafePointer<UInt8>, count: Int) {
+    _precondition(count >= 0, "can't append a negative number of bytes")
+    var p = start
+    var remaining = count
+
+    // Complete the current block first, so that the rest of the input can be
+    // compressed directly, eight bytes at a time.
+    while remaining != 0 && _byteCount & 7 != 0 {
+      _appendByte(p.memory)
+      p += 1
+      remaining -= 1
+    }
+    while remaining >= 8 {
+      var block: UInt64 = 0
+      _memcpy(
+        dest: UnsafeMutablePointer(Builtin.addressof(&block)),
+        src: UnsafeMutablePointer(p),
+        size: 8)
+      _compress(UInt64(littleEndian: block))
+      _byteCount += 8
+      p += 8
+      remaining -= 8
+    }
+    while remaining != 0 {
+      _appendByte(p.memory)
+      p += 1
+      remaining -= 1
+    }
+  }
+
+  /// Append the bytes in `buffer`.
+  public mutating func appendBytes(buffer: UnsafeBufferPointer<UInt8>) {
+    appendBytes(buffer.baseAddress, count: buffer.count)
+  }
+
+  /// Return the hash value of the bytes that were appended.
+  ///
+  /// The hasher must not be used afterwards.
+  @warn_unused_result
+  public mutating func finalize() -> UInt64 {
+    _compress(_tail | (UInt64(_byteCount) << 56))
+    _v2 ^= 0xff
+    _round()
+    _round()
+    _round()
+    return _v0 ^ _v1 ^ _v2 ^ _v3
+  }
+}
+
+extension _HashingDetail {
+  /// The SipHash key that is derived from the per-execution seed.
+  @warn_unused_result
+  static func getExecutionSipHashKey() -> (UInt64, UInt64) {
+    let seed = getExecutionSeed()
+    return (seed, hash16Bytes(seed, 0x6a09e667f3bcc908))
+  }
+}
+
+/// Return the SipHash-1-3 hash value of the `count` bytes starting at
+/// `start`, keyed with the per-execution seed.
+@warn_unused_result
+public // @testable
+func _hashBytes(start: UnsafePointer<UInt8>, count: Int) -> Int {
+  var hasher = _SipHash13()
+  hasher.appendBytes(start, count: count)
+  return Int(truncatingBitPattern: hasher.finalize())
+}
@@ -159,6 +159,15 @@ struct _SliceBuffer<Element> : _ArrayBufferType {
     return nil
   }
 
+  @warn_unused_result
+  public mutating func _tryReallocateUniqueBuffer(minimumCapacity: Int)
+    -> Bool
+  {
+    // A slice points into the middle of its storage, so moving the storage
+    // would leave it dangling.
+    return false
+  }
+
   @warn_unused_result
   public mutating func isMutableAndUniquelyReferenced() -> Bool {
     return _hasNativeBuffer && isUniquelyReferenced()
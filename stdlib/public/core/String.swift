@@ -119,6 +119,19 @@ public struct String {
   var _core: _StringCore
 }
 
+/// Returns the number of code units in `string` if it is stored as
+/// contiguous ASCII, or -1 otherwise.
+///
+/// Two ASCII strings can only be equal if they have the same length. The
+/// compiler uses this to narrow down the raw values a derived
+/// `init?(rawValue:)` compares against for enums with ASCII `String` raw
+/// values.
+@warn_unused_result
+public // COMPILER_INTRINSIC
+func _stringContiguousASCIICount(string: String) -> Int {
+  return string._core.isASCII ? string._core.count : -1
+}
+
 extension String {
   @warn_unused_result
   public // @testable
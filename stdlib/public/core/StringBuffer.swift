@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+import SwiftShims
+
 struct _StringBufferIVars {
   init(_ elementWidth: Int) {
     _sanityCheck(elementWidth == 1 || elementWidth == 2)
@@ -90,6 +92,22 @@ public struct _StringBuffer {
     encoding: Encoding.Type, input: Input, repairIllFormedSequences: Bool,
     minimumCapacity: Int = 0
   ) -> (_StringBuffer?, hadError: Bool) {
+    // Contiguous ASCII input can be copied without decoding.
+    if let utf8 = input as? UnsafeBufferPointer<UTF8.CodeUnit>
+    where encoding == UTF8.self &&
+      _swift_stdlib_countLeadingASCII_utf8(utf8.baseAddress, utf8.count)
+        == utf8.count {
+      let result = _StringBuffer(
+          capacity: max(utf8.count, minimumCapacity),
+          initialSize: utf8.count,
+          elementWidth: 1)
+      _memcpy(
+        dest: UnsafeMutablePointer(result.start),
+        src: UnsafeMutablePointer(utf8.baseAddress),
+        size: UInt(utf8.count))
+      return (result, false)
+    }
+
     // Determine how many UTF-16 code units we'll need
     let inputStream = input.generate()
     guard let (utf16Count, isAscii) = UTF16.measure(encoding, input: inputStream,
@@ -136,6 +136,26 @@ extension String.CharacterView : CollectionType {
       }
 
       let startIndexUTF16 = start._position
+
+      // Fast path: every scalar below U+0300 has a grapheme cluster break
+      // property of Control, CR, LF or Any, so an ASCII scalar followed by
+      // such a scalar is a cluster of its own unless it is CR followed by
+      // LF.  This avoids the trie lookups for ASCII text.
+      let core = start._core
+      let u0 = core[startIndexUTF16]
+      if _fastPath(u0 < 0x80) {
+        if startIndexUTF16 + 1 == end._position {
+          return 1
+        }
+        let u1 = core[startIndexUTF16 + 1]
+        if u0 == 0x0d /* CR */ {
+          return u1 == 0x0a /* LF */ ? 2 : 1
+        }
+        if _fastPath(u1 < 0x300) {
+          return 1
+        }
+      }
+
       let unicodeScalars = UnicodeScalarView(start._core)
       let graphemeClusterBreakProperty =
           _UnicodeGraphemeClusterBreakPropertyTrie()
@@ -175,6 +195,19 @@ extension String.CharacterView : CollectionType {
       }
 
       let endIndexUTF16 = end._position
+
+      // Fast path: no scalar extends the cluster of its predecessor when it
+      // is ASCII, except for LF after CR.
+      let core = end._core
+      let u1 = core[endIndexUTF16 - 1]
+      if _fastPath(u1 < 0x80) {
+        if u1 == 0x0a /* LF */ && endIndexUTF16 - 1 != start._position
+            && core[endIndexUTF16 - 2] == 0x0d /* CR */ {
+          return 2
+        }
+        return 1
+      }
+
       let unicodeScalars = UnicodeScalarView(start._core)
       let graphemeClusterBreakProperty =
           _UnicodeGraphemeClusterBreakPropertyTrie()
@@ -228,6 +261,17 @@ extension String.CharacterView : CollectionType {
   /// - Requires: `position` is a valid position in `self` and
   ///   `position != endIndex`.
   public subscript(i: Index) -> Character {
+    // A single UTF-16 code unit that is not a surrogate is a complete
+    // scalar; build the character from it without forming a `String`.
+    if i._lengthUTF16 == 1 {
+      let u = _core[i._utf16Index]
+      if _fastPath(u < 0x80) {
+        return Character(_asciiCodeUnit: UInt8(truncatingBitPattern: u))
+      }
+      if !UTF16.isLeadSurrogate(u) && !UTF16.isTrailSurrogate(u) {
+        return Character(UnicodeScalar(u))
+      }
+    }
     return Character(String(unicodeScalars[i._base..<i._endBase]))
   }
 
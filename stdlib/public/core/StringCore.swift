@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+import SwiftShims
+
 /// The core implementation of a highly-optimizable String that
 /// can store both ASCII and UTF-16, and can wrap native Swift
 /// _StringBuffer or NSString instances.
@@ -182,6 +184,24 @@ public struct _StringCore {
     _invariantCheck()
   }
 
+  /// Create the implementation of a string holding the single ASCII
+  /// character `c`.
+  ///
+  /// The string points at statically-allocated storage and has no owner,
+  /// like a string literal, so it costs no allocation or reference
+  /// counting.  It is copied into a native buffer when it is mutated.
+  init(_singleASCII c: UTF8.CodeUnit) {
+    _sanityCheck(c <= 0x7f, "not an ASCII character")
+    let strings = UnsafeMutablePointer<UTF8.CodeUnit>(
+      Builtin.addressof(&_swiftASCIICharacterStrings))
+    self = _StringCore(
+      baseAddress: COpaquePointer(strings + (Int(c) << 1)),
+      count: 1,
+      elementShift: 0,
+      hasCocoaBuffer: false,
+      owner: nil)
+  }
+
   //===--------------------------------------------------------------------===//
   // Properties
 
@@ -552,11 +572,8 @@ public struct _StringCore {
     if _fastPath(elementWidth == 1) {
       return true
     }
-    let unsafeBuffer =
-      UnsafeBufferPointer(
-        start: UnsafeMutablePointer<UTF16.CodeUnit>(_baseAddress),
-        count: count)
-    return !unsafeBuffer.contains { $0 > 0x7f }
+    return _swift_stdlib_countLeadingASCII_utf16(
+      UnsafeMutablePointer<UTF16.CodeUnit>(_baseAddress), count) == count
   }
 }
 
@@ -82,6 +82,54 @@ extension _StringCore {
     return _transcodeSomeUTF16AsUTF8(storage, i)
   }
 #endif
+
+  /// Returns the number of UTF-8 code units that `_encodeSomeUTF8` produces
+  /// for the code units in `subRange`, which must start and end on Unicode
+  /// scalar boundaries.
+  ///
+  /// - Requires: the storage is contiguous.
+  @warn_unused_result
+  func _utf8Count(subRange: Range<Int>) -> Int {
+    _sanityCheck(subRange.endIndex <= count)
+    _sanityCheck(!_baseAddress._isNull)
+
+    if _fastPath(elementWidth == 1) {
+      return subRange.endIndex - subRange.startIndex
+    }
+
+    var result = 0
+    var i = subRange.startIndex
+    while i < subRange.endIndex {
+      let (utf8Count, utf16Count) = _measureContiguousUTF16ScalarAsUTF8(i)
+      result += utf8Count
+      i += utf16Count
+    }
+    return result
+  }
+
+  /// Returns the number of UTF-8 and UTF-16 code units of the Unicode
+  /// scalar that starts at `i` in contiguous UTF-16 storage.
+  @warn_unused_result
+  func _measureContiguousUTF16ScalarAsUTF8(i: Int) -> (Int, Int) {
+    _sanityCheck(elementWidth == 2)
+    _sanityCheck(!_baseAddress._isNull)
+    _sanityCheck(i < count)
+
+    let u = startUTF16[i]
+    if _fastPath(u < 0x80) {
+      return (1, 1)
+    }
+    if u < 0x800 {
+      return (2, 1)
+    }
+    if UTF16.isLeadSurrogate(u) && i + 1 < count
+        && UTF16.isTrailSurrogate(startUTF16[i + 1]) {
+      return (4, 2)
+    }
+    // Either a scalar in the BMP or an ill-formed sequence, which is
+    // encoded as U+FFFD.
+    return (3, 1)
+  }
 }
 
 extension String {
@@ -157,6 +205,78 @@ extension String {
         }
       }
 
+      /// Returns the result of advancing `self` by `n` positions.
+      ///
+      /// - Complexity: O(1) if the `String` is stored as ASCII.  Otherwise,
+      ///   O(`n`), but whole Unicode scalars are skipped without encoding
+      ///   them.
+      @warn_unused_result
+      public func advancedBy(n: Int) -> Index {
+        _precondition(n >= 0,
+          "Only BidirectionalIndexType can be advanced by a negative amount")
+        var i = self
+        var remaining = n
+
+        if _fastPath(!_core._baseAddress._isNull) {
+          // Finish a partially consumed scalar first, so that `_coreIndex`
+          // is the position of the next byte.
+          while remaining != 0 && i._pendingContinuationCount != 0 {
+            i = i.successor()
+            remaining -= 1
+          }
+          var coreIndex = i._coreIndex
+          if _core.elementWidth == 1 {
+            _precondition(remaining <= _core.endIndex - coreIndex,
+              "Can't increment past endIndex of String.UTF8View")
+            coreIndex += remaining
+            remaining = 0
+          } else {
+            while coreIndex < _core.endIndex {
+              let (utf8Count, utf16Count) =
+                _core._measureContiguousUTF16ScalarAsUTF8(coreIndex)
+              if utf8Count > remaining {
+                break
+              }
+              remaining -= utf8Count
+              coreIndex += utf16Count
+            }
+          }
+          if coreIndex != i._coreIndex {
+            i = Index(_core, _utf16Offset: coreIndex)
+          }
+        }
+
+        while remaining != 0 {
+          i = i.successor()
+          remaining -= 1
+        }
+        return i
+      }
+
+      /// Measure the distance between `self` and `end`.
+      ///
+      /// - Requires: `end` is reachable from `self` by incrementation.
+      ///
+      /// - Complexity: O(1) if the `String` is stored as ASCII.  Otherwise,
+      ///   O(N) over the UTF-16 code units in between.
+      @warn_unused_result
+      public func distanceTo(end: Index) -> Int {
+        if _slowPath(_core._baseAddress._isNull) {
+          var i = self
+          var result = 0
+          while i != end {
+            i = i.successor()
+            result += 1
+          }
+          return result
+        }
+        // An index into the middle of a Unicode scalar has already moved its
+        // `_coreIndex` past that scalar.
+        return _pendingContinuationCount
+          + _core._utf8Count(_coreIndex..<end._coreIndex)
+          - end._pendingContinuationCount
+      }
+
       /// True iff the index is at the end of its view or if the next
       /// byte begins a new UnicodeScalar.
       internal var _isOnUnicodeScalarBoundary : Bool {
@@ -164,6 +284,18 @@ extension String {
         return UTF8._numTrailingBytes(next) != 4 || _isAtEnd
       }
 
+      /// The number of continuation bytes of a partially consumed Unicode
+      /// scalar that remain in the buffer.
+      internal var _pendingContinuationCount: Int {
+        var buffer = _buffer
+        var result = 0
+        while UTF8.isContinuation(UTF8.CodeUnit(truncatingBitPattern: buffer)) {
+          result += 1
+          buffer >>= 8
+        }
+        return result
+      }
+
       /// True iff the index is at the end of its view
       internal var _isAtEnd : Bool {
         return _buffer == Index._emptyBuffer
@@ -230,6 +362,28 @@ extension String {
       return UTF8View(_core, subRange.startIndex, subRange.endIndex)
     }
 
+    /// The number of UTF-8 code units in `self`.
+    ///
+    /// - Complexity: O(1) if the `String` is stored as ASCII.  Otherwise,
+    ///   O(N) over the UTF-16 code units, without forming any indices.
+    public var count: Int {
+      return _startIndex.distanceTo(_endIndex)
+    }
+
+    /// If the `String` is stored as ASCII, invoke `body` on the code units
+    /// of `self` in place.  Otherwise, return `nil`.
+    public func _withContiguousStorageIfAvailable<R>(
+      @noescape body: (UnsafeBufferPointer<UTF8.CodeUnit>) throws -> R
+    ) rethrows -> R? {
+      if _slowPath(_core.elementWidth != 1 || _core._baseAddress._isNull) {
+        return nil
+      }
+      defer { _fixLifetime(_core) }
+      return try body(UnsafeBufferPointer(
+        start: _core.startASCII + _startIndex._coreIndex,
+        count: _endIndex._coreIndex - _startIndex._coreIndex))
+    }
+
     /// Returns a mirror that reflects `self`.
     @warn_unused_result
     public func _getMirror() -> _MirrorType {
@@ -25,10 +25,12 @@
 #include "swift/Runtime/Metadata.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerIntPair.h"
+#include "llvm/ADT/SmallVector.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "ExistentialMetadataImpl.h"
 #include "Private.h"
+#include "RuntimeStatistics.h"
 #include "../SwiftShims/RuntimeShims.h"
 #include "stddef.h"
 
@@ -91,18 +93,50 @@ static void _buildNameForMetadata(const Metadata *type,
                                   bool qualified,
                                   std::string &result);
 
-static void _buildNominalTypeName(const NominalTypeDescriptor *ntd,
-                                  const Metadata *type,
-                                  bool qualified,
-                                  std::string &result) {
+/// Append the demangling of the mangled type name \p name to \p result.
+///
+/// The same nominal type and protocol names are demangled again for every
+/// generic instantiation and every existential that mentions them, so the
+/// results are memoized. Mangled names live in the binary's constant data,
+/// so their address identifies them.
+static void _appendDemangledTypeName(const char *name,
+                                     bool qualified,
+                                     std::string &result) {
+  using Key = std::pair<const char *, bool>;
+
+  static pthread_rwlock_t DemangledNameCacheLock = PTHREAD_RWLOCK_INITIALIZER;
+  static Lazy<llvm::DenseMap<Key, std::string>> DemangledNameCache;
+
+  Key key(name, qualified);
+  auto &cache = DemangledNameCache.get();
+
+  pthread_rwlock_rdlock(&DemangledNameCacheLock);
+  auto found = cache.find(key);
+  if (found != cache.end()) {
+    result += found->second;
+    pthread_rwlock_unlock(&DemangledNameCacheLock);
+    return;
+  }
+  pthread_rwlock_unlock(&DemangledNameCacheLock);
+
   auto options = Demangle::DemangleOptions();
   options.DisplayDebuggerGeneratedModule = false;
   options.QualifyEntities = qualified;
+  auto demangled = Demangle::demangleTypeAsString(name, strlen(name), options);
+  result += demangled;
 
+  // If another thread got here first, its entry is kept; it is the same.
+  pthread_rwlock_wrlock(&DemangledNameCacheLock);
+  cache.insert({key, std::move(demangled)});
+  pthread_rwlock_unlock(&DemangledNameCacheLock);
+}
+
+static void _buildNominalTypeName(const NominalTypeDescriptor *ntd,
+                                  const Metadata *type,
+                                  bool qualified,
+                                  std::string &result) {
   // Demangle the basic type name.
-  result += Demangle::demangleTypeAsString(ntd->Name,
-                                           strlen(ntd->Name),
-                                           options);
+  _appendDemangledTypeName(ntd->Name, qualified, result);
   
   // If generic, demangle the type parameters.
   if (ntd->GenericParams.NumPrimaryParams > 0) {
@@ -141,19 +175,13 @@ static const char *_getProtocolName(const ProtocolDescriptor *protocol) {
 static void _buildExistentialTypeName(const ProtocolDescriptorList *protocols,
                                       bool qualified,
                                       std::string &result) {
-  auto options = Demangle::DemangleOptions();
-  options.QualifyEntities = qualified;
-  options.DisplayDebuggerGeneratedModule = false;
-
   // If there's only one protocol, the existential type name is the protocol
   // name.
   auto descriptors = protocols->getProtocols();
   
   if (protocols->NumProtocols == 1) {
-    auto name = _getProtocolName(descriptors[0]);
-    result += Demangle::demangleTypeAsString(name,
-                                             strlen(name),
-                                             options);
+    _appendDemangledTypeName(_getProtocolName(descriptors[0]), qualified,
+                             result);
     return;
   }
   
@@ -161,10 +189,8 @@ static void _buildExistentialTypeName(const ProtocolDescriptorList *protocols,
   for (unsigned i = 0, e = protocols->NumProtocols; i < e; ++i) {
     if (i > 0)
       result += ", ";
-    auto name = _getProtocolName(descriptors[i]);
-    result += Demangle::demangleTypeAsString(name,
-                                             strlen(name),
-                                             options);
+    _appendDemangledTypeName(_getProtocolName(descriptors[i]), qualified,
+                             result);
   }
   result += ">";
 }
@@ -665,6 +691,41 @@ static bool _conformsToProtocols(const OpaqueValue *value,
   return true;
 }
 
+/// Whether the conformances of a type to the protocols of an existential type
+/// depend only on the type, so that they can be cached.
+static bool canCacheConformances(const ExistentialTypeMetadata *existentialType) {
+  for (unsigned i = 0, n = existentialType->Protocols.NumProtocols; i != n;
+       ++i) {
+    const ProtocolDescriptor *protocol = existentialType->Protocols[i];
+    if (!protocol->Flags.needsWitnessTable() &&
+        protocol->Flags.getSpecialProtocol() != SpecialProtocol::AnyObject)
+      return false;
+  }
+  return true;
+}
+
+/// Check whether a type conforms to the protocols of an existential type,
+/// filling in a list of conformances. Results that depend only on the type
+/// come from the cast cache.
+static bool _conformsToExistential(const OpaqueValue *value,
+                                   const Metadata *type,
+                                const ExistentialTypeMetadata *existentialType,
+                                   const WitnessTable **conformances) {
+  if (!canCacheConformances(existentialType))
+    return _conformsToProtocols(value, type, existentialType->Protocols,
+                                conformances);
+
+  auto cached = swift_lookupExistentialConformances(type, existentialType);
+  if (!cached)
+    return false;
+
+  auto witnessTables = cached->getWitnessTables();
+  for (unsigned i = 0, n = existentialType->Flags.getNumWitnessTables();
+       i != n; ++i)
+    conformances[i] = witnessTables[i];
+  return true;
+}
+
 static bool shouldDeallocateSource(bool castSucceeded, DynamicCastFlags flags) {
   return (castSucceeded && (flags & DynamicCastFlags::TakeOnSuccess)) ||
         (!castSucceeded && (flags & DynamicCastFlags::DestroyOnFailure));
@@ -983,9 +1044,8 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     }
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables())) {
+    if (!_conformsToExistential(srcDynamicValue, srcDynamicType, targetType,
+                                destExistential->getWitnessTables())) {
       return _fail(srcDynamicValue, srcDynamicType, targetType, flags);
     }
 
@@ -1002,9 +1062,8 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
       reinterpret_cast<OpaqueExistentialContainer*>(dest);
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables()))
+    if (!_conformsToExistential(srcDynamicValue, srcDynamicType, targetType,
+                                destExistential->getWitnessTables()))
       return _fail(srcDynamicValue, srcDynamicType, targetType, flags);
 
     // Fill in the type and value.
@@ -1026,9 +1085,8 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     // one we need.
     assert(targetType->Protocols.NumProtocols == 1);
     const WitnessTable *errorWitness;
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              &errorWitness))
+    if (!_conformsToExistential(srcDynamicValue, srcDynamicType, targetType,
+                                &errorWitness))
       return _fail(srcDynamicValue, srcDynamicType, targetType, flags);
     
     BoxPair destBox = swift_allocError(srcDynamicType, errorWitness,
@@ -2002,11 +2060,29 @@ static bool canCastToExistential(OpaqueValue *dest, OpaqueValue *src,
 }
 
 /// Perform a dynamic cast to an arbitrary type.
+static bool _dynamicCast(OpaqueValue *dest,
+                         OpaqueValue *src,
+                         const Metadata *srcType,
+                         const Metadata *targetType,
+                         DynamicCastFlags flags);
+
 bool swift::swift_dynamicCast(OpaqueValue *dest,
                               OpaqueValue *src,
                               const Metadata *srcType,
                               const Metadata *targetType,
                               DynamicCastFlags flags) {
+  SWIFT_RUNTIME_STATISTIC(DynamicCasts, 1);
+  bool result = _dynamicCast(dest, src, srcType, targetType, flags);
+  if (!result)
+    SWIFT_RUNTIME_STATISTIC(DynamicCastFailures, 1);
+  return result;
+}
+
+static bool _dynamicCast(OpaqueValue *dest,
+                         OpaqueValue *src,
+                         const Metadata *srcType,
+                         const Metadata *targetType,
+                         DynamicCastFlags flags) {
   // Check if the cast source is Optional and the target is not an existential
   // that Optional conforms to. Unwrap one level of Optional and continue.
   if (srcType->getKind() == MetadataKind::Optional
@@ -2216,7 +2292,7 @@ void ProtocolConformanceRecord::dump() const {
              kind == ProtocolConformanceTypeKind::UniqueDirectType
              ? "unique" : "nonunique");
       if (auto ntd = getDirectType()->getNominalTypeDescriptor()) {
-        printf("%s", ntd->Name);
+        printf("%s", ntd->Name.get());
       } else {
         printf("<structural type>");
       }
@@ -2305,14 +2381,67 @@ const {
 static std::once_flag InstallProtocolConformanceAddImageCallbackOnce;
 
 namespace {
+  /// An index from protocol descriptors to the conformance records of one
+  /// section, built once when the section is registered so that cache misses
+  /// only visit the records for the protocol being looked up.
+  ///
+  /// The index is keyed by protocol rather than by type because resolving a
+  /// record's type may instantiate metadata, which is not safe to do from
+  /// the image-added callback.
+  class ConformanceSectionIndex {
+    /// Pointers to the section's records, grouped by protocol.
+    std::vector<const ProtocolConformanceRecord *> Records;
+
+    /// The [start, end) range of each protocol's group within Records.
+    llvm::DenseMap<const ProtocolDescriptor *, std::pair<unsigned, unsigned>>
+      Groups;
+
+  public:
+    ConformanceSectionIndex(const ProtocolConformanceRecord *begin,
+                            const ProtocolConformanceRecord *end) {
+      // Count the records for each protocol, then lay out the groups
+      // contiguously in order of first appearance.
+      for (auto record = begin; record != end; ++record)
+        ++Groups[record->getProtocol()].second;
+
+      unsigned offset = 0;
+      for (auto &group : Groups) {
+        unsigned count = group.second.second;
+        group.second = {offset, offset};
+        offset += count;
+      }
+
+      Records.resize(offset);
+      for (auto record = begin; record != end; ++record)
+        Records[Groups[record->getProtocol()].second++] = record;
+    }
+
+    /// Return the records of this section for the given protocol.
+    ArrayRef<const ProtocolConformanceRecord *>
+    getRecords(const ProtocolDescriptor *protocol) const {
+      auto found = Groups.find(protocol);
+      if (found == Groups.end())
+        return {};
+      return llvm::makeArrayRef(Records).slice(found->second.first,
+                         found->second.second - found->second.first);
+    }
+  };
+
   struct ConformanceSection {
     const ProtocolConformanceRecord *Begin, *End;
+    /// The protocol index of the section. Sections are never unloaded, so
+    /// this is never freed.
+    const ConformanceSectionIndex *Index;
     const ProtocolConformanceRecord *begin() const {
       return Begin;
     }
     const ProtocolConformanceRecord *end() const {
       return End;
     }
+    ArrayRef<const ProtocolConformanceRecord *>
+    getRecords(const ProtocolDescriptor *protocol) const {
+      return Index->getRecords(protocol);
+    }
   };
 
   struct ConformanceCacheEntry {
@@ -2423,9 +2552,12 @@ swift::swift_registerProtocolConformances(const ProtocolConformanceRecord *begin
                                           const ProtocolConformanceRecord *end){
   auto &C = Conformances.get();
 
+  // Build the index before taking the lock; nobody can see this section yet.
+  auto index = new ConformanceSectionIndex(begin, end);
+
   pthread_mutex_lock(&C.SectionsToScanLock);
 
-  C.SectionsToScan.push_back(ConformanceSection{begin, end});
+  C.SectionsToScan.push_back(ConformanceSection{begin, end, index});
 
   pthread_mutex_unlock(&C.SectionsToScanLock);
 }
@@ -2631,9 +2763,32 @@ bool isRelatedType(const Metadata *type, const void *candidate) {
   return false;
 }
 
+/// Find the instance of the given generic metadata pattern among the given
+/// type and its superclasses.  Returns null if there is none.
+static const Metadata *findGenericInstance(const Metadata *type,
+                                           const GenericMetadata *pattern) {
+  while (true) {
+    if (type->getGenericPattern() == pattern)
+      return type;
+
+    // If the type is a class, try its superclass.
+    if (const ClassMetadata *classType = type->getClassObject()) {
+      if (auto super = classType->SuperClass) {
+        if (super != getRootSuperclass()) {
+          type = swift_getObjCClassMetadata(super);
+          continue;
+        }
+      }
+    }
+
+    return nullptr;
+  }
+}
+
 const WitnessTable *
 swift::swift_conformsToProtocol(const Metadata *type,
                                 const ProtocolDescriptor *protocol) {
+  SWIFT_RUNTIME_STATISTIC(ConformanceLookups, 1);
   auto &C = Conformances.get();
   
   // Install callbacks for tracking when a new dylib is loaded so we can
@@ -2696,8 +2851,12 @@ recur:
 
   for (; sectionIdx < endSectionIdx; ++sectionIdx) {
     auto &section = C.SectionsToScan[sectionIdx];
+    SWIFT_RUNTIME_STATISTIC(ConformanceSectionScans, 1);
     // Eagerly pull records for nondependent witnesses into our cache.
-    for (const auto &record : section) {
+    // Only the records for the protocol we're looking for are relevant.
+    for (const auto *recordPtr : section.getRecords(protocol)) {
+      const auto &record = *recordPtr;
+      SWIFT_RUNTIME_STATISTIC(ConformanceRecordsScanned, 1);
       // If the record applies to a specific type, cache it.
       if (auto metadata = record.getCanonicalTypeMetadata()) {
         auto P = record.getProtocol();
@@ -2748,6 +2907,38 @@ recur:
           C.Cache.findOrAllocateNode(hash);
           Bucket.push_front(ConformanceCacheEntry::createSuccess(
               R, P, record.getStaticWitnessTable()));
+
+      // If the record provides an accessor for the witness tables of the
+      // instances of a generic type, instantiate the table for the instance
+      // we're looking for and cache it for that instance.
+      } else if (record.getTypeKind()
+                   == ProtocolConformanceTypeKind::UniqueGenericPattern
+                 && record.getConformanceKind()
+                   == ProtocolConformanceReferenceKind::WitnessTableAccessor) {
+
+        auto R = record.getGenericPattern();
+        auto P = record.getProtocol();
+
+        // Look for an exact match.
+        if (protocol != P)
+          continue;
+
+        auto instance = findGenericInstance(type, R);
+        if (!instance)
+          continue;
+
+        // Hash and lookup the type-protocol pair in the cache.
+        size_t hash = hashTypeProtocolPair(instance, P);
+        ConcurrentList<ConformanceCacheEntry> &Bucket =
+          C.Cache.findOrAllocateNode(hash);
+
+        auto witness = record.getWitnessTable(instance);
+        if (witness)
+          Bucket.push_front(
+              ConformanceCacheEntry::createSuccess(instance, P, witness));
+        else
+          Bucket.push_front(ConformanceCacheEntry::createFailure(
+              instance, P, C.SectionsToScan.size()));
       }
     }
   }
@@ -2759,6 +2950,85 @@ recur:
   goto recur;
 }
 
+// Cast Cache.
+
+namespace {
+  /// The cached result of checking the conformances of a type to the
+  /// protocols of an existential type.
+  struct CastCacheEntry {
+    const Metadata *Type;
+    const ExistentialTypeMetadata *Target;
+
+    /// The conformances, or null if the type does not conform.
+    const ExistentialConformances *Conformances;
+
+    /// If the type does not conform, the number of conformance sections that
+    /// had been registered when the check was made.
+    size_t FailureGeneration;
+
+    bool matches(const Metadata *type,
+                 const ExistentialTypeMetadata *target) const {
+      return Type == type && Target == target;
+    }
+  };
+}
+
+static Lazy<ConcurrentMap<size_t, CastCacheEntry>> CastCache;
+
+static size_t hashCastCachePair(const Metadata *type,
+                                const ExistentialTypeMetadata *target) {
+  // A simple hash function for the cast pair.
+  return (size_t)type + ((size_t)target >> 2);
+}
+
+const ExistentialConformances *
+swift::swift_lookupExistentialConformances(
+                              const Metadata *type,
+                              const ExistentialTypeMetadata *existentialType) {
+  auto &C = Conformances.get();
+  ConcurrentList<CastCacheEntry> &Bucket =
+    CastCache.get().findOrAllocateNode(hashCastCachePair(type,
+                                                         existentialType));
+
+  // New entries are pushed in front, so the first match is the latest.
+  for (auto &Entry : Bucket) {
+    if (!Entry.matches(type, existentialType)) continue;
+
+    if (Entry.Conformances)
+      return Entry.Conformances;
+
+    // A failure is only definitive if no conformances have been registered
+    // since.
+    if (Entry.FailureGeneration == C.SectionsToScan.size())
+      return nullptr;
+    break;
+  }
+
+  // Read the generation before looking, so that conformances registered
+  // during the lookup invalidate a failure.
+  size_t generation = C.SectionsToScan.size();
+
+  unsigned numWitnessTables = existentialType->Flags.getNumWitnessTables();
+  SmallVector<const WitnessTable *, 4> witnessTables(numWitnessTables);
+  if (!_conformsToProtocols(nullptr, type, existentialType->Protocols,
+                            witnessTables.data())) {
+    Bucket.push_front({type, existentialType, nullptr, generation});
+    return nullptr;
+  }
+
+  // Threads racing to fill in the same entry may each allocate one. That's
+  // harmless; the entries are equivalent.
+  auto conformances = reinterpret_cast<ExistentialConformances *>(
+    malloc(sizeof(ExistentialConformances) +
+           numWitnessTables * sizeof(const WitnessTable *)));
+  conformances->Type = type;
+  memcpy(conformances + 1, witnessTables.data(),
+         numWitnessTables * sizeof(const WitnessTable *));
+
+  Bucket.push_front({type, existentialType, conformances, 0});
+  return conformances;
+}
+
 // The return type is incorrect.  It is only important that it is
 // passed using 'sret'.
 extern "C" OpaqueExistentialContainer
@@ -49,6 +49,25 @@ static unsigned getNumTagBytes(size_t size, unsigned emptyCases,
           numTags < 65536 ? 2 : 4);
 }
 
+/// Returns the number of tag bytes a single-payload enum needs after its
+/// payload. This is on the path of every generic enum tag access, so the
+/// common cases are answered without the general computation.
+static inline unsigned
+getSinglePayloadNumTagBytes(size_t payloadSize, unsigned emptyCases,
+                            unsigned payloadNumExtraInhabitants) {
+  // The extra inhabitants of the payload represent all the empty cases.
+  if (emptyCases <= payloadNumExtraInhabitants)
+    return 0;
+
+  // A payload of four bytes or more can hold the index of any empty case, so
+  // a single tag value, and byte, is enough.
+  if (payloadSize >= 4)
+    return 1;
+
+  return getNumTagBytes(payloadSize, emptyCases - payloadNumExtraInhabitants,
+                        1 /*payload case*/);
+}
+
 /// This is a small and fast implementation of memcpy with a constant count. It
 /// should be a performance win for small constant values where the function
 /// can be inlined, the loop unrolled and the memory accesses merged.
@@ -86,15 +105,11 @@ swift::swift_initEnumValueWitnessTableSinglePayload(ValueWitnessTable *vwtable,
   
   // If there are enough extra inhabitants for all of the cases, then the size
   // of the enum is the same as its payload.
-  size_t size;
-  if (payloadNumExtraInhabitants >= emptyCases) {
-    size = payloadSize;
+  size_t size = payloadSize + getSinglePayloadNumTagBytes(payloadSize,
+                                                emptyCases,
+                                                payloadNumExtraInhabitants);
+  if (payloadNumExtraInhabitants >= emptyCases)
     unusedExtraInhabitants = payloadNumExtraInhabitants - emptyCases;
-  } else {
-    size = payloadSize + getNumTagBytes(payloadSize,
-                                      emptyCases - payloadNumExtraInhabitants,
-                                      1 /*payload case*/);
-  }
   
   size_t align = payloadLayout->flags.getAlignment();
   vwtable->size = size;
@@ -148,16 +163,17 @@ swift::swift_getEnumCaseSinglePayload(const OpaqueValue *value,
   auto payloadNumExtraInhabitants = payloadWitnesses->getNumExtraInhabitants();
 
   // If there are extra tag bits, check them.
-  if (emptyCases > payloadNumExtraInhabitants) {
+  unsigned numBytes = getSinglePayloadNumTagBytes(payloadSize, emptyCases,
+                                                  payloadNumExtraInhabitants);
+  if (numBytes > 0) {
     auto *valueAddr = reinterpret_cast<const uint8_t*>(value);
     auto *extraTagBitAddr = valueAddr + payloadSize;
     unsigned extraTagBits = 0;
     // FIXME: endianness
-    unsigned numBytes = getNumTagBytes(payloadSize,
-                                       emptyCases-payloadNumExtraInhabitants,
-                                       1 /*payload case*/);
-
-    small_memcpy(&extraTagBits, extraTagBitAddr, numBytes);
+    if (numBytes == 1)
+      extraTagBits = *extraTagBitAddr;
+    else
+      small_memcpy(&extraTagBits, extraTagBitAddr, numBytes);
 
     // If the extra tag bits are zero, we have a valid payload or
     // extra inhabitant (checked below). If nonzero, form the case index from
@@ -199,10 +215,9 @@ swift::swift_storeEnumTagSinglePayload(OpaqueValue *value,
 
   auto *valueAddr = reinterpret_cast<uint8_t*>(value);
   auto *extraTagBitAddr = valueAddr + payloadSize;
-  unsigned numExtraTagBytes = emptyCases > payloadNumExtraInhabitants
-    ? getNumTagBytes(payloadSize, emptyCases - payloadNumExtraInhabitants,
-                     1 /*payload case*/)
-    : 0;
+  unsigned numExtraTagBytes = getSinglePayloadNumTagBytes(payloadSize,
+                                                emptyCases,
+                                                payloadNumExtraInhabitants);
 
   // For payload or extra inhabitant cases, zero-initialize the extra tag bits,
   // if any.
@@ -246,7 +261,10 @@ swift::swift_storeEnumTagSinglePayload(OpaqueValue *value,
   memcpy(valueAddr, &payloadIndex, std::min(size_t(4), payloadSize));
   if (payloadSize > 4)
     memset(valueAddr + 4, 0, payloadSize - 4);
-  memcpy(extraTagBitAddr, &extraTagIndex, numExtraTagBytes);
+  if (numExtraTagBytes == 1)
+    *extraTagBitAddr = extraTagIndex;
+  else
+    small_memcpy(extraTagBitAddr, &extraTagIndex, numExtraTagBytes);
 }
 
 void
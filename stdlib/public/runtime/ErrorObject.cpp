@@ -18,14 +18,57 @@
 //===----------------------------------------------------------------------===//
 
 #include <stdio.h>
+#include <string.h>
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "Private.h"
 
-#if !SWIFT_OBJC_INTEROP
-
 using namespace swift;
 
+namespace {
+  struct SharedErrorBox {
+    const Metadata *Type;
+    const WitnessTable *ErrorConformance;
+    uint8_t Value;
+    BoxPair Box;
+  };
+}
+
+static Lazy<ConcurrentMap<size_t, SharedErrorBox>> SharedErrorBoxes;
+
+BoxPair::Return
+swift::_swift_getSharedErrorBox(const Metadata *type,
+                                const WitnessTable *errorConformance,
+                                OpaqueValue *value,
+                                AllocErrorFn *allocate) {
+  auto vw = type->getValueWitnesses();
+  if (!value || !vw->isPOD() || vw->getSize() > sizeof(uint8_t))
+    return BoxPair{nullptr, nullptr};
+
+  uint8_t byte = 0;
+  memcpy(&byte, value, vw->getSize());
+
+  ConcurrentList<SharedErrorBox> &Bucket =
+    SharedErrorBoxes.get().findOrAllocateNode(
+      (size_t)type + ((size_t)errorConformance >> 2) + byte);
+  for (auto &Entry : Bucket) {
+    if (Entry.Type == type && Entry.ErrorConformance == errorConformance &&
+        Entry.Value == byte)
+      return Entry.Box;
+  }
+
+  // Threads racing to share the same value may each add a box. That's
+  // harmless; the boxes are equivalent. The cache owns one reference to each
+  // box, so they are never freed.
+  BoxPair box = allocate(type, errorConformance, value, /*isTake*/ false);
+  Bucket.push_front({type, errorConformance, byte, box});
+  return box;
+}
+
+#if !SWIFT_OBJC_INTEROP
+
 /// Determine the size and alignment of an ErrorType box containing the given
 /// type.
 static std::pair<size_t, size_t>
@@ -62,11 +105,11 @@ static const FullMetadata<HeapMetadata> ErrorTypeMetadata{
   Metadata{MetadataKind::ErrorObject},
 };
 
-BoxPair::Return
-swift::swift_allocError(const swift::Metadata *type,
-                        const swift::WitnessTable *errorConformance,
-                        OpaqueValue *initialValue,
-                        bool isTake) {
+static BoxPair::Return
+_swift_allocFreshError(const Metadata *type,
+                       const WitnessTable *errorConformance,
+                       OpaqueValue *initialValue,
+                       bool isTake) {
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
   
   auto allocated = swift_allocObject(&ErrorTypeMetadata,
@@ -89,6 +132,21 @@ swift::swift_allocError(const swift::Metadata *type,
   return BoxPair{allocated, valuePtr};
 }
 
+BoxPair::Return
+swift::swift_allocError(const swift::Metadata *type,
+                        const swift::WitnessTable *errorConformance,
+                        OpaqueValue *initialValue,
+                        bool isTake) {
+  BoxPair shared = _swift_getSharedErrorBox(type, errorConformance,
+                                            initialValue,
+                                            _swift_allocFreshError);
+  if (shared.first) {
+    swift_retain(shared.first);
+    return shared;
+  }
+  return _swift_allocFreshError(type, errorConformance, initialValue, isTake);
+}
+
 void
 swift::swift_deallocError(SwiftError *error, const Metadata *type) {
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
@@ -150,6 +150,25 @@ extern "C" BoxPair::Return swift_allocError(const Metadata *type,
 /// destroyed.
 extern "C" void swift_deallocError(SwiftError *error, const Metadata *type);
 
+/// The signature of an implementation of swift_allocError.
+using AllocErrorFn = BoxPair::Return (const Metadata *type,
+                                      const WitnessTable *errorConformance,
+                                      OpaqueValue *value, bool isTake);
+
+/// Get the box which all errors of the given type and value share, creating
+/// it with \p allocate on first use. A boxed error is never modified, so
+/// throwing the same value again doesn't need a new allocation.
+///
+/// Only POD values of at most one byte are shared. This covers enums without
+/// payloads and bounds the number of boxes kept alive per type.
+///
+/// \returns the box without retaining it, or a null box if the value isn't
+/// shared.
+BoxPair::Return _swift_getSharedErrorBox(const Metadata *type,
+                                         const WitnessTable *errorConformance,
+                                         OpaqueValue *value,
+                                         AllocErrorFn *allocate);
+
 struct ErrorValueResult {
   const OpaqueValue *value;
   const Metadata *type;
@@ -150,7 +150,22 @@ _swift_allocError_(const Metadata *type,
   return BoxPair{reinterpret_cast<HeapObject*>(instance), valuePtr};
 }
 
-extern "C" auto *_swift_allocError = _swift_allocError_;
+/// Allocate a catchable error object, sharing the box of small POD values.
+static BoxPair::Return
+_swift_allocSharedOrFreshError_(const Metadata *type,
+                                const WitnessTable *errorConformance,
+                                OpaqueValue *initialValue,
+                                bool isTake) {
+  BoxPair shared = _swift_getSharedErrorBox(type, errorConformance,
+                                            initialValue, _swift_allocError_);
+  if (shared.first) {
+    objc_retain((id)shared.first);
+    return shared;
+  }
+  return _swift_allocError_(type, errorConformance, initialValue, isTake);
+}
+
+extern "C" auto *_swift_allocError = _swift_allocSharedOrFreshError_;
 
 BoxPair::Return
 swift::swift_allocError(const Metadata *type,
@@ -12,23 +12,324 @@
 //
 // Implementations of the Swift heap
 //
+// Small allocations with no more than the default alignment are served from
+// a thread-caching size-class heap. The heap lives in a single reserved
+// address range that is carved into slabs, each of which holds blocks of one
+// size class; this makes it cheap to tell whether a pointer belongs to the
+// heap and which size class it has without trusting the size passed to
+// swift_slowDealloc. Every thread keeps a free list per size class, and
+// batches of blocks move between threads through per-class global lists.
+//
+// Everything else goes to the system allocator. Setting the environment
+// variable SWIFT_DEBUG_USE_SYSTEM_MALLOC=1 sends all allocations to the
+// system allocator, which is useful with malloc debugging tools.
+//
 //===----------------------------------------------------------------------===//
 
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Basic/Malloc.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(__GNU_LIBRARY__)
+#include <malloc.h>
+#elif defined(__FreeBSD__)
+#include <malloc_np.h>
+#endif
 
 using namespace swift;
 
+/// The alignment mask the system allocator guarantees for every allocation.
+#if defined(__APPLE__)
+static const size_t MallocAlignMask = 15;
+#else
+static const size_t MallocAlignMask = (sizeof(void*) == 8) ? 15 : 7;
+#endif
+
+namespace {
+
+/// Size classes are multiples of the block granule.
+enum : size_t {
+  GranuleSize = 16,
+  NumSizeClasses = 32,
+  MaxSmallSize = GranuleSize * NumSizeClasses,
+  SmallAlignMask = GranuleSize - 1,
+
+  /// Blocks are handed to threads from fresh slabs of this size.
+  SlabSize = 64 * 1024,
+  SlabShift = 16,
+
+  /// The number of blocks moved between a thread cache and the global
+  /// free list at once.
+  TransferBatchSize = 32,
+  /// A thread cache returns a batch to the global list once it holds
+  /// this many free blocks of a class.
+  MaxCachedBlocks = 2 * TransferBatchSize,
+};
+
+static_assert(SlabSize == (size_t(1) << SlabShift), "slab shift mismatch");
+
+/// The address range reserved for the size-class heap.
+#if defined(__LP64__) || defined(_WIN64)
+static const size_t HeapRegionSize = size_t(4) * 1024 * 1024 * 1024;
+#else
+static const size_t HeapRegionSize = size_t(256) * 1024 * 1024;
+#endif
+static const size_t NumSlabs = HeapRegionSize / SlabSize;
+
+static inline size_t sizeClassForSize(size_t size) {
+  return size == 0 ? 0 : (size - 1) / GranuleSize;
+}
+
+static inline size_t sizeForSizeClass(size_t sizeClass) {
+  return (sizeClass + 1) * GranuleSize;
+}
+
+/// A free block, linked through its first word.
+struct FreeBlock {
+  FreeBlock *Next;
+};
+
+/// A singly-linked list of free blocks of one size class.
+struct FreeList {
+  FreeBlock *Head;
+  size_t Count;
+
+  void push(FreeBlock *block) {
+    block->Next = Head;
+    Head = block;
+    ++Count;
+  }
+
+  FreeBlock *pop() {
+    FreeBlock *block = Head;
+    if (block) {
+      Head = block->Next;
+      --Count;
+    }
+    return block;
+  }
+
+  /// Move up to \p n blocks from the front of this list to \p dest.
+  void transfer(FreeList &dest, size_t n) {
+    while (n-- && Head)
+      dest.push(pop());
+  }
+};
+
+/// The process-wide state of the size-class heap.
+struct SizeClassHeap {
+  /// The start of the reserved region, or 0 if the heap is disabled.
+  uintptr_t RegionBase;
+  /// The size of the reserved region, or 0 if the heap is disabled.
+  size_t RegionSize;
+  /// The index of the next unused slab.
+  std::atomic<size_t> NextSlab;
+  /// The size class of every slab handed out so far.
+  uint8_t SlabClasses[NumSlabs];
+
+  /// Blocks returned by threads, available to any thread.
+  FreeList GlobalLists[NumSizeClasses];
+  std::mutex GlobalLocks[NumSizeClasses];
+
+  /// Destroys thread caches when their threads exit.
+  pthread_key_t ThreadCacheKey;
+
+  SizeClassHeap();
+
+  bool isEnabled() const { return RegionSize != 0; }
+
+  bool contains(const void *ptr) const {
+    return (uintptr_t)ptr - RegionBase < RegionSize;
+  }
+
+  size_t sizeClassOf(const void *ptr) const {
+    return SlabClasses[((uintptr_t)ptr - RegionBase) >> SlabShift];
+  }
+
+  void refill(FreeList &list, size_t sizeClass);
+  void release(FreeList &list, size_t sizeClass, size_t n);
+};
+
+/// The free lists of one thread.
+struct ThreadCache {
+  FreeList Lists[NumSizeClasses];
+};
+
+} // end anonymous namespace
+
+static Lazy<SizeClassHeap> Heap;
+
+/// The current thread's cache; mirrors the pthread-specific value so that
+/// the allocation fast path never calls into pthreads.
+static __thread ThreadCache *CurrentThreadCache;
+
+static void destroyThreadCache(void *value) {
+  auto cache = static_cast<ThreadCache *>(value);
+  CurrentThreadCache = nullptr;
+  auto &heap = Heap.unsafeGetAlreadyInitialized();
+  for (size_t i = 0; i < NumSizeClasses; ++i)
+    heap.release(cache->Lists[i], i, cache->Lists[i].Count);
+  free(cache);
+}
+
+SizeClassHeap::SizeClassHeap() : RegionBase(0), RegionSize(0), NextSlab(0) {
+  memset(SlabClasses, 0, sizeof(SlabClasses));
+  memset(GlobalLists, 0, sizeof(GlobalLists));
+
+  const char *useSystemMalloc = getenv("SWIFT_DEBUG_USE_SYSTEM_MALLOC");
+  if (useSystemMalloc && useSystemMalloc[0] && useSystemMalloc[0] != '0')
+    return;
+
+  if (pthread_key_create(&ThreadCacheKey, destroyThreadCache) != 0)
+    return;
+
+  // Reserve the whole region up front. Pages are only committed by the
+  // kernel once they are touched.
+  void *region = mmap(nullptr, HeapRegionSize, PROT_READ|PROT_WRITE,
+                      MAP_ANON|MAP_PRIVATE|MAP_NORESERVE, -1, 0);
+  if (region == MAP_FAILED)
+    return;
+
+  RegionBase = (uintptr_t)region;
+  RegionSize = HeapRegionSize;
+}
+
+/// Put at least one block of the given class on \p list, taking blocks from
+/// the global free list if there are any and from a fresh slab otherwise.
+/// Leaves \p list empty if the region is exhausted.
+void SizeClassHeap::refill(FreeList &list, size_t sizeClass) {
+  {
+    std::lock_guard<std::mutex> guard(GlobalLocks[sizeClass]);
+    GlobalLists[sizeClass].transfer(list, TransferBatchSize);
+  }
+  if (list.Head)
+    return;
+
+  size_t slab = NextSlab.fetch_add(1, std::memory_order_relaxed);
+  if (slab >= NumSlabs)
+    return;
+  SlabClasses[slab] = sizeClass;
+
+  size_t blockSize = sizeForSizeClass(sizeClass);
+  char *begin = (char *)(RegionBase + slab * SlabSize);
+  char *end = begin + (SlabSize / blockSize) * blockSize;
+  // Push in reverse so that blocks are handed out in address order.
+  for (char *block = end - blockSize; block >= begin; block -= blockSize)
+    list.push(reinterpret_cast<FreeBlock *>(block));
+}
+
+/// Return \p n blocks from \p list to the global free list.
+void SizeClassHeap::release(FreeList &list, size_t sizeClass, size_t n) {
+  std::lock_guard<std::mutex> guard(GlobalLocks[sizeClass]);
+  list.transfer(GlobalLists[sizeClass], n);
+}
+
+static ThreadCache *getThreadCacheSlow(SizeClassHeap &heap) {
+  auto cache = static_cast<ThreadCache *>(calloc(1, sizeof(ThreadCache)));
+  if (!cache) swift::crash("Could not allocate memory.");
+  pthread_setspecific(heap.ThreadCacheKey, cache);
+  CurrentThreadCache = cache;
+  return cache;
+}
+
+static void *allocSmall(SizeClassHeap &heap, size_t size) {
+  ThreadCache *cache = CurrentThreadCache;
+  if (LLVM_UNLIKELY(!cache))
+    cache = getThreadCacheSlow(heap);
+
+  size_t sizeClass = sizeClassForSize(size);
+  FreeList &list = cache->Lists[sizeClass];
+  if (LLVM_UNLIKELY(!list.Head)) {
+    heap.refill(list, sizeClass);
+    // If the region is exhausted, fall back to the system allocator.
+    if (!list.Head)
+      return nullptr;
+  }
+  return list.pop();
+}
+
+static void deallocSmall(SizeClassHeap &heap, void *ptr) {
+  ThreadCache *cache = CurrentThreadCache;
+  if (LLVM_UNLIKELY(!cache))
+    cache = getThreadCacheSlow(heap);
+
+  size_t sizeClass = heap.sizeClassOf(ptr);
+  FreeList &list = cache->Lists[sizeClass];
+  list.push(reinterpret_cast<FreeBlock *>(ptr));
+  if (LLVM_UNLIKELY(list.Count > MaxCachedBlocks))
+    heap.release(list, sizeClass, TransferBatchSize);
+}
+
 void *swift::swift_slowAlloc(size_t size, size_t alignMask) {
-  // FIXME: use posix_memalign if alignMask is larger than the system guarantee.
-  void *p = malloc(size);
+  void *p;
+  if (size <= MaxSmallSize && alignMask <= SmallAlignMask) {
+    auto &heap = Heap.get();
+    if (heap.isEnabled() && (p = allocSmall(heap, size)))
+      return p;
+  }
+
+  if (alignMask <= MallocAlignMask) {
+    p = malloc(size);
+  } else {
+    p = AlignedAlloc(size, alignMask + 1);
+  }
   if (!p) swift::crash("Could not allocate memory.");
   return p;
 }
 
 void swift::swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask) {
-  free(ptr);
+  // Don't trust bytes to identify the size class: some callers only know
+  // the size of the class instance, not of its tail allocation.
+  auto &heap = Heap.get();
+  if (heap.contains(ptr))
+    return deallocSmall(heap, ptr);
+
+  if (alignMask <= MallocAlignMask) {
+    free(ptr);
+  } else {
+    AlignedFree(ptr);
+  }
+}
+
+void *swift::swift_slowRealloc(void *ptr, size_t oldSize, size_t newSize,
+                               size_t alignMask) {
+  auto &heap = Heap.get();
+  bool isSmall = heap.contains(ptr);
+  if (isSmall && newSize <= sizeForSizeClass(heap.sizeClassOf(ptr)))
+    return ptr;
+
+  // Memory from the size-class heap, and over-aligned memory, can't be
+  // handed to realloc.
+  if (isSmall || alignMask > MallocAlignMask) {
+    void *p = swift_slowAlloc(newSize, alignMask);
+    memcpy(p, ptr, std::min(oldSize, newSize));
+    swift_slowDealloc(ptr, oldSize, alignMask);
+    return p;
+  }
+
+  void *p = realloc(ptr, newSize);
+  if (!p) swift::crash("Could not allocate memory.");
+  return p;
+}
+
+size_t swift::swift_slowAllocSize(const void *ptr) {
+  auto &heap = Heap.get();
+  if (heap.contains(ptr))
+    return sizeForSizeClass(heap.sizeClassOf(ptr));
+#if defined(__APPLE__)
+  return malloc_size(ptr);
+#else
+  return malloc_usable_size(const_cast<void *>(ptr));
+#endif
 }
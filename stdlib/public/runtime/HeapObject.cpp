@@ -20,6 +20,7 @@
 #include "swift/Runtime/Heap.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/ABI/System.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/MathExtras.h"
 #include "MetadataCache.h"
 #include "Private.h"
@@ -29,7 +30,13 @@
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
+#include <mutex>
 #include <unistd.h>
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+#include <atomic>
+#include <pthread.h>
+#include <vector>
+#endif
 #include "../SwiftShims/RuntimeShims.h"
 #if SWIFT_OBJC_INTEROP
 # include <objc/NSObject.h>
@@ -46,15 +53,43 @@
 # define SWIFT_RELEASE()
 # define SWIFT_RETAIN()
 #endif
+#include "HeapProfile.h"
 #include "Leaks.h"
+#include "RuntimeStatistics.h"
 
 using namespace swift;
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+static void pollBiasedRefCountQueue();
+#endif
+
+#if SWIFT_RUNTIME_ENABLE_STATISTICS
+static void countObjectAllocation(size_t size) {
+  SWIFT_RUNTIME_STATISTIC(ObjectsAllocated, 1);
+  SWIFT_RUNTIME_STATISTIC(BytesAllocated, size);
+  if (size <= 16)
+    SWIFT_RUNTIME_STATISTIC(ObjectsAllocatedUpTo16, 1);
+  else if (size <= 32)
+    SWIFT_RUNTIME_STATISTIC(ObjectsAllocatedUpTo32, 1);
+  else if (size <= 64)
+    SWIFT_RUNTIME_STATISTIC(ObjectsAllocatedUpTo64, 1);
+  else if (size <= 128)
+    SWIFT_RUNTIME_STATISTIC(ObjectsAllocatedUpTo128, 1);
+  else if (size <= 256)
+    SWIFT_RUNTIME_STATISTIC(ObjectsAllocatedUpTo256, 1);
+  else
+    SWIFT_RUNTIME_STATISTIC(ObjectsAllocatedOver256, 1);
+}
+#endif
+
 HeapObject *
 swift::swift_allocObject(HeapMetadata const *metadata,
                          size_t requiredSize,
                          size_t requiredAlignmentMask) {
   SWIFT_ALLOCATEOBJECT();
+#if SWIFT_RUNTIME_ENABLE_STATISTICS
+  countObjectAllocation(requiredSize);
+#endif
   return _swift_allocObject(metadata, requiredSize, requiredAlignmentMask);
 }
 static HeapObject *
@@ -70,6 +105,11 @@ _swift_allocObject_(HeapMetadata const *metadata, size_t requiredSize,
 
   // If leak tracking is enabled, start tracking this object.
   SWIFT_LEAKS_START_TRACKING_OBJECT(object);
+  SWIFT_HEAP_PROFILE_ALLOCATION(object, requiredSize);
+
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  pollBiasedRefCountQueue();
+#endif
 
   return object;
 }
@@ -104,6 +144,38 @@ extern "C" HeapObject* swift_bufferAllocate(
   return swift::swift_allocObject(bufferType, size, alignMask);
 }
 
+/// \brief Resize a buffer returned by swift_bufferAllocate to <size> bytes,
+/// keeping its first <oldSize> bytes and moving it if it can't grow in place.
+///
+/// This takes the caller's reference to <object> and returns a reference to
+/// the resized object. If anything else references the object, it is
+/// returned unchanged. The contents are moved bitwise, so the buffer must
+/// not hold values that depend on their own address.
+extern "C" HeapObject *swift_bufferReallocate(
+  HeapObject *object, size_t oldSize, size_t size, size_t alignMask)
+{
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+  // Another thread's release queue may hold the object's address.
+  return object;
+#else
+  // Any other strong, unowned or weak reference would be left dangling.
+  if (!object->refCount.isUniquelyReferenced() ||
+      object->weakRefCount.getCount() != 1)
+    return object;
+
+  SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
+  SWIFT_HEAP_PROFILE_DEALLOCATION(object);
+  auto newObject = reinterpret_cast<HeapObject *>(
+                     swift_slowRealloc(object, oldSize, size, alignMask));
+  SWIFT_LEAKS_START_TRACKING_OBJECT(newObject);
+  SWIFT_HEAP_PROFILE_ALLOCATION(newObject, size);
+  SWIFT_RUNTIME_STATISTIC(BuffersReallocated, 1);
+  if (newObject != object)
+    SWIFT_RUNTIME_STATISTIC(BuffersMovedByReallocation, 1);
+  return newObject;
+#endif
+}
+
 /// \brief Another entrypoint for swift_bufferAllocate.
 /// It is generated by the compiler in some corner cases, e.g. if an serialized
 /// optimzed module is imported into a non-optimized main module.
@@ -125,6 +197,108 @@ extern "C" void swift_bufferDeallocateFromStack(HeapObject *) {
 
 extern "C" intptr_t swift_bufferHeaderSize() { return sizeof(HeapObject); }
 
+namespace {
+/// A block of memory in a SwiftArena. Objects are allocated upward from the
+/// end of the header, each one preceded by its size.
+struct ArenaBlock {
+  ArenaBlock *Next;
+  size_t Size;
+};
+} // end anonymous namespace
+
+struct swift::SwiftArena {
+  ArenaBlock *Blocks = nullptr;
+  char *Cursor = nullptr;
+  char *End = nullptr;
+  size_t BlockSize;
+
+  explicit SwiftArena(size_t blockSize) : BlockSize(blockSize) {}
+
+  ArenaBlock *allocateBlock(size_t size) {
+    auto block = reinterpret_cast<ArenaBlock *>(
+                   swift_slowAlloc(size, alignof(ArenaBlock) - 1));
+    block->Size = size;
+    return block;
+  }
+
+  /// Allocate \p size bytes aligned to \p alignMask, and record the size
+  /// in the word before them.
+  void *allocate(size_t size, size_t alignMask) {
+    size_t needed = sizeof(size_t) + alignMask + size;
+
+    char *start;
+    if (LLVM_UNLIKELY(needed > BlockSize / 2)) {
+      // Keep filling the current block after a large allocation.
+      ArenaBlock *block = allocateBlock(sizeof(ArenaBlock) + needed);
+      if (Blocks) {
+        block->Next = Blocks->Next;
+        Blocks->Next = block;
+      } else {
+        block->Next = nullptr;
+        Blocks = block;
+      }
+      start = reinterpret_cast<char *>(block + 1);
+    } else {
+      if (LLVM_UNLIKELY(size_t(End - Cursor) < needed)) {
+        ArenaBlock *block = allocateBlock(BlockSize);
+        block->Next = Blocks;
+        Blocks = block;
+        Cursor = reinterpret_cast<char *>(block + 1);
+        End = reinterpret_cast<char *>(block) + BlockSize;
+      }
+      start = Cursor;
+    }
+
+    uintptr_t address =
+      (uintptr_t(start) + sizeof(size_t) + alignMask) & ~uintptr_t(alignMask);
+    auto result = reinterpret_cast<char *>(address);
+    reinterpret_cast<size_t *>(result)[-1] = size;
+    if (start == Cursor)
+      Cursor = result + size;
+    return result;
+  }
+
+  ~SwiftArena() {
+    for (ArenaBlock *block = Blocks; block;) {
+      ArenaBlock *next = block->Next;
+      swift_slowDealloc(block, block->Size, alignof(ArenaBlock) - 1);
+      block = next;
+    }
+  }
+};
+
+SwiftArena *swift::swift_arenaCreate(size_t blockSize) {
+  // A block must at least hold its header and one small object.
+  blockSize = std::max(blockSize, size_t(256));
+  return new SwiftArena(blockSize);
+}
+
+void swift::swift_arenaDestroy(SwiftArena *arena) {
+  delete arena;
+}
+
+HeapObject *swift::swift_arenaAllocObject(SwiftArena *arena,
+                                          HeapMetadata const *metadata,
+                                          size_t requiredSize,
+                                          size_t requiredAlignmentMask) {
+  assert(isAlignmentMask(requiredAlignmentMask));
+  auto object = reinterpret_cast<HeapObject *>(
+                  arena->allocate(requiredSize, requiredAlignmentMask));
+  object->metadata = metadata;
+  object->refCount.init();
+  // The arena holds a weak retain, so that deallocation leaves the memory
+  // alone; swift_deallocObject recognizes this and does nothing else.
+  object->weakRefCount.initForArena();
+  SWIFT_RUNTIME_STATISTIC(ObjectsAllocatedInArenas, 1);
+  return object;
+}
+
+size_t swift::swift_bufferAllocatedSize(HeapObject *object) {
+  if (LLVM_UNLIKELY(object->weakRefCount.isArenaAllocated()))
+    return reinterpret_cast<size_t *>(object)[-1];
+  return swift_slowAllocSize(object);
+}
+
 /// A do-nothing destructor for POD metadata.
 static void destroyPOD(HeapObject *o);
 
@@ -318,6 +492,7 @@ void _swift_release_dealloc(HeapObject *object)
 
 void swift::swift_retain(HeapObject *object) {
   SWIFT_RETAIN();
+  SWIFT_RUNTIME_STATISTIC(Retains, 1);
   _swift_retain(object);
 }
 static void _swift_retain_(HeapObject *object) {
@@ -327,6 +502,7 @@ auto swift::_swift_retain = _swift_retain_;
 
 void swift::swift_retain_n(HeapObject *object, uint32_t n) {
   SWIFT_RETAIN();
+  SWIFT_RUNTIME_STATISTIC(Retains, n);
   _swift_retain_n(object, n);
 }
 static void _swift_retain_n_(HeapObject *object, uint32_t n) {
@@ -338,6 +514,7 @@ auto swift::_swift_retain_n = _swift_retain_n_;
 
 void swift::swift_release(HeapObject *object) {
   SWIFT_RELEASE();
+  SWIFT_RUNTIME_STATISTIC(Releases, 1);
   return _swift_release(object);
 }
 static void _swift_release_(HeapObject *object) {
@@ -349,6 +526,7 @@ auto swift::_swift_release = _swift_release_;
 
 void swift::swift_release_n(HeapObject *object, uint32_t n) {
   SWIFT_RELEASE();
+  SWIFT_RUNTIME_STATISTIC(Releases, n);
   return _swift_release_n(object, n);
 }
 static void _swift_release_n_(HeapObject *object, uint32_t n) {
@@ -358,6 +536,55 @@ static void _swift_release_n_(HeapObject *object, uint32_t n) {
 }
 auto swift::_swift_release_n = _swift_release_n_;
 
+/// How many elements ahead of the current one the batch entry points
+/// prefetch the object header.
+static constexpr size_t BatchPrefetchDistance = 8;
+
+/// Return the length of the run of copies of objects[i], and prefetch the
+/// header of the object after it.
+static uint32_t batchRunLength(HeapObject **objects, size_t i, size_t count) {
+  HeapObject *object = objects[i];
+  uint32_t n = 1;
+  while (i + n < count && objects[i + n] == object && n != UINT32_MAX)
+    ++n;
+  // Prefetching is only a hint, so null and stale pointers are harmless.
+  if (i + n + BatchPrefetchDistance < count)
+    __builtin_prefetch(objects[i + n + BatchPrefetchDistance], /*write*/ 1);
+  return n;
+}
+
+void swift::swift_retainBatch(HeapObject **objects, size_t count) {
+  SWIFT_RETAIN();
+  SWIFT_RUNTIME_STATISTIC(Retains, count);
+  _swift_retainBatch(objects, count);
+}
+static void _swift_retainBatch_(HeapObject **objects, size_t count) {
+  for (size_t i = 0; i < count;) {
+    HeapObject *object = objects[i];
+    uint32_t n = batchRunLength(objects, i, count);
+    if (object)
+      object->refCount.increment(n);
+    i += n;
+  }
+}
+auto swift::_swift_retainBatch = _swift_retainBatch_;
+
+void swift::swift_releaseBatch(HeapObject **objects, size_t count) {
+  SWIFT_RELEASE();
+  SWIFT_RUNTIME_STATISTIC(Releases, count);
+  _swift_releaseBatch(objects, count);
+}
+static void _swift_releaseBatch_(HeapObject **objects, size_t count) {
+  for (size_t i = 0; i < count;) {
+    HeapObject *object = objects[i];
+    uint32_t n = batchRunLength(objects, i, count);
+    if (object && object->refCount.decrementShouldDeallocateN(n))
+      _swift_release_dealloc(object);
+    i += n;
+  }
+}
+auto swift::_swift_releaseBatch = _swift_releaseBatch_;
+
 size_t swift::swift_retainCount(HeapObject *object) {
   return object->refCount.getCount();
 }
@@ -460,13 +687,9 @@ void swift::swift_unownedRetainStrongAndRelease(HeapObject *object) {
   assert(object->weakRefCount.getCount() &&
          "object is not currently weakly retained");
 
-  if (! object->refCount.tryIncrement())
+  if (!tryIncrementStrongAndDecrementWeak(object->refCount,
+                                          object->weakRefCount))
     _swift_abortRetainUnowned(object);
-
-  // This should never cause a deallocation.
-  bool dealloc = object->weakRefCount.decrementShouldDeallocate();
-  assert(!dealloc && "retain-strong-and-release caused dealloc?");
-  (void) dealloc;
 }
 
 void swift::swift_unownedCheck(HeapObject *object) {
@@ -483,6 +706,119 @@ void _swift_release_dealloc(HeapObject *object) {
   asFullMetadata(object->metadata)->destroy(object);
 }
 
+#if SWIFT_RUNTIME_ENABLE_BIASED_REFCOUNTING
+__thread uint16_t _swift_biasedRefCountThreadID;
+
+namespace {
+
+/// Objects biased towards one thread whose shared count went negative,
+/// waiting for that thread to merge their biased counts.
+struct BiasedRefCountQueue {
+  std::mutex Lock;
+  std::vector<HeapObject *> Objects;
+  /// Set once the owner has exited. Objects queued after that are merged
+  /// by the releasing thread, since the owner no longer touches them.
+  bool OwnerExited = false;
+  /// Mirrors !Objects.empty() so that the owner can poll without locking.
+  std::atomic<bool> Pending{false};
+};
+
+struct BiasedRefCountState {
+  std::atomic<unsigned> NextThreadID{1};
+  /// Drains a thread's queue when it exits.
+  pthread_key_t ThreadExitKey;
+  BiasedRefCountQueue Queues[StrongRefCount::BIASED_MAX_OWNER + 1];
+
+  BiasedRefCountState();
+};
+
+} // end anonymous namespace
+
+static Lazy<BiasedRefCountState> BiasedRefCounts;
+
+static HeapObject *getHeapObject(StrongRefCount *refCount) {
+  return reinterpret_cast<HeapObject *>(
+    reinterpret_cast<char *>(refCount) - offsetof(HeapObject, refCount));
+}
+
+static void mergeQueuedObjects(std::vector<HeapObject *> &objects) {
+  for (auto object : objects)
+    if (object->refCount.mergeQueuedShouldDeallocate())
+      _swift_release_dealloc(object);
+}
+
+static void drainBiasedRefCountQueue(BiasedRefCountQueue &queue) {
+  std::vector<HeapObject *> objects;
+  {
+    std::lock_guard<std::mutex> guard(queue.Lock);
+    objects.swap(queue.Objects);
+    queue.Pending.store(false, std::memory_order_relaxed);
+  }
+  // Deallocation may run deinits that queue more objects, so merge outside
+  // the lock.
+  mergeQueuedObjects(objects);
+}
+
+static void biasedRefCountThreadExit(void *value) {
+  auto id = static_cast<uint16_t>(reinterpret_cast<uintptr_t>(value));
+  auto &queue = BiasedRefCounts.unsafeGetAlreadyInitialized().Queues[id];
+
+  // Anything this thread releases from here on goes to the shared count.
+  _swift_biasedRefCountThreadID = StrongRefCount::BIASED_NO_OWNER;
+
+  std::vector<HeapObject *> objects;
+  {
+    std::lock_guard<std::mutex> guard(queue.Lock);
+    objects.swap(queue.Objects);
+    queue.OwnerExited = true;
+  }
+  mergeQueuedObjects(objects);
+}
+
+BiasedRefCountState::BiasedRefCountState() {
+  if (pthread_key_create(&ThreadExitKey, biasedRefCountThreadExit) != 0)
+    NextThreadID.store(StrongRefCount::BIASED_NO_OWNER);
+}
+
+uint16_t _swift_biasedRefCountAssignThreadID() {
+  auto &state = BiasedRefCounts.get();
+  unsigned id = state.NextThreadID.fetch_add(1, std::memory_order_relaxed);
+  if (id > StrongRefCount::BIASED_MAX_OWNER ||
+      pthread_setspecific(state.ThreadExitKey,
+                          reinterpret_cast<void *>(uintptr_t(id))) != 0)
+    id = StrongRefCount::BIASED_NO_OWNER;
+  _swift_biasedRefCountThreadID = id;
+  return id;
+}
+
+void _swift_biasedRefCountQueueMerge(StrongRefCount *refCount) {
+  HeapObject *object = getHeapObject(refCount);
+  auto &queue = BiasedRefCounts.unsafeGetAlreadyInitialized()
+                  .Queues[refCount->getBiasedOwner()];
+  {
+    std::lock_guard<std::mutex> guard(queue.Lock);
+    if (!queue.OwnerExited) {
+      queue.Objects.push_back(object);
+      queue.Pending.store(true, std::memory_order_relaxed);
+      return;
+    }
+  }
+  // The owner is gone, so its biased count can't change any more.
+  if (refCount->mergeQueuedShouldDeallocate())
+    _swift_release_dealloc(object);
+}
+
+/// Merge the objects other threads have queued on the current thread.
+static void pollBiasedRefCountQueue() {
+  uint16_t id = _swift_biasedRefCountThreadID;
+  if (id == StrongRefCount::BIASED_NO_OWNER)
+    return;
+  auto &queue = BiasedRefCounts.unsafeGetAlreadyInitialized().Queues[id];
+  if (queue.Pending.load(std::memory_order_relaxed))
+    drainBiasedRefCountQueue(queue);
+}
+#endif
+
 #if SWIFT_OBJC_INTEROP
 /// Perform the root -dealloc operation for a class instance.
 void swift::swift_rootObjCDealloc(HeapObject *self) {
@@ -544,9 +880,12 @@ static inline void memset_pattern8(void *b, const void *pattern8, size_t len) {
 }
 #endif
 
+static void detachWeakReferences(HeapObject *object);
+
 void swift::swift_deallocObject(HeapObject *object, size_t allocatedSize,
                                 size_t allocatedAlignMask) {
   SWIFT_DEALLOCATEOBJECT();
+  SWIFT_RUNTIME_STATISTIC(ObjectsDeallocated, 1);
   assert(isAlignmentMask(allocatedAlignMask));
   assert(object->refCount.isDeallocating());
 #ifdef SWIFT_RUNTIME_CLOBBER_FREED_OBJECTS
@@ -557,6 +896,7 @@ void swift::swift_deallocObject(HeapObject *object, size_t allocatedSize,
 
   // If we are tracking leaks, stop tracking this object.
   SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
+  SWIFT_HEAP_PROFILE_DEALLOCATION(object);
 
   // Drop the initial weak retain of the object.
   //
@@ -623,9 +963,16 @@ void swift::swift_deallocObject(HeapObject *object, size_t allocatedSize,
   // release, we will fall back on swift_weakRelease, which does an
   // atomic decrement (and has the ability to reconstruct
   // allocatedSize and allocatedAlignMask).
+  //
+  // Weak references don't hold the object's memory: they hold it through
+  // the side table, which lets go of it here.
   if (object->weakRefCount.getCount() == 1) {
     swift_slowDealloc(object, allocatedSize, allocatedAlignMask);
+  } else if (object->weakRefCount.isArenaAllocated() &&
+             object->weakRefCount.getCount() == 2) {
+    // The remaining weak retain is the arena's, which frees the memory.
   } else {
+    detachWeakReferences(object);
     swift_unownedRelease(object);
   }
 }
@@ -635,27 +982,160 @@ void swift::swift_deallocObject(HeapObject *object, size_t allocatedSize,
 extern "C" void swift_fixLifetime(OpaqueValue *value) {
 }
 
+/*****************************************************************************/
+/****************************** WEAK REFERENCES ******************************/
+/*****************************************************************************/
+
+// Native weak references point at a side-table entry rather than at the
+// object, tagged with NativeWeakReferenceTag. The entry holds one unowned
+// reference to the object for all of them and gives it up when the object
+// is deallocated, so the object's memory doesn't outlive its deinit.
+
+namespace {
+
+/// The side-table entry shared by all weak references to one object.
+struct WeakReferenceEntry {
+  /// The referent, or null once it has been deallocated.
+  HeapObject *Object;
+  /// The number of weak references to this entry.
+  size_t WeakCount;
+  /// The shard whose lock guards this entry.
+  unsigned Shard;
+};
+
+/// A lock and the entries of the objects that hash to it.
+struct WeakReferenceShard {
+  std::mutex Lock;
+  llvm::DenseMap<HeapObject *, WeakReferenceEntry *> Entries;
+};
+
+struct WeakReferenceSideTable {
+  static constexpr unsigned NumShards = 64;
+  WeakReferenceShard Shards[NumShards];
+
+  static unsigned getShardIndex(HeapObject *object) {
+    return (reinterpret_cast<uintptr_t>(object) >> 4) % NumShards;
+  }
+};
+
+} // end anonymous namespace
+
+static Lazy<WeakReferenceSideTable> WeakReferences;
+
+static WeakReferenceEntry *getWeakReferenceEntry(const WeakReference *ref) {
+  auto bits = reinterpret_cast<uintptr_t>(ref->Value);
+  assert((!bits || (bits & NativeWeakReferenceTag)) &&
+         "native weak reference does not point at a side-table entry");
+  return reinterpret_cast<WeakReferenceEntry *>(bits & ~NativeWeakReferenceTag);
+}
+
+static void setWeakReferenceEntry(WeakReference *ref,
+                                  WeakReferenceEntry *entry) {
+  auto bits = reinterpret_cast<uintptr_t>(entry);
+  ref->Value = reinterpret_cast<HeapObject *>(
+                 bits ? bits | NativeWeakReferenceTag : 0);
+}
+
+/// Find or create the entry for an object and add a weak reference to it.
+static WeakReferenceEntry *retainWeakReferenceEntry(HeapObject *object) {
+  if (!object)
+    return nullptr;
+
+  unsigned index = WeakReferenceSideTable::getShardIndex(object);
+  auto &shard = WeakReferences.get().Shards[index];
+  WeakReferenceEntry *entry;
+  bool created = false;
+  {
+    std::lock_guard<std::mutex> guard(shard.Lock);
+    auto &slot = shard.Entries[object];
+    if (!slot) {
+      slot = new WeakReferenceEntry{object, 0, index};
+      created = true;
+    }
+    entry = slot;
+    ++entry->WeakCount;
+  }
+  // The entry's unowned reference keeps the header readable until the
+  // object is deallocated and detaches it.
+  if (created)
+    swift_unownedRetain(object);
+  return entry;
+}
+
+/// Drop a weak reference to an entry, destroying it with the last one.
+static void releaseWeakReferenceEntry(WeakReferenceEntry *entry) {
+  if (!entry)
+    return;
+
+  auto &shard = WeakReferences.unsafeGetAlreadyInitialized()
+                  .Shards[entry->Shard];
+  HeapObject *object;
+  {
+    std::lock_guard<std::mutex> guard(shard.Lock);
+    if (--entry->WeakCount != 0)
+      return;
+    object = entry->Object;
+    if (object)
+      shard.Entries.erase(object);
+  }
+  delete entry;
+  swift_unownedRelease(object);
+}
+
+/// Return whether the referent of an entry has started deallocating.
+static bool isWeakReferenceEntryDead(WeakReferenceEntry *entry) {
+  auto &shard = WeakReferences.unsafeGetAlreadyInitialized()
+                  .Shards[entry->Shard];
+  std::lock_guard<std::mutex> guard(shard.Lock);
+  return !entry->Object || entry->Object->refCount.isDeallocating();
+}
+
+/// Clear the entry of an object that is being deallocated, if it has one,
+/// and drop the entry's unowned reference to it.
+static void detachWeakReferences(HeapObject *object) {
+  unsigned index = WeakReferenceSideTable::getShardIndex(object);
+  auto &shard = WeakReferences.get().Shards[index];
+  {
+    std::lock_guard<std::mutex> guard(shard.Lock);
+    auto found = shard.Entries.find(object);
+    if (found == shard.Entries.end())
+      return;
+    found->second->Object = nullptr;
+    shard.Entries.erase(found);
+  }
+  swift_unownedRelease(object);
+}
+
 void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
-  ref->Value = value;
-  swift_unownedRetain(value);
+  setWeakReferenceEntry(ref, retainWeakReferenceEntry(value));
 }
 
 void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
-  swift_unownedRetain(newValue);
-  auto oldValue = ref->Value;
-  ref->Value = newValue;
-  swift_unownedRelease(oldValue);
+  auto newEntry = retainWeakReferenceEntry(newValue);
+  auto oldEntry = getWeakReferenceEntry(ref);
+  setWeakReferenceEntry(ref, newEntry);
+  releaseWeakReferenceEntry(oldEntry);
 }
 
 HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
-  auto object = ref->Value;
-  if (object == nullptr) return nullptr;
-  if (object->refCount.isDeallocating()) {
-    swift_unownedRelease(object);
+  auto entry = getWeakReferenceEntry(ref);
+  if (entry == nullptr) return nullptr;
+
+  HeapObject *object;
+  {
+    auto &shard = WeakReferences.unsafeGetAlreadyInitialized()
+                    .Shards[entry->Shard];
+    std::lock_guard<std::mutex> guard(shard.Lock);
+    // The lock keeps the object from being detached and freed under us.
+    object = entry->Object;
+    if (object && !object->refCount.tryIncrement())
+      object = nullptr;
+  }
+  if (!object) {
     ref->Value = nullptr;
-    return nullptr;
+    releaseWeakReferenceEntry(entry);
   }
-  return swift_tryRetain(object);
+  return object;
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
@@ -665,45 +1145,46 @@ HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
 }
 
 void swift::swift_weakDestroy(WeakReference *ref) {
-  auto tmp = ref->Value;
+  auto entry = getWeakReferenceEntry(ref);
   ref->Value = nullptr;
-  swift_unownedRelease(tmp);
+  releaseWeakReferenceEntry(entry);
 }
 
 void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
-  auto object = src->Value;
-  if (object == nullptr) {
+  auto entry = getWeakReferenceEntry(src);
+  if (entry == nullptr) {
     dest->Value = nullptr;
-  } else if (object->refCount.isDeallocating()) {
+  } else if (isWeakReferenceEntryDead(entry)) {
     src->Value = nullptr;
     dest->Value = nullptr;
-    swift_unownedRelease(object);
+    releaseWeakReferenceEntry(entry);
   } else {
-    dest->Value = object;
-    swift_unownedRetain(object);
+    auto &shard = WeakReferences.unsafeGetAlreadyInitialized()
+                    .Shards[entry->Shard];
+    {
+      std::lock_guard<std::mutex> guard(shard.Lock);
+      ++entry->WeakCount;
+    }
+    setWeakReferenceEntry(dest, entry);
   }
 }
 
 void swift::swift_weakTakeInit(WeakReference *dest, WeakReference *src) {
-  auto object = src->Value;
-  dest->Value = object;
-  if (object != nullptr && object->refCount.isDeallocating()) {
+  auto entry = getWeakReferenceEntry(src);
+  dest->Value = src->Value;
+  if (entry != nullptr && isWeakReferenceEntryDead(entry)) {
     dest->Value = nullptr;
-    swift_unownedRelease(object);
+    releaseWeakReferenceEntry(entry);
   }
 }
 
 void swift::swift_weakCopyAssign(WeakReference *dest, WeakReference *src) {
-  if (auto object = dest->Value) {
-    swift_unownedRelease(object);
-  }
+  releaseWeakReferenceEntry(getWeakReferenceEntry(dest));
   swift_weakCopyInit(dest, src);
 }
 
 void swift::swift_weakTakeAssign(WeakReference *dest, WeakReference *src) {
-  if (auto object = dest->Value) {
-    swift_unownedRelease(object);
-  }
+  releaseWeakReferenceEntry(getWeakReferenceEntry(dest));
   swift_weakTakeInit(dest, src);
 }
 
@@ -0,0 +1,396 @@
+//===--- HeapProfile.cpp - Swift sampling heap profiler -------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The sampling heap profiler. Each thread counts down the bytes it allocates
+// to its next sample point; the gaps between sample points are exponentially
+// distributed, so every allocated byte is equally likely to be sampled. The
+// allocation that reaches a sample point is recorded with its type and
+// backtrace, and is remembered until it is deallocated.
+//
+// Profiles are written in the legacy heap profile format that pprof reads,
+// with the sample interval in the header so that pprof can scale the sampled
+// counts back up:
+//
+//   heap profile: <live>: <live bytes> [<all>: <bytes>] @ heap_v2/<interval>
+//   <live>: <live bytes> [<all>: <bytes>] @ <address>...
+//   ...
+//   MAPPED_LIBRARIES:
+//   <the contents of /proc/self/maps>
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Config.h"
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/HeapProfile.h"
+#include "swift/Runtime/Metadata.h"
+#include "HeapProfile.h"
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <execinfo.h>
+#define SWIFT_HEAP_PROFILE_HAS_BACKTRACE 1
+#endif
+
+using namespace swift;
+
+bool swift::_swift_isHeapProfiling = false;
+__thread size_t swift::_swift_heapProfileBytesUntilSample;
+
+static constexpr size_t DefaultSampleInterval = 512 * 1024;
+
+/// The deepest backtrace that is recorded for a sample.
+static constexpr int MaxSampleFrames = 64;
+
+namespace {
+  /// The sampled allocations of one type from one backtrace.
+  struct AllocationSite {
+    const Metadata *Type;
+    std::vector<void *> Frames;
+    uint64_t LiveObjects;
+    uint64_t LiveBytes;
+    uint64_t Objects;
+    uint64_t Bytes;
+  };
+
+  /// A sampled object that hasn't been deallocated yet.
+  struct LiveSample {
+    unsigned Site;
+    size_t Size;
+  };
+
+  struct HeapProfiler {
+    std::mutex Lock;
+    std::vector<AllocationSite> Sites;
+    /// Maps the type and backtrace of a site, as raw bytes, to its index.
+    std::unordered_map<std::string, unsigned> SiteIndices;
+    std::unordered_map<HeapObject *, LiveSample> LiveSamples;
+  };
+}
+
+static Lazy<HeapProfiler> Profiler;
+
+static std::atomic<size_t> SampleInterval{DefaultSampleInterval};
+
+/// Counts the live sampled objects by a hash of their address, so that most
+/// deallocations see without taking the lock that they weren't sampled.
+static constexpr unsigned SampledAddressFilterBits = 12;
+static std::atomic<uint32_t>
+  SampledAddressFilter[1 << SampledAddressFilterBits];
+
+static std::atomic<uint32_t> &getSampledAddressCounter(HeapObject *object) {
+  uint64_t hash = (uint64_t)(uintptr_t)object * 0x9E3779B97F4A7C15ull;
+  return SampledAddressFilter[hash >> (64 - SampledAddressFilterBits)];
+}
+
+/// The state of the current thread's random number generator, or zero if
+/// the thread hasn't picked a sample point yet.
+static __thread uint64_t SampleRandomState;
+
+/// Pick the number of bytes before the current thread's next sample point.
+static size_t pickBytesUntilSample() {
+  uint64_t state = SampleRandomState;
+  if (!state)
+    state = (uint64_t)(uintptr_t)&SampleRandomState ^ 0x2545F4914F6CDD1Dull;
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  SampleRandomState = state;
+
+  // A uniform value in (0, 1].
+  double uniform = ((state >> 11) + 1) * (1.0 / 9007199254740992.0);
+  double gap = -std::log(uniform) *
+               SampleInterval.load(std::memory_order_relaxed);
+  if (gap < 1)
+    return 1;
+  if (gap > (double)(SIZE_MAX / 2))
+    return SIZE_MAX / 2;
+  return (size_t)gap;
+}
+
+/*****************************************************************************/
+/********************************** SAMPLING *********************************/
+/*****************************************************************************/
+
+static std::atomic<bool> DumpRequested{false};
+static void dumpHeapProfileToEnvironmentPrefix();
+
+void swift::_swift_heapProfileSampleAllocation(HeapObject *object,
+                                               size_t size) {
+  // The first allocation of a thread only picks its first sample point.
+  if (!SampleRandomState) {
+    _swift_heapProfileBytesUntilSample = pickBytesUntilSample();
+    if (_swift_heapProfileBytesUntilSample > size) {
+      _swift_heapProfileBytesUntilSample -= size;
+      return;
+    }
+  }
+  _swift_heapProfileBytesUntilSample = pickBytesUntilSample();
+
+  void *frames[MaxSampleFrames];
+  int numFrames = 0;
+#if SWIFT_HEAP_PROFILE_HAS_BACKTRACE
+  numFrames = backtrace(frames, MaxSampleFrames);
+#endif
+  // Leave out this function's own frame.
+  int firstFrame = std::min(numFrames, 1);
+
+  std::string key(reinterpret_cast<const char *>(&object->metadata),
+                  sizeof(object->metadata));
+  key.append(reinterpret_cast<const char *>(frames + firstFrame),
+             (numFrames - firstFrame) * sizeof(void *));
+
+  auto &profiler = Profiler.get();
+  {
+    std::lock_guard<std::mutex> guard(profiler.Lock);
+    auto insertion = profiler.SiteIndices.insert({key,
+                                                  profiler.Sites.size()});
+    if (insertion.second) {
+      profiler.Sites.push_back({object->metadata,
+                                std::vector<void *>(frames + firstFrame,
+                                                    frames + numFrames),
+                                0, 0, 0, 0});
+    }
+    unsigned siteIndex = insertion.first->second;
+    auto &site = profiler.Sites[siteIndex];
+    ++site.LiveObjects;
+    site.LiveBytes += size;
+    ++site.Objects;
+    site.Bytes += size;
+    auto sampleInsertion =
+      profiler.LiveSamples.insert({object, {siteIndex, size}});
+    if (sampleInsertion.second) {
+      getSampledAddressCounter(object).fetch_add(1,
+                                                 std::memory_order_relaxed);
+    } else {
+      // The earlier object at this address was freed without passing
+      // through swift_deallocObject.
+      auto &earlierSite = profiler.Sites[sampleInsertion.first->second.Site];
+      --earlierSite.LiveObjects;
+      earlierSite.LiveBytes -= sampleInsertion.first->second.Size;
+      sampleInsertion.first->second = {siteIndex, size};
+    }
+  }
+
+  if (DumpRequested.exchange(false, std::memory_order_relaxed))
+    dumpHeapProfileToEnvironmentPrefix();
+}
+
+void swift::_swift_heapProfileRecordDeallocation(HeapObject *object) {
+  auto &counter = getSampledAddressCounter(object);
+  if (LLVM_LIKELY(counter.load(std::memory_order_relaxed) == 0))
+    return;
+
+  auto &profiler = Profiler.get();
+  std::lock_guard<std::mutex> guard(profiler.Lock);
+  auto found = profiler.LiveSamples.find(object);
+  if (found == profiler.LiveSamples.end())
+    return;
+  auto &site = profiler.Sites[found->second.Site];
+  --site.LiveObjects;
+  site.LiveBytes -= found->second.Size;
+  profiler.LiveSamples.erase(found);
+  counter.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void swift::swift_startHeapProfile(size_t sampleInterval) {
+  SampleInterval.store(std::max(sampleInterval, (size_t)1),
+                       std::memory_order_relaxed);
+  Profiler.get();
+  _swift_isHeapProfiling = true;
+}
+
+/*****************************************************************************/
+/********************************** PROFILES *********************************/
+/*****************************************************************************/
+
+/// Copy the memory map of the process into a profile, so that pprof can
+/// symbolize its addresses.
+static void writeMappedLibraries(FILE *file) {
+#if defined(__linux__)
+  FILE *maps = fopen("/proc/self/maps", "r");
+  if (!maps)
+    return;
+  fputs("\nMAPPED_LIBRARIES:\n", file);
+  char buffer[4096];
+  while (size_t length = fread(buffer, 1, sizeof(buffer), maps))
+    fwrite(buffer, 1, length, file);
+  fclose(maps);
+#endif
+}
+
+/// The factor that turns the sampled counts of allocations of the given
+/// average size into an estimate of the actual counts.
+static double getUnsamplingFactor(uint64_t objects, uint64_t bytes,
+                                  size_t interval) {
+  if (!objects)
+    return 0;
+  double averageSize = (double)bytes / objects;
+  return 1 / (1 - std::exp(-averageSize / interval));
+}
+
+static bool writeHeapProfile(const std::string &path,
+                             const std::vector<AllocationSite> &sites,
+                             size_t interval) {
+  FILE *file = fopen(path.c_str(), "w");
+  if (!file)
+    return false;
+
+  uint64_t liveObjects = 0, liveBytes = 0, objects = 0, bytes = 0;
+  for (auto &site : sites) {
+    liveObjects += site.LiveObjects;
+    liveBytes += site.LiveBytes;
+    objects += site.Objects;
+    bytes += site.Bytes;
+  }
+  fprintf(file, "heap profile: %" PRIu64 ": %" PRIu64 " [%" PRIu64
+                ": %" PRIu64 "] @ heap_v2/%zu\n",
+          liveObjects, liveBytes, objects, bytes, interval);
+
+  for (auto &site : sites) {
+    fprintf(file, "%" PRIu64 ": %" PRIu64 " [%" PRIu64 ": %" PRIu64 "] @",
+            site.LiveObjects, site.LiveBytes, site.Objects, site.Bytes);
+    for (void *frame : site.Frames)
+      fprintf(file, " %p", frame);
+    fputc('\n', file);
+  }
+
+  writeMappedLibraries(file);
+  return fclose(file) == 0;
+}
+
+/// The name of a sampled type. Boxes don't have a type name of their own.
+static std::string getSampledTypeName(const Metadata *type) {
+  switch (type->getKind()) {
+  case MetadataKind::HeapLocalVariable:
+  case MetadataKind::HeapGenericLocalVariable:
+    return "<<<box>>>";
+  case MetadataKind::ErrorObject:
+    return "<<<error box>>>";
+  default:
+    return nameForMetadata(type);
+  }
+}
+
+static bool writeTypeSummary(const std::string &path,
+                             const std::vector<AllocationSite> &sites,
+                             size_t interval) {
+  struct TypeTotals {
+    const Metadata *Type;
+    double LiveObjects, LiveBytes, Objects, Bytes;
+  };
+  std::vector<TypeTotals> types;
+  std::unordered_map<const Metadata *, size_t> typeIndices;
+  for (auto &site : sites) {
+    auto insertion = typeIndices.insert({site.Type, types.size()});
+    if (insertion.second)
+      types.push_back({site.Type, 0, 0, 0, 0});
+    auto &totals = types[insertion.first->second];
+    double factor = getUnsamplingFactor(site.Objects, site.Bytes, interval);
+    totals.LiveObjects += site.LiveObjects * factor;
+    totals.LiveBytes += site.LiveBytes * factor;
+    totals.Objects += site.Objects * factor;
+    totals.Bytes += site.Bytes * factor;
+  }
+  std::sort(types.begin(), types.end(),
+            [](const TypeTotals &a, const TypeTotals &b) {
+              return a.LiveBytes > b.LiveBytes;
+            });
+
+  FILE *file = fopen(path.c_str(), "w");
+  if (!file)
+    return false;
+  fprintf(file, "%14s %16s %14s %16s  %s\n", "live objects", "live bytes",
+          "objects", "bytes", "type");
+  for (auto &totals : types) {
+    fprintf(file, "%14.0f %16.0f %14.0f %16.0f  %s\n", totals.LiveObjects,
+            totals.LiveBytes, totals.Objects, totals.Bytes,
+            getSampledTypeName(totals.Type).c_str());
+  }
+  return fclose(file) == 0;
+}
+
+bool swift::swift_dumpHeapProfile(const char *prefix) {
+  if (!_swift_isHeapProfiling)
+    return false;
+
+  std::vector<AllocationSite> sites;
+  {
+    auto &profiler = Profiler.get();
+    std::lock_guard<std::mutex> guard(profiler.Lock);
+    sites = profiler.Sites;
+  }
+  size_t interval = SampleInterval.load(std::memory_order_relaxed);
+
+  std::string path = prefix;
+  bool wroteProfile = writeHeapProfile(path + ".heap", sites, interval);
+  bool wroteSummary = writeTypeSummary(path + ".types", sites, interval);
+  return wroteProfile && wroteSummary;
+}
+
+/*****************************************************************************/
+/******************************* INITIALIZATION ******************************/
+/*****************************************************************************/
+
+static const char *EnvironmentProfilePrefix = nullptr;
+
+/// Write a profile to the prefix in SWIFT_HEAP_PROFILE, followed by the
+/// process ID and the number of the profile.
+static void dumpHeapProfileToEnvironmentPrefix() {
+  static std::atomic<unsigned> NumProfiles{0};
+  char suffix[64];
+  snprintf(suffix, sizeof(suffix), ".%d.%u", (int)getpid(),
+           NumProfiles.fetch_add(1, std::memory_order_relaxed));
+  swift_dumpHeapProfile((std::string(EnvironmentProfilePrefix) +
+                         suffix).c_str());
+}
+
+/// Writing a profile isn't async-signal-safe, so the signal handler only
+/// asks the next sampled allocation to write one.
+static void requestHeapProfileDump(int) {
+  DumpRequested.store(true, std::memory_order_relaxed);
+}
+
+static bool initializeHeapProfile() {
+  const char *prefix = getenv("SWIFT_HEAP_PROFILE");
+  if (!prefix || !*prefix)
+    return true;
+  EnvironmentProfilePrefix = prefix;
+
+  size_t interval = DefaultSampleInterval;
+  if (const char *value = getenv("SWIFT_HEAP_PROFILE_SAMPLE_INTERVAL"))
+    interval = strtoull(value, nullptr, 10);
+  if (const char *value = getenv("SWIFT_HEAP_PROFILE_SIGNAL")) {
+    int signalNumber = atoi(value);
+    if (signalNumber > 0)
+      signal(signalNumber, requestHeapProfileDump);
+  }
+
+  swift_startHeapProfile(interval);
+  atexit(dumpHeapProfileToEnvironmentPrefix);
+  return true;
+}
+
+SWIFT_ALLOWED_RUNTIME_GLOBAL_CTOR_BEGIN
+static bool HeapProfileInitialized = initializeHeapProfile();
+SWIFT_ALLOWED_RUNTIME_GLOBAL_CTOR_END
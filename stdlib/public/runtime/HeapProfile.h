@@ -0,0 +1,67 @@
+//===--- HeapProfile.h ------------------------------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The allocation and deallocation hooks of the sampling heap profiler. While
+// the profiler isn't running, each hook is a single load of a global flag.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_STDLIB_RUNTIME_HEAPPROFILE_H
+#define SWIFT_STDLIB_RUNTIME_HEAPPROFILE_H
+
+#include "llvm/Support/Compiler.h"
+#include <cstddef>
+
+namespace swift {
+
+struct HeapObject;
+
+/// Whether the heap profiler is running.
+extern LLVM_LIBRARY_VISIBILITY bool _swift_isHeapProfiling;
+
+/// The number of bytes the current thread may still allocate before its next
+/// sample. It starts out as zero, so that the first allocation of a thread
+/// picks the thread's first sample point.
+extern LLVM_LIBRARY_VISIBILITY __thread size_t
+  _swift_heapProfileBytesUntilSample __attribute__((tls_model("initial-exec")));
+
+/// Record the allocation that reached the current thread's sample point.
+LLVM_LIBRARY_VISIBILITY
+void _swift_heapProfileSampleAllocation(HeapObject *object, size_t size);
+
+/// Forget the given object if its allocation was sampled.
+LLVM_LIBRARY_VISIBILITY
+void _swift_heapProfileRecordDeallocation(HeapObject *object);
+
+static inline void _swift_heapProfileRecordAllocation(HeapObject *object,
+                                                      size_t size) {
+  if (LLVM_LIKELY(_swift_heapProfileBytesUntilSample > size)) {
+    _swift_heapProfileBytesUntilSample -= size;
+    return;
+  }
+  _swift_heapProfileSampleAllocation(object, size);
+}
+
+} // end namespace swift
+
+#define SWIFT_HEAP_PROFILE_ALLOCATION(object, size)                            \
+  do {                                                                         \
+    if (LLVM_UNLIKELY(::swift::_swift_isHeapProfiling))                        \
+      ::swift::_swift_heapProfileRecordAllocation(object, size);               \
+  } while (0)
+#define SWIFT_HEAP_PROFILE_DEALLOCATION(object)                                \
+  do {                                                                         \
+    if (LLVM_UNLIKELY(::swift::_swift_isHeapProfiling))                        \
+      ::swift::_swift_heapProfileRecordDeallocation(object);                   \
+  } while (0)
+
+#endif
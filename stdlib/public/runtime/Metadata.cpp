@@ -71,23 +71,33 @@ void *MetadataAllocator::alloc(size_t size) {
     return mem;
   }
   
-  char *end = next + size;
-  
-  // Allocate a new page if we need one.
-  if (LLVM_UNLIKELY(((uintptr_t)next & ~pagesizeMask)
-                      != (((uintptr_t)end & ~pagesizeMask)))){
-    next = (char*)
-      mmap(nullptr, pagesizeMask+1, PROT_READ|PROT_WRITE,
-           MAP_ANON|MAP_PRIVATE, VM_TAG_FOR_SWIFT_METADATA, 0);
-
-    if (next == MAP_FAILED)
-      crash("unable to allocate memory for metadata cache");
-    end = next + size;
+  char *addr = next.load(std::memory_order_relaxed);
+  while (true) {
+    char *end = addr + size;
+
+    // Allocate a new page if we need one.
+    if (LLVM_UNLIKELY(((uintptr_t)addr & ~pagesizeMask)
+                        != (((uintptr_t)end & ~pagesizeMask)))){
+      char *page = (char*)
+        mmap(nullptr, pagesizeMask+1, PROT_READ|PROT_WRITE,
+             MAP_ANON|MAP_PRIVATE, VM_TAG_FOR_SWIFT_METADATA, 0);
+
+      if (page == MAP_FAILED)
+        crash("unable to allocate memory for metadata cache");
+
+      // If another thread moved the bump pointer while we were mapping,
+      // give the page back and retry from its new value.
+      if (!next.compare_exchange_strong(addr, page + size,
+                                        std::memory_order_relaxed)) {
+        munmap(page, pagesizeMask+1);
+        continue;
+      }
+      return page;
+    }
+
+    if (next.compare_exchange_weak(addr, end, std::memory_order_relaxed))
+      return addr;
   }
-  
-  char *addr = next;
-  next = end;
-  return addr;
 }
 
 namespace {
@@ -252,15 +262,22 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
   auto genericArgs = (const void * const *) arguments;
   size_t numGenericArgs = pattern->NumKeyArguments;
 
+  bool created = false;
   auto entry = getCache(pattern).findOrAdd(genericArgs, numGenericArgs,
     [&]() -> GenericCacheEntry* {
       // Create new metadata to cache.
       auto metadata = pattern->CreateFunction(pattern, arguments);
       auto entry = GenericCacheEntry::getFromMetadata(pattern, metadata);
       entry->Value = metadata;
+      created = true;
       return entry;
     });
 
+  // Record the new metadata once its cache entry is complete.
+  if (created &&
+      _swift_isRecordingMetadataSnapshot.load(std::memory_order_relaxed))
+    _swift_recordGenericMetadata(pattern, genericArgs, entry->Value);
+
   return entry->Value;
 }
 
@@ -1010,6 +1027,9 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
   // FIXME: include labels when uniquing!
   auto genericArgs = (const void * const *) elements;
   auto &Types = TupleTypes.get();
+  // The entry builder replaces the proposed witnesses with the chosen ones.
+  auto originalWitnesses = proposedWitnesses;
+  bool created = false;
   auto entry = Types.findOrAdd(genericArgs, numElements,
     [&]() -> TupleCacheEntry* {
       // Create a new entry for the cache.
@@ -1030,6 +1050,8 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
       metadata->NumElements = numElements;
       metadata->Labels = labels;
 
+      created = true;
+
       // Perform basic layout on the tuple.
       auto layout = BasicLayout::initialForValueType();
       performBasicLayout(layout, elements, numElements,
@@ -1094,6 +1116,12 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
       return entry;
     });
 
+  // Record the new metadata once its cache entry is complete.
+  if (created &&
+      _swift_isRecordingMetadataSnapshot.load(std::memory_order_relaxed))
+    _swift_recordTupleTypeMetadata(numElements, elements, labels,
+                                   originalWitnesses, entry->getData());
+
   return entry->getData();
 }
 
@@ -1756,15 +1784,14 @@ getExistentialMetatypeValueWitnesses(ExistentialMetatypeState &EM,
   if (numWitnessTables == 2)
     return &ExistentialMetatypeValueWitnesses_2;
 
-  static_assert(3 * sizeof(void*) >= sizeof(ValueBuffer),
-                "not handling all possible inline-storage class existentials!");
-
   auto found = EM.ValueWitnessTables.find(numWitnessTables);
   if (found != EM.ValueWitnessTables.end())
     return found->second;
 
+  // With a value buffer larger than three words, containers with more
+  // witness tables may still be stored inline.
   using Box = NonFixedExistentialMetatypeBox;
-  using Witnesses = NonFixedValueWitnesses<Box, /*known allocated*/ true>;
+  using Witnesses = NonFixedValueWitnesses<Box, /*known allocated*/ false>;
 
   auto *vwt = new ExtraInhabitantsValueWitnessTable;
 #define STORE_VAR_EXISTENTIAL_METATYPE_WITNESS(WITNESS) \
@@ -1779,7 +1806,8 @@ getExistentialMetatypeValueWitnesses(ExistentialMetatypeState &EM,
     .withAlignment(Box::Container::getAlignment(numWitnessTables))
     .withPOD(true)
     .withBitwiseTakable(true)
-    .withInlineStorage(false)
+    .withInlineStorage(canBeInline(vwt->size,
+                         Box::Container::getAlignment(numWitnessTables)))
     .withExtraInhabitants(true);
   vwt->stride = Box::Container::getStride(numWitnessTables);
   vwt->extraInhabitantFlags = ExtraInhabitantFlags()
@@ -1929,15 +1957,14 @@ getClassExistentialValueWitnesses(ExistentialTypeState &E,
   if (numWitnessTables == 2)
     return &ClassExistentialValueWitnesses_2;
 
-  static_assert(3 * sizeof(void*) >= sizeof(ValueBuffer),
-                "not handling all possible inline-storage class existentials!");
-
   auto found = E.ClassValueWitnessTables.find(numWitnessTables);
   if (found != E.ClassValueWitnessTables.end())
     return found->second;
 
+  // With a value buffer larger than three words, containers with more
+  // witness tables may still be stored inline.
   using Box = NonFixedClassExistentialBox;
-  using Witnesses = NonFixedValueWitnesses<Box, /*known allocated*/ true>;
+  using Witnesses = NonFixedValueWitnesses<Box, /*known allocated*/ false>;
 
   auto *vwt = new ExtraInhabitantsValueWitnessTable;
 #define STORE_VAR_CLASS_EXISTENTIAL_WITNESS(WITNESS) \
@@ -1952,7 +1979,8 @@ getClassExistentialValueWitnesses(ExistentialTypeState &E,
     .withAlignment(Box::Container::getAlignment(numWitnessTables))
     .withPOD(false)
     .withBitwiseTakable(true)
-    .withInlineStorage(false)
+    .withInlineStorage(canBeInline(vwt->size,
+                         Box::Container::getAlignment(numWitnessTables)))
     .withExtraInhabitants(true);
   vwt->stride = Box::Container::getStride(numWitnessTables);
   vwt->extraInhabitantFlags = ExtraInhabitantFlags()
@@ -2308,6 +2336,72 @@ swift::swift_getForeignTypeMetadata(ForeignTypeMetadata *nonUnique) {
   return uniqueMetadata;
 }
 
+/*** Generic witness tables ***********************************************/
+
+namespace {
+  class GenericWitnessTableCacheEntry
+      : public CacheEntry<GenericWitnessTableCacheEntry> {
+  public:
+    static const char *getName() { return "GenericWitnessTableCache"; }
+
+    GenericWitnessTableCacheEntry(size_t numArguments) {}
+
+    static constexpr size_t getNumArguments() {
+      return 1;
+    }
+  };
+}
+
+using GenericWitnessTableCache = MetadataCache<GenericWitnessTableCacheEntry>;
+using LazyGenericWitnessTableCache = Lazy<GenericWitnessTableCache>;
+
+/// Fetch the instantiation cache for a generic witness table structure.
+static GenericWitnessTableCache &getCache(GenericWitnessTable *genericTable) {
+  // Keep this assert even if you change the representation above.
+  static_assert(sizeof(LazyGenericWitnessTableCache) <=
+                sizeof(GenericWitnessTable::PrivateData),
+                "witness table cache is larger than the allowed space");
+
+  auto lazyCache =
+    reinterpret_cast<LazyGenericWitnessTableCache*>(genericTable->PrivateData);
+  return lazyCache->get();
+}
+
+const WitnessTable *
+swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
+                                    const Metadata *type,
+                                    void * const *instantiationArgs) {
+  const size_t numGenericArgs = 1;
+  const void *args[] = { type };
+  auto &cache = getCache(genericTable);
+  auto entry = cache.findOrAdd(args, numGenericArgs,
+    [&]() -> GenericWitnessTableCacheEntry* {
+      // Allocate the witness table right after the cache entry.
+      size_t numWords = genericTable->WitnessTableSizeInWords;
+      size_t numWordsToCopy = genericTable->WitnessTableSizeInWordsToCopy;
+      assert(numWordsToCopy <= numWords);
+      auto entry = GenericWitnessTableCacheEntry::allocate(
+                     cache.getAllocator(), args, numGenericArgs,
+                     numWords * sizeof(void*));
+
+      // Copy the pattern and zero-fill the rest.
+      auto table = entry->getData<void*>();
+      memcpy(table, reinterpret_cast<void * const *>(genericTable->Pattern),
+             numWordsToCopy * sizeof(void*));
+      memset(table + numWordsToCopy, 0,
+             (numWords - numWordsToCopy) * sizeof(void*));
+
+      // Fill in whatever depends on the type.
+      if (genericTable->Instantiator)
+        genericTable->Instantiator(reinterpret_cast<WitnessTable*>(table),
+                                   type, instantiationArgs);
+
+      return entry;
+    });
+
+  return entry->getData<WitnessTable>();
+}
+
 /*** Other metadata routines ***********************************************/
 
 const NominalTypeDescriptor *
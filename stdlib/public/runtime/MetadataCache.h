@@ -15,9 +15,12 @@
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "swift/Runtime/Concurrent.h"
+#include "swift/Runtime/Debug.h"
 #include "swift/Runtime/Metadata.h"
+#include "RuntimeStatistics.h"
 #include <mutex>
 #include <condition_variable>
+#include <thread>
 
 #ifndef SWIFT_DEBUG_RUNTIME
 #define SWIFT_DEBUG_RUNTIME 0
@@ -53,7 +56,7 @@ public:
     return Entry::fromArgumentsBuffer(args, length);
   }
 
-  bool operator==(EntryRef<Entry>& rhs) const {
+  bool operator==(const EntryRef<Entry> &rhs) const {
     // Compare the sizes.
     unsigned asize = size(), bsize = rhs.size();
     if (asize != bsize) return false;
@@ -140,85 +143,154 @@ public:
 
 /// The implementation of a metadata cache.  Note that all-zero must
 /// be a valid state for the cache.
+///
+/// Lookups of existing entries never take a lock. Misses take one of a
+/// small number of construction locks, selected by the hash of the key,
+/// only long enough to claim the key; the entry itself is built with no
+/// lock held, so unrelated instantiations proceed in parallel and an entry
+/// builder may re-entrantly look up other entries of the same cache.
 template <class Entry> class MetadataCache {
 
-  /// This pair ties an EntryRef Key and an Entry Value.
-  struct EntryPair {
-    EntryPair(EntryRef<Entry> K, Entry* V) : Key(K), Value(V) {}
+  /// The table of fully-constructed entries, keyed by the hash of their
+  /// arguments.
+  typedef ConcurrentOpenHashTable<Entry> MDTableTy;
+
+  /// A key that some thread is currently building an entry for.
+  /// These are allocated on the building thread's stack.
+  struct PendingEntry {
     EntryRef<Entry> Key;
-    Entry* Value;
+    size_t Hash;
+    std::thread::id Builder;
+    PendingEntry *Next;
+  };
+
+  /// A construction lock and the set of keys under construction that
+  /// hash to it.
+  struct ConstructionShard {
+    std::mutex Lock;
+    std::condition_variable Cond;
+    PendingEntry *Pending = nullptr;
   };
 
-  /// This collection maps hash codes to a list of entry pairs.
-  typedef ConcurrentMap<size_t, EntryPair> MDMapTy;
+  enum : size_t { NumConstructionShards = 16 };
 
-  /// This map hash codes of entry refs to a list of entry pairs.
-  MDMapTy *Map;
+  /// The completed entries of this cache.
+  MDTableTy *Table;
 
   /// Synchronization of metadata creation.
-  std::mutex *Lock;
-  
+  ConstructionShard *Shards;
+
   /// The head of a linked list connecting all the metadata cache entries.
   /// TODO: Remove this when LLDB is able to understand the final data
   /// structure for the metadata cache.
-  const Entry *Head;
+  std::atomic<const Entry *> Head;
 
   /// Allocator for entries of this cache.
   MetadataAllocator Allocator;
-  
+
+  static bool matches(const Entry *entry, EntryRef<Entry> key) {
+    auto entryKey = EntryRef<Entry>::forEntry(entry, entry->getNumArguments());
+    return entryKey == key;
+  }
+
+  const Entry *findExisting(EntryRef<Entry> key, size_t hash) const {
+    return Table->find(hash, [&](const Entry *entry) {
+      return matches(entry, key);
+    });
+  }
+
 public:
-  MetadataCache() : Map(new MDMapTy()), Lock(new std::mutex()) {}
-  ~MetadataCache() { delete Map; delete Lock; }
+  MetadataCache()
+    : Table(new MDTableTy()),
+      Shards(new ConstructionShard[NumConstructionShards]),
+      Head(nullptr) {}
+  ~MetadataCache() { delete Table; delete [] Shards; }
 
   /// Caches are not copyable.
   MetadataCache(const MetadataCache &other) = delete;
   MetadataCache &operator=(const MetadataCache &other) = delete;
 
   /// Get the allocator for metadata in this cache.
-  /// The allocator can only be safely used while the cache is locked during
-  /// an addMetadataEntry call.
+  /// The allocator is safe to use concurrently, so entry builders may
+  /// allocate from it without further synchronization.
   MetadataAllocator &getAllocator() { return Allocator; }
 
   /// Call entryBuilder() and add the generated metadata to the cache.
-  /// \p key is the key used by the cache and \p Bucket is the cache
-  /// entry to place the new metadata entry.
+  /// \p key is the key used by the cache and \p hash is its hash code.
   /// This method is marked as 'noinline' because it is infrequently executed
   /// and marking it as such generates better code that is easier to analyze
   /// and profile.
   __attribute__ ((noinline))
-  const Entry *addMetadataEntry(EntryRef<Entry> key,
-                                ConcurrentList<EntryPair> &Bucket,
+  const Entry *addMetadataEntry(EntryRef<Entry> key, size_t hash,
                                 llvm::function_ref<Entry *()> entryBuilder) {
-    // Hold a lock to prevent the modification of the cache by multiple threads.
-    std::unique_lock<std::mutex> ConstructionGuard(*Lock);
-
-    // Some other thread may have setup the value we are about to construct
-    // while we were asleep so do a search before constructing a new value.
-    for (auto &A : Bucket) {
-      if (A.Key == key) return A.Value;
+    ConstructionShard &shard = Shards[hash % NumConstructionShards];
+    auto self = std::this_thread::get_id();
+
+    // Claim the key, or wait for the thread that already claimed it.
+    std::unique_lock<std::mutex> guard(shard.Lock);
+    while (true) {
+      // Some other thread may have setup the value we are about to
+      // construct while we were asleep so do a search before constructing
+      // a new value.
+      if (auto existing = findExisting(key, hash))
+        return existing;
+
+      PendingEntry *pending = shard.Pending;
+      while (pending && !(pending->Hash == hash && pending->Key == key))
+        pending = pending->Next;
+      if (!pending)
+        break;
+
+      // An entry whose construction requires itself can never finish.
+      if (pending->Builder == self)
+        crash("recursive instantiation of metadata cache entry");
+
+      shard.Cond.wait(guard);
     }
 
+    PendingEntry claim{key, hash, self, shard.Pending};
+    shard.Pending = &claim;
+    guard.unlock();
+
     // Build the new cache entry.
     // For some cache types this call may re-entrantly perform additional
-    // cache lookups.
+    // cache lookups, including lookups in this cache.
     // Notice that the entry is completely constructed before it is inserted
-    // into the map, and that only one entry can be constructed at once
-    // because of the lock above.
+    // into the table, and that only one entry can be constructed for a given
+    // key at once because of the claim above.
+#if SWIFT_RUNTIME_ENABLE_STATISTICS
+    // The time includes any nested instantiations the builder triggers.
+    uint64_t startTime = SWIFT_RUNTIME_STATISTICS_NOW();
+#endif
     Entry *entry = entryBuilder();
     assert(entry);
+    SWIFT_RUNTIME_STATISTIC(MetadataConstructionNanoseconds,
+                            SWIFT_RUNTIME_STATISTICS_NOW() - startTime);
 
     // Update the linked list.
-    entry->Next = Head;
-    Head = entry;
-
-    key = EntryRef<Entry>::forEntry(entry, entry->getNumArguments());
-    Bucket.push_front(EntryPair(key, entry));
+    const Entry *oldHead = Head.load(std::memory_order_relaxed);
+    do {
+      entry->Next = oldHead;
+    } while (!Head.compare_exchange_weak(oldHead, entry,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+
+    Table->insert(hash, entry);
+
+    // Release the claim and wake up anyone waiting on this shard.
+    guard.lock();
+    PendingEntry **link = &shard.Pending;
+    while (*link != &claim)
+      link = &(*link)->Next;
+    *link = claim.Next;
+    guard.unlock();
+    shard.Cond.notify_all();
 
 #if SWIFT_DEBUG_RUNTIME
     printf("%s(%p): created %p\n",
            Entry::getName(), this, entry);
 #endif
-    return key.getEntry();
+    return entry;
   }
 
   /// Look up a cached metadata entry. If a cache match exists, return it.
@@ -242,16 +314,15 @@ public:
            Entry::getName(), this, hash);
 #endif
 
-    // Look for an existing entry.
-    // Find the bucket for the metadata entry.
-    ConcurrentList<EntryPair> &Bucket = Map->findOrAllocateNode(hash);
-    // Scan the bucket and return the value if we found the key.
-    for (auto &A : Bucket) {
-      if (A.Key == key) return A.Value;
+    // Look for an existing entry without taking any locks.
+    if (auto existing = findExisting(key, hash)) {
+      SWIFT_RUNTIME_STATISTIC(MetadataCacheHits, 1);
+      return existing;
     }
 
     // We did not find a key so we will need to create one and store it.
-    return addMetadataEntry(key, Bucket, entryBuilder);
+    SWIFT_RUNTIME_STATISTIC(MetadataCacheMisses, 1);
+    return addMetadataEntry(key, hash, entryBuilder);
   }
 };
 
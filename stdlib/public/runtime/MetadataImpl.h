@@ -263,6 +263,17 @@ struct SwiftRetainableBox :
   static void release(HeapObject *obj) {
     swift_release(obj);
   }
+
+  static void destroyArray(HeapObject **arr, size_t n) {
+    swift_releaseBatch(arr, n);
+  }
+
+  static HeapObject **initializeArrayWithCopy(HeapObject **dest,
+                                              HeapObject **src, size_t n) {
+    memcpy(dest, src, n * sizeof(HeapObject *));
+    swift_retainBatch(dest, n);
+    return dest;
+  }
 };
 
 /// A box implementation class for Swift unowned object pointers.
@@ -850,7 +861,7 @@ struct NonFixedBufferValueWitnesses : BufferValueWitnessesBase<Impl> {
                                                        ValueBuffer *src,
                                                        const Metadata *self) {
     auto vwtable = self->getValueWitnesses();
-    if (!IsKnownAllocated && !vwtable->isValueInline()) {
+    if (!IsKnownAllocated && vwtable->isValueInline()) {
       return Impl::initializeWithTake(reinterpret_cast<OpaqueValue*>(dest),
                                       reinterpret_cast<OpaqueValue*>(src),
                                       self);
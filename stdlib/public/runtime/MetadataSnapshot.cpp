@@ -0,0 +1,429 @@
+//===--- MetadataSnapshot.cpp - Prewarmed metadata snapshots --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Recording and replaying metadata snapshots; see MetadataSnapshot.h.
+//
+// Static pointers are recorded as an exported symbol of the image that
+// contains them, plus an offset into the symbol. Images are identified by
+// path, and by the size and modification time the file had when the
+// snapshot was recorded.
+//
+// A snapshot is a text file with one record per line:
+//
+//   image <size> <mtime> <path>
+//   generic <pattern> <argument>...
+//   tuple <labels> <witnesses> <element>...
+//
+// Each reference is "0" for null, "@<image>:<symbol>+<offset>" for an
+// address in the given image record, or "#<index>" for the metadata of the
+// given generic or tuple record. Indices count from zero, in file order.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Config.h"
+#include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/MetadataSnapshot.h"
+#include "llvm/ADT/DenseMap.h"
+#include "Private.h"
+
+#include <dlfcn.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+using namespace swift;
+
+static const char SnapshotHeader[] = "swift-metadata-snapshot 2\n";
+
+std::atomic<bool> swift::_swift_isRecordingMetadataSnapshot(false);
+
+/*****************************************************************************/
+/********************************* RECORDING *********************************/
+/*****************************************************************************/
+
+namespace {
+
+struct SnapshotRecorder {
+  std::mutex Lock;
+  FILE *File = nullptr;
+  /// The record index of each metadata recorded so far.
+  llvm::DenseMap<const void *, unsigned> Records;
+  /// The image record index of each image base address seen so far.
+  llvm::DenseMap<const void *, unsigned> Images;
+  unsigned NumRecords = 0;
+
+  /// Append a reference to a pointer to \p out. \p info is the result of
+  /// dladdr for the pointer, if it succeeded. Returns false if the pointer
+  /// is neither null, nor recorded metadata, nor an exported symbol.
+  bool addReference(std::string &out, const void *pointer,
+                    const Dl_info *info);
+
+  /// Write a record and, if it is recordable, give \p metadata its index.
+  void record(const char *kind, const void * const *references,
+              size_t numReferences, const Metadata *metadata);
+};
+
+} // end anonymous namespace
+
+static Lazy<SnapshotRecorder> Recorder;
+
+bool SnapshotRecorder::addReference(std::string &out, const void *pointer,
+                                    const Dl_info *info) {
+  char buffer[64];
+  if (!pointer) {
+    out += " 0";
+    return true;
+  }
+
+  auto found = Records.find(pointer);
+  if (found != Records.end()) {
+    snprintf(buffer, sizeof(buffer), " #%u", found->second);
+    out += buffer;
+    return true;
+  }
+
+  if (!info)
+    return false;
+
+  auto image = Images.find(info->dli_fbase);
+  if (image == Images.end()) {
+    struct stat status;
+    if (stat(info->dli_fname, &status) != 0)
+      return false;
+    fprintf(File, "image %lld %lld %s\n", (long long) status.st_size,
+            (long long) status.st_mtime, info->dli_fname);
+    unsigned index = Images.size();
+    image = Images.insert({info->dli_fbase, index}).first;
+  }
+
+  snprintf(buffer, sizeof(buffer), " @%u:", image->second);
+  out += buffer;
+  out += info->dli_sname;
+  snprintf(buffer, sizeof(buffer), "+%" PRIxPTR,
+           (uintptr_t) pointer - (uintptr_t) info->dli_saddr);
+  out += buffer;
+  return true;
+}
+
+void SnapshotRecorder::record(const char *kind,
+                              const void * const *references,
+                              size_t numReferences,
+                              const Metadata *metadata) {
+  // Symbolize the references before taking the lock: dladdr takes the
+  // dynamic loader's lock, and code which runs under that lock, like static
+  // initializers of images being loaded, may instantiate metadata.
+  std::vector<Dl_info> infos(numReferences);
+  std::vector<bool> symbolized(numReferences);
+  for (size_t i = 0; i < numReferences; ++i) {
+    Dl_info &info = infos[i];
+    symbolized[i] = references[i] && dladdr(references[i], &info) &&
+                    info.dli_fbase && info.dli_fname && info.dli_sname &&
+                    info.dli_saddr;
+  }
+
+  std::lock_guard<std::mutex> guard(Lock);
+  if (!File)
+    return;
+  std::string line = kind;
+  for (size_t i = 0; i < numReferences; ++i)
+    if (!addReference(line, references[i],
+                      symbolized[i] ? &infos[i] : nullptr))
+      return;
+  line += '\n';
+  fputs(line.c_str(), File);
+  Records[metadata] = NumRecords++;
+}
+
+void swift::_swift_recordGenericMetadata(GenericMetadata *pattern,
+                                         const void * const *arguments,
+                                         const Metadata *metadata) {
+  std::vector<const void *> references;
+  references.push_back(pattern);
+  references.insert(references.end(), arguments,
+                    arguments + pattern->NumKeyArguments);
+  Recorder.get().record("generic", references.data(), references.size(),
+                        metadata);
+}
+
+void swift::_swift_recordTupleTypeMetadata(size_t numElements,
+                                    const Metadata * const *elements,
+                                    const char *labels,
+                                    const ValueWitnessTable *proposedWitnesses,
+                                    const Metadata *metadata) {
+  // Label strings are not exported, so labeled tuples can't be replayed.
+  if (labels)
+    return;
+  std::vector<const void *> references;
+  references.push_back(labels);
+  references.push_back(proposedWitnesses);
+  references.insert(references.end(), elements, elements + numElements);
+  Recorder.get().record("tuple", references.data(), references.size(),
+                        metadata);
+}
+
+bool swift::swift_startRecordingMetadataSnapshot(const char *path) {
+  auto &recorder = Recorder.get();
+  std::lock_guard<std::mutex> guard(recorder.Lock);
+  if (recorder.File)
+    return false;
+  recorder.File = fopen(path, "w");
+  if (!recorder.File)
+    return false;
+  fputs(SnapshotHeader, recorder.File);
+  _swift_isRecordingMetadataSnapshot.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+void swift::swift_stopRecordingMetadataSnapshot() {
+  auto &recorder = Recorder.get();
+  std::lock_guard<std::mutex> guard(recorder.Lock);
+  if (!recorder.File)
+    return;
+  _swift_isRecordingMetadataSnapshot.store(false, std::memory_order_relaxed);
+  fclose(recorder.File);
+  recorder.File = nullptr;
+  recorder.Records.clear();
+  recorder.Images.clear();
+  recorder.NumRecords = 0;
+}
+
+/*****************************************************************************/
+/********************************* REPLAYING *********************************/
+/*****************************************************************************/
+
+namespace {
+
+/// An image record, resolved in this process.
+struct ResolvedImage {
+  /// The handle of the loaded image, or null if it isn't loaded or has
+  /// changed since the snapshot was recorded.
+  void *Handle;
+  std::string Path;
+};
+
+/// A reference, resolved in this process.
+struct ResolvedReference {
+  const void *Pointer;
+  /// The symbol of a static reference; empty for null and for recorded
+  /// metadata.
+  std::string Symbol;
+  uintptr_t Offset;
+};
+
+} // end anonymous namespace
+
+/// Resolve an "image" record to a handle of the loaded image.
+static ResolvedImage resolveImage(char *record) {
+  char *path;
+  long long size = strtoll(record, &path, 10);
+  long long mtime = strtoll(path, &path, 10);
+  if (*path++ != ' ')
+    return {nullptr, ""};
+  path[strcspn(path, "\n")] = '\0';
+
+  struct stat status;
+  if (stat(path, &status) != 0 || status.st_size != size ||
+      status.st_mtime != mtime)
+    return {nullptr, path};
+  // Only look at images which are already loaded.
+  return {dlopen(path, RTLD_LAZY | RTLD_NOLOAD), path};
+}
+
+/// Resolve a static reference "<image>:<symbol>+<offset>". The symbol has
+/// to be exported by the image, and the address has to lie within it as far
+/// as dladdr can tell.
+static bool resolveSymbol(char *next, char *&end,
+                          const std::vector<ResolvedImage> &images,
+                          ResolvedReference &reference) {
+  unsigned long image = strtoul(next, &end, 10);
+  if (end == next || *end != ':' || image >= images.size() ||
+      !images[image].Handle)
+    return false;
+
+  char *symbol = end + 1;
+  size_t symbolLength = strcspn(symbol, "+ \n");
+  if (symbolLength == 0 || symbol[symbolLength] != '+')
+    return false;
+  reference.Symbol.assign(symbol, symbolLength);
+
+  char *offset = symbol + symbolLength + 1;
+  reference.Offset = strtoull(offset, &end, 16);
+  if (end == offset)
+    return false;
+
+  auto base = dlsym(images[image].Handle, reference.Symbol.c_str());
+  if (!base)
+    return false;
+  reference.Pointer = (const char *) base + reference.Offset;
+
+  Dl_info info;
+  return dladdr(reference.Pointer, &info) && info.dli_fname &&
+         info.dli_sname && info.dli_saddr == base &&
+         images[image].Path == info.dli_fname &&
+         reference.Symbol == info.dli_sname;
+}
+
+/// Parse the references of a "generic" or "tuple" record. Returns false if
+/// any of them can't be resolved in this process.
+static bool resolveReferences(char *record,
+                              const std::vector<ResolvedImage> &images,
+                              const std::vector<const Metadata *> &metadata,
+                              std::vector<ResolvedReference> &references) {
+  references.clear();
+  char *next = record;
+  while (true) {
+    next += strspn(next, " ");
+    if (*next == '\0' || *next == '\n')
+      return true;
+
+    ResolvedReference reference = {nullptr, "", 0};
+    char *end;
+    if (*next == '0') {
+      end = next + 1;
+    } else if (*next == '#') {
+      unsigned long index = strtoul(next + 1, &end, 10);
+      if (end == next + 1 || index >= metadata.size() || !metadata[index])
+        return false;
+      reference.Pointer = metadata[index];
+    } else if (*next == '@') {
+      if (!resolveSymbol(next + 1, end, images, reference))
+        return false;
+    } else {
+      return false;
+    }
+    references.push_back(reference);
+    next = end;
+  }
+}
+
+static bool startsWith(const std::string &symbol, const char *prefix) {
+  return symbol.compare(0, strlen(prefix), prefix) == 0;
+}
+
+/// True if \p reference can be a generic argument: metadata, or a witness
+/// table for a protocol requirement.
+static bool isMetadataOrWitnessTable(const ResolvedReference &reference) {
+  if (!reference.Pointer)
+    return false;
+  return reference.Symbol.empty() || startsWith(reference.Symbol, "_TM") ||
+         startsWith(reference.Symbol, "_TW");
+}
+
+/// True if \p reference can be an element of a tuple.
+static bool isMetadata(const ResolvedReference &reference) {
+  if (!reference.Pointer)
+    return false;
+  return reference.Symbol.empty() || startsWith(reference.Symbol, "_TM");
+}
+
+static const Metadata *
+replayGenericRecord(const std::vector<ResolvedReference> &references) {
+  if (references.empty())
+    return nullptr;
+
+  // The pattern must be the start of an exported generic metadata pattern.
+  auto &patternReference = references[0];
+  if (!startsWith(patternReference.Symbol, "_TMP") ||
+      patternReference.Offset != 0)
+    return nullptr;
+  auto pattern = (GenericMetadata *) patternReference.Pointer;
+  if (references.size() != 1 + pattern->NumKeyArguments)
+    return nullptr;
+
+  std::vector<const void *> arguments;
+  for (size_t i = 1; i < references.size(); ++i) {
+    if (!isMetadataOrWitnessTable(references[i]))
+      return nullptr;
+    arguments.push_back(references[i].Pointer);
+  }
+  return swift_getGenericMetadata(pattern, arguments.data());
+}
+
+static const Metadata *
+replayTupleRecord(const std::vector<ResolvedReference> &references) {
+  if (references.size() <= 2)
+    return nullptr;
+
+  // Label strings are not exported, so only unlabeled tuples can be
+  // checked.
+  if (references[0].Pointer)
+    return nullptr;
+  auto &witnesses = references[1];
+  if (witnesses.Pointer && (!startsWith(witnesses.Symbol, "_TWV") ||
+                            witnesses.Offset != 0))
+    return nullptr;
+
+  std::vector<const Metadata *> elements;
+  for (size_t i = 2; i < references.size(); ++i) {
+    if (!isMetadata(references[i]))
+      return nullptr;
+    elements.push_back((const Metadata *) references[i].Pointer);
+  }
+  return swift_getTupleTypeMetadata(elements.size(), elements.data(),
+                          nullptr,
+                          (const ValueWitnessTable *) witnesses.Pointer);
+}
+
+size_t swift::swift_replayMetadataSnapshot(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return 0;
+
+  std::vector<ResolvedImage> images;
+  std::vector<const Metadata *> metadata;
+  std::vector<ResolvedReference> references;
+  size_t numReplayed = 0;
+
+  char *line = nullptr;
+  size_t capacity = 0;
+  if (getline(&line, &capacity, file) < 0 || strcmp(line, SnapshotHeader)) {
+    free(line);
+    fclose(file);
+    return 0;
+  }
+
+  while (getline(&line, &capacity, file) > 0) {
+    if (!strncmp(line, "image ", 6)) {
+      images.push_back(resolveImage(line + 6));
+      continue;
+    }
+
+    const Metadata *result = nullptr;
+    if (!strncmp(line, "generic ", 8)) {
+      if (resolveReferences(line + 8, images, metadata, references))
+        result = replayGenericRecord(references);
+    } else if (!strncmp(line, "tuple ", 6)) {
+      if (resolveReferences(line + 6, images, metadata, references))
+        result = replayTupleRecord(references);
+    } else {
+      // Unknown records may still be referenced by index.
+    }
+    if (result)
+      ++numReplayed;
+    metadata.push_back(result);
+  }
+
+  // Drop the references to the images which dlopen added.
+  for (auto &image : images)
+    if (image.Handle)
+      dlclose(image.Handle);
+
+  free(line);
+  fclose(file);
+  return numReplayed;
+}
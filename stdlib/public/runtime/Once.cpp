@@ -16,6 +16,8 @@
 
 #include "swift/Runtime/Once.h"
 #include "swift/Runtime/Debug.h"
+#include "swift/Basic/Lazy.h"
+#include <mutex>
 #include <type_traits>
 
 using namespace swift;
@@ -27,6 +29,16 @@ using namespace swift;
 #include <dispatch/dispatch.h>
 static_assert(std::is_same<swift_once_t, dispatch_once_t>::value,
               "swift_once_t and dispatch_once_t must stay in sync");
+#else
+
+/// The predicate value of a finished initialization. It is the same as
+/// dispatch_once's, and the compiler depends on it.
+static const swift_once_t OnceDone = -1L;
+
+/// Serializes the initializations that haven't finished yet. It is recursive
+/// because the initializer of a global may access other globals.
+static Lazy<std::recursive_mutex> OnceMutex;
+
 #endif
 // The compiler generates the swift_once_t values as word-sized zero-initialized
 // variables, so we want to make sure swift_once_t isn't larger than the
@@ -41,12 +53,14 @@ void swift::swift_once(swift_once_t *predicate, void (*fn)(void *)) {
 #if defined(__APPLE__)
   dispatch_once_f(predicate, nullptr, fn);
 #else
-  // FIXME: We're relying here on the coincidence that libstdc++ uses pthread's
-  // pthread_once, and that on glibc pthread_once follows a compatible init
-  // process (the token is a word that is atomically incremented from 0 to
-  // 1 to 2 during initialization) to work. We should implement our own version
-  // that we can rely on to continue to work that way.
-  // For more information, see rdar://problem/18499385
-  std::call_once(*predicate, [fn]() { fn(nullptr); });
+  // The compiler usually performs this check inline already.
+  if (__atomic_load_n(predicate, __ATOMIC_ACQUIRE) == OnceDone)
+    return;
+
+  std::lock_guard<std::recursive_mutex> guard(OnceMutex.get());
+  if (__atomic_load_n(predicate, __ATOMIC_RELAXED) == OnceDone)
+    return;
+  fn(nullptr);
+  __atomic_store_n(predicate, OnceDone, __ATOMIC_RELEASE);
 #endif
 }
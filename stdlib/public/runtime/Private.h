@@ -20,6 +20,7 @@
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Metadata.h"
 #include "llvm/Support/Compiler.h"
+#include <atomic>
 
 namespace swift {
   struct ProtocolDescriptor;
@@ -80,6 +81,16 @@ namespace swift {
     return object == nullptr || isObjCTaggedPointer(object);
   }
 
+  /// Native weak references hold a pointer to a side-table entry with this
+  /// bit set. Neither heap objects nor Objective-C tagged pointers set it.
+  static const uintptr_t NativeWeakReferenceTag = 2;
+
+  /// Does the value of a non-null, non-tagged weak reference refer to a
+  /// native object?
+  static inline bool isNativeWeakReferenceValue(const void *value) {
+    return ((uintptr_t) value) & NativeWeakReferenceTag;
+  }
+
   LLVM_LIBRARY_VISIBILITY
   const ClassMetadata *_swift_getClass(const void *object);
 
@@ -106,6 +117,26 @@ namespace swift {
   /// Returns true if common value witnesses were used, false otherwise.
   void installCommonValueWitnesses(ValueWitnessTable *vwtable);
 
+  /// True if this process records a metadata snapshot; see
+  /// MetadataSnapshot.h.
+  extern LLVM_LIBRARY_VISIBILITY
+  std::atomic<bool> _swift_isRecordingMetadataSnapshot;
+
+  /// Add freshly instantiated generic metadata to the metadata snapshot.
+  /// Must not be called while the metadata cache entry is being built.
+  LLVM_LIBRARY_VISIBILITY
+  void _swift_recordGenericMetadata(GenericMetadata *pattern,
+                                    const void * const *arguments,
+                                    const Metadata *metadata);
+
+  /// Add freshly instantiated tuple metadata to the metadata snapshot.
+  /// Must not be called while the metadata cache entry is being built.
+  LLVM_LIBRARY_VISIBILITY
+  void _swift_recordTupleTypeMetadata(size_t numElements,
+                                     const Metadata * const *elements,
+                                     const char *labels,
+                                     const ValueWitnessTable *proposedWitnesses,
+                                     const Metadata *metadata);
 
 } // end namespace swift
 
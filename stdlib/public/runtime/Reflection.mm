@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Reflection.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
@@ -214,8 +216,8 @@ struct MagicMirrorData {
   /// the ObjC class.
   const Metadata *Type;
 };
-static_assert(sizeof(MagicMirrorData) == sizeof(ValueBuffer),
-              "MagicMirrorData doesn't exactly fill a ValueBuffer");
+static_assert(sizeof(MagicMirrorData) <= sizeof(ValueBuffer),
+              "MagicMirrorData doesn't fit in a ValueBuffer");
   
 /// A magic implementation of Mirror that can use runtime metadata to walk an
 /// arbitrary object.
@@ -224,8 +226,11 @@ static_assert(sizeof(MagicMirrorData) == sizeof(ValueBuffer),
 /// _MirrorType protocol.
 class MagicMirror {
 public:
-  // The data for the mirror.
-  MagicMirrorData Data;
+  // The data for the mirror, padded out to the size of the value buffer.
+  union {
+    MagicMirrorData Data;
+    ValueBuffer Buffer;
+  };
 
   // The existential header.
   const Metadata *Self;
@@ -498,16 +503,47 @@ StringMirrorTuple swift_TupleMirror_subscript(intptr_t i,
   return result;
 }
   
+namespace {
+  /// The names of a doubly-null-terminated list, split up front so that
+  /// looking up the i-th name doesn't have to skip the i names before it.
+  struct FieldNamesCacheEntry {
+    const char *FieldNames;
+    /// One pointer per name, followed by a pointer to the terminating empty
+    /// string.
+    const char **Names;
+  };
+}
+
+static Lazy<ConcurrentMap<size_t, FieldNamesCacheEntry>> FieldNamesCache;
+
 // Get a field name from a doubly-null-terminated list.
 static const char *getFieldName(const char *fieldNames, size_t i) {
+  // The list is emitted once per nominal type, so its address identifies it.
+  ConcurrentList<FieldNamesCacheEntry> &Bucket =
+    FieldNamesCache.get().findOrAllocateNode((size_t)fieldNames);
+  for (auto &Entry : Bucket) {
+    if (Entry.FieldNames == fieldNames)
+      return Entry.Names[i];
+  }
+
+  size_t numNames = 0;
+  for (const char *fieldName = fieldNames; *fieldName;
+       fieldName += strlen(fieldName) + 1)
+    ++numNames;
+
+  // Threads racing to split the same list may each add an entry. That's
+  // harmless; the entries are equivalent.
+  auto names = reinterpret_cast<const char **>(
+    malloc((numNames + 1) * sizeof(const char *)));
   const char *fieldName = fieldNames;
-  for (size_t j = 0; j < i; ++j) {
-    size_t len = strlen(fieldName);
-    assert(len != 0);
-    fieldName += len + 1;
+  for (size_t j = 0; j <= numNames; ++j) {
+    names[j] = fieldName;
+    fieldName += strlen(fieldName) + 1;
   }
 
-  return fieldName;
+  Bucket.push_front({fieldNames, names});
+  assert(i <= numNames && "field index out of range");
+  return names[i];
 }
 
 // -- Struct destructuring.
@@ -559,7 +595,7 @@ static bool isEnumReflectable(const Metadata *type) {
   const auto &Description = Enum->Description->Enum;
 
   // No metadata for C and @objc enums yet
-  if (Description.CaseNames == nullptr)
+  if (Description.CaseNames.isNull())
     return false;
 
   return true;
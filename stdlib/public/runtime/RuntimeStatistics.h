@@ -0,0 +1,76 @@
+//===--- RuntimeStatistics.h ------------------------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Per-thread counters behind swift_getRuntimeStatistics. They are only
+// compiled in when the runtime is built with SWIFT_RUNTIME_ENABLE_STATISTICS;
+// otherwise the macros below expand to nothing.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_STDLIB_RUNTIME_STATISTICS_H
+#define SWIFT_STDLIB_RUNTIME_STATISTICS_H
+
+#if SWIFT_RUNTIME_ENABLE_STATISTICS
+
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <cstdint>
+
+namespace swift {
+
+enum class RuntimeStatistic : unsigned {
+#define RUNTIME_STATISTIC(Name, Description) Name,
+#include "swift/Runtime/RuntimeStatistics.def"
+  Last_RuntimeStatistic
+};
+
+/// The counters of one thread. Only the owning thread writes them, so an
+/// update is a relaxed load and store rather than an atomic add; the atomics
+/// just let swift_getRuntimeStatistics read them from another thread.
+struct ThreadRuntimeStatistics {
+  std::atomic<uint64_t>
+    Counters[unsigned(RuntimeStatistic::Last_RuntimeStatistic)];
+  ThreadRuntimeStatistics *Prev;
+  ThreadRuntimeStatistics *Next;
+};
+
+extern LLVM_LIBRARY_VISIBILITY __thread ThreadRuntimeStatistics *
+  _swift_threadRuntimeStatistics;
+
+/// Allocate and register the counters of the current thread.
+LLVM_LIBRARY_VISIBILITY
+ThreadRuntimeStatistics *_swift_registerThreadRuntimeStatistics();
+
+static inline void _swift_addRuntimeStatistic(RuntimeStatistic which,
+                                              uint64_t amount) {
+  auto statistics = _swift_threadRuntimeStatistics;
+  if (LLVM_UNLIKELY(!statistics))
+    statistics = _swift_registerThreadRuntimeStatistics();
+  auto &counter = statistics->Counters[unsigned(which)];
+  counter.store(counter.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
+
+/// The current time in nanoseconds, for timing statistics.
+LLVM_LIBRARY_VISIBILITY uint64_t _swift_runtimeStatisticsNow();
+
+} // end namespace swift
+
+#define SWIFT_RUNTIME_STATISTIC(Name, Amount)                                  \
+  ::swift::_swift_addRuntimeStatistic(::swift::RuntimeStatistic::Name, Amount)
+#define SWIFT_RUNTIME_STATISTICS_NOW() ::swift::_swift_runtimeStatisticsNow()
+#else
+#define SWIFT_RUNTIME_STATISTIC(Name, Amount)
+#define SWIFT_RUNTIME_STATISTICS_NOW() 0
+#endif
+
+#endif
@@ -0,0 +1,152 @@
+//===--- Statistics.cpp - Swift Runtime statistics ------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementation of the runtime statistics counters. Each thread counts into
+// its own block of counters. The blocks of running threads are kept in a
+// list, and a block is folded into the totals of finished threads when its
+// thread exits.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Config.h"
+#include "swift/Runtime/Statistics.h"
+#include "RuntimeStatistics.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if SWIFT_RUNTIME_ENABLE_STATISTICS
+#include <chrono>
+#include <pthread.h>
+#endif
+
+using namespace swift;
+
+#if SWIFT_RUNTIME_ENABLE_STATISTICS
+
+static constexpr unsigned NumRuntimeStatistics =
+  unsigned(RuntimeStatistic::Last_RuntimeStatistic);
+
+static_assert(sizeof(SwiftRuntimeStatistics)
+                == NumRuntimeStatistics * sizeof(uint64_t),
+              "SwiftRuntimeStatistics should have one field per statistic");
+
+__thread ThreadRuntimeStatistics *swift::_swift_threadRuntimeStatistics;
+
+/// Protects ThreadStatisticsList and FinishedThreadTotals.
+static pthread_mutex_t ThreadStatisticsLock = PTHREAD_MUTEX_INITIALIZER;
+static ThreadRuntimeStatistics *ThreadStatisticsList = nullptr;
+static uint64_t FinishedThreadTotals[NumRuntimeStatistics];
+
+static pthread_key_t ThreadStatisticsKey;
+static pthread_once_t ThreadStatisticsKeyOnce = PTHREAD_ONCE_INIT;
+
+/// Fold the counters of an exiting thread into the totals.
+static void retireThreadStatistics(void *value) {
+  auto statistics = static_cast<ThreadRuntimeStatistics *>(value);
+  pthread_mutex_lock(&ThreadStatisticsLock);
+  for (unsigned i = 0; i != NumRuntimeStatistics; ++i)
+    FinishedThreadTotals[i] +=
+      statistics->Counters[i].load(std::memory_order_relaxed);
+  if (statistics->Prev)
+    statistics->Prev->Next = statistics->Next;
+  else
+    ThreadStatisticsList = statistics->Next;
+  if (statistics->Next)
+    statistics->Next->Prev = statistics->Prev;
+  pthread_mutex_unlock(&ThreadStatisticsLock);
+
+  // Destructors of other thread-local values may still use the runtime,
+  // and would then register a fresh block for this thread.
+  _swift_threadRuntimeStatistics = nullptr;
+  delete statistics;
+}
+
+static void createThreadStatisticsKey() {
+  pthread_key_create(&ThreadStatisticsKey, retireThreadStatistics);
+}
+
+ThreadRuntimeStatistics *swift::_swift_registerThreadRuntimeStatistics() {
+  // This must not allocate through the Swift runtime, since allocation is
+  // itself counted.
+  auto statistics = new ThreadRuntimeStatistics();
+  pthread_mutex_lock(&ThreadStatisticsLock);
+  statistics->Prev = nullptr;
+  statistics->Next = ThreadStatisticsList;
+  if (ThreadStatisticsList)
+    ThreadStatisticsList->Prev = statistics;
+  ThreadStatisticsList = statistics;
+  pthread_mutex_unlock(&ThreadStatisticsLock);
+
+  pthread_once(&ThreadStatisticsKeyOnce, createThreadStatisticsKey);
+  pthread_setspecific(ThreadStatisticsKey, statistics);
+  _swift_threadRuntimeStatistics = statistics;
+  return statistics;
+}
+
+uint64_t swift::_swift_runtimeStatisticsNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool swift::swift_getRuntimeStatistics(SwiftRuntimeStatistics *statistics) {
+  uint64_t totals[NumRuntimeStatistics];
+  pthread_mutex_lock(&ThreadStatisticsLock);
+  memcpy(totals, FinishedThreadTotals, sizeof(totals));
+  for (auto thread = ThreadStatisticsList; thread; thread = thread->Next)
+    for (unsigned i = 0; i != NumRuntimeStatistics; ++i)
+      totals[i] += thread->Counters[i].load(std::memory_order_relaxed);
+  pthread_mutex_unlock(&ThreadStatisticsLock);
+
+  unsigned i = 0;
+#define RUNTIME_STATISTIC(Name, Description) statistics->Name = totals[i++];
+#include "swift/Runtime/RuntimeStatistics.def"
+  return true;
+}
+
+static void dumpRuntimeStatisticsAtExit() {
+  swift_dumpRuntimeStatistics();
+}
+
+static bool initializeRuntimeStatistics() {
+  if (getenv("SWIFT_DEBUG_DUMP_RUNTIME_STATISTICS"))
+    atexit(dumpRuntimeStatisticsAtExit);
+  return true;
+}
+
+SWIFT_ALLOWED_RUNTIME_GLOBAL_CTOR_BEGIN
+static bool RuntimeStatisticsInitialized = initializeRuntimeStatistics();
+SWIFT_ALLOWED_RUNTIME_GLOBAL_CTOR_END
+
+#else
+
+bool swift::swift_getRuntimeStatistics(SwiftRuntimeStatistics *statistics) {
+  memset(statistics, 0, sizeof(*statistics));
+  return false;
+}
+
+#endif
+
+void swift::swift_dumpRuntimeStatistics() {
+  SwiftRuntimeStatistics statistics;
+  if (!swift_getRuntimeStatistics(&statistics)) {
+    fprintf(stderr, "Swift runtime statistics are not enabled in this "
+                    "build of the runtime\n");
+    return;
+  }
+
+  fprintf(stderr, "Swift runtime statistics:\n");
+#define RUNTIME_STATISTIC(Name, Description)                                   \
+  fprintf(stderr, "%20" PRIu64 " %s\n", statistics.Name, Description);
+#include "swift/Runtime/RuntimeStatistics.def"
+}
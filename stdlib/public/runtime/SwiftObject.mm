@@ -856,6 +856,9 @@ void swift::swift_unknownUnownedTakeAssign(UnownedReference *dest,
 // FIXME: these are not really valid implementations; they assume too
 // much about the implementation of ObjC weak references, and the
 // loads from ->Value can race with clears by the runtime.
+//
+// A native weak reference holds a tagged side-table entry rather than an
+// object, so its kind is read off the value itself.
 
 static void doWeakInit(WeakReference *addr, void *value, bool valueIsNative) {
   assert(value != nullptr);
@@ -898,7 +901,7 @@ void swift::swift_unknownWeakAssign(WeakReference *addr, void *newValue) {
   if (isObjCTaggedPointerOrNull(oldValue))
     return doWeakInit(addr, newValue, newIsNative);
 
-  bool oldIsNative = usesNativeSwiftReferenceCounting_allocated(oldValue);
+  bool oldIsNative = isNativeWeakReferenceValue(oldValue);
 
   // If they're both native, we can use the native function.
   if (oldIsNative && newIsNative)
@@ -918,7 +921,7 @@ void *swift::swift_unknownWeakLoadStrong(WeakReference *addr) {
   void *value = addr->Value;
   if (isObjCTaggedPointerOrNull(value)) return value;
 
-  if (usesNativeSwiftReferenceCounting_allocated(value)) {
+  if (isNativeWeakReferenceValue(value)) {
     return swift_weakLoadStrong(addr);
   } else {
     return (void*) objc_loadWeakRetained((id*) &addr->Value);
@@ -929,7 +932,7 @@ void *swift::swift_unknownWeakTakeStrong(WeakReference *addr) {
   void *value = addr->Value;
   if (isObjCTaggedPointerOrNull(value)) return value;
 
-  if (usesNativeSwiftReferenceCounting_allocated(value)) {
+  if (isNativeWeakReferenceValue(value)) {
     return swift_weakTakeStrong(addr);
   } else {
     void *result = (void*) objc_loadWeakRetained((id*) &addr->Value);
@@ -941,7 +944,7 @@ void *swift::swift_unknownWeakTakeStrong(WeakReference *addr) {
 void swift::swift_unknownWeakDestroy(WeakReference *addr) {
   id object = (id) addr->Value;
   if (isObjCTaggedPointerOrNull(object)) return;
-  doWeakDestroy(addr, usesNativeSwiftReferenceCounting_allocated(object));
+  doWeakDestroy(addr, isNativeWeakReferenceValue(object));
 }
 void swift::swift_unknownWeakCopyInit(WeakReference *dest, WeakReference *src) {
   id object = (id) src->Value;
@@ -949,7 +952,7 @@ void swift::swift_unknownWeakCopyInit(WeakReference *dest, WeakReference *src) {
     dest->Value = (HeapObject*) object;
     return;
   }
-  if (usesNativeSwiftReferenceCounting_allocated(object))
+  if (isNativeWeakReferenceValue(object))
     return swift_weakCopyInit(dest, src);
   objc_copyWeak((id*) &dest->Value, (id*) src);
 }
@@ -959,7 +962,7 @@ void swift::swift_unknownWeakTakeInit(WeakReference *dest, WeakReference *src) {
     dest->Value = (HeapObject*) object;
     return;
   }
-  if (usesNativeSwiftReferenceCounting_allocated(object))
+  if (isNativeWeakReferenceValue(object))
     return swift_weakTakeInit(dest, src);
   objc_moveWeak((id*) &dest->Value, (id*) &src->Value);
 }
@@ -230,26 +230,20 @@ static intptr_t hashFinish(intptr_t HashState) {
   return HashState;
 }
 
-extern "C"
-intptr_t _swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
-  UErrorCode ErrorCode = U_ZERO_ERROR;
-  intptr_t HashState = HASH_SEED;
-  HashState = hashChunk(GetRootCollator(), HashState, Str, Length, &ErrorCode);
-
-  if (U_FAILURE(ErrorCode)) {
-    swift::crash("hashChunk: Unexpected error hashing unicode string.");
-  }
-  return hashFinish(HashState);
-}
-
-extern "C" intptr_t _swift_stdlib_unicode_hash_ascii(const char *Str,
-                                                     int32_t Length) {
+// Defined in Stubs.cpp.
+extern "C" intptr_t _swift_stdlib_countLeadingASCII_utf16(const uint16_t *Str,
+                                                          intptr_t Length);
+
+/// Hash a string of ASCII code units with the cached collation elements.
+/// This gives the same result as hashChunk would for the same characters.
+template <typename CodeUnit>
+static intptr_t hashASCII(const CodeUnit *Str, int32_t Length) {
   const ASCIICollation *Table = ASCIICollation::getTable();
   intptr_t HashState = HASH_SEED;
   int32_t Pos = 0;
   while (Pos < Length) {
-    const char c = Str[Pos++];
-    assert((c & 0x80) == 0 && "This table only exists for the ASCII subset");
+    const CodeUnit c = Str[Pos++];
+    assert(c < 0x80 && "This table only exists for the ASCII subset");
     intptr_t Elem = Table->map(c);
     // Ignore zero valued collation elements. They don't participate in the
     // ordering relation.
@@ -265,6 +259,28 @@ extern "C" intptr_t _swift_stdlib_unicode_hash_ascii(const char *Str,
   return hashFinish(HashState);
 }
 
+extern "C"
+intptr_t _swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
+  // UTF-16 strings are often ASCII, and then the collation iterator is not
+  // needed.
+  if (_swift_stdlib_countLeadingASCII_utf16(Str, Length) == Length)
+    return hashASCII(Str, Length);
+
+  UErrorCode ErrorCode = U_ZERO_ERROR;
+  intptr_t HashState = HASH_SEED;
+  HashState = hashChunk(GetRootCollator(), HashState, Str, Length, &ErrorCode);
+
+  if (U_FAILURE(ErrorCode)) {
+    swift::crash("hashChunk: Unexpected error hashing unicode string.");
+  }
+  return hashFinish(HashState);
+}
+
+extern "C" intptr_t _swift_stdlib_unicode_hash_ascii(const char *Str,
+                                                     int32_t Length) {
+  return hashASCII(reinterpret_cast<const unsigned char *>(Str), Length);
+}
+
 /// Convert the unicode string to uppercase. This function will return the
 /// required buffer length as a result. If this length does not match the
 /// 'DestinationCapacity' this function must be called again with a buffer of
@@ -36,6 +36,27 @@ extern "C" _SwiftEmptyArrayStorage _swiftEmptyArrayStorage = {
   }
 };
 
+#define ASCII_CHARACTER_STRING(c) { c, 0 }
+#define ASCII_CHARACTER_STRINGS_8(c)                                           \
+  ASCII_CHARACTER_STRING(c + 0), ASCII_CHARACTER_STRING(c + 1),                \
+  ASCII_CHARACTER_STRING(c + 2), ASCII_CHARACTER_STRING(c + 3),                \
+  ASCII_CHARACTER_STRING(c + 4), ASCII_CHARACTER_STRING(c + 5),                \
+  ASCII_CHARACTER_STRING(c + 6), ASCII_CHARACTER_STRING(c + 7)
+#define ASCII_CHARACTER_STRINGS_32(c)                                          \
+  ASCII_CHARACTER_STRINGS_8(c + 0), ASCII_CHARACTER_STRINGS_8(c + 8),          \
+  ASCII_CHARACTER_STRINGS_8(c + 16), ASCII_CHARACTER_STRINGS_8(c + 24)
+
+extern "C" _SwiftASCIICharacterStrings _swiftASCIICharacterStrings = {
+  {
+    ASCII_CHARACTER_STRINGS_32(0), ASCII_CHARACTER_STRINGS_32(32),
+    ASCII_CHARACTER_STRINGS_32(64), ASCII_CHARACTER_STRINGS_32(96)
+  }
+};
+
+#undef ASCII_CHARACTER_STRINGS_32
+#undef ASCII_CHARACTER_STRINGS_8
+#undef ASCII_CHARACTER_STRING
+
 extern "C"
 uint64_t _swift_stdlib_HashingDetail_fixedSeedOverride = 0;
 
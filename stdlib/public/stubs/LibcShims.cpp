@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "../SwiftShims/LibcShims.h"
+#include "swift/Runtime/Heap.h"
 
 #if defined(__linux__)
 #include <bsd/stdlib.h>
@@ -30,6 +31,12 @@ void _swift_stdlib_free(void *ptr) { free(ptr); }
 
 int _swift_stdlib_putchar(int c) { return putchar(c); }
 
+__swift_size_t _swift_stdlib_fwrite_stdout(const void *ptr,
+                                           __swift_size_t size,
+                                           __swift_size_t nitems) {
+  return fwrite(ptr, size, nitems, stdout);
+}
+
 __swift_size_t _swift_stdlib_strlen(const char *s) { return strlen(s); }
 
 int _swift_stdlib_memcmp(const void *s1, const void *s2, __swift_size_t n) {
@@ -47,22 +54,10 @@ __swift_ssize_t _swift_stdlib_write(int fd, const void *buf,
 
 int _swift_stdlib_close(int fd) { return close(fd); }
 
-#if defined(__APPLE__)
-#include <malloc/malloc.h>
-size_t _swift_stdlib_malloc_size(const void *ptr) { return malloc_size(ptr); }
-#elif defined(__GNU_LIBRARY__)
-#include <malloc.h>
+// Heap objects come from swift_slowAlloc, which does not always use malloc.
 size_t _swift_stdlib_malloc_size(const void *ptr) {
-  return malloc_usable_size(const_cast<void *>(ptr));
+  return swift_slowAllocSize(ptr);
 }
-#elif defined(__FreeBSD__)
-#include <malloc_np.h>
-size_t _swift_stdlib_malloc_size(const void *ptr) {
-  return malloc_usable_size(const_cast<void *>(ptr));
-}
-#else
-#error No malloc_size analog known for this platform/libc.
-#endif
 
 __swift_uint32_t _swift_stdlib_arc4random(void) { return arc4random(); }
 
@@ -22,7 +22,11 @@
 
 #include <sys/resource.h>
 #include <sys/errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <unistd.h>
+#include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstdarg>
 #include <cstdint>
@@ -31,9 +35,17 @@
 #include <cstring>
 #include <xlocale.h>
 #include <limits>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 #include "llvm/ADT/StringExtras.h"
+#include "swift/Runtime/Config.h"
 #include "swift/Runtime/Debug.h"
 #include "swift/Basic/Lazy.h"
+#include "../SwiftShims/GlobalObjects.h"
 
 static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
                                    int64_t Radix, bool Uppercase,
@@ -41,13 +53,46 @@ static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
   char *P = Buffer;
   uint64_t Y = Value;
 
+  if (Radix == 10) {
+    // Write the digits back to front, two at a time, straight into their
+    // final position.
+    static const char DigitPairs[] =
+      "00010203040506070809"
+      "10111213141516171819"
+      "20212223242526272829"
+      "30313233343536373839"
+      "40414243444546474849"
+      "50515253545556575859"
+      "60616263646566676869"
+      "70717273747576777879"
+      "80818283848586878889"
+      "90919293949596979899";
+
+    size_t Length = 1;
+    for (uint64_t Z = Y; Z >= 10; Z /= 10)
+      ++Length;
+    if (Negative)
+      *P++ = '-';
+    P += Length;
+    char *End = P;
+
+    while (Y >= 100) {
+      const char *Pair = &DigitPairs[(Y % 100) * 2];
+      Y /= 100;
+      *--P = Pair[1];
+      *--P = Pair[0];
+    }
+    if (Y >= 10) {
+      *--P = DigitPairs[Y * 2 + 1];
+      *--P = DigitPairs[Y * 2];
+    } else {
+      *--P = '0' + char(Y);
+    }
+    return size_t(End - Buffer);
+  }
+
   if (Y == 0) {
     *P++ = '0';
-  } else if (Radix == 10) {
-    while (Y) {
-      *P++ = '0' + char(Y % 10);
-      Y /= 10;
-    }
   } else {
     unsigned Radix32 = Radix;
     while (Y) {
@@ -366,3 +411,174 @@ extern "C" int _swift_stdlib_putc_stderr(int C) {
 extern "C" size_t _swift_stdlib_getHardwareConcurrency() {
   return sysconf(_SC_NPROCESSORS_ONLN);
 }
+
+static size_t readArrayGrowthPercent() {
+  const char *Value = getenv("SWIFT_ARRAY_GROWTH_PERCENT");
+  if (!Value)
+    return 200;
+  char *End;
+  unsigned long Percent = strtoul(Value, &End, 10);
+  if (*Value == '\0' || *End != '\0' || Percent < 110 || Percent > 400)
+    return 200;
+  return Percent;
+}
+
+extern "C" size_t _swift_stdlib_getArrayGrowthPercent() {
+  static size_t Percent = readArrayGrowthPercent();
+  return Percent;
+}
+
+static uint64_t randomHashingSeed() {
+  uint64_t Seed = 0;
+#if defined(__APPLE__) || defined(__FreeBSD__)
+  arc4random_buf(&Seed, sizeof(Seed));
+#else
+  int FD = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+  if (FD >= 0) {
+    if (read(FD, &Seed, sizeof(Seed)) != sizeof(Seed))
+      Seed = 0;
+    close(FD);
+  }
+  if (Seed == 0)
+    swift::crash("Could not read a random hashing seed from /dev/urandom");
+#endif
+  return Seed;
+}
+
+/// SWIFT_HASHING_SEED replaces the fixed seed of the hash functions in
+/// Hashing.swift and SipHash.swift, either with the given number or, if it
+/// is "random", with a per-process random seed. It is read before any Swift
+/// code runs, because the seed must not change while hashed collections
+/// exist.
+static bool initializeHashingSeed() {
+  const char *Value = getenv("SWIFT_HASHING_SEED");
+  if (!Value || *Value == '\0')
+    return true;
+  uint64_t Seed;
+  if (strcmp(Value, "random") == 0) {
+    Seed = randomHashingSeed();
+  } else {
+    char *End;
+    Seed = strtoull(Value, &End, 0);
+    if (*End != '\0')
+      return true;
+  }
+  // Zero means that there is no override.
+  if (Seed != 0)
+    swift::_swift_stdlib_HashingDetail_fixedSeedOverride = Seed;
+  return true;
+}
+
+SWIFT_ALLOWED_RUNTIME_GLOBAL_CTOR_BEGIN
+static bool HashingSeedInitialized = initializeHashingSeed();
+SWIFT_ALLOWED_RUNTIME_GLOBAL_CTOR_END
+
+namespace {
+struct ConcurrentPerformState {
+  std::atomic<size_t> NextIndex;
+  size_t Iterations;
+  void *Context;
+  void (*Work)(void *, size_t);
+};
+} // end anonymous namespace
+
+static void *concurrentPerformWorker(void *Arg) {
+  auto *State = static_cast<ConcurrentPerformState *>(Arg);
+  for (;;) {
+    size_t Index = State->NextIndex.fetch_add(1, std::memory_order_relaxed);
+    if (Index >= State->Iterations)
+      return nullptr;
+    State->Work(State->Context, Index);
+  }
+}
+
+extern "C" void
+_swift_stdlib_concurrentPerform(size_t Iterations, void *Context,
+                                void (*Work)(void *, size_t)) {
+  ConcurrentPerformState State;
+  State.NextIndex.store(0, std::memory_order_relaxed);
+  State.Iterations = Iterations;
+  State.Context = Context;
+  State.Work = Work;
+
+  // The calling thread does its share of the work, too.  If a thread cannot
+  // be started, the remaining threads pick up its iterations.
+  size_t ThreadCount = std::min(Iterations,
+                                _swift_stdlib_getHardwareConcurrency());
+  std::vector<pthread_t> Threads;
+  for (size_t I = 1; I < ThreadCount; ++I) {
+    pthread_t Thread;
+    if (pthread_create(&Thread, nullptr, concurrentPerformWorker, &State) != 0)
+      break;
+    Threads.push_back(Thread);
+  }
+  concurrentPerformWorker(&State);
+  for (pthread_t Thread : Threads)
+    pthread_join(Thread, nullptr);
+}
+
+/// Return the number of leading elements of Str that are below 0x80.
+/// WordMask has the high bit of every element in a word set.
+template <typename CodeUnit, uint64_t WordMask>
+static intptr_t countLeadingASCIIWordwise(const CodeUnit *Str, intptr_t Pos,
+                                          intptr_t Length) {
+  constexpr intptr_t UnitsPerWord = sizeof(uint64_t) / sizeof(CodeUnit);
+  for (; Pos + UnitsPerWord <= Length; Pos += UnitsPerWord) {
+    uint64_t Word;
+    memcpy(&Word, Str + Pos, sizeof(Word));
+    if (Word & WordMask)
+      break;
+  }
+  while (Pos < Length && Str[Pos] < 0x80)
+    ++Pos;
+  return Pos;
+}
+
+// These scan 16 bytes at a time where the target has vectors, and 8 bytes
+// at a time otherwise. A non-ASCII block is rescanned one element at a time
+// to find the exact position.
+
+extern "C" intptr_t _swift_stdlib_countLeadingASCII_utf8(const uint8_t *Str,
+                                                         intptr_t Length) {
+  intptr_t Pos = 0;
+#if defined(__SSE2__)
+  for (; Pos + 16 <= Length; Pos += 16) {
+    __m128i Block = _mm_loadu_si128((const __m128i *)(Str + Pos));
+    if (_mm_movemask_epi8(Block))
+      break;
+  }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+  for (; Pos + 16 <= Length; Pos += 16) {
+    uint8x16_t Block = vld1q_u8(Str + Pos);
+    uint8x8_t High = vorr_u8(vget_low_u8(Block), vget_high_u8(Block));
+    if (vget_lane_u64(vreinterpret_u64_u8(High), 0) & 0x8080808080808080ULL)
+      break;
+  }
+#endif
+  return countLeadingASCIIWordwise<uint8_t, 0x8080808080808080ULL>(
+    Str, Pos, Length);
+}
+
+extern "C" intptr_t _swift_stdlib_countLeadingASCII_utf16(const uint16_t *Str,
+                                                          intptr_t Length) {
+  intptr_t Pos = 0;
+#if defined(__SSE2__)
+  const __m128i NonASCII = _mm_set1_epi16((short)0xFF80);
+  const __m128i Zero = _mm_setzero_si128();
+  for (; Pos + 8 <= Length; Pos += 8) {
+    __m128i Block = _mm_loadu_si128((const __m128i *)(Str + Pos));
+    __m128i IsASCII = _mm_cmpeq_epi16(_mm_and_si128(Block, NonASCII), Zero);
+    if (_mm_movemask_epi8(IsASCII) != 0xFFFF)
+      break;
+  }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+  for (; Pos + 8 <= Length; Pos += 8) {
+    uint16x8_t Block = vld1q_u16(Str + Pos);
+    uint16x4_t High = vorr_u16(vget_low_u16(Block), vget_high_u16(Block));
+    if (vget_lane_u64(vreinterpret_u64_u16(High), 0) & 0xFF80FF80FF80FF80ULL)
+      break;
+  }
+#endif
+  return countLeadingASCIIWordwise<uint16_t, 0xFF80FF80FF80FF80ULL>(
+    Str, Pos, Length);
+}
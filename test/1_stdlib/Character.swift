@@ -251,6 +251,23 @@ CharacterTests.test(
     { x in { String(Character(x)) < String(Character($0)) } } as PredicateFn)
 }
 
+CharacterTests.test("String(Character(x)) for ASCII x is not shared by mutation") {
+  // Single ASCII character strings share static storage; mutating one
+  // must not change any other.
+  var first = String(Character("a"))
+  let second = String(Character("a"))
+  first.append(Character("b"))
+  first.appendContentsOf("\u{e9}")
+  var third = String(Character("c"))
+  third.replaceRange(third.startIndex..<third.endIndex, with: "d")
+  expectEqual("ab\u{e9}", first)
+  expectEqual("a", second)
+  expectEqual("a", String(Character("a")))
+  expectEqual("d", third)
+  expectEqual("c", String(Character("c")))
+  expectEqual(0, String(Character("\0")).utf8.first)
+}
+
 CharacterTests.test("String.append(_: Character)") {
   for test in testCharacters {
     let character = Character(test)
@@ -0,0 +1,133 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+// REQUIRES: OS=linux-gnu
+
+import StdlibUnittest
+import Glibc
+
+// Also import modules which are used by StdlibUnittest internally. This
+// workaround is needed to link all required libraries in case we compile
+// StdlibUnittest with -sil-serialize-all.
+import SwiftPrivate
+
+var GlibcIOTests = TestSuite("GlibcIOTests")
+
+let fn = "glibc_io_test.txt"
+
+GlibcIOTests.setUp {
+  unlink(fn)
+}
+
+func writeFile(contents: [String]) {
+  let fd = open(fn, O_WRONLY | O_CREAT | O_TRUNC, 0o666)
+  expectNotEqual(-1, fd)
+  let chunks = contents.map { Array($0.utf8) }
+  let storage = chunks.map {
+    (chunk) -> UnsafeMutablePointer<UInt8> in
+    let bytes = UnsafeMutablePointer<UInt8>.alloc(chunk.count)
+    bytes.initializeFrom(chunk)
+    return bytes
+  }
+  let buffers = zip(storage, chunks).map {
+    UnsafeBufferPointer(start: UnsafePointer<UInt8>($0), count: $1.count)
+  }
+  let written = writev(fd, buffers)
+  expectEqual(chunks.reduce(0) { $0 + $1.count }, written)
+  for (bytes, chunk) in zip(storage, chunks) {
+    bytes.dealloc(chunk.count)
+  }
+  close(fd)
+}
+
+func lines(reader: FileDescriptorReader) -> [[UInt8]] {
+  var result: [[UInt8]] = []
+  while let line = reader.nextLine() {
+    result.append(Array(line))
+  }
+  return result
+}
+
+let expectedLines = ["alpha", "", "a much longer line than the buffer", "z"]
+  .map { Array($0.utf8) }
+
+GlibcIOTests.test("writev, then read lines with a growing buffer") {
+  writeFile(["alpha\n\na much ", "longer line than the buffer\n", "z"])
+
+  let fd = open(fn, O_RDONLY)
+  expectNotEqual(-1, fd)
+  let reader = FileDescriptorReader(fileDescriptor: fd, bufferSize: 4)
+  let result = lines(reader)
+  expectEqual(expectedLines.count, result.count)
+  for (expected, actual) in zip(expectedLines, result) {
+    expectEqualSequence(expected, actual)
+  }
+  close(fd)
+}
+
+GlibcIOTests.test("buffered read(into:)") {
+  writeFile(["0123456789"])
+
+  let fd = open(fn, O_RDONLY)
+  expectNotEqual(-1, fd)
+  let reader = FileDescriptorReader(fileDescriptor: fd, bufferSize: 8)
+  var bytes = [UInt8](count: 3, repeatedValue: 0)
+  var result: [UInt8] = []
+  while true {
+    let count = bytes.withUnsafeMutableBufferPointer {
+      reader.read(into: $0)
+    }
+    expectGE(count, 0)
+    if count == 0 { break }
+    result += bytes[0..<count]
+  }
+  expectEqualSequence(Array("0123456789".utf8), result)
+  close(fd)
+}
+
+GlibcIOTests.test("readv") {
+  writeFile(["abcdef"])
+
+  let fd = open(fn, O_RDONLY)
+  expectNotEqual(-1, fd)
+  var first = [UInt8](count: 2, repeatedValue: 0)
+  var second = [UInt8](count: 8, repeatedValue: 0)
+  let count = first.withUnsafeMutableBufferPointer {
+    (first) -> Int in
+    second.withUnsafeMutableBufferPointer {
+      (second) -> Int in
+      readv(fd, [first, second])
+    }
+  }
+  expectEqual(6, count)
+  expectEqualSequence(Array("ab".utf8), first)
+  expectEqualSequence(Array("cdef".utf8), second[0..<4])
+  close(fd)
+}
+
+GlibcIOTests.test("MappedFile") {
+  writeFile(["alpha\n\na much longer line than the buffer\nz\n"])
+
+  let file = MappedFile(path: fn)!
+  expectEqual(44, file.count)
+  expectEqual(UInt8(ascii: "a"), file[0])
+  let result = file.lines.map { Array($0) }
+  expectEqual(expectedLines.count, result.count)
+  for (expected, actual) in zip(expectedLines, result) {
+    expectEqualSequence(expected, actual)
+  }
+}
+
+GlibcIOTests.test("MappedFile/empty") {
+  writeFile([])
+
+  let file = MappedFile(path: fn)!
+  expectEqual(0, file.count)
+  expectEqual(0, Array(file.lines).count)
+}
+
+GlibcIOTests.test("MappedFile/missing") {
+  expectEmpty(MappedFile(path: fn))
+  expectEqual(ENOENT, errno)
+}
+
+runAllTests()
@@ -72,6 +72,16 @@ final class TestManagedBuffer<T> : ManagedBuffer<CountAndCapacity,T> {
     return r as! TestManagedBuffer
   }
 
+  class func create(
+    capacity: Int, arena: ManagedBufferArena
+  ) -> TestManagedBuffer {
+    let r = super.create(capacity, arena: arena) {
+      CountAndCapacity(
+        count: LifetimeTracked(0), capacity: $0.allocatedElementCount)
+    }
+    return r as! TestManagedBuffer
+  }
+
   var count: Int {
     get {
       return value.count.value
@@ -244,6 +254,25 @@ tests.test("ManagedBufferPointer") {
   }
 }
 
+tests.test("arena") {
+  if true {
+    let arena = ManagedBufferArena(blockSize: 1024)
+    for i in 0..<100 {
+      // Some of the buffers need a block of their own.
+      let capacity = i % 10 == 9 ? 1000 : i
+      let s = TestManagedBuffer<LifetimeTracked>.create(
+        capacity, arena: arena)
+      expectLE(capacity, s.capacity)
+      for j in 0..<(capacity / 2) {
+        s.append(LifetimeTracked(j))
+      }
+      expectEqual(capacity / 2 + 1, LifetimeTracked.instances)
+    }
+    expectEqual(0, LifetimeTracked.instances)
+  }
+  expectEqual(0, LifetimeTracked.instances)
+}
+
 tests.test("isUniquelyReferenced") {
   var s = TestManagedBuffer<LifetimeTracked>.create(0)
   expectTrue(isUniquelyReferenced(&s))
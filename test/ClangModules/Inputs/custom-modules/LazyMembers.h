@@ -0,0 +1,19 @@
+@import ObjectiveC;
+@import Foundation;
+
+@protocol LazyMembersProto
+- (void)protocolMethod;
+@property (readonly) NSInteger protocolProperty;
+@end
+
+@interface LazyMembers : NSObject <LazyMembersProto>
++ (instancetype)lazyMembersWithValue:(NSInteger)value;
+- (void)instanceMethod;
++ (void)classMethod;
+@property NSInteger value;
+@end
+
+@interface LazyMembers (Category)
+- (void)categoryMethod;
+@property (readonly) NSInteger categoryProperty;
+@end
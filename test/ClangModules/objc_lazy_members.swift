@@ -0,0 +1,32 @@
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse -verify -I %S/Inputs/custom-modules -enable-swift-name-lookup-tables %s
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse -verify -I %S/Inputs/custom-modules %s
+
+// REQUIRES: objc_interop
+
+// With lookup tables, the members of an Objective-C class are imported by
+// name as they are looked up. Make sure every kind of member is still found.
+
+import LazyMembers
+
+func testLazyMembers(obj: LazyMembers) {
+  obj.instanceMethod()
+  LazyMembers.classMethod()
+  obj.value = obj.value + 1
+
+  // Members of categories.
+  obj.categoryMethod()
+  _ = obj.categoryProperty
+
+  // Members of adopted protocols.
+  obj.protocolMethod()
+  _ = obj.protocolProperty
+
+  // Initializers, including factory methods.
+  _ = LazyMembers()
+  _ = LazyMembers(value: 1)
+
+  // Members of the superclass.
+  _ = obj.description
+
+  obj.missingMethod() // expected-error{{value of type 'LazyMembers' has no member 'missingMethod'}}
+}
@@ -0,0 +1,24 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse -verify -module-cache-path %t/clang-module-cache -enable-swift-name-lookup-tables %s
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse -verify -module-cache-path %t/clang-module-cache -enable-swift-name-lookup-tables %s
+
+// REQUIRES: objc_interop
+
+// With lookup tables, the Swift names of Clang declarations are recorded in
+// the module file when it is built. The second run reads them back from the
+// cached module, so both runs must see the same names.
+
+import Foundation
+
+func testFactoryInitializers(queen: Bee, path: String) throws {
+  _ = Hive(queen: queen)
+  _ = try Hive(flakyQueen: queen)
+  _ = try NSString(contentsOfFile: path)
+}
+
+func testMembers(hive: Hive) {
+  _ = hive.makingHoney
+  hive.guard = hive
+  _ = hive.bees[0] as Bee
+  _ = hive.anythingToBees
+}
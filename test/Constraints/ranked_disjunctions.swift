@@ -0,0 +1,38 @@
+// RUN: %target-parse-verify-swift -solver-rank-disjunction-choices
+
+// Ranking the terms of a disjunction only changes the order in which they
+// are attempted; the solutions picked must stay the same.
+
+func f0(_: Float) -> Float {}
+func f0(_: Int) -> Int {}
+func f0(_: Double) -> Double {}
+func f0<T>(_: T) -> T {}
+
+func g0(_: Int, _: Int) -> Int {}
+func g0(_: Double, _: Int) -> Double {}
+
+struct NotALiteral {}
+
+let i: Int = 0
+let d: Double = 0
+
+let r1: Int = f0(i)
+let r2: Double = f0(d)
+let r3: Float = f0(1)
+let r4 = f0(1)
+let _: Int = r4
+let r5 = f0(NotALiteral())
+let _: NotALiteral = r5
+let r6 = g0(d, 1)
+let _: Double = r6
+let r7 = g0(1, 1)
+let _: Int = r7
+
+// Literal-heavy arithmetic that needs both operator ranking and literal
+// defaults to type-check quickly.
+let sum = 1 + 2 * 3 - 4 / 5 + 6 * 7 - 8 + 9 * 10 - 11 + 12
+let _: Int = sum
+let mixed = d + 1 * 2.5 - 3 / d + 4 * 5 - 6
+let _: Double = mixed
+let weird = i + 1.5 // expected-error{{binary operator '+' cannot be applied to operands of type 'Int' and 'Double'}}
+// expected-note @-1 {{overloads for '+' exist with these partially matching parameter lists:}}
@@ -0,0 +1,35 @@
+// RUN: %target-parse-verify-swift
+
+// Elements of a collection literal with the same shape share their type
+// variables; make sure that doesn't change the types that get picked.
+
+func isType<T>(_: T, _: T.Type) {}
+
+let ints = [1, 2, 3, 4, 5, 6, 7, 8]
+isType(ints, [Int].self)
+
+let doubles: [Double] = [1, 2, 3.5, 4, 5.5]
+isType(doubles, [Double].self)
+
+let mixed: [Any] = [1, "two", 3, 4.5, "five", 6, true]
+isType(mixed, [Any].self)
+
+let optionals: [Int?] = [1, nil, 2, nil, 3]
+isType(optionals, [Int?].self)
+
+let nested = [[1, 2], [3, 4], [5], [6, 7, 8]]
+isType(nested, [[Int]].self)
+
+let nestedDoubles: [[Double]] = [[1, 2], [3.5], [4, 5]]
+isType(nestedDoubles, [[Double]].self)
+
+let tuples = [(1, "one"), (2, "two"), (3, "three")]
+isType(tuples, [(Int, String)].self)
+
+let dictionary = ["one": [1], "two": [2, 2], "three": [3, 3, 3]]
+isType(dictionary, [String: [Int]].self)
+
+let dictionaryOfDoubles: [String: Double] = ["a": 1, "b": 2.5, "c": 3]
+isType(dictionaryOfDoubles, [String: Double].self)
+
+let bad: [Int] = [1, 2, "three", 4] // expected-error{{cannot convert value of type 'String' to expected element type 'Int'}}
@@ -14,6 +14,9 @@
 // RUN: %target-ld %t/ASTSection.o -add_ast_path %t/ASTSection.swiftmodule -o %t/ASTSection.dylib -dylib -lSystem -lobjc
 // RUN: %lldb-moduleimport-test %t/ASTSection.dylib | FileCheck %s
 
+// Modules which aren't imported are not deserialized.
+// RUN: %lldb-moduleimport-test %t/ASTSection.dylib -import-module Swift | FileCheck -check-prefix=LAZY %s
+
 // REQUIRES: OS=macosx
 
 // CHECK: Loaded module ASTSection from
@@ -21,3 +24,8 @@
 // CHECK: - SDK path: /fake/sdk/path{{$}}
 // CHECK: - -Xcc options: -working-directory {{.+}} -DA -DB
 // CHECK: Importing ASTSection... ok!
+// CHECK: Deserialized ASTSection
+
+// LAZY: Loaded module ASTSection from
+// LAZY: Importing Swift... ok!
+// LAZY-NOT: Deserialized ASTSection
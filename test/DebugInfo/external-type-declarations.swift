@@ -0,0 +1,26 @@
+// RUN: %target-swift-frontend %s -emit-ir -g -o - | FileCheck -check-prefix=FULL %s
+// RUN: %target-swift-frontend %s -emit-ir -g -debug-info-external-type-declarations -o - | FileCheck %s
+
+// Types from the standard library are only declared, by mangled name...
+// CHECK: !DICompositeType(tag: DW_TAG_structure_type, name: "Int64"
+// CHECK-SAME:             size: 64, align: 64
+// CHECK-SAME:             DIFlagFwdDecl
+// CHECK-SAME:             identifier: "_TtVs5Int64"
+
+// ...while the types of this module are still emitted in full.
+// CHECK: !DICompositeType(tag: DW_TAG_structure_type, name: "Point"
+// CHECK-NOT:              DIFlagFwdDecl
+// CHECK-SAME:             identifier: "_TtV26external_type_declarations5Point"
+
+// FULL: !DICompositeType(tag: DW_TAG_structure_type, name: "Int64"
+// FULL-NOT:              DIFlagFwdDecl
+// FULL-SAME:             identifier: "_TtVs5Int64"
+
+var a : Int64 = 2
+
+struct Point {
+  var x: Int64
+  var y: Int64
+}
+
+var p = Point(x: 1, y: 2)
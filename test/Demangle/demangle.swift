@@ -12,3 +12,7 @@ RUN: diff %t.check %t.output
 ; RUN: swift-demangle __TtSi | FileCheck %s -check-prefix=DOUBLE
 ; DOUBLE: _TtSi ---> Swift.Int
 
+; Symbols embedded in text, repeated ones, and "_T" on its own.
+; RUN: echo 'x _TtSi y _TtSi _T _TtSS,_TtSi' | swift-demangle | FileCheck %s -check-prefix=FILTER
+; FILTER: x Swift.Int y Swift.Int _T Swift.String,Swift.Int
+
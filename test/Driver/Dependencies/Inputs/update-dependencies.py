@@ -13,13 +13,33 @@
 # the old dependencies (if present).
 #
 # If invoked in non-primary-file mode, it only creates the output file.
+#
+# If invoked in batch mode, it does both for every primary file, taking the
+# outputs from the batch output file map.
 
+import json
 import os
 import shutil
 import sys
 
 assert sys.argv[1] == '-frontend'
 
+if '-batch-output-file-map' in sys.argv:
+  mapFile = sys.argv[sys.argv.index('-batch-output-file-map') + 1]
+  with open(mapFile) as f:
+    outputMap = json.load(f)
+
+  primaryFiles = [sys.argv[i + 1] for i, arg in enumerate(sys.argv)
+                  if arg == '-primary-file']
+  print "Batch of", len(primaryFiles)
+  for primaryFile in primaryFiles:
+    outputs = outputMap[primaryFile]
+    shutil.copyfile(primaryFile, outputs['swift-dependencies'])
+    with open(outputs['object'], 'a'):
+      os.utime(outputs['object'], None)
+    print "Handled", os.path.basename(primaryFile)
+  sys.exit(0)
+
 if '-primary-file' in sys.argv:
   primaryFile = sys.argv[sys.argv.index('-primary-file') + 1]
   depsFile = sys.argv[sys.argv.index('-emit-reference-dependencies-path') + 1]
@@ -0,0 +1,25 @@
+// main | other
+
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -enable-batch-mode ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-BATCH %s
+// RUN: ls %t/main.o %t/other.o %t/main.swiftdeps %t/other.swiftdeps
+
+// CHECK-BATCH-NOT: warning
+// CHECK-BATCH: -primary-file ./main.swift {{.*}}-primary-file ./other.swift {{.*}}-batch-output-file-map
+// CHECK-BATCH: Batch of 2
+// CHECK-BATCH-DAG: Handled main.swift
+// CHECK-BATCH-DAG: Handled other.swift
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -enable-batch-mode ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-NONE %s
+
+// CHECK-NONE-NOT: Handled
+
+// With as many parallel tasks as files, every file gets its own frontend.
+// RUN: touch -t 201401240006 %t/*.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -enable-batch-mode ./main.swift ./other.swift -module-name main -j2 -v 2>&1 | FileCheck -check-prefix=CHECK-UNBATCHED %s
+
+// CHECK-UNBATCHED-NOT: Batch of
+// CHECK-UNBATCHED-DAG: Handled main.swift
+// CHECK-UNBATCHED-DAG: Handled other.swift
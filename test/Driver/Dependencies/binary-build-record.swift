@@ -0,0 +1,28 @@
+/// other ==> main
+
+// RUN: rm -rf %t && cp -r %S/Inputs/one-way/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+
+// CHECK-FIRST: Handled main.swift
+// CHECK-FIRST: Handled other.swift
+
+// RUN: ls %t/main~buildrecord.swiftdeps.bin
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-UNCHANGED %s
+
+// CHECK-UNCHANGED-NOT: Handled
+
+// A driver that only knows about the YAML record may replace it. The binary
+// copy no longer matches, so the (malformed) YAML record is read instead and
+// everything is rebuilt.
+// RUN: echo 'garbage' > %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-REBUILD %s
+
+// CHECK-REBUILD-DAG: Handled main.swift
+// CHECK-REBUILD-DAG: Handled other.swift
+
+// Without the binary copy, the YAML record written by the last build is used.
+// RUN: rm %t/main~buildrecord.swiftdeps.bin
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-UNCHANGED %s
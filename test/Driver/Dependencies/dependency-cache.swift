@@ -0,0 +1,32 @@
+/// other ==> main
+
+// RUN: rm -rf %t && cp -r %S/Inputs/one-way/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+
+// CHECK-FIRST: Handled main.swift
+// CHECK-FIRST: Handled other.swift
+
+// RUN: ls %t/main~buildrecord.swiftdeps.depcache
+
+// Give the .swiftdeps files a known timestamp and let the cache pick it up.
+// RUN: touch -t 201401240006 %t/*.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-UNCHANGED %s
+
+// CHECK-UNCHANGED-NOT: Handled
+
+// Corrupt other.swiftdeps without changing its size or timestamp. The cached
+// copy is still used, so nothing needs to be rebuilt.
+// RUN: echo '# Dependencies after compilation:' > %t/other.swiftdeps
+// RUN: echo 'provides-top-level: {a}' >> %t/other.swiftdeps
+// RUN: touch -t 201401240006 %t/other.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-UNCHANGED %s
+
+// Once the timestamp changes, the file is read again, and the malformed file
+// forces a full rebuild.
+// RUN: touch -t 201401240007 %t/other.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-REBUILD %s
+
+// CHECK-REBUILD-DAG: Handled main.swift
+// CHECK-REBUILD-DAG: Handled other.swift
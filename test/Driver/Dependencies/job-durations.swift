@@ -0,0 +1,29 @@
+// main | other
+
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// Without any recorded durations, jobs run in the order they were created.
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-IN-ORDER %s
+
+// CHECK-IN-ORDER: Handled main.swift
+// CHECK-IN-ORDER: Handled other.swift
+
+// RUN: FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps.durations
+
+// CHECK-RECORD-DAG: "./main.swift": {{[0-9]+$}}
+// CHECK-RECORD-DAG: "./other.swift": {{[0-9]+$}}
+
+// Slower jobs are started first.
+// RUN: echo '"./main.swift": 10' > %t/main~buildrecord.swiftdeps.durations
+// RUN: echo '"./other.swift": 1000' >> %t/main~buildrecord.swiftdeps.durations
+// RUN: touch -t 201401240006 %t/*.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-SLOWEST-FIRST %s
+
+// CHECK-SLOWEST-FIRST: Handled other.swift
+// CHECK-SLOWEST-FIRST: Handled main.swift
+
+// A malformed file is ignored.
+// RUN: echo 'garbage' > %t/main~buildrecord.swiftdeps.durations
+// RUN: touch -t 201401240007 %t/*.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -driver-always-rebuild-dependents ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-IN-ORDER %s
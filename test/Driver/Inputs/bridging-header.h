@@ -0,0 +1 @@
+int bridgingHeaderFunction(void);
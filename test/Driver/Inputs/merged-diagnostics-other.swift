@@ -0,0 +1,3 @@
+func other() {
+  let unusedInOther = 1
+}
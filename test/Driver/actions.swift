@@ -110,3 +110,15 @@
 
 // RUN: %swiftc_driver -driver-print-actions -g %S/Inputs/main.swift %S/../Inputs/empty.swift %s -module-name actions -force-single-frontend-invocation 2>&1 | FileCheck %s -check-prefix=WHOLE-MODULE -check-prefix=WHOLE-MODULE-DEBUG
 // WHOLE-MODULE-DEBUG: 5: generate-dSYM, {4}, dSYM
+
+// RUN: %swiftc_driver -driver-print-actions -c -enable-bridging-pch -import-objc-header %S/Inputs/bridging-header.h %S/Inputs/main.swift %s -module-name actions 2>&1 | FileCheck %s -check-prefix=BRIDGING-PCH
+// BRIDGING-PCH: 0: input, "{{.*}}Inputs/main.swift", swift
+// BRIDGING-PCH: 1: input, "{{.*}}Inputs/bridging-header.h", objc-header
+// BRIDGING-PCH: 2: generate-pch, {1}, pch
+// BRIDGING-PCH: 3: compile, {0, 2}, object
+// BRIDGING-PCH: 4: input, "{{.*}}actions.swift", swift
+// BRIDGING-PCH: 5: compile, {4, 2}, object
+
+// RUN: %swiftc_driver -driver-print-actions -c -enable-bridging-pch -import-objc-header %S/Inputs/bridging-header.h %S/Inputs/main.swift %s -module-name actions -force-single-frontend-invocation 2>&1 | FileCheck %s -check-prefix=BRIDGING-PCH-WHOLE-MODULE
+// BRIDGING-PCH-WHOLE-MODULE-NOT: generate-pch
+// BRIDGING-PCH-WHOLE-MODULE: 2: compile, {0, 1}, object
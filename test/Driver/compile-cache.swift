@@ -0,0 +1,8 @@
+// RUN: %swiftc_driver -driver-print-jobs -compile-cache /tmp/swift-compile-cache -target x86_64-unknown-linux-gnu %s -emit-module -module-name main -o %t.out | FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -compile-cache /tmp/swift-compile-cache -compile-server-socket /tmp/swift-compile-server.sock -target x86_64-unknown-linux-gnu %s -module-name main -o %t.out | FileCheck -check-prefix=SERVER %s
+
+// CHECK: bin/swift -compile-cache /tmp/swift-compile-cache -frontend -c
+// CHECK-NOT: -compile-cache
+// CHECK: bin/swift -frontend -emit-module
+
+// SERVER: bin/swift -compile-cache /tmp/swift-compile-cache -compile-server-client /tmp/swift-compile-server.sock -frontend -c
@@ -0,0 +1,6 @@
+// RUN: %swiftc_driver -driver-print-jobs -compile-server-socket /tmp/swift-compile-server.sock -target x86_64-unknown-linux-gnu %s -emit-module -module-name main -o %t.out | FileCheck %s
+
+// CHECK: bin/swift -compile-server-client /tmp/swift-compile-server.sock -frontend -c
+// CHECK-NOT: -compile-server-client
+// CHECK: bin/swift -frontend -emit-module
+
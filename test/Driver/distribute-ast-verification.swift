@@ -0,0 +1,8 @@
+// RUN: %swiftc_driver -driver-print-jobs -c %S/Inputs/main.swift %S/Inputs/lib.swift -distribute-ast-verification -module-name main 2>&1 | FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -c %S/Inputs/main.swift %S/Inputs/lib.swift -module-name main 2>&1 | FileCheck -check-prefix=CHECK-DEFAULT %s
+// RUN: %swiftc_driver -driver-print-jobs -c %S/Inputs/main.swift -distribute-ast-verification -module-name main 2>&1 | FileCheck -check-prefix=CHECK-DEFAULT %s
+
+// CHECK: -primary-file {{.*}}main.swift {{.*}}lib.swift -ast-verifier-process-count 2 -ast-verifier-process-id 0
+// CHECK: {{.*}}main.swift -primary-file {{.*}}lib.swift -ast-verifier-process-count 2 -ast-verifier-process-id 1
+
+// CHECK-DEFAULT-NOT: -ast-verifier-process
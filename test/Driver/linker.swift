@@ -28,6 +28,10 @@
 // RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -emit-library %s -module-name LINKER | FileCheck -check-prefix INFERRED_NAME %s
 // RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -emit-library %s -o libLINKER.dylib | FileCheck -check-prefix INFERRED_NAME %s
 
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -whole-module-optimization -whole-program %s | FileCheck -check-prefix WHOLE_PROGRAM %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -emit-library -whole-module-optimization -whole-program %s 2>&1 | FileCheck -check-prefix WHOLE_PROGRAM_IGNORED %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -whole-program %s 2>&1 | FileCheck -check-prefix WHOLE_PROGRAM_IGNORED %s
+
 // There are more RUN lines further down in the file.
 
 // REQUIRES: X86
@@ -155,6 +159,16 @@
 // INFERRED_NAME: bin/ld{{"? }}
 // INFERRED_NAME: -o libLINKER.dylib
 
+// WHOLE_PROGRAM: bin/swift
+// WHOLE_PROGRAM: -whole-program
+// WHOLE_PROGRAM: bin/ld{{"? }}
+// WHOLE_PROGRAM: -dead_strip
+// WHOLE_PROGRAM: -o {{[^ ]+}}
+
+// WHOLE_PROGRAM_IGNORED: warning: ignoring '-whole-program'
+// WHOLE_PROGRAM_IGNORED-NOT: -whole-program
+// WHOLE_PROGRAM_IGNORED-NOT: -dead_strip
+
 
 // Test ld detection. We use hard links to make sure
 // the Swift driver really thinks it's been moved.
@@ -14,6 +14,8 @@
 // RUN: FileCheck %s < %t.complex.txt
 // RUN: FileCheck -check-prefix THREE-OUTPUTS %s < %t.complex.txt
 
+// RUN: %swiftc_driver -driver-print-jobs -c -emit-module %s %S/Inputs/main.swift -emit-objc-header-path path/to/header.h -parallel-objc-header 2>&1 | FileCheck -check-prefix PARALLEL-HEADER %s
+
 // CHECK: bin/swift{{c?}} -frontend
 // CHECK: -module-name {{[^ ]+}}
 // CHECK: -o [[OBJECTFILE:.*]]
@@ -85,3 +87,9 @@
 // MERGE_1: -module-name merge
 // MERGE_1: -o /tmp/modules
 
+// PARALLEL-HEADER: bin/swift{{c?}} -frontend -c -primary-file {{[^ ]*}}merge-module.swift
+// PARALLEL-HEADER-SAME: -emit-objc-header-path [[HEADER1:[^ ]+\.partial\.h]] -emit-partial-objc-header
+// PARALLEL-HEADER: bin/swift{{c?}} -frontend -c {{[^ ]*}}merge-module.swift -primary-file {{[^ ]*}}main.swift
+// PARALLEL-HEADER-SAME: -emit-objc-header-path [[HEADER2:[^ ]+\.partial\.h]] -emit-partial-objc-header
+// PARALLEL-HEADER: bin/swift{{c?}} -frontend -emit-module
+// PARALLEL-HEADER-SAME: -emit-objc-header-path path/to/header.h -merge-partial-objc-header [[HEADER1]] -merge-partial-objc-header [[HEADER2]]
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: cd %t && %target-swiftc_driver -c %s %S/Inputs/merged-diagnostics-other.swift -module-name main -serialize-diagnostics-module-path %t/main.dia
+// RUN: c-index-test -read-diagnostics %t/main.dia > %t/merged.txt 2>&1
+// RUN: FileCheck --input-file=%t/merged.txt %s
+
+// A path that can't be written is an error.
+// RUN: cd %t && not %target-swiftc_driver -c %s -module-name main -serialize-diagnostics-module-path %t/missing/main.dia 2>&1 | FileCheck -check-prefix=CHECK-ERROR %s
+
+func first() {
+  let unusedInMain = 1
+}
+
+// CHECK-DAG: merged-serialized-diagnostics.swift:10:7: warning: initialization of immutable value 'unusedInMain' was never used
+// CHECK-DAG: merged-diagnostics-other.swift:2:7: warning: initialization of immutable value 'unusedInOther' was never used
+// CHECK: Number of diagnostics: 2
+
+// CHECK-ERROR: error: unable to merge serialized diagnostics into '{{.*}}main.dia':
@@ -8,9 +8,14 @@
 
 // RUN: %swiftc_driver -driver-print-jobs -profile-generate -target x86_64-unknown-linux-gnu %s | FileCheck -check-prefix=CHECK -check-prefix=LINUX %s
 
+// RUN: %swiftc_driver -driver-print-jobs -profile-use=%t.profdata -target x86_64-unknown-linux-gnu %s | FileCheck -check-prefix=USE %s
+
 // CHECK: swift
 // CHECK: -profile-generate
 
+// USE: swift
+// USE: -profile-use={{[^ ]*}}.profdata
+
 // OSX: bin/ld{{"? }}
 // OSX: lib/swift/clang/{{[^ ]*}}/lib/darwin/libclang_rt.profile_osx.a
 
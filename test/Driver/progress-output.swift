@@ -0,0 +1,12 @@
+// RUN: %swiftc_driver_plain -emit-executable %s -o %t.out -emit-module -emit-module-path %t.swiftmodule -progress-output %t.progress -driver-skip-execution
+// RUN: FileCheck %s < %t.progress
+
+// CHECK: {"kind":"began","name":"compile","inputs":["{{[^"]*}}progress-output.swift"],"pid":1,"time-us":{{[0-9]+}}}
+// CHECK-NEXT: {"kind":"finished","name":"compile","inputs":["{{[^"]*}}progress-output.swift"],"pid":1,"exit-status":0,"wall-time-us":{{[0-9]+}},"user-time-us":0,"system-time-us":0,"max-rss-bytes":0}
+// CHECK: {"kind":"began","name":"merge-module","inputs":[],"pid":2,
+// CHECK: {"kind":"finished","name":"merge-module","inputs":[],"pid":2,"exit-status":0,
+// CHECK: {"kind":"began","name":"link","inputs":[],"pid":3,
+
+// The frontend jobs append their phase timings to the same file.
+// RUN: %swiftc_driver -driver-print-jobs %s -progress-output %t.progress | FileCheck -check-prefix=FRONTEND %s
+// FRONTEND: bin/swift -frontend -c {{.*}} -progress-output {{[^ ]*}}.progress
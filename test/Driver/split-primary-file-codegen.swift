@@ -0,0 +1,10 @@
+// RUN: %swiftc_driver -driver-print-jobs -c %S/Inputs/main.swift %S/Inputs/lib.swift -num-threads 2 -split-primary-file-codegen -module-name main 2>&1 | FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -c %S/Inputs/main.swift %S/Inputs/lib.swift -num-threads 2 -module-name main 2>&1 | FileCheck -check-prefix=CHECK-DEFAULT %s
+// RUN: %swiftc_driver -driver-print-jobs -c %S/Inputs/main.swift %S/Inputs/lib.swift -split-primary-file-codegen -module-name main 2>&1 | FileCheck -check-prefix=CHECK-DEFAULT %s
+// RUN: %swiftc_driver -driver-print-jobs -S %S/Inputs/main.swift %S/Inputs/lib.swift -num-threads 2 -split-primary-file-codegen -module-name main 2>&1 | FileCheck -check-prefix=CHECK-DEFAULT %s
+// RUN: %swiftc_driver -driver-print-jobs -c %S/Inputs/main.swift %S/Inputs/lib.swift -wmo -num-threads 2 -split-primary-file-codegen -module-name main 2>&1 | FileCheck -check-prefix=CHECK-DEFAULT %s
+
+// CHECK: -primary-file {{[^ ]*}}main.swift {{.*}} -num-threads 2 -parallel-codegen-linker {{[^ ]*}}ld -o
+// CHECK: -primary-file {{[^ ]*}}lib.swift {{.*}} -num-threads 2 -parallel-codegen-linker {{[^ ]*}}ld -o
+
+// CHECK-DEFAULT-NOT: -parallel-codegen-linker
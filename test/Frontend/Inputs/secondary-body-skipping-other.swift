@@ -0,0 +1,10 @@
+func otherFunc() -> Int {
+  let x = (1 +
+  return x
+}
+
+struct OtherStruct {
+  var value: Int {
+    get { return = 0 }
+  }
+}
@@ -0,0 +1,16 @@
+// RUN: %target-swift-frontend -parse %s -ast-verifier-sample-percent 0
+// RUN: %target-swift-frontend -parse %s -ast-verifier-sample-percent 50 -ast-verifier-sample-seed 7
+// RUN: %target-swift-frontend -parse %s -ast-verifier-process-count 2 -ast-verifier-process-id 1
+
+// RUN: not %target-swift-frontend -parse %s -ast-verifier-sample-percent 101 2>&1 | FileCheck -check-prefix=CHECK-PERCENT %s
+// CHECK-PERCENT: error: invalid value '101' in '-ast-verifier-sample-percent 101'
+
+// RUN: not %target-swift-frontend -parse %s -ast-verifier-process-count 2 -ast-verifier-process-id 2 2>&1 | FileCheck -check-prefix=CHECK-ID %s
+// CHECK-ID: error: invalid value '2' in '-ast-verifier-process-id 2'
+
+func first(x: Int) -> Int { return x + 1 }
+func second(x: Int) -> Int { return first(x) * 2 }
+
+struct S {
+  func method() -> Int { return second(1) }
+}
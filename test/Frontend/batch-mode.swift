@@ -0,0 +1,27 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: echo '{"%s": {"object": "%t/main.o", "swift-dependencies": "%t/main.swiftdeps"}, "%S/Inputs/batch-mode-other.swift": {"object": "%t/other.o", "swift-dependencies": "%t/other.swiftdeps"}}' > %t/map.json
+
+// RUN: %target-swift-frontend -c -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -batch-output-file-map %t/map.json -module-name main
+// RUN: ls %t/main.o %t/other.o
+// RUN: FileCheck -check-prefix=CHECK-MAIN %s < %t/main.swiftdeps
+// RUN: FileCheck -check-prefix=CHECK-OTHER %s < %t/other.swiftdeps
+
+// CHECK-MAIN-LABEL: provides-top-level:
+// CHECK-MAIN: "mainFunc"
+// CHECK-MAIN-LABEL: depends-top-level:
+// CHECK-MAIN: "otherFunc"
+
+// CHECK-OTHER-LABEL: provides-top-level:
+// CHECK-OTHER: "otherFunc"
+// CHECK-OTHER-NOT: "mainFunc"
+
+// RUN: not %target-swift-frontend -c -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -module-name main 2>&1 | FileCheck -check-prefix=CHECK-NO-MAP %s
+// CHECK-NO-MAP: error: multiple -primary-file arguments require -batch-output-file-map
+
+// RUN: echo '{}' > %t/empty-map.json
+// RUN: not %target-swift-frontend -c -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -batch-output-file-map %t/empty-map.json -module-name main 2>&1 | FileCheck -check-prefix=CHECK-NO-ENTRY %s
+// CHECK-NO-ENTRY: error: batch output file map has no entry for primary file '{{.*}}batch-mode.swift'
+
+func mainFunc() {
+  otherFunc()
+}
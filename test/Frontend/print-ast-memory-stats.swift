@@ -0,0 +1,12 @@
+// RUN: %target-swift-frontend -parse -print-ast-memory-stats -module-name stats %s 2>&1 | FileCheck %s
+
+func one() -> Int { return 1 }
+
+// CHECK: *** AST memory statistics for module 'stats' ***
+// CHECK: Declarations:
+// CHECK: {{[0-9]+ +[0-9]+ +[0-9]+}}  Func
+// CHECK: total
+// CHECK: Expressions:
+// CHECK: {{[0-9]+ +[0-9]+ +[0-9]+}}  IntegerLiteral
+// CHECK: total
+// CHECK: ASTContext total memory: {{[0-9]+}} bytes
@@ -0,0 +1,16 @@
+// RUN: %target-swift-frontend -emit-ir -O -release-lookup-caches-after-silgen -module-name main %s | FileCheck %s
+
+// Optimizing and emitting IR still works once the lookup caches are gone.
+
+public struct Counter {
+  public var value = 0
+  public mutating func increment() { value += 1 }
+}
+
+public func count() -> Int {
+  var counter = Counter()
+  counter.increment()
+  return counter.value
+}
+
+// CHECK: define {{.*}} @_TF4main5countFT_Si
@@ -0,0 +1,10 @@
+// RUN: %target-swift-frontend -parse -primary-file %s %S/Inputs/secondary-body-skipping-other.swift -module-name main
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/secondary-body-skipping-other.swift -module-name main -disable-secondary-body-skipping 2>&1 | FileCheck %s
+
+// Function bodies in secondary files are skipped, so syntax errors inside
+// them are only reported by the job for which that file is primary.
+// CHECK: secondary-body-skipping-other.swift:{{[0-9]+}}:{{[0-9]+}}: error:
+
+func mainFunc() -> Int {
+  return otherFunc() + OtherStruct().value
+}
@@ -0,0 +1,34 @@
+// RUN: rm -rf %t && mkdir %t
+
+// RUN: %target-swift-frontend -emit-ir %s -module-name trace -trace-compile-time %t/trace.json -o %t/trace.ll
+// RUN: FileCheck %s < %t/trace.json
+
+// A second job appends to the same trace.
+// RUN: %target-swift-frontend -parse %s -module-name trace -trace-compile-time %t/trace.json
+// RUN: FileCheck -check-prefix=CHECK-APPENDED %s < %t/trace.json
+
+// RUN: %swiftc_driver -driver-print-jobs -c %s -trace-compile-time %t/driver.json | FileCheck -check-prefix=CHECK-DRIVER %s
+
+// CHECK: [
+// CHECK-NEXT: {"name": "process_name", "ph": "M", "pid": {{[0-9]+}}, "args": {"name": "trace"}},
+// CHECK-DAG: {"name": "Swift", "cat": "import", "ph": "X", "ts": {{[0-9]+}}, "dur": {{[0-9]+}}, "pid": {{[0-9]+}}, "tid": 0},
+// CHECK-DAG: {"name": "compute(_:)", "cat": "typecheck-body",
+// CHECK-DAG: {"name": "Sema", "cat": "frontend",
+// CHECK-DAG: {"name": "SILGen", "cat": "frontend",
+// CHECK-DAG: {"name": "{{.*}}compute{{.*}}", "cat": "irgen-function",
+// CHECK-DAG: {"name": "IRGen", "cat": "frontend",
+// CHECK-DAG: {"name": "{{.*}}trace.ll", "cat": "llvm",
+// CHECK-DAG: {"name": "frontend", "cat": "frontend",
+
+// CHECK-APPENDED: [
+// CHECK-APPENDED: "name": "process_name"
+// CHECK-APPENDED: "name": "process_name"
+// CHECK-APPENDED-NOT: [
+
+// CHECK-DRIVER: -frontend {{.*}}-trace-compile-time {{.*}}driver.json
+
+func compute(x: Int) -> Int {
+  return x * 2 + 1 - x / 3
+}
+
+let result = compute(1 + 2 * 3)
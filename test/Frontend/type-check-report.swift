@@ -0,0 +1,40 @@
+// RUN: rm -rf %t && mkdir %t
+
+// RUN: %target-swift-frontend -parse %s -type-check-report %t/report.jsonl -type-check-report-count 3
+// RUN: FileCheck %s < %t/report.jsonl
+
+// A second job appends to the same report.
+// RUN: %target-swift-frontend -parse %s -type-check-report %t/report.jsonl -type-check-report-count 3
+// RUN: FileCheck -check-prefix=CHECK-APPENDED %s < %t/report.jsonl
+
+// RUN: not %target-swift-frontend -parse %s -type-check-report %t/report.jsonl -type-check-report-count many 2>&1 | FileCheck -check-prefix=CHECK-INVALID %s
+
+// RUN: %swiftc_driver -driver-print-jobs -c %s -type-check-report %t/report.jsonl -type-check-report-count 5 | FileCheck -check-prefix=CHECK-DRIVER %s
+
+// CHECK: {"kind": "{{expression|function-body|closure-body}}", "file": "{{.*}}type-check-report.swift", "line": {{[0-9]+}}, "column": {{[0-9]+}}, {{.*}}"ms": {{[0-9]+\.[0-9]+}}, "states": {{[0-9]+}}, "disjunctions": {{[0-9]+}}, "solver-bytes": {{[0-9]+}}}
+// CHECK-NEXT: {"kind":
+// CHECK-NEXT: {"kind":
+// CHECK-NOT: {"kind":
+
+// CHECK-APPENDED: {"kind":
+// CHECK-APPENDED-NEXT: {"kind":
+// CHECK-APPENDED-NEXT: {"kind":
+// CHECK-APPENDED-NEXT: {"kind":
+// CHECK-APPENDED-NEXT: {"kind":
+// CHECK-APPENDED-NEXT: {"kind":
+// CHECK-APPENDED-NOT: {"kind":
+
+// CHECK-INVALID: error: invalid value 'many' in '-type-check-report-count many'
+
+// CHECK-DRIVER: -frontend {{.*}}-type-check-report {{.*}}report.jsonl -type-check-report-count 5
+
+func slowishFunction() -> Double {
+  let values = [1, 2.5, 3, 4, 5.5, 6]
+  return values.reduce(0) { $0 + $1 * 2 - 1 }
+}
+
+func compute(x: Int) -> Int {
+  return x * 2 + 1 - x / 3
+}
+
+let result = compute(1 + 2 * 3)
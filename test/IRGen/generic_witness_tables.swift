@@ -0,0 +1,41 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -primary-file %s -emit-ir -enable-generic-witness-tables > %t/out.ll
+// RUN: FileCheck %s < %t/out.ll
+// RUN: FileCheck -check-prefix=ACCESSOR %s < %t/out.ll
+// RUN: FileCheck -check-prefix=INSTANTIATOR %s < %t/out.ll
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | FileCheck -check-prefix=DISABLED %s
+
+protocol P {
+  typealias Element
+  func first() -> Element
+}
+
+protocol Q : P {
+  func second() -> Element
+}
+
+struct Box<T> : Q {
+  var value: T
+  func first() -> T { return value }
+  func second() -> T { return value }
+}
+
+// The witness tables we emit for the dependent conformances are only the
+// patterns for the runtime instantiation.
+// CHECK-DAG: @_TWd{{.*}}3Box{{.*}}1P{{.*}} = internal global { i16, i16, i8*, i8*, [16 x i8*] } { i16 [[P_SIZE:[0-9]+]], i16 [[P_SIZE]], i8* bitcast ({{.*}} @_TWP{{.*}}3Box{{.*}}1P{{.*}} to i8*), i8* null, [16 x i8*] zeroinitializer }
+// CHECK-DAG: @_TWd{{.*}}3Box{{.*}}1Q{{.*}} = internal global { i16, i16, i8*, i8*, [16 x i8*] } { i16 [[Q_SIZE:[0-9]+]], i16 [[Q_SIZE]], i8* bitcast ({{.*}} @_TWP{{.*}}3Box{{.*}}1Q{{.*}} to i8*), i8* bitcast (void (i8**, %swift.type*, i8**)* @_TWD{{.*}}3Box{{.*}}1Q{{.*}} to i8*), [16 x i8*] zeroinitializer }
+
+// The access functions instantiate the tables through the runtime.
+// ACCESSOR-LABEL: define {{.*}}i8** @_TWa{{.*}}3Box{{.*}}1P{{.*}}(%swift.type*)
+// ACCESSOR:         [[TABLE:%.*]] = call i8** @swift_getGenericWitnessTable(i8* bitcast ({{.*}} @_TWd{{.*}}3Box{{.*}}1P{{.*}} to i8*), %swift.type* %0, i8** null)
+// ACCESSOR:         ret i8** [[TABLE]]
+
+// The base protocol witness depends on the conforming type, so it is filled
+// in when the table is instantiated.
+// INSTANTIATOR-LABEL: define internal void @_TWD{{.*}}3Box{{.*}}1Q{{.*}}(i8**, %swift.type*, i8**)
+// INSTANTIATOR:         [[BASE:%.*]] = call i8** @_TWa{{.*}}3Box{{.*}}1P{{.*}}(%swift.type* %1)
+// INSTANTIATOR:         [[OPAQUE:%.*]] = bitcast i8** [[BASE]] to i8*
+// INSTANTIATOR:         store i8* [[OPAQUE]], i8** {{%.*}}
+// INSTANTIATOR:         ret void
+
+// DISABLED-NOT: @swift_getGenericWitnessTable
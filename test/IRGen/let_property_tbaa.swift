@@ -0,0 +1,34 @@
+// RUN: %target-swift-frontend -primary-file %s -O -disable-llvm-optzns -emit-ir | FileCheck %s
+
+// REQUIRES: CPU=x86_64
+
+final class Point {
+  let x: Int
+  var y: Int
+
+  init(x: Int, y: Int) {
+    self.x = x
+    self.y = y
+  }
+}
+
+// Loads of `let` properties are tagged so that LLVM knows calls can't
+// modify them.
+// CHECK-LABEL: define {{.*}} @_TF17let_property_tbaa5readX{{.*}}(
+// CHECK:         load i64, i64* {{%.*}}, align 8, !tbaa [[LET:![0-9]+]]
+// CHECK:         ret i64
+@inline(never)
+func readX(p: Point) -> Int {
+  return p.x
+}
+
+// CHECK-LABEL: define {{.*}} @_TF17let_property_tbaa5readY{{.*}}(
+// CHECK-NOT:     !tbaa
+// CHECK:         ret i64
+@inline(never)
+func readY(p: Point) -> Int {
+  return p.y
+}
+
+// CHECK: [[LET]] = !{[[TY:![0-9]+]], [[TY]], i64 0}
+// CHECK: [[TY]] = !{!"Swift immutable property", {{![0-9]+}}, i64 0}
@@ -0,0 +1,59 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// RUN: %target-swift-frontend -c -primary-file %S/Inputs/multithread_module/main.swift %s -o %t/main.o -num-threads 2 -parallel-codegen-linker ld -g -module-name test
+// RUN: %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -primary-file %s -o %t/mt_primary_file.o -num-threads 2 -parallel-codegen-linker ld -g -module-name test
+// RUN: %target-build-swift %t/main.o %t/mt_primary_file.o -o %t/a.out
+// RUN: %target-run %t/a.out | FileCheck %s
+
+// RUN: %target-swift-frontend -c -primary-file %S/Inputs/multithread_module/main.swift %s -o %t/main-opt.o -num-threads 4 -parallel-codegen-linker ld -O -module-name test
+// RUN: %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -primary-file %s -o %t/mt_primary_file-opt.o -num-threads 4 -parallel-codegen-linker ld -O -module-name test
+// RUN: %target-build-swift %t/main-opt.o %t/mt_primary_file-opt.o -o %t/a-opt.out
+// RUN: %target-run %t/a-opt.out | FileCheck %s
+// REQUIRES: executable_test
+
+
+
+// Test code generation of a single primary file on multiple threads, with
+// -parallel-codegen-linker.
+// The file's LLVM module is split into partitions, which are combined into a
+// single object file again.
+
+// CHECK: 28
+// CHECK: 125
+// CHECK: 42
+// CHECK: 237
+
+public func testit(x: Int) -> Int {
+	return incrementit(x)
+}
+
+public class Base {
+	func memberfunc(x: Int) -> Int {
+		return x + 1
+	}
+}
+
+public var g2 = 123
+
+@inline(never)
+func callmember(b: Base) -> Int {
+	return b.memberfunc(g2)
+}
+
+@inline(never)
+private func privateInc(x: Int) -> Int {
+	return x + 3
+}
+
+func callPrivInc(x: Int) -> Int {
+	return privateInc(x)
+}
+
+protocol MyProto {
+	func protofunc() -> Int
+}
+
+@inline(never)
+func callproto(p: MyProto) {
+	print(p.protofunc())
+}
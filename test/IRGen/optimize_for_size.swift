@@ -0,0 +1,25 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -primary-file %s -Osize -emit-ir | FileCheck %s
+// RUN: %target-swift-frontend -primary-file %s -O -emit-ir | FileCheck -check-prefix=SPEED %s
+// RUN: %target-swift-frontend -primary-file %s -Osize -emit-ir -emit-code-size-report -o %t/out.ll
+// RUN: FileCheck -check-prefix=REPORT %s < %t/out.ll.codesize
+
+public func sum(values: [Int]) -> Int {
+  var result = 0
+  for v in values {
+    result = result &+ v
+  }
+  return result
+}
+
+// CHECK-LABEL: define {{.*}}@_TF17optimize_for_size3sumFT6valuesGSaSi__Si
+// CHECK-SAME:    [[ATTRS:#[0-9]+]]
+// CHECK: attributes [[ATTRS]] = {{{.*}}optsize
+
+// SPEED-NOT: optsize
+
+// REPORT: # Code size of {{.*}}, in LLVM instructions
+// REPORT-NEXT: total {{[0-9]+}}
+// REPORT: #   size function
+// REPORT: {{ *[0-9]+}} _TF17optimize_for_size3sumFT6valuesGSaSi__Si
+// REPORT: #   size   copies specialized function
@@ -0,0 +1,12 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// Without -parallel-codegen-linker a primary file is code-generated on one
+// thread, even with -num-threads.
+// RUN: %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -primary-file %S/multithread_primary_file.swift -o %t/serial.o -num-threads 2 -module-name test -Xllvm -debug-only=irgen 2>&1 | FileCheck -check-prefix=SERIAL %s
+// RUN: %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -primary-file %S/multithread_primary_file.swift -o %t/split.o -num-threads 2 -parallel-codegen-linker ld -module-name test -Xllvm -debug-only=irgen 2>&1 | FileCheck -check-prefix=SPLIT %s
+// RUN: not %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -primary-file %S/multithread_primary_file.swift -o %t/missing.o -num-threads 2 -parallel-codegen-linker %t/no-such-linker -module-name test 2>&1 | FileCheck -check-prefix=MISSING %s
+// REQUIRES: asserts
+
+// SERIAL-NOT: splitting
+// SPLIT: splitting {{.*}}split.o into 2 partitions
+// MISSING: error: cannot find linker '{{.*}}no-such-linker' for multi-threaded code generation
@@ -0,0 +1,50 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift -Xfrontend -enable-dynamic-cast-inline-caches %s -o %t/a.out
+// RUN: %target-run %t/a.out | FileCheck %s
+// REQUIRES: executable_test
+
+// Repeated casts of the same types hit the runtime's cast cache and the
+// inline caches at the cast sites; make sure the answers stay right as the
+// types change.
+
+protocol Named : class { var name: String { get } }
+protocol Counted { var count: Int { get } }
+
+class Base {}
+class Dog : Base, Named { var name: String { return "dog" } }
+class Puppy : Dog {}
+class Rock : Base {}
+
+struct Bag : Counted { var count: Int }
+struct Pebble {}
+
+func describe(x: Base) -> String {
+  if let named = x as? Named {
+    return named.name
+  }
+  return "anonymous"
+}
+
+func count(x: Any) -> Int {
+  if let counted = x as? Counted {
+    return counted.count
+  }
+  return -1
+}
+
+let objects: [Base] = [Dog(), Dog(), Rock(), Puppy(), Rock(), Dog()]
+for _ in 0..<2 {
+  // CHECK: dog anonymous dog anonymous dog
+  // CHECK: dog anonymous dog anonymous dog
+  print(objects[1..<6].map(describe).joinWithSeparator(" "))
+}
+
+let values: [Any] = [Bag(count: 3), Pebble(), Bag(count: 5), 7, Pebble()]
+for _ in 0..<2 {
+  // CHECK: 3 -1 5 -1 -1
+  // CHECK: 3 -1 5 -1 -1
+  print(values.map { String(count($0)) }.joinWithSeparator(" "))
+}
+
+// CHECK: dog
+print((Puppy() as Base as! Named).name)
@@ -0,0 +1,41 @@
+// RUN: %target-run-simple-swift | FileCheck %s
+// REQUIRES: executable_test
+
+// Enums with many ASCII String raw values dispatch on the length of the raw
+// value before comparing it against the cases.
+enum Field : String {
+  case id, name, kind, owner, title, status, created, modified
+  case K = "K"
+  case longFieldName = "a_much_longer_field_name"
+}
+
+func parse(s: String) {
+  if let field = Field(rawValue: s) {
+    print("\(s.unicodeScalars.count): \(field)")
+  } else {
+    print("\(s.unicodeScalars.count): nil")
+  }
+}
+
+// CHECK: 2: id
+parse("id")
+// CHECK-NEXT: 4: name
+parse("name")
+// CHECK-NEXT: 4: kind
+parse("kind")
+// CHECK-NEXT: 8: modified
+parse("modified")
+// CHECK-NEXT: 24: longFieldName
+parse("a_much_longer_field_name")
+// CHECK-NEXT: 4: nil
+parse("nope")
+// CHECK-NEXT: 9: nil
+parse("undefined")
+// CHECK-NEXT: 0: nil
+parse("")
+
+// Strings which aren't stored as ASCII are compared against every case.
+// CHECK-NEXT: 1: K
+parse("\u{212A}")
+// CHECK-NEXT: 2: nil
+parse("i\u{0301}")
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-jit-run %s -immediate-object-cache-path %t/cache | FileCheck %s
+// RUN: ls %t/cache | FileCheck -check-prefix=CACHE %s
+// RUN: %target-jit-run %s -immediate-object-cache-path %t/cache | FileCheck %s
+// RUN: ls %t/cache | count 1
+// REQUIRES: executable_test
+// REQUIRES: swift_interpreter
+
+// CACHE: {{.*}}.o
+
+// CHECK: fib(20) = 6765
+func fib(n: Int) -> Int {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2)
+}
+print("fib(20) = \(fib(20))")
@@ -0,0 +1,65 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: %target-run %t/a.out record %t/snapshot | FileCheck %s
+// RUN: %target-run %t/a.out replay %t/snapshot | FileCheck %s
+// RUN: %target-run %t/a.out replay-stale %t/stale | FileCheck %s
+// REQUIRES: executable_test
+
+#if os(Linux)
+import Glibc
+#else
+import Darwin
+#endif
+
+@_silgen_name("swift_startRecordingMetadataSnapshot")
+func startRecordingMetadataSnapshot(path: UnsafePointer<CChar>) -> Bool
+
+@_silgen_name("swift_stopRecordingMetadataSnapshot")
+func stopRecordingMetadataSnapshot()
+
+@_silgen_name("swift_replayMetadataSnapshot")
+func replayMetadataSnapshot(path: UnsafePointer<CChar>) -> Int
+
+func useGenericTypes() {
+  let values: [Any] = [[1, 2, 3], ["one": 1], Optional<String>.None, (1, 2.5)]
+  for value in values {
+    print(value)
+  }
+}
+
+let mode = Process.arguments[1]
+let path = Process.arguments[2]
+
+switch mode {
+case "record":
+  print(startRecordingMetadataSnapshot(path))
+  useGenericTypes()
+  stopRecordingMetadataSnapshot()
+
+case "replay":
+  // The standard library's generic types, like Array<Int>, are replayed.
+  print(replayMetadataSnapshot(path) > 0)
+  useGenericTypes()
+
+case "replay-stale":
+  // Records whose image changed, or whose references don't name matching
+  // symbols, are skipped.
+  let file = fopen(path, "w")
+  fputs("swift-metadata-snapshot 2\n", file)
+  fputs("image 0 0 /nonexistent/libswiftCore.so\n", file)
+  fputs("generic @0:_TMPSa+0 #0\n", file)
+  fputs("generic @1:_TMPSa+0 0\n", file)
+  fputs("tuple 0 @0:_TMdSi+0 #0 #0\n", file)
+  fclose(file)
+  print(replayMetadataSnapshot(path) == 0)
+  useGenericTypes()
+
+default:
+  fatalError("unknown mode")
+}
+
+// CHECK: true
+// CHECK-NEXT: [1, 2, 3]
+// CHECK-NEXT: ["one": 1]
+// CHECK-NEXT: nil
+// CHECK-NEXT: (1, 2.5)
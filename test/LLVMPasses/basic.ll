@@ -366,6 +366,58 @@ bb1:
 }
 
 
+; Retain motion follows straight-line edges into the successor block.
+; CHECK-LABEL: @retain_motion_across_blocks(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: br label %bb1
+; CHECK: bb1:
+; CHECK-NEXT: store i64 42, i64* %P
+; CHECK-NEXT: ret void
+define void @retain_motion_across_blocks(%swift.refcounted* %A, i64* %P) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br label %bb1
+bb1:
+  store i64 42, i64* %P
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+}
+
+; Release motion follows straight-line edges into the predecessor block.
+; CHECK-LABEL: @release_motion_across_blocks(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: call void @user(%swift.refcounted* %A)
+; CHECK-NEXT: br label %bb1
+; CHECK: bb1:
+; CHECK-NEXT: ret void
+define void @release_motion_across_blocks(%swift.refcounted* %A) {
+entry:
+  call void @user(%swift.refcounted* %A)
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br label %bb1
+bb1:
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+}
+
+; Motion must not cross into a block that has other predecessors.
+; CHECK-LABEL: @no_motion_into_merge_block(
+; CHECK: entry:
+; CHECK: swift_retain
+; CHECK: bb2:
+; CHECK-NEXT: swift_release
+; CHECK-NEXT: ret void
+define void @no_motion_into_merge_block(%swift.refcounted* %A, i1 %c) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br i1 %c, label %bb1, label %bb2
+bb1:
+  br label %bb2
+bb2:
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+}
+
 !llvm.dbg.cu = !{!1}
 !llvm.module.flags = !{!4}
 
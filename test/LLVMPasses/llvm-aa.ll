@@ -16,3 +16,54 @@ entry:
   %3 = add i8 %1, %2
   ret i8 %3
 }
+
+declare void @unknown()
+declare noalias i8* @allocate() nounwind
+
+; Loads of `let` properties can be forwarded over calls.
+; CHECK-LABEL: define i64 @test_eliminate_let_loads_over_call(i64*) {
+; CHECK: load
+; CHECK-NOT: load
+define i64 @test_eliminate_let_loads_over_call(i64*) {
+entry:
+  %1 = load i64, i64* %0, !tbaa !0
+  call void @unknown()
+  %2 = load i64, i64* %0, !tbaa !0
+  %3 = add i64 %1, %2
+  ret i64 %3
+}
+
+; Untagged loads can't.
+; CHECK-LABEL: define i64 @test_keep_loads_over_call(i64*) {
+; CHECK: load
+; CHECK: call void @unknown()
+; CHECK: load
+define i64 @test_keep_loads_over_call(i64*) {
+entry:
+  %1 = load i64, i64* %0
+  call void @unknown()
+  %2 = load i64, i64* %0
+  %3 = add i64 %1, %2
+  ret i64 %3
+}
+
+; Nor can loads from an object allocated in this function, since a callee
+; may still be initializing it.
+; CHECK-LABEL: define i64 @test_keep_let_loads_of_fresh_object() {
+; CHECK: load
+; CHECK: call void @unknown()
+; CHECK: load
+define i64 @test_keep_let_loads_of_fresh_object() {
+entry:
+  %0 = call i8* @allocate()
+  %1 = bitcast i8* %0 to i64*
+  %2 = load i64, i64* %1, !tbaa !0
+  call void @unknown()
+  %3 = load i64, i64* %1, !tbaa !0
+  %4 = add i64 %2, %3
+  ret i64 %4
+}
+
+!0 = !{!1, !1, i64 0}
+!1 = !{!"Swift immutable property", !2, i64 0}
+!2 = !{!"Swift TBAA"}
@@ -0,0 +1,69 @@
+; RUN: %swift-llvm-opt -swift-profile-counter-promotion %s | FileCheck %s
+
+target datalayout = "e-p:64:64:64-S128-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f128:128:128-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-apple-macosx10.9"
+
+@__profc_loop = private global [2 x i64] zeroinitializer, section "__DATA,__llvm_prf_cnts", align 8
+@not_a_counter = global [2 x i64] zeroinitializer, align 8
+
+declare void @opaque()
+
+; The update in the loop body accumulates in a register and is stored once,
+; on the exit; the update outside the loop is untouched.
+; CHECK-LABEL: define void @loop(i64 %n)
+; CHECK: entry:
+; CHECK:   load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 0)
+; CHECK:   store i64 {{.*}}, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 0)
+; CHECK: body:
+; CHECK-NOT: @__profc_loop
+; CHECK:   call void @opaque()
+; CHECK-NOT: @__profc_loop
+; CHECK: exit:
+; CHECK:   [[OLD:%.*]] = load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 1)
+; CHECK:   [[NEW:%.*]] = add i64 [[OLD]], %{{.*}}
+; CHECK:   store i64 [[NEW]], i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 1)
+; CHECK:   ret void
+define void @loop(i64 %n) {
+entry:
+  %c0 = load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 0)
+  %c0.inc = add i64 %c0, 1
+  store i64 %c0.inc, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 0)
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %c1 = load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 1)
+  %c1.inc = add i64 %c1, 1
+  store i64 %c1.inc, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 1)
+  call void @opaque()
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret void
+}
+
+; Ordinary globals are left alone.
+; CHECK-LABEL: define void @not_a_counter(i64 %n)
+; CHECK: body:
+; CHECK:   load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @not_a_counter, i64 0, i64 1)
+; CHECK:   store i64 {{.*}}, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @not_a_counter, i64 0, i64 1)
+; CHECK:   call void @opaque()
+define void @not_a_counter(i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %c1 = load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @not_a_counter, i64 0, i64 1)
+  %c1.inc = add i64 %c1, 1
+  store i64 %c1.inc, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @not_a_counter, i64 0, i64 1)
+  call void @opaque()
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret void
+}
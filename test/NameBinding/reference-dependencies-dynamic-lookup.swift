@@ -67,3 +67,4 @@ let globalUse = getAnyObject()?.counter
 // NEGATIVE-LABEL: depends-dynamic-lookup:
 // NEGATIVE-NOT: "cat1Method"
 // NEGATIVE-NOT: "unusedProp"
+// NEGATIVE-LABEL: {{^depends-external:$}}
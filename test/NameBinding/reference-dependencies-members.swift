@@ -10,6 +10,9 @@
 // RUN: FileCheck -check-prefix=DEPENDS-NOMINAL-NEGATIVE %s < %t.swiftdeps
 // RUN: FileCheck -check-prefix=DEPENDS-MEMBER %s < %t.swiftdeps
 // RUN: FileCheck -check-prefix=DEPENDS-MEMBER-NEGATIVE %s < %t.swiftdeps
+// RUN: FileCheck -check-prefix=FINGERPRINTS-NOMINAL %s < %t.swiftdeps
+// RUN: FileCheck -check-prefix=FINGERPRINTS-MEMBER %s < %t.swiftdeps
+// RUN: FileCheck -check-prefix=FINGERPRINTS-MEMBER-NEGATIVE %s < %t.swiftdeps
 
 
 // PROVIDES-NOMINAL-LABEL: {{^provides-nominal:$}}
@@ -20,11 +23,17 @@
 // DEPENDS-NOMINAL-NEGATIVE-LABEL: {{^depends-nominal:$}}
 // DEPENDS-MEMBER-LABEL: {{^depends-member:$}}
 // DEPENDS-MEMBER-NEGATIVE-LABEL: {{^depends-member:$}}
+// FINGERPRINTS-NOMINAL-LABEL: {{^fingerprints-nominal:$}}
+// FINGERPRINTS-MEMBER-LABEL: {{^fingerprints-member:$}}
+// FINGERPRINTS-MEMBER-NEGATIVE-LABEL: {{^fingerprints-member:$}}
 
 // PROVIDES-NOMINAL-DAG: 4Base"
+// FINGERPRINTS-NOMINAL-DAG: - ["{{.+}}4Base", "{{[0-9a-f]+}}"]
 class Base {
   // PROVIDES-MEMBER-DAG: - ["{{.+}}4Base", ""]
-  // PROVIDES-MEMBER-NEGATIVE-NOT: - ["{{.+}}4Base", "{{.+}}"]
+  // PROVIDES-MEMBER-DAG: - ["{{.+}}4Base", "foo"]
+  // FINGERPRINTS-MEMBER-DAG: - ["{{.+}}4Base", "", "{{[0-9a-f]+}}"]
+  // FINGERPRINTS-MEMBER-DAG: - ["{{.+}}4Base", "foo", "{{[0-9a-f]+}}"]
   func foo() {}
 }
   
@@ -32,7 +41,7 @@ class Base {
 // DEPENDS-NOMINAL-DAG: 9OtherBase"
 class Sub : OtherBase {
   // PROVIDES-MEMBER-DAG: - ["{{.+}}3Sub", ""]
-  // PROVIDES-MEMBER-NEGATIVE-NOT: - ["{{.+}}3Sub", "{{.+}}"]
+  // PROVIDES-MEMBER-DAG: - ["{{.+}}3Sub", "foo"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}9OtherBase", ""]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}9OtherBase", "foo"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}9OtherBase", "init"]
@@ -52,12 +61,15 @@ protocol SomeProto {}
 extension OtherClass : SomeProto {}
 
 // PROVIDES-NOMINAL-NEGATIVE-NOT: 11OtherStruct"{{$}}
+// FINGERPRINTS-MEMBER-DAG: - ["{{.+}}11OtherStruct", "", "{{[0-9a-f]+}}"]
 // DEPENDS-NOMINAL-DAG: 11OtherStruct"
 extension OtherStruct {
   // PROVIDES-MEMBER-DAG: - ["{{.+}}11OtherStruct", ""]
   // PROVIDES-MEMBER-DAG: - ["{{.+}}11OtherStruct", "foo"]
   // PROVIDES-MEMBER-DAG: - ["{{.+}}11OtherStruct", "bar"]
   // PROVIDES-MEMBER-NEGATIVE-NOT: "baz"
+  // FINGERPRINTS-MEMBER-DAG: - ["{{.+}}11OtherStruct", "bar", "{{[0-9a-f]+}}"]
+  // FINGERPRINTS-MEMBER-NEGATIVE-NOT: "baz"
   // DEPENDS-MEMBER-DAG: - ["{{.+}}11OtherStruct", "foo"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}11OtherStruct", "bar"]
   // DEPENDS-MEMBER-DAG: - !private ["{{.+}}11OtherStruct", "baz"]
@@ -48,3 +48,37 @@ func $builtin_send_data(object:AnyObject?, _ sl: Int, _ el: Int, _ sc: Int, _ ec
   let loc = "[\(sl):\(sc)-\(el):\(ec)]"
   print(loc + " " + (object as! LogRecord).text)
 }
+
+// With -playground-batched-logging, values are handed to the logger along
+// with their site and location.  This logger keeps a few values per site
+// and prints them when its buffer fills up or is drained.
+
+let batchedLogCapacity = 8
+let batchedLogSampleLimit = 2
+var batchedLog: [String] = []
+var batchedLogSiteCounts: [Int] = []
+
+func $builtin_log_batched<T>(object : T, _ name : String, _ id : Int, _ sl : Int, _ el : Int, _ sc : Int, _ ec : Int) {
+  while batchedLogSiteCounts.count <= id {
+    batchedLogSiteCounts.append(0)
+  }
+  batchedLogSiteCounts[id] += 1
+  if batchedLogSiteCounts[id] > batchedLogSampleLimit {
+    return
+  }
+  let loc = "[\(sl):\(sc)-\(el):\(ec)]"
+  batchedLog.append(loc + " " + LogRecord(api:"$builtin_log_batched", object:object, name:name).text)
+  if batchedLog.count == batchedLogCapacity {
+    $builtin_drain_batched_log()
+  }
+}
+
+func $builtin_drain_batched_log() {
+  for text in batchedLog {
+    print(text)
+  }
+  batchedLog.removeAll()
+  for (id, count) in batchedLogSiteCounts.enumerate() where count > batchedLogSampleLimit {
+    print("site \(id): \(count - batchedLogSampleLimit) more")
+  }
+}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: cp %s %t/main.swift
+// RUN: %target-build-swift -Xfrontend -playground -Xfrontend -playground-high-performance -Xfrontend -playground-batched-logging -Xfrontend -debugger-support -o %t/main %S/Inputs/PlaygroundsRuntime.swift %t/main.swift
+// RUN: %target-run %t/main | FileCheck %s
+// REQUIRES: executable_test
+
+var a = 5
+for i in 0..<5 {
+  i
+}
+$builtin_drain_batched_log()
+
+// Values are only printed when the log is drained, and at most twice per
+// site.
+
+// CHECK: [{{.*}}] $builtin_log_batched[a='5']
+// CHECK-NEXT: [{{.*}}] $builtin_log_batched[='0']
+// CHECK-NEXT: [{{.*}}] $builtin_log_batched[='1']
+// CHECK-NEXT: site {{[0-9]+}}: 3 more
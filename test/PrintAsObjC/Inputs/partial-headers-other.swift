@@ -0,0 +1,7 @@
+import ObjectiveC
+
+@objc class Base {
+  func baseMethod() {}
+}
+
+@objc protocol OtherProto {}
@@ -0,0 +1,38 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse -primary-file %s %S/Inputs/partial-headers-other.swift -module-name partial -emit-objc-header-path %t/main.h -emit-partial-objc-header -import-objc-header %S/../Inputs/empty.h -disable-objc-attr-requires-foundation-module
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse %s -primary-file %S/Inputs/partial-headers-other.swift -module-name partial -emit-objc-header-path %t/other.h -emit-partial-objc-header -import-objc-header %S/../Inputs/empty.h -disable-objc-attr-requires-foundation-module
+// RUN: FileCheck -check-prefix=PARTIAL %s < %t/main.h
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse %s %S/Inputs/partial-headers-other.swift -module-name partial -emit-objc-header-path %t/merged.h -merge-partial-objc-header %t/main.h -merge-partial-objc-header %t/other.h -import-objc-header %S/../Inputs/empty.h -disable-objc-attr-requires-foundation-module
+// RUN: FileCheck %s < %t/merged.h
+// RUN: not grep @swift-objc %t/merged.h
+// RUN: %check-in-clang %t/merged.h
+
+// RUN: not %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse %s %S/Inputs/partial-headers-other.swift -module-name partial -emit-objc-header-path %t/bad.h -merge-partial-objc-header %s -disable-objc-attr-requires-foundation-module 2>&1 | FileCheck -check-prefix=MALFORMED %s
+
+// REQUIRES: objc_interop
+
+import ObjectiveC
+
+// Each partial header only defines the declarations of its file, and marks
+// what they need from the other files.
+// PARTIAL: // @swift-objc-fragment class:Derived class:Base
+// PARTIAL: @interface Derived : Base
+// PARTIAL: // @swift-objc-fragment protocol:LocalProto protocol:OtherProto
+// PARTIAL: @protocol LocalProto <OtherProto>
+// PARTIAL-NOT: @interface Base
+// PARTIAL: // @swift-objc-end
+
+// The merged header defines the declarations after the ones they require.
+// CHECK: @interface Base
+// CHECK: @protocol OtherProto
+// CHECK: @interface Derived : Base
+// CHECK: @protocol LocalProto <OtherProto>
+// CHECK: #pragma clang diagnostic pop
+
+// MALFORMED: error: error parsing input file '{{.*}}bad.h' (malformed partial Objective-C header)
+
+@objc class Derived : Base {
+  func derivedMethod() {}
+}
+
+@objc protocol LocalProto : OtherProto {}
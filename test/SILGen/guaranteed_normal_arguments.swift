@@ -0,0 +1,46 @@
+// RUN: %target-swift-frontend -enable-guaranteed-normal-arguments -emit-silgen %s | FileCheck %s
+
+class C {}
+
+struct S {
+  var c: C
+
+  // Initializers still take their arguments at +1.
+  // CHECK-LABEL: sil hidden @_TFV27guaranteed_normal_arguments1SC{{.*}} : $@convention(thin) (@owned C, @thin S.Type) -> @owned S
+  init(c: C) { self.c = c }
+
+  // CHECK-LABEL: sil hidden @_TFV27guaranteed_normal_arguments1S6method{{.*}} : $@convention(method) (@guaranteed C, @guaranteed S) -> ()
+  func method(c: C) {}
+}
+
+// CHECK-LABEL: sil hidden @_TF27guaranteed_normal_arguments3use{{.*}} : $@convention(thin) (@guaranteed C) -> ()
+func use(c: C) {}
+
+// A +0 argument can be passed on to a +0 parameter without a copy.
+// CHECK-LABEL: sil hidden @_TF27guaranteed_normal_arguments7forward{{.*}} : $@convention(thin) (@guaranteed C) -> ()
+// CHECK:       bb0([[C:%.*]] : $C):
+// CHECK-NOT:     strong_retain [[C]]
+// CHECK:         apply {{%.*}}([[C]])
+// CHECK-NOT:     strong_release [[C]]
+// CHECK:         return
+func forward(c: C) {
+  use(c)
+}
+
+// Consuming a +0 argument copies it.
+// CHECK-LABEL: sil hidden @_TF27guaranteed_normal_arguments4make{{.*}} : $@convention(thin) (@guaranteed C) -> @owned S
+// CHECK:       bb0([[C:%.*]] : $C):
+// CHECK:         strong_retain [[C]]
+// CHECK:         apply {{%.*}}([[C]], {{%.*}})
+// CHECK-NOT:     strong_release [[C]]
+// CHECK:         return
+func make(c: C) -> S {
+  return S(c: c)
+}
+
+// Closures use the same convention.
+// CHECK-LABEL: sil hidden @_TF27guaranteed_normal_arguments10applyTwice{{.*}} : $@convention(thin) (@guaranteed @callee_owned (@guaranteed C) -> (), @guaranteed C) -> ()
+func applyTwice(f: (C) -> (), _ c: C) {
+  f(c)
+  f(c)
+}
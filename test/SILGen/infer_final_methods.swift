@@ -0,0 +1,63 @@
+// RUN: %target-swift-frontend -emit-silgen -O %s | FileCheck %s --check-prefix=WMO
+// RUN: %target-swift-frontend -emit-silgen -O -primary-file %s | FileCheck %s --check-prefix=FILE
+// RUN: %target-swift-frontend -emit-silgen %s | FileCheck %s --check-prefix=ONONE
+
+public class Base {
+  func overridden() {}
+  func notOverridden() {}
+  private func privateMethod() {}
+  public func publicMethod() {}
+}
+
+class Derived : Base {
+  override func overridden() {}
+}
+
+// With the whole module at hand, methods that are never overridden are
+// called directly and lose their vtable entries.
+
+// WMO-LABEL: sil hidden @_TF19infer_final_methods4testFCS_4BaseT_
+// WMO:         class_method %0 : $Base, #Base.overridden!1
+// WMO:         function_ref @_TFC19infer_final_methods4Base13notOverriddenfT_T_
+// WMO:         function_ref @_TFC19infer_final_methods4BaseP{{.*}}13privateMethodfT_T_
+// WMO:         class_method %0 : $Base, #Base.publicMethod!1
+// WMO:         return
+
+// Compiling a single file, only private methods can be called directly,
+// and every method keeps its vtable entry so that the class layout agrees
+// with the other files.
+
+// FILE-LABEL: sil hidden @_TF19infer_final_methods4testFCS_4BaseT_
+// FILE:         class_method %0 : $Base, #Base.overridden!1
+// FILE:         class_method %0 : $Base, #Base.notOverridden!1
+// FILE:         function_ref @_TFC19infer_final_methods4BaseP{{.*}}13privateMethodfT_T_
+// FILE:         class_method %0 : $Base, #Base.publicMethod!1
+// FILE:         return
+
+// Unoptimized builds always use the vtable.
+
+// ONONE-LABEL: sil hidden @_TF19infer_final_methods4testFCS_4BaseT_
+// ONONE:         class_method %0 : $Base, #Base.overridden!1
+// ONONE:         class_method %0 : $Base, #Base.notOverridden!1
+// ONONE:         class_method %0 : $Base, #Base.privateMethod!1
+// ONONE:         class_method %0 : $Base, #Base.publicMethod!1
+// ONONE:         return
+func test(b: Base) {
+  b.overridden()
+  b.notOverridden()
+  b.privateMethod()
+  b.publicMethod()
+}
+
+// WMO-LABEL: sil_vtable Base {
+// WMO:         #Base.overridden!1: _TFC19infer_final_methods4Base10overriddenfT_T_
+// WMO-NOT:     #Base.notOverridden
+// WMO-NOT:     #Base.privateMethod
+// WMO:         #Base.publicMethod!1
+// WMO:       }
+
+// FILE-LABEL: sil_vtable Base {
+// FILE:         #Base.notOverridden!1
+// FILE:         #Base.privateMethod!1
+// FILE:         #Base.publicMethod!1
+// FILE:       }
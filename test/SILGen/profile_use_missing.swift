@@ -0,0 +1,6 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: not %target-swift-frontend -emit-silgen -profile-use=%t/missing.profdata %s 2>&1 | FileCheck %s
+
+// CHECK: error: unable to read profile data from '{{.*}}missing.profdata'
+
+func foo() {}
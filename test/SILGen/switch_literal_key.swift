@@ -0,0 +1,75 @@
+// RUN: %target-swift-frontend -emit-silgen %s | FileCheck %s
+
+// Large switches over string literals first branch on the contiguous ASCII
+// count of the subject.
+
+// CHECK-LABEL: sil hidden @{{.*}}stringSwitch
+// CHECK:         [[COUNT_FN:%.*]] = function_ref @_TFs27_stringContiguousASCIICount
+// CHECK:         [[COUNT:%.*]] = apply [[COUNT_FN]]
+// CHECK:         [[KEY:%.*]] = struct_extract [[COUNT]] : $Int, #Int._value
+// CHECK:         switch_value [[KEY]] : $Builtin.Int{{[0-9]+}}, case {{%.*}}: bb{{[0-9]+}}, case {{%.*}}: bb{{[0-9]+}}, case {{%.*}}: bb{{[0-9]+}}, case {{%.*}}: bb{{[0-9]+}}, case {{%.*}}: bb{{[0-9]+}}, default bb{{[0-9]+}}
+// CHECK:         function_ref @_TFsoi2teu
+// CHECK:         return
+func stringSwitch(s: String) -> Int {
+  switch s {
+  case "a": return 1
+  case "b": return 2
+  case "ab": return 3
+  case "abc": return 4
+  case "bcd": return 5
+  case "cd": return 6
+  case "hello": return 7
+  case "world": return 8
+  default: return 0
+  }
+}
+
+// Large switches over integer literals branch on the value itself.
+
+// CHECK-LABEL: sil hidden @{{.*}}intSwitch
+// CHECK:         [[KEY:%.*]] = struct_extract %0 : $Int, #Int._value
+// CHECK:         switch_value [[KEY]] : $Builtin.Int{{[0-9]+}},
+// CHECK-SAME:      default
+func intSwitch(i: Int) -> Int {
+  switch i {
+  case 0: return 1
+  case 1: return 2
+  case -1: return 3
+  case 10: return 4
+  case 100: return 5
+  case 1000: return 6
+  case 7, 8: return 7
+  default: return 0
+  }
+}
+
+// Small switches, and switches with bindings or guards, test each case in
+// turn.
+
+// CHECK-LABEL: sil hidden @{{.*}}smallStringSwitch
+// CHECK-NOT:     switch_value
+// CHECK:         return
+func smallStringSwitch(s: String) -> Int {
+  switch s {
+  case "a": return 1
+  case "b": return 2
+  default: return 0
+  }
+}
+
+// CHECK-LABEL: sil hidden @{{.*}}guardedIntSwitch
+// CHECK-NOT:     switch_value
+// CHECK:         return
+func guardedIntSwitch(i: Int, flag: Bool) -> Int {
+  switch i {
+  case 0: return 1
+  case 1: return 2
+  case 2 where flag: return 3
+  case 3: return 4
+  case 4: return 5
+  case 5: return 6
+  case 6: return 7
+  case 7: return 8
+  default: return 0
+  }
+}
@@ -0,0 +1,23 @@
+public struct Box<T> {
+  public var value: T
+
+  public init(_ value: T) {
+    self.value = value
+  }
+}
+
+@inline(never)
+public func makeBox<T>(x: T) -> Box<T> {
+  return Box(x)
+}
+
+@inline(never)
+public func makeOtherBox<T>(x: T) -> Box<T> {
+  return Box(x)
+}
+
+// Create the specializations of makeBox and makeOtherBox for Int.
+public func prespecializeBoxes() {
+  _ = makeBox(1 as Int)
+  _ = makeOtherBox(1 as Int)
+}
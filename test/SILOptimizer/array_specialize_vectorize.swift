@@ -0,0 +1,18 @@
+// RUN: %target-swift-frontend -O -disable-llvm-optzns -emit-ir -primary-file %s | FileCheck %s
+// RUN: %target-swift-frontend -O -disable-llvm-optzns -emit-ir -primary-file %s -Xllvm -sil-array-props-vectorize=false | FileCheck %s --check-prefix=NOHINT
+// REQUIRES: objc_interop,swift_stdlib_no_asserts,optimized_stdlib
+
+// The fast loop created by specializing on array.props has no bounds checks
+// left, so it is marked for the loop vectorizer.
+
+// CHECK-LABEL: define {{.*}}addOne
+// CHECK: br {{.*}}, !llvm.loop [[LOOP:![0-9]+]]
+// CHECK: [[LOOP]] = {{(distinct )?}}!{[[LOOP]], [[ENABLE:![0-9]+]]}
+// CHECK: [[ENABLE]] = !{!"llvm.loop.vectorize.enable", i1 true}
+
+// NOHINT-NOT: llvm.loop.vectorize.enable
+func addOne(inout a: [Int]) {
+  for i in 0..<a.count {
+    a[i] = a[i] &+ 1
+  }
+}
@@ -0,0 +1,80 @@
+// RUN: %target-swift-frontend %s -O -whole-module-optimization -emit-sil | FileCheck -check-prefix=CHECK-WMO %s
+// RUN: %target-swift-frontend %s -O -whole-module-optimization -whole-program -emit-sil > %t.sil
+// RUN: FileCheck %s < %t.sil
+// RUN: FileCheck -check-prefix=CHECK-DEAD %s < %t.sil
+
+// With -whole-program only main and symbols which can be reached through the
+// runtime are roots, so unused public code is removed as well.
+
+public class PublicBase {
+	@inline(never)
+	public func aliveMethod() {
+	}
+
+	@inline(never)
+	public func deadMethod() {
+	}
+}
+
+public protocol PublicProt {
+	func aliveWitness()
+
+	func deadWitness()
+}
+
+public struct PublicAdopt : PublicProt {
+	public init() {}
+
+	@inline(never)
+	public func aliveWitness() {
+	}
+
+	@inline(never)
+	public func deadWitness() {
+	}
+}
+
+@inline(never)
+public func deadPublicFunction() {
+}
+
+@inline(never)
+@_silgen_name("whole_program_called_from_c")
+public func calledFromC() {
+}
+
+@inline(never)
+@_semantics("optimize.sil.never") // avoid devirtualization
+func testClasses(b: PublicBase) {
+	b.aliveMethod()
+}
+
+@inline(never)
+@_semantics("optimize.sil.never") // avoid devirtualization
+func testProtocols(p: PublicProt) {
+	p.aliveWitness()
+}
+
+testClasses(PublicBase())
+testProtocols(PublicAdopt())
+
+// CHECK-WMO: sil {{.*}}deadPublicFunction
+// CHECK-WMO-LABEL: sil_vtable PublicBase
+// CHECK-WMO: deadMethod
+// CHECK-WMO-LABEL: sil_witness_table PublicAdopt: PublicProt
+// CHECK-WMO: deadWitness{{.*}}: @{{.*}}deadWitness
+
+// CHECK-DAG: sil @main
+// CHECK-DAG: sil {{.*}}@whole_program_called_from_c
+
+// CHECK-DEAD-NOT: sil {{.*}}deadPublicFunction
+// CHECK-DEAD-NOT: sil {{.*}}deadMethod
+// CHECK-DEAD-NOT: sil {{.*}}deadWitness
+
+// CHECK-LABEL: sil_vtable PublicBase
+// CHECK: aliveMethod
+// CHECK-NOT: deadMethod
+
+// CHECK-LABEL: sil_witness_table PublicAdopt: PublicProt
+// CHECK: aliveWitness!1: @{{.*}}aliveWitness
+// CHECK: deadWitness!1: nil
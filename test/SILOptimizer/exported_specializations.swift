@@ -0,0 +1,20 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -O -emit-module -module-name ExportSpec -export-specializations-of makeBox -o %t %S/Inputs/exported_specializations_input.swift
+// RUN: %target-swift-frontend -O -emit-sil -I %t %s | FileCheck %s
+// RUN: %target-swift-frontend -Onone -emit-sil -I %t %s | FileCheck %s
+
+// Check that calls to generic functions of another module use the
+// specializations that module exports, but only those.
+
+import ExportSpec
+
+// CHECK-LABEL: sil {{.*}}@_TF24exported_specializations4testFT_T_
+// CHECK: function_ref @_TTSg5Si___TF10ExportSpec7makeBox
+// CHECK: function_ref @_TF10ExportSpec12makeOtherBox
+// CHECK: return
+@inline(never)
+public func test() {
+  _ = makeBox(2 as Int)
+  _ = makeOtherBox(2 as Int)
+}
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module %S/Inputs/linker_pass_input.swift -o %t/Swift.swiftmodule -parse-stdlib -parse-as-library -module-name Swift -sil-serialize-all -module-link-name swiftCore
+// RUN: %target-swift-frontend %s -O -I %t -sil-debug-serialization -sil-link-on-demand -o - -emit-sil | FileCheck %s
+
+// The body of doSomething is deserialized when the inliner considers the
+// call, so the call to unknown ends up in main.
+
+// CHECK-LABEL: sil @main
+// CHECK: function_ref @unknown
+doSomething()
+
+// callDoSomething3 is never inlined, so its body is never deserialized.
+
+// CHECK-NOT: sil public_external {{.*}}callDoSomething3{{.*}} {
+// CHECK: sil {{.*}}[noinline] @{{.*}}callDoSomething3{{.*}} : $@convention(thin) () -> (){{$}}
+callDoSomething3()
@@ -0,0 +1,19 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -O -emit-sil %s -sil-pass-profile %t/profile.json -o /dev/null
+// RUN: FileCheck %s < %t/profile.json
+
+// CHECK: [
+// CHECK: "stage": "
+// CHECK: "pass": "
+// CHECK: "function": "_TF12pass_profile3add
+// CHECK: "wall-time-ns":
+// CHECK: "instructions-before":
+// CHECK: "instructions-after":
+// CHECK: "allocated-bytes":
+// CHECK: "total-allocated-bytes":
+// CHECK: "invalidations":
+// CHECK: ]
+
+func add(x: Int, _ y: Int) -> Int {
+  return x + y
+}
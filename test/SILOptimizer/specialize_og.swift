@@ -0,0 +1,20 @@
+// RUN: %target-swift-frontend %s -Og -emit-sil | FileCheck %s
+
+// Check that -Og specializes generic calls without inlining them, and keeps
+// the debug info of variables.
+
+@inline(never)
+func identity<T>(x: T) -> T {
+  return x
+}
+
+// CHECK-LABEL: sil hidden @_TF13specialize_og4test{{.*}} : $@convention(thin) (Int) -> Int
+// CHECK:       bb0([[X:%.*]] : $Int):
+// CHECK:         debug_value [[X]] : $Int
+// CHECK:         [[SPECIALIZED:%.*]] = function_ref @_TTSg5Si___TF13specialize_og8identity
+// CHECK:         apply [[SPECIALIZED]]
+// CHECK:         return
+func test(x: Int) -> Int {
+  let y = identity(x)
+  return y
+}
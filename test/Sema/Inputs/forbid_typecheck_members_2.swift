@@ -0,0 +1,5 @@
+class ClsSec {
+  let member : Int = 0
+
+  func NOTYPECHECK_method() {}
+}
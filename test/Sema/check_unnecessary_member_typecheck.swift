@@ -0,0 +1,11 @@
+// Without SILGen, members of types from the secondary file that the primary
+// file does not use are never validated.
+
+// RUN: %target-swift-frontend -parse -primary-file %s %S/Inputs/forbid_typecheck_members_2.swift -debug-forbid-typecheck-prefix NOTYPECHECK
+// RUN: not --crash %target-swift-frontend -emit-silgen -primary-file %s %S/Inputs/forbid_typecheck_members_2.swift -debug-forbid-typecheck-prefix NOTYPECHECK 2>&1 | FileCheck %s
+
+// CHECK: forbidden typecheck occurred: NOTYPECHECK_method
+
+func primFn() -> Int {
+  return ClsSec().member
+}
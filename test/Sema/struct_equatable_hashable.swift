@@ -0,0 +1,71 @@
+// RUN: %target-swift-frontend -parse -verify %s
+
+struct Point : Hashable {
+  var x: Int
+  let y: Int
+}
+
+if Point(x: 1, y: 2) == Point(x: 1, y: 2) { }
+var pointHash: Int = Point(x: 1, y: 2).hashValue
+
+// Stored properties of derived struct types can themselves be derived.
+struct Segment : Hashable {
+  var from: Point
+  var to: Point
+  var name: String
+  static var count = 0
+  var length: Int { return 0 }
+}
+
+if Segment(from: Point(x: 0, y: 0), to: Point(x: 1, y: 1), name: "a") ==
+   Segment(from: Point(x: 0, y: 0), to: Point(x: 1, y: 1), name: "b") { }
+var segmentHash: Int =
+  Segment(from: Point(x: 0, y: 0), to: Point(x: 1, y: 1), name: "").hashValue
+
+struct Empty : Hashable {}
+
+if Empty() == Empty() { }
+var emptyHash: Int = Empty().hashValue
+
+// Conformance declared in an extension.
+struct Size {
+  var width: Double
+  var height: Double
+}
+
+extension Size : Equatable {}
+
+if Size(width: 1, height: 2) == Size(width: 2, height: 1) { }
+
+// Explicit definitions take precedence.
+struct CustomHashable : Hashable {
+  var x: Int
+
+  var hashValue: Int { return 0 }
+}
+func ==(a: CustomHashable, b: CustomHashable) -> Bool {
+  return true
+}
+
+if CustomHashable(x: 1) == CustomHashable(x: 2) { }
+var customHash: Int = CustomHashable(x: 1).hashValue
+
+// Structs are not implicitly Equatable or Hashable.
+struct NotDeclared {
+  var x: Int
+}
+
+var notDeclaredHash = NotDeclared(x: 1).hashValue // expected-error{{value of type 'NotDeclared' has no member 'hashValue'}}
+
+// All stored properties must conform.
+class NotEquatable {}
+
+struct HasNonEquatableProperty : Equatable { // expected-error{{does not conform}}
+  var x: Int
+  var object: NotEquatable
+}
+
+// Generic structs are not derived.
+struct Wrapper<T : Hashable> : Hashable { // expected-error 2 {{does not conform}}
+  var value: T
+}
@@ -0,0 +1,15 @@
+public func publicGeneric<T>(x: T) -> T {
+  return x
+}
+
+struct InternalBox<T> {
+  var value: T
+}
+
+public func usesInternalType<T>(x: T) -> T {
+  return InternalBox(value: x).value
+}
+
+public func nonGeneric(x: Int) -> Int {
+  return x
+}
@@ -0,0 +1,49 @@
+public struct Point {
+  public var x: Int
+  public var y: Int
+
+  public init(x: Int, y: Int) {
+    self.x = x
+    self.y = y
+  }
+
+  public func scaled(by factor: Int) -> Point {
+    return Point(x: x * factor, y: y * factor)
+  }
+
+  public func scaled(byX factor: Int) -> Point {
+    return Point(x: x * factor, y: y)
+  }
+
+  public subscript(i: Int) -> Int {
+    return i == 0 ? x : y
+  }
+}
+
+extension Point {
+  public var sum: Int { return x + y }
+
+  public func scaled(byY factor: Int) -> Point {
+    return Point(x: x, y: y * factor)
+  }
+}
+
+public class Shape {
+  public init() {}
+  public func area() -> Int { return 0 }
+}
+
+public class Square : Shape {
+  public var side: Int
+  public init(side: Int) { self.side = side }
+  public override func area() -> Int { return side * side }
+}
+
+public protocol Named {
+  var name: String { get }
+  func rename(to: String)
+}
+
+extension Named {
+  public func greeting() -> String { return "Hello, " + name }
+}
@@ -0,0 +1,21 @@
+public struct Outer {
+  public struct Inner {
+    public init() {}
+  }
+
+  public class Deeper {
+    public enum Innermost {
+      case value
+    }
+  }
+}
+
+extension Outer {
+  public enum FromExtension {
+    case one, two
+  }
+}
+
+public protocol Wrapper {
+  associatedtype Wrapped
+}
@@ -0,0 +1,13 @@
+import def_nested_types
+
+public func makeInner() -> Outer.Inner {
+  return Outer.Inner()
+}
+
+public func pick(_ x: Outer.FromExtension) -> Outer.Deeper.Innermost {
+  return .value
+}
+
+extension Outer.Inner : Wrapper {
+  public typealias Wrapped = Outer.FromExtension
+}
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/a %t/b
+// RUN: %target-swift-frontend -emit-module -o %t/a %S/Inputs/def_struct.swift
+// RUN: %target-swift-frontend -emit-module -o %t/b %S/Inputs/def_struct.swift
+// RUN: llvm-bcanalyzer -dump %t/a/def_struct.swiftmodule | FileCheck %s
+
+// Rebuilding a module from the same source produces the same file, hash
+// included.
+// RUN: cmp %t/a/def_struct.swiftmodule %t/b/def_struct.swiftmodule
+
+// The hash is part of the control block.
+// CHECK: <CONTROL_BLOCK
+// CHECK: <CONTENT_HASH {{.*}}/> blob data = '{{.+}}'
+// CHECK: </CONTROL_BLOCK>
+
+// RUN: %target-swift-frontend -parse -I %t/a %s
+import def_struct
@@ -0,0 +1,29 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_member_names.swift
+// RUN: llvm-bcanalyzer %t/def_member_names.swiftmodule | FileCheck %s
+// RUN: %target-swift-frontend -parse -I %t %s -verify
+
+// Make sure the MEMBER_NAMES table is present.
+// CHECK: MEMBER_NAMES
+
+import def_member_names
+
+// Members of deserialized types are loaded by name; make sure lookup still
+// finds overloads, members of extensions, and inherited members.
+var p = Point(x: 1, y: 2)
+_ = p.scaled(by: 2)
+_ = p.scaled(byX: 2)
+_ = p.scaled(byY: 2)
+_ = p.sum + p[0] + p.x
+_ = p.missing // expected-error{{value of type 'Point' has no member 'missing'}}
+
+let s: Shape = Square(side: 3)
+_ = s.area()
+_ = Square(side: 2).side
+
+struct Person : Named {
+  var name: String
+  func rename(to: String) {}
+}
+_ = Person(name: "x").greeting()
@@ -0,0 +1,18 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_nested_types.swift
+// RUN: llvm-bcanalyzer %t/def_nested_types.swiftmodule | FileCheck %s
+// RUN: %target-swift-frontend -emit-module -o %t -I %t %S/Inputs/nested_types_user.swift
+// RUN: %target-swift-frontend -parse -I %t %s -verify
+
+// Make sure the NESTED_TYPE_DECLS table is present.
+// CHECK: NESTED_TYPE_DECLS
+
+import def_nested_types
+import nested_types_user
+
+// Cross-references to nested types, including types nested in extensions,
+// are resolved through the nested type table.
+let inner: Outer.Inner = makeInner()
+let innermost: Outer.Deeper.Innermost = pick(.two)
+let wrapped: Outer.Inner.Wrapped = .one
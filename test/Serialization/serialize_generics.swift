@@ -0,0 +1,26 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -sil-serialize-generics -o %t %S/Inputs/def_generics_serialized.swift
+// RUN: llvm-bcanalyzer %t/def_generics_serialized.swiftmodule | FileCheck %s
+// RUN: %target-swift-frontend -emit-silgen -sil-link-all -I %t %s | FileCheck %s -check-prefix=SIL
+// RUN: %target-swift-frontend -emit-module -sil-serialize-generics -sil-serialize-generics-limit 0 -o %t %S/Inputs/def_generics_serialized.swift
+// RUN: %target-swift-frontend -emit-silgen -sil-link-all -I %t %s | FileCheck %s -check-prefix=LIMIT
+
+// CHECK-NOT: UnknownCode
+
+import def_generics_serialized
+
+// Only public generic functions whose bodies don't refer to internal types
+// are serialized.
+
+// SIL-NOT: sil public_external @{{.*}}usesInternalType{{.*}} {
+// SIL-NOT: sil public_external @{{.*}}nonGeneric{{.*}} {
+// SIL: sil public_external @{{.*}}publicGeneric{{.*}} : $@convention(thin) <T> (@out T, @in T) -> () {
+// SIL-NOT: sil public_external @{{.*}}usesInternalType{{.*}} {
+// SIL-NOT: sil public_external @{{.*}}nonGeneric{{.*}} {
+
+// LIMIT-NOT: sil public_external @{{.*}}publicGeneric{{.*}} {
+
+let a = publicGeneric(x: 1)
+let b = usesInternalType(x: 2)
+let c = nonGeneric(x: 3)
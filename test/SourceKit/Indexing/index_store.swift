@@ -0,0 +1,23 @@
+// RUN: rm -rf %t.store
+// RUN: %sourcekitd-test -req=index.store.ondisk -cache-path=%t.store == \
+// RUN:     -req=index %s -- %s | %sed_clean > %t.response1
+
+// Make sure we kept a record for the file.
+// RUN: ls %t.store | grep "index_store.swift-.*\.index"
+
+// Indexing the unchanged file again reports the stored entities.
+// RUN: %sourcekitd-test -req=index.store.ondisk -cache-path=%t.store == \
+// RUN:     -req=index %s -- %s | %sed_clean > %t.response2
+// RUN: diff -u %t.response1 %t.response2
+
+// The stored entities match the ones from walking the AST.
+// RUN: %sourcekitd-test -req=index %s -- %s | %sed_clean > %t.response3
+// RUN: diff -u %t.response1 %t.response3
+
+// RUN: FileCheck %s < %t.response1
+// CHECK: key.name: "StoredClass"
+// CHECK: key.name: "storedMethod()"
+
+class StoredClass {
+  func storedMethod() {}
+}
@@ -11,6 +11,13 @@ var x: FooClassBase
 // RUN:         %mcp_opt %clang-importer-sdk > %t.response
 // RUN: diff -u %s.response %t.response
 
+// Opening the same module again reuses the generated interface.
+// RUN: %sourcekitd-test -req=interface-gen -module Foo -- -I %t.overlays -F %S/../Inputs/libIDE-mock-sdk \
+// RUN:         %mcp_opt %clang-importer-sdk == -req=interface-gen -module Foo -- -I %t.overlays \
+// RUN:         -F %S/../Inputs/libIDE-mock-sdk %mcp_opt %clang-importer-sdk > %t.reopen.response
+// RUN: cat %s.response %s.response > %t.reopen.expected
+// RUN: diff -u %t.reopen.expected %t.reopen.response
+
 // RUN: %sourcekitd-test -req=interface-gen -module Foo.FooSub -- -I %t.overlays -F %S/../Inputs/libIDE-mock-sdk \
 // RUN:         %mcp_opt %clang-importer-sdk > %t.sub.response
 // RUN: diff -u %s.sub.response %t.sub.response
@@ -363,6 +363,10 @@ public:
                            ArrayRef<const char *> Args,
                            StringRef Hash) = 0;
 
+  /// Keep the symbols reported by indexSource() in the directory \p path, so
+  /// that units whose hash has not changed are not walked again.
+  virtual void indexStoreOnDisk(StringRef path) = 0;
+
   virtual void codeComplete(llvm::MemoryBuffer *InputBuf, unsigned Offset,
                             CodeCompletionConsumer &Consumer,
                             ArrayRef<const char *> Args) = 0;
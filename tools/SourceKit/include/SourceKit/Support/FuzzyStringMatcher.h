@@ -14,7 +14,9 @@
 #define LLVM_SOURCEKIT_LIB_SUPPORT_FUZZYSTRINGMATCHER_H
 
 #include "SourceKit/Core/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/BitVector.h"
+#include <cstdint>
 #include <string>
 
 namespace SourceKit {
@@ -32,6 +34,8 @@ class FuzzyStringMatcher {
   double maxScore; ///< The maximum possible raw score for this pattern.
   /// If (and only if) c is in pattern, charactersInPattern[c] == 1
   llvm::BitVector charactersInPattern;
+  /// The character mask of the lowercased pattern.
+  uint64_t patternMask;
 
 public:
   bool normalize = false; ///< Whether to normalize scores to [0, 1].
@@ -47,6 +51,27 @@ public:
 
   /// Calculates the numerical score for \p candidate.
   double scoreCandidate(StringRef candidate) const;
+
+  /// Calculates the scores of many candidates at once, storing the score of
+  /// each of \p candidates in the same position of \p scores. Candidates that
+  /// don't match score 0.
+  ///
+  /// Very large batches are split across threads.
+  void scoreCandidates(ArrayRef<StringRef> candidates,
+                       llvm::MutableArrayRef<double> scores) const;
+
+  /// Returns a mask of the (case-insensitive) characters in \p str.
+  ///
+  /// Computing the mask is as expensive as matching, but it can be stored
+  /// with the candidate and reused for every pattern; see
+  /// \c mayMatchCandidate().
+  static uint64_t getCharacterMask(StringRef str);
+
+  /// Whether a candidate with the character mask \p candidateMask may match
+  /// the pattern. If this returns false, \c matchesCandidate() is false too.
+  bool mayMatchCandidate(uint64_t candidateMask) const {
+    return (patternMask & ~candidateMask) == 0;
+  }
 };
 
 } // end namespace SourceKit
@@ -21,12 +21,18 @@
 #include "llvm/Support/Mutex.h"
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace llvm {
   class MemoryBuffer;
   class SourceMgr;
 }
 
+namespace clang {
+  class RewriteRope;
+}
+
 namespace SourceKit {
 
 class ImmutableTextUpdate;
@@ -72,6 +78,9 @@ private:
 class ImmutableTextBuffer : public ImmutableTextUpdate {
   std::unique_ptr<llvm::SourceMgr> SrcMgr;
   unsigned BufId;
+  /// The offsets at which lines start, computed on first use.
+  mutable std::vector<unsigned> LineStarts;
+  mutable std::once_flag LineStartsOnce;
 
 public:
   explicit ImmutableTextBuffer(std::unique_ptr<llvm::MemoryBuffer> MemBuf,
@@ -86,6 +95,10 @@ public:
   /// ImmutableTextBuffer object that it came from.
   const llvm::MemoryBuffer *getInternalBuffer() const;
 
+  /// Returns the 1-based line and column of \p ByteOffset, or (0, 0) if it
+  /// is past the end of the text.
+  ///
+  /// The first call indexes the lines; later calls take logarithmic time.
   std::pair<unsigned, unsigned> getLineAndColumn(unsigned ByteOffset) const;
 
   static bool classof(const ImmutableTextUpdate *ITD) {
@@ -156,10 +169,15 @@ class EditableTextBuffer : public ThreadSafeRefCountedBase<EditableTextBuffer> {
   llvm::sys::Mutex EditMtx;
   ImmutableTextBufferRef Root;
   ImmutableTextUpdateRef CurrUpd;
+  /// The text as of \c CurrUpd, which edits update in logarithmic time so
+  /// that the buffer of the latest snapshot doesn't have to be rebuilt from
+  /// the edit history.
+  std::unique_ptr<clang::RewriteRope> CurrText;
   std::string Filename;
 
 public:
   explicit EditableTextBuffer(StringRef Filename, StringRef Text = StringRef());
+  ~EditableTextBuffer();
 
   StringRef getFilename() const { return Filename; }
 
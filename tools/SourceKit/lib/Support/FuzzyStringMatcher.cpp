@@ -14,6 +14,9 @@
 #include "clang/Basic/CharInfo.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallString.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 using namespace SourceKit;
 using clang::toUppercase;
@@ -33,6 +36,7 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
     charactersInPattern.set(static_cast<unsigned char>(toUppercase(c)));
   }
   assert(pattern.size() == lowercasePattern.size());
+  patternMask = getCharacterMask(lowercasePattern);
 
   // FIXME: pull out the magic constants.
   // This depends on the inner details of the matching algorithm and  will need
@@ -50,6 +54,22 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
   }
 }
 
+uint64_t FuzzyStringMatcher::getCharacterMask(StringRef str) {
+  uint64_t mask = 0;
+  for (char c : str) {
+    unsigned char lower = toLowercase(c);
+    unsigned bit;
+    if (lower >= 'a' && lower <= 'z')
+      bit = lower - 'a';
+    else if (lower >= '0' && lower <= '9')
+      bit = 26 + (lower - '0');
+    else
+      bit = 36 + lower % 28; // Everything else shares the remaining bits.
+    mask |= uint64_t(1) << bit;
+  }
+  return mask;
+}
+
 bool FuzzyStringMatcher::matchesCandidate(StringRef candidate) const {
   unsigned patternLength = pattern.size();
   unsigned candidateLength = candidate.size();
@@ -202,6 +222,44 @@ double FuzzyStringMatcher::scoreCandidate(StringRef candidate) const {
   return finalScore;
 }
 
+void FuzzyStringMatcher::scoreCandidates(
+    ArrayRef<StringRef> candidates,
+    llvm::MutableArrayRef<double> scores) const {
+  assert(candidates.size() == scores.size());
+
+  auto scoreRange = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i != end; ++i) {
+      // Matching is much cheaper than scoring, so weed out the candidates
+      // that don't match first.
+      scores[i] = matchesCandidate(candidates[i])
+                      ? scoreCandidate(candidates[i])
+                      : 0.0;
+    }
+  };
+
+  // Threads only pay off for batches much larger than a typical result list.
+  static const size_t minCandidatesPerThread = 8192;
+  size_t numThreads =
+      std::min<size_t>(std::thread::hardware_concurrency(),
+                       candidates.size() / minCandidatesPerThread);
+  if (numThreads <= 1) {
+    scoreRange(0, candidates.size());
+    return;
+  }
+
+  size_t chunkSize = (candidates.size() + numThreads - 1) / numThreads;
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (size_t begin = chunkSize; begin < candidates.size();
+       begin += chunkSize) {
+    size_t end = std::min(begin + chunkSize, candidates.size());
+    threads.emplace_back(scoreRange, begin, end);
+  }
+  scoreRange(0, chunkSize);
+  for (auto &thread : threads)
+    thread.join();
+}
+
 CandidateSpecificMatcher::CandidateSpecificMatcher(
     StringRef pattern, StringRef lowercasePattern, StringRef candidate,
     const llvm::BitVector &charactersInPattern, unsigned &firstPatternPos)
@@ -14,6 +14,7 @@
 #include "clang/Rewrite/Core/RewriteRope.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include <algorithm>
 
 using namespace SourceKit;
 using namespace llvm;
@@ -51,12 +52,23 @@ const llvm::MemoryBuffer *ImmutableTextBuffer::getInternalBuffer() const {
 
 std::pair<unsigned, unsigned>
 ImmutableTextBuffer::getLineAndColumn(unsigned ByteOffset) const {
-  auto Buf = SrcMgr->getMemoryBuffer(BufId);
-  if (ByteOffset > Buf->getBufferSize())
+  StringRef Text = getText();
+  if (ByteOffset > Text.size())
     return std::make_pair(0, 0);
 
-  SMLoc Loc = SMLoc::getFromPointer(Buf->getBufferStart() + ByteOffset);
-  return SrcMgr->getLineAndColumn(Loc, 0);
+  std::call_once(LineStartsOnce, [&] {
+    LineStarts.push_back(0);
+    for (size_t I = 0, E = Text.size(); I != E; ++I) {
+      if (Text[I] == '\n')
+        LineStarts.push_back(I + 1);
+    }
+  });
+
+  // Find the last line that starts at or before the offset.
+  auto Line = std::upper_bound(LineStarts.begin(), LineStarts.end(),
+                               ByteOffset) - 1;
+  return std::make_pair(unsigned(Line - LineStarts.begin()) + 1,
+                        ByteOffset - *Line + 1);
 }
 
 ReplaceImmutableTextUpdate::ReplaceImmutableTextUpdate(
@@ -119,12 +131,16 @@ bool ImmutableTextSnapshot::foreachReplaceUntil(
 
 static std::atomic<uint64_t> Generation{ 0 };
 
-EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text) {
+EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text)
+  : CurrText(new RewriteRope) {
   this->Filename = Filename;
   Root = new ImmutableTextBuffer(Filename, Text, ++Generation);
   CurrUpd = Root;
+  CurrText->assign(Text.begin(), Text.end());
 }
 
+EditableTextBuffer::~EditableTextBuffer() = default;
+
 ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
   return new ImmutableTextSnapshot(const_cast<EditableTextBuffer*>(this), Root,
                                    CurrUpd);
@@ -165,6 +181,11 @@ ImmutableTextSnapshotRef EditableTextBuffer::addAtomicUpdate(
   CurrUpd->Next = NewUpd;
   CurrUpd = NewUpd;
 
+  auto ReplaceUpd = cast<ReplaceImmutableTextUpdate>(NewUpd);
+  CurrText->erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
+  StringRef Text = ReplaceUpd->getText();
+  CurrText->insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
+
   return new ImmutableTextSnapshot(this, Root, CurrUpd);
 }
 
@@ -198,6 +219,20 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
       return Buf;
 
+  {
+    // The text of the latest snapshot is already at hand.
+    llvm::sys::ScopedLock L(EditMtx);
+    refresh();
+    if (Snap.DiffEnd == CurrUpd) {
+      auto MemBuf = getMemBufferFromRope(getFilename(), *CurrText);
+      ImmutableTextBufferRef ImmBuf =
+          new ImmutableTextBuffer(std::move(MemBuf), Snap.getStamp());
+      Snap.DiffEnd->Next = ImmBuf;
+      refresh();
+      return ImmBuf;
+    }
+  }
+
   // Check if a buffer was created in the middle of the snapshot updates.
   ImmutableTextBufferRef StartBuf = Snap.BufferStart;
   ImmutableTextUpdateRef Upd = StartBuf;  
@@ -11,9 +11,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "SourceKit/Support/UIdent.h"
-#include "SourceKit/Support/Concurrency.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 #include <mutex>
 #include <vector>
 
@@ -21,11 +23,122 @@ using namespace SourceKit;
 using llvm::StringRef;
 
 namespace {
+/// An insert-only hash trie from strings to registry entries.
+///
+/// Lookups don't take any locks. Inserts must be serialized by the caller;
+/// every node and leaf is fully initialized before it is published, and
+/// nothing is ever removed, so a concurrent lookup sees either the old or
+/// the new state of a slot.
+class UIDHashTrie {
+  static const unsigned BitsPerLevel = 4;
+  static const unsigned SlotsPerNode = 1 << BitsPerLevel;
+  static const unsigned MaxLevel = 64 / BitsPerLevel;
+
+  struct Leaf {
+    uint64_t Hash;
+    StringRef Key;
+    void *Value;
+    /// Another leaf with the same hash.
+    std::atomic<Leaf *> Next;
+
+    Leaf(uint64_t Hash, StringRef Key, void *Value)
+      : Hash(Hash), Key(Key), Value(Value), Next(nullptr) {}
+  };
+
+  struct Node;
+
+  /// A slot holds either a Node, tagged with the low bit, or a Leaf.
+  typedef std::atomic<uintptr_t> Slot;
+
+  struct Node {
+    Slot Slots[SlotsPerNode];
+    Node() {
+      for (auto &S : Slots)
+        S.store(0, std::memory_order_relaxed);
+    }
+  };
+
+  Node Root;
+
+  static unsigned getIndex(uint64_t Hash, unsigned Level) {
+    return (Hash >> (Level * BitsPerLevel)) & (SlotsPerNode - 1);
+  }
+  static bool isNode(uintptr_t Value) { return Value & 1; }
+  static Node *getNode(uintptr_t Value) {
+    return reinterpret_cast<Node *>(Value & ~uintptr_t(1));
+  }
+  static Leaf *getLeaf(uintptr_t Value) {
+    return reinterpret_cast<Leaf *>(Value);
+  }
+
+public:
+  void *find(uint64_t Hash, StringRef Key) const {
+    const Node *N = &Root;
+    for (unsigned Level = 0; Level != MaxLevel; ++Level) {
+      uintptr_t Value =
+          N->Slots[getIndex(Hash, Level)].load(std::memory_order_acquire);
+      if (!Value)
+        return nullptr;
+      if (isNode(Value)) {
+        N = getNode(Value);
+        continue;
+      }
+      for (Leaf *L = getLeaf(Value); L;
+           L = L->Next.load(std::memory_order_acquire)) {
+        if (L->Hash == Hash && L->Key == Key)
+          return L->Value;
+      }
+      return nullptr;
+    }
+    return nullptr;
+  }
+
+  /// Add \p Key, which must not be in the trie yet. \p Key must outlive the
+  /// trie.
+  void insert(uint64_t Hash, StringRef Key, void *Value) {
+    Leaf *NewLeaf = new Leaf(Hash, Key, Value);
+    Node *N = &Root;
+    for (unsigned Level = 0; Level != MaxLevel; ++Level) {
+      Slot &S = N->Slots[getIndex(Hash, Level)];
+      uintptr_t Existing = S.load(std::memory_order_relaxed);
+      if (!Existing) {
+        S.store(reinterpret_cast<uintptr_t>(NewLeaf),
+                std::memory_order_release);
+        return;
+      }
+      if (isNode(Existing)) {
+        N = getNode(Existing);
+        continue;
+      }
+
+      Leaf *Old = getLeaf(Existing);
+      if (Old->Hash == Hash || Level + 1 == MaxLevel) {
+        // Chain leaves whose hashes can't be told apart any further.
+        NewLeaf->Next.store(Old->Next.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+        Old->Next.store(NewLeaf, std::memory_order_release);
+        return;
+      }
+
+      // Push the existing leaf one level down and descend into the new node.
+      Node *Child = new Node();
+      Child->Slots[getIndex(Old->Hash, Level + 1)]
+          .store(Existing, std::memory_order_relaxed);
+      S.store(reinterpret_cast<uintptr_t>(Child) | 1,
+              std::memory_order_release);
+      N = Child;
+    }
+  }
+};
+
 class UIDRegistryImpl {
   typedef llvm::StringMap<void *, llvm::BumpPtrAllocator> HashTableTy;
   typedef llvm::StringMapEntry<void *> EntryTy;
+  /// Owns the entries; only accessed while holding \c InsertMtx.
   HashTableTy HashTable;
-  WorkQueue Queue{ WorkQueue::Dequeuing::Concurrent, "UIDRegistryImpl" };
+  /// Indexes the entries of \c HashTable for lock-free lookups.
+  UIDHashTrie Trie;
+  std::mutex InsertMtx;
 
 public:
 
@@ -36,12 +149,13 @@ public:
 };
 }
 
+/// A small direct-mapped cache of the UIDs most recently looked up by this
+/// thread.
+static const unsigned NumRecentUIDs = 64;
+static LLVM_THREAD_LOCAL void *RecentUIDs[NumRecentUIDs];
+
 static UIDRegistryImpl *getGlobalRegistry() {
-  static UIDRegistryImpl *GlobalRegistry = 0;
-  if (!GlobalRegistry) {
-    static std::once_flag flag;
-    std::call_once(flag, [](){ GlobalRegistry = new UIDRegistryImpl(); });
-  }
+  static UIDRegistryImpl *GlobalRegistry = new UIDRegistryImpl();
   return GlobalRegistry;
 }
 
@@ -85,20 +199,25 @@ void UIdent::print(llvm::raw_ostream &OS) const {
 void *UIDRegistryImpl::get(StringRef Str) {
   assert(!Str.empty());
   assert(Str.find(' ') == StringRef::npos);
-  EntryTy *Ptr = 0;
-  Queue.dispatchSync([&]{
-    HashTableTy::iterator It = HashTable.find(Str);
-    if (It != HashTable.end())
-      Ptr = &(*It);
-  });
-
-  if (Ptr == 0) {
-    Queue.dispatchBarrierSync([&]{
+  uint64_t Hash = llvm::hash_value(Str);
+
+  void *&Recent = RecentUIDs[Hash % NumRecentUIDs];
+  if (Recent && getName(Recent) == Str)
+    return Recent;
+
+  void *Ptr = Trie.find(Hash, Str);
+  if (!Ptr) {
+    std::lock_guard<std::mutex> Guard(InsertMtx);
+    // Another thread may have added it since the lookup.
+    Ptr = Trie.find(Hash, Str);
+    if (!Ptr) {
       EntryTy &Entry = *HashTable.insert(std::make_pair(Str, nullptr)).first;
       Ptr = &Entry;
-    });
+      Trie.insert(Hash, Entry.getKey(), Ptr);
+    }
   }
 
+  Recent = Ptr;
   return Ptr;
 }
 
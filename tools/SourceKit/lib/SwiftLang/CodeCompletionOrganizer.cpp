@@ -197,7 +197,8 @@ public:
 
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, Options options,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *matches);
 
   void sort(Options options);
 
@@ -271,8 +272,27 @@ void CodeCompletionOrganizer::preSortCompletions(
 
 void CodeCompletionOrganizer::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText,
-    Completion *&exactMatch) {
-  impl.addCompletionsWithFilter(completions, filterText, options, exactMatch);
+    Completion *&exactMatch, std::vector<Completion *> *matches) {
+  impl.addCompletionsWithFilter(completions, filterText, options, exactMatch,
+                                matches);
+}
+
+static bool usesFuzzyMatching(StringRef filterText, const Options &options) {
+  return options.fuzzyMatching && filterText.size() >= options.minFuzzyLength;
+}
+
+bool CodeCompletionOrganizer::canRefineFilter(StringRef previousFilterText,
+                                              StringRef filterText,
+                                              const Options &options) {
+  // Without a filter, some results are hidden rather than filtered out.
+  if (previousFilterText.empty() ||
+      !filterText.startswith_lower(previousFilterText))
+    return false;
+
+  // Both fuzzy and prefix matching only get stricter as the filter text grows,
+  // but a fuzzy match is looser than a prefix match.
+  return !usesFuzzyMatching(filterText, options) ||
+         usesFuzzyMatching(previousFilterText, options);
 }
 
 void CodeCompletionOrganizer::groupAndSort(const Options &options) {
@@ -426,7 +446,7 @@ static bool isHighPriorityKeyword(CodeCompletionKeywordKind kind) {
 
 void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText, Options options,
-    Completion *&exactMatch) {
+    Completion *&exactMatch, std::vector<Completion *> *matches) {
   assert(rootGroup);
 
   auto &contents = rootGroup->contents;
@@ -486,29 +506,54 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
 
   FuzzyStringMatcher pattern(filterText);
   pattern.normalize = true;
+  bool fuzzy = usesFuzzyMatching(filterText, options);
+  std::vector<Completion *> results;
   for (Completion *completion : completions) {
+    // Neither kind of match is possible if the name lacks some character of
+    // the filter text.
+    if (!pattern.mayMatchCandidate(completion->getNameCharacterMask()))
+      continue;
+
     bool match = false;
-    if (options.fuzzyMatching && filterText.size() >= options.minFuzzyLength) {
+    if (fuzzy) {
       match = pattern.matchesCandidate(completion->getName());
     } else {
       match = completion->getName().startswith_lower(filterText);
     }
+    if (!match)
+      continue;
+
+    if (matches)
+      matches->push_back(completion);
 
-    if (match && completion->getName().equals_lower(filterText)) {
+    if (completion->getName().equals_lower(filterText)) {
       if (!exactMatch)
         exactMatch = completion;
-      match = (options.addInnerResults || options.addInnerOperators)
-                  ? options.includeExactMatch
-                  : true;
+      if ((options.addInnerResults || options.addInnerOperators) &&
+          !options.includeExactMatch)
+        continue;
     }
 
-    // Build wrapper and add to results.
-    if (match) {
-      auto wrapper = make_result(completion);
-      if (options.fuzzyMatching)
-        wrapper->matchScore = pattern.scoreCandidate(completion->getName());
-      contents.push_back(std::move(wrapper));
-    }
+    results.push_back(completion);
+  }
+
+  // Score the results in one batch.
+  std::vector<double> scores;
+  if (options.fuzzyMatching) {
+    std::vector<StringRef> names;
+    names.reserve(results.size());
+    for (Completion *completion : results)
+      names.push_back(completion->getName());
+    scores.resize(results.size());
+    pattern.scoreCandidates(names, scores);
+  }
+
+  // Build wrappers and add to results.
+  for (size_t i = 0, e = results.size(); i != e; ++i) {
+    auto wrapper = make_result(results[i]);
+    if (options.fuzzyMatching)
+      wrapper->matchScore = scores[i];
+    contents.push_back(std::move(wrapper));
   }
 }
 
@@ -84,9 +84,20 @@ public:
   /// Add \p completions to the organizer, removing any results that don't match
   /// \p filterText and returning \p exactMatch if there is an exact match.
   ///
+  /// If \p matches is non-null and \p filterText is not empty, every
+  /// completion that matches \p filterText is appended to it, in order,
+  /// whether or not it was added as a result.
+  ///
   /// Precondition: \p completions should be sorted with preSortCompletions().
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
-                                StringRef filterText, Completion *&exactMatch);
+                                StringRef filterText, Completion *&exactMatch,
+                                std::vector<Completion *> *matches = nullptr);
+
+  /// Whether every completion matching \p filterText also matches
+  /// \p previousFilterText, so that filtering can start from the completions
+  /// that matched \p previousFilterText.
+  static bool canRefineFilter(StringRef previousFilterText,
+                              StringRef filterText, const Options &options);
 
   void groupAndSort(const Options &options);
 
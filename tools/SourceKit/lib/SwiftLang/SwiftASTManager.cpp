@@ -20,20 +20,25 @@
 #include "SourceKit/Support/Logging.h"
 #include "SourceKit/Support/Tracing.h"
 
+#include "swift/AST/ClangModuleLoader.h"
 #include "swift/Basic/Cache.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
+#include "swift/Parse/DelayedParsingCallbacks.h"
 #include "swift/Strings.h"
 #include "swift/Subsystems.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/CodeCompletionTypeChecking.h"
 
+#include "clang/AST/ASTContext.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
+#include <atomic>
+
 using namespace SourceKit;
 using namespace swift;
 using namespace swift::sys;
@@ -160,6 +165,7 @@ namespace SourceKit {
     EditorDiagConsumer CollectDiagConsumer;
     CompilerInstance CompInst;
     OwnedResolver TypeResolver{ nullptr, nullptr };
+    SmallVector<std::pair<unsigned, unsigned>, 8> SkippedBodyRanges;
     WorkQueue Queue{ WorkQueue::Dequeuing::Serial, "sourcekit.swift.ConsumeAST" };
 
     Implementation(uint64_t Generation) : Generation(Generation) {}
@@ -209,6 +215,11 @@ namespace SourceKit {
   EditorDiagConsumer &ASTUnit::getEditorDiagConsumer() const {
     return Impl.CollectDiagConsumer;
   }
+
+  ArrayRef<std::pair<unsigned, unsigned>>
+  ASTUnit::getSkippedBodyRanges() const {
+    return Impl.SkippedBodyRanges;
+  }
 }
 
 namespace {
@@ -228,6 +239,17 @@ struct FileContent {
       Stamp(Stamp) {}
 };
 
+/// An edit of the primary file that is confined to one function body.
+struct FunctionBodyEdit {
+  /// The snapshot of the primary file after the edit.
+  ImmutableTextSnapshotRef Snapshot;
+  /// The offset of the first edited byte.
+  unsigned EditOffset;
+  /// The offsets of the body's braces after the edit.
+  unsigned LBraceOffset;
+  unsigned RBraceOffset;
+};
+
 class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   SwiftInvocationRef InvokRef;
   SmallVector<BufferStamp, 8> Stamps;
@@ -236,6 +258,11 @@ class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   std::vector<std::pair<SwiftASTConsumerRef, const void*>> QueuedConsumers;
   llvm::sys::Mutex Mtx;
 
+  /// The snapshots used by the AST build in progress, if any.
+  SmallVector<ImmutableTextSnapshotRef, 4> BuildSnapshots;
+  /// Set to stop the AST build in progress; the type checker polls it.
+  std::atomic<bool> BuildCancelled{false};
+
 public:
   explicit ASTProducer(SwiftInvocationRef InvokRef)
     : InvokRef(std::move(InvokRef)) {}
@@ -246,29 +273,57 @@ public:
     return AST;
   }
 
+  /// Builds the AST for the queued consumers, unless an earlier build has
+  /// already served all of them.
+  ///
+  /// \p Receiver is not called if the build was cancelled, in which case the
+  /// consumers stay queued for the build that superseded it.
   void getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
                        ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                 std::function<void(ASTUnitRef Unit, StringRef Error)> Receiver);
   bool shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
                      ArrayRef<ImmutableTextSnapshotRef> Snapshots);
 
-  void enqueueConsumer(SwiftASTConsumerRef Consumer, const void *OncePerASTToken);
+  /// 
+eturns true if a queued consumer with the same \p OncePerASTToken was
+  /// superseded by \p Consumer.
+  bool enqueueConsumer(SwiftASTConsumerRef Consumer, const void *OncePerASTToken);
   std::vector<SwiftASTConsumerRef> popQueuedConsumers();
+  bool hasQueuedConsumers();
+  bool queuedConsumersCanUsePartialAST();
+
+  /// Cancels the AST build in progress if the documents it was started for
+  /// have been edited since.
+  void cancelStaleBuild(SwiftASTManager::Implementation &MgrImpl);
 
   size_t getMemoryCost() const {
     // FIXME: Report the memory cost of the overall CompilerInstance.
-    if (AST && AST->getCompilerInstance().hasASTContext())
-      return AST->Impl.CompInst.getASTContext().getTotalMemory();
+    if (AST && AST->getCompilerInstance().hasASTContext()) {
+      ASTContext &Ctx = AST->Impl.CompInst.getASTContext();
+      size_t Cost = Ctx.getTotalMemory();
+      // Imported Clang modules are usually the bulk of the memory.
+      if (auto *ClangLoader = Ctx.getClangModuleLoader()) {
+        clang::ASTContext &ClangCtx = ClangLoader->getClangASTContext();
+        Cost += ClangCtx.getASTAllocatedMemory() +
+                ClangCtx.getSideTableAllocatedMemory();
+      }
+      return Cost;
+    }
     return sizeof(*this) + sizeof(*AST);
   }
 
 private:
   ASTUnitRef getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
                             ArrayRef<ImmutableTextSnapshotRef> Snapshots,
-                            std::string &Error);
+                            std::string &Error, bool &Cancelled);
+
+  Optional<FunctionBodyEdit>
+  findFunctionBodyEdit(SwiftASTManager::Implementation &MgrImpl,
+                       ArrayRef<ImmutableTextSnapshotRef> Snapshots);
 
   ASTUnitRef createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                            ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                           Optional<FunctionBodyEdit> BodyEdit,
                            std::string &Error);
 };
 
@@ -299,10 +354,22 @@ struct CacheKeyHashInfo<ASTKey> {
 } // namespace sys
 } // namespace swift.
 
+/// The memory, in bytes, that cached ASTs may use before the least recently
+/// used ones are dropped.
+static const size_t DefaultASTCacheMemoryLimit = size_t(2) << 30;
+
 struct SwiftASTManager::Implementation {
   explicit Implementation(SwiftLangSupport &LangSupport)
     : EditorDocs(LangSupport.getEditorDocuments()),
-      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()) { }
+      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()) {
+    size_t Limit = DefaultASTCacheMemoryLimit;
+    if (const char *EnvOpt = ::getenv("SOURCEKIT_AST_CACHE_LIMIT_MB")) {
+      unsigned LimitMB;
+      if (!StringRef(EnvOpt).getAsInteger(10, LimitMB))
+        Limit = size_t(LimitMB) << 20;
+    }
+    ASTCache.setCostLimit(Limit);
+  }
 
   SwiftEditorDocumentFileMap &EditorDocs;
   std::string RuntimeResourcePath;
@@ -400,6 +467,9 @@ bool SwiftASTManager::initCompilerInvocation(CompilerInvocation &Invocation,
   setModuleName(Invocation);
   Invocation.setSerializedDiagnosticsPath(StringRef());
   Invocation.getLangOptions().AttachCommentsToDecls = true;
+  // Large generated files can repeat the same diagnostic many times over,
+  // and the editor only ever shows one of them.
+  Invocation.getDiagnosticOptions().SuppressDuplicateDiagnostics = true;
   auto &FrontendOpts = Invocation.getFrontendOptions();
   if (FrontendOpts.PlaygroundTransform) {
     // The playground instrumenter changes the AST in ways that disrupt the
@@ -465,6 +535,36 @@ SwiftASTManager::getInvocation(ArrayRef<const char *> OrigArgs,
       *new SwiftInvocation::Implementation(std::move(Opts)));
 }
 
+static void
+buildASTForQueuedConsumers(SwiftASTManager::Implementation &MgrImpl,
+                           ASTProducerRef Producer,
+                           ArrayRef<ImmutableTextSnapshotRef> Snaps) {
+  SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
+  Snapshots.append(Snaps.begin(), Snaps.end());
+
+  Producer->getASTUnitAsync(MgrImpl, Snapshots,
+    [&MgrImpl, Producer, Snapshots](ASTUnitRef Unit, StringRef Error) {
+      auto Consumers = Producer->popQueuedConsumers();
+
+      // A consumer that was queued while a partial AST was being built may
+      // need the whole file checked; queue it again for a full AST.
+      bool NeedsFullAST = false;
+      for (auto &Consumer : Consumers) {
+        if (!Unit) {
+          Consumer->failed(Error);
+        } else if (Unit->isPartial() && !Consumer->canUsePartialAST()) {
+          Producer->enqueueConsumer(std::move(Consumer), nullptr);
+          NeedsFullAST = true;
+        } else {
+          Unit->Impl.consumeAsync(std::move(Consumer), Unit);
+        }
+      }
+
+      if (NeedsFullAST)
+        buildASTForQueuedConsumers(MgrImpl, Producer, Snapshots);
+    });
+}
+
 void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
                                       SwiftASTConsumerRef ASTConsumer,
                                       const void *OncePerASTToken,
@@ -472,25 +572,18 @@ void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
   ASTProducerRef Producer = Impl.getASTProducer(InvokRef);
 
   if (ASTUnitRef Unit = Producer->getExistingAST()) {
-    if (ASTConsumer->canUseASTWithSnapshots(Unit->getSnapshots())) {
+    if ((!Unit->isPartial() || ASTConsumer->canUsePartialAST()) &&
+        ASTConsumer->canUseASTWithSnapshots(Unit->getSnapshots())) {
       Unit->Impl.consumeAsync(std::move(ASTConsumer), Unit);
       return;
     }
   }
 
-  Producer->enqueueConsumer(std::move(ASTConsumer), OncePerASTToken);
-
-  Producer->getASTUnitAsync(Impl, Snapshots,
-    [Producer](ASTUnitRef Unit, StringRef Error) {
-      auto Consumers = Producer->popQueuedConsumers();
-
-      for (auto &Consumer : Consumers) {
-        if (Unit)
-          Unit->Impl.consumeAsync(std::move(Consumer), Unit);
-        else
-          Consumer->failed(Error);
-      }
-    });
+  // A request that supersedes an earlier one usually follows an edit; don't
+  // keep type-checking text that is already out of date.
+  if (Producer->enqueueConsumer(std::move(ASTConsumer), OncePerASTToken))
+    Producer->cancelStaleBuild(Impl);
+  buildASTForQueuedConsumers(Impl, Producer, Snapshots);
 }
 
 void SwiftASTManager::removeCachedAST(SwiftInvocationRef Invok) {
@@ -565,33 +658,60 @@ void ASTProducer::getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
   Snapshots.append(Snaps.begin(), Snaps.end());
 
   MgrImpl.ASTBuildQueue.dispatch([ThisProducer, &MgrImpl, Snapshots, Receiver] {
+    // Requests that arrive while a build is queued each dispatch a build of
+    // their own; the first one to run serves all of them.
+    if (!ThisProducer->hasQueuedConsumers())
+      return;
+
     std::string Error;
-    ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots, Error);
+    bool Cancelled = false;
+    ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots, Error,
+                                                   Cancelled);
+    if (Cancelled)
+      return;
     Receiver(Unit, Error);
   }, /*isStackDeep=*/true);
 }
 
 ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
                                    ArrayRef<ImmutableTextSnapshotRef> Snapshots,
-                                   std::string &Error) {
-  if (!AST || shouldRebuild(MgrImpl, Snapshots)) {
+                                   std::string &Error, bool &Cancelled) {
+  bool CanUsePartialAST = queuedConsumersCanUsePartialAST();
+  if (!AST || shouldRebuild(MgrImpl, Snapshots) ||
+      (AST->isPartial() && !CanUsePartialAST)) {
     bool IsRebuild = AST != nullptr;
     const InvocationOptions &Opts = InvokRef->Impl.Opts;
 
+    // If the only change is an edit inside one function body, check just
+    // that body again.
+    Optional<FunctionBodyEdit> BodyEdit;
+    if (IsRebuild && CanUsePartialAST)
+      BodyEdit = findFunctionBodyEdit(MgrImpl, Snapshots);
+
     LOG_FUNC_SECTION(InfoHighPrio) {
       Log->getOS() << "AST build (";
       if (IsRebuild)
         Log->getOS() << "rebuild";
       else
         Log->getOS() << "first";
+      if (BodyEdit)
+        Log->getOS() << ", function body";
       Log->getOS() << "): ";
       Log->getOS() << Opts.Invok.getModuleName() << '/' << Opts.PrimaryFile;
     }
 
-    auto NewAST = createASTUnit(MgrImpl, Snapshots, Error);
+    BuildCancelled = false;
+    auto NewAST = createASTUnit(MgrImpl, Snapshots, BodyEdit, Error);
     {
       // FIXME: ThreadSafeRefCntPtr is racy.
       llvm::sys::ScopedLock L(Mtx);
+      BuildSnapshots.clear();
+      // Keep the previous AST if this one was cut short.
+      if (!NewAST && BuildCancelled) {
+        LOG_INFO_FUNC(High, "AST build cancelled: " << Opts.PrimaryFile);
+        Cancelled = true;
+        return nullptr;
+      }
       AST = NewAST;
     }
 
@@ -606,20 +726,56 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
   return AST;
 }
 
-void ASTProducer::enqueueConsumer(SwiftASTConsumerRef Consumer,
+bool ASTProducer::enqueueConsumer(SwiftASTConsumerRef Consumer,
                                   const void *OncePerASTToken) {
   llvm::sys::ScopedLock L(Mtx);
+  bool Superseded = false;
   if (OncePerASTToken) {
     for (auto I = QueuedConsumers.begin(),
               E = QueuedConsumers.end(); I != E; ++I) {
       if (I->second == OncePerASTToken) {
         I->first->cancelled();
         QueuedConsumers.erase(I);
+        Superseded = true;
         break;
       }
     }
   }
   QueuedConsumers.push_back({ std::move(Consumer), OncePerASTToken });
+  return Superseded;
+}
+
+bool ASTProducer::hasQueuedConsumers() {
+  llvm::sys::ScopedLock L(Mtx);
+  return !QueuedConsumers.empty();
+}
+
+void ASTProducer::cancelStaleBuild(SwiftASTManager::Implementation &MgrImpl) {
+  SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
+  {
+    llvm::sys::ScopedLock L(Mtx);
+    Snapshots = BuildSnapshots;
+  }
+
+  for (auto &Snap : Snapshots) {
+    auto EditorDoc = MgrImpl.EditorDocs.findByPath(Snap->getFilename());
+    if (EditorDoc && EditorDoc->getLatestSnapshot()->getStamp() !=
+                         Snap->getStamp()) {
+      BuildCancelled = true;
+      return;
+    }
+  }
+}
+
+bool ASTProducer::queuedConsumersCanUsePartialAST() {
+  llvm::sys::ScopedLock L(Mtx);
+  if (QueuedConsumers.empty())
+    return false;
+  for (auto &C : QueuedConsumers) {
+    if (!C.first->canUsePartialAST())
+      return false;
+  }
+  return true;
 }
 
 std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
@@ -632,6 +788,16 @@ std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
   return Consumers;
 }
 
+static BufferStamp getInputStamp(SwiftASTManager::Implementation &MgrImpl,
+                                 ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                                 StringRef File) {
+  for (auto &Snap : Snapshots) {
+    if (Snap->getFilename() == File)
+      return Snap->getStamp();
+  }
+  return MgrImpl.getBufferStamp(File);
+}
+
 bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
                                 ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
   const SwiftInvocation::Implementation &Invok = InvokRef->Impl;
@@ -639,18 +805,8 @@ bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
   // Check if the inputs changed.
   SmallVector<BufferStamp, 8> InputStamps;
   InputStamps.reserve(Invok.Opts.Invok.getInputFilenames().size());
-  for (auto &File : Invok.Opts.Invok.getInputFilenames()) {
-    bool FoundSnapshot = false;
-    for (auto &Snap : Snapshots) {
-      if (Snap->getFilename() == File) {
-        FoundSnapshot = true;
-        InputStamps.push_back(Snap->getStamp());
-        break;
-      }
-    }
-    if (!FoundSnapshot)
-      InputStamps.push_back(MgrImpl.getBufferStamp(File));
-  }
+  for (auto &File : Invok.Opts.Invok.getInputFilenames())
+    InputStamps.push_back(getInputStamp(MgrImpl, Snapshots, File));
   assert(InputStamps.size() == Invok.Opts.Invok.getInputFilenames().size());
   if (Stamps != InputStamps)
     return true;
@@ -663,6 +819,150 @@ bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
   return false;
 }
 
+/// Finds the function body in \p Decls, or in the members of types and
+/// extensions among them, that strictly contains the bytes [Begin, End).
+///
+/// \returns the offsets of the body's braces.
+template <typename DeclRange>
+static Optional<std::pair<unsigned, unsigned>>
+findEnclosingFunctionBody(DeclRange Decls, SourceManager &SM, unsigned BufferID,
+                          unsigned Begin, unsigned End) {
+  for (Decl *D : Decls) {
+    if (D->isImplicit())
+      continue;
+
+    Optional<std::pair<unsigned, unsigned>> Found;
+    if (auto *AFD = dyn_cast<AbstractFunctionDecl>(D)) {
+      SourceRange BodyRange = AFD->getBodySourceRange();
+      if (BodyRange.isInvalid())
+        continue;
+      unsigned LBrace = SM.getLocOffsetInBuffer(BodyRange.Start, BufferID);
+      unsigned RBrace = SM.getLocOffsetInBuffer(BodyRange.End, BufferID);
+      if (LBrace < Begin && End <= RBrace)
+        Found = std::make_pair(LBrace, RBrace);
+    } else if (auto *NTD = dyn_cast<NominalTypeDecl>(D)) {
+      Found = findEnclosingFunctionBody(NTD->getMembers(), SM, BufferID,
+                                        Begin, End);
+    } else if (auto *ED = dyn_cast<ExtensionDecl>(D)) {
+      Found = findEnclosingFunctionBody(ED->getMembers(), SM, BufferID,
+                                        Begin, End);
+    }
+    if (Found)
+      return Found;
+  }
+  return None;
+}
+
+/// Collects the byte ranges of the function bodies in \p Decls, or in the
+/// members of types and extensions among them, that were not parsed.
+template <typename DeclRange>
+static void
+collectUnparsedBodyRanges(DeclRange Decls, SourceManager &SM, unsigned BufferID,
+                   SmallVectorImpl<std::pair<unsigned, unsigned>> &Ranges) {
+  for (Decl *D : Decls) {
+    if (auto *AFD = dyn_cast<AbstractFunctionDecl>(D)) {
+      if (AFD->getBodyKind() != AbstractFunctionDecl::BodyKind::Unparsed)
+        continue;
+      SourceRange BodyRange = AFD->getBodySourceRange();
+      unsigned LBrace = SM.getLocOffsetInBuffer(BodyRange.Start, BufferID);
+      unsigned RBrace = SM.getLocOffsetInBuffer(BodyRange.End, BufferID);
+      Ranges.push_back({ LBrace, RBrace - LBrace + 1 });
+    } else if (auto *NTD = dyn_cast<NominalTypeDecl>(D)) {
+      collectUnparsedBodyRanges(NTD->getMembers(), SM, BufferID, Ranges);
+    } else if (auto *ED = dyn_cast<ExtensionDecl>(D)) {
+      collectUnparsedBodyRanges(ED->getMembers(), SM, BufferID, Ranges);
+    }
+  }
+}
+
+Optional<FunctionBodyEdit>
+ASTProducer::findFunctionBodyEdit(SwiftASTManager::Implementation &MgrImpl,
+                                  ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
+  const InvocationOptions &Opts = InvokRef->Impl.Opts;
+  StringRef PrimaryFile = Opts.PrimaryFile;
+
+  // Everything but the primary file must be unchanged.
+  for (auto &Dependency : DependencyStamps) {
+    if (Dependency.second != MgrImpl.getBufferStamp(Dependency.first))
+      return None;
+  }
+  auto InputFiles = Opts.Invok.getInputFilenames();
+  assert(InputFiles.size() == Stamps.size());
+  for (unsigned i : indices(InputFiles)) {
+    if (InputFiles[i] == PrimaryFile)
+      continue;
+    if (Stamps[i] != getInputStamp(MgrImpl, Snapshots, InputFiles[i]))
+      return None;
+  }
+
+  ImmutableTextSnapshotRef OldSnap;
+  for (auto &Snap : AST->getSnapshots()) {
+    if (Snap->getFilename() == PrimaryFile) {
+      OldSnap = Snap;
+      break;
+    }
+  }
+  ImmutableTextSnapshotRef NewSnap;
+  for (auto &Snap : Snapshots) {
+    if (Snap->getFilename() == PrimaryFile) {
+      NewSnap = Snap;
+      break;
+    }
+  }
+  if (!NewSnap) {
+    if (auto EditorDoc = MgrImpl.EditorDocs.findByPath(PrimaryFile))
+      NewSnap = EditorDoc->getLatestSnapshot();
+  }
+  if (!OldSnap || !NewSnap || !OldSnap->isFromSameBuffer(NewSnap) ||
+      !OldSnap->precedesOrSame(NewSnap))
+    return None;
+
+  // Compute the smallest range of the new text that covers every edit, and
+  // by how much the edits changed the length of the text.
+  bool HasEdit = false;
+  unsigned Begin = 0, End = 0;
+  int Delta = 0;
+  OldSnap->foreachReplaceUntil(NewSnap,
+    [&](ReplaceImmutableTextUpdateRef Upd) -> bool {
+      unsigned Offset = Upd->getByteOffset();
+      unsigned RemoveEnd = Offset + Upd->getLength();
+      unsigned InsertEnd = Offset + Upd->getText().size();
+      int UpdDelta = int(Upd->getText().size()) - int(Upd->getLength());
+      if (HasEdit) {
+        // Move the range covered so far to where it is after this update.
+        if (Begin >= RemoveEnd)
+          Begin += UpdDelta;
+        if (End > RemoveEnd)
+          End += UpdDelta;
+        else if (End > Offset)
+          End = InsertEnd;
+      } else {
+        Begin = Offset;
+        End = InsertEnd;
+        HasEdit = true;
+      }
+      Begin = std::min(Begin, Offset);
+      End = std::max(End, InsertEnd);
+      Delta += UpdDelta;
+      return true;
+    });
+  if (!HasEdit)
+    return None;
+
+  // The text before Begin is unchanged, so it can be used to find the body
+  // in the previous AST.
+  SourceFile &SF = AST->getPrimarySourceFile();
+  if (!SF.getBufferID().hasValue())
+    return None;
+  auto Body = findEnclosingFunctionBody(
+    llvm::makeArrayRef(SF.Decls), AST->getCompilerInstance().getSourceMgr(),
+    SF.getBufferID().getValue(), Begin, End - Delta);
+  if (!Body)
+    return None;
+
+  return FunctionBodyEdit{ NewSnap, Begin, Body->first, Body->second + Delta };
+}
+
 static void collectModuleDependencies(Module *TopMod,
     llvm::SmallPtrSetImpl<Module *> &Visited,
     SmallVectorImpl<std::string> &Filenames) {
@@ -716,6 +1016,7 @@ static std::atomic<uint64_t> ASTUnitGeneration{ 0 };
 
 ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                                       ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                                      Optional<FunctionBodyEdit> BodyEdit,
                                       std::string &Error) {
   Stamps.clear();
   DependencyStamps.clear();
@@ -748,6 +1049,15 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   for (auto &Content : Contents)
     Stamps.push_back(Content.Stamp);
 
+  // The edit is only meaningful for the text it was computed against.
+  if (BodyEdit) {
+    auto Inputs = Opts.Invok.getInputFilenames();
+    auto PrimaryIt = std::find(Inputs.begin(), Inputs.end(), Opts.PrimaryFile);
+    if (PrimaryIt == Inputs.end() ||
+        Contents[PrimaryIt - Inputs.begin()].Snapshot != BodyEdit->Snapshot)
+      BodyEdit = None;
+  }
+
   trace::SwiftInvocation TraceInfo;
 
   if (trace::enabled()) {
@@ -766,6 +1076,12 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
 
     }
   }
+  {
+    llvm::sys::ScopedLock L(Mtx);
+    BuildSnapshots.assign(ASTRef->Impl.Snapshots.begin(),
+                          ASTRef->Impl.Snapshots.end());
+  }
+
   auto &CompIns = ASTRef->Impl.CompInst;
   auto &Consumer = ASTRef->Impl.CollectDiagConsumer;
 
@@ -790,10 +1106,48 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
     TracedOp.start(trace::OperationKind::PerformSema, TraceInfo);
   }
 
+  // Only parse and type-check the body that was edited; the other bodies
+  // are left unparsed.
+  Optional<FocusedFunctionBodyCallbacks> FocusCallbacks;
+  Optional<unsigned> PrimaryBufferID;
+  if (BodyEdit) {
+    PrimaryBufferID =
+      CompIns.getSourceMgr().getIDForBufferIdentifier(Opts.PrimaryFile);
+    if (PrimaryBufferID) {
+      FocusCallbacks.emplace(CompIns.getSourceMgr().getLocForOffset(
+          *PrimaryBufferID, BodyEdit->EditOffset));
+      CompIns.setPrimaryDelayedParsingCallbacks(FocusCallbacks.getPointer());
+    }
+  }
+
   CloseClangModuleFiles scopedCloseFiles(
       *CompIns.getASTContext().getClangModuleLoader());
   Consumer.setInputBufferIDs(ASTRef->getCompilerInstance().getInputBufferIDs());
+  CompIns.getASTContext().CancellationFlag = &BuildCancelled;
   CompIns.performSema();
+  // Consumers may still type-check parts of the AST lazily.
+  CompIns.getASTContext().CancellationFlag = nullptr;
+  if (BuildCancelled)
+    return nullptr;
+
+  if (FocusCallbacks) {
+    // The edit may have moved the braces of the body, e.g. if it added a
+    // closing brace; in that case the rest of the file has to be checked too.
+    SourceFile *SF = CompIns.getPrimarySourceFile();
+    auto &SM = CompIns.getSourceMgr();
+    auto Body = SF ? findEnclosingFunctionBody(llvm::makeArrayRef(SF->Decls),
+                                               SM, *PrimaryBufferID,
+                                               BodyEdit->EditOffset,
+                                               BodyEdit->EditOffset)
+                   : None;
+    if (!Body || Body->first != BodyEdit->LBraceOffset ||
+        Body->second != BodyEdit->RBraceOffset) {
+      LOG_INFO_FUNC(Low, "edit escaped its function body; checking whole file");
+      return createASTUnit(MgrImpl, Snapshots, None, Error);
+    }
+    collectUnparsedBodyRanges(llvm::makeArrayRef(SF->Decls), SM,
+                              *PrimaryBufferID, ASTRef->Impl.SkippedBodyRanges);
+  }
 
   llvm::SmallPtrSet<Module *, 16> Visited;
   SmallVector<std::string, 8> Filenames;
@@ -807,7 +1161,9 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
 
   // Since we only typecheck the primary file (plus referenced constructs
   // from other files), any error is likely to break SIL generation.
-  if (!Consumer.hadAnyError()) {
+  // Bodies that were not parsed can't be SILGen'd, so a partial AST gets no
+  // SIL diagnostics.
+  if (!Consumer.hadAnyError() && !ASTRef->isPartial()) {
     // FIXME: Any error anywhere in the SourceFile will switch off SIL
     // diagnostics. This means that this can happen:
     //   - The user sees a SIL diagnostic in one function
@@ -55,6 +55,12 @@ public:
   ArrayRef<ImmutableTextSnapshotRef> getSnapshots() const;
   EditorDiagConsumer &getEditorDiagConsumer() const;
   swift::SourceFile &getPrimarySourceFile() const;
+
+  /// The byte ranges (offset and length) of the function bodies in the
+  /// primary file that were left unparsed, because only an edited function
+  /// body was checked again. Empty if the whole file was checked.
+  ArrayRef<std::pair<unsigned, unsigned>> getSkippedBodyRanges() const;
+  bool isPartial() const { return !getSkippedBodyRanges().empty(); }
 };
 
 typedef IntrusiveRefCntPtr<ASTUnit> ASTUnitRef;
@@ -72,6 +78,12 @@ public:
       ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
     return false;
   }
+  /// Whether the consumer can handle a partial AST, in which only an edited
+  /// function body of the primary file was checked again.
+  /// \sa ASTUnit::getSkippedBodyRanges
+  virtual bool canUsePartialAST() {
+    return false;
+  }
   virtual void failed(StringRef Error);
   virtual void handlePrimaryAST(ASTUnitRef AstUnit) = 0;
 };
@@ -646,6 +646,20 @@ ArrayRef<Completion *> CodeCompletion::SessionCache::getSortedCompletions() {
   llvm::sys::ScopedLock L(mtx);
   return sortedCompletions;
 }
+std::vector<Completion *> CodeCompletion::SessionCache::getCompletionsToFilter(
+    StringRef filterText, const Options &options) {
+  llvm::sys::ScopedLock L(mtx);
+  if (CodeCompletionOrganizer::canRefineFilter(lastFilterText, filterText,
+                                               options))
+    return lastFilterMatches;
+  return sortedCompletions;
+}
+void CodeCompletion::SessionCache::setFilterMatches(
+    StringRef filterText, std::vector<Completion *> &&matches) {
+  llvm::sys::ScopedLock L(mtx);
+  lastFilterText = filterText;
+  lastFilterMatches = std::move(matches);
+}
 llvm::MemoryBuffer *CodeCompletion::SessionCache::getBuffer() {
   llvm::sys::ScopedLock L(mtx);
   return buffer.get();
@@ -848,8 +862,13 @@ static void transformAndForwardResults(
       session->getCompletionKind() == CompletionKind::PostfixExpr;
 
   if (!hasEarlyInnerResults) {
-    organizer.addCompletionsWithFilter(session->getSortedCompletions(),
-                                       filterText, exactMatch);
+    // As the user types, each filter text usually extends the previous one,
+    // so only the completions that matched before need to be matched again.
+    auto completions = session->getCompletionsToFilter(filterText, options);
+    std::vector<Completion *> matches;
+    organizer.addCompletionsWithFilter(completions, filterText, exactMatch,
+                                       &matches);
+    session->setFilterMatches(filterText, std::move(matches));
   }
 
   if (hasEarlyInnerResults &&
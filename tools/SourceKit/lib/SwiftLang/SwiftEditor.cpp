@@ -15,6 +15,7 @@
 #include "SwiftLangSupport.h"
 #include "SourceKit/Core/Context.h"
 #include "SourceKit/Core/NotificationCenter.h"
+#include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/ImmutableTextBuffer.h"
 #include "SourceKit/Support/Logging.h"
 #include "SourceKit/Support/Tracing.h"
@@ -37,10 +38,25 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 
+#include <condition_variable>
+#include <mutex>
+
 using namespace SourceKit;
 using namespace swift;
 using namespace ide;
 
+bool EditorDiagConsumer::needsDiagnosticText(SourceLoc Loc,
+                                             DiagnosticKind Kind,
+                                             const DiagnosticInfo &Info) {
+  // Mirror the diagnostics that handleDiagnostic() drops without looking at
+  // their text.
+  if (Info.ID == diag::lex_editor_placeholder.ID || Loc.isInvalid())
+    return false;
+  if (Kind == DiagnosticKind::Note && !haveLastDiag())
+    return false;
+  return true;
+}
+
 void EditorDiagConsumer::handleDiagnostic(SourceManager &SM, SourceLoc Loc,
                                           DiagnosticKind Kind, StringRef Text,
                                           const DiagnosticInfo &Info) {
@@ -461,6 +477,12 @@ public:
 
   uint64_t getASTGeneration() const;
 
+  /// Whether semantic info from some AST has been recorded, which can fill in
+  /// the function bodies that a partial AST did not check.
+  bool hasSemanticInfo() const {
+    return getASTGeneration() != 0;
+  }
+
   void setCompilerArgs(ArrayRef<const char *> Args) {
     InvokRef = ASTMgr.getInvocation(Args, Filename, CompilerArgsError);
   }
@@ -475,7 +497,9 @@ public:
   void updateSemanticInfo(std::vector<SwiftSemanticToken> Toks,
                           std::vector<DiagnosticEntryInfo> Diags,
                           ImmutableTextSnapshotRef Snapshot,
-                          uint64_t ASTGeneration);
+                          uint64_t ASTGeneration,
+                          ArrayRef<std::pair<unsigned, unsigned>>
+                            SkippedBodyRanges = {});
   void removeCachedAST() {
     if (InvokRef)
       ASTMgr.removeCachedAST(InvokRef);
@@ -787,11 +811,41 @@ void SwiftDocumentSemanticInfo::updateSemanticInfo(
     std::vector<SwiftSemanticToken> Toks,
     std::vector<DiagnosticEntryInfo> Diags,
     ImmutableTextSnapshotRef Snapshot,
-    uint64_t ASTGeneration) {
+    uint64_t ASTGeneration,
+    ArrayRef<std::pair<unsigned, unsigned>> SkippedBodyRanges) {
 
   {
     llvm::sys::ScopedLock L(Mtx);
     if(ASTGeneration > this->ASTGeneration) {
+      if (!SkippedBodyRanges.empty()) {
+        // The AST did not check these function bodies, so keep what we knew
+        // about them, adjusted to the new snapshot.
+        auto isInSkippedBody = [&](unsigned Offset) -> bool {
+          for (auto &Range : SkippedBodyRanges) {
+            if (Offset >= Range.first && Offset < Range.first + Range.second)
+              return true;
+          }
+          return false;
+        };
+
+        if (TokSnapshot && TokSnapshot->precedesOrSame(Snapshot)) {
+          for (auto &Tok : takeSemanticTokens(Snapshot)) {
+            if (isInSkippedBody(Tok.ByteOffset))
+              Toks.push_back(Tok);
+          }
+        }
+        std::sort(Toks.begin(), Toks.end(),
+                  [](const SwiftSemanticToken &LHS,
+                     const SwiftSemanticToken &RHS) -> bool {
+                    return LHS.ByteOffset < RHS.ByteOffset;
+                  });
+
+        for (auto &Diag : getSemanticDiagnostics(Snapshot, {})) {
+          if (isInSkippedBody(Diag.Offset))
+            Diags.push_back(Diag);
+        }
+      }
+
       SemaToks = std::move(Toks);
       SemaDiags = std::move(Diags);
       TokSnapshot = DiagSnapshot = std::move(Snapshot);
@@ -865,6 +919,10 @@ public:
     LOG_WARN_FUNC("sema annotations failed: " << Error);
   }
 
+  bool canUsePartialAST() override {
+    return SemaInfoRef->hasSemanticInfo();
+  }
+
   void handlePrimaryAST(ASTUnitRef AstUnit) override {
     auto Generation = AstUnit->getGeneration();
     auto &CompIns = AstUnit->getCompilerInstance();
@@ -925,7 +983,8 @@ public:
       updateSemanticInfo(std::move(SemaToks),
                      std::move(Consumer.getDiagnosticsForBuffer(BufferID)),
                          DocSnapshot,
-                         Generation);
+                         Generation,
+                         AstUnit->getSkippedBodyRanges());
 
     if (DocSnapshot->getStamp() != EditableBuffer->getSnapshot()->getStamp()) {
       // Handle edits that occurred after we processed the AST.
@@ -1297,6 +1356,9 @@ public:
   }
 
   bool walkToNodePre(SyntaxNode Node) override {
+    // Look into comments for their markers.
+    if (Node.isComment())
+      return true;
     if (Node.Kind != SyntaxNodeKind::CommentMarker)
       return false;
 
@@ -1324,30 +1386,39 @@ public:
   }
 };
 
+/// Updates the syntax map for the edited line range and collects the entries
+/// to pass to the consumer.
+///
+/// The walk ends as soon as the new tokens line up with the existing syntax
+/// map again, since the rest of the map only moved with the edit.
 class SwiftEditorSyntaxWalker: public ide::SyntaxModelWalker {
   SwiftSyntaxMap &SyntaxMap;
   SwiftEditorLineRange EditedLineRange;
   SwiftEditorCharRange &AffectedRange;
   SourceManager &SrcManager;
-  EditorConsumer &Consumer;
   unsigned BufferID;
-  SwiftDocumentStructureWalker DocStructureWalker;
   std::vector<EditorConsumerSyntaxMapEntry> ConsumerSyntaxMap;
   unsigned NestingLevel = 0;
+  bool SyncedUp = false;
 public:
   SwiftEditorSyntaxWalker(SwiftSyntaxMap &SyntaxMap,
                           SwiftEditorLineRange EditedLineRange,
                           SwiftEditorCharRange &AffectedRange,
-                          SourceManager &SrcManager, EditorConsumer &Consumer,
-                          unsigned BufferID)
+                          SourceManager &SrcManager, unsigned BufferID)
     : SyntaxMap(SyntaxMap), EditedLineRange(EditedLineRange),
-      AffectedRange(AffectedRange), SrcManager(SrcManager), Consumer(Consumer),
-      BufferID(BufferID),
-      DocStructureWalker(SrcManager, BufferID, Consumer) { }
+      AffectedRange(AffectedRange), SrcManager(SrcManager),
+      BufferID(BufferID) { }
+
+  ArrayRef<EditorConsumerSyntaxMapEntry> getConsumerSyntaxMap() const {
+    return ConsumerSyntaxMap;
+  }
 
   bool walkToNodePre(SyntaxNode Node) override {
+    if (SyncedUp)
+      return false;
+    // Look into comment markers for URLs.
     if (Node.Kind == SyntaxNodeKind::CommentMarker)
-      return DocStructureWalker.walkToNodePre(Node);
+      return true;
 
     ++NestingLevel;
     SourceLoc StartLoc = Node.Range.getStart();
@@ -1390,9 +1461,10 @@ public:
       else if (StartLine > EditedLineRange.endLine()) {
         // We're after the edited line range, let's test if we're synced up.
         if (SyntaxMap.matchesFirstTokenOnLine(StartLine, Token)) {
-          // We're synced up, mark the affected range and return.
+          // We're synced up, mark the affected range and stop.
           AffectedRange.second =
                  Offset - (StartLineAndColumn.second - 1) - AffectedRange.first;
+          SyncedUp = true;
           return true;
         }
 
@@ -1444,28 +1516,14 @@ public:
   }
 
   bool walkToNodePost(SyntaxNode Node) override {
+    if (SyncedUp)
+      return false;
     if (Node.Kind == SyntaxNodeKind::CommentMarker)
-      return DocStructureWalker.walkToNodePost(Node);
-
-    if (--NestingLevel == 0) {
-      // We've unwound to the top level, so inform the consumer and drain
-      // the consumer syntax map queue.
-      for (auto &Entry: ConsumerSyntaxMap)
-        Consumer.handleSyntaxMap(Entry.Offset, Entry.Length, Entry.Kind);
-      ConsumerSyntaxMap.clear();
-    }
+      return true;
 
+    --NestingLevel;
     return true;
   }
-
-  bool walkToSubStructurePre(SyntaxStructureNode Node) override {
-    return DocStructureWalker.walkToSubStructurePre(Node);
-  }
-
-  bool walkToSubStructurePost(SyntaxStructureNode Node) override {
-    return DocStructureWalker.walkToSubStructurePost(Node);
-  }
-
 };
 
 typedef llvm::SmallString<64> StringBuilder;
@@ -2484,14 +2542,36 @@ void SwiftEditorDocument::readSyntaxInfo(EditorConsumer &Consumer) {
 
   ide::SyntaxModelContext ModelContext(Impl.SyntaxInfo->getSourceFile());
 
+  SourceManager &SrcManager = Impl.SyntaxInfo->getSourceManager();
+  unsigned BufferID = Impl.SyntaxInfo->getBufferID();
   SwiftEditorSyntaxWalker SyntaxWalker(Impl.SyntaxMap,
                                        Impl.EditedLineRange,
                                        Impl.AffectedRange,
-                                       Impl.SyntaxInfo->getSourceManager(),
-                                       Consumer,
-                                       Impl.SyntaxInfo->getBufferID());
+                                       SrcManager, BufferID);
+  SwiftDocumentStructureWalker StructureWalker(SrcManager, BufferID, Consumer);
+
+  // Update the syntax map concurrently while the document structure is
+  // reported from this thread. Both walks only read the parsed AST, and only
+  // this thread talks to the consumer.
+  std::mutex SyntaxMtx;
+  std::condition_variable SyntaxCV;
+  bool SyntaxDone = false;
+  WorkQueue::dispatchConcurrent([&] {
+    ModelContext.walk(SyntaxWalker);
+    std::lock_guard<std::mutex> Guard(SyntaxMtx);
+    SyntaxDone = true;
+    SyntaxCV.notify_one();
+  }, WorkQueue::Priority::Default, /*isStackDeep=*/true);
+
+  ModelContext.walk(StructureWalker);
+
+  {
+    std::unique_lock<std::mutex> Lock(SyntaxMtx);
+    SyntaxCV.wait(Lock, [&] { return SyntaxDone; });
+  }
 
-  ModelContext.walk(SyntaxWalker);
+  for (auto &Entry : SyntaxWalker.getConsumerSyntaxMap())
+    Consumer.handleSyntaxMap(Entry.Offset, Entry.Length, Entry.Kind);
 
   Consumer.recordAffectedRange(Impl.AffectedRange.first,
                                Impl.AffectedRange.second);
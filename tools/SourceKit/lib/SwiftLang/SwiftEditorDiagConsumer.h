@@ -66,6 +66,9 @@ public:
 
   bool hadAnyError() const { return HadAnyError; }
 
+  bool needsDiagnosticText(swift::SourceLoc Loc, swift::DiagnosticKind Kind,
+                           const swift::DiagnosticInfo &Info) override;
+
   void handleDiagnostic(swift::SourceManager &SM, swift::SourceLoc Loc,
                         swift::DiagnosticKind Kind, StringRef Text,
                         const swift::DiagnosticInfo &Info) override;
@@ -23,6 +23,7 @@
 #include "swift/IDE/Utils.h"
 #include "swift/Strings.h"
 
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ConvertUTF.h"
 
@@ -69,7 +70,6 @@ public:
 
   // Hold an AstUnit so that the Decl* we have are always valid.
   ASTUnitRef AstUnit;
-  std::string DocumentName;
   bool IsModule = false;
   std::string ModuleOrHeaderName;
   CompilerInvocation Invocation;
@@ -79,6 +79,9 @@ public:
   SourceTextInfo Info;
   // This is the non-typechecked AST for the generated interface source.
   CompilerInstance TextCI;
+  // The files the module was loaded from, with their modification times when
+  // the interface was generated.
+  std::vector<std::pair<std::string, llvm::sys::TimeValue>> ModuleFiles;
 };
 
 typedef SwiftInterfaceGenContext::Implementation::TextRange TextRange;
@@ -290,6 +293,19 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx,
                           Printer, Options);
 
   Info.Text = OS.str();
+
+  // Remember what the interface was generated from, so that it is only
+  // reused while the module is unchanged.
+  for (auto *File : Mod->getFiles()) {
+    auto *Loaded = dyn_cast<LoadedFile>(File);
+    if (!Loaded)
+      continue;
+    StringRef Filename = Loaded->getFilename();
+    llvm::sys::fs::file_status Status;
+    if (Filename.empty() || llvm::sys::fs::status(Filename, Status))
+      continue;
+    Impl.ModuleFiles.emplace_back(Filename, Status.getLastModificationTime());
+  }
   return false;
 }
 
@@ -319,18 +335,18 @@ SwiftInterfaceGenContext::createForSwiftSource(StringRef DocumentName,
                                                ASTUnitRef AstUnit,
                                                std::string &ErrMsg) {
   SwiftInterfaceGenContextRef IFaceGenCtx{ new SwiftInterfaceGenContext() };
-  IFaceGenCtx->Impl.DocumentName = DocumentName;
-  IFaceGenCtx->Impl.IsModule = true;
-  IFaceGenCtx->Impl.ModuleOrHeaderName = SourceFileName;
-  IFaceGenCtx->Impl.AstUnit = AstUnit;
+  IFaceGenCtx->DocumentName = DocumentName;
+  IFaceGenCtx->Impl->IsModule = true;
+  IFaceGenCtx->Impl->ModuleOrHeaderName = SourceFileName;
+  IFaceGenCtx->Impl->AstUnit = AstUnit;
 
   PrintOptions Options = PrintOptions::printSwiftFileInterface();
   SmallString<128> Text;
   llvm::raw_svector_ostream OS(Text);
-  AnnotatingPrinter Printer(IFaceGenCtx->Impl.Info, OS);
+  AnnotatingPrinter Printer(IFaceGenCtx->Impl->Info, OS);
   printSwiftSourceInterface(AstUnit->getPrimarySourceFile(), Printer, Options);
-  IFaceGenCtx->Impl.Info.Text = OS.str();
-  if (makeParserAST(IFaceGenCtx->Impl.TextCI, IFaceGenCtx->Impl.Info.Text)) {
+  IFaceGenCtx->Impl->Info.Text = OS.str();
+  if (makeParserAST(IFaceGenCtx->Impl->TextCI, IFaceGenCtx->Impl->Info.Text)) {
     ErrMsg = "Error during syntactic parsing";
     return nullptr;
   }
@@ -344,14 +360,14 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
                                  CompilerInvocation Invocation,
                                  std::string &ErrMsg) {
   SwiftInterfaceGenContextRef IFaceGenCtx{ new SwiftInterfaceGenContext() };
-  IFaceGenCtx->Impl.DocumentName = DocumentName;
-  IFaceGenCtx->Impl.IsModule = IsModule;
-  IFaceGenCtx->Impl.ModuleOrHeaderName = ModuleOrHeaderName;
-  IFaceGenCtx->Impl.Invocation = Invocation;
-  CompilerInstance &CI = IFaceGenCtx->Impl.Instance;
+  IFaceGenCtx->DocumentName = DocumentName;
+  IFaceGenCtx->Impl->IsModule = IsModule;
+  IFaceGenCtx->Impl->ModuleOrHeaderName = ModuleOrHeaderName;
+  IFaceGenCtx->Impl->Invocation = Invocation;
+  CompilerInstance &CI = IFaceGenCtx->Impl->Instance;
 
   // Display diagnostics to stderr.
-  CI.addDiagnosticConsumer(&IFaceGenCtx->Impl.DiagConsumer);
+  CI.addDiagnosticConsumer(&IFaceGenCtx->Impl->DiagConsumer);
 
   Invocation.clearInputs();
   if (CI.setup(Invocation)) {
@@ -370,7 +386,7 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
   }
 
   if (IsModule) {
-    if (getModuleInterfaceInfo(Ctx, ModuleOrHeaderName, IFaceGenCtx->Impl,
+    if (getModuleInterfaceInfo(Ctx, ModuleOrHeaderName, *IFaceGenCtx->Impl,
                                ErrMsg))
       return nullptr;
   } else {
@@ -386,11 +402,11 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
                                   /*diagLoc=*/{},
                                   /*trackParsedSymbols=*/true);
     if (getHeaderInterfaceInfo(Ctx, ModuleOrHeaderName,
-                               IFaceGenCtx->Impl.Info, ErrMsg))
+                               IFaceGenCtx->Impl->Info, ErrMsg))
       return nullptr;
   }
 
-  if (makeParserAST(IFaceGenCtx->Impl.TextCI, IFaceGenCtx->Impl.Info.Text)) {
+  if (makeParserAST(IFaceGenCtx->Impl->TextCI, IFaceGenCtx->Impl->Info.Text)) {
     ErrMsg = "Error during syntactic parsing";
     return nullptr;
   }
@@ -398,63 +414,90 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
   return IFaceGenCtx;
 }
 
+SwiftInterfaceGenContextRef
+SwiftInterfaceGenContext::createSharing(StringRef DocumentName,
+                                        SwiftInterfaceGenContextRef Existing) {
+  SwiftInterfaceGenContextRef IFaceGenCtx{
+    new SwiftInterfaceGenContext(Existing->Impl) };
+  IFaceGenCtx->DocumentName = DocumentName;
+  return IFaceGenCtx;
+}
+
 SwiftInterfaceGenContext::SwiftInterfaceGenContext()
-  : Impl(*new Implementation) {
+  : Impl(std::make_shared<Implementation>()) {
+}
+SwiftInterfaceGenContext::SwiftInterfaceGenContext(
+    std::shared_ptr<Implementation> Impl)
+  : Impl(std::move(Impl)) {
 }
 SwiftInterfaceGenContext::~SwiftInterfaceGenContext() {
-  delete &Impl;
 }
 
 StringRef SwiftInterfaceGenContext::getDocumentName() const {
-  return Impl.DocumentName;
+  return DocumentName;
 }
 
 StringRef SwiftInterfaceGenContext::getModuleOrHeaderName() const {
-  return Impl.ModuleOrHeaderName;
+  return Impl->ModuleOrHeaderName;
 }
 
 bool SwiftInterfaceGenContext::isModule() const {
-  return Impl.IsModule;
+  return Impl->IsModule;
 }
 
 bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
                                        const swift::CompilerInvocation &Invok) {
-  if (!Impl.IsModule)
+  if (!Impl->IsModule)
     return false;
-  if (ModuleName != Impl.ModuleOrHeaderName)
+  if (ModuleName != Impl->ModuleOrHeaderName)
     return false;
 
-  if (Invok.getTargetTriple() != Impl.Invocation.getTargetTriple())
+  if (Invok.getTargetTriple() != Impl->Invocation.getTargetTriple())
     return false;
 
   if (ModuleName == STDLIB_NAME)
     return true;
 
-  if (Invok.getSDKPath() != Impl.Invocation.getSDKPath())
+  if (Invok.getSDKPath() != Impl->Invocation.getSDKPath())
     return false;
 
-  if (Impl.Mod->isSystemModule())
+  if (Impl->Mod->isSystemModule())
     return true;
 
   const SearchPathOptions &SPOpts = Invok.getSearchPathOptions();
-  const SearchPathOptions &ImplSPOpts = Impl.Invocation.getSearchPathOptions();
+  const SearchPathOptions &ImplSPOpts = Impl->Invocation.getSearchPathOptions();
   if (SPOpts.ImportSearchPaths != ImplSPOpts.ImportSearchPaths)
     return false;
   if (SPOpts.FrameworkSearchPaths != ImplSPOpts.FrameworkSearchPaths)
     return false;
 
   if (Invok.getClangImporterOptions().ExtraArgs !=
-      Impl.Invocation.getClangImporterOptions().ExtraArgs)
+      Impl->Invocation.getClangImporterOptions().ExtraArgs)
     return false;
 
   return true;
 }
 
+bool SwiftInterfaceGenContext::isUpToDate() const {
+  // Only interfaces printed from a loaded module can be shared.
+  if (!Impl->Mod || Impl->ModuleFiles.empty())
+    return false;
+
+  for (auto &File : Impl->ModuleFiles) {
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(File.first, Status))
+      return false;
+    if (Status.getLastModificationTime() != File.second)
+      return false;
+  }
+  return true;
+}
+
 void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const {
-  Consumer.handleSourceText(Impl.Info.Text);
-  reportSyntacticAnnotations(Impl.TextCI, Consumer);
-  reportDocumentStructure(Impl.TextCI, Consumer);
-  reportSemanticAnnotations(Impl.Info, Consumer);
+  Consumer.handleSourceText(Impl->Info.Text);
+  reportSyntacticAnnotations(Impl->TextCI, Consumer);
+  reportDocumentStructure(Impl->TextCI, Consumer);
+  reportSemanticAnnotations(Impl->Info, Consumer);
   Consumer.finished();
 }
 
@@ -462,13 +505,13 @@ SwiftInterfaceGenContext::ResolvedEntity
 SwiftInterfaceGenContext::resolveEntityForOffset(unsigned Offset) const {
   // Search among the references.
   {
-    auto Pos = std::upper_bound(Impl.Info.References.begin(),
-                                Impl.Info.References.end(),
+    auto Pos = std::upper_bound(Impl->Info.References.begin(),
+                                Impl->Info.References.end(),
                                 Offset,
       [&](unsigned Offset, const TextReference &RHS) -> bool {
         return Offset < RHS.Range.Offset+RHS.Range.Length;
       });
-    if (Pos != Impl.Info.References.end() && Pos->Range.Offset <= Offset) {
+    if (Pos != Impl->Info.References.end() && Pos->Range.Offset <= Offset) {
       if (Pos->Mod)
         return ResolvedEntity(Pos->Mod, true);
       else
@@ -476,21 +519,21 @@ SwiftInterfaceGenContext::resolveEntityForOffset(unsigned Offset) const {
     }
   }
 
-  SourceManager &SM = Impl.TextCI.getSourceMgr();
-  auto SF = dyn_cast<SourceFile>(Impl.TextCI.getMainModule()->getFiles()[0]);
+  SourceManager &SM = Impl->TextCI.getSourceMgr();
+  auto SF = dyn_cast<SourceFile>(Impl->TextCI.getMainModule()->getFiles()[0]);
   unsigned BufferID = *SF->getBufferID();
   SourceLoc Loc = Lexer::getLocForStartOfToken(SM, BufferID, Offset);
   Offset = SM.getLocOffsetInBuffer(Loc, BufferID);
 
   // Search among the declarations.
   {
-    auto Pos = std::lower_bound(Impl.Info.Decls.begin(),
-                                Impl.Info.Decls.end(),
+    auto Pos = std::lower_bound(Impl->Info.Decls.begin(),
+                                Impl->Info.Decls.end(),
                                 Offset,
       [&](const TextDecl &LHS, unsigned Offset) -> bool {
         return LHS.Range.Offset < Offset;
       });
-    if (Pos != Impl.Info.Decls.end() && Pos->Range.Offset == Offset)
+    if (Pos != Impl->Info.Decls.end() && Pos->Range.Offset == Offset)
       return ResolvedEntity(dyn_cast<ValueDecl>(Pos->Dcl), false);
   }
 
@@ -499,8 +542,8 @@ SwiftInterfaceGenContext::resolveEntityForOffset(unsigned Offset) const {
 
 llvm::Optional<std::pair<unsigned, unsigned>>
 SwiftInterfaceGenContext::findUSRRange(StringRef USR) const {
-  auto Pos = Impl.Info.USRMap.find(USR);
-  if (Pos == Impl.Info.USRMap.end())
+  auto Pos = Impl->Info.USRMap.find(USR);
+  if (Pos == Impl->Info.USRMap.end())
     return None;
 
   return std::make_pair(Pos->getValue().Range.Offset,
@@ -509,7 +552,7 @@ SwiftInterfaceGenContext::findUSRRange(StringRef USR) const {
 
 void SwiftInterfaceGenContext::applyTo(
     swift::CompilerInvocation &CompInvok) const {
-  CompInvok = Impl.Invocation;
+  CompInvok = Impl->Invocation;
 }
 
 SwiftInterfaceGenContextRef SwiftInterfaceGenMap::get(StringRef Name) const {
@@ -528,7 +571,19 @@ void SwiftInterfaceGenMap::set(StringRef Name,
 
 bool SwiftInterfaceGenMap::remove(StringRef Name) {
   llvm::sys::ScopedLock L(Mtx);
-  return IFaceGens.erase(Name);
+  auto It = IFaceGens.find(Name);
+  if (It == IFaceGens.end())
+    return false;
+
+  // Keep the most recently closed module interfaces around, since the same
+  // modules tend to be opened again.
+  if (It->getValue()->isUpToDate()) {
+    RecentlyClosed.push_back(It->getValue());
+    if (RecentlyClosed.size() > MaxRecentlyClosed)
+      RecentlyClosed.erase(RecentlyClosed.begin());
+  }
+  IFaceGens.erase(It);
+  return true;
 }
 
 SwiftInterfaceGenContextRef
@@ -542,6 +597,23 @@ SwiftInterfaceGenMap::find(StringRef ModuleName,
   return nullptr;
 }
 
+SwiftInterfaceGenContextRef
+SwiftInterfaceGenMap::findReusable(StringRef ModuleName,
+                                   const CompilerInvocation &Invok) {
+  llvm::sys::ScopedLock L(Mtx);
+  for (auto &Entry : IFaceGens) {
+    if (Entry.getValue()->isUpToDate() &&
+        Entry.getValue()->matches(ModuleName, Invok))
+      return Entry.getValue();
+  }
+  for (auto It = RecentlyClosed.rbegin(), E = RecentlyClosed.rend(); It != E;
+       ++It) {
+    if ((*It)->isUpToDate() && (*It)->matches(ModuleName, Invok))
+      return *It;
+  }
+  return nullptr;
+}
+
 //============================================================================//
 // EditorOpenInterface
 //============================================================================//
@@ -576,6 +648,15 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
 
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
+  // Printing the interface of a big module takes a while, so reuse the one
+  // generated for another document if the module has not changed since.
+  if (auto Existing = IFaceGenContexts.findReusable(ModuleName, Invocation)) {
+    auto IFaceGenRef = SwiftInterfaceGenContext::createSharing(Name, Existing);
+    IFaceGenContexts.set(Name, IFaceGenRef);
+    IFaceGenRef->reportEditorInfo(Consumer);
+    return;
+  }
+
   std::string ErrMsg;
   auto IFaceGenRef = SwiftInterfaceGenContext::create(Name,
                                                       /*IsModule=*/true,
@@ -26,6 +26,8 @@
 
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -38,6 +40,357 @@ static UIdent KindImportModuleClang("source.lang.swift.import.module.clang");
 static UIdent KindImportModuleSwift("source.lang.swift.import.module.swift");
 static UIdent KindImportSourceFile("source.lang.swift.import.sourcefile");
 
+//============================================================================//
+// On-disk index store
+//============================================================================//
+
+/// Bump this when the format of the records changes.
+static const uint32_t IndexStoreVersion = 1;
+
+namespace {
+enum class IndexRecordTag : uint8_t {
+  StartEntity,
+  RelatedEntity,
+  FinishEntity,
+};
+} // anonymous namespace
+
+static void writeRecordString(llvm::raw_ostream &OS, StringRef Str) {
+  llvm::support::endian::Writer<llvm::support::little> LE(OS);
+  LE.write(static_cast<uint32_t>(Str.size()));
+  OS << Str;
+}
+
+static void writeRecordEntity(llvm::raw_ostream &OS, IndexRecordTag Tag,
+                              const EntityInfo &Info) {
+  llvm::support::endian::Writer<llvm::support::little> LE(OS);
+  LE.write(static_cast<uint8_t>(Tag));
+  LE.write(static_cast<uint8_t>(Info.EntityType));
+  writeRecordString(OS, Info.Kind.getName());
+  writeRecordString(OS, Info.Name);
+  writeRecordString(OS, Info.USR);
+  LE.write(static_cast<uint32_t>(Info.Line));
+  LE.write(static_cast<uint32_t>(Info.Column));
+
+  switch (Info.EntityType) {
+  case EntityInfo::Base:
+    break;
+  case EntityInfo::FuncDecl:
+    LE.write(static_cast<uint8_t>(
+        static_cast<const FuncDeclEntityInfo &>(Info).IsTestCandidate));
+    break;
+  case EntityInfo::CallReference: {
+    auto &CallInfo = static_cast<const CallRefEntityInfo &>(Info);
+    writeRecordString(OS, CallInfo.ReceiverUSR);
+    LE.write(static_cast<uint8_t>(CallInfo.IsDynamic));
+    break;
+  }
+  }
+}
+
+namespace {
+/// Reads the entities of a record written by IndexStoreRecorder.
+class IndexRecordReader {
+  const char *Cursor;
+  const char *End;
+
+public:
+  explicit IndexRecordReader(StringRef Data)
+    : Cursor(Data.begin()), End(Data.end()) { }
+
+  bool atEnd() const { return Cursor == End; }
+
+  bool read8(uint8_t &Value) {
+    if (End - Cursor < 1)
+      return false;
+    Value = static_cast<uint8_t>(*Cursor++);
+    return true;
+  }
+
+  bool read32(uint32_t &Value) {
+    if (End - Cursor < 4)
+      return false;
+    Value = llvm::support::endian::read32le(Cursor);
+    Cursor += 4;
+    return true;
+  }
+
+  bool read64(uint64_t &Value) {
+    if (End - Cursor < 8)
+      return false;
+    Value = llvm::support::endian::read64le(Cursor);
+    Cursor += 8;
+    return true;
+  }
+
+  bool readString(StringRef &Str) {
+    uint32_t Size;
+    if (!read32(Size) || uint32_t(End - Cursor) < Size)
+      return false;
+    Str = StringRef(Cursor, Size);
+    Cursor += Size;
+    return true;
+  }
+};
+} // anonymous namespace
+
+/// Reads one entity following its tag, into \p Info.
+static bool readRecordEntity(IndexRecordReader &Reader, EntityInfo &Info) {
+  StringRef Kind, Name, USR;
+  uint32_t Line, Column;
+  if (!Reader.readString(Kind) || !Reader.readString(Name) ||
+      !Reader.readString(USR) || !Reader.read32(Line) ||
+      !Reader.read32(Column))
+    return false;
+  Info.Kind = UIdent(Kind);
+  Info.Name = Name;
+  Info.USR = USR;
+  Info.Line = Line;
+  Info.Column = Column;
+
+  uint8_t Flag;
+  switch (Info.EntityType) {
+  case EntityInfo::Base:
+    return true;
+  case EntityInfo::FuncDecl:
+    if (!Reader.read8(Flag))
+      return false;
+    static_cast<FuncDeclEntityInfo &>(Info).IsTestCandidate = Flag;
+    return true;
+  case EntityInfo::CallReference: {
+    auto &CallInfo = static_cast<CallRefEntityInfo &>(Info);
+    StringRef ReceiverUSR;
+    if (!Reader.readString(ReceiverUSR) || !Reader.read8(Flag))
+      return false;
+    CallInfo.ReceiverUSR = ReceiverUSR;
+    CallInfo.IsDynamic = Flag;
+    return true;
+  }
+  }
+  return false;
+}
+
+/// Passes the entities of a record to \p Consumer, or only checks that the
+/// record is well-formed if \p Consumer is null.
+static bool replayRecordEntities(IndexRecordReader Reader,
+                                 IndexingConsumer *Consumer) {
+  while (!Reader.atEnd()) {
+    uint8_t Tag;
+    if (!Reader.read8(Tag))
+      return false;
+
+    if (Tag == uint8_t(IndexRecordTag::FinishEntity)) {
+      StringRef Kind;
+      if (!Reader.readString(Kind))
+        return false;
+      if (Consumer && !Consumer->finishSourceEntity(UIdent(Kind)))
+        return true;
+      continue;
+    }
+    if (Tag != uint8_t(IndexRecordTag::StartEntity) &&
+        Tag != uint8_t(IndexRecordTag::RelatedEntity))
+      return false;
+
+    uint8_t EntityType;
+    if (!Reader.read8(EntityType))
+      return false;
+    FuncDeclEntityInfo FuncInfo;
+    CallRefEntityInfo CallInfo;
+    EntityInfo BaseInfo;
+    EntityInfo *Info;
+    switch (EntityType) {
+    case EntityInfo::Base:          Info = &BaseInfo; break;
+    case EntityInfo::FuncDecl:      Info = &FuncInfo; break;
+    case EntityInfo::CallReference: Info = &CallInfo; break;
+    default:
+      return false;
+    }
+    if (!readRecordEntity(Reader, *Info))
+      return false;
+    if (!Consumer)
+      continue;
+
+    bool Continue = Tag == uint8_t(IndexRecordTag::StartEntity)
+                        ? Consumer->startSourceEntity(*Info)
+                        : Consumer->recordRelatedEntity(*Info);
+    if (!Continue)
+      return true;
+  }
+  return true;
+}
+
+static std::string getIndexRecordName(StringRef StorePath,
+                                      StringRef UnitFilename) {
+  SmallString<128> Name(StorePath);
+  llvm::sys::path::append(Name, llvm::sys::path::filename(UnitFilename));
+
+  // name-<hash of unit filename>.index
+  auto Hash = llvm::hash_value(UnitFilename);
+  SmallString<16> HashStr;
+  llvm::APInt(64, uint64_t(Hash)).toStringUnsigned(HashStr, /*Radix*/ 36);
+  llvm::raw_svector_ostream OS(Name);
+  OS << "-" << HashStr << ".index";
+  return OS.str();
+}
+
+namespace {
+/// Forwards the indexing callbacks to the client's consumer.
+///
+/// When a store directory is set, the entities reported for a unit are also
+/// written to a record on disk, keyed on the unit's hash and on a hash of the
+/// input contents and compiler arguments. A later request for the unchanged
+/// unit replays the record instead of walking the AST.
+class IndexStoreRecorder : public IndexingConsumer {
+  IndexingConsumer &Consumer;
+  std::string StorePath;
+  uint64_t InputHash;
+
+  std::string UnitHash;
+  std::string RecordName;
+  std::string Record;
+  llvm::raw_string_ostream RecordOS;
+  bool Recording = false;
+
+public:
+  IndexStoreRecorder(IndexingConsumer &Consumer, StringRef StorePath,
+                     llvm::hash_code InputHash)
+    : Consumer(Consumer), StorePath(StorePath), InputHash(InputHash),
+      RecordOS(Record) { }
+
+  /// Passes the stored entities of \p UnitFilename to the consumer, if its
+  /// record is up-to-date.
+  ///
+  /// \returns true if the entities were replayed.
+  bool replay(StringRef UnitFilename);
+
+  /// Keeps the entities reported from now on until finishRecording().
+  void startRecording(StringRef UnitFilename);
+
+  /// Writes the entities kept since startRecording() to the store.
+  void finishRecording();
+
+  void failed(StringRef ErrDescription) override {
+    Recording = false;
+    Consumer.failed(ErrDescription);
+  }
+
+  bool recordHash(StringRef Hash, bool isKnown) override {
+    UnitHash = Hash;
+    return Consumer.recordHash(Hash, isKnown);
+  }
+
+  bool startDependency(UIdent Kind, StringRef Name, StringRef Path,
+                       bool IsSystem, StringRef Hash) override {
+    return Consumer.startDependency(Kind, Name, Path, IsSystem, Hash);
+  }
+
+  bool finishDependency(UIdent Kind) override {
+    return Consumer.finishDependency(Kind);
+  }
+
+  bool startSourceEntity(const EntityInfo &Info) override {
+    if (Recording)
+      writeRecordEntity(RecordOS, IndexRecordTag::StartEntity, Info);
+    return Consumer.startSourceEntity(Info);
+  }
+
+  bool recordRelatedEntity(const EntityInfo &Info) override {
+    if (Recording)
+      writeRecordEntity(RecordOS, IndexRecordTag::RelatedEntity, Info);
+    return Consumer.recordRelatedEntity(Info);
+  }
+
+  bool finishSourceEntity(UIdent Kind) override {
+    if (Recording) {
+      llvm::support::endian::Writer<llvm::support::little>(RecordOS)
+          .write(static_cast<uint8_t>(IndexRecordTag::FinishEntity));
+      writeRecordString(RecordOS, Kind.getName());
+    }
+    return Consumer.finishSourceEntity(Kind);
+  }
+
+private:
+  void writeHeader(llvm::raw_ostream &OS) const {
+    llvm::support::endian::Writer<llvm::support::little> LE(OS);
+    LE.write(IndexStoreVersion);
+    writeRecordString(OS, UnitHash);
+    LE.write(InputHash);
+  }
+};
+} // anonymous namespace
+
+bool IndexStoreRecorder::replay(StringRef UnitFilename) {
+  if (StorePath.empty() || UnitFilename.empty() || UnitHash.empty())
+    return false;
+
+  auto BufOrErr =
+      llvm::MemoryBuffer::getFile(getIndexRecordName(StorePath, UnitFilename));
+  if (!BufOrErr)
+    return false;
+
+  // Check that the record was written for the current unit.
+  IndexRecordReader Reader(BufOrErr.get()->getBuffer());
+  uint32_t Version;
+  StringRef RecordUnitHash;
+  uint64_t RecordInputHash;
+  if (!Reader.read32(Version) || Version != IndexStoreVersion ||
+      !Reader.readString(RecordUnitHash) || RecordUnitHash != UnitHash ||
+      !Reader.read64(RecordInputHash) || RecordInputHash != InputHash)
+    return false;
+
+  // Don't pass anything along unless the whole record can be read.
+  if (!replayRecordEntities(Reader, nullptr)) {
+    LOG_WARN_FUNC("malformed index record for: " << UnitFilename);
+    return false;
+  }
+  replayRecordEntities(Reader, &Consumer);
+  return true;
+}
+
+void IndexStoreRecorder::startRecording(StringRef UnitFilename) {
+  if (StorePath.empty() || UnitFilename.empty() || UnitHash.empty())
+    return;
+  RecordName = getIndexRecordName(StorePath, UnitFilename);
+  Record.clear();
+  writeHeader(RecordOS);
+  Recording = true;
+}
+
+void IndexStoreRecorder::finishRecording() {
+  if (!Recording)
+    return;
+  Recording = false;
+  RecordOS.flush();
+
+  // Write to a temporary file and rename it, so that concurrent requests
+  // never see a partial record.
+  auto writeRecord = [&]() -> std::error_code {
+    if (auto EC = llvm::sys::fs::create_directories(StorePath))
+      return EC;
+
+    SmallString<128> TmpName(RecordName + "-%%%%%%");
+    int TmpFD;
+    if (auto EC = llvm::sys::fs::createUniqueFile(TmpName.str(), TmpFD,
+                                                  TmpName))
+      return EC;
+
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Record;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TmpName.str());
+      return std::make_error_code(std::errc::io_error);
+    }
+    return llvm::sys::fs::rename(TmpName.str(), RecordName);
+  };
+
+  if (auto EC = writeRecord())
+    LOG_WARN_FUNC("failed to write index record: " << RecordName
+                  << " (" << EC.message() << ')');
+  Record.clear();
+}
+
 namespace {
 
 // Adapter providing a common interface for a SourceFile/Module.
@@ -85,6 +438,7 @@ public:
 };
 
 class IndexSwiftASTWalker : public ide::SourceEntityWalker {
+  IndexStoreRecorder Recorder;
   IndexingConsumer &IdxConsumer;
   SourceManager &SrcMgr;
   unsigned BufferID;
@@ -102,9 +456,11 @@ class IndexSwiftASTWalker : public ide::SourceEntityWalker {
 public:
   IndexSwiftASTWalker(IndexingConsumer &IdxConsumer,
                       ASTContext &Ctx,
-                      unsigned BufferID)
-    : IdxConsumer(IdxConsumer), SrcMgr(Ctx.SourceMgr),
-      BufferID(BufferID) {
+                      unsigned BufferID,
+                      StringRef StorePath,
+                      llvm::hash_code InputHash)
+    : Recorder(IdxConsumer, StorePath, InputHash), IdxConsumer(Recorder),
+      SrcMgr(Ctx.SourceMgr), BufferID(BufferID) {
   }
   ~IndexSwiftASTWalker() {
     assert(Cancelled || EntitiesStack.empty());
@@ -296,6 +652,9 @@ void IndexSwiftASTWalker::visitModule(Module &Mod, StringRef KnownHash) {
       return;
     if (HashIsKnown)
       return; // No need to report symbols.
+    if (Recorder.replay(SrcFile->getFilename()))
+      return; // Reported the stored symbols.
+    Recorder.startRecording(SrcFile->getFilename());
     walk(*SrcFile);
   } else {
     IsModuleFile = true;
@@ -304,8 +663,15 @@ void IndexSwiftASTWalker::visitModule(Module &Mod, StringRef KnownHash) {
       return;
     if (HashIsKnown)
       return; // No need to report symbols.
+    if (Recorder.replay(Mod.getModuleFilename()))
+      return; // Reported the stored symbols.
+    Recorder.startRecording(Mod.getModuleFilename());
     walk(Mod);
   }
+
+  // Only keep the symbols if the client took all of them.
+  if (!Cancelled)
+    Recorder.finishRecording();
 }
 
 bool IndexSwiftASTWalker::handleSourceOrModuleFile(SourceFileOrModule SFOrMod,
@@ -955,12 +1321,23 @@ void IndexSwiftASTWalker::getModuleHash(SourceFileOrModule Mod,
 }
 
 
+/// Hashes what the symbols of a unit depend on besides its file reference
+/// and imports, for the index store.
+static llvm::hash_code hashIndexInput(llvm::MemoryBuffer *Input,
+                                      ArrayRef<const char *> Args) {
+  llvm::hash_code code = llvm::hash_value(Input->getBuffer());
+  for (const char *Arg : Args)
+    code = llvm::hash_combine(code, StringRef(Arg));
+  return code;
+}
+
 static void indexModule(llvm::MemoryBuffer *Input,
                         StringRef ModuleName,
                         StringRef Hash,
                         IndexingConsumer &IdxConsumer,
                         CompilerInstance &CI,
-                        ArrayRef<const char *> Args) {
+                        ArrayRef<const char *> Args,
+                        StringRef StorePath) {
   trace::TracedOperation TracedOp;
   if (trace::enabled()) {
     trace::SwiftInvocation SwiftArgs;
@@ -1004,7 +1381,8 @@ static void indexModule(llvm::MemoryBuffer *Input,
   // Setup a typechecker for protocol conformance resolving.
   OwnedResolver TypeResolver = createLazyResolver(Ctx);
 
-  IndexSwiftASTWalker Walker(IdxConsumer, Ctx, /*BufferID=*/-1);
+  IndexSwiftASTWalker Walker(IdxConsumer, Ctx, /*BufferID=*/-1, StorePath,
+                             hashIndexInput(Input, Args));
   Walker.visitModule(*Mod, Hash);
 }
 
@@ -1043,6 +1421,10 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
     return;
   }
 
+  // Keep the store alive while indexing, even if it is replaced.
+  IntrusiveRefCntPtr<SwiftIndexStore> Store = IndexStore;
+  StringRef StorePath = Store ? StringRef(Store->Path) : StringRef();
+
   StringRef Filename = llvm::sys::path::filename(InputFile);
   StringRef FileExt = llvm::sys::path::extension(Filename);
 
@@ -1072,7 +1454,7 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
     }
 
     indexModule(InputBuf.get(), llvm::sys::path::stem(Filename),
-                Hash, IdxConsumer, CI, Args);
+                Hash, IdxConsumer, CI, Args, StorePath);
     return;
   }
 
@@ -1105,6 +1487,13 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
   OwnedResolver TypeResolver = createLazyResolver(CI.getASTContext());
 
   unsigned BufferID = CI.getPrimarySourceFile()->getBufferID().getValue();
-  IndexSwiftASTWalker Walker(IdxConsumer, CI.getASTContext(), BufferID);
+  IndexSwiftASTWalker Walker(IdxConsumer, CI.getASTContext(), BufferID,
+                             StorePath, hashIndexInput(InputBuf.get(), Args));
   Walker.visitModule(*CI.getMainModule(), Hash);
 }
+
+void SwiftLangSupport::indexStoreOnDisk(StringRef path) {
+  ThreadSafeRefCntPtr<SwiftIndexStore> NewStore(new SwiftIndexStore);
+  NewStore->Path = path;
+  IndexStore = NewStore; // replace the old store.
+}
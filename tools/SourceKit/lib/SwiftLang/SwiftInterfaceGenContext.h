@@ -16,6 +16,7 @@
 #include "SourceKit/Core/LLVM.h"
 #include "swift/AST/Module.h"
 #include "swift/Basic/ThreadSafeRefCounted.h"
+#include <memory>
 #include <string>
 
 namespace swift {
@@ -44,6 +45,11 @@ public:
                                                           ASTUnitRef AstUnit,
                                                           std::string &ErrMsg);
 
+  /// Create a context for \p DocumentName that shares the interface text,
+  /// annotations and ASTs already generated for \p Existing.
+  static SwiftInterfaceGenContextRef
+  createSharing(StringRef DocumentName, SwiftInterfaceGenContextRef Existing);
+
   ~SwiftInterfaceGenContext();
 
   StringRef getDocumentName() const;
@@ -52,6 +58,10 @@ public:
 
   bool matches(StringRef ModuleName, const swift::CompilerInvocation &Invok);
 
+  /// Returns true if this is a module interface and none of the files the
+  /// module was loaded from changed since it was generated.
+  bool isUpToDate() const;
+
   void reportEditorInfo(EditorConsumer &Consumer) const;
 
   struct ResolvedEntity {
@@ -81,9 +91,11 @@ public:
   class Implementation;
 
 private:
-  Implementation &Impl;
+  std::string DocumentName;
+  std::shared_ptr<Implementation> Impl;
 
   SwiftInterfaceGenContext();
+  explicit SwiftInterfaceGenContext(std::shared_ptr<Implementation> Impl);
 };
 
 } // namespace SourceKit.
@@ -23,8 +23,10 @@
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/TimeValue.h"
 #include <map>
 #include <string>
+#include <vector>
 
 namespace swift {
   class ASTContext;
@@ -123,6 +125,7 @@ public:
 };
 
 namespace CodeCompletion {
+struct Options;
 
 /// Provides a thread-safe cache for code completion results that remain valid
 /// for the duration of a 'session' - for example, from the point that a user
@@ -137,6 +140,10 @@ class SessionCache : public ThreadSafeRefCountedBase<SessionCache> {
   CompletionSink sink;
   std::vector<Completion *> sortedCompletions;
   CompletionKind completionKind;
+  /// The filter text of the previous request and the completions it matched,
+  /// which the next keystroke's filter can start from.
+  std::string lastFilterText;
+  std::vector<Completion *> lastFilterMatches;
   llvm::sys::Mutex mtx;
 
 public:
@@ -147,6 +154,12 @@ public:
         completionKind(completionKind) {}
   void setSortedCompletions(std::vector<Completion *> &&completions);
   ArrayRef<Completion *> getSortedCompletions();
+  /// Returns the sorted completions that may match \p filterText, which are
+  /// the matches of the previous filter if \p filterText refines it.
+  std::vector<Completion *>
+  getCompletionsToFilter(StringRef filterText, const Options &options);
+  void setFilterMatches(StringRef filterText,
+                        std::vector<Completion *> &&matches);
   llvm::MemoryBuffer *getBuffer();
   ArrayRef<std::string> getCompilerArgs();
   CompletionKind getCompletionKind();
@@ -173,6 +186,9 @@ public:
 
 class SwiftInterfaceGenMap {
   llvm::StringMap<SwiftInterfaceGenContextRef> IFaceGens;
+  /// Module interfaces whose documents were closed, oldest first.
+  std::vector<SwiftInterfaceGenContextRef> RecentlyClosed;
+  static const unsigned MaxRecentlyClosed = 4;
   mutable llvm::sys::Mutex Mtx;
 
 public:
@@ -181,6 +197,43 @@ public:
   bool remove(StringRef Name);
   SwiftInterfaceGenContextRef find(StringRef ModuleName,
                                    const swift::CompilerInvocation &Invok);
+  /// Find an open or recently closed interface of \p ModuleName whose
+  /// module has not changed since it was generated.
+  SwiftInterfaceGenContextRef
+  findReusable(StringRef ModuleName, const swift::CompilerInvocation &Invok);
+};
+
+/// A thread-safe cache of the cursor info fields of declarations that were
+/// deserialized from a .swiftmodule, keyed on the module file and USR.
+///
+/// These fields only depend on the module file, so repeated cursor info
+/// requests on library symbols don't need to print the declaration or
+/// convert its doc comment again.
+class SwiftModuleDeclInfoCache {
+public:
+  struct Entry {
+    std::string Name;
+    std::string TypeName;
+    std::string DocComment;
+    std::string AnnotatedDecl;
+    std::vector<std::string> OverrideUSRs;
+  };
+
+private:
+  struct ModuleFileEntry {
+    llvm::sys::TimeValue ModificationTime;
+    llvm::StringMap<Entry> Decls;
+  };
+  llvm::StringMap<ModuleFileEntry> ModuleFiles;
+  unsigned NumEntries = 0;
+  static const unsigned MaxEntries = 4096;
+  mutable llvm::sys::Mutex Mtx;
+
+public:
+  /// Returns true and fills in \p Result if there is an entry for \p USR
+  /// and \p ModuleFilename did not change since it was added.
+  bool get(StringRef ModuleFilename, StringRef USR, Entry &Result);
+  void set(StringRef ModuleFilename, StringRef USR, Entry Value);
 };
 
 struct SwiftCompletionCache
@@ -192,6 +245,11 @@ struct SwiftCompletionCache
   ~SwiftCompletionCache();
 };
 
+/// The directory that indexSource() keeps the symbols of each unit in.
+struct SwiftIndexStore : public ThreadSafeRefCountedBase<SwiftIndexStore> {
+  std::string Path;
+};
+
 struct SwiftPopularAPI : public ThreadSafeRefCountedBase<SwiftPopularAPI> {
   llvm::StringMap<CodeCompletion::PopularityFactor> nameToFactor;
 };
@@ -207,10 +265,12 @@ class SwiftLangSupport : public LangSupport {
   std::unique_ptr<SwiftASTManager> ASTMgr;
   SwiftEditorDocumentFileMap EditorDocuments;
   SwiftInterfaceGenMap IFaceGenContexts;
+  SwiftModuleDeclInfoCache ModuleDeclInfos;
   ThreadSafeRefCntPtr<SwiftCompletionCache> CCCache;
   ThreadSafeRefCntPtr<SwiftPopularAPI> PopularAPI;
   CodeCompletion::SessionCacheMap CCSessions;
   ThreadSafeRefCntPtr<SwiftCustomCompletions> CustomCompletions;
+  ThreadSafeRefCntPtr<SwiftIndexStore> IndexStore;
 
 public:
   explicit SwiftLangSupport(SourceKit::Context &SKCtx);
@@ -224,6 +284,7 @@ public:
 
   SwiftEditorDocumentFileMap &getEditorDocuments() { return EditorDocuments; }
   SwiftInterfaceGenMap &getIFaceGenContexts() { return IFaceGenContexts; }
+  SwiftModuleDeclInfoCache &getModuleDeclInfos() { return ModuleDeclInfos; }
   IntrusiveRefCntPtr<SwiftCompletionCache> getCodeCompletionCache() {
     return CCCache;
   }
@@ -267,6 +328,8 @@ public:
   void indexSource(StringRef Filename, IndexingConsumer &Consumer,
                    ArrayRef<const char *> Args, StringRef Hash) override;
 
+  void indexStoreOnDisk(StringRef path) override;
+
   void codeComplete(llvm::MemoryBuffer *InputBuf, unsigned Offset,
                     SourceKit::CodeCompletionConsumer &Consumer,
                     ArrayRef<const char *> Args) override;
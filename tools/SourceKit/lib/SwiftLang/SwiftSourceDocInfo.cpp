@@ -33,6 +33,7 @@
 #include "clang/Index/USRGeneration.h"
 #include "clang/Lex/Lexer.h"
 
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 using namespace SourceKit;
@@ -221,6 +222,65 @@ static bool passCursorInfoForModule(ModuleEntity Mod,
   return false;
 }
 
+//============================================================================//
+// SwiftModuleDeclInfoCache
+//============================================================================//
+
+bool SwiftModuleDeclInfoCache::get(StringRef ModuleFilename, StringRef USR,
+                                   Entry &Result) {
+  llvm::sys::ScopedLock L(Mtx);
+  auto FileIt = ModuleFiles.find(ModuleFilename);
+  if (FileIt == ModuleFiles.end())
+    return false;
+
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(ModuleFilename, Status) ||
+      Status.getLastModificationTime() !=
+          FileIt->getValue().ModificationTime) {
+    NumEntries -= FileIt->getValue().Decls.size();
+    ModuleFiles.erase(FileIt);
+    return false;
+  }
+
+  auto It = FileIt->getValue().Decls.find(USR);
+  if (It == FileIt->getValue().Decls.end())
+    return false;
+  Result = It->getValue();
+  return true;
+}
+
+void SwiftModuleDeclInfoCache::set(StringRef ModuleFilename, StringRef USR,
+                                   Entry Value) {
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(ModuleFilename, Status))
+    return;
+
+  llvm::sys::ScopedLock L(Mtx);
+  if (NumEntries >= MaxEntries) {
+    ModuleFiles.clear();
+    NumEntries = 0;
+  }
+
+  auto &File = ModuleFiles[ModuleFilename];
+  if (File.ModificationTime != Status.getLastModificationTime()) {
+    NumEntries -= File.Decls.size();
+    File.Decls.clear();
+    File.ModificationTime = Status.getLastModificationTime();
+  }
+  if (File.Decls.insert(std::make_pair(USR, std::move(Value))).second)
+    ++NumEntries;
+}
+
+/// Returns the .swiftmodule file that \p VD was deserialized from, or an empty
+/// string if it is not a deserialized declaration.
+static StringRef getSerializedModuleFilename(const ValueDecl *VD) {
+  auto *DC = VD->getDeclContext()->getModuleScopeContext();
+  auto *File = dyn_cast<FileUnit>(DC);
+  if (!File || File->getKind() != FileUnitKind::SerializedAST)
+    return StringRef();
+  return cast<LoadedFile>(File)->getFilename();
+}
+
 /// Returns true for failure to resolve.
 static bool passCursorInfoForDecl(const ValueDecl *VD,
                                   const Module *MainModule,
@@ -236,13 +296,6 @@ static bool passCursorInfoForDecl(const ValueDecl *VD,
 
   SmallString<64> SS;
 
-  unsigned NameBegin = SS.size();
-  {
-    llvm::raw_svector_ostream OS(SS);
-    SwiftLangSupport::printDisplayName(VD, OS);
-  }
-  unsigned NameEnd = SS.size();
-
   unsigned USRBegin = SS.size();
   {
     llvm::raw_svector_ostream OS(SS);
@@ -250,22 +303,44 @@ static bool passCursorInfoForDecl(const ValueDecl *VD,
   }
   unsigned USREnd = SS.size();
 
+  // Declarations from a .swiftmodule look the same every time, so reuse
+  // what was computed for them by an earlier request.
+  StringRef ModuleFilename = getSerializedModuleFilename(VD);
+  SwiftModuleDeclInfoCache::Entry Cached;
+  bool IsCached = !ModuleFilename.empty() && USREnd != USRBegin &&
+    Lang.getModuleDeclInfos().get(ModuleFilename, SS.str(), Cached);
+
+  unsigned NameBegin = SS.size();
+  if (IsCached) {
+    SS += Cached.Name;
+  } else {
+    llvm::raw_svector_ostream OS(SS);
+    SwiftLangSupport::printDisplayName(VD, OS);
+  }
+  unsigned NameEnd = SS.size();
+
   unsigned TypenameBegin = SS.size();
-  if (VD->hasType()) {
+  if (IsCached) {
+    SS += Cached.TypeName;
+  } else if (VD->hasType()) {
     llvm::raw_svector_ostream OS(SS);
     VD->getType().print(OS);
   }
   unsigned TypenameEnd = SS.size();
 
   unsigned DocCommentBegin = SS.size();
-  {
+  if (IsCached) {
+    SS += Cached.DocComment;
+  } else {
     llvm::raw_svector_ostream OS(SS);
     ide::getDocumentationCommentAsXML(VD, OS);
   }
   unsigned DocCommentEnd = SS.size();
 
   unsigned DeclBegin = SS.size();
-  {
+  if (IsCached) {
+    SS += Cached.AnnotatedDecl;
+  } else {
     llvm::raw_svector_ostream OS(SS);
     printAnnotatedDeclaration(VD, OS);
   }
@@ -273,25 +348,33 @@ static bool passCursorInfoForDecl(const ValueDecl *VD,
 
   SmallVector<std::pair<unsigned, unsigned>, 4> OverUSROffs;
 
-  ide::walkOverriddenDecls(VD,
-    [&](llvm::PointerUnion<const ValueDecl*, const clang::NamedDecl*> D) {
+  if (IsCached) {
+    for (auto &OverUSR : Cached.OverrideUSRs) {
       unsigned OverUSRBegin = SS.size();
-      {
-        llvm::raw_svector_ostream OS(SS);
-        if (auto VD = D.dyn_cast<const ValueDecl*>()) {
-          if (SwiftLangSupport::printUSR(VD, OS))
-            return;
-        } else {
-          llvm::SmallString<128> Buf;
-          if (clang::index::generateUSRForDecl(
-              D.get<const clang::NamedDecl*>(), Buf))
-            return;
-          OS << Buf.str();
+      SS += OverUSR;
+      OverUSROffs.push_back(std::make_pair(OverUSRBegin, SS.size()));
+    }
+  } else {
+    ide::walkOverriddenDecls(VD,
+      [&](llvm::PointerUnion<const ValueDecl*, const clang::NamedDecl*> D) {
+        unsigned OverUSRBegin = SS.size();
+        {
+          llvm::raw_svector_ostream OS(SS);
+          if (auto VD = D.dyn_cast<const ValueDecl*>()) {
+            if (SwiftLangSupport::printUSR(VD, OS))
+              return;
+          } else {
+            llvm::SmallString<128> Buf;
+            if (clang::index::generateUSRForDecl(
+                D.get<const clang::NamedDecl*>(), Buf))
+              return;
+            OS << Buf.str();
+          }
         }
-      }
-      unsigned OverUSREnd = SS.size();
-      OverUSROffs.push_back(std::make_pair(OverUSRBegin, OverUSREnd));
-  });
+        unsigned OverUSREnd = SS.size();
+        OverUSROffs.push_back(std::make_pair(OverUSRBegin, OverUSREnd));
+    });
+  }
 
   SmallVector<std::pair<unsigned, unsigned>, 4> RelDeclOffs;
   walkRelatedDecls(VD, [&](const ValueDecl *RelatedDecl, bool DuplicateName) {
@@ -368,6 +451,17 @@ static bool passCursorInfoForDecl(const ValueDecl *VD,
                                  Offs.second-Offs.first));
   }
 
+  if (!ModuleFilename.empty() && !IsCached && !USR.empty()) {
+    SwiftModuleDeclInfoCache::Entry Entry;
+    Entry.Name = Name;
+    Entry.TypeName = TypeName;
+    Entry.DocComment = DocComment;
+    Entry.AnnotatedDecl = AnnotatedDecl;
+    for (StringRef OverUSR : OverUSRs)
+      Entry.OverrideUSRs.push_back(OverUSR);
+    Lang.getModuleDeclInfos().set(ModuleFilename, USR, std::move(Entry));
+  }
+
   SmallVector<StringRef, 4> AnnotatedRelatedDecls;
   for (auto Offs : RelDeclOffs) {
     AnnotatedRelatedDecls.push_back(StringRef(SS.begin() + Offs.first,
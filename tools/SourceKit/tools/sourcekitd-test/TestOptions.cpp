@@ -103,6 +103,7 @@ bool TestOptions::parseArgs(llvm::ArrayRef<const char *> Args) {
     case OPT_req:
       Request = llvm::StringSwitch<SourceKitRequest>(InputArg->getValue())
         .Case("index", SourceKitRequest::Index)
+        .Case("index.store.ondisk", SourceKitRequest::IndexStoreOnDisk)
         .Case("complete", SourceKitRequest::CodeComplete)
         .Case("complete.open", SourceKitRequest::CodeCompleteOpen)
         .Case("complete.close", SourceKitRequest::CodeCompleteClose)
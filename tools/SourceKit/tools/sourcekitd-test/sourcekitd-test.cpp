@@ -101,6 +101,7 @@ static sourcekitd_uid_t KeyUnpopular;
 static sourcekitd_uid_t KeyTypeInterface;
 
 static sourcekitd_uid_t RequestIndex;
+static sourcekitd_uid_t RequestIndexStoreOnDisk;
 static sourcekitd_uid_t RequestCodeComplete;
 static sourcekitd_uid_t RequestCodeCompleteOpen;
 static sourcekitd_uid_t RequestCodeCompleteClose;
@@ -191,6 +192,8 @@ static int skt_main(int argc, const char **argv) {
   semaSemaphore = dispatch_semaphore_create(0);
 
   RequestIndex = sourcekitd_uid_get_from_cstr("source.request.indexsource");
+  RequestIndexStoreOnDisk = sourcekitd_uid_get_from_cstr(
+      "source.request.indexsource.store.ondisk");
   RequestCodeComplete = sourcekitd_uid_get_from_cstr("source.request.codecomplete");
   RequestCodeCompleteOpen = sourcekitd_uid_get_from_cstr("source.request.codecomplete.open");
   RequestCodeCompleteClose = sourcekitd_uid_get_from_cstr("source.request.codecomplete.close");
@@ -366,6 +369,13 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestIndex);
     break;
 
+  case SourceKitRequest::IndexStoreOnDisk:
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest,
+                                          RequestIndexStoreOnDisk);
+    sourcekitd_request_dictionary_set_string(Req, KeyName,
+                                             Opts.CachePath.c_str());
+    break;
+
   case SourceKitRequest::CodeComplete:
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestCodeComplete);
     sourcekitd_request_dictionary_set_int64(Req, KeyOffset, ByteOffset);
@@ -607,6 +617,7 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
       break;
 
     case SourceKitRequest::Index:
+    case SourceKitRequest::IndexStoreOnDisk:
     case SourceKitRequest::CodeComplete:
     case SourceKitRequest::CodeCompleteOpen:
     case SourceKitRequest::CodeCompleteClose:
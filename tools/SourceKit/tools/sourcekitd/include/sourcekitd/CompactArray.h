@@ -31,6 +31,7 @@ protected:
   void addImpl(unsigned Val);
   void addImpl(llvm::StringRef Val);
   void addImpl(SourceKit::UIdent Val);
+  void addImpl(sourcekitd_uid_t Val);
   void addImpl(Optional<llvm::StringRef> Val);
 
 private:
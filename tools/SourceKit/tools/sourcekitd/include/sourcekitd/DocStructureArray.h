@@ -0,0 +1,64 @@
+//===--- DocStructureArray.h - ----------------------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SOURCEKITD_DOC_STRUCTURE_ARRAY_H
+#define LLVM_SOURCEKITD_DOC_STRUCTURE_ARRAY_H
+
+#include "sourcekitd/Internal.h"
+#include "llvm/ADT/ArrayRef.h"
+
+namespace sourcekitd {
+
+VariantFunctions *getVariantFunctionsForDocStructureArray();
+
+/// Builds the 'key.substructure' tree of an editor response as a single flat
+/// buffer that clients read in place.
+///
+/// The children of every structure node are stored next to each other, so
+/// each 'key.substructure' array is a range of entries in the buffer.
+class DocStructureArrayBuilder {
+public:
+  DocStructureArrayBuilder();
+  ~DocStructureArrayBuilder();
+
+  void beginSubStructure(unsigned Offset, unsigned Length,
+                         SourceKit::UIdent Kind,
+                         SourceKit::UIdent AccessLevel,
+                         SourceKit::UIdent SetterAccessLevel,
+                         unsigned NameOffset, unsigned NameLength,
+                         unsigned BodyOffset, unsigned BodyLength,
+                         llvm::StringRef DisplayName,
+                         llvm::StringRef TypeName,
+                         llvm::StringRef RuntimeName,
+                         llvm::StringRef SelectorName,
+                         llvm::ArrayRef<llvm::StringRef> InheritedTypes,
+                         llvm::ArrayRef<SourceKit::UIdent> Attrs);
+
+  void endSubStructure();
+
+  /// Add an element to the innermost open structure node.
+  ///
+  /// \returns false if there is no open structure node.
+  bool addElement(SourceKit::UIdent Kind, unsigned Offset, unsigned Length);
+
+  bool empty() const;
+
+  std::unique_ptr<llvm::MemoryBuffer> createBuffer();
+
+private:
+  struct Implementation;
+  Implementation &Impl;
+};
+
+}
+
+#endif
@@ -43,6 +43,7 @@ enum class CustomBufferKind {
   TokenAnnotationsArray,
   DocSupportAnnotationArray,
   CodeCompletionResultsArray,
+  DocStructureArray,
 };
 
 class ResponseBuilder {
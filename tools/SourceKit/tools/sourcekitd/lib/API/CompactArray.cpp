@@ -47,6 +47,10 @@ void CompactArrayBuilderImpl::addImpl(UIdent Val) {
   addScalar(uid, EntriesBuffer);
 }
 
+void CompactArrayBuilderImpl::addImpl(sourcekitd_uid_t Val) {
+  addScalar(Val, EntriesBuffer);
+}
+
 void CompactArrayBuilderImpl::addImpl(Optional<llvm::StringRef> Val) {
   if (Val.hasValue()) {
     addImpl(Val.getValue());
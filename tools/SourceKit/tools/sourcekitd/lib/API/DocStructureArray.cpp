@@ -0,0 +1,503 @@
+//===--- DocStructureArray.cpp --------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "sourcekitd/DocStructureArray.h"
+#include "sourcekitd/CompactArray.h"
+#include "SourceKit/Core/LLVM.h"
+#include "SourceKit/Support/UIdent.h"
+#include "DictionaryKeys.h"
+
+#include "llvm/Support/MemoryBuffer.h"
+#include <vector>
+
+using namespace SourceKit;
+using namespace sourcekitd;
+
+// The buffer starts with a header of 64-bit words: the number of top-level
+// structure nodes, followed by the offsets of the compact arrays of structure
+// nodes, elements, inherited types and attributes.
+enum DocStructureSubArray : unsigned {
+  StructuresArray,
+  ElementsArray,
+  InheritedTypesArray,
+  AttributesArray,
+  NumSubArrays
+};
+
+static const size_t HeaderSize = sizeof(uint64_t) * (1 + NumSubArrays);
+
+static sourcekitd_uid_t getUIDOrNull(UIdent UID) {
+  return UID.isValid() ? SKDUIDFromUIdent(UID) : nullptr;
+}
+
+struct DocStructureArrayBuilder::Implementation {
+  struct Element {
+    UIdent Kind;
+    unsigned Offset;
+    unsigned Length;
+  };
+
+  struct Node {
+    unsigned Offset;
+    unsigned Length;
+    UIdent Kind;
+    UIdent AccessLevel;
+    UIdent SetterAccessLevel;
+    unsigned NameOffset;
+    unsigned NameLength;
+    unsigned BodyOffset;
+    unsigned BodyLength;
+    std::string DisplayName;
+    std::string TypeName;
+    std::string RuntimeName;
+    std::string SelectorName;
+    std::vector<std::string> InheritedTypes;
+    std::vector<UIdent> Attrs;
+    std::vector<Element> Elements;
+    std::vector<unsigned> Children;
+  };
+
+  std::vector<Node> Nodes;
+  std::vector<unsigned> TopLevel;
+  std::vector<unsigned> OpenNodes;
+};
+
+DocStructureArrayBuilder::DocStructureArrayBuilder()
+  : Impl(*new Implementation()) {
+}
+
+DocStructureArrayBuilder::~DocStructureArrayBuilder() {
+  delete &Impl;
+}
+
+void DocStructureArrayBuilder::beginSubStructure(
+    unsigned Offset, unsigned Length, UIdent Kind, UIdent AccessLevel,
+    UIdent SetterAccessLevel, unsigned NameOffset, unsigned NameLength,
+    unsigned BodyOffset, unsigned BodyLength, StringRef DisplayName,
+    StringRef TypeName, StringRef RuntimeName, StringRef SelectorName,
+    ArrayRef<StringRef> InheritedTypes, ArrayRef<UIdent> Attrs) {
+
+  unsigned Index = Impl.Nodes.size();
+  if (Impl.OpenNodes.empty())
+    Impl.TopLevel.push_back(Index);
+  else
+    Impl.Nodes[Impl.OpenNodes.back()].Children.push_back(Index);
+
+  Implementation::Node Node;
+  Node.Offset = Offset;
+  Node.Length = Length;
+  Node.Kind = Kind;
+  Node.AccessLevel = AccessLevel;
+  Node.SetterAccessLevel = SetterAccessLevel;
+  Node.NameOffset = NameOffset;
+  Node.NameLength = NameLength;
+  Node.BodyOffset = BodyOffset;
+  Node.BodyLength = BodyLength;
+  Node.DisplayName = DisplayName;
+  Node.TypeName = TypeName;
+  Node.RuntimeName = RuntimeName;
+  Node.SelectorName = SelectorName;
+  for (StringRef InheritedType : InheritedTypes)
+    Node.InheritedTypes.push_back(InheritedType);
+  Node.Attrs.assign(Attrs.begin(), Attrs.end());
+  Impl.Nodes.push_back(std::move(Node));
+  Impl.OpenNodes.push_back(Index);
+}
+
+void DocStructureArrayBuilder::endSubStructure() {
+  if (!Impl.OpenNodes.empty())
+    Impl.OpenNodes.pop_back();
+}
+
+bool DocStructureArrayBuilder::addElement(UIdent Kind, unsigned Offset,
+                                          unsigned Length) {
+  if (Impl.OpenNodes.empty())
+    return false;
+  Impl.Nodes[Impl.OpenNodes.back()].Elements.push_back({Kind, Offset, Length});
+  return true;
+}
+
+bool DocStructureArrayBuilder::empty() const {
+  return Impl.Nodes.empty();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> DocStructureArrayBuilder::createBuffer() {
+  CompactArrayBuilder<unsigned, // Offset
+                      unsigned, // Length
+                      sourcekitd_uid_t, // Kind
+                      sourcekitd_uid_t, // AccessLevel
+                      sourcekitd_uid_t, // SetterAccessLevel
+                      unsigned, // NameOffset
+                      unsigned, // NameLength
+                      unsigned, // BodyOffset
+                      unsigned, // BodyLength
+                      StringRef, // DisplayName
+                      StringRef, // TypeName
+                      StringRef, // RuntimeName
+                      StringRef, // SelectorName
+                      unsigned, // InheritedTypes begin
+                      unsigned, // InheritedTypes end
+                      unsigned, // Attrs begin
+                      unsigned, // Attrs end
+                      unsigned, // Elements begin
+                      unsigned, // Elements end
+                      unsigned, // SubStructure begin
+                      unsigned  // SubStructure end
+                      > Structures;
+  CompactArrayBuilder<UIdent, unsigned, unsigned> Elements;
+  CompactArrayBuilder<StringRef> InheritedTypes;
+  CompactArrayBuilder<UIdent> Attributes;
+
+  // Lay the nodes out breadth-first, so that the children of every node end
+  // up next to each other.
+  std::vector<unsigned> Order(Impl.TopLevel);
+  unsigned NumElements = 0, NumInheritedTypes = 0, NumAttrs = 0;
+  for (size_t I = 0; I != Order.size(); ++I) {
+    auto &Node = Impl.Nodes[Order[I]];
+    unsigned SubBegin = Order.size();
+    Order.insert(Order.end(), Node.Children.begin(), Node.Children.end());
+    unsigned SubEnd = Order.size();
+
+    unsigned ElementsBegin = NumElements;
+    for (auto &Elem : Node.Elements)
+      Elements.addEntry(Elem.Kind, Elem.Offset, Elem.Length);
+    NumElements += Node.Elements.size();
+
+    unsigned InheritedBegin = NumInheritedTypes;
+    for (auto &Name : Node.InheritedTypes)
+      InheritedTypes.addEntry(Name);
+    NumInheritedTypes += Node.InheritedTypes.size();
+
+    unsigned AttrsBegin = NumAttrs;
+    for (auto Attr : Node.Attrs)
+      Attributes.addEntry(Attr);
+    NumAttrs += Node.Attrs.size();
+
+    Structures.addEntry(Node.Offset, Node.Length,
+                        getUIDOrNull(Node.Kind),
+                        getUIDOrNull(Node.AccessLevel),
+                        getUIDOrNull(Node.SetterAccessLevel),
+                        Node.NameOffset, Node.NameLength,
+                        Node.BodyOffset, Node.BodyLength,
+                        Node.DisplayName, Node.TypeName,
+                        Node.RuntimeName, Node.SelectorName,
+                        InheritedBegin, NumInheritedTypes,
+                        AttrsBegin, NumAttrs,
+                        ElementsBegin, NumElements,
+                        SubBegin, SubEnd);
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> SubBufs[NumSubArrays] = {
+    Structures.createBuffer(),
+    Elements.createBuffer(),
+    InheritedTypes.createBuffer(),
+    Attributes.createBuffer(),
+  };
+
+  // Keep every compact array 8-byte aligned, since it starts with its size.
+  auto alignedSize = [](size_t Size) { return (Size + 7) & ~size_t(7); };
+  size_t TotalSize = HeaderSize;
+  for (auto &SubBuf : SubBufs)
+    TotalSize += alignedSize(SubBuf->getBufferSize());
+
+  std::unique_ptr<llvm::MemoryBuffer> Buf;
+  Buf = llvm::MemoryBuffer::getNewMemBuffer(TotalSize);
+  char *BufStart = (char*)Buf->getBufferStart();
+  uint64_t *Header = reinterpret_cast<uint64_t*>(BufStart);
+  Header[0] = Impl.TopLevel.size();
+  size_t Offset = HeaderSize;
+  for (unsigned I = 0; I != NumSubArrays; ++I) {
+    Header[1 + I] = Offset;
+    memcpy(BufStart + Offset, SubBufs[I]->getBufferStart(),
+           SubBufs[I]->getBufferSize());
+    Offset += alignedSize(SubBufs[I]->getBufferSize());
+  }
+
+  return Buf;
+}
+
+namespace {
+
+void *getSubArray(void *Buf, DocStructureSubArray Which) {
+  uint64_t Offset = reinterpret_cast<uint64_t*>(Buf)[1 + Which];
+  return static_cast<char*>(Buf) + Offset;
+}
+
+#define APPLY(K, Ty, Field)                              \
+  do {                                                   \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(K);          \
+    sourcekitd_variant_t var = make##Ty##Variant(Field); \
+    if (!applier(key, var)) return false;                \
+  } while (0)
+
+#define APPLY_VAR(K, Var)                                \
+  do {                                                   \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(K);          \
+    if (!applier(key, Var)) return false;                \
+  } while (0)
+
+template <typename T> struct EntryDictFuncs;
+
+/// An array variant over the entries [Begin, End) of one of the compact
+/// arrays; \c T provides the dictionary of each entry.
+template <typename T>
+struct RangeArrayFuncs {
+  static sourcekitd_variant_t make(void *Buf, unsigned Begin, unsigned End) {
+    return {{ (uintptr_t)&Funcs, (uintptr_t)Buf,
+              (uint64_t(End) << 32) | Begin }};
+  }
+
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t var) {
+    return SOURCEKITD_VARIANT_TYPE_ARRAY;
+  }
+
+  static size_t array_get_count(sourcekitd_variant_t array) {
+    uint64_t Range = array.data[2];
+    return (Range >> 32) - (Range & 0xffffffff);
+  }
+
+  static sourcekitd_variant_t
+  array_get_value(sourcekitd_variant_t array, size_t index) {
+    assert(index < array_get_count(array));
+    uint64_t Begin = array.data[2] & 0xffffffff;
+    return {{ (uintptr_t)&EntryDictFuncs<T>::Funcs, (uintptr_t)array.data[1],
+              Begin + index }};
+  }
+
+  static VariantFunctions Funcs;
+};
+
+template <typename T>
+VariantFunctions RangeArrayFuncs<T>::Funcs = {
+  get_type,
+  nullptr/*array_apply*/,
+  nullptr/*array_get_bool*/,
+  array_get_count,
+  nullptr/*array_get_int64*/,
+  nullptr/*array_get_string*/,
+  nullptr/*array_get_uid*/,
+  array_get_value,
+  nullptr/*bool_get_value*/,
+  nullptr/*dictionary_apply*/,
+  nullptr/*dictionary_get_bool*/,
+  nullptr/*dictionary_get_int64*/,
+  nullptr/*dictionary_get_string*/,
+  nullptr/*dictionary_get_value*/,
+  nullptr/*dictionary_get_uid*/,
+  nullptr/*string_get_length*/,
+  nullptr/*string_get_ptr*/,
+  nullptr/*int64_get_value*/,
+  nullptr/*uid_get_value*/
+};
+
+/// The dictionary variant of one entry of a compact array; \c T provides
+/// \c apply() for it.
+template <typename T>
+struct EntryDictFuncs {
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t var) {
+    return SOURCEKITD_VARIANT_TYPE_DICTIONARY;
+  }
+
+  static bool dictionary_apply(sourcekitd_variant_t dict,
+                              sourcekitd_variant_dictionary_applier_t applier) {
+    return T::apply((void*)dict.data[1], dict.data[2], applier);
+  }
+
+  static VariantFunctions Funcs;
+};
+
+template <typename T>
+VariantFunctions EntryDictFuncs<T>::Funcs = {
+  get_type,
+  nullptr/*array_apply*/,
+  nullptr/*array_get_bool*/,
+  nullptr/*array_get_count*/,
+  nullptr/*array_get_int64*/,
+  nullptr/*array_get_string*/,
+  nullptr/*array_get_uid*/,
+  nullptr/*array_get_value*/,
+  nullptr/*bool_get_value*/,
+  dictionary_apply,
+  nullptr/*dictionary_get_bool*/,
+  nullptr/*dictionary_get_int64*/,
+  nullptr/*dictionary_get_string*/,
+  nullptr/*dictionary_get_value*/,
+  nullptr/*dictionary_get_uid*/,
+  nullptr/*string_get_length*/,
+  nullptr/*string_get_ptr*/,
+  nullptr/*int64_get_value*/,
+  nullptr/*uid_get_value*/
+};
+
+struct DocStructureElement {
+  static bool apply(void *Buf, size_t Index,
+                    sourcekitd_variant_dictionary_applier_t applier) {
+    CompactArrayReader<sourcekitd_uid_t, unsigned, unsigned>
+      Reader(getSubArray(Buf, ElementsArray));
+    sourcekitd_uid_t Kind;
+    unsigned Offset;
+    unsigned Length;
+    Reader.readEntries(Index, Kind, Offset, Length);
+
+    APPLY(KeyKind, UID, Kind);
+    APPLY(KeyOffset, Int, Offset);
+    APPLY(KeyLength, Int, Length);
+    return true;
+  }
+
+};
+
+struct DocStructureInheritedType {
+  static bool apply(void *Buf, size_t Index,
+                    sourcekitd_variant_dictionary_applier_t applier) {
+    CompactArrayReader<const char *>
+      Reader(getSubArray(Buf, InheritedTypesArray));
+    const char *Name;
+    Reader.readEntries(Index, Name);
+
+    APPLY(KeyName, String, Name);
+    return true;
+  }
+
+};
+
+struct DocStructureAttribute {
+  static bool apply(void *Buf, size_t Index,
+                    sourcekitd_variant_dictionary_applier_t applier) {
+    CompactArrayReader<sourcekitd_uid_t>
+      Reader(getSubArray(Buf, AttributesArray));
+    sourcekitd_uid_t Attr;
+    Reader.readEntries(Index, Attr);
+
+    APPLY(KeyAttribute, UID, Attr);
+    return true;
+  }
+
+};
+
+struct DocStructureNode {
+  static bool apply(void *Buf, size_t Index,
+                    sourcekitd_variant_dictionary_applier_t applier) {
+    CompactArrayReader<unsigned, unsigned,
+                       sourcekitd_uid_t, sourcekitd_uid_t, sourcekitd_uid_t,
+                       unsigned, unsigned, unsigned, unsigned,
+                       const char *, const char *, const char *, const char *,
+                       unsigned, unsigned, unsigned, unsigned,
+                       unsigned, unsigned, unsigned, unsigned>
+      Reader(getSubArray(Buf, StructuresArray));
+
+    unsigned Offset, Length;
+    sourcekitd_uid_t Kind, AccessLevel, SetterAccessLevel;
+    unsigned NameOffset, NameLength, BodyOffset, BodyLength;
+    const char *DisplayName, *TypeName, *RuntimeName, *SelectorName;
+    unsigned InheritedBegin, InheritedEnd, AttrsBegin, AttrsEnd;
+    unsigned ElementsBegin, ElementsEnd, SubBegin, SubEnd;
+    Reader.readEntries(Index, Offset, Length,
+                       Kind, AccessLevel, SetterAccessLevel,
+                       NameOffset, NameLength, BodyOffset, BodyLength,
+                       DisplayName, TypeName, RuntimeName, SelectorName,
+                       InheritedBegin, InheritedEnd, AttrsBegin, AttrsEnd,
+                       ElementsBegin, ElementsEnd, SubBegin, SubEnd);
+
+    APPLY(KeyOffset, Int, Offset);
+    APPLY(KeyLength, Int, Length);
+    APPLY(KeyKind, UID, Kind);
+    if (AccessLevel)
+      APPLY(KeyAccessibility, UID, AccessLevel);
+    if (SetterAccessLevel)
+      APPLY(KeySetterAccessibility, UID, SetterAccessLevel);
+    APPLY(KeyNameOffset, Int, NameOffset);
+    APPLY(KeyNameLength, Int, NameLength);
+    if (BodyOffset != 0 || BodyLength != 0) {
+      APPLY(KeyBodyOffset, Int, BodyOffset);
+      APPLY(KeyBodyLength, Int, BodyLength);
+    }
+    if (*DisplayName)
+      APPLY(KeyName, String, DisplayName);
+    if (*TypeName)
+      APPLY(KeyTypeName, String, TypeName);
+    if (*RuntimeName)
+      APPLY(KeyRuntimeName, String, RuntimeName);
+    if (*SelectorName)
+      APPLY(KeySelectorName, String, SelectorName);
+    if (InheritedBegin != InheritedEnd)
+      APPLY_VAR(KeyInheritedTypes,
+                RangeArrayFuncs<DocStructureInheritedType>::make(
+                    Buf, InheritedBegin, InheritedEnd));
+    if (AttrsBegin != AttrsEnd)
+      APPLY_VAR(KeyAttributes,
+                RangeArrayFuncs<DocStructureAttribute>::make(
+                    Buf, AttrsBegin, AttrsEnd));
+    if (ElementsBegin != ElementsEnd)
+      APPLY_VAR(KeyElements,
+                RangeArrayFuncs<DocStructureElement>::make(
+                    Buf, ElementsBegin, ElementsEnd));
+    if (SubBegin != SubEnd)
+      APPLY_VAR(KeySubStructure,
+                RangeArrayFuncs<DocStructureNode>::make(
+                    Buf, SubBegin, SubEnd));
+    return true;
+  }
+
+};
+
+#undef APPLY_VAR
+#undef APPLY
+
+/// The top-level 'key.substructure' array, whose variant only carries the
+/// buffer.
+struct DocStructureTopLevelArray {
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t var) {
+    return SOURCEKITD_VARIANT_TYPE_ARRAY;
+  }
+
+  static size_t array_get_count(sourcekitd_variant_t array) {
+    return *reinterpret_cast<uint64_t*>(array.data[1]);
+  }
+
+  static sourcekitd_variant_t
+  array_get_value(sourcekitd_variant_t array, size_t index) {
+    assert(index < array_get_count(array));
+    return {{ (uintptr_t)&EntryDictFuncs<DocStructureNode>::Funcs,
+              (uintptr_t)array.data[1], index }};
+  }
+
+  static VariantFunctions Funcs;
+};
+
+VariantFunctions DocStructureTopLevelArray::Funcs = {
+  get_type,
+  nullptr/*array_apply*/,
+  nullptr/*array_get_bool*/,
+  array_get_count,
+  nullptr/*array_get_int64*/,
+  nullptr/*array_get_string*/,
+  nullptr/*array_get_uid*/,
+  array_get_value,
+  nullptr/*bool_get_value*/,
+  nullptr/*dictionary_apply*/,
+  nullptr/*dictionary_get_bool*/,
+  nullptr/*dictionary_get_int64*/,
+  nullptr/*dictionary_get_string*/,
+  nullptr/*dictionary_get_value*/,
+  nullptr/*dictionary_get_uid*/,
+  nullptr/*string_get_length*/,
+  nullptr/*string_get_ptr*/,
+  nullptr/*int64_get_value*/,
+  nullptr/*uid_get_value*/
+};
+
+} // end anonymous namespace
+
+VariantFunctions *sourcekitd::getVariantFunctionsForDocStructureArray() {
+  return &DocStructureTopLevelArray::Funcs;
+}
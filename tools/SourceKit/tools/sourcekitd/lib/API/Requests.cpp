@@ -13,6 +13,7 @@
 #include "DictionaryKeys.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
+#include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
 
 #include "SourceKit/Core/Context.h"
@@ -57,6 +58,8 @@ public:
 } // anonymous namespace.
 
 static LazySKDUID RequestIndex("source.request.indexsource");
+static LazySKDUID
+    RequestIndexStoreOnDisk("source.request.indexsource.store.ondisk");
 static LazySKDUID RequestDocInfo("source.request.docinfo");
 static LazySKDUID RequestCodeComplete("source.request.codecomplete");
 static LazySKDUID RequestCodeCompleteOpen("source.request.codecomplete.open");
@@ -450,6 +453,16 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     return Rec(codeCompleteClose(*Name, Offset));
   }
 
+  if (ReqUID == RequestIndexStoreOnDisk) {
+    Optional<StringRef> Name = Req.getString(KeyName);
+    if (!Name.hasValue())
+      return Rec(createErrorRequestInvalid("missing 'key.name'"));
+    LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+    Lang.indexStoreOnDisk(*Name);
+    ResponseBuilder b;
+    return Rec(b.createResponse());
+  }
+
   if (ReqUID == RequestCodeCompleteCacheOnDisk) {
     Optional<StringRef> Name = Req.getString(KeyName);
     if (!Name.hasValue())
@@ -1426,18 +1439,13 @@ class SKEditorConsumer : public EditorConsumer {
   TokenAnnotationsArrayBuilder SyntaxMap;
   TokenAnnotationsArrayBuilder SemanticAnnotations;
 
-  struct StructureNode {
-    ResponseBuilder::Dictionary Dict;
-    ResponseBuilder::Array SubStructures;
-    ResponseBuilder::Array Elements;
-
-    explicit StructureNode(ResponseBuilder::Dictionary Dict) : Dict(Dict) {}
-  };
-  std::vector<StructureNode> Structures;
+  DocStructureArrayBuilder DocStructure;
+  ResponseBuilder::Array RootElements;
   ResponseBuilder::Array Diags;
   sourcekitd_response_t Error = nullptr;
 
   bool EnableSyntaxMap;
+  bool EnableStructure;
   bool EnableDiagnostics;
   bool SyntacticOnly;
 
@@ -1446,12 +1454,11 @@ public:
                    bool EnableStructure, bool EnableDiagnostics,
                    bool SyntacticOnly)
   : EnableSyntaxMap(EnableSyntaxMap),
+    EnableStructure(EnableStructure),
     EnableDiagnostics(EnableDiagnostics),
     SyntacticOnly(SyntacticOnly) {
 
     Dict = RespBuilder.getDictionary();
-    if (EnableStructure)
-      Structures.push_back(StructureNode{Dict});
   }
 
   SKEditorConsumer(ResponseReceiver RespReceiver, bool EnableSyntaxMap,
@@ -1634,6 +1641,11 @@ sourcekitd_response_t SKEditorConsumer::createResponse() {
         CustomBufferKind::TokenAnnotationsArray,
         SemanticAnnotations.createBuffer());
   }
+  if (EnableStructure && !DocStructure.empty()) {
+    Dict.setCustomBuffer(KeySubStructure,
+        CustomBufferKind::DocStructureArray,
+        DocStructure.createBuffer());
+  }
 
   return RespBuilder.createResponse();
 }
@@ -1680,77 +1692,37 @@ SKEditorConsumer::beginDocumentSubStructure(unsigned Offset,
                                             StringRef SelectorName,
                                             ArrayRef<StringRef> InheritedTypes,
                                             ArrayRef<UIdent> Attrs) {
-  if (Structures.empty())
-    return true;
-
-  auto &Parent = Structures.back();
-  if (Parent.SubStructures.isNull())
-    Parent.SubStructures = Parent.Dict.setArray(KeySubStructure);
-  auto Node = Parent.SubStructures.appendDictionary();
-  Node.set(KeyOffset, Offset);
-  Node.set(KeyLength, Length);
-  Node.set(KeyKind, Kind);
-  if (AccessLevel.isValid())
-    Node.set(KeyAccessibility, AccessLevel);
-  if (SetterAccessLevel.isValid())
-    Node.set(KeySetterAccessibility, SetterAccessLevel);
-  Node.set(KeyNameOffset, NameOffset);
-  Node.set(KeyNameLength, NameLength);
-  if (BodyOffset != 0 || BodyLength !=0) {
-    Node.set(KeyBodyOffset, BodyOffset);
-    Node.set(KeyBodyLength, BodyLength);
-  }
-
-  if (!DisplayName.empty())
-    Node.set(KeyName, DisplayName);
-
-  if (!TypeName.empty())
-    Node.set(KeyTypeName,TypeName);
-
-  if (!RuntimeName.empty())
-    Node.set(KeyRuntimeName, RuntimeName);
-
-  if (!SelectorName.empty())
-    Node.set(KeySelectorName, SelectorName);
-
-  if (!InheritedTypes.empty()) {
-    auto TypeArray = Node.setArray(KeyInheritedTypes);
-    for (const StringRef &TypeName : InheritedTypes) {
-      TypeArray.appendDictionary().set(KeyName, TypeName);
-    }
-  }
-  if (!Attrs.empty()) {
-    auto AttrArray = Node.setArray(KeyAttributes);
-    for (auto Attr : Attrs) {
-      auto AttrDict = AttrArray.appendDictionary();
-      AttrDict.set(KeyAttribute, Attr);
-    }
-  }
-  Structures.push_back(StructureNode{Node});
+  if (EnableStructure)
+    DocStructure.beginSubStructure(Offset, Length, Kind, AccessLevel,
+                                   SetterAccessLevel, NameOffset, NameLength,
+                                   BodyOffset, BodyLength, DisplayName,
+                                   TypeName, RuntimeName, SelectorName,
+                                   InheritedTypes, Attrs);
   return true;
 }
 
 bool SKEditorConsumer::endDocumentSubStructure() {
-  if (!Structures.empty())
-    Structures.pop_back();
-
+  if (EnableStructure)
+    DocStructure.endSubStructure();
   return true;
 }
 
 bool SKEditorConsumer::handleDocumentSubStructureElement(UIdent Kind,
                                                          unsigned Offset,
                                                          unsigned Length) {
-  if (Structures.empty())
+  if (!EnableStructure)
+    return true;
+  if (DocStructure.addElement(Kind, Offset, Length))
     return true;
 
-  auto &Parent = Structures.back();
-  if (Parent.Elements.isNull())
-    Parent.Elements = Parent.Dict.setArray(KeyElements);
-  auto Node = Parent.Elements.appendDictionary();
+  // Elements outside of any structure node belong to the response itself.
+  if (RootElements.isNull())
+    RootElements = Dict.setArray(KeyElements);
+  auto Node = RootElements.appendDictionary();
   Node.set(KeyKind, Kind);
   Node.set(KeyOffset, Offset);
   Node.set(KeyLength, Length);
-  return  true;
+  return true;
 }
 
 bool SKEditorConsumer::recordAffectedRange(unsigned Offset, unsigned Length) {
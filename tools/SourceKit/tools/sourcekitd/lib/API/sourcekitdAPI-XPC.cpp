@@ -12,6 +12,7 @@
 
 #include "DictionaryKeys.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
 #include "sourcekitd/Logging.h"
@@ -682,6 +683,8 @@ static sourcekitd_variant_type_t XPCVar_get_type(sourcekitd_variant_t var) {
       return SOURCEKITD_VARIANT_TYPE_ARRAY;
     case CustomBufferKind::CodeCompletionResultsArray:
       return SOURCEKITD_VARIANT_TYPE_ARRAY;
+    case CustomBufferKind::DocStructureArray:
+      return SOURCEKITD_VARIANT_TYPE_ARRAY;
     }
   }
   
@@ -817,6 +820,9 @@ static sourcekitd_variant_t variantFromXPCObject(xpc_object_t obj) {
     case CustomBufferKind::CodeCompletionResultsArray:
       return {{ (uintptr_t)getVariantFunctionsForCodeCompletionResultsArray(),
                 (uintptr_t)CUSTOM_BUF_START(obj), 0 }};
+    case CustomBufferKind::DocStructureArray:
+      return {{ (uintptr_t)getVariantFunctionsForDocStructureArray(),
+                (uintptr_t)CUSTOM_BUF_START(obj), 0 }};
     }
   }
 
@@ -0,0 +1,486 @@
+//===-- compile_cache_main.cpp - Shared cache of frontend job results -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Given -compile-cache <cache>, the driver runs each compile job as
+//
+//   swift -compile-cache <cache> -frontend <args>...
+//
+// which looks the job up in a content-addressed cache, and on a hit writes
+// the outputs and replays the diagnostics of an earlier, identical job
+// instead of compiling. <cache> is a directory, or an http:// or https:// URL
+// under which entries are read with GET and written with PUT (using curl).
+//
+// A job is identified in two steps, like ccache's direct mode:
+//
+// 1. The compiler version, the working directory, the arguments and the
+//    contents of the input files give the job's manifest key. The manifest
+//    lists the other files the job read, such as imported modules and
+//    headers, which only running the job can discover.
+// 2. The manifest key and the contents of the files in the manifest give the
+//    key of the entry, which holds the job's outputs and its diagnostics.
+//    Serialized modules contribute the content hash in their header rather
+//    than all of their bytes.
+//
+// Only jobs that produce object files are cached. A job that fails is never
+// stored.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Version.h"
+#include "swift/Option/Options.h"
+#include "swift/Serialization/Validation.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Option/Option.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <memory>
+
+using namespace swift;
+using namespace llvm::opt;
+
+extern int frontend_main(ArrayRef<const char *> Args, const char *Argv0,
+                         void *MainAddr);
+extern int compile_server_client_main(ArrayRef<const char *> Args,
+                                      const char *Argv0, void *MainAddr);
+
+namespace {
+
+/// Where cache entries are kept.
+class CacheBackend {
+public:
+  virtual ~CacheBackend() = default;
+
+  /// Reads the entry for \p Key into \p Data. Returns false if there is none.
+  virtual bool fetch(StringRef Key, std::string &Data) = 0;
+
+  /// Stores \p Data as the entry for \p Key. The cache is only an
+  /// optimization, so failures are ignored.
+  virtual void store(StringRef Key, StringRef Data) = 0;
+
+  /// Creates the backend for a directory path or an HTTP URL.
+  static std::unique_ptr<CacheBackend> create(StringRef Spec);
+};
+
+/// Keeps entries in files under a directory, which may be shared, for
+/// example over NFS.
+class DiskCacheBackend : public CacheBackend {
+  std::string Root;
+
+  std::string getPath(StringRef Key) const {
+    SmallString<128> Path(Root);
+    llvm::sys::path::append(Path, Key.substr(0, 2), Key);
+    return Path.str();
+  }
+
+public:
+  explicit DiskCacheBackend(StringRef Root) : Root(Root) {}
+
+  bool fetch(StringRef Key, std::string &Data) override {
+    auto Buffer = llvm::MemoryBuffer::getFile(getPath(Key));
+    if (!Buffer)
+      return false;
+    Data = Buffer.get()->getBuffer();
+    return true;
+  }
+
+  void store(StringRef Key, StringRef Data) override {
+    std::string Path = getPath(Key);
+    if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)))
+      return;
+
+    // Write to a temporary file and rename it, so that concurrent readers
+    // never see a partial entry.
+    std::string Model = Path + "-%%%%%%%%";
+    SmallString<128> TempPath;
+    int FD;
+    if (llvm::sys::fs::createUniqueFile(Model, FD, TempPath))
+      return;
+    {
+      llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+      Out << Data;
+    }
+    if (llvm::sys::fs::rename(TempPath, Path))
+      llvm::sys::fs::remove(TempPath);
+  }
+};
+
+/// Keeps entries on an HTTP server, such as a WebDAV share or an object
+/// store, by running curl.
+class HTTPCacheBackend : public CacheBackend {
+  std::string BaseURL;
+  std::string Curl;
+
+  bool runCurl(ArrayRef<StringRef> Args) {
+    std::vector<const char *> Argv;
+    Argv.push_back(Curl.c_str());
+    std::vector<std::string> Storage(Args.begin(), Args.end());
+    for (const std::string &Arg : Storage)
+      Argv.push_back(Arg.c_str());
+    Argv.push_back(nullptr);
+    StringRef Empty;
+    const StringRef *Redirects[] = { &Empty, &Empty, &Empty };
+    return llvm::sys::ExecuteAndWait(Curl, Argv.data(), nullptr,
+                                     Redirects) == 0;
+  }
+
+public:
+  HTTPCacheBackend(StringRef BaseURL, StringRef Curl)
+    : BaseURL(BaseURL.rtrim('/')), Curl(Curl) {}
+
+  bool fetch(StringRef Key, std::string &Data) override {
+    SmallString<128> TempPath;
+    if (llvm::sys::fs::createTemporaryFile("swift-cache", "entry", TempPath))
+      return false;
+    bool Found = runCurl({"--silent", "--fail", "--output", TempPath,
+                          BaseURL + "/" + Key.str()});
+    if (Found) {
+      auto Buffer = llvm::MemoryBuffer::getFile(TempPath);
+      Found = bool(Buffer);
+      if (Found)
+        Data = Buffer.get()->getBuffer();
+    }
+    llvm::sys::fs::remove(TempPath);
+    return Found;
+  }
+
+  void store(StringRef Key, StringRef Data) override {
+    int FD;
+    SmallString<128> TempPath;
+    if (llvm::sys::fs::createTemporaryFile("swift-cache", "entry", FD,
+                                           TempPath))
+      return;
+    {
+      llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+      Out << Data;
+    }
+    runCurl({"--silent", "--fail", "--upload-file", TempPath,
+             BaseURL + "/" + Key.str()});
+    llvm::sys::fs::remove(TempPath);
+  }
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<CacheBackend> CacheBackend::create(StringRef Spec) {
+  if (Spec.startswith("http://") || Spec.startswith("https://")) {
+    auto Curl = llvm::sys::findProgramByName("curl");
+    if (!Curl)
+      return nullptr;
+    return std::unique_ptr<CacheBackend>(
+      new HTTPCacheBackend(Spec, Curl.get()));
+  }
+  return std::unique_ptr<CacheBackend>(new DiskCacheBackend(Spec));
+}
+
+/// The options that name outputs of a job, which an entry holds the contents
+/// of.
+static const options::ID OutputOptions[] = {
+  options::OPT_o,
+  options::OPT_emit_module_path,
+  options::OPT_emit_module_doc_path,
+  options::OPT_emit_dependencies_path,
+  options::OPT_emit_reference_dependencies_path,
+  options::OPT_emit_objc_header_path,
+  options::OPT_serialize_diagnostics_path,
+};
+
+static std::string finalizeHash(llvm::MD5 &Hash) {
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Str;
+  llvm::MD5::stringifyResult(Result, Str);
+  return Str.str();
+}
+
+/// Adds \p Str to \p Hash, so that consecutive strings can't run together.
+static void hashString(llvm::MD5 &Hash, StringRef Str) {
+  Hash.update(Str);
+  Hash.update(StringRef("\0", 1));
+}
+
+/// Adds the contents of the file at \p Path to \p Hash. Returns false if the
+/// file can't be read.
+static bool hashFile(llvm::MD5 &Hash, StringRef Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return false;
+
+  StringRef Data = Buffer.get()->getBuffer();
+  if (serialization::isSerializedAST(Data)) {
+    auto Info = serialization::validateSerializedAST(Data);
+    if (Info.status == serialization::Status::Valid &&
+        !Info.contentHash.empty()) {
+      hashString(Hash, "module");
+      hashString(Hash, Info.contentHash);
+      return true;
+    }
+  }
+  hashString(Hash, Data);
+  return true;
+}
+
+/// Returns the files after the first target in a make-style dependencies
+/// file, which is how the frontend reports what a job read.
+static std::vector<std::string> parseDependencies(StringRef Data) {
+  StringRef Line = Data.split('\n').first;
+  size_t Colon = Line.find(" :");
+  std::vector<std::string> Result;
+  if (Colon == StringRef::npos)
+    return Result;
+
+  std::string Current;
+  StringRef Rest = Line.substr(Colon + 2);
+  for (size_t i = 0, e = Rest.size(); i != e; ++i) {
+    char C = Rest[i];
+    if (C == '\\' && i + 1 != e) {
+      Current.push_back(Rest[++i]);
+    } else if (C == '$' && i + 1 != e && Rest[i + 1] == '$') {
+      Current.push_back('$');
+      ++i;
+    } else if (C == ' ') {
+      if (!Current.empty())
+        Result.push_back(std::move(Current));
+      Current.clear();
+    } else {
+      Current.push_back(C);
+    }
+  }
+  if (!Current.empty())
+    Result.push_back(std::move(Current));
+  return Result;
+}
+
+/// Appends a named blob to an entry.
+static void appendRecord(std::string &Entry, StringRef Name, StringRef Data) {
+  Entry += Name;
+  Entry.push_back('\n');
+  Entry += llvm::utostr(Data.size());
+  Entry.push_back('\n');
+  Entry += Data;
+}
+
+/// Splits an entry into its named blobs. Returns false if it is malformed.
+static bool readRecords(StringRef Entry, llvm::StringMap<StringRef> &Records) {
+  while (!Entry.empty()) {
+    StringRef Name, SizeString;
+    std::tie(Name, Entry) = Entry.split('\n');
+    std::tie(SizeString, Entry) = Entry.split('\n');
+    size_t Size;
+    if (SizeString.getAsInteger(10, Size) || Size > Entry.size())
+      return false;
+    Records[Name] = Entry.substr(0, Size);
+    Entry = Entry.substr(Size);
+  }
+  return true;
+}
+
+static bool writeFile(StringRef Path, StringRef Data) {
+  std::error_code EC;
+  llvm::raw_fd_ostream Out(Path, EC, llvm::sys::fs::F_None);
+  if (EC)
+    return false;
+  Out << Data;
+  Out.close();
+  return !Out.has_error();
+}
+
+/// Runs the job without the cache: in a compile server if \p JobArgs asks for
+/// one, and in this process otherwise.
+static int runUncached(ArrayRef<const char *> JobArgs, const char *Argv0,
+                       void *MainAddr) {
+  if (StringRef(JobArgs[0]) == "-compile-server-client")
+    return compile_server_client_main(JobArgs.slice(1), Argv0, MainAddr);
+  return frontend_main(JobArgs.slice(1), Argv0, MainAddr);
+}
+
+int compile_cache_main(ArrayRef<const char *> Args, const char *Argv0,
+                       void *MainAddr) {
+  // The job follows the cache: either -frontend <args>, or
+  // -compile-server-client <socket> -frontend <args>.
+  auto FrontendPos = std::find_if(Args.begin(), Args.end(),
+                                  [](const char *Arg) {
+    return StringRef(Arg) == "-frontend";
+  });
+  if (Args.size() < 2 || FrontendPos == Args.end()) {
+    llvm::errs() << "error: expected a cache and a frontend job\n";
+    return 1;
+  }
+  ArrayRef<const char *> JobArgs = Args.slice(1);
+  ArrayRef<const char *> FrontendArgs(FrontendPos + 1, Args.end());
+
+  unsigned MissingIndex;
+  unsigned MissingCount;
+  std::unique_ptr<llvm::opt::OptTable> Table = createSwiftOptTable();
+  InputArgList ParsedArgs =
+      Table->ParseArgs(FrontendArgs, MissingIndex, MissingCount,
+                       options::FrontendOption);
+  std::unique_ptr<CacheBackend> Cache = CacheBackend::create(Args[0]);
+  if (MissingCount || !Cache || !ParsedArgs.hasArg(options::OPT_emit_object) ||
+      ParsedArgs.hasArg(options::OPT_batch_output_file_map) ||
+      ParsedArgs.getLastArgValue(options::OPT_o).empty())
+    return runUncached(JobArgs, Argv0, MainAddr);
+
+  SmallString<128> WorkingDirectory;
+  llvm::sys::fs::current_path(WorkingDirectory);
+
+  // Step 1: the manifest key.
+  llvm::MD5 ManifestHash;
+  hashString(ManifestHash, version::getSwiftFullVersion());
+  hashString(ManifestHash, WorkingDirectory);
+  for (const char *Arg : FrontendArgs)
+    hashString(ManifestHash, Arg);
+  for (const Arg *A : make_range(ParsedArgs.filtered_begin(
+                                   options::OPT_INPUT,
+                                   options::OPT_primary_file),
+                                 ParsedArgs.filtered_end())) {
+    if (StringRef(A->getValue()) == "-" || !hashFile(ManifestHash,
+                                                     A->getValue()))
+      return runUncached(JobArgs, Argv0, MainAddr);
+  }
+  std::string ManifestKey = "m" + finalizeHash(ManifestHash);
+
+  // Step 2: the entry key.
+  auto getEntryKey = [&](ArrayRef<std::string> Dependencies) -> std::string {
+    llvm::MD5 EntryHash;
+    hashString(EntryHash, ManifestKey);
+    for (const std::string &Path : Dependencies) {
+      hashString(EntryHash, Path);
+      if (!hashFile(EntryHash, Path))
+        return std::string();
+    }
+    return "e" + finalizeHash(EntryHash);
+  };
+
+  std::string Manifest;
+  if (Cache->fetch(ManifestKey, Manifest)) {
+    SmallVector<StringRef, 64> Lines;
+    StringRef(Manifest).split(Lines, "\n", -1, /*KeepEmpty=*/false);
+    std::vector<std::string> Dependencies(Lines.begin(), Lines.end());
+    std::string EntryKey = getEntryKey(Dependencies);
+
+    std::string Entry;
+    llvm::StringMap<StringRef> Records;
+    if (!EntryKey.empty() && Cache->fetch(EntryKey, Entry) &&
+        readRecords(Entry, Records)) {
+      bool Restored = true;
+      for (options::ID Output : OutputOptions) {
+        StringRef Path = ParsedArgs.getLastArgValue(Output);
+        if (Path.empty())
+          continue;
+        auto Record = Records.find(Table->getOptionName(Output));
+        if (Record == Records.end() || !writeFile(Path, Record->getValue())) {
+          Restored = false;
+          break;
+        }
+      }
+      if (Restored) {
+        llvm::outs() << Records.lookup("stdout");
+        llvm::errs() << Records.lookup("stderr");
+        return 0;
+      }
+    }
+  }
+
+  // Run the job in a separate process, so that its output can be stored.
+  // If it doesn't report what it read anyway, have it do so into a
+  // temporary file.
+  std::vector<std::string> RunArgs(JobArgs.begin(), JobArgs.end());
+  std::string DependenciesPath =
+    ParsedArgs.getLastArgValue(options::OPT_emit_dependencies_path);
+  SmallString<128> TempDependenciesPath;
+  if (DependenciesPath.empty()) {
+    if (llvm::sys::fs::createTemporaryFile("swift-cache", "d",
+                                           TempDependenciesPath))
+      return runUncached(JobArgs, Argv0, MainAddr);
+    DependenciesPath = TempDependenciesPath.str();
+    RunArgs.push_back("-emit-dependencies-path");
+    RunArgs.push_back(DependenciesPath);
+  }
+
+  SmallString<128> OutPath, ErrPath;
+  llvm::sys::fs::createTemporaryFile("swift-cache", "out", OutPath);
+  llvm::sys::fs::createTemporaryFile("swift-cache", "err", ErrPath);
+  std::string Executable = llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
+  std::vector<const char *> Argv;
+  Argv.push_back(Executable.c_str());
+  for (const std::string &Arg : RunArgs)
+    Argv.push_back(Arg.c_str());
+  Argv.push_back(nullptr);
+  StringRef In, Out(OutPath), Err(ErrPath);
+  const StringRef *Redirects[] = { &In, &Out, &Err };
+  std::string ErrorMessage;
+  int Status = llvm::sys::ExecuteAndWait(Executable, Argv.data(), nullptr,
+                                         Redirects, 0, 0, &ErrorMessage);
+
+  std::string Entry;
+  auto OutBuffer = llvm::MemoryBuffer::getFile(OutPath);
+  auto ErrBuffer = llvm::MemoryBuffer::getFile(ErrPath);
+  StringRef OutData = OutBuffer ? OutBuffer.get()->getBuffer() : "";
+  StringRef ErrData = ErrBuffer ? ErrBuffer.get()->getBuffer() : "";
+  llvm::outs() << OutData;
+  llvm::errs() << ErrData;
+  appendRecord(Entry, "stdout", OutData);
+  appendRecord(Entry, "stderr", ErrData);
+  llvm::sys::fs::remove(OutPath);
+  llvm::sys::fs::remove(ErrPath);
+
+  if (Status != 0) {
+    if (!TempDependenciesPath.empty())
+      llvm::sys::fs::remove(TempDependenciesPath);
+    if (Status < 0) {
+      llvm::errs() << "error: " << ErrorMessage << '\n';
+      return 1;
+    }
+    return Status;
+  }
+
+  std::vector<std::string> Dependencies;
+  if (auto Buffer = llvm::MemoryBuffer::getFile(DependenciesPath))
+    Dependencies = parseDependencies(Buffer.get()->getBuffer());
+  if (!TempDependenciesPath.empty())
+    llvm::sys::fs::remove(TempDependenciesPath);
+  if (Dependencies.empty())
+    return 0;
+
+  for (options::ID Output : OutputOptions) {
+    StringRef Path = ParsedArgs.getLastArgValue(Output);
+    if (Path.empty())
+      continue;
+    auto Buffer = llvm::MemoryBuffer::getFile(Path);
+    if (!Buffer)
+      return 0;
+    appendRecord(Entry, Table->getOptionName(Output),
+                 Buffer.get()->getBuffer());
+  }
+
+  std::string EntryKey = getEntryKey(Dependencies);
+  if (EntryKey.empty())
+    return 0;
+  Cache->store(EntryKey, Entry);
+  std::string NewManifest;
+  for (const std::string &Path : Dependencies) {
+    NewManifest += Path;
+    NewManifest.push_back('\n');
+  }
+  Cache->store(ManifestKey, NewManifest);
+  return 0;
+}
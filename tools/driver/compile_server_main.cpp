@@ -0,0 +1,460 @@
+//===-- compile_server_main.cpp - Long-lived frontend server --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A compile server keeps CompilerInstances around that have loaded the
+// standard library, and optionally other modules, for a set of frontend
+// options. It listens on a Unix domain socket for frontend jobs, and runs
+// each one in a forked copy of the instance for its options, so that the job
+// starts with those modules already loaded. Jobs that differ only in their
+// inputs and outputs share an instance.
+//
+//   swift -compile-server <socket> [-preload <module>]...
+//
+// The driver sends a job to the server when it is given
+// -compile-server-socket <socket>: the job then runs
+//
+//   swift -compile-server-client <socket> -frontend <args>...
+//
+// which passes its working directory, its arguments, and its standard output
+// and error to the server, and exits with the status of the job. If there is
+// no server, the client runs the job itself.
+//
+// Jobs run in the server's environment. The server checks that the files the
+// loaded modules came from are unchanged before it reuses an instance.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/AST/DiagnosticsFrontend.h"
+#include "swift/Frontend/Frontend.h"
+#include "swift/Option/Options.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Option/Option.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <list>
+#include <memory>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace swift;
+
+extern int frontend_main(ArrayRef<const char *> Args, const char *Argv0,
+                         void *MainAddr);
+extern int frontend_main_reusing(ArrayRef<const char *> Args,
+                                 const char *Argv0, void *MainAddr,
+                                 CompilerInstance &ReusedInstance);
+
+/// The most instances the server keeps loaded at once.
+static const size_t MaxReusableInstances = 8;
+
+static bool writeAll(int FD, const void *Data, size_t Size) {
+  auto *Bytes = static_cast<const char *>(Data);
+  while (Size != 0) {
+    ssize_t Written = write(FD, Bytes, Size);
+    if (Written < 0 && errno == EINTR)
+      continue;
+    if (Written <= 0)
+      return false;
+    Bytes += Written;
+    Size -= Written;
+  }
+  return true;
+}
+
+static bool readAll(int FD, void *Data, size_t Size) {
+  auto *Bytes = static_cast<char *>(Data);
+  while (Size != 0) {
+    ssize_t Read = read(FD, Bytes, Size);
+    if (Read < 0 && errno == EINTR)
+      continue;
+    if (Read <= 0)
+      return false;
+    Bytes += Read;
+    Size -= Read;
+  }
+  return true;
+}
+
+/// Fills in the address of the socket at \p Path. Returns false if the path
+/// is too long.
+static bool getSocketAddress(StringRef Path, sockaddr_un &Address) {
+  memset(&Address, 0, sizeof(Address));
+  Address.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Address.sun_path))
+    return false;
+  memcpy(Address.sun_path, Path.data(), Path.size());
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Client
+//===----------------------------------------------------------------------===//
+
+// A request is a 32-bit length, sent together with the client's standard
+// output and error, followed by that many bytes: the working directory and
+// the frontend arguments, each terminated by a NUL. The reply is the 32-bit
+// exit status of the job.
+
+int compile_server_client_main(ArrayRef<const char *> Args, const char *Argv0,
+                               void *MainAddr) {
+  if (Args.size() < 2 || StringRef(Args[1]) != "-frontend") {
+    llvm::errs() << "error: expected a socket path and a frontend job\n";
+    return 1;
+  }
+  StringRef SocketPath = Args[0];
+  ArrayRef<const char *> FrontendArgs = Args.slice(2);
+
+  sockaddr_un Address;
+  if (!getSocketAddress(SocketPath, Address)) {
+    llvm::errs() << "error: compile server socket path is too long: "
+                 << SocketPath << '\n';
+    return 1;
+  }
+
+  int FD = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (FD < 0 ||
+      connect(FD, reinterpret_cast<sockaddr *>(&Address),
+              sizeof(Address)) != 0) {
+    // Without a server, the job still has to run.
+    if (FD >= 0)
+      close(FD);
+    return frontend_main(FrontendArgs, Argv0, MainAddr);
+  }
+
+  SmallString<128> WorkingDirectory;
+  llvm::sys::fs::current_path(WorkingDirectory);
+  std::string Payload = WorkingDirectory.str();
+  Payload.push_back('\0');
+  for (const char *Arg : FrontendArgs) {
+    Payload += Arg;
+    Payload.push_back('\0');
+  }
+
+  uint32_t PayloadSize = Payload.size();
+  int StandardFDs[2] = { STDOUT_FILENO, STDERR_FILENO };
+  iovec Vector = { &PayloadSize, sizeof(PayloadSize) };
+  char Control[CMSG_SPACE(sizeof(StandardFDs))];
+  msghdr Message;
+  memset(&Message, 0, sizeof(Message));
+  Message.msg_iov = &Vector;
+  Message.msg_iovlen = 1;
+  Message.msg_control = Control;
+  Message.msg_controllen = sizeof(Control);
+  cmsghdr *Header = CMSG_FIRSTHDR(&Message);
+  Header->cmsg_level = SOL_SOCKET;
+  Header->cmsg_type = SCM_RIGHTS;
+  Header->cmsg_len = CMSG_LEN(sizeof(StandardFDs));
+  memcpy(CMSG_DATA(Header), StandardFDs, sizeof(StandardFDs));
+
+  int32_t Status;
+  if (sendmsg(FD, &Message, 0) != sizeof(PayloadSize) ||
+      !writeAll(FD, Payload.data(), Payload.size()) ||
+      !readAll(FD, &Status, sizeof(Status))) {
+    llvm::errs() << "error: compile server at " << SocketPath
+                 << " did not complete the job\n";
+    close(FD);
+    return 1;
+  }
+  close(FD);
+  return Status;
+}
+
+//===----------------------------------------------------------------------===//
+// Server
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// A CompilerInstance that has loaded the modules for some options.
+struct ReusableInstance {
+  CompilerInstance Instance;
+  DependencyTracker Tracker;
+
+  /// The files the loaded modules came from, and their modification times.
+  std::vector<std::pair<std::string, llvm::sys::TimeValue>> Dependencies;
+
+  /// Returns true if none of the files the loaded modules came from changed
+  /// since they were loaded.
+  bool isUpToDate() const {
+    for (auto &Dependency : Dependencies) {
+      llvm::sys::fs::file_status Status;
+      if (llvm::sys::fs::status(Dependency.first, Status) ||
+          Status.getLastModificationTime() != Dependency.second)
+        return false;
+    }
+    return true;
+  }
+};
+
+/// A job that was read from a client.
+struct Request {
+  std::string WorkingDirectory;
+  std::vector<std::string> Arguments;
+  int OutputFD = -1;
+  int ErrorFD = -1;
+
+  ~Request() {
+    if (OutputFD >= 0)
+      close(OutputFD);
+    if (ErrorFD >= 0)
+      close(ErrorFD);
+  }
+};
+
+class CompileServer {
+  const char *Argv0;
+  void *MainAddr;
+  std::vector<std::string> PreloadModules;
+
+  /// Loaded instances by reuse key, the most recently used first. An entry
+  /// without an instance marks options whose jobs run without one.
+  std::list<std::pair<std::string, std::unique_ptr<ReusableInstance>>>
+    Instances;
+
+  ReusableInstance *getInstance(const Request &R,
+                                ArrayRef<const char *> Args);
+  std::unique_ptr<ReusableInstance> createInstance(
+      const Request &R, ArrayRef<const char *> Args);
+
+public:
+  CompileServer(const char *Argv0, void *MainAddr,
+                std::vector<std::string> PreloadModules)
+    : Argv0(Argv0), MainAddr(MainAddr),
+      PreloadModules(std::move(PreloadModules)) {}
+
+  bool readRequest(int FD, Request &R);
+  void runJob(int ListenFD, int FD, Request &R);
+};
+
+} // end anonymous namespace
+
+/// Returns the arguments of a frontend job with the ones naming its inputs
+/// and outputs removed, and the working directory that relative paths in them
+/// are resolved against. Jobs with the same key can share an instance.
+static std::string computeReuseKey(ArrayRef<const char *> Args,
+                                   StringRef WorkingDirectory) {
+  using namespace options;
+
+  unsigned MissingIndex;
+  unsigned MissingCount;
+  std::unique_ptr<llvm::opt::OptTable> Table = createSwiftOptTable();
+  llvm::opt::InputArgList ParsedArgs =
+      Table->ParseArgs(Args, MissingIndex, MissingCount, FrontendOption);
+
+  std::string Key = WorkingDirectory;
+  for (const llvm::opt::Arg *A : ParsedArgs) {
+    switch (A->getOption().getID()) {
+    case OPT_INPUT:
+    case OPT_primary_file:
+    case OPT_o:
+    case OPT_emit_module_path:
+    case OPT_emit_module_doc_path:
+    case OPT_emit_dependencies_path:
+    case OPT_emit_reference_dependencies_path:
+    case OPT_emit_objc_header_path:
+    case OPT_serialize_diagnostics_path:
+    case OPT_batch_output_file_map:
+      continue;
+    default:
+      break;
+    }
+    Key.push_back('\0');
+    Key += A->getAsString(ParsedArgs);
+  }
+  return Key;
+}
+
+bool CompileServer::readRequest(int FD, Request &R) {
+  uint32_t PayloadSize;
+  int FDs[2];
+  iovec Vector = { &PayloadSize, sizeof(PayloadSize) };
+  char Control[CMSG_SPACE(sizeof(FDs))];
+  msghdr Message;
+  memset(&Message, 0, sizeof(Message));
+  Message.msg_iov = &Vector;
+  Message.msg_iovlen = 1;
+  Message.msg_control = Control;
+  Message.msg_controllen = sizeof(Control);
+  if (recvmsg(FD, &Message, 0) != sizeof(PayloadSize))
+    return false;
+
+  cmsghdr *Header = CMSG_FIRSTHDR(&Message);
+  if (!Header || Header->cmsg_level != SOL_SOCKET ||
+      Header->cmsg_type != SCM_RIGHTS ||
+      Header->cmsg_len != CMSG_LEN(sizeof(FDs)))
+    return false;
+  memcpy(FDs, CMSG_DATA(Header), sizeof(FDs));
+  R.OutputFD = FDs[0];
+  R.ErrorFD = FDs[1];
+
+  std::string Payload(PayloadSize, '\0');
+  if (!readAll(FD, &Payload[0], PayloadSize))
+    return false;
+
+  StringRef Rest = Payload;
+  std::tie(R.WorkingDirectory, Rest) = Rest.split('\0');
+  while (!Rest.empty()) {
+    StringRef Arg;
+    std::tie(Arg, Rest) = Rest.split('\0');
+    R.Arguments.push_back(Arg);
+  }
+  return true;
+}
+
+std::unique_ptr<ReusableInstance>
+CompileServer::createInstance(const Request &R, ArrayRef<const char *> Args) {
+  // Relative search paths are relative to the job's working directory.
+  if (chdir(R.WorkingDirectory.c_str()) != 0)
+    return nullptr;
+
+  std::unique_ptr<ReusableInstance> Result(new ReusableInstance());
+  CompilerInstance &Instance = Result->Instance;
+  CompilerInvocation Invocation;
+  Invocation.setMainExecutablePath(
+    llvm::sys::fs::getMainExecutable(Argv0, MainAddr));
+  if (Invocation.parseArgs(Args, Instance.getDiags(), R.WorkingDirectory))
+    return nullptr;
+
+  // -Xllvm options are process-wide, so they can't differ between the jobs
+  // of one server; such jobs parse them in their own process instead.
+  const FrontendOptions &Opts = Invocation.getFrontendOptions();
+  if (!Opts.LLVMArgs.empty() || Opts.actionIsImmediate() ||
+      Opts.RequestedAction == FrontendOptions::REPL ||
+      Opts.RequestedAction == FrontendOptions::NoneAction)
+    return nullptr;
+
+  Instance.setDependencyTracker(&Result->Tracker);
+  if (Instance.setupForReuse(Invocation, PreloadModules))
+    return nullptr;
+
+  for (StringRef Path : Result->Tracker.getDependencies()) {
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(Path, Status))
+      return nullptr;
+    Result->Dependencies.push_back({Path, Status.getLastModificationTime()});
+  }
+  return Result;
+}
+
+ReusableInstance *CompileServer::getInstance(const Request &R,
+                                             ArrayRef<const char *> Args) {
+  std::string Key = computeReuseKey(Args, R.WorkingDirectory);
+  for (auto I = Instances.begin(), E = Instances.end(); I != E; ++I) {
+    if (I->first != Key)
+      continue;
+    if (I->second && !I->second->isUpToDate()) {
+      Instances.erase(I);
+      break;
+    }
+    Instances.splice(Instances.begin(), Instances, I);
+    return I->second.get();
+  }
+
+  Instances.emplace_front(Key, createInstance(R, Args));
+  if (Instances.size() > MaxReusableInstances)
+    Instances.pop_back();
+  return Instances.front().second.get();
+}
+
+void CompileServer::runJob(int ListenFD, int FD, Request &R) {
+  std::vector<const char *> Args;
+  for (const std::string &Arg : R.Arguments)
+    Args.push_back(Arg.c_str());
+  ReusableInstance *Reusable = getInstance(R, Args);
+
+  if (fork() != 0)
+    return;
+
+  // The job runs in a copy of the server, which the forked process is. It
+  // writes to the client's output instead of the server's.
+  close(ListenFD);
+  dup2(R.OutputFD, STDOUT_FILENO);
+  dup2(R.ErrorFD, STDERR_FILENO);
+
+  int32_t Status = 1;
+  if (chdir(R.WorkingDirectory.c_str()) != 0) {
+    llvm::errs() << "error: cannot change to " << R.WorkingDirectory << ": "
+                 << strerror(errno) << '\n';
+  } else if (Reusable) {
+    Status = frontend_main_reusing(Args, Argv0, MainAddr, Reusable->Instance);
+  } else {
+    Status = frontend_main(Args, Argv0, MainAddr);
+  }
+  llvm::outs().flush();
+  writeAll(FD, &Status, sizeof(Status));
+  exit(Status);
+}
+
+int compile_server_main(ArrayRef<const char *> Args, const char *Argv0,
+                        void *MainAddr) {
+  std::vector<std::string> PreloadModules;
+  for (size_t i = 1; i < Args.size(); i += 2) {
+    if (StringRef(Args[i]) != "-preload" || i + 1 == Args.size()) {
+      llvm::errs() << "error: unexpected argument: " << Args[i] << '\n';
+      return 1;
+    }
+    PreloadModules.push_back(Args[i + 1]);
+  }
+  if (Args.empty()) {
+    llvm::errs() << "usage: swift -compile-server <socket> "
+                    "[-preload <module>]...\n";
+    return 1;
+  }
+
+  StringRef SocketPath = Args[0];
+  sockaddr_un Address;
+  if (!getSocketAddress(SocketPath, Address)) {
+    llvm::errs() << "error: socket path is too long: " << SocketPath << '\n';
+    return 1;
+  }
+
+  // Only the user running the server may submit jobs to it.
+  umask(077);
+  unlink(Address.sun_path);
+  int ListenFD = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (ListenFD < 0 ||
+      bind(ListenFD, reinterpret_cast<sockaddr *>(&Address),
+           sizeof(Address)) != 0 ||
+      listen(ListenFD, SOMAXCONN) != 0) {
+    llvm::errs() << "error: cannot listen on " << SocketPath << ": "
+                 << strerror(errno) << '\n';
+    return 1;
+  }
+
+  // Jobs report their status to their clients; nobody waits for them.
+  signal(SIGCHLD, SIG_IGN);
+  signal(SIGPIPE, SIG_IGN);
+
+  CompileServer Server(Argv0, MainAddr, std::move(PreloadModules));
+  while (true) {
+    int FD = accept(ListenFD, nullptr, nullptr);
+    if (FD < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      llvm::errs() << "error: cannot accept a job: " << strerror(errno)
+                   << '\n';
+      return 1;
+    }
+    Request R;
+    if (Server.readRequest(FD, R))
+      Server.runJob(ListenFD, FD, R);
+    close(FD);
+  }
+}
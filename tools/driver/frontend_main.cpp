@@ -18,16 +18,22 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Subsystems.h"
+#include "swift/AST/ASTMemoryStatistics.h"
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/Mangle.h"
 #include "swift/AST/NameLookup.h"
 #include "swift/AST/ReferencedNameTracker.h"
+#include "swift/AST/TypeCheckTimingReport.h"
 #include "swift/AST/TypeRefinementContext.h"
+#include "swift/Basic/CompileTimeTrace.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/FileSystem.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/ClangImporter/ClangImporter.h"
+#include "swift/Driver/OutputFileMap.h"
+#include "swift/Driver/Types.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
@@ -172,6 +178,148 @@ static void mangleTypeAsContext(StreamTy &&out, const NominalTypeDecl *type) {
   mangler.mangleContext(type, Mangle::Mangler::BindGenerics::None);
 }
 
+namespace {
+/// Accumulates the fingerprint of a provided name from the interface hashes
+/// of the declarations that contribute to it.
+///
+/// If any of those declarations has no hash, the name gets no fingerprint,
+/// and the driver treats any change to the file as a change to the name.
+class FingerprintBuilder {
+  llvm::MD5 Hash;
+  bool IsValid = true;
+
+public:
+  void invalidate() { IsValid = false; }
+
+  void addFull(const SourceFile *SF, const Decl *D) {
+    if (auto *hash = SF->getDeclInterfaceHash(D))
+      Hash.update(hash->Full);
+    else
+      invalidate();
+  }
+
+  void addOwn(const SourceFile *SF, const Decl *D) {
+    if (auto *hash = SF->getDeclInterfaceHash(D))
+      Hash.update(hash->Own);
+    else
+      invalidate();
+  }
+
+  void add(FingerprintBuilder other) {
+    llvm::MD5::MD5Result result;
+    if (other.finish(result))
+      Hash.update(result);
+    else
+      invalidate();
+  }
+
+  bool finish(llvm::MD5::MD5Result &result) {
+    if (!IsValid)
+      return false;
+    Hash.final(result);
+    return true;
+  }
+
+  bool finish(llvm::SmallString<32> &str) {
+    llvm::MD5::MD5Result result;
+    if (!finish(result))
+      return false;
+    llvm::MD5::stringifyResult(result, str);
+    return true;
+  }
+};
+
+/// The fingerprints of a type declared or extended in a source file.
+struct NominalFingerprints {
+  /// Covers everything that affects how other files use the type as a whole:
+  /// its kind, name, generic signature, and inheritance clauses, as well as
+  /// its stored properties, enum cases, protocol requirements, and
+  /// overridable class members.
+  FingerprintBuilder Layout;
+
+  /// Covers everything about the type in this file.
+  FingerprintBuilder Whole;
+
+  struct Member {
+    FingerprintBuilder Fingerprint;
+    bool IsProvided = false;
+  };
+
+  /// The non-private members of the type in this file, by name.
+  llvm::MapVector<Identifier, Member> Members;
+};
+} // end anonymous namespace
+
+/// Returns true if a change to \p member may change the way other files must
+/// use \p type, even if they don't refer to \p member at all.
+static bool memberAffectsTypeLayout(const NominalTypeDecl *type,
+                                    const Decl *member) {
+  if (isa<IfConfigDecl>(member) || isa<ProtocolDecl>(type))
+    return true;
+
+  if (isa<EnumDecl>(type))
+    return isa<EnumCaseDecl>(member) || isa<EnumElementDecl>(member);
+
+  if (isa<ClassDecl>(type)) {
+    if (isa<TypeDecl>(member))
+      return false;
+    if (auto *VD = dyn_cast<ValueDecl>(member))
+      return !VD->isFinal() || (isa<VarDecl>(VD) && !VD->isStatic() &&
+                                cast<VarDecl>(VD)->hasStorage());
+    return true;
+  }
+
+  if (auto *PBD = dyn_cast<PatternBindingDecl>(member))
+    return !PBD->isStatic() && PBD->hasStorage();
+  if (auto *VD = dyn_cast<VarDecl>(member))
+    return !VD->isStatic() && VD->hasStorage();
+  return false;
+}
+
+static NominalFingerprints
+computeNominalFingerprints(const SourceFile *SF, const NominalTypeDecl *NTD,
+                           ArrayRef<std::pair<const ExtensionDecl *, bool>>
+                             extensions) {
+  NominalFingerprints result;
+
+  SmallVector<DeclRange, 4> memberLists;
+  if (NTD->getParentSourceFile() == SF) {
+    result.Layout.addOwn(SF, NTD);
+    result.Whole.addFull(SF, NTD);
+    for (auto *member : NTD->getMembers(/*forceDelayed=*/false))
+      if (memberAffectsTypeLayout(NTD, member))
+        result.Layout.addFull(SF, member);
+    memberLists.push_back(NTD->getMembers(/*forceDelayed=*/false));
+  }
+
+  for (auto &entry : extensions) {
+    // Only extensions that add conformances change the type as a whole.
+    if (entry.second)
+      result.Layout.addOwn(SF, entry.first);
+    result.Whole.addFull(SF, entry.first);
+    memberLists.push_back(entry.first->getMembers(/*forceDelayed=*/false));
+  }
+
+  for (DeclRange members : memberLists) {
+    for (auto *member : members) {
+      auto *VD = dyn_cast<ValueDecl>(member);
+      if (!VD || !VD->hasName() ||
+          VD->getFormalAccess() == Accessibility::Private) {
+        continue;
+      }
+      auto &fingerprint = result.Members[VD->getName()].Fingerprint;
+      // Implicit members, like a memberwise initializer, are derived from
+      // the rest of the type.
+      if (VD->isImplicit() && !SF->getDeclInterfaceHash(VD))
+        fingerprint.add(result.Layout);
+      else
+        fingerprint.addFull(SF, VD);
+    }
+  }
+
+  return result;
+}
+
 /// Emits a Swift-style dependencies file.
 static bool emitReferenceDependencies(DiagnosticEngine &diags,
                                       SourceFile *SF,
@@ -202,6 +350,13 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
 
   llvm::MapVector<const NominalTypeDecl *, bool> extendedNominals;
   llvm::SmallVector<const ExtensionDecl *, 8> extensionsWithJustMembers;
+  // For each extended type, its extensions in this file and whether they add
+  // conformances.
+  llvm::DenseMap<const NominalTypeDecl *,
+                 SmallVector<std::pair<const ExtensionDecl *, bool>, 2>>
+    extensionsByNominal;
+  llvm::MapVector<Identifier, FingerprintBuilder> topLevelFingerprints;
+  llvm::SmallVector<const NominalTypeDecl *, 8> topLevelNominals;
 
   out << "provides-top-level:\n";
   for (const Decl *D : SF->Decls) {
@@ -235,15 +390,19 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         }
       }
       extendedNominals[NTD] |= !justMembers;
+      extensionsByNominal[NTD].push_back({ED, !justMembers});
       findNominals(extendedNominals, ED->getMembers());
       break;
     }
 
     case DeclKind::InfixOperator:
     case DeclKind::PrefixOperator:
-    case DeclKind::PostfixOperator:
-      out << "- \"" << escape(cast<OperatorDecl>(D)->getName()) << "\"\n";
+    case DeclKind::PostfixOperator: {
+      auto *OD = cast<OperatorDecl>(D);
+      out << "- \"" << escape(OD->getName()) << "\"\n";
+      topLevelFingerprints[OD->getName()].addFull(SF, OD);
       break;
+    }
 
     case DeclKind::Enum:
     case DeclKind::Struct:
@@ -257,6 +416,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         break;
       }
       out << "- \"" << escape(NTD->getName()) << "\"\n";
+      topLevelNominals.push_back(NTD);
       extendedNominals[NTD] |= true;
       findNominals(extendedNominals, NTD->getMembers());
       break;
@@ -273,6 +433,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         break;
       }
       out << "- \"" << escape(VD->getName()) << "\"\n";
+      topLevelFingerprints[VD->getName()].addFull(SF, VD);
       break;
     }
 
@@ -294,6 +455,17 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     }
   }
 
+  llvm::DenseMap<const NominalTypeDecl *, NominalFingerprints>
+    nominalFingerprints;
+  for (auto entry : extendedNominals) {
+    nominalFingerprints[entry.first] =
+      computeNominalFingerprints(SF, entry.first,
+                                 extensionsByNominal.lookup(entry.first));
+  }
+  // Using a type by name can depend on any part of its layout.
+  for (auto *NTD : topLevelNominals)
+    topLevelFingerprints[NTD->getName()].add(nominalFingerprints[NTD].Layout);
+
   out << "provides-nominal:\n";
   for (auto entry : extendedNominals) {
     if (!entry.second)
@@ -324,6 +496,23 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
       }
       out << "- [\"" << mangledName.str() << "\", \""
           << escape(VD->getName()) << "\"]\n";
+      auto *NTD = ED->getExtendedType()->getAnyNominal();
+      nominalFingerprints[NTD].Members[VD->getName()].IsProvided = true;
+    }
+  }
+
+  // This is also part of "provides-member". Providing members of types
+  // declared here individually lets the driver tell which ones changed.
+  for (auto entry : extendedNominals) {
+    SmallString<32> mangledName;
+    mangleTypeAsContext(llvm::raw_svector_ostream(mangledName), entry.first);
+
+    for (auto &member : nominalFingerprints[entry.first].Members) {
+      if (member.second.IsProvided)
+        continue;
+      out << "- [\"" << mangledName.str() << "\", \""
+          << escape(member.first) << "\"]\n";
+      member.second.IsProvided = true;
     }
   }
 
@@ -440,6 +629,49 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   SF->getInterfaceHash(interfaceHash);
   out << "interface-hash: \"" << interfaceHash << "\"\n";
 
+  // Fingerprints let the driver tell which of the names provided above
+  // changed when the interface hash does.
+  llvm::SmallString<32> fingerprint;
+  out << "fingerprints-top-level:\n";
+  for (auto &entry : topLevelFingerprints) {
+    fingerprint.clear();
+    if (entry.second.finish(fingerprint)) {
+      out << "- [\"" << escape(entry.first) << "\", \"" << fingerprint
+          << "\"]\n";
+    }
+  }
+
+  out << "fingerprints-nominal:\n";
+  for (auto entry : extendedNominals) {
+    fingerprint.clear();
+    if (!entry.second ||
+        !nominalFingerprints[entry.first].Layout.finish(fingerprint))
+      continue;
+    out << "- [\"";
+    mangleTypeAsContext(out, entry.first);
+    out << "\", \"" << fingerprint << "\"]\n";
+  }
+
+  out << "fingerprints-member:\n";
+  for (auto entry : extendedNominals) {
+    SmallString<32> mangledName;
+    mangleTypeAsContext(llvm::raw_svector_ostream(mangledName), entry.first);
+
+    auto &fingerprints = nominalFingerprints[entry.first];
+    fingerprint.clear();
+    if (fingerprints.Whole.finish(fingerprint)) {
+      out << "- [\"" << mangledName.str() << "\", \"\", \"" << fingerprint
+          << "\"]\n";
+    }
+    for (auto &member : fingerprints.Members) {
+      fingerprint.clear();
+      if (!member.second.Fingerprint.finish(fingerprint))
+        continue;
+      out << "- [\"" << mangledName.str() << "\", \""
+          << escape(member.first) << "\", \"" << fingerprint << "\"]\n";
+    }
+  }
+
   return false;
 }
 
@@ -457,10 +689,29 @@ static bool writeSIL(SILModule &SM, Module *M, bool EmitVerboseSIL,
   return false;
 }
 
+/// Prints the Objective-C header for \p M, or only for \p onlyFile if given.
+/// If \p partialHeaderPaths is non-empty, the header is merged from those
+/// partial headers instead.
 static bool printAsObjC(const std::string &outputPath, Module *M,
-                        StringRef bridgingHeader, bool moduleIsPublic) {
+                        StringRef bridgingHeader, bool moduleIsPublic,
+                        const SourceFile *onlyFile,
+                        ArrayRef<std::string> partialHeaderPaths) {
   using namespace llvm::sys;
 
+  // Read the partial headers first, so that a missing one doesn't clobber
+  // the existing header.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> partialHeaders;
+  for (auto &path : partialHeaderPaths) {
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer) {
+      M->getASTContext().Diags.diagnose(SourceLoc(),
+                                        diag::error_open_input_file,
+                                        path, buffer.getError().message());
+      return true;
+    }
+    partialHeaders.push_back(std::move(buffer.get()));
+  }
+
   clang::CompilerInstance Clang;
 
   std::string tmpFilePath;
@@ -482,9 +733,23 @@ static bool printAsObjC(const std::string &outputPath, Module *M,
     return true;
   }
 
-  auto requiredAccess = moduleIsPublic ? Accessibility::Public
-                                       : Accessibility::Internal;
-  bool hadError = printAsObjC(*out, M, bridgingHeader, requiredAccess);
+  bool hadError;
+  if (!partialHeaders.empty()) {
+    SmallVector<StringRef, 16> contents;
+    for (auto &buffer : partialHeaders)
+      contents.push_back(buffer->getBuffer());
+    hadError = mergeObjCHeaders(*out, contents);
+    if (hadError) {
+      M->getASTContext().Diags.diagnose(SourceLoc(),
+                                        diag::error_parse_input_file,
+                                        outputPath,
+                                        "malformed partial Objective-C header");
+    }
+  } else {
+    auto requiredAccess = moduleIsPublic ? Accessibility::Public
+                                         : Accessibility::Internal;
+    hadError = printAsObjC(*out, M, bridgingHeader, requiredAccess, onlyFile);
+  }
   out->flush();
 
   EC = swift::moveFileIfDifferent(tmpFilePath, outputPath);
@@ -609,6 +874,16 @@ static void debugFailWithCrash() {
   LLVM_BUILTIN_TRAP;
 }
 
+static bool performCompileStepsPostSema(CompilerInstance &Instance,
+                                        CompilerInvocation &Invocation,
+                                        const FrontendOptions &opts,
+                                        SourceFile *PrimarySourceFile,
+                                        int &ReturnValue);
+static bool performBatchCompile(CompilerInstance &Instance,
+                                CompilerInvocation &Invocation,
+                                const FrontendOptions &opts,
+                                int &ReturnValue);
+
 /// Performs the compile requested by the user.
 /// \returns true on error
 static bool performCompile(CompilerInstance &Instance,
@@ -620,6 +895,13 @@ static bool performCompile(CompilerInstance &Instance,
 
   IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
 
+  if (Action == FrontendOptions::EmitPCH) {
+    auto clangImporter = static_cast<ClangImporter *>(
+      Instance.getASTContext().getClangModuleLoader());
+    return clangImporter->emitBridgingPCH(Invocation.getInputFilenames()[0],
+                                          opts.getSingleOutputFilename());
+  }
+
   bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
   if (inputIsLLVMIr) {
     auto &LLVMContext = llvm::getGlobalContext();
@@ -659,15 +941,20 @@ static bool performCompile(CompilerInstance &Instance,
   }
 
   ReferencedNameTracker nameTracker;
-  bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
-  if (shouldTrackReferences)
+  // In batch mode, the reference dependencies paths are in the output file
+  // map, so always track references.
+  if (!opts.ReferenceDependenciesFilePath.empty() ||
+      !opts.BatchPrimaryInputs.empty())
     Instance.setReferencedNameTracker(&nameTracker);
 
-  if (Action == FrontendOptions::DumpParse ||
-      Action == FrontendOptions::DumpInterfaceHash)
-    Instance.performParseOnly();
-  else
-    Instance.performSema();
+  {
+    CompileTimeTraceScope traceScope("frontend", "Sema");
+    if (Action == FrontendOptions::DumpParse ||
+        Action == FrontendOptions::DumpInterfaceHash)
+      Instance.performParseOnly();
+    else
+      Instance.performSema();
+  }
 
   FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
   if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
@@ -713,12 +1000,34 @@ static bool performCompile(CompilerInstance &Instance,
   if (opts.PrintClangStats && Context.getClangModuleLoader())
     Context.getClangModuleLoader()->printStatistics();
 
+  if (opts.PrintASTMemoryStats)
+    printASTMemoryStatistics(Instance.getMainModule(), llvm::errs());
+
+  if (!opts.BatchPrimaryInputs.empty())
+    return performBatchCompile(Instance, Invocation, opts, ReturnValue);
+
+  return performCompileStepsPostSema(Instance, Invocation, opts,
+                                     PrimarySourceFile, ReturnValue);
+}
+
+/// Produces the outputs requested by \p opts for \p PrimarySourceFile, or for
+/// the whole module if it is null, from the type-checked AST.
+/// \returns true on error
+static bool performCompileStepsPostSema(CompilerInstance &Instance,
+                                        CompilerInvocation &Invocation,
+                                        const FrontendOptions &opts,
+                                        SourceFile *PrimarySourceFile,
+                                        int &ReturnValue) {
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+  IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
+  ASTContext &Context = Instance.getASTContext();
+
   if (!opts.DependenciesFilePath.empty())
     (void)emitMakeDependencies(Context.Diags, *Instance.getDependencyTracker(),
                                opts);
 
-  if (shouldTrackReferences)
-    emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
+  if (!opts.ReferenceDependenciesFilePath.empty())
+    emitReferenceDependencies(Context.Diags, PrimarySourceFile,
                               *Instance.getDependencyTracker(), opts);
 
   if (Context.hadError())
@@ -735,7 +1044,10 @@ static bool performCompile(CompilerInstance &Instance,
   if (Action == FrontendOptions::Parse) {
     if (!opts.ObjCHeaderOutputPath.empty())
       return printAsObjC(opts.ObjCHeaderOutputPath, Instance.getMainModule(),
-                         opts.ImplicitObjCHeaderPath, moduleIsPublic);
+                         opts.ImplicitObjCHeaderPath, moduleIsPublic,
+                         opts.EmitPartialObjCHeader ? PrimarySourceFile
+                                                    : nullptr,
+                         opts.PartialObjCHeaderPaths);
     return false;
   }
 
@@ -744,6 +1056,7 @@ static bool performCompile(CompilerInstance &Instance,
 
   std::unique_ptr<SILModule> SM = Instance.takeSILModule();
   if (!SM) {
+    CompileTimeTraceScope traceScope("frontend", "SILGen");
     if (opts.PrimaryInput.hasValue() && opts.PrimaryInput.getValue().isFilename()) {
       FileUnit *PrimaryFile = PrimarySourceFile;
       if (!PrimaryFile) {
@@ -757,6 +1070,9 @@ static bool performCompile(CompilerInstance &Instance,
                                 opts.SILSerializeAll,
                                 true);
     }
+
+    if (opts.ReleaseLookupCachesAfterSILGen)
+      Instance.getMainModule()->releaseLookupCaches();
   }
 
   // We've been told to emit SIL after SILGen, so write it now.
@@ -787,9 +1103,11 @@ static bool performCompile(CompilerInstance &Instance,
   }
 
   // Perform "stable" optimizations that are invariant across compiler versions.
-  if (!Invocation.getDiagnosticOptions().SkipDiagnosticPasses &&
-      runSILDiagnosticPasses(*SM))
-    return true;
+  if (!Invocation.getDiagnosticOptions().SkipDiagnosticPasses) {
+    CompileTimeTraceScope traceScope("frontend", "SIL diagnostic passes");
+    if (runSILDiagnosticPasses(*SM))
+      return true;
+  }
 
   // Now if we are asked to link all, link all.
   if (Invocation.getSILOptions().LinkMode == SILOptions::LinkAll)
@@ -799,6 +1117,7 @@ static bool performCompile(CompilerInstance &Instance,
 
   // Perform SIL optimization passes if optimizations haven't been disabled.
   // These may change across compiler versions.
+  CompileTimeTraceScope optimizationTraceScope("frontend", "SIL optimization");
   if (IRGenOpts.Optimize) {
     StringRef CustomPipelinePath =
       Invocation.getSILOptions().ExternalPassPipelineFilename;
@@ -811,6 +1130,7 @@ static bool performCompile(CompilerInstance &Instance,
     runSILPassesForOnone(*SM);
   }
   SM->verify();
+  optimizationTraceScope.finish();
 
   // Gather instruction counts if we are asked to do so.
   if (SM->getOptions().PrintInstCounts) {
@@ -827,7 +1147,9 @@ static bool performCompile(CompilerInstance &Instance,
 
   if (!opts.ObjCHeaderOutputPath.empty()) {
     (void)printAsObjC(opts.ObjCHeaderOutputPath, Instance.getMainModule(),
-                      opts.ImplicitObjCHeaderPath, moduleIsPublic);
+                      opts.ImplicitObjCHeaderPath, moduleIsPublic,
+                      opts.EmitPartialObjCHeader ? PrimarySourceFile : nullptr,
+                      opts.PartialObjCHeaderPaths);
   }
 
   if (Action == FrontendOptions::EmitSIB) {
@@ -852,6 +1174,9 @@ static bool performCompile(CompilerInstance &Instance,
       serializationOpts.OutputPath = opts.ModuleOutputPath.c_str();
       serializationOpts.DocOutputPath = opts.ModuleDocOutputPath.c_str();
       serializationOpts.SerializeAllSIL = opts.SILSerializeAll;
+      serializationOpts.SerializeGenericSIL = opts.SILSerializeGenerics;
+      serializationOpts.SerializeGenericSILLimit =
+          opts.SILSerializeGenericsLimit;
       if (opts.SerializeBridgingHeader)
         serializationOpts.ImportedHeader = opts.ImplicitObjCHeaderPath;
       serializationOpts.ModuleLinkName = opts.ModuleLinkName;
@@ -922,6 +1247,91 @@ static bool performCompile(CompilerInstance &Instance,
   return false;
 }
 
+/// Returns the output file map entry that holds the primary output of
+/// \p Action in batch mode.
+static driver::types::ID getBatchPrimaryOutputType(
+    FrontendOptions::ActionType Action) {
+  using namespace driver;
+  switch (Action) {
+  case FrontendOptions::EmitObject: return types::TY_Object;
+  case FrontendOptions::EmitAssembly: return types::TY_Assembly;
+  case FrontendOptions::EmitIR: return types::TY_LLVM_IR;
+  case FrontendOptions::EmitBC: return types::TY_LLVM_BC;
+  case FrontendOptions::EmitSIL: return types::TY_SIL;
+  case FrontendOptions::EmitSILGen: return types::TY_RawSIL;
+  case FrontendOptions::EmitSIB: return types::TY_SIB;
+  case FrontendOptions::EmitSIBGen: return types::TY_RawSIB;
+  default: return types::TY_Nothing;
+  }
+}
+
+/// Produces the outputs for each primary input of a batch in turn.
+///
+/// All of the primary inputs have already been type-checked together, so the
+/// standard library, imported Clang modules, and the other files in the module
+/// are only loaded once for the whole batch.
+/// \returns true on error
+static bool performBatchCompile(CompilerInstance &Instance,
+                                CompilerInvocation &Invocation,
+                                const FrontendOptions &opts,
+                                int &ReturnValue) {
+  using namespace driver;
+  DiagnosticEngine &Diags = Instance.getDiags();
+
+  auto OFM = OutputFileMap::loadFromPath(opts.BatchOutputFileMapPath);
+  if (!OFM) {
+    Diags.diagnose(SourceLoc(), diag::error_batch_output_file_map,
+                   opts.BatchOutputFileMapPath);
+    return true;
+  }
+
+  types::ID PrimaryOutputType = getBatchPrimaryOutputType(opts.RequestedAction);
+
+  // IRGen adds per-file information to its options, so start every primary
+  // file from the options we were given.
+  const IRGenOptions OriginalIRGenOpts = Invocation.getIRGenOptions();
+
+  bool HadError = false;
+  for (const SelectedInput &Primary : opts.BatchPrimaryInputs) {
+    assert(Primary.isFilename() && "batch mode only supports input files");
+    StringRef Filename = opts.InputFilenames[Primary.Index];
+
+    const TypeToPathMap *Outputs = OFM->getOutputMapForInput(Filename);
+    if (!Outputs) {
+      Diags.diagnose(SourceLoc(), diag::error_batch_no_outputs_for_primary_file,
+                     Filename);
+      HadError = true;
+      continue;
+    }
+
+    auto getOutput = [Outputs](types::ID Type) -> std::string {
+      auto Found = Outputs->find(Type);
+      if (Found == Outputs->end())
+        return std::string();
+      return Found->second;
+    };
+
+    FrontendOptions PrimaryOpts = opts;
+    PrimaryOpts.PrimaryInput = Primary;
+    PrimaryOpts.OutputFilenames.clear();
+    std::string PrimaryOutput = getOutput(PrimaryOutputType);
+    if (!PrimaryOutput.empty())
+      PrimaryOpts.OutputFilenames.push_back(PrimaryOutput);
+    PrimaryOpts.ModuleOutputPath = getOutput(types::TY_SwiftModuleFile);
+    PrimaryOpts.ModuleDocOutputPath = getOutput(types::TY_SwiftModuleDocFile);
+    PrimaryOpts.DependenciesFilePath = getOutput(types::TY_Dependencies);
+    PrimaryOpts.ReferenceDependenciesFilePath = getOutput(types::TY_SwiftDeps);
+
+    Invocation.getIRGenOptions() = OriginalIRGenOpts;
+    if (performCompileStepsPostSema(Instance, Invocation, PrimaryOpts,
+                                    Instance.getPrimarySourceFile(Filename),
+                                    ReturnValue))
+      HadError = true;
+  }
+
+  return HadError;
+}
+
 /// Returns true if an error occurred.
 static bool dumpAPI(Module *Mod, StringRef OutDir) {
   using namespace llvm::sys;
@@ -984,14 +1394,22 @@ static bool dumpAPI(Module *Mod, StringRef OutDir) {
   return false;
 }
 
-int frontend_main(ArrayRef<const char *>Args,
-                  const char *Argv0, void *MainAddr) {
+/// Runs the frontend with \p Args. If \p ReusedInstance is not null, it is
+/// an instance that was set up with CompilerInstance::setupForReuse() for
+/// the same options, and the job completes it instead of starting afresh.
+static int performFrontend(ArrayRef<const char *> Args,
+                           const char *Argv0, void *MainAddr,
+                           CompilerInstance *ReusedInstance) {
   llvm::InitializeAllTargets();
   llvm::InitializeAllTargetMCs();
   llvm::InitializeAllAsmPrinters();
   llvm::InitializeAllAsmParsers();
 
-  CompilerInstance Instance;
+  std::unique_ptr<CompilerInstance> OwnedInstance;
+  if (!ReusedInstance)
+    OwnedInstance.reset(new CompilerInstance());
+  CompilerInstance &Instance =
+    ReusedInstance ? *ReusedInstance : *OwnedInstance;
   PrintingDiagnosticConsumer PDC;
   Instance.addDiagnosticConsumer(&PDC);
 
@@ -1094,19 +1512,73 @@ int frontend_main(ArrayRef<const char *>Args,
     enableDiagnosticVerifier(Instance.getSourceMgr());
   }
 
+  // A reused instance already tracks the dependencies of the modules it
+  // loaded in advance.
   DependencyTracker depTracker;
-  if (!Invocation.getFrontendOptions().DependenciesFilePath.empty() ||
-      !Invocation.getFrontendOptions().ReferenceDependenciesFilePath.empty()) {
+  if (!ReusedInstance &&
+      (!Invocation.getFrontendOptions().DependenciesFilePath.empty() ||
+       !Invocation.getFrontendOptions().ReferenceDependenciesFilePath.empty() ||
+       !Invocation.getFrontendOptions().BatchOutputFileMapPath.empty())) {
     Instance.setDependencyTracker(&depTracker);
   }
 
-  if (Instance.setup(Invocation)) {
+  if (ReusedInstance ? Instance.setupInputs(Invocation)
+                     : Instance.setup(Invocation)) {
     return 1;
   }
 
+  const std::string &tracePath =
+    Invocation.getFrontendOptions().TraceCompileTimePath;
+  if (!tracePath.empty())
+    CompileTimeTrace::enable();
+  const std::string &progressPath =
+    Invocation.getFrontendOptions().ProgressOutputPath;
+  if (!progressPath.empty())
+    CompileTimeTrace::enablePhaseTotals();
+
   int ReturnValue = 0;
-  bool HadError = performCompile(Instance, Invocation, Args, ReturnValue) ||
-                  Instance.getASTContext().hadError();
+  bool HadError;
+  {
+    CompileTimeTraceScope traceScope("frontend", "frontend");
+    HadError = performCompile(Instance, Invocation, Args, ReturnValue) ||
+               Instance.getASTContext().hadError();
+  }
+
+  // Label this job by its primary input, so jobs can be told apart in a
+  // trace or progress stream shared with the driver.
+  StringRef processName = Invocation.getModuleName();
+  auto &primary = Invocation.getFrontendOptions().PrimaryInput;
+  if (primary.hasValue() && primary->isFilename())
+    processName = Invocation.getInputFilenames()[primary->Index];
+
+  if (!tracePath.empty()) {
+    std::string error;
+    if (CompileTimeTrace::appendToFile(tracePath, processName, error)) {
+      Instance.getDiags().diagnose(SourceLoc(), diag::cannot_open_file,
+                                   tracePath, error);
+      HadError = true;
+    }
+  }
+
+  if (!progressPath.empty()) {
+    std::string error;
+    if (CompileTimeTrace::appendPhaseTotals(progressPath, processName, error)) {
+      Instance.getDiags().diagnose(SourceLoc(), diag::cannot_open_file,
+                                   progressPath, error);
+      HadError = true;
+    }
+  }
+
+  if (auto *report = Instance.getASTContext().TypeCheckTimings.get()) {
+    const std::string &path =
+      Invocation.getFrontendOptions().TypeCheckReportPath;
+    std::string error;
+    if (report->appendToFile(path, Instance.getSourceMgr(), error)) {
+      Instance.getDiags().diagnose(SourceLoc(), diag::cannot_open_file,
+                                   path, error);
+      HadError = true;
+    }
+  }
 
   if (!HadError && !Invocation.getFrontendOptions().DumpAPIPath.empty()) {
     HadError = dumpAPI(Instance.getMainModule(),
@@ -1127,3 +1599,14 @@ int frontend_main(ArrayRef<const char *>Args,
 
   return (HadError ? 1 : ReturnValue);
 }
+
+int frontend_main(ArrayRef<const char *>Args,
+                  const char *Argv0, void *MainAddr) {
+  return performFrontend(Args, Argv0, MainAddr, nullptr);
+}
+
+int frontend_main_reusing(ArrayRef<const char *> Args,
+                          const char *Argv0, void *MainAddr,
+                          CompilerInstance &ReusedInstance) {
+  return performFrontend(Args, Argv0, MainAddr, &ReusedInstance);
+}
@@ -26,12 +26,15 @@
 #include "llvm/Object/MachO.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/ManagedStatic.h"
 #include <fstream>
@@ -83,9 +86,20 @@ int main(int argc, char **argv) {
   llvm::cl::list<std::string> FrameworkPaths(
     "F", llvm::cl::desc("add a directory to the framework search path"));
 
+  llvm::cl::list<std::string> ImportModules(
+    "import-module", llvm::cl::desc(
+      "only import this module, like an expression would, instead of all "
+      "the modules found in the AST sections"));
+
+  llvm::cl::opt<bool> PrintTiming(
+    "print-timing", llvm::cl::desc(
+      "print how long registering and importing the modules took"));
+
   llvm::cl::ParseCommandLineOptions(argc, argv);
   // Unregister our options so they don't interfere with the command line
   // parsing in CodeGen/BackendUtil.cpp.
+  PrintTiming.removeArgument();
+  ImportModules.removeArgument();
   FrameworkPaths.removeArgument();
   ImportPaths.removeArgument();
   ModuleCachePath.removeArgument();
@@ -120,6 +134,7 @@ int main(int argc, char **argv) {
     return 1;
 
   std::vector<llvm::object::OwningBinary<llvm::object::ObjectFile>> ObjFiles;
+  auto StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
 
   // Fetch the serialized module bitstreams from the Mach-O files and
   // register them with the module loader.
@@ -185,8 +200,14 @@ int main(int argc, char **argv) {
     ObjFiles.push_back(std::move(*OF));
   }
 
-  // Attempt to import all modules we found.
-  for (auto path : modules) {
+  auto RegisteredTime = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+
+  // Attempt to import all modules we found, or only the requested ones.
+  std::vector<std::string> ModulesToImport(modules.begin(), modules.end());
+  if (!ImportModules.empty())
+    ModulesToImport.assign(ImportModules.begin(), ImportModules.end());
+
+  for (auto path : ModulesToImport) {
     llvm::outs() << "Importing " << path << "... ";
 
 #ifdef SWIFT_SUPPORTS_SUBMODULES
@@ -216,5 +237,30 @@ int main(int argc, char **argv) {
       }
     }
   }
+
+  auto ImportedTime = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+
+  // Report which of the modules in the AST sections have been deserialized,
+  // either because they were imported or because an imported module
+  // depends on them.
+  llvm::StringSet<> Reported;
+  for (auto path : modules) {
+    if (!Reported.insert(path).second)
+      continue;
+    auto &Ctx = CI.getASTContext();
+    if (Ctx.getLoadedModule(Ctx.getIdentifier(path)))
+      llvm::outs() << "Deserialized " << path << "\n";
+  }
+
+  if (PrintTiming) {
+    llvm::errs() << llvm::format("Registered %u modules in %.3fs\n",
+                                 Reported.size(),
+                                 RegisteredTime.getWallTime() -
+                                   StartTime.getWallTime());
+    llvm::errs() << llvm::format("Imported %u modules in %.3fs\n",
+                                 unsigned(ModulesToImport.size()),
+                                 ImportedTime.getWallTime() -
+                                   RegisteredTime.getWallTime());
+  }
   return 0;
 }
@@ -19,6 +19,7 @@
 #include "swift/Subsystems.h"
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/SILOptions.h"
+#include "swift/Basic/CompileTimeTrace.h"
 #include "swift/Basic/LLVMInitialize.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
@@ -30,13 +31,17 @@
 #include "swift/Serialization/SerializedSILLoader.h"
 #include "swift/Serialization/SerializationOptions.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeValue.h"
+#include <algorithm>
 using namespace swift;
 
 namespace {
@@ -121,6 +126,13 @@ RemoveRuntimeAsserts("remove-runtime-asserts",
                      llvm::cl::init(false),
                      llvm::cl::desc("Remove runtime assertions (cond_fail)."));
 
+static llvm::cl::opt<bool>
+CollapseInlinedStdlibDebugScopes(
+    "collapse-inlined-stdlib-debug-scopes", llvm::cl::Hidden,
+    llvm::cl::init(false),
+    llvm::cl::desc("Attribute inlined transparent and standard library "
+                   "functions to their call sites."));
+
 static llvm::cl::opt<bool>
 EmitVerboseSIL("emit-verbose-sil",
                llvm::cl::desc("Emit locations during sil emission."));
@@ -153,6 +165,22 @@ ASTVerifierProcessId("ast-verifier-process-id", llvm::cl::Hidden,
 static llvm::cl::opt<bool>
 PerformWMO("wmo", llvm::cl::desc("Enable whole-module optimizations"));
 
+static llvm::cl::opt<std::string>
+TraceCompileTime("trace-compile-time",
+                 llvm::cl::desc("Append a Chrome trace of parsing, "
+                                "optimization and printing to a file"));
+
+static llvm::cl::opt<std::string>
+ExternalPassPipelineFilename("external-pass-pipeline-filename",
+                             llvm::cl::desc("Run the pass pipeline defined by "
+                                            "this file (asserts builds only)"));
+
+static llvm::cl::opt<unsigned>
+Benchmark("benchmark", llvm::cl::init(0),
+          llvm::cl::desc("Run the selected passes on <N> fresh copies of the "
+                         "input and report the time and SIL memory of each "
+                         "pass instead of printing the result"));
+
 static void runCommandLineSelectedPasses(SILModule *Module) {
   SILPassManager PM(Module);
 
@@ -162,6 +190,125 @@ static void runCommandLineSelectedPasses(SILModule *Module) {
   PM.run();
 }
 
+static void runSelectedPasses(SILModule &Module) {
+  if (!ExternalPassPipelineFilename.empty()) {
+    runSILOptimizationPassesWithFileSpecification(Module,
+                                                  ExternalPassPipelineFilename);
+  } else if (OptimizationGroup == OptGroup::Diagnostics) {
+    runSILDiagnosticPasses(Module);
+  } else if (OptimizationGroup == OptGroup::Performance) {
+    runSILOptimizationPasses(Module);
+  } else {
+    runCommandLineSelectedPasses(&Module);
+  }
+}
+
+/// Parse the input of \p Invocation into \p CI, or load its SIL if it is a
+/// serialized module. Returns true on error.
+static bool loadModule(CompilerInstance &CI, CompilerInvocation &Invocation,
+                       bool HasSerializedAST,
+                       const serialization::ExtendedValidationInfo &Info) {
+  if (CI.setup(Invocation))
+    return true;
+
+  {
+    CompileTimeTraceScope traceScope("sil-opt", "parse");
+    CI.performSema();
+  }
+
+  // If parsing produced an error, don't run any passes.
+  if (CI.getASTContext().hadError())
+    return true;
+
+  // Load the SIL if we have a module. We have to do this after SILParse
+  // creating the unfortunate double if statement.
+  if (HasSerializedAST) {
+    assert(!CI.hasSILModule() &&
+           "performSema() should not create a SILModule.");
+    CI.setSILModule(SILModule::createEmptyModule(CI.getMainModule(),
+                                                 CI.getSILOptions()));
+    std::unique_ptr<SerializedSILLoader> SL = SerializedSILLoader::create(
+        CI.getASTContext(), CI.getSILModule(), nullptr);
+
+    if (Info.isSIB())
+      SL->getAllForModule(CI.getMainModule()->getName(), nullptr);
+    else
+      SL->getAll();
+  }
+  return false;
+}
+
+template <typename T, typename GetValue>
+static void getMinAndMedian(const std::vector<T> &Samples, GetValue getValue,
+                            uint64_t &Min, uint64_t &Median) {
+  std::vector<uint64_t> Values;
+  for (auto &Sample : Samples)
+    Values.push_back(getValue(Sample));
+  std::sort(Values.begin(), Values.end());
+  Min = Values.front();
+  Median = Values[Values.size() / 2];
+}
+
+/// Run the selected passes on \p Iterations freshly loaded copies of the
+/// input, so that every run starts from the same module, and print the
+/// minimum and median cost of each pass over all runs.
+static bool runBenchmark(CompilerInvocation &Invocation, bool HasSerializedAST,
+                         const serialization::ExtendedValidationInfo &Info,
+                         unsigned Iterations) {
+  Invocation.getSILOptions().RecordPassProfile = true;
+
+  // The per-run costs of each pass, in the order in which the passes first
+  // ran.
+  std::vector<std::string> PassOrder;
+  llvm::StringMap<std::vector<SILPassCost>> PassSamples;
+  std::vector<uint64_t> PipelineTimes;
+
+  for (unsigned i = 0; i != Iterations; ++i) {
+    CompilerInstance CI;
+    PrintingDiagnosticConsumer PrintDiags;
+    CI.addDiagnosticConsumer(&PrintDiags);
+    if (loadModule(CI, Invocation, HasSerializedAST, Info))
+      return true;
+
+    llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
+    runSelectedPasses(*CI.getSILModule());
+    PipelineTimes.push_back(llvm::sys::TimeValue::now().nanoseconds() -
+                            StartTime.nanoseconds());
+
+    for (auto &Cost : takeSILPassProfile()) {
+      auto &Samples = PassSamples[Cost.Pass];
+      if (Samples.empty())
+        PassOrder.push_back(Cost.Pass);
+      Samples.push_back(Cost);
+    }
+  }
+
+  auto &OS = llvm::outs();
+  OS << llvm::format("%-40s %6s %12s %12s %14s %14s\n", "pass", "runs",
+                     "min-ms", "median-ms", "min-bytes", "median-bytes");
+
+  uint64_t MinTime, MedianTime;
+  for (auto &Pass : PassOrder) {
+    auto &Samples = PassSamples[Pass];
+    uint64_t MinBytes, MedianBytes;
+    getMinAndMedian(Samples, [](const SILPassCost &C) { return C.WallTimeNS; },
+                    MinTime, MedianTime);
+    getMinAndMedian(Samples,
+                    [](const SILPassCost &C) { return C.AllocatedBytes; },
+                    MinBytes, MedianBytes);
+    OS << llvm::format("%-40s %6u %12.3f %12.3f %14llu %14llu\n",
+                       Pass.c_str(), Samples.front().Runs, MinTime / 1e6,
+                       MedianTime / 1e6, (unsigned long long)MinBytes,
+                       (unsigned long long)MedianBytes);
+  }
+
+  getMinAndMedian(PipelineTimes, [](uint64_t T) { return T; },
+                  MinTime, MedianTime);
+  OS << llvm::format("%-40s %6u %12.3f %12.3f\n", "(pipeline)", Iterations,
+                     MinTime / 1e6, MedianTime / 1e6);
+  return false;
+}
+
 // This function isn't referenced outside its translation unit, but it
 // can't use the "static" keyword because its address is used for
 // getMainExecutable (since some platforms don't support taking the
@@ -214,8 +361,12 @@ int main(int argc, char **argv) {
   SILOptions &SILOpts = Invocation.getSILOptions();
   SILOpts.InlineThreshold = SILInlineThreshold;
   SILOpts.VerifyAll = EnableSILVerifyAll;
+  // Verification would dominate the measured time.
+  if (Benchmark && EnableSILVerifyAll.getNumOccurrences() == 0)
+    SILOpts.VerifyAll = false;
   SILOpts.RemoveRuntimeAsserts = RemoveRuntimeAsserts;
   SILOpts.AssertConfig = AssertConfId;
+  SILOpts.CollapseInlinedStdlibDebugScopes = CollapseInlinedStdlibDebugScopes;
   if (OptimizationGroup != OptGroup::Diagnostics)
     SILOpts.Optimization = SILOptions::SILOptMode::Optimize;
 
@@ -264,44 +415,26 @@ int main(int argc, char **argv) {
     }
   }
 
-  if (CI.setup(Invocation))
-    return 1;
+  if (Benchmark)
+    return runBenchmark(Invocation, HasSerializedAST, extendedInfo, Benchmark);
 
-  CI.performSema();
+  if (!TraceCompileTime.empty())
+    CompileTimeTrace::enable();
 
-  // If parsing produced an error, don't run any passes.
-  if (CI.getASTContext().hadError())
+  if (loadModule(CI, Invocation, HasSerializedAST, extendedInfo))
     return 1;
 
-  // Load the SIL if we have a module. We have to do this after SILParse
-  // creating the unfortunate double if statement.
-  if (HasSerializedAST) {
-    assert(!CI.hasSILModule() &&
-           "performSema() should not create a SILModule.");
-    CI.setSILModule(SILModule::createEmptyModule(CI.getMainModule(),
-                                                 CI.getSILOptions()));
-    std::unique_ptr<SerializedSILLoader> SL = SerializedSILLoader::create(
-        CI.getASTContext(), CI.getSILModule(), nullptr);
-
-    if (extendedInfo.isSIB())
-      SL->getAllForModule(CI.getMainModule()->getName(), nullptr);
-    else
-      SL->getAll();
-  }
-
   // If we're in verify mode, install a custom diagnostic handling for
   // SourceMgr.
   if (VerifyMode)
     enableDiagnosticVerifier(CI.getSourceMgr());
 
-  if (OptimizationGroup == OptGroup::Diagnostics) {
-    runSILDiagnosticPasses(*CI.getSILModule());
-  } else if (OptimizationGroup == OptGroup::Performance) {
-    runSILOptimizationPasses(*CI.getSILModule());
-  } else {
-    runCommandLineSelectedPasses(CI.getSILModule());
+  {
+    CompileTimeTraceScope traceScope("sil-opt", "optimize");
+    runSelectedPasses(*CI.getSILModule());
   }
 
+  CompileTimeTraceScope outputTraceScope("sil-opt", "output");
   if (EmitSIB) {
     llvm::SmallString<128> OutputFile;
     if (OutputFilename.size()) {
@@ -340,8 +473,19 @@ int main(int argc, char **argv) {
     }
   }
 
+  outputTraceScope.finish();
+
   bool HadError = CI.getASTContext().hadError();
 
+  if (!TraceCompileTime.empty()) {
+    std::string Error;
+    if (CompileTimeTrace::appendToFile(TraceCompileTime, "sil-opt", Error)) {
+      llvm::errs() << "while writing '" << TraceCompileTime << "': "
+                   << Error << '\n';
+      HadError = true;
+    }
+  }
+
   // If we're in -verify mode, we've buffered up all of the generated
   // diagnostics.  Check now to ensure that they meet our expectations.
   if (VerifyMode) {
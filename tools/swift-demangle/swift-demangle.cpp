@@ -15,10 +15,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/PrettyStackTrace.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
-#include "llvm/Support/Regex.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -52,6 +53,20 @@ static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
 
+/// Every symbol is demangled through one session, so that the memory of
+/// each parse tree is reused for the next.
+static swift::Demangle::DemangleSession Session;
+
+/// The demangled names printed so far. Symbols repeat a lot in the crash
+/// logs and symbol tables this tool is fed.
+static llvm::StringMap<std::string> DemangledNames;
+
+static swift::Demangle::NodePointer demangleNode(llvm::StringRef name) {
+  swift::PrettyStackTraceStringAction prettyStackTrace("demangling string",
+                                                       name);
+  return Session.demangleSymbolAsNode(name.data(), name.size());
+}
+
 static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
                      const swift::Demangle::DemangleOptions &options) {
   bool hadLeadingUnderscore = false;
@@ -59,8 +74,21 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
     hadLeadingUnderscore = true;
     name = name.substr(1);
   }
-  swift::Demangle::NodePointer pointer =
-      swift::demangle_wrappers::demangleSymbolAsNode(name);
+  if (!ExpandMode && !TreeOnly && !RemangleMode) {
+    auto found = DemangledNames.find(name);
+    if (found == DemangledNames.end()) {
+      std::string string = swift::Demangle::nodeToString(demangleNode(name),
+                                                         options);
+      found = DemangledNames.insert(
+          {name, string.empty() ? name.str() : std::move(string)}).first;
+    }
+    if (!CompactMode)
+      llvm::outs() << name << " ---> ";
+    llvm::outs() << found->getValue();
+    return;
+  }
+
+  swift::Demangle::NodePointer pointer = demangleNode(name);
   if (ExpandMode || TreeOnly) {
     llvm::outs() << "Demangling for " << name << '\n';
     swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
@@ -85,14 +113,25 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
   }
 }
 
-static llvm::StringRef substrBefore(llvm::StringRef whole,
-                                    llvm::StringRef part) {
-  return whole.slice(0, part.data() - whole.data());
+static bool isSymbolChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
 }
 
-static llvm::StringRef substrAfter(llvm::StringRef whole,
-                                   llvm::StringRef part) {
-  return whole.substr((part.data() - whole.data()) + part.size());
+/// Find the next match of "_T[_a-zA-Z0-9$]+" in \p text at or after
+/// \p from, returning an empty string if there is none.
+static llvm::StringRef findSymbol(llvm::StringRef text, size_t from) {
+  for (;;) {
+    size_t start = text.find("_T", from);
+    if (start == llvm::StringRef::npos)
+      return llvm::StringRef();
+    size_t end = start + 2;
+    while (end < text.size() && isSymbolChar(text[end]))
+      ++end;
+    if (end > start + 2)
+      return text.slice(start, end);
+    from = start + 1;
+  }
 }
 
 int main(int argc, char **argv) {
@@ -113,14 +152,16 @@ int main(int argc, char **argv) {
     llvm::StringRef inputContents = input.get()->getBuffer();
 
     // This doesn't handle Unicode symbols, but maybe that's okay.
-    llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
-    llvm::SmallVector<llvm::StringRef, 1> matches;
-    while (maybeSymbol.match(inputContents, &matches)) {
-      llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
-      inputContents = substrAfter(inputContents, matches.front());
+    size_t printed = 0;
+    for (llvm::StringRef symbol = findSymbol(inputContents, 0);
+         !symbol.empty();
+         symbol = findSymbol(inputContents, printed)) {
+      size_t start = symbol.data() - inputContents.data();
+      llvm::outs() << inputContents.slice(printed, start);
+      demangle(llvm::outs(), symbol, options);
+      printed = start + symbol.size();
     }
-    llvm::outs() << inputContents;
+    llvm::outs() << inputContents.substr(printed);
 
   } else {
     for (llvm::StringRef name : InputNames) {
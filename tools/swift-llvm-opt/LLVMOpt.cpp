@@ -235,6 +235,7 @@ int main(int argc, char **argv) {
   initializeSwiftARCOptPass(Registry);
   initializeSwiftARCContractPass(Registry);
   initializeSwiftStackPromotionPass(Registry);
+  initializeSwiftProfileCounterPromotionPass(Registry);
 
   llvm::cl::ParseCommandLineOptions(argc, argv, "Swift LLVM optimizer\n");
 
@@ -0,0 +1,76 @@
+#include "swift/AST/DiagnosticEngine.h"
+#include "swift/AST/DiagnosticsCommon.h"
+#include "swift/Basic/SourceManager.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+
+namespace {
+/// Records the text of every diagnostic it receives.
+class RecordingConsumer : public DiagnosticConsumer {
+public:
+  bool NeedsText = true;
+  std::vector<std::pair<DiagnosticKind, std::string>> Received;
+
+  bool needsDiagnosticText(SourceLoc Loc, DiagnosticKind Kind,
+                           const DiagnosticInfo &Info) override {
+    return NeedsText;
+  }
+
+  void handleDiagnostic(SourceManager &SM, SourceLoc Loc,
+                        DiagnosticKind Kind, StringRef Text,
+                        const DiagnosticInfo &Info) override {
+    Received.push_back({Kind, Text});
+  }
+};
+} // end anonymous namespace
+
+TEST(DiagnosticEngine, SkipsUnneededText) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  RecordingConsumer Consumer;
+  Consumer.NeedsText = false;
+  Diags.addConsumer(Consumer);
+
+  Diags.diagnose(SourceLoc(), diag::error_opening_output, "a", "b");
+  ASSERT_EQ(1u, Consumer.Received.size());
+  EXPECT_EQ(DiagnosticKind::Error, Consumer.Received[0].first);
+  EXPECT_EQ("", Consumer.Received[0].second);
+  EXPECT_TRUE(Diags.hadAnyError());
+
+  // The text is produced as soon as any consumer asks for it.
+  RecordingConsumer Other;
+  Diags.addConsumer(Other);
+  Diags.diagnose(SourceLoc(), diag::error_opening_output, "a", "b");
+  ASSERT_EQ(1u, Other.Received.size());
+  EXPECT_EQ("error opening 'a' for output: b", Other.Received[0].second);
+}
+
+TEST(DiagnosticEngine, SuppressesDuplicates) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  RecordingConsumer Consumer;
+  Diags.addConsumer(Consumer);
+  Diags.setSuppressDuplicateDiagnostics();
+
+  unsigned BufferID = SM.addMemBufferCopy("let x = 1\nlet y = 2\n");
+  SourceLoc Start = SM.getLocForBufferStart(BufferID);
+  SourceLoc Other = Start.getAdvancedLoc(10);
+
+  Diags.diagnose(Start, diag::error_opening_output, "a", "b");
+  Diags.diagnose(Start, diag::while_parsing_as_less_operator);
+  // Repeated, along with its note.
+  Diags.diagnose(Start, diag::error_opening_output, "a", "b");
+  Diags.diagnose(Start, diag::while_parsing_as_less_operator);
+  // Different arguments, or a different location.
+  Diags.diagnose(Start, diag::error_opening_output, "a", "c");
+  Diags.diagnose(Other, diag::error_opening_output, "a", "b");
+  Diags.diagnose(Other, diag::while_parsing_as_less_operator);
+
+  ASSERT_EQ(5u, Consumer.Received.size());
+  EXPECT_EQ(DiagnosticKind::Error, Consumer.Received[0].first);
+  EXPECT_EQ(DiagnosticKind::Note, Consumer.Received[1].first);
+  EXPECT_EQ("error opening 'a' for output: c", Consumer.Received[2].second);
+  EXPECT_EQ("error opening 'a' for output: b", Consumer.Received[3].second);
+  EXPECT_EQ(DiagnosticKind::Note, Consumer.Received[4].first);
+}
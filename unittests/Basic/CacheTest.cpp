@@ -0,0 +1,84 @@
+#include "swift/Basic/Cache.h"
+#include "gtest/gtest.h"
+
+using namespace swift::sys;
+
+namespace {
+struct Blob {
+  size_t Size;
+};
+} // end anonymous namespace
+
+namespace swift {
+namespace sys {
+template <>
+struct CacheValueCostInfo<Blob> {
+  static size_t getCost(const Blob &Val) { return Val.Size; }
+};
+} // namespace sys
+} // namespace swift
+
+// libcache only evicts under memory pressure.
+#if !defined(__APPLE__)
+
+TEST(Cache, NoLimitKeepsEverything) {
+  Cache<int, Blob> C("swift.test.Cache");
+  for (int i = 0; i != 10; ++i)
+    C.set(i, Blob{ 1000 });
+  for (int i = 0; i != 10; ++i)
+    EXPECT_TRUE(C.get(i).hasValue());
+}
+
+TEST(Cache, EvictsLeastRecentlyUsed) {
+  Cache<int, Blob> C("swift.test.Cache");
+  C.setCostLimit(30);
+  C.set(1, Blob{ 10 });
+  C.set(2, Blob{ 10 });
+  C.set(3, Blob{ 10 });
+
+  // Using 1 makes 2 the least recently used entry.
+  EXPECT_TRUE(C.get(1).hasValue());
+  C.set(4, Blob{ 10 });
+
+  EXPECT_TRUE(C.get(1).hasValue());
+  EXPECT_FALSE(C.get(2).hasValue());
+  EXPECT_TRUE(C.get(3).hasValue());
+  EXPECT_TRUE(C.get(4).hasValue());
+}
+
+TEST(Cache, LoweringLimitEvicts) {
+  Cache<int, Blob> C("swift.test.Cache");
+  C.set(1, Blob{ 10 });
+  C.set(2, Blob{ 10 });
+  C.set(3, Blob{ 10 });
+  C.setCostLimit(15);
+
+  EXPECT_FALSE(C.get(1).hasValue());
+  EXPECT_FALSE(C.get(2).hasValue());
+  EXPECT_TRUE(C.get(3).hasValue());
+}
+
+TEST(Cache, KeepsMostRecentEntryOverLimit) {
+  Cache<int, Blob> C("swift.test.Cache");
+  C.setCostLimit(10);
+  C.set(1, Blob{ 5 });
+  C.set(2, Blob{ 100 });
+
+  EXPECT_FALSE(C.get(1).hasValue());
+  ASSERT_TRUE(C.get(2).hasValue());
+  EXPECT_EQ(100u, C.get(2)->Size);
+}
+
+TEST(Cache, ReplacingUpdatesCost) {
+  Cache<int, Blob> C("swift.test.Cache");
+  C.setCostLimit(30);
+  C.set(1, Blob{ 10 });
+  C.set(1, Blob{ 10 });
+  C.set(1, Blob{ 10 });
+  C.set(2, Blob{ 10 });
+
+  EXPECT_TRUE(C.get(1).hasValue());
+  EXPECT_TRUE(C.get(2).hasValue());
+}
+
+#endif
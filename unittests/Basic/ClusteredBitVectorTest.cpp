@@ -1,4 +1,5 @@
 #include "swift/Basic/ClusteredBitVector.h"
+#include "llvm/ADT/APInt.h"
 #include "gtest/gtest.h"
 
 using namespace swift;
@@ -208,3 +209,43 @@ TEST(ClusteredBitVector, FlipAllBig) {
   EXPECT_EQ(true, vec[7]);
   EXPECT_EQ(1u, vec.count());
 }
+
+TEST(ClusteredBitVector, AppendAtOffset) {
+  ClusteredBitVector other;
+  other.appendSetBits(70);
+  other.appendClearBits(3);
+  other.appendSetBits(60);
+
+  ClusteredBitVector vec;
+  vec.appendClearBits(5);
+  vec.appendSetBits(2);
+  vec.append(other);
+  EXPECT_EQ(140u, vec.size());
+  EXPECT_EQ(132u, vec.count());
+  EXPECT_EQ(false, vec[4]);
+  EXPECT_EQ(true, vec[5]);
+  EXPECT_EQ(true, vec[76]);
+  EXPECT_EQ(false, vec[77]);
+  EXPECT_EQ(false, vec[79]);
+  EXPECT_EQ(true, vec[80]);
+  EXPECT_EQ(true, vec[139]);
+}
+
+TEST(ClusteredBitVector, FromAPInt) {
+  llvm::APInt value(130, 0);
+  value.setBit(0);
+  value.setBit(64);
+  value.setBit(129);
+
+  auto vec = ClusteredBitVector::fromAPInt(value);
+  EXPECT_EQ(130u, vec.size());
+  EXPECT_EQ(3u, vec.count());
+  EXPECT_EQ(true, vec[0]);
+  EXPECT_EQ(true, vec[64]);
+  EXPECT_EQ(true, vec[129]);
+  EXPECT_EQ(value, vec.asAPInt());
+
+  vec.appendSetBits(1);
+  EXPECT_EQ(131u, vec.size());
+  EXPECT_EQ(4u, vec.count());
+}
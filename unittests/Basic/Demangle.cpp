@@ -11,3 +11,21 @@ TEST(Demangle, DemangleWrappers) {
       demangleSymbolAsString(MangledName));
 }
 
+TEST(Demangle, DemangleSession) {
+  swift::Demangle::DemangleSession Session;
+  for (unsigned i = 0; i < 3; ++i) {
+    EXPECT_EQ("Swift.Int", Session.demangleSymbolAsString("_TtSi"));
+    EXPECT_EQ("_TtZZ", Session.demangleSymbolAsString("_TtZZ"));
+  }
+
+  // A parse tree outlives the session that built it, and later calls on the
+  // session do not reuse its memory.
+  NodePointer Tree;
+  {
+    swift::Demangle::DemangleSession Scoped;
+    Tree = Scoped.demangleSymbolAsNode("_TtSi", 5);
+    EXPECT_EQ("Swift.String", Scoped.demangleSymbolAsString("_TtSS"));
+  }
+  EXPECT_EQ("Swift.Int", swift::Demangle::nodeToString(Tree));
+}
+
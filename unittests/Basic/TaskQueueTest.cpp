@@ -0,0 +1,75 @@
+//===- TaskQueueTest.cpp - for swift/Basic/TaskQueue.h --------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/TaskQueue.h"
+#include "swift/Basic/LLVM.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+using namespace swift;
+using namespace swift::sys;
+
+#if LLVM_ON_UNIX
+
+static const char *SleepArgs[] = { "-c", "sleep 0.2" };
+
+/// Runs \p Count shell tasks that each sleep for a moment, projected to use
+/// \p ProjectedMemory bytes, and returns how many of them ran at once.
+static unsigned runSleepingTasks(TaskQueue &TQ, unsigned Count,
+                                 uint64_t ProjectedMemory,
+                                 std::vector<TaskProcessInformation> &Infos) {
+  for (unsigned i = 0; i != Count; ++i)
+    TQ.addTask("/bin/sh", SleepArgs, llvm::None, nullptr, 0, ProjectedMemory);
+
+  unsigned Running = 0, MaxRunning = 0;
+  bool Failed = TQ.execute(
+    [&](ProcessId, void *) {
+      ++Running;
+      MaxRunning = std::max(MaxRunning, Running);
+    },
+    [&](ProcessId, int ReturnCode, StringRef, TaskProcessInformation ProcInfo,
+        void *) {
+      EXPECT_EQ(0, ReturnCode);
+      --Running;
+      Infos.push_back(ProcInfo);
+      return TaskFinishedResponse::ContinueExecution;
+    });
+  EXPECT_FALSE(Failed);
+  return MaxRunning;
+}
+
+TEST(TaskQueueTest, ResourceUsage) {
+  TaskQueue TQ(2);
+  std::vector<TaskProcessInformation> Infos;
+  EXPECT_EQ(2U, runSleepingTasks(TQ, 2, 0, Infos));
+  ASSERT_EQ(2U, Infos.size());
+  for (auto &Info : Infos) {
+    EXPECT_GE(Info.WallTimeMicros, 100000U);
+    EXPECT_GT(Info.MaxResidentSetBytes, 0U);
+  }
+}
+
+TEST(TaskQueueTest, MemoryBudget) {
+  TaskQueue TQ(3);
+  TQ.setMemoryBudget(100);
+  std::vector<TaskProcessInformation> Infos;
+
+  // Two tasks fit in the budget together; a third doesn't.
+  EXPECT_EQ(2U, runSleepingTasks(TQ, 3, 50, Infos));
+
+  // A task that is larger than the whole budget still runs, on its own.
+  EXPECT_EQ(1U, runSleepingTasks(TQ, 2, 200, Infos));
+  EXPECT_EQ(5U, Infos.size());
+}
+
+#endif
@@ -1,4 +1,6 @@
 #include "swift/Driver/DependencyGraph.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace swift;
@@ -790,3 +792,155 @@ TEST(DependencyGraph, ChainedExternalPreMarked) {
   EXPECT_TRUE(graph.isMarked(0));
   EXPECT_FALSE(graph.isMarked(1));
 }
+
+static std::string encodeAsBinary(StringRef yaml) {
+  auto buffer = llvm::MemoryBuffer::getMemBuffer(yaml);
+  std::string result;
+  llvm::raw_string_ostream out(result);
+  EXPECT_FALSE(DependencyGraphImpl::encodeAsBinary(*buffer, out));
+  return out.str();
+}
+
+TEST(DependencyGraph, BinaryFormat) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 encodeAsBinary("provides-top-level: [a]\n"
+                                                "provides-member: [[b, bb]]\n"
+                                                "interface-hash: abc")),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, encodeAsBinary("depends-top-level: [a]")),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2,
+                                 encodeAsBinary("depends-member: [[b, bb]]")),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3,
+                                 encodeAsBinary("depends-top-level: "
+                                                "[!private a]")),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(4,
+                                 encodeAsBinary("depends-external: [/foo]")),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(3u, marked.size());
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+  EXPECT_FALSE(graph.isMarked(3));
+  EXPECT_FALSE(graph.isMarked(4));
+
+  auto externals = graph.getExternalDependencies();
+  EXPECT_EQ(1, std::distance(externals.begin(), externals.end()));
+  EXPECT_EQ("/foo", *externals.begin());
+
+  EXPECT_EQ(graph.loadFromString(0, encodeAsBinary("interface-hash: abc")),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(0, encodeAsBinary("interface-hash: def")),
+            LoadResult::AffectsDownstream);
+}
+
+TEST(DependencyGraph, MalformedBinary) {
+  DependencyGraph<uintptr_t> graph;
+
+  std::string encoded = encodeAsBinary("provides-top-level: [a, b]");
+  EXPECT_EQ(graph.loadFromString(0, StringRef(encoded).drop_back()),
+            LoadResult::HadError);
+  EXPECT_EQ(graph.loadFromString(1, StringRef(encoded).substr(0, 8)),
+            LoadResult::HadError);
+}
+
+TEST(DependencyGraph, Fingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0, "provides-top-level: [a, b]\n"
+                                    "provides-member: [[c, cc]]\n"
+                                    "interface-hash: abc\n"
+                                    "fingerprints-top-level: [[a, 1], [b, 2]]\n"
+                                    "fingerprints-member: [[c, cc, 3]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-member: [[c, cc]]"),
+            LoadResult::UpToDate);
+
+  // A change to the interface that doesn't change any fingerprint doesn't
+  // affect anything else.
+  EXPECT_EQ(graph.loadFromString(0, "provides-top-level: [a, b]\n"
+                                    "provides-member: [[c, cc]]\n"
+                                    "interface-hash: def\n"
+                                    "fingerprints-top-level: [[a, 1], [b, 2]]\n"
+                                    "fingerprints-member: [[c, cc, 3]]"),
+            LoadResult::UpToDate);
+
+  EXPECT_EQ(graph.loadFromString(0, "provides-top-level: [a, b]\n"
+                                    "provides-member: [[c, cc]]\n"
+                                    "interface-hash: ghi\n"
+                                    "fingerprints-top-level: [[a, 1], [b, 4]]\n"
+                                    "fingerprints-member: [[c, cc, 3]]"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+  EXPECT_FALSE(graph.isMarked(3));
+}
+
+TEST(DependencyGraph, FingerprintsBinary) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 encodeAsBinary("provides-member: [[c, cc], "
+                                                "[c, dd]]\n"
+                                                "interface-hash: abc\n"
+                                                "fingerprints-member: "
+                                                "[[c, cc, 1], [c, dd, 2]]")),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-member: [[c, cc]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-member: [[c, dd]]"),
+            LoadResult::UpToDate);
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 encodeAsBinary("provides-member: [[c, cc], "
+                                                "[c, dd]]\n"
+                                                "interface-hash: def\n"
+                                                "fingerprints-member: "
+                                                "[[c, cc, 3], [c, dd, 2]]")),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_FALSE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, MissingFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0, "provides-top-level: [a, b]\n"
+                                    "interface-hash: abc\n"
+                                    "fingerprints-top-level: [[a, 1]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  // Without a fingerprint, "b" is assumed to change along with the interface.
+  EXPECT_EQ(graph.loadFromString(0, "provides-top-level: [a, b]\n"
+                                    "interface-hash: def\n"
+                                    "fingerprints-top-level: [[a, 1]]"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+}
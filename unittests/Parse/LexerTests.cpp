@@ -111,6 +111,54 @@ TEST_F(LexerTest, StringLiteralWithNUL1) {
   EXPECT_EQ(Toks[1].getLength(), 0U);
 }
 
+TEST_F(LexerTest, LongBlockComment) {
+  // The newline and the nested comment are both past the first sixteen
+  // bytes of the comment.
+  const char *Source =
+      "aaa /* a long comment that is\n"
+      "longer than sixteen bytes /* nested */ with é */ bbb";
+  std::vector<tok> ExpectedTokens{ tok::identifier, tok::identifier };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ("bbb", Toks[1].getText());
+  EXPECT_TRUE(Toks[1].isAtStartOfLine());
+}
+
+TEST_F(LexerTest, LongBlockCommentOnOneLine) {
+  const char *Source =
+      "aaa /* a long comment that is longer than sixteen bytes */ bbb";
+  std::vector<tok> ExpectedTokens{ tok::identifier, tok::identifier };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ("bbb", Toks[1].getText());
+  EXPECT_FALSE(Toks[1].isAtStartOfLine());
+}
+
+TEST_F(LexerTest, LongLineComment) {
+  const char *Source =
+      "// a long comment that is longer than sixteen bytes, with é\n"
+      "aaa";
+  std::vector<tok> ExpectedTokens{ tok::comment, tok::identifier };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens,
+                                     /*KeepComments=*/true);
+  EXPECT_EQ("aaa", Toks[1].getText());
+  EXPECT_TRUE(Toks[1].isAtStartOfLine());
+}
+
+TEST_F(LexerTest, LongStringLiteral) {
+  const char *Source =
+      "\"a string literal longer than sixteen bytes \\(x) with \\\"é\\\"\" "
+      "aaa";
+  std::vector<tok> ExpectedTokens{ tok::string_literal, tok::identifier };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ(Toks[0].getLength(), 61U);
+}
+
+TEST_F(LexerTest, LongIdentifier) {
+  const char *Source = "anIdentifierLongerThan16Bytes_$0é_and_more aaa";
+  std::vector<tok> ExpectedTokens{ tok::identifier, tok::identifier };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ("anIdentifierLongerThan16Bytes_$0é_and_more", Toks[0].getText());
+}
+
 TEST_F(LexerTest, RestoreBasic) {
   const char *Source = "aaa \t\0 bbb ccc";
 
@@ -12,8 +12,11 @@
 
 #include "SourceKit/Support/FuzzyStringMatcher.h"
 #include "gtest/gtest.h"
+#include <string>
+#include <vector>
 
 using FuzzyStringMatcher = SourceKit::FuzzyStringMatcher;
+using llvm::StringRef;
 
 TEST(FuzzyStringMatcher, BasicMatching) {
   {
@@ -315,4 +318,40 @@ TEST(FuzzyStringMatcher, ShortUnconnectedMatches) {
   FuzzyStringMatcher m("abcd");
   EXPECT_GT(m.scoreCandidate("xaxbxcdxxxxxx"), m.scoreCandidate("xaxbxcxd"));
   EXPECT_GT(m.scoreCandidate("xaxbxc_d"), m.scoreCandidate("xaxbxcxd"));
-}
\ No newline at end of file
+}
+TEST(FuzzyStringMatcher, CharacterMask) {
+  auto mask = FuzzyStringMatcher::getCharacterMask;
+  FuzzyStringMatcher m("aSd_1");
+  EXPECT_TRUE(m.mayMatchCandidate(mask("a_s_d_1")));
+  EXPECT_TRUE(m.mayMatchCandidate(mask("1_DSA")));
+  EXPECT_FALSE(m.mayMatchCandidate(mask("asd1")));
+  EXPECT_FALSE(m.mayMatchCandidate(mask("")));
+  EXPECT_TRUE(FuzzyStringMatcher("").mayMatchCandidate(mask("")));
+
+  // Whatever the prefilter rejects must not match.
+  const char *candidates[] = {"asdf_1", "a_sd1", "_1asd", "x", "ASD_12"};
+  for (const char *candidate : candidates) {
+    if (!m.mayMatchCandidate(mask(candidate)))
+      EXPECT_FALSE(m.matchesCandidate(candidate));
+  }
+}
+
+TEST(FuzzyStringMatcher, BatchScoring) {
+  std::vector<std::string> storage;
+  for (unsigned i = 0; i < 50000; ++i)
+    storage.push_back((i % 2 ? "MKAnnotationView" : "NSWindow") +
+                      std::to_string(i));
+  std::vector<StringRef> candidates(storage.begin(), storage.end());
+
+  FuzzyStringMatcher m("mkav");
+  std::vector<double> scores(candidates.size());
+  m.scoreCandidates(candidates, scores);
+  for (unsigned i = 0; i < candidates.size(); ++i) {
+    double expected = m.matchesCandidate(candidates[i])
+                          ? m.scoreCandidate(candidates[i])
+                          : 0.0;
+    EXPECT_EQ(expected, scores[i]);
+  }
+  EXPECT_GT(scores[1], 0.0);
+  EXPECT_EQ(0.0, scores[0]);
+}
@@ -43,3 +43,32 @@ TEST(EditableTextBuffer, Updates) {
 
   EXPECT_EQ(Buf->getFilename(), "/a/test");
 }
+
+TEST(EditableTextBuffer, OlderSnapshots) {
+  EditableTextBufferRef EdBuf = new EditableTextBuffer("/a/test", "abc");
+  ImmutableTextSnapshotRef Snap1 = EdBuf->insert(3, "def");
+  ImmutableTextSnapshotRef Snap2 = EdBuf->erase(0, 1);
+  ImmutableTextSnapshotRef Snap3 = EdBuf->replace(1, 1, "xyz");
+
+  // Snapshots that are no longer the latest are rebuilt from the history.
+  EXPECT_EQ(Snap3->getBuffer()->getText(), "bxyzdef");
+  EXPECT_EQ(Snap1->getBuffer()->getText(), "abcdef");
+  EXPECT_EQ(Snap2->getBuffer()->getText(), "bcdef");
+  EXPECT_EQ(EdBuf->getBuffer()->getText(), "bxyzdef");
+
+  EdBuf->insert(0, "_");
+  EXPECT_EQ(EdBuf->getBuffer()->getText(), "_bxyzdef");
+  EXPECT_EQ(Snap3->getBuffer()->getText(), "bxyzdef");
+}
+
+TEST(ImmutableTextBuffer, LineAndColumn) {
+  ImmutableTextBufferRef Buf =
+      new ImmutableTextBuffer("/a/test", "ab\n\ncd\n", /*Stamp=*/0);
+  EXPECT_EQ(Buf->getLineAndColumn(0), std::make_pair(1u, 1u));
+  EXPECT_EQ(Buf->getLineAndColumn(2), std::make_pair(1u, 3u));
+  EXPECT_EQ(Buf->getLineAndColumn(3), std::make_pair(2u, 1u));
+  EXPECT_EQ(Buf->getLineAndColumn(4), std::make_pair(3u, 1u));
+  EXPECT_EQ(Buf->getLineAndColumn(5), std::make_pair(3u, 2u));
+  EXPECT_EQ(Buf->getLineAndColumn(7), std::make_pair(4u, 1u));
+  EXPECT_EQ(Buf->getLineAndColumn(8), std::make_pair(0u, 0u));
+}
@@ -92,6 +92,15 @@ TEST(EnumTest, getEnumCaseSinglePayload) {
   ASSERT_EQ(1, test_getEnumCaseSinglePayload({255, 0}, XI_TMBi8_, 4));
   ASSERT_EQ(2, test_getEnumCaseSinglePayload({0, 1}, XI_TMBi8_, 4));
   ASSERT_EQ(3, test_getEnumCaseSinglePayload({1, 1}, XI_TMBi8_, 4));
+
+  // Test with a payload large enough for a single tag byte.
+  ASSERT_EQ(-1, test_getEnumCaseSinglePayload({1, 2, 3, 4, 0}, _TMBi32_,
+                                               128*1024));
+  ASSERT_EQ(0, test_getEnumCaseSinglePayload({0, 0, 0, 0, 1}, _TMBi32_,
+                                              128*1024));
+  ASSERT_EQ(65536 + 2,
+            test_getEnumCaseSinglePayload({2, 0, 1, 0, 1}, _TMBi32_,
+                                           128*1024));
 }
 
 bool test_storeEnumTagSinglePayload(std::initializer_list<uint8_t> after,
@@ -152,4 +161,12 @@ TEST(EnumTest, storeEnumTagSinglePayload) {
                                               XI_TMBi8_, 2, 4));
   ASSERT_TRUE(test_storeEnumTagSinglePayload({1, 1}, {219, 123},
                                               XI_TMBi8_, 3, 4));
+
+  // Test with a payload large enough for a single tag byte.
+  ASSERT_TRUE(test_storeEnumTagSinglePayload({1, 2, 3, 4, 0},
+                                              {1, 2, 3, 4, 77},
+                                              _TMBi32_, -1, 128*1024));
+  ASSERT_TRUE(test_storeEnumTagSinglePayload({2, 0, 1, 0, 1},
+                                              {1, 2, 3, 4, 77},
+                                              _TMBi32_, 65536 + 2, 128*1024));
 }
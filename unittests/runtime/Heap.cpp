@@ -0,0 +1,95 @@
+//===--- swift/unittests/runtime/Heap.cpp - Runtime heap tests ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Heap.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+TEST(HeapTest, slowAlloc_sizes) {
+  std::vector<std::pair<void *, size_t>> allocations;
+  for (size_t size = 0; size <= 2048; size += 7) {
+    void *p = swift_slowAlloc(size, sizeof(void*) - 1);
+    ASSERT_NE(nullptr, p);
+    EXPECT_EQ(uintptr_t(0), uintptr_t(p) & (sizeof(void*) - 1));
+    EXPECT_GE(swift_slowAllocSize(p), size);
+    memset(p, 0xAB, size);
+    allocations.push_back({p, size});
+  }
+  for (auto &allocation : allocations)
+    swift_slowDealloc(allocation.first, allocation.second,
+                      sizeof(void*) - 1);
+}
+
+TEST(HeapTest, slowAlloc_overAligned) {
+  for (size_t alignMask : {31, 63, 127, 4095}) {
+    for (size_t size : {1, 16, 100, 5000}) {
+      void *p = swift_slowAlloc(size, alignMask);
+      ASSERT_NE(nullptr, p);
+      EXPECT_EQ(uintptr_t(0), uintptr_t(p) & alignMask);
+      memset(p, 0xCD, size);
+      swift_slowDealloc(p, size, alignMask);
+    }
+  }
+}
+
+TEST(HeapTest, slowDealloc_otherThread) {
+  // Blocks freed on a thread other than the one that allocated them must be
+  // reusable by both.
+  std::vector<void *> blocks;
+  for (unsigned i = 0; i < 1000; ++i)
+    blocks.push_back(swift_slowAlloc(48, 15));
+
+  std::thread freeingThread([&] {
+    for (void *p : blocks)
+      swift_slowDealloc(p, 48, 15);
+    for (unsigned i = 0; i < 1000; ++i)
+      swift_slowDealloc(swift_slowAlloc(48, 15), 48, 15);
+  });
+  freeingThread.join();
+
+  for (unsigned i = 0; i < 1000; ++i) {
+    void *p = swift_slowAlloc(48, 15);
+    memset(p, 0xEF, 48);
+    swift_slowDealloc(p, 48, 15);
+  }
+}
+
+TEST(HeapTest, slowRealloc) {
+  // Grow from the size-class heap into the system allocator and back, and
+  // across over-aligned allocations, checking the contents survive.
+  for (size_t alignMask : {7, 15, 63}) {
+    size_t size = 24;
+    auto p = static_cast<unsigned char *>(swift_slowAlloc(size, alignMask));
+    for (size_t i = 0; i < size; ++i)
+      p[i] = static_cast<unsigned char>(i);
+
+    for (size_t newSize : {40, 600, 100000, 64}) {
+      p = static_cast<unsigned char *>(
+            swift_slowRealloc(p, size, newSize, alignMask));
+      ASSERT_NE(nullptr, p);
+      EXPECT_EQ(uintptr_t(0), uintptr_t(p) & alignMask);
+      EXPECT_GE(swift_slowAllocSize(p), newSize);
+      for (size_t i = 0; i < std::min(size, newSize); ++i)
+        ASSERT_EQ(static_cast<unsigned char>(i), p[i]);
+      for (size_t i = size; i < newSize; ++i)
+        p[i] = static_cast<unsigned char>(i);
+      size = newSize;
+    }
+    swift_slowDealloc(p, size, alignMask);
+  }
+}
@@ -215,6 +215,36 @@ TEST(Concurrent, ConcurrentList) {
   EXPECT_EQ(ListLen, results.size() * numElem);
 }
 
+TEST(Concurrent, ConcurrentOpenHashTable) {
+  const int numElem = 100;
+
+  // Every thread inserts its own elements and then looks all of them up
+  // again while the other threads are still inserting and resizing.
+  ConcurrentOpenHashTable<int> Table;
+  std::vector<int> Elems(64 * numElem);
+  std::atomic<unsigned> NextThread(0);
+  RaceTest<int*>(
+    [&]() -> int* {
+      unsigned base = NextThread.fetch_add(1) * numElem;
+      for (int i = 0; i < numElem; i++) {
+        Elems[base + i] = base + i;
+        // Use a deliberately poor hash to exercise collisions.
+        Table.insert((base + i) % 7, &Elems[base + i]);
+      }
+      for (int i = 0; i < numElem; i++) {
+        int *found = Table.find((base + i) % 7, [&](int *candidate) {
+          return *candidate == int(base + i);
+        });
+        EXPECT_EQ(&Elems[base + i], found);
+      }
+      return nullptr;
+    }
+  );
+
+  EXPECT_EQ(Elems.size(), Table.size());
+  EXPECT_EQ(nullptr, Table.find(3, [](int *) { return false; }));
+}
+
 TEST(MetadataAllocator, alloc_firstAllocationMoreThanPageSized) {
   using swift::MetadataAllocator;
   MetadataAllocator allocator;
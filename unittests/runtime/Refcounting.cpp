@@ -11,8 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/HeapProfile.h"
 #include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Statistics.h"
 #include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 
 using namespace swift;
 
@@ -55,6 +62,78 @@ TEST(RefcountingTest, release) {
   EXPECT_EQ(1u, value);
 }
 
+TEST(RefcountingTest, arena) {
+  SwiftArena *arena = swift_arenaCreate(1024);
+  size_t values[64] = {};
+  TestObject *objects[64];
+  for (size_t i = 0; i < 64; ++i) {
+    // Every eighth object is too big to share a block.
+    size_t size = i % 8 == 7 ? 4096 : sizeof(TestObject) + i;
+    objects[i] = static_cast<TestObject *>(
+      swift_arenaAllocObject(arena, &TestClassObjectMetadata, size,
+                             alignof(TestObject) - 1));
+    EXPECT_EQ(0u, uintptr_t(objects[i]) & (alignof(TestObject) - 1));
+    EXPECT_EQ(size, swift_bufferAllocatedSize(objects[i]));
+    objects[i]->Addr = &values[i];
+    objects[i]->Value = i + 1;
+  }
+  for (size_t i = 0; i < 64; ++i) {
+    swift_retain(objects[i]);
+    swift_release(objects[i]);
+    EXPECT_EQ(0u, values[i]);
+    swift_release(objects[i]);
+    EXPECT_EQ(i + 1, values[i]);
+  }
+  swift_arenaDestroy(arena);
+}
+
+TEST(RefcountingTest, statistics) {
+  SwiftRuntimeStatistics before, after;
+  // Without statistics in the runtime, every counter reads as zero.
+  if (!swift_getRuntimeStatistics(&before)) {
+    EXPECT_EQ(0u, before.Retains);
+    return;
+  }
+
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  swift_retain(object);
+  swift_retain_n(object, 2);
+  swift_release_n(object, 3);
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+  swift_getRuntimeStatistics(&after);
+  EXPECT_EQ(before.ObjectsAllocated + 1, after.ObjectsAllocated);
+  EXPECT_EQ(before.ObjectsDeallocated + 1, after.ObjectsDeallocated);
+  EXPECT_EQ(before.Retains + 3, after.Retains);
+  EXPECT_EQ(before.Releases + 4, after.Releases);
+}
+
+static std::string readFile(const std::string &path) {
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+TEST(RefcountingTest, heap_profile) {
+  std::string prefix = std::string(P_tmpdir) + "/swift-heap-profile-" +
+                       std::to_string(getpid());
+  // With a sample interval of one byte, nearly every allocation is sampled.
+  swift_startHeapProfile(1);
+
+  BoxPair box = swift_allocBox(&_TMBi64_);
+  ASSERT_TRUE(swift_dumpHeapProfile(prefix.c_str()));
+  swift_release(box.first);
+
+  std::string profile = readFile(prefix + ".heap");
+  EXPECT_EQ(0u, profile.find("heap profile: "));
+  std::string summary = readFile(prefix + ".types");
+  EXPECT_NE(std::string::npos, summary.find("<<<box>>>"));
+  remove((prefix + ".heap").c_str());
+  remove((prefix + ".types").c_str());
+}
+
 TEST(RefcountingTest, retain_release) {
   size_t value = 0;
   auto object = allocTestObject(&value, 1);
@@ -67,6 +146,42 @@ TEST(RefcountingTest, retain_release) {
   EXPECT_EQ(1u, value);
 }
 
+TEST(RefcountingTest, release_on_other_thread) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  swift_retain(object);
+  std::thread releasingThread([&] {
+    swift_release(object);
+    swift_release(object);
+  });
+  releasingThread.join();
+
+  // A biased object released elsewhere is deallocated once the allocating
+  // thread merges its count, which happens no later than its next allocation.
+  size_t otherValue = 0;
+  swift_release(allocTestObject(&otherValue, 1));
+  EXPECT_EQ(1u, otherValue);
+  EXPECT_EQ(1u, value);
+}
+
+TEST(RefcountingTest, retain_release_batch) {
+  size_t value1 = 0, value2 = 0;
+  auto object1 = allocTestObject(&value1, 1);
+  auto object2 = allocTestObject(&value2, 1);
+  HeapObject *objects[] = { object1, object1, nullptr, object2, object1 };
+  swift_retainBatch(objects, 5);
+  EXPECT_EQ(4u, swift_retainCount(object1));
+  EXPECT_EQ(2u, swift_retainCount(object2));
+  swift_releaseBatch(objects, 5);
+  EXPECT_EQ(0u, value1);
+  EXPECT_EQ(0u, value2);
+  EXPECT_EQ(1u, swift_retainCount(object1));
+  EXPECT_EQ(1u, swift_retainCount(object2));
+  swift_releaseBatch(objects + 3, 2);
+  EXPECT_EQ(1u, value1);
+  EXPECT_EQ(1u, value2);
+}
+
 TEST(RefcountingTest, pin_unpin) {
   size_t value = 0;
   auto object = allocTestObject(&value, 1);
@@ -156,3 +271,23 @@ TEST(RefcountingTest, unowned_retain_release_n) {
   swift_release(object);
   EXPECT_EQ(1u, value);
 }
+
+TEST(RefcountingTest, weak_side_table) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  WeakReference ref1, ref2;
+  swift_weakInit(&ref1, object);
+  swift_weakCopyInit(&ref2, &ref1);
+  // All weak references share a single unowned reference to the object.
+  EXPECT_EQ(2u, swift_unownedRetainCount(object));
+
+  auto loaded = swift_weakLoadStrong(&ref2);
+  EXPECT_EQ(object, loaded);
+  swift_release(loaded);
+
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref1));
+  EXPECT_EQ(nullptr, swift_weakTakeStrong(&ref2));
+  swift_weakDestroy(&ref1);
+}
@@ -0,0 +1,93 @@
+#include "swift/Basic/ClusteredBitVector.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include "stdlib.h"
+
+using namespace swift;
+
+// Times the word-level operations on vectors much larger than the ones
+// IRGen usually builds, so that per-bit overhead shows up clearly.
+
+const unsigned NumBits = 1 << 16;
+const unsigned NumIterations = 200;
+
+static unsigned Sink = 0;
+
+template <class Fn>
+static void measure(const char *name, Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i != NumIterations; ++i)
+    fn();
+  auto end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+  llvm::outs() << llvm::format("%-28s %12.1f ns/iteration\n", name,
+                               double(ns.count()) / NumIterations);
+}
+
+static ClusteredBitVector makeRandomVector(unsigned numBits) {
+  ClusteredBitVector result;
+  while (result.size() < numBits) {
+    unsigned run = 1 + unsigned(rand()) % 13;
+    run = std::min(run, unsigned(numBits - result.size()));
+    if (rand() & 1)
+      result.appendSetBits(run);
+    else
+      result.appendClearBits(run);
+  }
+  return result;
+}
+
+int main() {
+  srand(0);
+  auto a = makeRandomVector(NumBits);
+  auto b = makeRandomVector(NumBits);
+  llvm::APInt apint = a.asAPInt();
+
+  measure("append (aligned)", [&] {
+    ClusteredBitVector v;
+    v.append(a);
+    v.append(b);
+    Sink += v.size();
+  });
+  measure("append (offset 3)", [&] {
+    ClusteredBitVector v;
+    v.appendSetBits(3);
+    v.append(a);
+    v.append(b);
+    Sink += v.size();
+  });
+  measure("appendSetBits (offset 5)", [&] {
+    ClusteredBitVector v;
+    v.appendClearBits(5);
+    v.appendSetBits(NumBits);
+    Sink += v.size();
+  });
+  measure("operator&=", [&] {
+    ClusteredBitVector v = a;
+    v &= b;
+    Sink += v.size();
+  });
+  measure("operator|=", [&] {
+    ClusteredBitVector v = a;
+    v |= b;
+    Sink += v.size();
+  });
+  measure("count", [&] {
+    Sink += a.count();
+  });
+  measure("enumerateSetBits", [&] {
+    auto e = a.enumerateSetBits();
+    while (auto i = e.findNext())
+      Sink += *i;
+  });
+  measure("fromAPInt", [&] {
+    Sink += ClusteredBitVector::fromAPInt(apint).size();
+  });
+  measure("asAPInt", [&] {
+    Sink += a.asAPInt().getBitWidth();
+  });
+
+  llvm::outs() << "(" << Sink << ")\n";
+}
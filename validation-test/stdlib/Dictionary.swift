@@ -1081,6 +1081,33 @@ DictionaryTestSuite.test("deleteChainCollisionRandomized") {
   }
 }
 
+DictionaryTestSuite.test("hashFragmentsSurviveResizeAndDelete") {
+  // Growing the table and backward-shifting entries on deletion both move
+  // entries, which must carry their hash fragments along.  Every fourth key
+  // shares a hash value with its neighbour to also cover equal fragments.
+  var keys: [TestKeyTy] = []
+  for i in 0..<200 {
+    keys.append(TestKeyTy(value: i, hashValue: i - i % 4 / 3))
+  }
+
+  var d = Dictionary<TestKeyTy, TestValueTy>(minimumCapacity: 2)
+  for k in keys {
+    d[k] = TestValueTy(k.value + 1000)
+  }
+  for k in keys where k.value % 3 == 0 {
+    d[k] = nil
+  }
+
+  assert(d.count == 133)
+  for k in keys {
+    if k.value % 3 == 0 {
+      assert(d[k] == nil)
+    } else {
+      assert(d[k]!.value == k.value + 1000)
+    }
+  }
+}
+
 DictionaryTestSuite.test("init(dictionaryLiteral:)") {
   do {
     var empty = Dictionary<Int, Int>()
@@ -128,6 +128,49 @@ HashingTestSuite.test("_squeezeHashValue/UInt") {
   checkRange((UInt.max-10)..<(UInt.max-1))
 }
 
+// The key is 00 01 02 ... 0f, as in the reference implementation.
+let sipHashTestKey: (UInt64, UInt64) = (0x0706050403020100, 0x0f0e0d0c0b0a0908)
+
+func sipHash13(bytes: [UInt8]) -> UInt64 {
+  var hasher = _SipHash13(key: sipHashTestKey)
+  bytes.withUnsafeBufferPointer { hasher.appendBytes($0) }
+  return hasher.finalize()
+}
+
+HashingTestSuite.test("_SipHash13/GoldenValues") {
+  expectEqual(0xabac_0158_050f_c4dc, sipHash13([]))
+  expectEqual(0xc9f4_9bf3_7d57_ca93, sipHash13(Array(0..<1)))
+  expectEqual(0xd392_7d98_9bb1_1140, sipHash13(Array(0..<7)))
+  expectEqual(0x3690_9511_8d29_9a8e, sipHash13(Array(0..<8)))
+  expectEqual(0x25a4_8eb3_6c06_3de4, sipHash13(Array(0..<9)))
+  expectEqual(0xd320_d86d_2a51_9956, sipHash13(Array(0..<15)))
+  expectEqual(0xcc4f_dd1a_7d90_8b66, sipHash13(Array(0..<16)))
+  expectEqual(0x9d19_9062_b7bb_b3a8, sipHash13(Array(0..<63)))
+}
+
+HashingTestSuite.test("_SipHash13/Streaming") {
+  // Splitting the input between calls doesn't change the hash value.
+  let bytes: [UInt8] = Array(0..<63)
+  for split in 0...bytes.count {
+    var hasher = _SipHash13(key: sipHashTestKey)
+    bytes.withUnsafeBufferPointer {
+      hasher.appendBytes($0.baseAddress, count: split)
+      hasher.appendBytes($0.baseAddress + split, count: bytes.count - split)
+    }
+    expectEqual(0x9d19_9062_b7bb_b3a8, hasher.finalize())
+  }
+
+  // Integers are appended in little-endian byte order.
+  for prefix in 0..<8 {
+    var hasher = _SipHash13(key: sipHashTestKey)
+    var expected: [UInt8] = Array(0..<UInt8(prefix))
+    expected.withUnsafeBufferPointer { hasher.appendBytes($0) }
+    hasher.append(0x0807_0605_0403_0201 as UInt64)
+    expected += (1...8)
+    expectEqual(sipHash13(expected), hasher.finalize())
+  }
+}
+
 HashingTestSuite.test("overridePerExecutionHashSeed/overflow") {
   // Test that we don't use checked arithmetic on the seed.
   _HashingDetail.fixedSeedOverride = UInt64.max
@@ -0,0 +1,144 @@
+// RUN: %target-build-swift -Xfrontend -disable-access-control -module-name a %s -o %t.out
+// RUN: %target-run %t.out | FileCheck %s
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+// Also import modules which are used by StdlibUnittest internally. This
+// workaround is needed to link all required libraries in case we compile
+// StdlibUnittest with -sil-serialize-all.
+import SwiftPrivate
+import SwiftPrivatePthreadExtras
+#if _runtime(_ObjC)
+import ObjectiveC
+#endif
+
+// Runtime operations whose throughput should grow with the number of
+// threads.  The operation counts are small, so that the test is quick;
+// raise them to get meaningful numbers.
+
+class Payload {
+  let value: Int
+  init(_ value: Int) { self.value = value }
+}
+
+struct Pair<T, U> {
+  var first: T
+  var second: U
+}
+
+struct LazilyInitialized {
+  static let value = 42
+}
+
+@inline(never)
+func metadataForPair<T>(_: T.Type) -> Any.Type {
+  return Pair<T, Payload>.self
+}
+
+enum Workload {
+  case SharedRefcounting
+  case Allocation
+  case MetadataLookup
+  case Once
+  case ConformanceLookup
+}
+
+let sharedPayload = Payload(1)
+
+struct RuntimeScalingTest : RaceTestWithPerTrialDataType {
+  static var workload = Workload.SharedRefcounting
+
+  class RaceData {
+    let payload: Payload = sharedPayload
+    let value: Any = 1
+  }
+
+  typealias ThreadLocalData = Void
+  typealias Observation = Observation1UInt
+
+  func makeRaceData() -> RaceData {
+    return RaceData()
+  }
+
+  func makeThreadLocalData() -> Void {
+    return Void()
+  }
+
+  func thread1(
+    raceData: RaceData, inout _ threadLocalData: ThreadLocalData
+  ) -> Observation {
+    switch RuntimeScalingTest.workload {
+    case .SharedRefcounting:
+      let payload = raceData.payload
+      _blackHole(payload)
+      return Observation(UInt(payload.value))
+
+    case .Allocation:
+      let payload = Payload(1)
+      _blackHole(payload)
+      return Observation(UInt(payload.value))
+
+    case .MetadataLookup:
+      let type = metadataForPair(raceData.value.dynamicType)
+      return Observation(type == Pair<Int, Payload>.self ? 1 : 0)
+
+    case .Once:
+      return Observation(UInt(LazilyInitialized.value - 41))
+
+    case .ConformanceLookup:
+      return Observation(raceData.value is CustomStringConvertible ? 1 : 0)
+    }
+  }
+
+  func evaluateObservations(
+    observations: [Observation],
+    _ sink: (RaceTestObservationEvaluation) -> Void
+  ) {
+    for observation in observations {
+      sink(observation == Observation(1) ? .Pass : .Failure)
+    }
+  }
+}
+
+var RaceScalingSuite = TestSuite("RaceScaling")
+
+RaceScalingSuite.test("ResultsPerThreadCount") {
+  let results = runRaceScalingBenchmark(
+    RuntimeScalingTest.self, operationsPerThread: 2000,
+    threadCounts: [1, 2, 4])
+  expectEqual([1, 2, 4], results.map { $0.threads })
+  for result in results {
+    expectLE(2000 * result.threads, result.operations)
+    expectGE(result.imbalance, 1)
+    expectGT(result.operationsPerSecond, 0)
+  }
+}
+// CHECK: [ RUN      ] RaceScaling.ResultsPerThreadCount
+// CHECK: out>>> RuntimeScalingTest scaling:
+// CHECK: out>>> threads  operations/s  speedup  efficiency  imbalance  involuntary-csw
+// CHECK: out>>>       1 {{ *[0-9]+}}     1.00        1.00       1.00
+// CHECK: out>>>       2
+// CHECK: out>>>       4
+// CHECK: [       OK ] RaceScaling.ResultsPerThreadCount
+
+for (name, workload) in [
+  ("SharedRefcounting", Workload.SharedRefcounting),
+  ("Allocation", .Allocation),
+  ("MetadataLookup", .MetadataLookup),
+  ("Once", .Once),
+  ("ConformanceLookup", .ConformanceLookup),
+] {
+  RaceScalingSuite.test(name) {
+    RuntimeScalingTest.workload = workload
+    _ = runRaceScalingBenchmark(
+      RuntimeScalingTest.self, operationsPerThread: 2000)
+  }
+}
+// CHECK: [       OK ] RaceScaling.SharedRefcounting
+// CHECK: [       OK ] RaceScaling.Allocation
+// CHECK: [       OK ] RaceScaling.MetadataLookup
+// CHECK: [       OK ] RaceScaling.Once
+// CHECK: [       OK ] RaceScaling.ConformanceLookup
+
+runAllTests()
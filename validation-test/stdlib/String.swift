@@ -79,6 +79,32 @@ StringTests.test("unicodeScalars") {
   checkUnicodeScalarViewIteration([ 0x10ffff ], "\u{0010ffff}")
 }
 
+func checkCharacterViewIteration(expected: [String], _ s: String) {
+  expectEqualSequence(expected, s.characters.map { String($0) })
+  expectEqualSequence(
+    expected.reverse(), s.characters.reverse().map { String($0) })
+}
+
+StringTests.test("characters/ASCIIFastPath") {
+  checkCharacterViewIteration([], "")
+  checkCharacterViewIteration([ "a" ], "a")
+  checkCharacterViewIteration([ "a", "b", "c" ], "abc")
+  checkCharacterViewIteration([ "\r\n" ], "\r\n")
+  checkCharacterViewIteration([ "\r", "\r\n", "\n" ], "\r\r\n\n")
+  checkCharacterViewIteration([ "\n", "\r" ], "\n\r")
+  checkCharacterViewIteration([ "a", "\r\n", "b" ], "a\r\nb")
+  checkCharacterViewIteration([ "\r", "\u{0301}" ], "\r\u{0301}")
+  checkCharacterViewIteration([ "a\u{0301}", "b" ], "a\u{0301}b")
+  checkCharacterViewIteration([ "a", "\u{00e9}", "b" ], "a\u{00e9}b")
+  checkCharacterViewIteration([ "a", "\u{1f600}", "b" ], "a\u{1f600}b")
+  checkCharacterViewIteration(
+    [ "\u{1100}\u{1161}", "a" ], "\u{1100}\u{1161}a")
+
+  let s = "x\u{0301}y"
+  expectEqual(Character("y"), s.characters.last)
+  expectEqual(Character("x\u{0301}"), s.characters.first)
+}
+
 StringTests.test("indexComparability") {
   let empty = ""
   expectTrue(empty.startIndex == empty.endIndex)
@@ -1146,5 +1172,35 @@ StringTests.test("String.append(_: Character)") {
   }
 }
 
+StringTests.test("ASCIIFastPaths") {
+  // Lengths around the 16-byte block size of the ASCII scanning kernels,
+  // with a non-ASCII code unit at every position.
+  for length in 0..<40 {
+    for nonASCIIPosition in 0...length {
+      var utf8 = Array(Repeat(count: length, repeatedValue: UInt8(ascii: "a")))
+      if nonASCIIPosition < length {
+        utf8.replaceRange(
+          nonASCIIPosition..<nonASCIIPosition + 1, with: [0xC3, 0xA9])
+      }
+      let s = utf8.withUnsafeBufferPointer {
+        String._fromWellFormedCodeUnitSequence(UTF8.self, input: $0)
+      }
+      expectEqual(nonASCIIPosition == length ? 1 : 2, s._core.elementWidth)
+      expectEqualSequence(utf8, s.utf8)
+
+      // ASCII content in wide storage hashes like narrow storage.
+      var wide = s._core
+      if nonASCIIPosition < length {
+        wide.replaceRange(nonASCIIPosition..<nonASCIIPosition + 1, with: [97])
+        expectEqual(2, wide.elementWidth)
+        let narrow = String(
+          Repeat(count: length, repeatedValue: "a" as Character))
+        expectEqual(narrow, String(wide))
+        expectEqual(narrow.hashValue, String(wide).hashValue)
+      }
+    }
+  }
+}
+
 runAllTests()
 
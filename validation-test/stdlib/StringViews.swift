@@ -680,6 +680,50 @@ tests.test("UTF8 indexes") {
   }
 }
 
+tests.test("UTF8/count") {
+  expectEqual(0, "".utf8.count)
+  expectEqual(summerBytes.count, summer.utf8.count)
+  expectEqual(winterUTF8.count, winter.utf8.count)
+
+  // Every subrange, including ones that start or end in the middle of a
+  // Unicode scalar, agrees with walking the indices.
+  let u8 = (summer + winter + summer).utf8
+  for i in u8.indices {
+    for j in i..<u8.endIndex {
+      expectEqual(i.distanceTo(j), u8[i..<j].count)
+    }
+  }
+}
+
+tests.test("UTF8/advancedBy,distanceTo") {
+  for s in [ summer, summer + winter + summer ] {
+    let u8 = s.utf8
+    for i in u8.indices {
+      var j = i
+      var n = 0
+      while true {
+        expectEqual(j, i.advancedBy(n))
+        expectEqual(n, i.distanceTo(j))
+        if j == u8.endIndex { break }
+        ++j
+        ++n
+      }
+    }
+  }
+}
+
+tests.test("UTF8/_withContiguousStorageIfAvailable") {
+  let u8 = summer.utf8
+  expectEqual(
+    summerBytes,
+    u8._withContiguousStorageIfAvailable { Array($0) } ?? [])
+  let tail = u8[u8.startIndex.advancedBy(3)..<u8.endIndex]
+  expectEqual(
+    Array(summerBytes[3..<summerBytes.count]),
+    tail._withContiguousStorageIfAvailable { Array($0) } ?? [])
+  expectEmpty(winter.utf8._withContiguousStorageIfAvailable { $0.count })
+}
+
 tests.test("UTF16->String") {
   let s = summer + winter + winter + summer
   let v = s.utf16